@@ -39,9 +39,9 @@ public:
     }
 
     CANChannelNumericID
-    getChannelNumericID( CANInterfaceID iid )
+    getChannelNumericID( const CANInterfaceID &iid ) const
     {
-        for ( auto l : mLookup )
+        for ( const auto &l : mLookup )
         {
             if ( l.second == iid )
             {
@@ -52,9 +52,9 @@ public:
     };
 
     CANInterfaceID
-    getInterfaceID( CANChannelNumericID cid )
+    getInterfaceID( CANChannelNumericID cid ) const
     {
-        for ( auto l : mLookup )
+        for ( const auto &l : mLookup )
         {
             if ( l.first == cid )
             {
@@ -75,6 +75,8 @@ public:
 
     bool isCompressionNeeded() const override;
 
+    bool isColumnarEncodingNeeded() const override;
+
     uint32_t getPriority() const override;
 
     const struct ExpressionNode *getCondition() const override;
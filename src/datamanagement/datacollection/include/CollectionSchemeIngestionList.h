@@ -17,6 +17,7 @@
 #include "ICollectionSchemeList.h"
 #include "LoggingModule.h"
 #include "collection_schemes.pb.h"
+#include <memory>
 #include <vector>
 
 namespace Aws
@@ -34,6 +35,16 @@ using namespace Aws::IoTFleetWise::Schemas;
  */
 constexpr size_t COLLECTION_SCHEME_LIST_BYTE_SIZE_LIMIT = 128000000;
 
+/**
+ * @brief Maximum number of threads used to build the collectionSchemes of a list in parallel
+ */
+constexpr size_t COLLECTION_SCHEME_LIST_MAX_BUILD_THREADS = 4;
+
+/**
+ * @brief Minimum number of collectionSchemes each build thread is given, so that small lists are built in place
+ */
+constexpr size_t COLLECTION_SCHEME_LIST_MIN_SCHEMES_PER_BUILD_THREAD = 8;
+
 class CollectionSchemeIngestionList : public ICollectionSchemeList
 {
 public:
@@ -59,6 +70,18 @@ public:
     }
 
 private:
+    /**
+     * @brief Builds every stride-th collectionScheme of the list starting at the given index. The collectionSchemes
+     * are independent of each other, so several threads can build disjoint parts of the list at the same time.
+     *
+     * @param first index of the first collectionScheme to build
+     * @param stride distance between the collectionSchemes built by this call
+     * @param collectionSchemes output, the successfully built collectionSchemes are put at their index
+     */
+    void buildCollectionSchemes( size_t first,
+                                 size_t stride,
+                                 std::vector<std::shared_ptr<CollectionSchemeIngestion>> &collectionSchemes ) const;
+
     /**
      * @brief This vector will store the binary data copied from the IReceiver callback.
      */
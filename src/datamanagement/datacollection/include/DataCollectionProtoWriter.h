@@ -18,9 +18,13 @@
 #include "CANInterfaceIDTranslator.h"
 #include "CollectionInspectionAPITypes.h"
 #include "OBDDataTypes.h"
+#include "PayloadBufferPool.h"
+#include "SignalColumnCodec.h"
 #include "vehicle_data.pb.h"
 #include <cstdint>
+#include <memory>
 #include <string>
+#include <vector>
 
 namespace Aws
 {
@@ -34,14 +38,27 @@ using namespace Aws::IoTFleetWise::DataInspection;
 /**
  * @brief Class that does the protobuf setup for the collected data
  *        and serializes the edge to cloud data
+ *
+ * The VehicleData message is not built as a protobuf object tree. The captured signals and raw CAN
+ * frames are encoded in protobuf wire format directly into a buffer from the PayloadBufferPool as they
+ * are appended. The DTC and Geohash sub messages are kept aside and encoded when the payload is
+ * finalized, so they can still be set up after the signals. The resulting bytes parse to the same
+ * VehicleData message as the one previously serialized from the object tree.
+ *
+ * If the collection scheme selects the columnar signal encoding, the signals are grouped by signal ID into
+ * SignalColumn sub messages instead, which are encoded together with the DTC and Geohash sub messages.
  */
 class DataCollectionProtoWriter
 {
 public:
     /**
      * @brief Constructor. Setup the DataCollectionProtoWriter.
+     *
+     * @param canIDTranslator  translates the internal channel ids to the interface ids
+     * @param bufferPool       pool the payload buffers are taken from. If nullptr, a private pool is created.
      */
-    DataCollectionProtoWriter( CANInterfaceIDTranslator &canIDTranslator );
+    DataCollectionProtoWriter( CANInterfaceIDTranslator &canIDTranslator,
+                               std::shared_ptr<PayloadBufferPool> bufferPool = nullptr );
 
     /**
      * @brief Destructor.
@@ -105,6 +122,32 @@ public:
      */
     unsigned getVehicleDataMsgCount() const;
 
+    /**
+     * @brief Gets the size of the payload if it was serialized now
+     *
+     * @return the encoded size in bytes
+     */
+    size_t getVehicleDataEncodedSize() const;
+
+    /**
+     * @brief Gets the number of bytes the encoded payload grows by when the message is appended
+     *
+     * @param msg  the message that could be appended next
+     * @return the growth of the encoded size in bytes
+     */
+    size_t getEncodedSize( const CollectedSignal &msg ) const;
+    size_t getEncodedSize( const CollectedCanRawFrame &msg ) const;
+    size_t getEncodedSize( const GeohashInfo &geohashInfo ) const;
+
+    /**
+     * @brief Gets the number of bytes the encoded payload grows by when the DTC code is appended
+     *
+     * @param dtc  the diagnostic trouble code that could be appended next
+     * @param dtcInfo  the DTC info that setupDTCInfo is called with before the code is appended
+     * @return the growth of the encoded size in bytes
+     */
+    size_t getEncodedSize( const std::string &dtc, const DTCInfo &dtcInfo ) const;
+
     /**
      * @brief Serializes the vehicle data to be sent to cloud
      *
@@ -114,10 +157,74 @@ public:
 
     bool serializeVehicleData( std::string *out ) const;
 
+    /**
+     * @brief Completes the payload and hands over its buffer without copying it
+     *
+     * The writer does not keep any reference to the returned buffer. setupVehicleData has to be called
+     * before the next payload is appended.
+     *
+     * @return the buffer holding the serialized VehicleData message
+     */
+    std::shared_ptr<PayloadBufferPool::Buffer> finalizeVehicleData();
+
 private:
+    /**
+     * @brief Grows the payload buffer
+     *
+     * @param size  number of bytes that will be written
+     * @return pointer to the first of the size bytes appended to the buffer
+     */
+    uint8_t *extendBuffer( size_t size );
+
+    /**
+     * @brief Gets the encoded size of the DTC and Geohash sub messages
+     */
+    size_t getTrailerSize() const;
+
+    /**
+     * @brief Encodes the DTC and Geohash sub messages
+     *
+     * @param target  destination with at least getTrailerSize() bytes
+     * @return pointer behind the last written byte
+     */
+    uint8_t *writeTrailer( uint8_t *target ) const;
+
+    size_t getCapturedSignalBodySize( const CollectedSignal &msg ) const;
+    size_t getCanFrameBodySize( const CollectedCanRawFrame &msg, const std::string &interfaceID ) const;
+    size_t getDTCDataSize() const;
+    size_t getGeohashSize() const;
+
+    /**
+     * @brief Gets the encoded size of a SignalColumn sub message without its tag and length
+     */
+    static size_t getSignalColumnBodySize( uint32_t signalID,
+                                           uint32_t sampleCount,
+                                           size_t relativeTimesSize,
+                                           size_t doubleValuesSize );
+    static size_t getSignalColumnBodySize( const SignalColumnEncoder &column );
+
+    /**
+     * @brief Finds the column of the signal in the current payload
+     * @return the index of the column or mSignalColumnCount if the signal has no column yet
+     */
+    size_t findSignalColumn( uint32_t signalID ) const;
+
     Timestamp mTriggerTime;
     unsigned mVehicleDataMsgCount{}; // tracks the number of messages being sent in the edge to cloud payload
-    VehicleDataMsg::VehicleData mVehicleData{};
+    std::shared_ptr<PayloadBufferPool> mBufferPool;
+    std::shared_ptr<PayloadBufferPool::Buffer> mBuffer;
+    bool mHasDTCData{ false };
+    int64_t mDTCRelativeTime{ 0 };
+    std::vector<std::string> mDTCCodes;
+    bool mHasGeohash{ false };
+    GeohashInfo mGeohashInfo;
+    bool mColumnarEncoding{ false };
+    // The first mSignalColumnCount columns are in use, the others are kept to reuse their memory
+    std::vector<SignalColumnEncoder> mSignalColumns;
+    size_t mSignalColumnCount{ 0 };
+    // The signals are collected grouped by signal ID, so the column of the previous signal is checked first
+    mutable size_t mLastSignalColumn{ 0 };
+    size_t mSignalColumnsSize{ 0 };
     CANInterfaceIDTranslator mIDTranslator;
 };
 } // namespace DataManagement
@@ -14,11 +14,16 @@
 #pragma once
 
 // Includes
+#include "ClockHandler.h"
 #include "CollectionInspectionAPITypes.h"
+#include "CompressionCodec.h"
 #include "DataCollectionJSONWriter.h"
 #include "DataCollectionProtoWriter.h"
 #include "ISender.h"
 #include "LoggingModule.h"
+#include "PayloadBufferPool.h"
+#include <array>
+#include <cstddef>
 #include <memory>
 #include <string>
 #include <vector>
@@ -32,6 +37,7 @@ namespace DataManagement
 using namespace Aws::IoTFleetWise::Platform::Linux;
 using namespace Aws::IoTFleetWise::DataInspection;
 using namespace Aws::IoTFleetWise::OffboardConnectivity;
+using namespace Aws::IoTFleetWise::OffboardConnectivityAwsIot;
 using Aws::IoTFleetWise::OffboardConnectivity::CollectionSchemeParams;
 
 /**
@@ -43,12 +49,35 @@ enum class SendDestination
     MQTT
 };
 
+/**
+ * @brief Distribution of the sizes of the payloads handed over to the ISender
+ */
+struct PayloadSizeStatistics
+{
+    // The first buckets split the maximum payload size into equal parts: up to 25%, 50%, 75% and 100%.
+    // The last bucket counts the payloads that exceed it, which happens only if a single message is
+    // too large or the compressed size was underestimated.
+    static constexpr size_t NUMBER_OF_FILL_BUCKETS = 5;
+
+    uint64_t payloadCount{ 0 };
+    uint64_t totalBytes{ 0 };
+    uint64_t minBytes{ 0 };
+    uint64_t maxBytes{ 0 };
+    std::array<uint64_t, NUMBER_OF_FILL_BUCKETS> fillBuckets{};
+};
+
 /**
  * @brief Serializes collected data and sends it to the cloud.
  *        Optionally supports debug JSON output of collected data.
  *        The maxMessageCount option limits the number of messages
  *        (or signals) appended to the protobuf message before the
- *        protobuf is serialized and sent to the cloud.
+ *        protobuf is serialized and sent to the cloud. Independent of
+ *        that, a payload is cut before its encoded size, or its estimated
+ *        size after compression, would exceed the maximum payload size.
+ *
+ *        The payload is encoded directly into a pooled buffer, compressed into
+ *        a second pooled buffer if requested and then handed over to the
+ *        ISender, which can publish it without copying.
  */
 class DataCollectionSender
 {
@@ -61,12 +90,18 @@ public:
      *  @param maxMessageCount    Maximum number of messages before the data is serialized and sent to the cloud
      *  @param canIDTranslator    Needed to translate the internal used can channel id to the can interface id used by
      *  @param persistencyPath     Path to file system where files will be written for durable storage.
+     *  @param maxPayloadSize     Size in bytes the payloads are filled up to. 0 or values bigger than
+     *                            ISender::getMaxSendSize() use the maximum the sender accepts.
+     *  @param payloadCodec       Codec the payloads are compressed with if the collection scheme requests
+     *                            compression. If nullptr, Snappy is used.
      */
     DataCollectionSender( std::shared_ptr<ISender> sender,
                           bool jsonOutputEnabled,
                           unsigned maxMessageCount,
                           CANInterfaceIDTranslator &canIDTranslator,
-                          std::string persistencyPath );
+                          std::string persistencyPath,
+                          size_t maxPayloadSize = 0,
+                          std::shared_ptr<const PayloadCodec> payloadCodec = nullptr );
 
     /**
      * @brief Serializes the collected data and transmits it to the cloud
@@ -79,9 +114,10 @@ public:
     /**
      * @brief Send the serialized data to the cloud
      *
+     * @param payload buffer with the serialized proto. The ownership is passed to the ISender.
      * @return SUCCESS if transmit was successful, else return an errorcode
      */
-    ConnectivityError transmit();
+    ConnectivityError transmit( std::shared_ptr<PayloadBufferPool::Buffer> payload );
 
     /**
      * @brief Send the serialized data to the cloud
@@ -91,18 +127,35 @@ public:
      */
     ConnectivityError transmit( const std::string &payload );
 
+    /**
+     * @brief Gets the distribution of the payload sizes sent so far. Not thread safe with send().
+     */
+    PayloadSizeStatistics getPayloadSizeStatistics() const;
+
 private:
+    // Safety margin applied to the compression ratio observed so far when estimating the compressed size
+    static constexpr double COMPRESSION_RATIO_MARGIN = 1.1;
+    // Weight of the latest payload in the moving average of the compression ratio
+    static constexpr double COMPRESSION_RATIO_WEIGHT = 0.25;
+
     LoggingModule mLogger;
     uint32_t mCollectionEventID; // A unique ID that FWE generates each time a collectionScheme condition is triggered.
     std::shared_ptr<ISender> mSender;
     bool mJsonOutputEnabled{ false };
     SendDestination mSendDestination{ SendDestination::MQTT };
     unsigned mTransmitThreshold; // max number of messages that can be sent to cloud at one time
+    size_t mMaxPayloadSize;      // max size of a payload sent to cloud at one time
+    double mCompressionRatio{ 1.0 };
+    PayloadSizeStatistics mPayloadSizeStatistics;
     std::string mPersistencyPath;
+    std::shared_ptr<PayloadBufferPool> mBufferPool;
+    std::shared_ptr<const PayloadCodec> mPayloadCodec;
     DataCollectionProtoWriter mProtoWriter;
     DataCollectionJSONWriter mJsonWriter;
-    std::string mProtoOutput;
     CollectionSchemeParams mCollectionSchemeParams;
+    std::shared_ptr<const Clock> mClock = ClockHandler::getClock();
+    // Reception time of the newest signal or raw CAN frame of the data currently sent, 0 if there is none
+    Timestamp mNewestReceiveTime{ 0 };
 
     /**
      * @brief Set up collectionSchemeParams struct
@@ -121,6 +174,24 @@ private:
      * @brief Serialize and send the protobuf data to the cloud
      */
     void serializeAndTransmit();
+
+    /**
+     * @brief Checks if the current payload has to be sent before the next message is appended
+     *
+     * @param nextMessageSize encoded size of the next message
+     * @return true if the message count or the payload size limit would be exceeded
+     */
+    bool isPayloadFull( size_t nextMessageSize ) const;
+
+    /**
+     * @brief Estimates the size of the payload as handed over to the ISender
+     *
+     * @param encodedSize size of the serialized proto
+     * @return the encoded size, or the estimated compressed size if compression is enabled
+     */
+    size_t estimatePayloadSize( size_t encodedSize ) const;
+
+    void updatePayloadSizeStatistics( size_t payloadSize );
 };
 
 } // namespace DataManagement
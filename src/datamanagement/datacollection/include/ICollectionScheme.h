@@ -363,6 +363,11 @@ public:
      */
     virtual bool isCompressionNeeded() const = 0;
 
+    /**
+     * @brief Is it needed to send the signals grouped by signal ID in the columnar encoding
+     */
+    virtual bool isColumnarEncodingNeeded() const = 0;
+
     /**
      * @brief Returns the condition to trigger the collectionScheme
      *
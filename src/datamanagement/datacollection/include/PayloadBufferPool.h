@@ -0,0 +1,82 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#pragma once
+
+// Includes
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace DataManagement
+{
+
+/**
+ * @brief Pool of reusable byte buffers for the edge to cloud payloads
+ *
+ * A buffer handed out by acquire() is owned by the returned shared pointer. When the last owner
+ * releases it, which can be the MQTT stack on one of its own threads after the publish completed,
+ * the buffer goes back to the pool with its capacity retained, so that the next payload of a similar
+ * size does not need any heap allocation. Buffers released after the pool itself has been destroyed
+ * are simply freed.
+ */
+class PayloadBufferPool
+{
+public:
+    using Buffer = std::vector<uint8_t>;
+
+    static constexpr size_t DEFAULT_MAX_POOLED_BUFFERS = 4;
+
+    /**
+     * @brief Constructor
+     *
+     * @param maxPooledBuffers maximum number of idle buffers kept for reuse. Buffers released while
+     *                         the pool is full are freed.
+     */
+    explicit PayloadBufferPool( size_t maxPooledBuffers = DEFAULT_MAX_POOLED_BUFFERS );
+
+    /**
+     * @brief Gets an empty buffer, reusing an idle one from the pool if available
+     *
+     * @return a buffer with size 0 that returns to the pool once the last reference is dropped
+     */
+    std::shared_ptr<Buffer> acquire();
+
+    /**
+     * @brief Gets the number of idle buffers currently held by the pool
+     */
+    size_t getPooledBufferCount() const;
+
+private:
+    struct State
+    {
+        std::mutex mMutex;
+        std::vector<std::unique_ptr<Buffer>> mIdleBuffers;
+        size_t mMaxPooledBuffers;
+    };
+
+    static void release( const std::weak_ptr<State> &weakState, Buffer *buffer );
+
+    // Kept behind a shared pointer so buffers in flight can detect that the pool is gone
+    std::shared_ptr<State> mState;
+};
+
+} // namespace DataManagement
+} // namespace IoTFleetWise
+} // namespace Aws
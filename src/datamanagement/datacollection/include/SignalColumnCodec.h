@@ -0,0 +1,157 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#pragma once
+
+// Includes
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace DataManagement
+{
+
+/**
+ * @brief Encodes the samples of one signal into the two columns of a SignalColumn message
+ *
+ * The relative times are encoded as delta of delta: the first time is stored with 64 bits and each following
+ * time as the change of the difference to its predecessor, which is 0 for periodic signals. The zigzag encoded
+ * delta of delta is stored as '0' if it is 0, as '10', '110' or '1110' followed by 7, 9 or 12 bits, or as '1111'
+ * followed by 64 bits.
+ *
+ * The values are XOR encoded like in the Gorilla time series database: the first value is stored with 64 bits
+ * and each following value as the XOR of its bits with the bits of its predecessor. An XOR of 0 is stored as '0'.
+ * Otherwise the meaningful bits between the leading and trailing zeros are stored after '10' if they fit into the
+ * window of meaningful bits of the previous sample, or after '11', 5 bits of leading zeros and 6 bits of length.
+ *
+ * Both columns are written most significant bit first and padded with zeros to full bytes.
+ */
+class SignalColumnEncoder
+{
+public:
+    /**
+     * @brief Starts a new column
+     * @param signalID  ID of the signal whose samples are encoded
+     */
+    void reset( uint32_t signalID );
+
+    /**
+     * @brief Appends a sample to the column
+     * @param relativeTime  time of the sample relative to the trigger time in milliseconds
+     * @param value  value of the sample
+     */
+    void append( int64_t relativeTime, double value );
+
+    /**
+     * @brief Gets the sizes both columns would have if the sample was appended
+     * @param relativeTime  time of the sample relative to the trigger time in milliseconds
+     * @param value  value of the sample
+     * @param relativeTimesSize  set to the size of the relative times column in bytes
+     * @param doubleValuesSize  set to the size of the values column in bytes
+     */
+    void getSizesAfterAppend( int64_t relativeTime,
+                              double value,
+                              size_t &relativeTimesSize,
+                              size_t &doubleValuesSize ) const;
+
+    uint32_t
+    getSignalID() const
+    {
+        return mSignalID;
+    }
+
+    uint32_t
+    getSampleCount() const
+    {
+        return mSampleCount;
+    }
+
+    const std::vector<uint8_t> &
+    getRelativeTimes() const
+    {
+        return mRelativeTimes.mBytes;
+    }
+
+    const std::vector<uint8_t> &
+    getDoubleValues() const
+    {
+        return mDoubleValues.mBytes;
+    }
+
+private:
+    struct BitWriter
+    {
+        std::vector<uint8_t> mBytes;
+        size_t mBitCount{ 0 };
+
+        void clear();
+        void write( uint64_t bits, uint32_t count );
+    };
+
+    // Bits a sample is encoded with in one column: a prefix of up to 13 bits followed by up to 64 payload bits
+    struct Code
+    {
+        uint64_t prefix{ 0 };
+        uint32_t prefixLength{ 0 };
+        uint64_t payload{ 0 };
+        uint32_t payloadLength{ 0 };
+        // Only used for values: window of meaningful bits to use for the next sample
+        uint32_t windowLeadingZeros{ 0 };
+        uint32_t windowLength{ 0 };
+    };
+
+    Code getTimeCode( int64_t relativeTime ) const;
+    Code getValueCode( uint64_t valueBits ) const;
+
+    uint32_t mSignalID{ 0 };
+    uint32_t mSampleCount{ 0 };
+    int64_t mLastTime{ 0 };
+    int64_t mLastDelta{ 0 };
+    uint64_t mLastValueBits{ 0 };
+    // Window of meaningful bits of the last XOR value that was not 0, in use if mWindowLength is not 0
+    uint32_t mWindowLeadingZeros{ 0 };
+    uint32_t mWindowLength{ 0 };
+    BitWriter mRelativeTimes;
+    BitWriter mDoubleValues;
+};
+
+/**
+ * @brief Decodes the columns of a SignalColumn message written by SignalColumnEncoder
+ */
+class SignalColumnDecoder
+{
+public:
+    /**
+     * @brief Decodes the samples of one signal
+     * @param sampleCount  number of encoded samples
+     * @param relativeTimes  relative times column
+     * @param doubleValues  values column
+     * @param outRelativeTimes  filled with the times relative to the trigger time in milliseconds
+     * @param outValues  filled with the values
+     * @return True if all samples could be decoded, False if a column is too short
+     */
+    static bool decode( uint32_t sampleCount,
+                        const std::string &relativeTimes,
+                        const std::string &doubleValues,
+                        std::vector<int64_t> &outRelativeTimes,
+                        std::vector<double> &outValues );
+};
+
+} // namespace DataManagement
+} // namespace IoTFleetWise
+} // namespace Aws
@@ -535,6 +535,18 @@ CollectionSchemeIngestion::isCompressionNeeded() const
     return mProtoCollectionSchemeMessagePtr->compress_collected_data();
 }
 
+bool
+CollectionSchemeIngestion::isColumnarEncodingNeeded() const
+{
+    if ( !mReady )
+    {
+        return false;
+    }
+
+    return mProtoCollectionSchemeMessagePtr->signal_encoding() ==
+           CollectionSchemesMsg::CollectionScheme::COLUMNAR_SIGNAL_ENCODING;
+}
+
 uint32_t
 CollectionSchemeIngestion::getMinimumPublishIntervalMs() const
 {
@@ -12,7 +12,12 @@
  */
 
 #include "CollectionSchemeIngestionList.h"
+#include "Signal.h"
+#include "Thread.h"
+#include <algorithm>
 #include <exception>
+#include <functional>
+#include <unistd.h>
 
 namespace Aws
 {
@@ -20,6 +25,27 @@ namespace IoTFleetWise
 {
 namespace DataManagement
 {
+namespace
+{
+/**
+ * @brief Extra thread building a part of the list. The own done signal makes sure the part is built before the
+ * thread is released.
+ */
+struct ListBuildThread
+{
+    Thread thread;
+    Signal done;
+    std::function<void()> build;
+
+    static void
+    doWork( void *data )
+    {
+        auto self = static_cast<ListBuildThread *>( data );
+        self->build();
+        self->done.notify();
+    }
+};
+} // namespace
 
 const std::vector<ICollectionSchemePtr> &
 CollectionSchemeIngestionList::getCollectionSchemes() const
@@ -112,26 +138,56 @@ CollectionSchemeIngestionList::build()
     // Ensure we start with an empty vector of collectionScheme pointers
     mVectorCollectionSchemePtr.clear();
 
-    // Iterate through all the collectionSchemes in the collectionScheme list, make a shared pointer of them
-    for ( int i = 0; i < mCollectionSchemeListMsg.collection_schemes_size(); i++ )
+    // The collectionSchemes do not depend on each other, so large lists are split over a few threads. The calling
+    // thread builds its share too, and the share of every thread that could not be created.
+    auto numCollectionSchemes = static_cast<size_t>( mCollectionSchemeListMsg.collection_schemes_size() );
+    auto numberOfCpus = sysconf( _SC_NPROCESSORS_ONLN );
+    size_t numThreads = std::min( { COLLECTION_SCHEME_LIST_MAX_BUILD_THREADS,
+                                    ( numberOfCpus > 0 ) ? static_cast<size_t>( numberOfCpus ) : 1,
+                                    std::max<size_t>( numCollectionSchemes /
+                                                          COLLECTION_SCHEME_LIST_MIN_SCHEMES_PER_BUILD_THREAD,
+                                                      1 ) } );
+    std::vector<std::shared_ptr<CollectionSchemeIngestion>> collectionSchemes( numCollectionSchemes );
+    std::vector<std::unique_ptr<ListBuildThread>> buildThreads;
+    std::vector<size_t> sharesOfCallingThread = { 0 };
+    for ( size_t i = 1; i < numThreads; i++ )
     {
-        // Create a CollectionSchemeIngestion Pointer, or pICPPtr.
-        auto pICPPtr = std::make_shared<CollectionSchemeIngestion>();
-
-        // Stuff the pointer with the collectionScheme proto message data
-        pICPPtr->copyData( std::make_shared<CollectionSchemesMsg::CollectionScheme>(
-            mCollectionSchemeListMsg.collection_schemes( i ) ) );
+        auto buildThread = std::make_unique<ListBuildThread>();
+        buildThread->build = [this, i, numThreads, &collectionSchemes]() {
+            buildCollectionSchemes( i, numThreads, collectionSchemes );
+        };
+        if ( !buildThread->thread.create( ListBuildThread::doWork, buildThread.get() ) )
+        {
+            mLogger.warn( "CollectionSchemeIngestionList::build()",
+                          "Build thread " + std::to_string( i ) + " could not be created. Building in place" );
+            sharesOfCallingThread.emplace_back( i );
+            continue;
+        }
+        buildThread->thread.setThreadName( "fwDCColSchBld" + std::to_string( i ) );
+        buildThreads.emplace_back( std::move( buildThread ) );
+    }
+    for ( auto share : sharesOfCallingThread )
+    {
+        buildCollectionSchemes( share, numThreads, collectionSchemes );
+    }
+    for ( auto &buildThread : buildThreads )
+    {
+        buildThread->done.wait( Signal::WaitWithPredicate );
+        buildThread->thread.release();
+    }
 
-        // Check to see if it successfully builds
-        if ( pICPPtr->build() )
+    // Keep the order of the list
+    for ( size_t i = 0; i < numCollectionSchemes; i++ )
+    {
+        if ( collectionSchemes[i] != nullptr )
         {
             mLogger.trace( "CollectionSchemeIngestionList::build()",
                            "Adding CollectionScheme index: " + std::to_string( i ) + " of " +
-                               std::to_string( mCollectionSchemeListMsg.collection_schemes_size() ) );
+                               std::to_string( numCollectionSchemes ) );
 
             // Add this newly created shared pointer to the vector of ICollectionScheme shared pointers.
             // It is implicitly upcasted to its base pointer
-            mVectorCollectionSchemePtr.emplace_back( pICPPtr );
+            mVectorCollectionSchemePtr.emplace_back( collectionSchemes[i] );
         }
         else
         {
@@ -148,6 +204,27 @@ CollectionSchemeIngestionList::build()
     return true;
 }
 
+void
+CollectionSchemeIngestionList::buildCollectionSchemes(
+    size_t first, size_t stride, std::vector<std::shared_ptr<CollectionSchemeIngestion>> &collectionSchemes ) const
+{
+    for ( size_t i = first; i < collectionSchemes.size(); i += stride )
+    {
+        // Create a CollectionSchemeIngestion Pointer, or pICPPtr.
+        auto pICPPtr = std::make_shared<CollectionSchemeIngestion>();
+
+        // Stuff the pointer with the collectionScheme proto message data
+        pICPPtr->copyData( std::make_shared<CollectionSchemesMsg::CollectionScheme>(
+            mCollectionSchemeListMsg.collection_schemes( static_cast<int>( i ) ) ) );
+
+        // Only collectionSchemes that build successfully are kept. Each index is written by exactly one thread.
+        if ( pICPPtr->build() )
+        {
+            collectionSchemes[i] = pICPPtr;
+        }
+    }
+}
+
 } // namespace DataManagement
 } // namespace IoTFleetWise
 } // namespace Aws
@@ -13,6 +13,8 @@
 
 // Includes
 #include "DataCollectionProtoWriter.h"
+#include <google/protobuf/io/coded_stream.h>
+#include <google/protobuf/wire_format_lite.h>
 
 namespace Aws
 {
@@ -21,10 +23,59 @@ namespace IoTFleetWise
 namespace DataManagement
 {
 
-DataCollectionProtoWriter::DataCollectionProtoWriter( CANInterfaceIDTranslator &canIDTranslator )
+using google::protobuf::internal::WireFormatLite;
+using google::protobuf::io::CodedOutputStream;
+using VehicleDataMsg::VehicleData;
+
+namespace
+{
+
+size_t
+getStringFieldSize( int fieldNumber, const std::string &value )
+{
+    // proto3 does not encode empty singular strings
+    return value.empty() ? 0U : WireFormatLite::TagSize( fieldNumber, WireFormatLite::TYPE_STRING ) +
+                                    WireFormatLite::StringSize( value );
+}
+
+uint8_t *
+writeStringField( int fieldNumber, const std::string &value, uint8_t *target )
+{
+    return value.empty() ? target : WireFormatLite::WriteStringToArray( fieldNumber, value, target );
+}
+
+size_t
+getLengthDelimitedFieldSize( int fieldNumber, size_t bodySize )
+{
+    return WireFormatLite::TagSize( fieldNumber, WireFormatLite::TYPE_MESSAGE ) +
+           WireFormatLite::LengthDelimitedSize( bodySize );
+}
+
+uint8_t *
+writeLengthDelimitedHeader( int fieldNumber, size_t bodySize, uint8_t *target )
+{
+    target = WireFormatLite::WriteTagToArray( fieldNumber, WireFormatLite::WIRETYPE_LENGTH_DELIMITED, target );
+    return CodedOutputStream::WriteVarint32ToArray( static_cast<uint32_t>( bodySize ), target );
+}
+
+size_t
+getSignalColumnFieldSize( size_t bodySize )
+{
+    return getLengthDelimitedFieldSize( VehicleData::kSignalColumnsFieldNumber, bodySize );
+}
+
+} // namespace
+
+DataCollectionProtoWriter::DataCollectionProtoWriter( CANInterfaceIDTranslator &canIDTranslator,
+                                                      std::shared_ptr<PayloadBufferPool> bufferPool )
     : mTriggerTime( 0U )
+    , mBufferPool( std::move( bufferPool ) )
     , mIDTranslator( canIDTranslator )
 {
+    if ( mBufferPool == nullptr )
+    {
+        mBufferPool = std::make_shared<PayloadBufferPool>();
+    }
 }
 
 DataCollectionProtoWriter::~DataCollectionProtoWriter()
@@ -37,59 +88,188 @@ DataCollectionProtoWriter::setupVehicleData( const TriggeredCollectionSchemeData
                                              uint32_t collectionEventID )
 {
     mVehicleDataMsgCount = 0U;
+    mHasDTCData = false;
+    mDTCRelativeTime = 0;
+    mDTCCodes.clear();
+    mHasGeohash = false;
+    mColumnarEncoding = triggeredCollectionSchemeData->metaData.columnarEncoding;
+    mSignalColumnCount = 0U;
+    mSignalColumnsSize = 0U;
+    if ( mBuffer == nullptr )
+    {
+        mBuffer = mBufferPool->acquire();
+    }
+    mBuffer->clear();
 
-    mVehicleData.Clear();
-    mVehicleData.set_campaign_arn( triggeredCollectionSchemeData->metaData.collectionSchemeID );
-    mVehicleData.set_decoder_arn( triggeredCollectionSchemeData->metaData.decoderID );
-    mVehicleData.set_collection_event_id( collectionEventID );
+    const auto &campaignArn = triggeredCollectionSchemeData->metaData.collectionSchemeID;
+    const auto &decoderArn = triggeredCollectionSchemeData->metaData.decoderID;
     mTriggerTime = triggeredCollectionSchemeData->triggerTime;
-    mVehicleData.set_collection_event_time_ms_epoch( mTriggerTime );
+    size_t headerSize = getStringFieldSize( VehicleData::kCampaignArnFieldNumber, campaignArn ) +
+                        getStringFieldSize( VehicleData::kDecoderArnFieldNumber, decoderArn );
+    if ( collectionEventID != 0U )
+    {
+        headerSize +=
+            WireFormatLite::TagSize( VehicleData::kCollectionEventIdFieldNumber, WireFormatLite::TYPE_UINT32 ) +
+            WireFormatLite::UInt32Size( collectionEventID );
+    }
+    if ( mTriggerTime != 0U )
+    {
+        headerSize += WireFormatLite::TagSize( VehicleData::kCollectionEventTimeMsEpochFieldNumber,
+                                               WireFormatLite::TYPE_UINT64 ) +
+                      WireFormatLite::UInt64Size( mTriggerTime );
+    }
+
+    auto target = extendBuffer( headerSize );
+    target = writeStringField( VehicleData::kCampaignArnFieldNumber, campaignArn, target );
+    target = writeStringField( VehicleData::kDecoderArnFieldNumber, decoderArn, target );
+    if ( collectionEventID != 0U )
+    {
+        target =
+            WireFormatLite::WriteUInt32ToArray( VehicleData::kCollectionEventIdFieldNumber, collectionEventID, target );
+    }
+    if ( mTriggerTime != 0U )
+    {
+        WireFormatLite::WriteUInt64ToArray( VehicleData::kCollectionEventTimeMsEpochFieldNumber, mTriggerTime, target );
+    }
+}
+
+size_t
+DataCollectionProtoWriter::getCapturedSignalBodySize( const CollectedSignal &msg ) const
+{
+    using CapturedSignal = VehicleDataMsg::CapturedSignal;
+    auto relativeTime = static_cast<int64_t>( msg.receiveTime ) - static_cast<int64_t>( mTriggerTime );
+    // The double value is part of a oneof, so it is encoded even if it is 0
+    size_t bodySize = WireFormatLite::TagSize( CapturedSignal::kDoubleValueFieldNumber, WireFormatLite::TYPE_DOUBLE ) +
+                      WireFormatLite::kDoubleSize;
+    if ( relativeTime != 0 )
+    {
+        bodySize += WireFormatLite::TagSize( CapturedSignal::kRelativeTimeMsFieldNumber, WireFormatLite::TYPE_SINT64 ) +
+                    WireFormatLite::SInt64Size( relativeTime );
+    }
+    if ( msg.signalID != 0U )
+    {
+        bodySize += WireFormatLite::TagSize( CapturedSignal::kSignalIdFieldNumber, WireFormatLite::TYPE_UINT32 ) +
+                    WireFormatLite::UInt32Size( msg.signalID );
+    }
+    return bodySize;
 }
+
+size_t
+DataCollectionProtoWriter::getCanFrameBodySize( const CollectedCanRawFrame &msg, const std::string &interfaceID ) const
+{
+    using CanFrame = VehicleDataMsg::CanFrame;
+    auto relativeTime = static_cast<int64_t>( msg.receiveTime ) - static_cast<int64_t>( mTriggerTime );
+    size_t bodySize = getStringFieldSize( CanFrame::kInterfaceIdFieldNumber, interfaceID );
+    if ( relativeTime != 0 )
+    {
+        bodySize += WireFormatLite::TagSize( CanFrame::kRelativeTimeMsFieldNumber, WireFormatLite::TYPE_SINT64 ) +
+                    WireFormatLite::SInt64Size( relativeTime );
+    }
+    if ( msg.frameID != 0U )
+    {
+        bodySize += WireFormatLite::TagSize( CanFrame::kMessageIdFieldNumber, WireFormatLite::TYPE_UINT32 ) +
+                    WireFormatLite::UInt32Size( msg.frameID );
+    }
+    if ( msg.size != 0U )
+    {
+        bodySize += getLengthDelimitedFieldSize( CanFrame::kByteValuesFieldNumber, msg.size );
+    }
+    return bodySize;
+}
+
 void
 DataCollectionProtoWriter::append( const CollectedSignal &msg )
 {
-    auto capturedSignals = mVehicleData.add_captured_signals();
+    using CapturedSignal = VehicleDataMsg::CapturedSignal;
     mVehicleDataMsgCount++;
-    capturedSignals->set_relative_time_ms( static_cast<int64_t>( msg.receiveTime ) -
-                                           static_cast<int64_t>( mTriggerTime ) );
-    capturedSignals->set_signal_id( msg.signalID );
-    capturedSignals->set_double_value( msg.value );
+    auto relativeTime = static_cast<int64_t>( msg.receiveTime ) - static_cast<int64_t>( mTriggerTime );
+    if ( mColumnarEncoding )
+    {
+        auto index = findSignalColumn( msg.signalID );
+        if ( index == mSignalColumnCount )
+        {
+            if ( mSignalColumnCount == mSignalColumns.size() )
+            {
+                mSignalColumns.emplace_back();
+            }
+            mSignalColumns[index].reset( msg.signalID );
+            mSignalColumnCount++;
+        }
+        auto &column = mSignalColumns[index];
+        // Columns without samples are not encoded
+        auto previousSize =
+            ( column.getSampleCount() == 0U ) ? 0U : getSignalColumnFieldSize( getSignalColumnBodySize( column ) );
+        column.append( relativeTime, msg.value );
+        mSignalColumnsSize =
+            mSignalColumnsSize - previousSize + getSignalColumnFieldSize( getSignalColumnBodySize( column ) );
+        mLastSignalColumn = index;
+        return;
+    }
+    auto bodySize = getCapturedSignalBodySize( msg );
+
+    const int fieldNumber = VehicleData::kCapturedSignalsFieldNumber;
+    auto target = extendBuffer( getLengthDelimitedFieldSize( fieldNumber, bodySize ) );
+    target = writeLengthDelimitedHeader( fieldNumber, bodySize, target );
+    if ( relativeTime != 0 )
+    {
+        target = WireFormatLite::WriteSInt64ToArray( CapturedSignal::kRelativeTimeMsFieldNumber, relativeTime, target );
+    }
+    if ( msg.signalID != 0U )
+    {
+        target = WireFormatLite::WriteUInt32ToArray( CapturedSignal::kSignalIdFieldNumber, msg.signalID, target );
+    }
+    WireFormatLite::WriteDoubleToArray( CapturedSignal::kDoubleValueFieldNumber, msg.value, target );
 }
 
 void
 DataCollectionProtoWriter::append( const CollectedCanRawFrame &msg )
 {
-    auto rawCanFrames = mVehicleData.add_can_frames();
+    using CanFrame = VehicleDataMsg::CanFrame;
     mVehicleDataMsgCount++;
-    rawCanFrames->set_relative_time_ms( static_cast<int64_t>( msg.receiveTime ) -
-                                        static_cast<int64_t>( mTriggerTime ) );
-    rawCanFrames->set_message_id( msg.frameID );
-    rawCanFrames->set_interface_id( mIDTranslator.getInterfaceID( msg.channelId ) );
-    rawCanFrames->set_byte_values( reinterpret_cast<char const *>( msg.data.data() ), msg.size );
+    auto relativeTime = static_cast<int64_t>( msg.receiveTime ) - static_cast<int64_t>( mTriggerTime );
+    const auto interfaceID = mIDTranslator.getInterfaceID( msg.channelId );
+    auto bodySize = getCanFrameBodySize( msg, interfaceID );
+
+    const int fieldNumber = VehicleData::kCanFramesFieldNumber;
+    auto target = extendBuffer( getLengthDelimitedFieldSize( fieldNumber, bodySize ) );
+    target = writeLengthDelimitedHeader( fieldNumber, bodySize, target );
+    if ( relativeTime != 0 )
+    {
+        target = WireFormatLite::WriteSInt64ToArray( CanFrame::kRelativeTimeMsFieldNumber, relativeTime, target );
+    }
+    if ( msg.frameID != 0U )
+    {
+        target = WireFormatLite::WriteUInt32ToArray( CanFrame::kMessageIdFieldNumber, msg.frameID, target );
+    }
+    target = writeStringField( CanFrame::kInterfaceIdFieldNumber, interfaceID, target );
+    if ( msg.size != 0U )
+    {
+        target = writeLengthDelimitedHeader( CanFrame::kByteValuesFieldNumber, msg.size, target );
+        CodedOutputStream::WriteRawToArray( msg.data.data(), static_cast<int>( msg.size ), target );
+    }
 }
 
 void
 DataCollectionProtoWriter::setupDTCInfo( const DTCInfo &msg )
 {
-    auto dtcData = mVehicleData.mutable_dtc_data();
-    dtcData->set_relative_time_ms( static_cast<int64_t>( msg.receiveTime ) - static_cast<int64_t>( mTriggerTime ) );
+    mHasDTCData = true;
+    mDTCRelativeTime = static_cast<int64_t>( msg.receiveTime ) - static_cast<int64_t>( mTriggerTime );
 }
 
 void
 DataCollectionProtoWriter::append( const std::string &dtc )
 {
-    auto dtcData = mVehicleData.mutable_dtc_data();
+    mHasDTCData = true;
     mVehicleDataMsgCount++;
-    dtcData->add_active_dtc_codes( dtc );
+    mDTCCodes.emplace_back( dtc );
 }
 
 void
 DataCollectionProtoWriter::append( const GeohashInfo &geohashInfo )
 {
-    auto geohashProto = mVehicleData.mutable_geohash();
+    mHasGeohash = true;
     mVehicleDataMsgCount++;
-    geohashProto->set_geohash_string( geohashInfo.mGeohashString );
-    geohashProto->set_prev_reported_geohash_string( geohashInfo.mPrevReportedGeohashString );
+    mGeohashInfo = geohashInfo;
 }
 
 unsigned
@@ -98,10 +278,268 @@ DataCollectionProtoWriter::getVehicleDataMsgCount() const
     return mVehicleDataMsgCount;
 }
 
+size_t
+DataCollectionProtoWriter::getVehicleDataEncodedSize() const
+{
+    return ( ( mBuffer == nullptr ) ? 0U : mBuffer->size() ) + getTrailerSize();
+}
+
+size_t
+DataCollectionProtoWriter::getEncodedSize( const CollectedSignal &msg ) const
+{
+    if ( mColumnarEncoding )
+    {
+        auto relativeTime = static_cast<int64_t>( msg.receiveTime ) - static_cast<int64_t>( mTriggerTime );
+        size_t relativeTimesSize = 0U;
+        size_t doubleValuesSize = 0U;
+        auto index = findSignalColumn( msg.signalID );
+        if ( index == mSignalColumnCount )
+        {
+            SignalColumnEncoder newColumn;
+            newColumn.getSizesAfterAppend( relativeTime, msg.value, relativeTimesSize, doubleValuesSize );
+            return getSignalColumnFieldSize(
+                getSignalColumnBodySize( msg.signalID, 1U, relativeTimesSize, doubleValuesSize ) );
+        }
+        const auto &column = mSignalColumns[index];
+        column.getSizesAfterAppend( relativeTime, msg.value, relativeTimesSize, doubleValuesSize );
+        return getSignalColumnFieldSize( getSignalColumnBodySize(
+                   column.getSignalID(), column.getSampleCount() + 1U, relativeTimesSize, doubleValuesSize ) ) -
+               getSignalColumnFieldSize( getSignalColumnBodySize( column ) );
+    }
+    return getLengthDelimitedFieldSize( VehicleData::kCapturedSignalsFieldNumber, getCapturedSignalBodySize( msg ) );
+}
+
+size_t
+DataCollectionProtoWriter::getEncodedSize( const CollectedCanRawFrame &msg ) const
+{
+    return getLengthDelimitedFieldSize( VehicleData::kCanFramesFieldNumber,
+                                        getCanFrameBodySize( msg, mIDTranslator.getInterfaceID( msg.channelId ) ) );
+}
+
+size_t
+DataCollectionProtoWriter::getEncodedSize( const std::string &dtc, const DTCInfo &dtcInfo ) const
+{
+    using DtcData = VehicleDataMsg::DtcData;
+    size_t codeSize = WireFormatLite::TagSize( DtcData::kActiveDtcCodesFieldNumber, WireFormatLite::TYPE_STRING ) +
+                      WireFormatLite::StringSize( dtc );
+    if ( !mHasDTCData )
+    {
+        // The DTC data sub message including its relative time is added with the first code
+        auto relativeTime = static_cast<int64_t>( dtcInfo.receiveTime ) - static_cast<int64_t>( mTriggerTime );
+        size_t bodySize = codeSize;
+        if ( relativeTime != 0 )
+        {
+            bodySize += WireFormatLite::TagSize( DtcData::kRelativeTimeMsFieldNumber, WireFormatLite::TYPE_SINT64 ) +
+                        WireFormatLite::SInt64Size( relativeTime );
+        }
+        return getLengthDelimitedFieldSize( VehicleData::kDtcDataFieldNumber, bodySize );
+    }
+    // The length prefix of the sub message might grow as well
+    auto currentBodySize = getDTCDataSize();
+    return codeSize + CodedOutputStream::VarintSize32( static_cast<uint32_t>( currentBodySize + codeSize ) ) -
+           CodedOutputStream::VarintSize32( static_cast<uint32_t>( currentBodySize ) );
+}
+
+size_t
+DataCollectionProtoWriter::getEncodedSize( const GeohashInfo &geohashInfo ) const
+{
+    using Geohash = VehicleDataMsg::Geohash;
+    size_t bodySize =
+        getStringFieldSize( Geohash::kGeohashStringFieldNumber, geohashInfo.mGeohashString ) +
+        getStringFieldSize( Geohash::kPrevReportedGeohashStringFieldNumber, geohashInfo.mPrevReportedGeohashString );
+    return getLengthDelimitedFieldSize( VehicleData::kGeohashFieldNumber, bodySize );
+}
+
 bool
 DataCollectionProtoWriter::serializeVehicleData( std::string *out ) const
 {
-    return mVehicleData.SerializeToString( out );
+    if ( out == nullptr )
+    {
+        return false;
+    }
+    size_t streamedSize = ( mBuffer == nullptr ) ? 0U : mBuffer->size();
+    out->resize( streamedSize + getTrailerSize() );
+    auto target = reinterpret_cast<uint8_t *>( &( *out )[0] );
+    if ( streamedSize > 0U )
+    {
+        target = CodedOutputStream::WriteRawToArray( mBuffer->data(), static_cast<int>( streamedSize ), target );
+    }
+    writeTrailer( target );
+    return true;
+}
+
+std::shared_ptr<PayloadBufferPool::Buffer>
+DataCollectionProtoWriter::finalizeVehicleData()
+{
+    writeTrailer( extendBuffer( getTrailerSize() ) );
+    mHasDTCData = false;
+    mDTCCodes.clear();
+    mHasGeohash = false;
+    mSignalColumnCount = 0U;
+    mSignalColumnsSize = 0U;
+    return std::move( mBuffer );
+}
+
+uint8_t *
+DataCollectionProtoWriter::extendBuffer( size_t size )
+{
+    if ( mBuffer == nullptr )
+    {
+        mBuffer = mBufferPool->acquire();
+    }
+    auto offset = mBuffer->size();
+    mBuffer->resize( offset + size );
+    return mBuffer->data() + offset;
+}
+
+size_t
+DataCollectionProtoWriter::getDTCDataSize() const
+{
+    using DtcData = VehicleDataMsg::DtcData;
+    size_t bodySize = 0U;
+    if ( mDTCRelativeTime != 0 )
+    {
+        bodySize += WireFormatLite::TagSize( DtcData::kRelativeTimeMsFieldNumber, WireFormatLite::TYPE_SINT64 ) +
+                    WireFormatLite::SInt64Size( mDTCRelativeTime );
+    }
+    for ( const auto &dtc : mDTCCodes )
+    {
+        // Repeated strings are encoded even if empty
+        bodySize += WireFormatLite::TagSize( DtcData::kActiveDtcCodesFieldNumber, WireFormatLite::TYPE_STRING ) +
+                    WireFormatLite::StringSize( dtc );
+    }
+    return bodySize;
+}
+
+size_t
+DataCollectionProtoWriter::getGeohashSize() const
+{
+    using Geohash = VehicleDataMsg::Geohash;
+    return getStringFieldSize( Geohash::kGeohashStringFieldNumber, mGeohashInfo.mGeohashString ) +
+           getStringFieldSize( Geohash::kPrevReportedGeohashStringFieldNumber,
+                               mGeohashInfo.mPrevReportedGeohashString );
+}
+
+size_t
+DataCollectionProtoWriter::getSignalColumnBodySize( uint32_t signalID,
+                                                    uint32_t sampleCount,
+                                                    size_t relativeTimesSize,
+                                                    size_t doubleValuesSize )
+{
+    using SignalColumn = VehicleDataMsg::SignalColumn;
+    size_t bodySize = 0U;
+    if ( signalID != 0U )
+    {
+        bodySize += WireFormatLite::TagSize( SignalColumn::kSignalIdFieldNumber, WireFormatLite::TYPE_UINT32 ) +
+                    WireFormatLite::UInt32Size( signalID );
+    }
+    if ( sampleCount != 0U )
+    {
+        bodySize += WireFormatLite::TagSize( SignalColumn::kSampleCountFieldNumber, WireFormatLite::TYPE_UINT32 ) +
+                    WireFormatLite::UInt32Size( sampleCount );
+    }
+    if ( relativeTimesSize != 0U )
+    {
+        bodySize += getLengthDelimitedFieldSize( SignalColumn::kRelativeTimeMsFieldNumber, relativeTimesSize );
+    }
+    if ( doubleValuesSize != 0U )
+    {
+        bodySize += getLengthDelimitedFieldSize( SignalColumn::kDoubleValuesFieldNumber, doubleValuesSize );
+    }
+    return bodySize;
+}
+
+size_t
+DataCollectionProtoWriter::getSignalColumnBodySize( const SignalColumnEncoder &column )
+{
+    return getSignalColumnBodySize( column.getSignalID(),
+                                    column.getSampleCount(),
+                                    column.getRelativeTimes().size(),
+                                    column.getDoubleValues().size() );
+}
+
+size_t
+DataCollectionProtoWriter::findSignalColumn( uint32_t signalID ) const
+{
+    if ( ( mLastSignalColumn < mSignalColumnCount ) && ( mSignalColumns[mLastSignalColumn].getSignalID() == signalID ) )
+    {
+        return mLastSignalColumn;
+    }
+    for ( size_t i = 0; i < mSignalColumnCount; i++ )
+    {
+        if ( mSignalColumns[i].getSignalID() == signalID )
+        {
+            mLastSignalColumn = i;
+            return i;
+        }
+    }
+    return mSignalColumnCount;
+}
+
+size_t
+DataCollectionProtoWriter::getTrailerSize() const
+{
+    size_t trailerSize = mSignalColumnsSize;
+    if ( mHasDTCData )
+    {
+        trailerSize += getLengthDelimitedFieldSize( VehicleData::kDtcDataFieldNumber, getDTCDataSize() );
+    }
+    if ( mHasGeohash )
+    {
+        trailerSize += getLengthDelimitedFieldSize( VehicleData::kGeohashFieldNumber, getGeohashSize() );
+    }
+    return trailerSize;
+}
+
+uint8_t *
+DataCollectionProtoWriter::writeTrailer( uint8_t *target ) const
+{
+    for ( size_t i = 0; i < mSignalColumnCount; i++ )
+    {
+        using SignalColumn = VehicleDataMsg::SignalColumn;
+        const auto &column = mSignalColumns[i];
+        const auto &relativeTimes = column.getRelativeTimes();
+        const auto &doubleValues = column.getDoubleValues();
+        target = writeLengthDelimitedHeader(
+            VehicleData::kSignalColumnsFieldNumber, getSignalColumnBodySize( column ), target );
+        if ( column.getSignalID() != 0U )
+        {
+            target =
+                WireFormatLite::WriteUInt32ToArray( SignalColumn::kSignalIdFieldNumber, column.getSignalID(), target );
+        }
+        // Columns in use have at least one sample, so none of the other fields is empty
+        target = WireFormatLite::WriteUInt32ToArray(
+            SignalColumn::kSampleCountFieldNumber, column.getSampleCount(), target );
+        target = writeLengthDelimitedHeader( SignalColumn::kRelativeTimeMsFieldNumber, relativeTimes.size(), target );
+        target = CodedOutputStream::WriteRawToArray(
+            relativeTimes.data(), static_cast<int>( relativeTimes.size() ), target );
+        target = writeLengthDelimitedHeader( SignalColumn::kDoubleValuesFieldNumber, doubleValues.size(), target );
+        target = CodedOutputStream::WriteRawToArray(
+            doubleValues.data(), static_cast<int>( doubleValues.size() ), target );
+    }
+    if ( mHasDTCData )
+    {
+        using DtcData = VehicleDataMsg::DtcData;
+        target = writeLengthDelimitedHeader( VehicleData::kDtcDataFieldNumber, getDTCDataSize(), target );
+        if ( mDTCRelativeTime != 0 )
+        {
+            target =
+                WireFormatLite::WriteSInt64ToArray( DtcData::kRelativeTimeMsFieldNumber, mDTCRelativeTime, target );
+        }
+        for ( const auto &dtc : mDTCCodes )
+        {
+            target = WireFormatLite::WriteStringToArray( DtcData::kActiveDtcCodesFieldNumber, dtc, target );
+        }
+    }
+    if ( mHasGeohash )
+    {
+        using Geohash = VehicleDataMsg::Geohash;
+        target = writeLengthDelimitedHeader( VehicleData::kGeohashFieldNumber, getGeohashSize(), target );
+        target = writeStringField( Geohash::kGeohashStringFieldNumber, mGeohashInfo.mGeohashString, target );
+        target = writeStringField(
+            Geohash::kPrevReportedGeohashStringFieldNumber, mGeohashInfo.mPrevReportedGeohashString, target );
+    }
+    return target;
 }
 
 } // namespace DataManagement
@@ -13,8 +13,9 @@
 
 // Includes
 #include "DataCollectionSender.h"
+#include "TraceModule.h"
+#include <algorithm>
 #include <boost/filesystem.hpp>
-#include <snappy.h>
 #include <sstream>
 
 namespace Aws
@@ -24,18 +25,35 @@ namespace IoTFleetWise
 namespace DataManagement
 {
 
+constexpr size_t PayloadSizeStatistics::NUMBER_OF_FILL_BUCKETS;
+constexpr double DataCollectionSender::COMPRESSION_RATIO_MARGIN;
+constexpr double DataCollectionSender::COMPRESSION_RATIO_WEIGHT;
+
 DataCollectionSender::DataCollectionSender( std::shared_ptr<ISender> sender,
                                             bool jsonOutputEnabled,
                                             unsigned maxMessageCount,
                                             CANInterfaceIDTranslator &canIDTranslator,
-                                            std::string persistencyPath )
+                                            std::string persistencyPath,
+                                            size_t maxPayloadSize,
+                                            std::shared_ptr<const PayloadCodec> payloadCodec )
     : mSender( std::move( sender ) )
     , mJsonOutputEnabled( jsonOutputEnabled )
-    , mProtoWriter( canIDTranslator )
+    , mBufferPool( std::make_shared<PayloadBufferPool>() )
+    , mPayloadCodec( std::move( payloadCodec ) )
+    , mProtoWriter( canIDTranslator, mBufferPool )
     , mJsonWriter( std::move( persistencyPath ) )
 {
+    if ( mPayloadCodec == nullptr )
+    {
+        mPayloadCodec = std::make_shared<PayloadCodec>();
+    }
     mTransmitThreshold = ( maxMessageCount > 0U ) ? maxMessageCount : UINT_MAX;
     mCollectionEventID = 0U;
+    mMaxPayloadSize = ( mSender != nullptr ) ? mSender->getMaxSendSize() : SIZE_MAX;
+    if ( ( maxPayloadSize > 0U ) && ( maxPayloadSize < mMaxPayloadSize ) )
+    {
+        mMaxPayloadSize = maxPayloadSize;
+    }
 }
 
 void
@@ -47,6 +65,19 @@ DataCollectionSender::send( const TriggeredCollectionSchemeDataPtr triggeredColl
         return;
     }
 
+    TraceModule::get().addLatencyToHistogram( TraceHistogram::TRIGGER_TO_SENDER_LATENCY,
+                                              triggeredCollectionSchemeDataPtr->triggerTime,
+                                              mClock->timeSinceEpochMs() );
+    mNewestReceiveTime = 0;
+    for ( const auto &signal : triggeredCollectionSchemeDataPtr->signals )
+    {
+        mNewestReceiveTime = std::max( mNewestReceiveTime, signal.receiveTime );
+    }
+    for ( const auto &canFrame : triggeredCollectionSchemeDataPtr->canFrames )
+    {
+        mNewestReceiveTime = std::max( mNewestReceiveTime, canFrame.receiveTime );
+    }
+
     // Assign a unique event id to the edge to cloud payload
     mCollectionEventID = triggeredCollectionSchemeDataPtr->eventID;
 
@@ -71,13 +102,13 @@ DataCollectionSender::send( const TriggeredCollectionSchemeDataPtr triggeredColl
         }
         if ( mSendDestination == SendDestination::MQTT )
         {
-            mProtoWriter.append( signal );
-            if ( mProtoWriter.getVehicleDataMsgCount() >= mTransmitThreshold )
+            if ( isPayloadFull( mProtoWriter.getEncodedSize( signal ) ) )
             {
                 serializeAndTransmit();
                 // Setup the next payload chunk
                 mProtoWriter.setupVehicleData( triggeredCollectionSchemeDataPtr, mCollectionEventID );
             }
+            mProtoWriter.append( signal );
         }
     }
 
@@ -90,13 +121,13 @@ DataCollectionSender::send( const TriggeredCollectionSchemeDataPtr triggeredColl
         }
         if ( mSendDestination == SendDestination::MQTT )
         {
-            mProtoWriter.append( canFrame );
-            if ( mProtoWriter.getVehicleDataMsgCount() >= mTransmitThreshold )
+            if ( isPayloadFull( mProtoWriter.getEncodedSize( canFrame ) ) )
             {
                 serializeAndTransmit();
                 // Setup the next payload chunk
                 mProtoWriter.setupVehicleData( triggeredCollectionSchemeDataPtr, mCollectionEventID );
             }
+            mProtoWriter.append( canFrame );
         }
     }
 
@@ -105,22 +136,20 @@ DataCollectionSender::send( const TriggeredCollectionSchemeDataPtr triggeredColl
         // Add DTC info to the payload
         if ( triggeredCollectionSchemeDataPtr->mDTCInfo.hasItems() )
         {
-            mProtoWriter.setupDTCInfo( triggeredCollectionSchemeDataPtr->mDTCInfo );
-            const auto &dtcCodes = triggeredCollectionSchemeDataPtr->mDTCInfo.mDTCCodes;
+            const auto &dtcInfo = triggeredCollectionSchemeDataPtr->mDTCInfo;
 
             // Iterate through all the DTC codes and add to the protobuf
-            for ( const auto &dtc : dtcCodes )
+            for ( const auto &dtc : dtcInfo.mDTCCodes )
             {
-                mProtoWriter.append( dtc );
-
-                if ( mProtoWriter.getVehicleDataMsgCount() >= mTransmitThreshold )
+                if ( isPayloadFull( mProtoWriter.getEncodedSize( dtc, dtcInfo ) ) )
                 {
                     serializeAndTransmit();
                     // Setup the next payload chunk
                     mProtoWriter.setupVehicleData( triggeredCollectionSchemeDataPtr, mCollectionEventID );
-                    // Setup DTC metadata for the next payload
-                    mProtoWriter.setupDTCInfo( triggeredCollectionSchemeDataPtr->mDTCInfo );
                 }
+                // Setup DTC metadata, which is needed again after a new payload chunk was started
+                mProtoWriter.setupDTCInfo( dtcInfo );
+                mProtoWriter.append( dtc );
             }
         }
     }
@@ -134,13 +163,13 @@ DataCollectionSender::send( const TriggeredCollectionSchemeDataPtr triggeredColl
         }
         if ( mSendDestination == SendDestination::MQTT )
         {
-            mProtoWriter.append( triggeredCollectionSchemeDataPtr->mGeohashInfo );
-            if ( mProtoWriter.getVehicleDataMsgCount() >= mTransmitThreshold )
+            if ( isPayloadFull( mProtoWriter.getEncodedSize( triggeredCollectionSchemeDataPtr->mGeohashInfo ) ) )
             {
                 serializeAndTransmit();
                 // Setup the next payload chunk
                 mProtoWriter.setupVehicleData( triggeredCollectionSchemeDataPtr, mCollectionEventID );
             }
+            mProtoWriter.append( triggeredCollectionSchemeDataPtr->mGeohashInfo );
         }
     }
 
@@ -161,8 +190,62 @@ DataCollectionSender::send( const TriggeredCollectionSchemeDataPtr triggeredColl
     }
 }
 
+bool
+DataCollectionSender::isPayloadFull( size_t nextMessageSize ) const
+{
+    auto messageCount = mProtoWriter.getVehicleDataMsgCount();
+    if ( messageCount == 0U )
+    {
+        // A message which alone exceeds the limit is sent anyway
+        return false;
+    }
+    if ( messageCount >= mTransmitThreshold )
+    {
+        return true;
+    }
+    return estimatePayloadSize( mProtoWriter.getVehicleDataEncodedSize() + nextMessageSize ) > mMaxPayloadSize;
+}
+
+size_t
+DataCollectionSender::estimatePayloadSize( size_t encodedSize ) const
+{
+    if ( !mCollectionSchemeParams.compression )
+    {
+        return encodedSize;
+    }
+    return static_cast<size_t>( static_cast<double>( encodedSize ) * mCompressionRatio * COMPRESSION_RATIO_MARGIN );
+}
+
+void
+DataCollectionSender::updatePayloadSizeStatistics( size_t payloadSize )
+{
+    auto &stats = mPayloadSizeStatistics;
+    stats.payloadCount++;
+    stats.totalBytes += payloadSize;
+    stats.minBytes = ( stats.payloadCount == 1U ) ? payloadSize : std::min<uint64_t>( stats.minBytes, payloadSize );
+    stats.maxBytes = std::max<uint64_t>( stats.maxBytes, payloadSize );
+    // The buckets split the limit in equal parts. Payloads exceeding the limit count into the last bucket.
+    const size_t oversizeBucket = PayloadSizeStatistics::NUMBER_OF_FILL_BUCKETS - 1U;
+    size_t bucket = oversizeBucket;
+    if ( payloadSize <= mMaxPayloadSize )
+    {
+        bucket = std::min( ( payloadSize * oversizeBucket ) / mMaxPayloadSize, oversizeBucket - 1U );
+    }
+    stats.fillBuckets[bucket]++;
+
+    TraceModule::get().setVariable( TraceVariable::DS_PAYLOAD_SIZE, payloadSize );
+    TraceModule::get().incrementVariable(
+        static_cast<TraceVariable>( toUType( TraceVariable::DS_PAYLOAD_FILL_25 ) + bucket ) );
+}
+
+PayloadSizeStatistics
+DataCollectionSender::getPayloadSizeStatistics() const
+{
+    return mPayloadSizeStatistics;
+}
+
 ConnectivityError
-DataCollectionSender::transmit()
+DataCollectionSender::transmit( std::shared_ptr<PayloadBufferPool::Buffer> payload )
 {
     if ( mSendDestination != SendDestination::MQTT )
     {
@@ -170,27 +253,38 @@ DataCollectionSender::transmit()
                        "Upload destination is not  set to AWS IoT Core. Skipping this request" );
         return ConnectivityError::Success;
     }
+    if ( payload == nullptr )
+    {
+        return ConnectivityError::WrongInputData;
+    }
 
-    std::string payloadData;
     // compress the data before transmitting if specified in the collectionScheme
     if ( mCollectionSchemeParams.compression )
     {
         mLogger.trace( "DataCollectionSender::transmit",
                        "Compress the payload before transmitting since compression flag is true" );
-        if ( snappy::Compress( mProtoOutput.data(), mProtoOutput.size(), &payloadData ) == 0u )
+        // The codecs can not compress in place, so a second pooled buffer is used and the uncompressed one
+        // goes back to the pool right away
+        auto compressedPayload = mBufferPool->acquire();
+        compressedPayload->resize( mPayloadCodec->getMaxCompressedSize( payload->size() ) );
+        auto compressedSize = mPayloadCodec->compress(
+            payload->data(), payload->size(), compressedPayload->data(), compressedPayload->size() );
+        if ( compressedSize == 0U )
         {
             mLogger.trace( "DataCollectionSender::transmit", "Error in compressing the payload" );
             return ConnectivityError::WrongInputData;
         }
-    }
-    else
-    {
-        // Using payloadData as a container to send(), hence assign it to original uncompressed payload
-        payloadData = mProtoOutput;
+        compressedPayload->resize( compressedSize );
+        // Track how well the data compresses to predict the compressed size of the next payloads
+        auto ratio = static_cast<double>( compressedSize ) / static_cast<double>( payload->size() );
+        mCompressionRatio =
+            ( COMPRESSION_RATIO_WEIGHT * ratio ) + ( ( 1.0 - COMPRESSION_RATIO_WEIGHT ) * mCompressionRatio );
+        payload = std::move( compressedPayload );
     }
 
-    ConnectivityError ret = mSender->send(
-        reinterpret_cast<const uint8_t *>( payloadData.data() ), payloadData.size(), mCollectionSchemeParams );
+    auto payloadSize = payload->size();
+    updatePayloadSizeStatistics( payloadSize );
+    ConnectivityError ret = mSender->sendBuffer( std::move( payload ), mCollectionSchemeParams );
     if ( ret != ConnectivityError::Success )
     {
         mLogger.error( "DataCollectionSender::transmit",
@@ -199,8 +293,13 @@ DataCollectionSender::transmit()
     else
     {
         mLogger.info( "DataCollectionSender::transmit",
-                      "A Payload of size: " + std::to_string( payloadData.length() ) +
+                      "A Payload of size: " + std::to_string( payloadSize ) +
                           " bytes has been unloaded to AWS IoT Core" );
+        if ( mNewestReceiveTime != 0 )
+        {
+            TraceModule::get().addLatencyToHistogram(
+                TraceHistogram::CAN_TO_PUBLISH_LATENCY, mNewestReceiveTime, mClock->timeSinceEpochMs() );
+        }
     }
     return ret;
 }
@@ -234,15 +333,16 @@ DataCollectionSender::serializeAndTransmit()
         return;
     }
 
-    // Note: a class member is used to store the serialized proto output to avoid heap fragmentation
-    if ( !mProtoWriter.serializeVehicleData( &mProtoOutput ) )
+    // Note: the payload buffers come from a pool and are returned to it once sent, to avoid heap fragmentation
+    auto payload = mProtoWriter.finalizeVehicleData();
+    if ( payload == nullptr )
     {
         mLogger.error( "DataCollectionSender::serializeAndTransmit", "serialization failed" );
     }
     else
     {
         // transmit the data to the cloud
-        auto res = transmit();
+        auto res = transmit( std::move( payload ) );
         if ( res != ConnectivityError::Success )
         {
             mLogger.error( "DataCollectionSender::serializeAndTransmit",
@@ -0,0 +1,80 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+// Includes
+#include "PayloadBufferPool.h"
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace DataManagement
+{
+
+constexpr size_t PayloadBufferPool::DEFAULT_MAX_POOLED_BUFFERS;
+
+PayloadBufferPool::PayloadBufferPool( size_t maxPooledBuffers )
+    : mState( std::make_shared<State>() )
+{
+    mState->mMaxPooledBuffers = maxPooledBuffers;
+    mState->mIdleBuffers.reserve( maxPooledBuffers );
+}
+
+std::shared_ptr<PayloadBufferPool::Buffer>
+PayloadBufferPool::acquire()
+{
+    std::unique_ptr<Buffer> buffer;
+    {
+        std::lock_guard<std::mutex> lock( mState->mMutex );
+        if ( !mState->mIdleBuffers.empty() )
+        {
+            buffer = std::move( mState->mIdleBuffers.back() );
+            mState->mIdleBuffers.pop_back();
+        }
+    }
+    if ( buffer == nullptr )
+    {
+        buffer = std::make_unique<Buffer>();
+    }
+    buffer->clear();
+    std::weak_ptr<State> weakState = mState;
+    return std::shared_ptr<Buffer>( buffer.release(),
+                                    [weakState]( Buffer *released ) { release( weakState, released ); } );
+}
+
+size_t
+PayloadBufferPool::getPooledBufferCount() const
+{
+    std::lock_guard<std::mutex> lock( mState->mMutex );
+    return mState->mIdleBuffers.size();
+}
+
+void
+PayloadBufferPool::release( const std::weak_ptr<State> &weakState, Buffer *buffer )
+{
+    std::unique_ptr<Buffer> owned( buffer );
+    auto state = weakState.lock();
+    if ( state == nullptr )
+    {
+        return;
+    }
+    std::lock_guard<std::mutex> lock( state->mMutex );
+    if ( state->mIdleBuffers.size() < state->mMaxPooledBuffers )
+    {
+        state->mIdleBuffers.emplace_back( std::move( owned ) );
+    }
+}
+
+} // namespace DataManagement
+} // namespace IoTFleetWise
+} // namespace Aws
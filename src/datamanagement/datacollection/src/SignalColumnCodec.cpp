@@ -0,0 +1,362 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+// Includes
+#include "SignalColumnCodec.h"
+#include <algorithm>
+#include <cstring>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace DataManagement
+{
+
+namespace
+{
+
+constexpr uint32_t BITS_PER_SAMPLE = 64;
+// The leading zeros of an XOR value are stored with 5 bits
+constexpr uint32_t MAX_LEADING_ZEROS = 31;
+constexpr uint32_t LEADING_ZEROS_BITS = 5;
+constexpr uint32_t LENGTH_BITS = 6;
+
+// Delta of delta buckets: the prefix and the number of bits of the zigzag encoded value minus 1
+struct TimeBucket
+{
+    uint64_t prefix;
+    uint32_t prefixLength;
+    uint32_t valueLength;
+};
+constexpr TimeBucket TIME_BUCKETS[] = { { 0x2, 2, 7 }, { 0x6, 3, 9 }, { 0xE, 4, 12 } };
+constexpr TimeBucket TIME_BUCKET_LARGE = { 0xF, 4, 64 };
+
+uint64_t
+getDoubleBits( double value )
+{
+    uint64_t bits = 0;
+    std::memcpy( &bits, &value, sizeof( bits ) );
+    return bits;
+}
+
+uint64_t
+zigzagEncode( int64_t value )
+{
+    return ( static_cast<uint64_t>( value ) << 1U ) ^ static_cast<uint64_t>( value >> 63 );
+}
+
+int64_t
+zigzagDecode( uint64_t value )
+{
+    return static_cast<int64_t>( value >> 1U ) ^ -static_cast<int64_t>( value & 1U );
+}
+
+size_t
+getByteCount( size_t bitCount )
+{
+    return ( bitCount + 7U ) / 8U;
+}
+
+class BitReader
+{
+public:
+    explicit BitReader( const std::string &bytes )
+        : mBytes( bytes )
+    {
+    }
+
+    bool
+    read( uint32_t count, uint64_t &bits )
+    {
+        if ( mBitPosition + count > mBytes.size() * 8U )
+        {
+            return false;
+        }
+        bits = 0;
+        for ( uint32_t i = 0; i < count; i++ )
+        {
+            auto byte = static_cast<uint8_t>( mBytes[mBitPosition / 8U] );
+            bits = ( bits << 1U ) | ( ( byte >> ( 7U - ( mBitPosition % 8U ) ) ) & 1U );
+            mBitPosition++;
+        }
+        return true;
+    }
+
+    // Reads up to maxOnes bits until the first 0 and returns the number of 1 bits before it
+    bool
+    readOnes( uint32_t maxOnes, uint32_t &ones )
+    {
+        ones = 0;
+        uint64_t bit = 1;
+        while ( ( ones < maxOnes ) && read( 1, bit ) && ( bit == 1U ) )
+        {
+            ones++;
+        }
+        return ( ones == maxOnes ) || ( bit == 0U );
+    }
+
+private:
+    const std::string &mBytes;
+    size_t mBitPosition{ 0 };
+};
+
+} // namespace
+
+void
+SignalColumnEncoder::BitWriter::clear()
+{
+    mBytes.clear();
+    mBitCount = 0;
+}
+
+void
+SignalColumnEncoder::BitWriter::write( uint64_t bits, uint32_t count )
+{
+    while ( count > 0U )
+    {
+        if ( ( mBitCount % 8U ) == 0U )
+        {
+            mBytes.push_back( 0 );
+        }
+        auto freeBits = 8U - static_cast<uint32_t>( mBitCount % 8U );
+        auto chunk = std::min( freeBits, count );
+        auto chunkBits = ( bits >> ( count - chunk ) ) & ( ( 1U << chunk ) - 1U );
+        mBytes.back() = static_cast<uint8_t>( mBytes.back() | ( chunkBits << ( freeBits - chunk ) ) );
+        mBitCount += chunk;
+        count -= chunk;
+    }
+}
+
+void
+SignalColumnEncoder::reset( uint32_t signalID )
+{
+    mSignalID = signalID;
+    mSampleCount = 0;
+    mLastTime = 0;
+    mLastDelta = 0;
+    mLastValueBits = 0;
+    mWindowLeadingZeros = 0;
+    mWindowLength = 0;
+    mRelativeTimes.clear();
+    mDoubleValues.clear();
+}
+
+SignalColumnEncoder::Code
+SignalColumnEncoder::getTimeCode( int64_t relativeTime ) const
+{
+    Code code;
+    if ( mSampleCount == 0U )
+    {
+        code.payload = static_cast<uint64_t>( relativeTime );
+        code.payloadLength = BITS_PER_SAMPLE;
+        return code;
+    }
+    auto delta = static_cast<int64_t>( static_cast<uint64_t>( relativeTime ) - static_cast<uint64_t>( mLastTime ) );
+    auto deltaOfDelta = zigzagEncode(
+        static_cast<int64_t>( static_cast<uint64_t>( delta ) - static_cast<uint64_t>( mLastDelta ) ) );
+    code.prefixLength = 1;
+    if ( deltaOfDelta == 0U )
+    {
+        return code;
+    }
+    // The value 0 has its own code, so the buckets store the value minus 1
+    for ( const auto &bucket : TIME_BUCKETS )
+    {
+        if ( deltaOfDelta <= ( 1ULL << bucket.valueLength ) )
+        {
+            code.prefix = bucket.prefix;
+            code.prefixLength = bucket.prefixLength;
+            code.payload = deltaOfDelta - 1U;
+            code.payloadLength = bucket.valueLength;
+            return code;
+        }
+    }
+    code.prefix = TIME_BUCKET_LARGE.prefix;
+    code.prefixLength = TIME_BUCKET_LARGE.prefixLength;
+    code.payload = deltaOfDelta;
+    code.payloadLength = TIME_BUCKET_LARGE.valueLength;
+    return code;
+}
+
+SignalColumnEncoder::Code
+SignalColumnEncoder::getValueCode( uint64_t valueBits ) const
+{
+    Code code;
+    code.windowLeadingZeros = mWindowLeadingZeros;
+    code.windowLength = mWindowLength;
+    if ( mSampleCount == 0U )
+    {
+        code.payload = valueBits;
+        code.payloadLength = BITS_PER_SAMPLE;
+        return code;
+    }
+    auto xorBits = valueBits ^ mLastValueBits;
+    code.prefixLength = 1;
+    if ( xorBits == 0U )
+    {
+        return code;
+    }
+    auto leadingZeros = std::min( static_cast<uint32_t>( __builtin_clzll( xorBits ) ), MAX_LEADING_ZEROS );
+    auto trailingZeros = static_cast<uint32_t>( __builtin_ctzll( xorBits ) );
+    if ( ( mWindowLength != 0U ) && ( leadingZeros >= mWindowLeadingZeros ) &&
+         ( trailingZeros >= BITS_PER_SAMPLE - mWindowLeadingZeros - mWindowLength ) )
+    {
+        // The meaningful bits fit into the previous window
+        code.prefix = 0x2;
+        code.prefixLength = 2;
+        code.payload = xorBits >> ( BITS_PER_SAMPLE - mWindowLeadingZeros - mWindowLength );
+        code.payloadLength = mWindowLength;
+        return code;
+    }
+    auto length = BITS_PER_SAMPLE - leadingZeros - trailingZeros;
+    // A length of 64 does not fit into the length bits and is stored as 0
+    code.prefix = ( ( ( 0x3ULL << LEADING_ZEROS_BITS ) | leadingZeros ) << LENGTH_BITS ) |
+                  ( length & ( ( 1U << LENGTH_BITS ) - 1U ) );
+    code.prefixLength = 2 + LEADING_ZEROS_BITS + LENGTH_BITS;
+    code.payload = xorBits >> trailingZeros;
+    code.payloadLength = length;
+    code.windowLeadingZeros = leadingZeros;
+    code.windowLength = length;
+    return code;
+}
+
+void
+SignalColumnEncoder::append( int64_t relativeTime, double value )
+{
+    auto valueBits = getDoubleBits( value );
+    auto timeCode = getTimeCode( relativeTime );
+    auto valueCode = getValueCode( valueBits );
+    mRelativeTimes.write( timeCode.prefix, timeCode.prefixLength );
+    mRelativeTimes.write( timeCode.payload, timeCode.payloadLength );
+    mDoubleValues.write( valueCode.prefix, valueCode.prefixLength );
+    mDoubleValues.write( valueCode.payload, valueCode.payloadLength );
+
+    if ( mSampleCount > 0U )
+    {
+        mLastDelta =
+            static_cast<int64_t>( static_cast<uint64_t>( relativeTime ) - static_cast<uint64_t>( mLastTime ) );
+    }
+    mLastTime = relativeTime;
+    mLastValueBits = valueBits;
+    mWindowLeadingZeros = valueCode.windowLeadingZeros;
+    mWindowLength = valueCode.windowLength;
+    mSampleCount++;
+}
+
+void
+SignalColumnEncoder::getSizesAfterAppend( int64_t relativeTime,
+                                          double value,
+                                          size_t &relativeTimesSize,
+                                          size_t &doubleValuesSize ) const
+{
+    auto timeCode = getTimeCode( relativeTime );
+    auto valueCode = getValueCode( getDoubleBits( value ) );
+    relativeTimesSize = getByteCount( mRelativeTimes.mBitCount + timeCode.prefixLength + timeCode.payloadLength );
+    doubleValuesSize = getByteCount( mDoubleValues.mBitCount + valueCode.prefixLength + valueCode.payloadLength );
+}
+
+bool
+SignalColumnDecoder::decode( uint32_t sampleCount,
+                             const std::string &relativeTimes,
+                             const std::string &doubleValues,
+                             std::vector<int64_t> &outRelativeTimes,
+                             std::vector<double> &outValues )
+{
+    outRelativeTimes.clear();
+    outValues.clear();
+    BitReader timeReader( relativeTimes );
+    BitReader valueReader( doubleValues );
+    uint64_t time = 0;
+    uint64_t delta = 0;
+    uint64_t valueBits = 0;
+    uint32_t windowLeadingZeros = 0;
+    uint32_t windowLength = 0;
+    for ( uint32_t i = 0; i < sampleCount; i++ )
+    {
+        uint64_t bits = 0;
+        uint32_t ones = 0;
+        if ( i == 0U )
+        {
+            if ( !timeReader.read( BITS_PER_SAMPLE, time ) || !valueReader.read( BITS_PER_SAMPLE, valueBits ) )
+            {
+                return false;
+            }
+        }
+        else
+        {
+            // Relative time
+            if ( !timeReader.readOnes( TIME_BUCKET_LARGE.prefixLength, ones ) )
+            {
+                return false;
+            }
+            if ( ones == TIME_BUCKET_LARGE.prefixLength )
+            {
+                if ( !timeReader.read( TIME_BUCKET_LARGE.valueLength, bits ) )
+                {
+                    return false;
+                }
+            }
+            else if ( ones > 0U )
+            {
+                if ( !timeReader.read( TIME_BUCKETS[ones - 1U].valueLength, bits ) )
+                {
+                    return false;
+                }
+                bits++;
+            }
+            delta += static_cast<uint64_t>( zigzagDecode( bits ) );
+            time += delta;
+
+            // Value
+            if ( !valueReader.readOnes( 2, ones ) )
+            {
+                return false;
+            }
+            if ( ones == 2U )
+            {
+                uint64_t leadingZeros = 0;
+                uint64_t length = 0;
+                if ( !valueReader.read( LEADING_ZEROS_BITS, leadingZeros ) ||
+                     !valueReader.read( LENGTH_BITS, length ) )
+                {
+                    return false;
+                }
+                windowLeadingZeros = static_cast<uint32_t>( leadingZeros );
+                windowLength = ( length == 0U ) ? BITS_PER_SAMPLE : static_cast<uint32_t>( length );
+                if ( windowLeadingZeros + windowLength > BITS_PER_SAMPLE )
+                {
+                    return false;
+                }
+            }
+            if ( ones > 0U )
+            {
+                if ( ( windowLength == 0U ) || !valueReader.read( windowLength, bits ) )
+                {
+                    return false;
+                }
+                auto trailingZeros = BITS_PER_SAMPLE - windowLeadingZeros - windowLength;
+                valueBits ^= ( trailingZeros < BITS_PER_SAMPLE ) ? ( bits << trailingZeros ) : 0U;
+            }
+        }
+        double value = 0.0;
+        std::memcpy( &value, &valueBits, sizeof( value ) );
+        outRelativeTimes.push_back( static_cast<int64_t>( time ) );
+        outValues.push_back( value );
+    }
+    return true;
+}
+
+} // namespace DataManagement
+} // namespace IoTFleetWise
+} // namespace Aws
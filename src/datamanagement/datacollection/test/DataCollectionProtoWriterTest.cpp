@@ -61,7 +61,7 @@ TEST_F( DataCollectionProtoWriterTest, TestVehicleData )
 
     std::array<uint8_t, 8> data = { 1, 2, 3, 4, 5, 6, 7, 8 };
     CollectedCanRawFrame canRawFrameMsg(
-        12 /*frameId*/, 1 /*nodeId*/, testTriggerTime + 1000 /*receiveTime*/, data, 8 /*sizeof data*/ );
+        12 /*frameId*/, 1 /*nodeId*/, testTriggerTime + 1000 /*receiveTime*/, data.data(), 8 /*sizeof data*/ );
     protoWriter.append( canRawFrameMsg );
     EXPECT_EQ( protoWriter.getVehicleDataMsgCount(), 2 );
     std::string out;
@@ -184,4 +184,206 @@ TEST_F( DataCollectionProtoWriterTest, TestGeohash )
     auto geohash = vehicleDataTest.mutable_geohash();
     ASSERT_EQ( "9q9hwg28j", geohash->geohash_string() );
     ASSERT_EQ( "9q9hwg281", geohash->prev_reported_geohash_string() );
-}
\ No newline at end of file
+}
+// Test that the streamed payload is identical to the one serialized from a VehicleData message
+TEST_F( DataCollectionProtoWriterTest, TestStreamedPayloadMatchesMessageSerialization )
+{
+    CANInterfaceIDTranslator canIDTranslator;
+    canIDTranslator.add( "vcan0" );
+    canIDTranslator.add( "vcan1" );
+    auto bufferPool = std::make_shared<PayloadBufferPool>();
+    DataCollectionProtoWriter protoWriter( canIDTranslator, bufferPool );
+    std::shared_ptr<TriggeredCollectionSchemeData> triggeredCollectionSchemeDataPtr =
+        std::make_shared<TriggeredCollectionSchemeData>();
+    triggeredCollectionSchemeDataPtr->metaData.collectionSchemeID = "arn:campaign";
+    triggeredCollectionSchemeDataPtr->metaData.decoderID = "arn:decoder";
+    Timestamp testTriggerTime = 1600000000000;
+    triggeredCollectionSchemeDataPtr->triggerTime = testTriggerTime;
+
+    VehicleDataMsg::VehicleData expected{};
+    expected.set_campaign_arn( "arn:campaign" );
+    expected.set_decoder_arn( "arn:decoder" );
+    expected.set_collection_event_id( 77 );
+    expected.set_collection_event_time_ms_epoch( testTriggerTime );
+    protoWriter.setupVehicleData( triggeredCollectionSchemeDataPtr, 77 );
+
+    // Includes default values which proto3 does not encode, except the oneof double value
+    std::vector<CollectedSignal> signals = { CollectedSignal( 120, testTriggerTime + 2000, 77.88 ),
+                                             CollectedSignal( 0, testTriggerTime, 0.0 ),
+                                             CollectedSignal( 100000, testTriggerTime - 500, -1.5 ) };
+    for ( const auto &signal : signals )
+    {
+        protoWriter.append( signal );
+        auto capturedSignal = expected.add_captured_signals();
+        capturedSignal->set_relative_time_ms( static_cast<int64_t>( signal.receiveTime ) -
+                                              static_cast<int64_t>( testTriggerTime ) );
+        capturedSignal->set_signal_id( signal.signalID );
+        capturedSignal->set_double_value( signal.value );
+    }
+
+    std::array<uint8_t, 8> data = { 1, 2, 3, 4, 5, 6, 7, 8 };
+    std::vector<CollectedCanRawFrame> canFrames = {
+        CollectedCanRawFrame( 0x7FF, 1, testTriggerTime + 10, data.data(), 8 ),
+        CollectedCanRawFrame( 0, 0, testTriggerTime, data.data(), 0 ),
+        CollectedCanRawFrame( 0x18DAF158, 5, testTriggerTime, data.data(), 3 ) };
+    for ( const auto &canFrame : canFrames )
+    {
+        protoWriter.append( canFrame );
+        auto rawCanFrame = expected.add_can_frames();
+        rawCanFrame->set_relative_time_ms( static_cast<int64_t>( canFrame.receiveTime ) -
+                                           static_cast<int64_t>( testTriggerTime ) );
+        rawCanFrame->set_message_id( canFrame.frameID );
+        rawCanFrame->set_interface_id( canIDTranslator.getInterfaceID( canFrame.channelId ) );
+        rawCanFrame->set_byte_values( reinterpret_cast<const char *>( canFrame.data.data() ), canFrame.size );
+    }
+
+    GeohashInfo geohashInfo;
+    geohashInfo.mGeohashString = "9q9hwg28j";
+    protoWriter.append( geohashInfo );
+    expected.mutable_geohash()->set_geohash_string( "9q9hwg28j" );
+
+    std::string expectedProto;
+    ASSERT_TRUE( expected.SerializeToString( &expectedProto ) );
+    std::string out;
+    ASSERT_TRUE( protoWriter.serializeVehicleData( &out ) );
+    ASSERT_EQ( convertProtoToHex( out ), convertProtoToHex( expectedProto ) );
+
+    auto payload = protoWriter.finalizeVehicleData();
+    ASSERT_NE( payload, nullptr );
+    ASSERT_EQ( std::string( payload->begin(), payload->end() ), expectedProto );
+
+    // The buffer of the next payload comes from the pool once the previous one is released
+    payload.reset();
+    ASSERT_EQ( bufferPool->getPooledBufferCount(), 1 );
+    protoWriter.setupVehicleData( triggeredCollectionSchemeDataPtr, 78 );
+    ASSERT_EQ( bufferPool->getPooledBufferCount(), 0 );
+    ASSERT_EQ( protoWriter.getVehicleDataMsgCount(), 0 );
+}
+
+// Test that the predicted growth of the payload matches the actual encoded size
+TEST_F( DataCollectionProtoWriterTest, TestEncodedSizePrediction )
+{
+    CANInterfaceIDTranslator canIDTranslator;
+    canIDTranslator.add( "vcan0" );
+    DataCollectionProtoWriter protoWriter( canIDTranslator );
+    std::shared_ptr<TriggeredCollectionSchemeData> triggeredCollectionSchemeDataPtr =
+        std::make_shared<TriggeredCollectionSchemeData>();
+    triggeredCollectionSchemeDataPtr->metaData.collectionSchemeID = "123";
+    triggeredCollectionSchemeDataPtr->metaData.decoderID = "456";
+    Timestamp testTriggerTime = 1600000000000;
+    triggeredCollectionSchemeDataPtr->triggerTime = testTriggerTime;
+    protoWriter.setupVehicleData( triggeredCollectionSchemeDataPtr, 1 );
+
+    std::string out;
+    auto checkEncodedSize = [&]() {
+        ASSERT_TRUE( protoWriter.serializeVehicleData( &out ) );
+        ASSERT_EQ( protoWriter.getVehicleDataEncodedSize(), out.size() );
+    };
+    checkEncodedSize();
+
+    for ( uint32_t i = 0; i < 20; i++ )
+    {
+        CollectedSignal signal( i * 1000, testTriggerTime + i * 100, i * 1.5 );
+        auto expectedSize = protoWriter.getVehicleDataEncodedSize() + protoWriter.getEncodedSize( signal );
+        protoWriter.append( signal );
+        ASSERT_EQ( protoWriter.getVehicleDataEncodedSize(), expectedSize );
+    }
+    checkEncodedSize();
+
+    std::array<uint8_t, 8> data = { 1, 2, 3, 4, 5, 6, 7, 8 };
+    CollectedCanRawFrame canFrame( 0x123, 0, testTriggerTime + 10, data.data(), 8 );
+    auto expectedSize = protoWriter.getVehicleDataEncodedSize() + protoWriter.getEncodedSize( canFrame );
+    protoWriter.append( canFrame );
+    ASSERT_EQ( protoWriter.getVehicleDataEncodedSize(), expectedSize );
+
+    // Enough codes to grow the length prefix of the DTC sub message
+    DTCInfo dtcInfo;
+    dtcInfo.receiveTime = testTriggerTime + 2000;
+    for ( uint32_t i = 0; i < 30; i++ )
+    {
+        std::string dtc = "P0" + std::to_string( 100 + i );
+        expectedSize = protoWriter.getVehicleDataEncodedSize() + protoWriter.getEncodedSize( dtc, dtcInfo );
+        protoWriter.setupDTCInfo( dtcInfo );
+        protoWriter.append( dtc );
+        ASSERT_EQ( protoWriter.getVehicleDataEncodedSize(), expectedSize );
+    }
+
+    GeohashInfo geohashInfo;
+    geohashInfo.mGeohashString = "9q9hwg28j";
+    geohashInfo.mPrevReportedGeohashString = "9q9hwg281";
+    expectedSize = protoWriter.getVehicleDataEncodedSize() + protoWriter.getEncodedSize( geohashInfo );
+    protoWriter.append( geohashInfo );
+    ASSERT_EQ( protoWriter.getVehicleDataEncodedSize(), expectedSize );
+    checkEncodedSize();
+
+    auto payload = protoWriter.finalizeVehicleData();
+    ASSERT_EQ( payload->size(), expectedSize );
+}
+
+// Test that the signals are grouped into columns that decode to the appended samples
+TEST_F( DataCollectionProtoWriterTest, TestColumnarSignalEncoding )
+{
+    CANInterfaceIDTranslator canIDTranslator;
+    DataCollectionProtoWriter protoWriter( canIDTranslator );
+    std::shared_ptr<TriggeredCollectionSchemeData> triggeredCollectionSchemeDataPtr =
+        std::make_shared<TriggeredCollectionSchemeData>();
+    triggeredCollectionSchemeDataPtr->metaData.collectionSchemeID = "123";
+    triggeredCollectionSchemeDataPtr->metaData.decoderID = "456";
+    triggeredCollectionSchemeDataPtr->metaData.columnarEncoding = true;
+    Timestamp testTriggerTime = 1600000000000;
+    triggeredCollectionSchemeDataPtr->triggerTime = testTriggerTime;
+    protoWriter.setupVehicleData( triggeredCollectionSchemeDataPtr, 1 );
+
+    // Newest sample first like the inspection engine collects them, and one signal appended out of its group
+    std::vector<CollectedSignal> signals;
+    for ( uint32_t i = 0; i < 100; i++ )
+    {
+        signals.emplace_back( 1, testTriggerTime - i * 10, 20.0 + ( i % 3 ) * 0.5 );
+    }
+    for ( uint32_t i = 0; i < 50; i++ )
+    {
+        signals.emplace_back( 0, testTriggerTime - i * i, -1.0 * i );
+    }
+    signals.emplace_back( 1, testTriggerTime + 123456789, 1e300 );
+    for ( const auto &signal : signals )
+    {
+        auto expectedSize = protoWriter.getVehicleDataEncodedSize() + protoWriter.getEncodedSize( signal );
+        protoWriter.append( signal );
+        ASSERT_EQ( protoWriter.getVehicleDataEncodedSize(), expectedSize );
+    }
+    ASSERT_EQ( protoWriter.getVehicleDataMsgCount(), signals.size() );
+
+    auto payload = protoWriter.finalizeVehicleData();
+    VehicleDataMsg::VehicleData vehicleData;
+    ASSERT_TRUE( vehicleData.ParseFromArray( payload->data(), static_cast<int>( payload->size() ) ) );
+    ASSERT_EQ( vehicleData.captured_signals_size(), 0 );
+    ASSERT_EQ( vehicleData.signal_columns_size(), 2 );
+
+    size_t signalIndex = 0;
+    for ( const auto &column : vehicleData.signal_columns() )
+    {
+        std::vector<int64_t> relativeTimes;
+        std::vector<double> values;
+        ASSERT_TRUE( SignalColumnDecoder::decode(
+            column.sample_count(), column.relative_time_ms(), column.double_values(), relativeTimes, values ) );
+        for ( size_t i = 0; i < relativeTimes.size(); i++ )
+        {
+            // The last signal belongs to the first column
+            const auto &signal =
+                ( ( column.signal_id() == 1 ) && ( i == 100 ) ) ? signals.back() : signals[signalIndex++];
+            ASSERT_EQ( column.signal_id(), signal.signalID );
+            ASSERT_EQ( relativeTimes[i], static_cast<int64_t>( signal.receiveTime - testTriggerTime ) );
+            ASSERT_EQ( values[i], signal.value );
+        }
+    }
+    ASSERT_EQ( signalIndex, signals.size() - 1 );
+
+    // The next payload uses rows again
+    triggeredCollectionSchemeDataPtr->metaData.columnarEncoding = false;
+    protoWriter.setupVehicleData( triggeredCollectionSchemeDataPtr, 2 );
+    protoWriter.append( signals[0] );
+    payload = protoWriter.finalizeVehicleData();
+    ASSERT_TRUE( vehicleData.ParseFromArray( payload->data(), static_cast<int>( payload->size() ) ) );
+    ASSERT_EQ( vehicleData.captured_signals_size(), 1 );
+    ASSERT_EQ( vehicleData.signal_columns_size(), 0 );
+}
@@ -16,6 +16,7 @@
 #include <functional>
 #include <gtest/gtest.h>
 #include <list>
+#include <snappy.h>
 
 using namespace Aws::IoTFleetWise::DataManagement;
 
@@ -53,6 +54,22 @@ public:
     }
 };
 
+class MockBufferSender : public MockSender
+{
+public:
+    std::vector<std::shared_ptr<const std::vector<std::uint8_t>>> mBuffers;
+
+    ConnectivityError
+    sendBuffer( std::shared_ptr<const std::vector<std::uint8_t>> buffer,
+                struct Aws::IoTFleetWise::OffboardConnectivity::CollectionSchemeParams collectionSchemeParams =
+                    CollectionSchemeParams() ) override
+    {
+        static_cast<void>( collectionSchemeParams ); // Currently not implemented, hence unused
+        mBuffers.emplace_back( std::move( buffer ) );
+        return ConnectivityError::Success;
+    }
+};
+
 class DataCollectionSenderTest : public ::testing::Test
 {
 public:
@@ -122,11 +139,14 @@ public:
         }
         {
             std::array<uint8_t, 8> data = { 1, 2, 3, 4, 5, 6, 7, 8 };
-            CollectedCanRawFrame canFrames1( 12 /*frameId*/, 1 /*nodeId*/, 815 /*receiveTime*/, data, sizeof data );
+            CollectedCanRawFrame canFrames1(
+                12 /*frameId*/, 1 /*nodeId*/, 815 /*receiveTime*/, data.data(), sizeof data );
             collectedDataPtr->canFrames.push_back( canFrames1 );
-            CollectedCanRawFrame canFrames2( 4 /*frameId*/, 2 /*nodeId*/, 1100 /*receiveTime*/, data, sizeof data );
+            CollectedCanRawFrame canFrames2(
+                4 /*frameId*/, 2 /*nodeId*/, 1100 /*receiveTime*/, data.data(), sizeof data );
             collectedDataPtr->canFrames.push_back( canFrames2 );
-            CollectedCanRawFrame canFrames3( 6 /*frameId*/, 3 /*nodeId*/, 1300 /*receiveTime*/, data, sizeof data );
+            CollectedCanRawFrame canFrames3(
+                6 /*frameId*/, 3 /*nodeId*/, 1300 /*receiveTime*/, data.data(), sizeof data );
             collectedDataPtr->canFrames.push_back( canFrames3 );
         }
         {
@@ -189,3 +209,109 @@ TEST_F( DataCollectionSenderTest, TestTransmitPayload )
     };
     ASSERT_EQ( dataCollectionSender.transmit( testProto ), ConnectivityError::Success );
 }
+
+TEST_F( DataCollectionSenderTest, TestPayloadBufferIsHandedOverAndReused )
+{
+    auto mockSender = std::make_shared<MockBufferSender>();
+    CANInterfaceIDTranslator canIDTranslator;
+    DataCollectionSender dataCollectionSender( mockSender, false, 10, canIDTranslator, mTmpDir.generic_string() );
+
+    dataCollectionSender.send( collectedDataPtr );
+    ASSERT_EQ( mockSender->mBuffers.size(), 1 );
+    checkProto( mockSender->mBuffers[0]->data(), mockSender->mBuffers[0]->size() );
+    auto firstPayloadData = mockSender->mBuffers[0]->data();
+
+    // Once the sender releases the buffer it is used again for the next payload
+    mockSender->mBuffers.clear();
+    dataCollectionSender.send( collectedDataPtr );
+    ASSERT_EQ( mockSender->mBuffers.size(), 1 );
+    ASSERT_EQ( mockSender->mBuffers[0]->data(), firstPayloadData );
+    checkProto( mockSender->mBuffers[0]->data(), mockSender->mBuffers[0]->size() );
+}
+
+TEST_F( DataCollectionSenderTest, TestCompressedPayload )
+{
+    auto mockSender = std::make_shared<MockBufferSender>();
+    CANInterfaceIDTranslator canIDTranslator;
+    DataCollectionSender dataCollectionSender( mockSender, false, 10, canIDTranslator, mTmpDir.generic_string() );
+    collectedDataPtr->metaData.compress = true;
+
+    dataCollectionSender.send( collectedDataPtr );
+    ASSERT_EQ( mockSender->mBuffers.size(), 1 );
+    std::string uncompressed;
+    ASSERT_TRUE( snappy::Uncompress( reinterpret_cast<const char *>( mockSender->mBuffers[0]->data() ),
+                                     mockSender->mBuffers[0]->size(),
+                                     &uncompressed ) );
+    checkProto( reinterpret_cast<const std::uint8_t *>( uncompressed.data() ), uncompressed.size() );
+}
+
+TEST_F( DataCollectionSenderTest, TestPayloadsAreCutAtMaxPayloadSize )
+{
+    auto mockSender = std::make_shared<MockBufferSender>();
+    CANInterfaceIDTranslator canIDTranslator;
+    // No limit on the message count, so only the size limit cuts the payloads
+    DataCollectionSender dataCollectionSender( mockSender, false, 0, canIDTranslator, mTmpDir.generic_string(), 1000 );
+    collectedDataPtr->signals.clear();
+    for ( uint32_t i = 0; i < 2000; i++ )
+    {
+        collectedDataPtr->signals.emplace_back( i, 800 + i, i * 0.5 );
+    }
+
+    dataCollectionSender.send( collectedDataPtr );
+    ASSERT_GT( mockSender->mBuffers.size(), 2 );
+    size_t signalCount = 0;
+    size_t canFrameCount = 0;
+    for ( size_t i = 0; i < mockSender->mBuffers.size(); i++ )
+    {
+        const auto &buffer = mockSender->mBuffers[i];
+        ASSERT_LE( buffer->size(), 1000 );
+        if ( i + 1 < mockSender->mBuffers.size() )
+        {
+            // All but the last payload are filled up to less than one signal below the limit
+            ASSERT_GT( buffer->size(), 950 );
+        }
+        VehicleDataMsg::VehicleData vehicleData{};
+        ASSERT_TRUE( vehicleData.ParseFromArray( buffer->data(), static_cast<int>( buffer->size() ) ) );
+        ASSERT_EQ( "123", vehicleData.campaign_arn() );
+        signalCount += static_cast<size_t>( vehicleData.captured_signals_size() );
+        canFrameCount += static_cast<size_t>( vehicleData.can_frames_size() );
+    }
+    ASSERT_EQ( signalCount, 2000 );
+    ASSERT_EQ( canFrameCount, 3 );
+
+    auto stats = dataCollectionSender.getPayloadSizeStatistics();
+    ASSERT_EQ( stats.payloadCount, mockSender->mBuffers.size() );
+    ASSERT_LE( stats.maxBytes, 1000 );
+    ASSERT_EQ( stats.minBytes, mockSender->mBuffers.back()->size() );
+    ASSERT_EQ( stats.fillBuckets[3], stats.payloadCount - 1 );
+    ASSERT_EQ( stats.fillBuckets[4], 0 );
+}
+
+TEST_F( DataCollectionSenderTest, TestCompressedPayloadsAreCutAtMaxPayloadSize )
+{
+    auto mockSender = std::make_shared<MockBufferSender>();
+    CANInterfaceIDTranslator canIDTranslator;
+    DataCollectionSender dataCollectionSender( mockSender, false, 0, canIDTranslator, mTmpDir.generic_string(), 1000 );
+    collectedDataPtr->metaData.compress = true;
+    collectedDataPtr->signals.clear();
+    for ( uint32_t i = 0; i < 10000; i++ )
+    {
+        // Repeating data which compresses well
+        collectedDataPtr->signals.emplace_back( i % 4, 800 + ( i % 4 ), 1.0 );
+    }
+
+    dataCollectionSender.send( collectedDataPtr );
+    size_t signalCount = 0;
+    for ( const auto &buffer : mockSender->mBuffers )
+    {
+        ASSERT_LE( buffer->size(), 1000 );
+        std::string uncompressed;
+        ASSERT_TRUE(
+            snappy::Uncompress( reinterpret_cast<const char *>( buffer->data() ), buffer->size(), &uncompressed ) );
+        VehicleDataMsg::VehicleData vehicleData{};
+        ASSERT_TRUE( vehicleData.ParseFromString( uncompressed ) );
+        signalCount += static_cast<size_t>( vehicleData.captured_signals_size() );
+    }
+    ASSERT_EQ( signalCount, 10000 );
+    ASSERT_EQ( dataCollectionSender.getPayloadSizeStatistics().fillBuckets[4], 0 );
+}
@@ -0,0 +1,72 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include "PayloadBufferPool.h"
+#include <gtest/gtest.h>
+#include <thread>
+
+using namespace Aws::IoTFleetWise::DataManagement;
+
+TEST( PayloadBufferPoolTest, ReleasedBufferIsReusedWithItsCapacity )
+{
+    PayloadBufferPool pool;
+    ASSERT_EQ( pool.getPooledBufferCount(), 0 );
+    auto buffer = pool.acquire();
+    buffer->resize( 1000 );
+    auto data = buffer->data();
+    buffer.reset();
+    ASSERT_EQ( pool.getPooledBufferCount(), 1 );
+
+    buffer = pool.acquire();
+    ASSERT_EQ( pool.getPooledBufferCount(), 0 );
+    ASSERT_TRUE( buffer->empty() );
+    ASSERT_GE( buffer->capacity(), 1000 );
+    buffer->resize( 1000 );
+    ASSERT_EQ( buffer->data(), data );
+}
+
+TEST( PayloadBufferPoolTest, PoolKeepsAtMostMaxBuffers )
+{
+    PayloadBufferPool pool( 2 );
+    auto buffer1 = pool.acquire();
+    auto buffer2 = pool.acquire();
+    auto buffer3 = pool.acquire();
+    ASSERT_NE( buffer1, buffer2 );
+    ASSERT_NE( buffer2, buffer3 );
+    buffer1.reset();
+    buffer2.reset();
+    buffer3.reset();
+    ASSERT_EQ( pool.getPooledBufferCount(), 2 );
+}
+
+TEST( PayloadBufferPoolTest, BufferOutlivesPool )
+{
+    std::shared_ptr<PayloadBufferPool::Buffer> buffer;
+    {
+        PayloadBufferPool pool;
+        buffer = pool.acquire();
+        buffer->push_back( 0xAA );
+    }
+    ASSERT_EQ( buffer->at( 0 ), 0xAA );
+    // Must not access the destroyed pool
+    buffer.reset();
+}
+
+TEST( PayloadBufferPoolTest, BufferReleasedFromOtherThread )
+{
+    PayloadBufferPool pool;
+    auto buffer = pool.acquire();
+    std::thread releaser( [&buffer]() { buffer.reset(); } );
+    releaser.join();
+    ASSERT_EQ( pool.getPooledBufferCount(), 1 );
+}
@@ -0,0 +1,156 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include "SignalColumnCodec.h"
+#include <cmath>
+#include <gtest/gtest.h>
+#include <limits>
+
+using namespace Aws::IoTFleetWise::DataManagement;
+
+static std::string
+toString( const std::vector<uint8_t> &bytes )
+{
+    return std::string( bytes.begin(), bytes.end() );
+}
+
+static void
+encodeAndDecode( const std::vector<int64_t> &relativeTimes, const std::vector<double> &values )
+{
+    SignalColumnEncoder encoder;
+    encoder.reset( 5 );
+    for ( size_t i = 0; i < relativeTimes.size(); i++ )
+    {
+        size_t relativeTimesSize = 0;
+        size_t doubleValuesSize = 0;
+        encoder.getSizesAfterAppend( relativeTimes[i], values[i], relativeTimesSize, doubleValuesSize );
+        encoder.append( relativeTimes[i], values[i] );
+        ASSERT_EQ( encoder.getRelativeTimes().size(), relativeTimesSize );
+        ASSERT_EQ( encoder.getDoubleValues().size(), doubleValuesSize );
+    }
+    ASSERT_EQ( encoder.getSignalID(), 5 );
+    ASSERT_EQ( encoder.getSampleCount(), relativeTimes.size() );
+
+    std::vector<int64_t> decodedTimes;
+    std::vector<double> decodedValues;
+    ASSERT_TRUE( SignalColumnDecoder::decode( encoder.getSampleCount(),
+                                              toString( encoder.getRelativeTimes() ),
+                                              toString( encoder.getDoubleValues() ),
+                                              decodedTimes,
+                                              decodedValues ) );
+    ASSERT_EQ( decodedTimes, relativeTimes );
+    ASSERT_EQ( decodedValues.size(), values.size() );
+    for ( size_t i = 0; i < values.size(); i++ )
+    {
+        if ( std::isnan( values[i] ) )
+        {
+            ASSERT_TRUE( std::isnan( decodedValues[i] ) );
+        }
+        else
+        {
+            ASSERT_EQ( decodedValues[i], values[i] );
+        }
+    }
+}
+
+TEST( SignalColumnCodecTest, PeriodicConstantSignalUsesOneBitPerSample )
+{
+    std::vector<int64_t> relativeTimes;
+    std::vector<double> values;
+    for ( int64_t i = 0; i < 1001; i++ )
+    {
+        relativeTimes.push_back( -10000 + i * 10 );
+        values.push_back( 42.5 );
+    }
+    encodeAndDecode( relativeTimes, values );
+
+    SignalColumnEncoder encoder;
+    encoder.reset( 1 );
+    for ( size_t i = 0; i < relativeTimes.size(); i++ )
+    {
+        encoder.append( relativeTimes[i], values[i] );
+    }
+    // 64 bits for the first sample, 9 bits for the first delta and 1 bit for each following sample
+    ASSERT_EQ( encoder.getRelativeTimes().size(), ( 64 + 9 + 999 + 7 ) / 8 );
+    // 64 bits for the first sample and 1 bit for each following sample
+    ASSERT_EQ( encoder.getDoubleValues().size(), ( 64 + 1000 + 7 ) / 8 );
+}
+
+TEST( SignalColumnCodecTest, AllTimeBucketsAndValueWindows )
+{
+    std::vector<int64_t> relativeTimes = { 0,
+                                           -5,
+                                           100,
+                                           400,
+                                           3000,
+                                           3000,
+                                           1000000,
+                                           std::numeric_limits<int64_t>::min(),
+                                           std::numeric_limits<int64_t>::max(),
+                                           7 };
+    std::vector<double> values = { 0.0,
+                                   1.0,
+                                   1.0000001,
+                                   -1.0,
+                                   std::numeric_limits<double>::max(),
+                                   std::numeric_limits<double>::denorm_min(),
+                                   std::numeric_limits<double>::quiet_NaN(),
+                                   -0.0,
+                                   std::numeric_limits<double>::infinity(),
+                                   123.456 };
+    encodeAndDecode( relativeTimes, values );
+}
+
+TEST( SignalColumnCodecTest, RandomSamples )
+{
+    std::srand( 1 );
+    std::vector<int64_t> relativeTimes;
+    std::vector<double> values;
+    int64_t time = 0;
+    for ( int i = 0; i < 5000; i++ )
+    {
+        time -= std::rand() % ( ( i % 4 == 0 ) ? 100000 : 20 );
+        relativeTimes.push_back( time );
+        values.push_back( ( i % 7 == 0 ) ? std::rand() * 0.001 : std::round( std::rand() % 1000 ) );
+    }
+    encodeAndDecode( relativeTimes, values );
+}
+
+TEST( SignalColumnCodecTest, ResetStartsNewColumn )
+{
+    SignalColumnEncoder encoder;
+    encoder.reset( 1 );
+    encoder.append( 10, 1.0 );
+    encoder.reset( 2 );
+    ASSERT_EQ( encoder.getSampleCount(), 0 );
+    ASSERT_TRUE( encoder.getRelativeTimes().empty() );
+    ASSERT_TRUE( encoder.getDoubleValues().empty() );
+    encodeAndDecode( { 20 }, { 2.0 } );
+}
+
+TEST( SignalColumnCodecTest, DecodeFailsForTruncatedColumns )
+{
+    SignalColumnEncoder encoder;
+    encoder.reset( 1 );
+    encoder.append( 0, 1.0 );
+    encoder.append( 100000, 2.0 );
+    auto relativeTimes = toString( encoder.getRelativeTimes() );
+    auto doubleValues = toString( encoder.getDoubleValues() );
+    std::vector<int64_t> decodedTimes;
+    std::vector<double> decodedValues;
+    ASSERT_TRUE( SignalColumnDecoder::decode( 2, relativeTimes, doubleValues, decodedTimes, decodedValues ) );
+    ASSERT_FALSE( SignalColumnDecoder::decode(
+        2, relativeTimes.substr( 0, relativeTimes.size() - 1 ), doubleValues, decodedTimes, decodedValues ) );
+    ASSERT_FALSE( SignalColumnDecoder::decode(
+        2, relativeTimes, doubleValues.substr( 0, doubleValues.size() - 1 ), decodedTimes, decodedValues ) );
+}
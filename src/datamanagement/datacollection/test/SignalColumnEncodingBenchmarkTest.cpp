@@ -0,0 +1,103 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include "DataCollectionProtoWriter.h"
+#include <benchmark/benchmark.h>
+#include <cmath>
+#include <snappy.h>
+
+using namespace Aws::IoTFleetWise::DataManagement;
+
+static constexpr Timestamp TRIGGER_TIME = 1600000000000;
+
+/**
+ * @brief Collected data like the inspection engine outputs it: grouped by signal and newest sample first. The
+ * signals are sampled periodically with some jitter and change slowly in the resolution of a CAN signal.
+ */
+static TriggeredCollectionSchemeDataPtr
+createCollectedData( uint32_t signalCount, uint32_t samplesPerSignal, bool columnarEncoding )
+{
+    auto collectedData = std::make_shared<TriggeredCollectionSchemeData>();
+    collectedData->metaData.collectionSchemeID = "arn:aws:iotfleetwise:us-west-2:123456789012:campaign/benchmark";
+    collectedData->metaData.decoderID = "arn:aws:iotfleetwise:us-west-2:123456789012:decoder-manifest/benchmark";
+    collectedData->metaData.columnarEncoding = columnarEncoding;
+    collectedData->triggerTime = TRIGGER_TIME;
+    for ( uint32_t signal = 0; signal < signalCount; signal++ )
+    {
+        auto period = 10U * ( 1U + ( signal % 10U ) );
+        for ( uint32_t sample = 0; sample < samplesPerSignal; sample++ )
+        {
+            auto jitter = ( ( sample * 7U ) % 3U == 0U ) ? 1U : 0U;
+            auto receiveTime = TRIGGER_TIME - ( sample * period ) - jitter;
+            // Constant, slowly changing and fast changing signals
+            double value = 0.0;
+            switch ( signal % 3U )
+            {
+            case 0:
+                value = 1.0;
+                break;
+            case 1:
+                value = std::round( 1000.0 + ( sample / 10U ) ) * 0.1;
+                break;
+            default:
+                value = std::round( 500.0 * std::sin( sample * 0.1 + signal ) ) * 0.25;
+                break;
+            }
+            collectedData->signals.emplace_back( 1000U + signal, receiveTime, value );
+        }
+    }
+    return collectedData;
+}
+
+static void
+BM_encodeSignals( benchmark::State &state )
+{
+    auto columnarEncoding = state.range( 0 ) != 0;
+    auto collectedData =
+        createCollectedData( static_cast<uint32_t>( state.range( 1 ) ), static_cast<uint32_t>( state.range( 2 ) ),
+                             columnarEncoding );
+    CANInterfaceIDTranslator canIDTranslator;
+    DataCollectionProtoWriter protoWriter( canIDTranslator );
+    std::shared_ptr<PayloadBufferPool::Buffer> payload;
+    for ( auto _ : state )
+    {
+        // Returns the previous buffer to the pool before the next payload is written
+        payload.reset();
+        protoWriter.setupVehicleData( collectedData, 1 );
+        for ( const auto &signal : collectedData->signals )
+        {
+            protoWriter.append( signal );
+        }
+        payload = protoWriter.finalizeVehicleData();
+        benchmark::DoNotOptimize( payload->data() );
+    }
+    // The payload sizes are the same in each iteration
+    std::string compressed;
+    snappy::Compress( reinterpret_cast<const char *>( payload->data() ), payload->size(), &compressed );
+    auto signalCount = static_cast<double>( collectedData->signals.size() );
+    state.counters["bytes_per_signal"] = static_cast<double>( payload->size() ) / signalCount;
+    state.counters["snappy_bytes_per_signal"] = static_cast<double>( compressed.size() ) / signalCount;
+    state.SetItemsProcessed( static_cast<int64_t>( state.iterations() * collectedData->signals.size() ) );
+}
+
+// Arguments: columnar encoding, number of signals, samples per signal
+BENCHMARK( BM_encodeSignals )
+    ->ArgNames( { "columnar", "signals", "samples" } )
+    ->Args( { 0, 10, 10 } )
+    ->Args( { 1, 10, 10 } )
+    ->Args( { 0, 50, 200 } )
+    ->Args( { 1, 50, 200 } )
+    ->Args( { 0, 3, 5000 } )
+    ->Args( { 1, 3, 5000 } );
+
+BENCHMARK_MAIN();
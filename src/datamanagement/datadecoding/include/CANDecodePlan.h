@@ -0,0 +1,151 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#pragma once
+
+// Includes
+#include "IDecoderDictionary.h"
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace DataManagement
+{
+
+/**
+ * @brief Decoding rules of one CAN frame, precompiled from a CANMessageDecoderMethod.
+ *
+ * Only the signals which have to be collected are kept, in the order of the original format, so
+ * decoding a frame does not need any lookup into CANDecoderDictionary::signalIDsToCollect.
+ */
+struct CANFrameDecodePlan
+{
+    CANRawFrameID frameID{ 0 };
+    CANMessageCollectType collectType{ CANMessageCollectType::DECODE };
+    /**
+     * @brief Message ID of the original format, only used for logging
+     */
+    uint32_t formatMessageID{ 0 };
+    /**
+     * @brief Same as CANMessageFormat::isValid() of the original format
+     */
+    bool isFormatValid{ false };
+    bool isMultiplexed{ false };
+    /**
+     * @brief False if the frame is multiplexed but no multiplexor signal exists in the format
+     */
+    bool hasMultiplexorSignal{ false };
+    /**
+     * @brief True if the multiplexor signal has to be collected. Only in this case the multiplexor value
+     * is decoded and used to skip the signals of other multiplexor values.
+     */
+    bool collectMultiplexorSignal{ false };
+    CANSignalFormat multiplexorSignal;
+    /**
+     * @brief Signals to collect, laid out contiguously
+     */
+    std::vector<CANSignalFormat> signals;
+};
+
+/**
+ * @brief Immutable decoding plan for all frames of one CAN channel.
+ *
+ * The plan is compiled once when a new CANDecoderDictionary is published and then only read by
+ * the decoding thread. Standard frame IDs are indexed directly through a flat table, all other IDs
+ * through a sorted array, so the lookup per frame neither hashes nor allocates.
+ */
+class CANChannelDecodePlan
+{
+public:
+    static constexpr CANRawFrameID MAX_DIRECT_INDEXED_FRAME_ID = 0x7FF;
+
+    CANChannelDecodePlan();
+
+    /**
+     * @brief Compile the decoding plan of one channel out of the decoder dictionary.
+     * @param dictionary The CAN decoder dictionary to compile
+     * @param channelID The channel for which the plan is compiled
+     * @return the compiled plan. If the dictionary does not contain any rule for this channel, the plan is empty.
+     */
+    static std::shared_ptr<const CANChannelDecodePlan> build( const CANDecoderDictionary &dictionary,
+                                                              CANChannelNumericID channelID );
+
+    /**
+     * @brief Lookup the decoding plan of one frame
+     * @param frameID the CAN frame ID as received on the bus
+     * @return pointer to the plan or nullptr if the frame is not of interest
+     */
+    inline const CANFrameDecodePlan *
+    find( CANRawFrameID frameID ) const
+    {
+        if ( frameID <= MAX_DIRECT_INDEXED_FRAME_ID )
+        {
+            auto index = mDirectIndex[frameID];
+            return index == INVALID_INDEX ? nullptr : &mFrames[index];
+        }
+        return findNonDirectIndexed( frameID );
+    }
+
+    /**
+     * @return number of frames for which the plan has decoding rules
+     */
+    inline size_t
+    size() const
+    {
+        return mFrames.size();
+    }
+
+    /**
+     * @return all frame plans, e.g. for logging
+     */
+    inline const std::vector<CANFrameDecodePlan> &
+    getFrames() const
+    {
+        return mFrames;
+    }
+
+    /**
+     * @return signals used by the conditions of the highest priority collection schemes, see
+     * DecoderDictionary::highPrioritySignalIDs
+     */
+    inline const std::unordered_set<SignalID> &
+    getHighPrioritySignalIDs() const
+    {
+        return mHighPrioritySignalIDs;
+    }
+
+private:
+    static constexpr uint32_t INVALID_INDEX = 0xFFFFFFFF;
+
+    const CANFrameDecodePlan *findNonDirectIndexed( CANRawFrameID frameID ) const;
+
+    std::vector<CANFrameDecodePlan> mFrames;
+    std::array<uint32_t, MAX_DIRECT_INDEXED_FRAME_ID + 1> mDirectIndex;
+    /**
+     * @brief Sorted by frame ID. .first=frame ID, .second=index into mFrames
+     */
+    std::vector<std::pair<CANRawFrameID, uint32_t>> mSortedIndex;
+    std::unordered_set<SignalID> mHighPrioritySignalIDs;
+};
+
+using CANChannelDecodePlanConstPtr = std::shared_ptr<const CANChannelDecodePlan>;
+
+} // namespace DataManagement
+} // namespace IoTFleetWise
+} // namespace Aws
@@ -15,6 +15,7 @@
 
 // Includes
 #include "CANDataTypes.h"
+#include "CANDecodePlan.h"
 #include "ClockHandler.h"
 #include "IDecoderManifest.h"
 #include "LoggingModule.h"
@@ -51,7 +52,22 @@ public:
     bool decodeCANMessage( const uint8_t *frameData,
                            size_t frameSize,
                            const CANMessageFormat &format,
-                           const std::unordered_set<SignalID> signalIDsToCollect,
+                           const std::unordered_set<SignalID> &signalIDsToCollect,
+                           CANDecodedMessage &decodedMessage );
+
+    /**
+     * @brief Decode a given frameData of frameSize using a precompiled decoding plan. All signals in the plan
+     * are collected, so no lookup per signal is needed.
+     * @param frameData pointer to the frame data
+     * @param frameSize size in bytes of the frame.
+     * @param framePlan the precompiled decoding plan of the frame
+     * @param decodedMessage result of the decoding. The decoded signals are appended.
+     * @return True if the decoding is successful, False means that the decoding was
+     * partially not successful
+     */
+    bool decodeCANMessage( const uint8_t *frameData,
+                           size_t frameSize,
+                           const CANFrameDecodePlan &framePlan,
                            CANDecodedMessage &decodedMessage );
 
     /**
@@ -63,6 +79,16 @@ public:
     static int64_t extractSignalFromFrame( const uint8_t *frameData, const CANSignalFormat &signalDescription );
 
 private:
+    /**
+     * @brief Range check and decode one signal. Signals not matching the multiplexor value are skipped.
+     * @return False if the signal is out of range of the frame
+     */
+    bool decodeSignal( const uint8_t *frameData,
+                       uint32_t frameSizeInBits,
+                       const CANSignalFormat &signalFormat,
+                       uint8_t multiplexorValue,
+                       CANDecodedMessage &decodedMessage );
+
     LoggingModule mLogger;
     std::shared_ptr<const Clock> mClock = ClockHandler::getClock();
 };
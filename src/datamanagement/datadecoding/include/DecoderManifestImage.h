@@ -0,0 +1,145 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#pragma once
+
+#include "IDecoderManifest.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace DataManagement
+{
+/**
+ * @brief Compiled binary image of a built decoder manifest. It is used directly, e.g. from a read only memory
+ * mapping, instead of parsing the decoder manifest protobuf and building the dictionaries signal by signal.
+ *
+ * The image starts with a versioned header holding the size and hash of the protobuf it was compiled from, so that a
+ * stale image is detected. It is followed by fixed size records sorted by signal ID and by CAN interface and frame ID,
+ * which are looked up with a binary search. The image is only read on the system that wrote it, so it uses the
+ * native byte order.
+ */
+class DecoderManifestImage
+{
+public:
+    static constexpr uint32_t VERSION = 1;
+
+    /**
+     * @brief Compiles the image from the dictionaries of a built decoder manifest
+     *
+     * @param id                ID of the decoder manifest
+     * @param protoBinaryData   protobuf the dictionaries were built from
+     * @param canMessageFormats CAN message formats by interface ID and CAN frame ID
+     * @param signalToCANFrame  CAN frame and interface ID of each CAN signal
+     * @param signalToProtocol  network protocol of each signal
+     * @param pidFormats        decoder format of each OBD PID signal
+     * @return the image
+     */
+    static std::vector<uint8_t> compile(
+        const std::string &id,
+        const std::vector<uint8_t> &protoBinaryData,
+        const std::unordered_map<CANInterfaceID, std::unordered_map<CANRawFrameID, CANMessageFormat>>
+            &canMessageFormats,
+        const std::unordered_map<SignalID, std::pair<CANRawFrameID, CANInterfaceID>> &signalToCANFrame,
+        const std::unordered_map<SignalID, VehicleDataSourceProtocol> &signalToProtocol,
+        const std::unordered_map<SignalID, PIDSignalDecoderFormat> &pidFormats );
+
+    /**
+     * @brief Checks the header of the image and that all records are within its size. The records themselves are
+     * only read when they are looked up.
+     *
+     * @param data  the image
+     * @param size  size of the image in bytes
+     * @param owner keeps the memory of the image alive as long as this object, e.g. its memory mapping
+     * @return false if the image is truncated, corrupted or has another version
+     */
+    bool init( const uint8_t *data, size_t size, std::shared_ptr<const void> owner );
+
+    /**
+     * @brief Checks if the image was compiled from the given decoder manifest protobuf
+     */
+    bool isCompiledFrom( const std::vector<uint8_t> &protoBinaryData ) const;
+
+    std::string getID() const;
+
+    /**
+     * @return INVALID_PROTOCOL if the signal is not in the image
+     */
+    VehicleDataSourceProtocol getNetworkProtocol( SignalID signalID ) const;
+
+    /**
+     * @return invalid IDs if the signal is not a CAN signal in the image
+     */
+    std::pair<CANRawFrameID, CANInterfaceID> getCANFrameAndInterfaceID( SignalID signalID ) const;
+
+    /**
+     * @brief Gets the decoding rules of a CAN frame
+     * @param canID         CAN frame ID
+     * @param interfaceID   interface the frame is received on
+     * @param format        filled with the decoding rules
+     * @return false if the frame is not in the image
+     */
+    bool getCANMessageFormat( CANRawFrameID canID, const CANInterfaceID &interfaceID, CANMessageFormat &format ) const;
+
+    /**
+     * @return NOT_FOUND_PID_DECODER_FORMAT if the signal is not an OBD PID signal in the image
+     */
+    PIDSignalDecoderFormat getPIDSignalDecoderFormat( SignalID signalID ) const;
+
+    /**
+     * @brief 64 bit FNV-1a hash used to match the image with its decoder manifest protobuf
+     */
+    static uint64_t calculateHash( const uint8_t *data, size_t size );
+
+private:
+    /**
+     * @brief Binary searches the signal records
+     * @return index of the signal record, or the signal count if the signal is not in the image
+     */
+    uint32_t findSignal( SignalID signalID ) const;
+
+    /**
+     * @brief Binary searches the CAN message records
+     * @return index of the message record, or the message count if the frame is not in the image
+     */
+    uint32_t findMessage( uint32_t interfaceIndex, CANRawFrameID canID ) const;
+    std::string getString( uint32_t offset, uint32_t length ) const;
+
+    std::shared_ptr<const void> mOwner;
+    uint64_t mProtoHash{ 0 };
+    uint64_t mProtoSize{ 0 };
+    std::string mID;
+    const uint8_t *mSignals{ nullptr };
+    const uint8_t *mMessages{ nullptr };
+    const uint8_t *mCANSignals{ nullptr };
+    const uint8_t *mPIDs{ nullptr };
+    const uint8_t *mInterfaces{ nullptr };
+    const uint8_t *mStrings{ nullptr };
+    uint32_t mSignalCount{ 0 };
+    uint32_t mMessageCount{ 0 };
+    uint32_t mCANSignalCount{ 0 };
+    uint32_t mPIDCount{ 0 };
+    uint32_t mInterfaceCount{ 0 };
+    uint32_t mStringTableSize{ 0 };
+};
+} // namespace DataManagement
+} // namespace IoTFleetWise
+} // namespace Aws
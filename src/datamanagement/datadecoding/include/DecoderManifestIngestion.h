@@ -13,6 +13,7 @@
 
 #pragma once
 
+#include "DecoderManifestImage.h"
 #include "IDecoderManifest.h"
 #include "LoggingModule.h"
 #include "decoder_manifest.pb.h"
@@ -78,6 +79,10 @@ public:
         return mProtoBinaryData;
     }
 
+    void setImage( std::shared_ptr<const DecoderManifestImage> image ) override;
+
+    std::vector<uint8_t> compileImage() const override;
+
 private:
     /**
      * @brief The DecoderManifest message that will hold the deserialized proto.
@@ -94,11 +99,17 @@ private:
      */
     bool mReady{ false };
 
+    /**
+     * @brief Image of this decoder manifest. If set after build(), the getters read from the image and the
+     * dictionaries below are not built, except for the CAN message formats which are added on demand.
+     */
+    std::shared_ptr<const DecoderManifestImage> mImage;
+
     /**
      * @brief A dictionary used internally that allows the retrieval of a CANMessageFormat per CanChannelId and
      * CANRawFrameID Key: CANRawFrameID Value: CANMessageFormat
      */
-    std::unordered_map<CANInterfaceID, CANFrameToMessageMap> mCANMessageFormatDictionary;
+    mutable std::unordered_map<CANInterfaceID, CANFrameToMessageMap> mCANMessageFormatDictionary;
 
     /**
      * @brief A dictionary used internally that allows lookup of what CANRawFrameID and NodeID a Signal is found on
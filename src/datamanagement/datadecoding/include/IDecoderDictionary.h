@@ -67,6 +67,11 @@ struct DecoderDictionary
     }
     virtual ~DecoderDictionary() = default;
     std::unordered_set<SignalID> signalIDsToCollect;
+    /**
+     * @brief Signals of signalIDsToCollect used by the conditions of the highest priority collection schemes. They
+     * are not shed when the signal buffer fills up.
+     */
+    std::unordered_set<SignalID> highPrioritySignalIDs;
 };
 
 /**
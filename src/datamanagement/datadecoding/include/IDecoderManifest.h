@@ -19,8 +19,10 @@
 #include "SensorTypes.h"
 #include "SignalTypes.h"
 #include <cstdint>
+#include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 
 namespace Aws
 {
@@ -171,6 +173,8 @@ const PIDSignalDecoderFormat NOT_READY_PID_DECODER_FORMAT = PIDSignalDecoderForm
  */
 const PIDSignalDecoderFormat NOT_FOUND_PID_DECODER_FORMAT = PIDSignalDecoderFormat();
 
+class DecoderManifestImage;
+
 /**
  * @brief IDecoderManifest is used to exchange DecoderManifest between components
  *
@@ -252,6 +256,29 @@ public:
      */
     virtual const std::vector<uint8_t> &getData() const = 0;
 
+    /**
+     * @brief Sets a compiled image of a decoder manifest, which build() uses instead of parsing the protobuf if the
+     * image was compiled from the same protobuf.
+     *
+     * @param image the image, can be nullptr
+     */
+    virtual void
+    setImage( std::shared_ptr<const DecoderManifestImage> image )
+    {
+        static_cast<void>( image );
+    }
+
+    /**
+     * @brief Compiles the image of the built decoder manifest, see DecoderManifestImage
+     *
+     * @return the image, or an empty vector if the decoder manifest is not built or was itself built from an image
+     */
+    virtual std::vector<uint8_t>
+    compileImage() const
+    {
+        return {};
+    }
+
     /**
      * @brief Virtual destructor to be implemented by the base class
      */
@@ -0,0 +1,107 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+// Includes
+#include "CANDecodePlan.h"
+#include <algorithm>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace DataManagement
+{
+
+constexpr CANRawFrameID CANChannelDecodePlan::MAX_DIRECT_INDEXED_FRAME_ID;
+constexpr uint32_t CANChannelDecodePlan::INVALID_INDEX;
+
+CANChannelDecodePlan::CANChannelDecodePlan()
+{
+    mDirectIndex.fill( INVALID_INDEX );
+}
+
+std::shared_ptr<const CANChannelDecodePlan>
+CANChannelDecodePlan::build( const CANDecoderDictionary &dictionary, CANChannelNumericID channelID )
+{
+    auto plan = std::make_shared<CANChannelDecodePlan>();
+    auto channelIt = dictionary.canMessageDecoderMethod.find( channelID );
+    if ( channelIt == dictionary.canMessageDecoderMethod.end() )
+    {
+        return plan;
+    }
+    const auto &signalIDsToCollect = dictionary.signalIDsToCollect;
+    plan->mHighPrioritySignalIDs = dictionary.highPrioritySignalIDs;
+    plan->mFrames.reserve( channelIt->second.size() );
+    for ( const auto &decoderMethod : channelIt->second )
+    {
+        const auto &format = decoderMethod.second.format;
+        CANFrameDecodePlan framePlan;
+        framePlan.frameID = decoderMethod.first;
+        framePlan.collectType = decoderMethod.second.collectType;
+        framePlan.formatMessageID = format.mMessageID;
+        framePlan.isFormatValid = format.isValid();
+        framePlan.isMultiplexed = format.isMultiplexed();
+        if ( format.isMultiplexed() )
+        {
+            auto muxIt = std::find_if( format.mSignals.begin(),
+                                       format.mSignals.end(),
+                                       []( const CANSignalFormat &signal ) { return signal.isMultiplexor(); } );
+            if ( muxIt != format.mSignals.end() )
+            {
+                framePlan.hasMultiplexorSignal = true;
+                framePlan.multiplexorSignal = *muxIt;
+                framePlan.collectMultiplexorSignal =
+                    signalIDsToCollect.find( muxIt->mSignalID ) != signalIDsToCollect.end();
+            }
+        }
+        for ( const auto &signal : format.mSignals )
+        {
+            if ( signalIDsToCollect.find( signal.mSignalID ) != signalIDsToCollect.end() )
+            {
+                framePlan.signals.emplace_back( signal );
+            }
+        }
+        auto index = static_cast<uint32_t>( plan->mFrames.size() );
+        if ( framePlan.frameID <= MAX_DIRECT_INDEXED_FRAME_ID )
+        {
+            plan->mDirectIndex[framePlan.frameID] = index;
+        }
+        else
+        {
+            plan->mSortedIndex.emplace_back( framePlan.frameID, index );
+        }
+        plan->mFrames.emplace_back( std::move( framePlan ) );
+    }
+    std::sort( plan->mSortedIndex.begin(), plan->mSortedIndex.end() );
+    return plan;
+}
+
+const CANFrameDecodePlan *
+CANChannelDecodePlan::findNonDirectIndexed( CANRawFrameID frameID ) const
+{
+    auto it = std::lower_bound( mSortedIndex.begin(),
+                                mSortedIndex.end(),
+                                frameID,
+                                []( const std::pair<CANRawFrameID, uint32_t> &entry, CANRawFrameID id ) {
+                                    return entry.first < id;
+                                } );
+    if ( ( it == mSortedIndex.end() ) || ( it->first != frameID ) )
+    {
+        return nullptr;
+    }
+    return &mFrames[it->second];
+}
+
+} // namespace DataManagement
+} // namespace IoTFleetWise
+} // namespace Aws
@@ -28,7 +28,7 @@ bool
 CANDecoder::decodeCANMessage( const uint8_t *frameData,
                               size_t frameSize,
                               const CANMessageFormat &format,
-                              const std::unordered_set<uint32_t> signalIDsToCollect,
+                              const std::unordered_set<uint32_t> &signalIDsToCollect,
                               CANDecodedMessage &decodedMessage )
 {
     uint8_t errorCounter = 0;
@@ -60,58 +60,114 @@ CANDecoder::decodeCANMessage( const uint8_t *frameData,
         }
     }
 
-    for ( size_t i = 0; i < format.mSignals.size(); ++i )
+    for ( const auto &signalFormat : format.mSignals )
     {
-        if ( signalIDsToCollect.find( format.mSignals[i].mSignalID ) != signalIDsToCollect.end() )
+        if ( signalIDsToCollect.find( signalFormat.mSignalID ) != signalIDsToCollect.end() )
         {
-            // Skip the signals that don't match the MUX value
-            if ( multiplexorValue != UINT8_MAX && format.mSignals[i].mMultiplexorValue != multiplexorValue )
+            if ( !decodeSignal( frameData, frameSizeInBits, signalFormat, multiplexorValue, decodedMessage ) )
             {
-                continue;
-            }
-
-            if ( ( format.mSignals[i].mFirstBitPosition >= frameSizeInBits ) ||
-                 ( format.mSignals[i].mSizeInBits < 1 ) || ( format.mSignals[i].mSizeInBits > frameSizeInBits ) )
-            {
-                // Wrongly coded Signal, skip it
-                mLogger.error( "CANDecoder::decodeCANMessage", "Signal Out of Range" );
                 errorCounter++;
-                continue;
             }
+        }
+    }
 
-            if ( ( !format.mSignals[i].mIsBigEndian ) &&
-                 ( format.mSignals[i].mFirstBitPosition + format.mSignals[i].mSizeInBits > frameSizeInBits ) )
-            {
-                // Wrongly coded Signal, skip it
-                mLogger.error( "CANDecoder::decodeCANMessage", "Little endian signal Out of Range" );
-                errorCounter++;
-                continue;
-            }
+    // Message decoding time
+    decodedMessage.mDecodingTime = mClock->timeSinceEpochMs();
+    // Should not harm, callers will ignore the return code.
+    return errorCounter == 0;
+}
 
-            // Start decoding the signal, extract the value before scaling from the Frame.
-            int64_t rawValue = extractSignalFromFrame( frameData, format.mSignals[i] );
-            double physicalValue =
-                static_cast<double>( rawValue ) * format.mSignals[i].mFactor + format.mSignals[i].mOffset;
+bool
+CANDecoder::decodeCANMessage( const uint8_t *frameData,
+                              size_t frameSize,
+                              const CANFrameDecodePlan &framePlan,
+                              CANDecodedMessage &decodedMessage )
+{
+    uint8_t errorCounter = 0;
+    uint32_t frameSizeInBits = static_cast<uint32_t>( frameSize * 8 );
+    uint8_t multiplexorValue = UINT8_MAX;
+
+    if ( framePlan.isMultiplexed )
+    {
+        if ( !framePlan.hasMultiplexorSignal )
+        {
+            mLogger.error( "CANDecoder::decodeCANMessage",
+                           "Message ID" + std::to_string( framePlan.formatMessageID ) +
+                               " is multiplexed but no Multiplexor signal has been found " );
+            return false;
+        }
+        if ( framePlan.collectMultiplexorSignal )
+        {
+            // Decode the multiplexor Value
+            const auto &muxSignal = framePlan.multiplexorSignal;
+            int64_t rawValue = extractSignalFromFrame( frameData, muxSignal );
+            multiplexorValue =
+                static_cast<uint8_t>( static_cast<uint8_t>( rawValue ) * muxSignal.mFactor + muxSignal.mOffset );
             decodedMessage.mFrameInfo.mSignals.emplace_back(
-                CANDecodedSignal( format.mSignals[i].mSignalID, rawValue, physicalValue ) );
+                CANDecodedSignal( muxSignal.mSignalID, rawValue, static_cast<double>( multiplexorValue ) ) );
+        }
+    }
+
+    for ( const auto &signalFormat : framePlan.signals )
+    {
+        if ( !decodeSignal( frameData, frameSizeInBits, signalFormat, multiplexorValue, decodedMessage ) )
+        {
+            errorCounter++;
         }
     }
 
     // Message decoding time
     decodedMessage.mDecodingTime = mClock->timeSinceEpochMs();
-    // Should not harm, callers will ignore the return code.
     return errorCounter == 0;
 }
 
+bool
+CANDecoder::decodeSignal( const uint8_t *frameData,
+                          uint32_t frameSizeInBits,
+                          const CANSignalFormat &signalFormat,
+                          uint8_t multiplexorValue,
+                          CANDecodedMessage &decodedMessage )
+{
+    // Skip the signals that don't match the MUX value
+    if ( multiplexorValue != UINT8_MAX && signalFormat.mMultiplexorValue != multiplexorValue )
+    {
+        return true;
+    }
+
+    if ( ( signalFormat.mFirstBitPosition >= frameSizeInBits ) || ( signalFormat.mSizeInBits < 1 ) ||
+         ( signalFormat.mSizeInBits > frameSizeInBits ) || ( signalFormat.mSizeInBits > 64 ) )
+    {
+        // Wrongly coded Signal, skip it
+        mLogger.error( "CANDecoder::decodeCANMessage", "Signal Out of Range" );
+        return false;
+    }
+
+    if ( ( !signalFormat.mIsBigEndian ) &&
+         ( signalFormat.mFirstBitPosition + signalFormat.mSizeInBits > frameSizeInBits ) )
+    {
+        // Wrongly coded Signal, skip it
+        mLogger.error( "CANDecoder::decodeCANMessage", "Little endian signal Out of Range" );
+        return false;
+    }
+
+    // Start decoding the signal, extract the value before scaling from the Frame.
+    int64_t rawValue = extractSignalFromFrame( frameData, signalFormat );
+    double physicalValue = static_cast<double>( rawValue ) * signalFormat.mFactor + signalFormat.mOffset;
+    decodedMessage.mFrameInfo.mSignals.emplace_back(
+        CANDecodedSignal( signalFormat.mSignalID, rawValue, physicalValue ) );
+    return true;
+}
+
 int64_t
 CANDecoder::extractSignalFromFrame( const uint8_t *frameData, const CANSignalFormat &signalDescription )
 {
     const uint8_t BYTE_SIZE = 8;
-    uint8_t startBit = static_cast<uint8_t>( signalDescription.mFirstBitPosition );
-    uint8_t startByte = startBit / BYTE_SIZE;
-    uint8_t startBitInByte = startBit % BYTE_SIZE;
+    // CAN FD frames have up to 512 bits, so positions do not fit in 8 bits
+    uint16_t startBit = signalDescription.mFirstBitPosition;
+    int startByte = startBit / BYTE_SIZE;
+    uint8_t startBitInByte = static_cast<uint8_t>( startBit % BYTE_SIZE );
     uint8_t resultLength = static_cast<uint8_t>( BYTE_SIZE - startBitInByte );
-    uint8_t endByte = 0U;
+    int endByte = 0;
 
     // Write first bits to result
     uint64_t result = frameData[startByte] >> startBitInByte;
@@ -119,10 +175,10 @@ CANDecoder::extractSignalFromFrame( const uint8_t *frameData, const CANSignalFor
     // Write residual bytes
     if ( signalDescription.mIsBigEndian ) // Motorola (big endian)
     {
-        endByte = static_cast<uint8_t>(
-            ( startByte * BYTE_SIZE + BYTE_SIZE - startBitInByte - signalDescription.mSizeInBits ) / BYTE_SIZE );
+        endByte = ( startByte * BYTE_SIZE + BYTE_SIZE - startBitInByte - signalDescription.mSizeInBits ) / BYTE_SIZE;
 
-        for ( int count = startByte - 1; count >= endByte; count-- )
+        // Bits of a badly coded signal before the start of the frame are not read
+        for ( int count = startByte - 1; ( count >= endByte ) && ( count >= 0 ) && ( resultLength < 64 ); count-- )
         {
             result |= static_cast<uint64_t>( frameData[count] ) << resultLength;
             resultLength = static_cast<uint8_t>( resultLength + BYTE_SIZE );
@@ -130,9 +186,9 @@ CANDecoder::extractSignalFromFrame( const uint8_t *frameData, const CANSignalFor
     }
     else // Intel (little endian)
     {
-        endByte = static_cast<uint8_t>( ( startBit + signalDescription.mSizeInBits - 1 ) / BYTE_SIZE );
+        endByte = ( startBit + signalDescription.mSizeInBits - 1 ) / BYTE_SIZE;
 
-        for ( int count = startByte + 1; count <= endByte; count++ )
+        for ( int count = startByte + 1; ( count <= endByte ) && ( resultLength < 64 ); count++ )
         {
             result |= static_cast<uint64_t>( frameData[count] ) << resultLength;
             resultLength = static_cast<uint8_t>( resultLength + BYTE_SIZE );
@@ -0,0 +1,537 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include "DecoderManifestImage.h"
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <map>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace DataManagement
+{
+namespace
+{
+constexpr uint32_t IMAGE_MAGIC = 0x46574449; // "FWDI"
+constexpr uint32_t NO_INDEX = std::numeric_limits<uint32_t>::max();
+
+struct ImageHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint64_t protoHash;
+    uint64_t protoSize;
+    uint32_t signalCount;
+    uint32_t messageCount;
+    uint32_t canSignalCount;
+    uint32_t pidCount;
+    uint32_t interfaceCount;
+    uint32_t stringTableSize;
+    uint32_t idOffset;
+    uint32_t idLength;
+};
+
+struct SignalRecord
+{
+    uint32_t signalID;
+    uint32_t protocol;
+    // Index of the CAN message record of a CAN signal, NO_INDEX otherwise
+    uint32_t messageIndex;
+    // Index of the PID record of an OBD PID signal, NO_INDEX otherwise
+    uint32_t pidIndex;
+};
+
+struct MessageRecord
+{
+    uint32_t interfaceIndex;
+    uint32_t messageID;
+    // Range of the CAN signal records of the message
+    uint32_t firstSignal;
+    uint32_t signalCount;
+    uint8_t sizeInBytes;
+    uint8_t isMultiplexed;
+    uint8_t reserved[6];
+};
+
+struct CANSignalRecord
+{
+    uint32_t signalID;
+    uint16_t firstBitPosition;
+    uint16_t sizeInBits;
+    double offset;
+    double factor;
+    uint8_t isBigEndian;
+    uint8_t isSigned;
+    uint8_t isMultiplexorSignal;
+    uint8_t multiplexorValue;
+    uint8_t reserved[4];
+};
+
+struct PIDRecord
+{
+    uint64_t pidResponseLength;
+    uint64_t startByte;
+    uint64_t byteLength;
+    double scaling;
+    double offset;
+    uint8_t serviceMode;
+    uint8_t pid;
+    uint8_t bitRightShift;
+    uint8_t bitMaskLength;
+    uint8_t reserved[4];
+};
+
+struct InterfaceRecord
+{
+    // Name of the interface in the string table
+    uint32_t offset;
+    uint32_t length;
+};
+
+// Records are copied out of the image, so that they can be read from any alignment without aliasing issues
+template <typename Record>
+Record
+readRecord( const uint8_t *section, size_t index )
+{
+    Record record;
+    std::memcpy( &record, section + ( index * sizeof( Record ) ), sizeof( Record ) );
+    return record;
+}
+
+template <typename Record>
+void
+appendRecord( std::vector<uint8_t> &image, const Record &record )
+{
+    const auto *bytes = reinterpret_cast<const uint8_t *>( &record );
+    image.insert( image.end(), bytes, bytes + sizeof( Record ) );
+}
+
+uint64_t
+alignSize( uint64_t size )
+{
+    return ( size + 7U ) & ~static_cast<uint64_t>( 7U );
+}
+} // namespace
+
+static_assert( sizeof( ImageHeader ) == 56, "Unexpected padding in ImageHeader" );
+static_assert( sizeof( SignalRecord ) == 16, "Unexpected padding in SignalRecord" );
+static_assert( sizeof( MessageRecord ) == 24, "Unexpected padding in MessageRecord" );
+static_assert( sizeof( CANSignalRecord ) == 32, "Unexpected padding in CANSignalRecord" );
+static_assert( sizeof( PIDRecord ) == 48, "Unexpected padding in PIDRecord" );
+static_assert( sizeof( InterfaceRecord ) == 8, "Unexpected padding in InterfaceRecord" );
+
+constexpr uint32_t DecoderManifestImage::VERSION;
+
+uint64_t
+DecoderManifestImage::calculateHash( const uint8_t *data, size_t size )
+{
+    uint64_t hash = 0xCBF29CE484222325U;
+    for ( size_t i = 0; i < size; i++ )
+    {
+        hash ^= data[i];
+        hash *= 0x100000001B3U;
+    }
+    return hash;
+}
+
+std::vector<uint8_t>
+DecoderManifestImage::compile(
+    const std::string &id,
+    const std::vector<uint8_t> &protoBinaryData,
+    const std::unordered_map<CANInterfaceID, std::unordered_map<CANRawFrameID, CANMessageFormat>> &canMessageFormats,
+    const std::unordered_map<SignalID, std::pair<CANRawFrameID, CANInterfaceID>> &signalToCANFrame,
+    const std::unordered_map<SignalID, VehicleDataSourceProtocol> &signalToProtocol,
+    const std::unordered_map<SignalID, PIDSignalDecoderFormat> &pidFormats )
+{
+    std::string stringTable = id;
+
+    // Interfaces are sorted by name and messages by interface and frame ID, so that they can be binary searched
+    std::vector<CANInterfaceID> interfaceIDs;
+    interfaceIDs.reserve( canMessageFormats.size() );
+    for ( const auto &interface : canMessageFormats )
+    {
+        interfaceIDs.emplace_back( interface.first );
+    }
+    std::sort( interfaceIDs.begin(), interfaceIDs.end() );
+    std::vector<InterfaceRecord> interfaces;
+    std::vector<MessageRecord> messages;
+    std::vector<CANSignalRecord> canSignals;
+    std::map<std::pair<CANInterfaceID, CANRawFrameID>, uint32_t> messageIndexes;
+    for ( const auto &interfaceID : interfaceIDs )
+    {
+        const auto interfaceIndex = static_cast<uint32_t>( interfaces.size() );
+        interfaces.push_back( InterfaceRecord{ static_cast<uint32_t>( stringTable.size() ),
+                                               static_cast<uint32_t>( interfaceID.size() ) } );
+        stringTable += interfaceID;
+        std::map<CANRawFrameID, const CANMessageFormat *> sortedFormats;
+        for ( const auto &format : canMessageFormats.at( interfaceID ) )
+        {
+            sortedFormats.emplace( format.first, &format.second );
+        }
+        for ( const auto &format : sortedFormats )
+        {
+            MessageRecord message{};
+            message.interfaceIndex = interfaceIndex;
+            message.messageID = format.first;
+            message.firstSignal = static_cast<uint32_t>( canSignals.size() );
+            message.signalCount = static_cast<uint32_t>( format.second->mSignals.size() );
+            message.sizeInBytes = format.second->mSizeInBytes;
+            message.isMultiplexed = format.second->mIsMultiplexed ? 1U : 0U;
+            for ( const auto &signalFormat : format.second->mSignals )
+            {
+                CANSignalRecord canSignal{};
+                canSignal.signalID = signalFormat.mSignalID;
+                canSignal.firstBitPosition = signalFormat.mFirstBitPosition;
+                canSignal.sizeInBits = signalFormat.mSizeInBits;
+                canSignal.offset = signalFormat.mOffset;
+                canSignal.factor = signalFormat.mFactor;
+                canSignal.isBigEndian = signalFormat.mIsBigEndian ? 1U : 0U;
+                canSignal.isSigned = signalFormat.mIsSigned ? 1U : 0U;
+                canSignal.isMultiplexorSignal = signalFormat.mIsMultiplexorSignal ? 1U : 0U;
+                canSignal.multiplexorValue = signalFormat.mMultiplexorValue;
+                canSignals.push_back( canSignal );
+            }
+            messageIndexes[std::make_pair( interfaceID, format.first )] = static_cast<uint32_t>( messages.size() );
+            messages.push_back( message );
+        }
+    }
+
+    std::vector<SignalID> signalIDs;
+    signalIDs.reserve( signalToProtocol.size() );
+    for ( const auto &signal : signalToProtocol )
+    {
+        signalIDs.emplace_back( signal.first );
+    }
+    std::sort( signalIDs.begin(), signalIDs.end() );
+    std::vector<SignalRecord> signals;
+    std::vector<PIDRecord> pids;
+    signals.reserve( signalIDs.size() );
+    for ( auto signalID : signalIDs )
+    {
+        SignalRecord signal{ signalID, static_cast<uint32_t>( signalToProtocol.at( signalID ) ), NO_INDEX, NO_INDEX };
+        auto canFrame = signalToCANFrame.find( signalID );
+        if ( canFrame != signalToCANFrame.end() )
+        {
+            auto messageIndex =
+                messageIndexes.find( std::make_pair( canFrame->second.second, canFrame->second.first ) );
+            if ( messageIndex != messageIndexes.end() )
+            {
+                signal.messageIndex = messageIndex->second;
+            }
+        }
+        auto pidFormat = pidFormats.find( signalID );
+        if ( pidFormat != pidFormats.end() )
+        {
+            PIDRecord pid{};
+            pid.pidResponseLength = pidFormat->second.mPidResponseLength;
+            pid.startByte = pidFormat->second.mStartByte;
+            pid.byteLength = pidFormat->second.mByteLength;
+            pid.scaling = pidFormat->second.mScaling;
+            pid.offset = pidFormat->second.mOffset;
+            pid.serviceMode = static_cast<uint8_t>( pidFormat->second.mServiceMode );
+            pid.pid = pidFormat->second.mPID;
+            pid.bitRightShift = pidFormat->second.mBitRightShift;
+            pid.bitMaskLength = pidFormat->second.mBitMaskLength;
+            signal.pidIndex = static_cast<uint32_t>( pids.size() );
+            pids.push_back( pid );
+        }
+        signals.push_back( signal );
+    }
+
+    ImageHeader header{};
+    header.magic = IMAGE_MAGIC;
+    header.version = VERSION;
+    header.protoHash = calculateHash( protoBinaryData.data(), protoBinaryData.size() );
+    header.protoSize = protoBinaryData.size();
+    header.signalCount = static_cast<uint32_t>( signals.size() );
+    header.messageCount = static_cast<uint32_t>( messages.size() );
+    header.canSignalCount = static_cast<uint32_t>( canSignals.size() );
+    header.pidCount = static_cast<uint32_t>( pids.size() );
+    header.interfaceCount = static_cast<uint32_t>( interfaces.size() );
+    header.stringTableSize = static_cast<uint32_t>( alignSize( stringTable.size() ) );
+    header.idOffset = 0;
+    header.idLength = static_cast<uint32_t>( id.size() );
+    stringTable.resize( header.stringTableSize, '\0' );
+
+    std::vector<uint8_t> image;
+    image.reserve( sizeof( header ) + ( signals.size() * sizeof( SignalRecord ) ) +
+                   ( messages.size() * sizeof( MessageRecord ) ) + ( canSignals.size() * sizeof( CANSignalRecord ) ) +
+                   ( pids.size() * sizeof( PIDRecord ) ) + ( interfaces.size() * sizeof( InterfaceRecord ) ) +
+                   stringTable.size() );
+    appendRecord( image, header );
+    for ( const auto &signal : signals )
+    {
+        appendRecord( image, signal );
+    }
+    for ( const auto &message : messages )
+    {
+        appendRecord( image, message );
+    }
+    for ( const auto &canSignal : canSignals )
+    {
+        appendRecord( image, canSignal );
+    }
+    for ( const auto &pid : pids )
+    {
+        appendRecord( image, pid );
+    }
+    for ( const auto &interface : interfaces )
+    {
+        appendRecord( image, interface );
+    }
+    image.insert( image.end(), stringTable.begin(), stringTable.end() );
+    return image;
+}
+
+bool
+DecoderManifestImage::init( const uint8_t *data, size_t size, std::shared_ptr<const void> owner )
+{
+    if ( ( data == nullptr ) || ( size < sizeof( ImageHeader ) ) )
+    {
+        return false;
+    }
+    auto header = readRecord<ImageHeader>( data, 0 );
+    if ( ( header.magic != IMAGE_MAGIC ) || ( header.version != VERSION ) )
+    {
+        return false;
+    }
+    // The counts are 32 bit, so the section sizes can not overflow
+    uint64_t offset = sizeof( ImageHeader );
+    const uint64_t signalsOffset = offset;
+    offset += static_cast<uint64_t>( header.signalCount ) * sizeof( SignalRecord );
+    const uint64_t messagesOffset = offset;
+    offset += static_cast<uint64_t>( header.messageCount ) * sizeof( MessageRecord );
+    const uint64_t canSignalsOffset = offset;
+    offset += static_cast<uint64_t>( header.canSignalCount ) * sizeof( CANSignalRecord );
+    const uint64_t pidsOffset = offset;
+    offset += static_cast<uint64_t>( header.pidCount ) * sizeof( PIDRecord );
+    const uint64_t interfacesOffset = offset;
+    offset += static_cast<uint64_t>( header.interfaceCount ) * sizeof( InterfaceRecord );
+    const uint64_t stringsOffset = offset;
+    offset += header.stringTableSize;
+    if ( ( offset != size ) ||
+         ( static_cast<uint64_t>( header.idOffset ) + header.idLength > header.stringTableSize ) )
+    {
+        return false;
+    }
+    mSignals = data + signalsOffset;
+    mMessages = data + messagesOffset;
+    mCANSignals = data + canSignalsOffset;
+    mPIDs = data + pidsOffset;
+    mInterfaces = data + interfacesOffset;
+    mStrings = data + stringsOffset;
+    mSignalCount = header.signalCount;
+    mMessageCount = header.messageCount;
+    mCANSignalCount = header.canSignalCount;
+    mPIDCount = header.pidCount;
+    mInterfaceCount = header.interfaceCount;
+    mStringTableSize = header.stringTableSize;
+    mProtoHash = header.protoHash;
+    mProtoSize = header.protoSize;
+    mOwner = std::move( owner );
+    mID = getString( header.idOffset, header.idLength );
+    return true;
+}
+
+bool
+DecoderManifestImage::isCompiledFrom( const std::vector<uint8_t> &protoBinaryData ) const
+{
+    return ( mSignals != nullptr ) && ( mProtoSize == protoBinaryData.size() ) &&
+           ( mProtoHash == calculateHash( protoBinaryData.data(), protoBinaryData.size() ) );
+}
+
+std::string
+DecoderManifestImage::getID() const
+{
+    return mID;
+}
+
+std::string
+DecoderManifestImage::getString( uint32_t offset, uint32_t length ) const
+{
+    if ( static_cast<uint64_t>( offset ) + length > mStringTableSize )
+    {
+        return std::string();
+    }
+    return std::string( reinterpret_cast<const char *>( mStrings + offset ), length );
+}
+
+uint32_t
+DecoderManifestImage::findSignal( SignalID signalID ) const
+{
+    uint32_t low = 0;
+    uint32_t high = mSignalCount;
+    while ( low < high )
+    {
+        uint32_t middle = low + ( ( high - low ) / 2 );
+        auto middleSignalID = readRecord<SignalRecord>( mSignals, middle ).signalID;
+        if ( middleSignalID == signalID )
+        {
+            return middle;
+        }
+        if ( middleSignalID < signalID )
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+    return mSignalCount;
+}
+
+uint32_t
+DecoderManifestImage::findMessage( uint32_t interfaceIndex, CANRawFrameID canID ) const
+{
+    const auto key = std::make_pair( interfaceIndex, canID );
+    uint32_t low = 0;
+    uint32_t high = mMessageCount;
+    while ( low < high )
+    {
+        uint32_t middle = low + ( ( high - low ) / 2 );
+        auto message = readRecord<MessageRecord>( mMessages, middle );
+        const auto middleKey = std::make_pair( message.interfaceIndex, message.messageID );
+        if ( middleKey == key )
+        {
+            return middle;
+        }
+        if ( middleKey < key )
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+    return mMessageCount;
+}
+
+VehicleDataSourceProtocol
+DecoderManifestImage::getNetworkProtocol( SignalID signalID ) const
+{
+    auto signalIndex = findSignal( signalID );
+    if ( signalIndex == mSignalCount )
+    {
+        return VehicleDataSourceProtocol::INVALID_PROTOCOL;
+    }
+    return static_cast<VehicleDataSourceProtocol>( readRecord<SignalRecord>( mSignals, signalIndex ).protocol );
+}
+
+std::pair<CANRawFrameID, CANInterfaceID>
+DecoderManifestImage::getCANFrameAndInterfaceID( SignalID signalID ) const
+{
+    auto signalIndex = findSignal( signalID );
+    if ( signalIndex == mSignalCount )
+    {
+        return std::make_pair( INVALID_CAN_FRAME_ID, INVALID_CAN_INTERFACE_ID );
+    }
+    auto signal = readRecord<SignalRecord>( mSignals, signalIndex );
+    if ( signal.messageIndex >= mMessageCount )
+    {
+        return std::make_pair( INVALID_CAN_FRAME_ID, INVALID_CAN_INTERFACE_ID );
+    }
+    auto message = readRecord<MessageRecord>( mMessages, signal.messageIndex );
+    if ( message.interfaceIndex >= mInterfaceCount )
+    {
+        return std::make_pair( INVALID_CAN_FRAME_ID, INVALID_CAN_INTERFACE_ID );
+    }
+    auto interface = readRecord<InterfaceRecord>( mInterfaces, message.interfaceIndex );
+    return std::make_pair( message.messageID, getString( interface.offset, interface.length ) );
+}
+
+bool
+DecoderManifestImage::getCANMessageFormat( CANRawFrameID canID,
+                                           const CANInterfaceID &interfaceID,
+                                           CANMessageFormat &format ) const
+{
+    // There are only a few interfaces, so they are compared one by one without copying their names
+    uint32_t interfaceIndex = 0;
+    for ( ; interfaceIndex < mInterfaceCount; interfaceIndex++ )
+    {
+        auto interface = readRecord<InterfaceRecord>( mInterfaces, interfaceIndex );
+        if ( ( interface.length == interfaceID.size() ) &&
+             ( static_cast<uint64_t>( interface.offset ) + interface.length <= mStringTableSize ) &&
+             ( std::memcmp( mStrings + interface.offset, interfaceID.data(), interface.length ) == 0 ) )
+        {
+            break;
+        }
+    }
+    if ( interfaceIndex == mInterfaceCount )
+    {
+        return false;
+    }
+    auto messageIndex = findMessage( interfaceIndex, canID );
+    if ( messageIndex == mMessageCount )
+    {
+        return false;
+    }
+    auto message = readRecord<MessageRecord>( mMessages, messageIndex );
+    if ( static_cast<uint64_t>( message.firstSignal ) + message.signalCount > mCANSignalCount )
+    {
+        return false;
+    }
+    format.mMessageID = message.messageID;
+    format.mSizeInBytes = message.sizeInBytes;
+    format.mIsMultiplexed = message.isMultiplexed != 0;
+    format.mSignals.clear();
+    format.mSignals.reserve( message.signalCount );
+    for ( uint32_t i = 0; i < message.signalCount; i++ )
+    {
+        auto canSignal = readRecord<CANSignalRecord>( mCANSignals, message.firstSignal + i );
+        CANSignalFormat signalFormat;
+        signalFormat.mSignalID = canSignal.signalID;
+        signalFormat.mFirstBitPosition = canSignal.firstBitPosition;
+        signalFormat.mSizeInBits = canSignal.sizeInBits;
+        signalFormat.mOffset = canSignal.offset;
+        signalFormat.mFactor = canSignal.factor;
+        signalFormat.mIsBigEndian = canSignal.isBigEndian != 0;
+        signalFormat.mIsSigned = canSignal.isSigned != 0;
+        signalFormat.mIsMultiplexorSignal = canSignal.isMultiplexorSignal != 0;
+        signalFormat.mMultiplexorValue = canSignal.multiplexorValue;
+        format.mSignals.emplace_back( signalFormat );
+    }
+    return true;
+}
+
+PIDSignalDecoderFormat
+DecoderManifestImage::getPIDSignalDecoderFormat( SignalID signalID ) const
+{
+    auto signalIndex = findSignal( signalID );
+    if ( signalIndex == mSignalCount )
+    {
+        return NOT_FOUND_PID_DECODER_FORMAT;
+    }
+    auto signal = readRecord<SignalRecord>( mSignals, signalIndex );
+    if ( signal.pidIndex >= mPIDCount )
+    {
+        return NOT_FOUND_PID_DECODER_FORMAT;
+    }
+    auto pid = readRecord<PIDRecord>( mPIDs, signal.pidIndex );
+    return PIDSignalDecoderFormat( static_cast<size_t>( pid.pidResponseLength ),
+                                   static_cast<SID>( pid.serviceMode ),
+                                   pid.pid,
+                                   pid.scaling,
+                                   pid.offset,
+                                   static_cast<size_t>( pid.startByte ),
+                                   static_cast<size_t>( pid.byteLength ),
+                                   pid.bitRightShift,
+                                   pid.bitMaskLength );
+}
+} // namespace DataManagement
+} // namespace IoTFleetWise
+} // namespace Aws
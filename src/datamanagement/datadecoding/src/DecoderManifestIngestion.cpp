@@ -38,6 +38,10 @@ DecoderManifestIngestion::getID() const
         // Return empty string
         return std::string();
     }
+    if ( mImage != nullptr )
+    {
+        return mImage->getID();
+    }
 
     return mProtoDecoderManifest.arn();
 }
@@ -55,6 +59,22 @@ DecoderManifestIngestion::getCANMessageFormat( CANRawFrameID canID, CANInterface
     {
         return INVALID_CAN_MESSAGE_FORMAT;
     }
+    if ( mImage != nullptr )
+    {
+        // A reference is returned, so the format is kept once it was read from the image
+        auto &canFrameToMessageMap = mCANMessageFormatDictionary[interfaceID];
+        auto format = canFrameToMessageMap.find( canID );
+        if ( format == canFrameToMessageMap.end() )
+        {
+            CANMessageFormat newCANMessageFormat;
+            if ( !mImage->getCANMessageFormat( canID, interfaceID, newCANMessageFormat ) )
+            {
+                return INVALID_CAN_MESSAGE_FORMAT;
+            }
+            format = canFrameToMessageMap.emplace( canID, std::move( newCANMessageFormat ) ).first;
+        }
+        return format->second;
+    }
 
     // Check if the message for this CANRawFrameID and interfaceID exists
     if ( mCANMessageFormatDictionary.count( interfaceID ) > 0 &&
@@ -75,6 +95,10 @@ DecoderManifestIngestion::getCANFrameAndInterfaceID( SignalID signalID ) const
     {
         return std::make_pair( INVALID_CAN_FRAME_ID, INVALID_CAN_INTERFACE_ID );
     }
+    if ( mImage != nullptr )
+    {
+        return mImage->getCANFrameAndInterfaceID( signalID );
+    }
 
     // Check to see if entry exists
     if ( mSignalToCANRawFrameIDAndInterfaceIDDictionary.count( signalID ) > 0 )
@@ -94,6 +118,10 @@ DecoderManifestIngestion::getNetworkProtocol( SignalID signalID ) const
     {
         return VehicleDataSourceProtocol::INVALID_PROTOCOL;
     }
+    if ( mImage != nullptr )
+    {
+        return mImage->getNetworkProtocol( signalID );
+    }
 
     if ( mSignalToVehicleDataSourceProtocol.count( signalID ) > 0 )
     {
@@ -110,6 +138,10 @@ DecoderManifestIngestion::getPIDSignalDecoderFormat( SignalID signalID ) const
     {
         return NOT_READY_PID_DECODER_FORMAT;
     }
+    if ( mImage != nullptr )
+    {
+        return mImage->getPIDSignalDecoderFormat( signalID );
+    }
 
     // Check if this signal exist in OBD PID Dictionary
     if ( mSignalToPIDDictionary.count( signalID ) > 0 )
@@ -176,6 +208,21 @@ DecoderManifestIngestion::build()
         return false;
     }
 
+    // An image compiled from the same protobuf is used as is, without parsing the protobuf
+    if ( mImage != nullptr )
+    {
+        if ( mImage->isCompiledFrom( mProtoBinaryData ) )
+        {
+            mCANMessageFormatDictionary.clear();
+            mLogger.info( "DecoderManifestIngestion::build",
+                          "Using the image of the Decoder Manifest with ID: " + mImage->getID() );
+            mReady = true;
+            return true;
+        }
+        mLogger.info( "DecoderManifestIngestion::build", "Decoder Manifest image is outdated, parsing the proto" );
+        mImage.reset();
+    }
+
     // Try to parse the binary data into our mProtoDecoderManifest member variable
     if ( !mProtoDecoderManifest.ParseFromArray( mProtoBinaryData.data(), static_cast<int>( mProtoBinaryData.size() ) ) )
     {
@@ -222,9 +269,6 @@ DecoderManifestIngestion::build()
         canSignalFormat.mIsMultiplexorSignal = false;
         canSignalFormat.mMultiplexorValue = 0;
 
-        mLogger.trace( "DecoderManifestIngestion::build",
-                       "Adding CAN Signal Format for Signal ID: " + std::to_string( canSignalFormat.mSignalID ) );
-
         // Each CANMessageFormat object contains an array of signal decoding rules for each signal it contains. Cloud
         // sends us a set of Signal IDs so we need to iterate through them and either create new CANMessageFormat
         // objects when they don't exist yet for the specified CAN frame id, or add the signal decoding rule to an
@@ -291,12 +335,37 @@ DecoderManifestIngestion::build()
         mSignalToPIDDictionary[pidSignal.signal_id()] = obdPIDSignalDecoderFormat;
     }
 
-    mLogger.trace( "DecoderManifestIngestion::build", "Decoder Manifest build succeeded." );
+    mLogger.trace( "DecoderManifestIngestion::build",
+                   "Decoder Manifest build succeeded with " +
+                       std::to_string( mProtoDecoderManifest.can_signals_size() ) + " CAN signals" );
     // Set our ready flag to true
     mReady = true;
     return true;
 }
 
+void
+DecoderManifestIngestion::setImage( std::shared_ptr<const DecoderManifestImage> image )
+{
+    mImage = std::move( image );
+    // The image is only used by the next build
+    mReady = false;
+}
+
+std::vector<uint8_t>
+DecoderManifestIngestion::compileImage() const
+{
+    if ( ( !mReady ) || ( mImage != nullptr ) )
+    {
+        return {};
+    }
+    return DecoderManifestImage::compile( mProtoDecoderManifest.arn(),
+                                          mProtoBinaryData,
+                                          mCANMessageFormatDictionary,
+                                          mSignalToCANRawFrameIDAndInterfaceIDDictionary,
+                                          mSignalToVehicleDataSourceProtocol,
+                                          mSignalToPIDDictionary );
+}
+
 } // namespace DataManagement
 } // namespace IoTFleetWise
 } // namespace Aws
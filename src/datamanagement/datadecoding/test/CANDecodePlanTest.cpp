@@ -0,0 +1,200 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include "CANDecodePlan.h"
+#include "CANDecoder.h"
+#include <gtest/gtest.h>
+
+using namespace Aws::IoTFleetWise::DataManagement;
+
+static CANSignalFormat
+makeSignal( SignalID signalID, uint16_t firstBitPosition, uint16_t sizeInBits, uint8_t multiplexorValue = UINT8_MAX )
+{
+    CANSignalFormat signal;
+    signal.mSignalID = signalID;
+    signal.mIsBigEndian = true;
+    signal.mIsSigned = false;
+    signal.mFirstBitPosition = firstBitPosition;
+    signal.mSizeInBits = sizeInBits;
+    signal.mOffset = 0.0;
+    signal.mFactor = 1.0;
+    signal.mMultiplexorValue = multiplexorValue;
+    return signal;
+}
+
+static CANMessageDecoderMethod
+makeDecoderMethod( CANRawFrameID frameID, CANMessageCollectType collectType, std::vector<CANSignalFormat> signals )
+{
+    CANMessageDecoderMethod decoderMethod;
+    decoderMethod.collectType = collectType;
+    decoderMethod.format.mMessageID = frameID;
+    decoderMethod.format.mSizeInBytes = 8;
+    decoderMethod.format.mSignals = std::move( signals );
+    return decoderMethod;
+}
+
+TEST( CANDecodePlanTest, BuildOnlyContainsRequestedChannel )
+{
+    CANDecoderDictionary dictionary;
+    dictionary.canMessageDecoderMethod[1][0x100] =
+        makeDecoderMethod( 0x100, CANMessageCollectType::DECODE, { makeSignal( 1, 8, 8 ) } );
+    dictionary.canMessageDecoderMethod[2][0x200] =
+        makeDecoderMethod( 0x200, CANMessageCollectType::RAW, { makeSignal( 2, 8, 8 ) } );
+    dictionary.signalIDsToCollect = { 1, 2 };
+
+    auto plan = CANChannelDecodePlan::build( dictionary, 1 );
+    ASSERT_EQ( plan->size(), 1 );
+    ASSERT_NE( plan->find( 0x100 ), nullptr );
+    ASSERT_EQ( plan->find( 0x200 ), nullptr );
+    ASSERT_EQ( plan->find( 0x100 )->collectType, CANMessageCollectType::DECODE );
+
+    auto emptyPlan = CANChannelDecodePlan::build( dictionary, 3 );
+    ASSERT_EQ( emptyPlan->size(), 0 );
+    ASSERT_EQ( emptyPlan->find( 0x100 ), nullptr );
+}
+
+TEST( CANDecodePlanTest, LookupStandardAndExtendedFrameIDs )
+{
+    CANDecoderDictionary dictionary;
+    std::vector<CANRawFrameID> frameIDs = { 0x0, 0x7FF, 0x800, 0x18DAF158, 0x1FFFFFFF, 0x123 };
+    for ( auto frameID : frameIDs )
+    {
+        dictionary.canMessageDecoderMethod[1][frameID] =
+            makeDecoderMethod( frameID, CANMessageCollectType::RAW_AND_DECODE, { makeSignal( frameID, 8, 8 ) } );
+        dictionary.signalIDsToCollect.insert( frameID );
+    }
+
+    auto plan = CANChannelDecodePlan::build( dictionary, 1 );
+    ASSERT_EQ( plan->size(), frameIDs.size() );
+    for ( auto frameID : frameIDs )
+    {
+        auto framePlan = plan->find( frameID );
+        ASSERT_NE( framePlan, nullptr );
+        ASSERT_EQ( framePlan->frameID, frameID );
+        ASSERT_EQ( framePlan->signals.size(), 1 );
+        ASSERT_EQ( framePlan->signals[0].mSignalID, frameID );
+    }
+    ASSERT_EQ( plan->find( 0x1 ), nullptr );
+    ASSERT_EQ( plan->find( 0x801 ), nullptr );
+    ASSERT_EQ( plan->find( 0x18DAF159 ), nullptr );
+}
+
+TEST( CANDecodePlanTest, SignalsNotToCollectAreFilteredOut )
+{
+    CANDecoderDictionary dictionary;
+    dictionary.canMessageDecoderMethod[1][0x101] =
+        makeDecoderMethod( 0x101,
+                           CANMessageCollectType::DECODE,
+                           { makeSignal( 1, 44, 4 ), makeSignal( 7, 28, 12 ), makeSignal( 9, 8, 8 ) } );
+    dictionary.signalIDsToCollect = { 1, 9 };
+
+    auto plan = CANChannelDecodePlan::build( dictionary, 1 );
+    auto framePlan = plan->find( 0x101 );
+    ASSERT_NE( framePlan, nullptr );
+    ASSERT_TRUE( framePlan->isFormatValid );
+    ASSERT_EQ( framePlan->signals.size(), 2 );
+    ASSERT_EQ( framePlan->signals[0].mSignalID, 1 );
+    ASSERT_EQ( framePlan->signals[1].mSignalID, 9 );
+
+    std::vector<uint8_t> frameData = { 0x08, 0x46, 0xFF, 0x4B, 0x00, 0xD0, 0x00, 0x00 };
+    CANDecoder decoder;
+    CANDecodedMessage decodedMsg;
+    ASSERT_TRUE( decoder.decodeCANMessage( frameData.data(), frameData.size(), *framePlan, decodedMsg ) );
+    ASSERT_EQ( decodedMsg.mFrameInfo.mSignals.size(), 2 );
+    ASSERT_EQ( decodedMsg.mFrameInfo.mSignals[0].mSignalID, 1 );
+    ASSERT_EQ( decodedMsg.mFrameInfo.mSignals[0].mRawValue, 13 );
+    ASSERT_EQ( decodedMsg.mFrameInfo.mSignals[1].mSignalID, 9 );
+    ASSERT_EQ( decodedMsg.mFrameInfo.mSignals[1].mRawValue, 0x46 );
+}
+
+TEST( CANDecodePlanTest, DecodeMultiplexedFrameSameAsDictionary )
+{
+    std::vector<uint8_t> frameData = { 0x05, 0x02, 0x0B, 0x00, 0xD3, 0x00, 0x4B, 0x18 };
+
+    CANSignalFormat multiplexorSignal;
+    multiplexorSignal.mSignalID = 50;
+    multiplexorSignal.mIsBigEndian = false;
+    multiplexorSignal.mFirstBitPosition = 0;
+    multiplexorSignal.mSizeInBits = 4;
+    multiplexorSignal.mFactor = 1.0;
+    multiplexorSignal.mIsMultiplexorSignal = true;
+
+    auto decoderMethod = makeDecoderMethod( 0x300,
+                                            CANMessageCollectType::DECODE,
+                                            { multiplexorSignal,
+                                              makeSignal( 51, 48, 16, 5 ),
+                                              makeSignal( 52, 16, 16, 5 ),
+                                              makeSignal( 53, 32, 16, 4 ) } );
+    decoderMethod.format.mIsMultiplexed = true;
+
+    CANDecoderDictionary dictionary;
+    dictionary.canMessageDecoderMethod[1][0x300] = decoderMethod;
+    dictionary.signalIDsToCollect = { 50, 51, 52, 53 };
+
+    CANDecoder decoder;
+    CANDecodedMessage expectedMsg;
+    ASSERT_TRUE( decoder.decodeCANMessage(
+        frameData.data(), frameData.size(), decoderMethod.format, dictionary.signalIDsToCollect, expectedMsg ) );
+
+    auto plan = CANChannelDecodePlan::build( dictionary, 1 );
+    auto framePlan = plan->find( 0x300 );
+    ASSERT_NE( framePlan, nullptr );
+    ASSERT_TRUE( framePlan->hasMultiplexorSignal );
+    ASSERT_TRUE( framePlan->collectMultiplexorSignal );
+    CANDecodedMessage decodedMsg;
+    ASSERT_TRUE( decoder.decodeCANMessage( frameData.data(), frameData.size(), *framePlan, decodedMsg ) );
+
+    ASSERT_EQ( decodedMsg.mFrameInfo.mSignals.size(), 3 );
+    ASSERT_EQ( decodedMsg.mFrameInfo.mSignals.size(), expectedMsg.mFrameInfo.mSignals.size() );
+    for ( size_t i = 0; i < decodedMsg.mFrameInfo.mSignals.size(); i++ )
+    {
+        ASSERT_EQ( decodedMsg.mFrameInfo.mSignals[i].mSignalID, expectedMsg.mFrameInfo.mSignals[i].mSignalID );
+        ASSERT_EQ( decodedMsg.mFrameInfo.mSignals[i].mRawValue, expectedMsg.mFrameInfo.mSignals[i].mRawValue );
+    }
+}
+
+TEST( CANDecodePlanTest, MultiplexedFrameWithoutMultiplexorSignalFails )
+{
+    auto decoderMethod = makeDecoderMethod( 0x300, CANMessageCollectType::DECODE, { makeSignal( 51, 48, 16, 5 ) } );
+    decoderMethod.format.mIsMultiplexed = true;
+    CANDecoderDictionary dictionary;
+    dictionary.canMessageDecoderMethod[1][0x300] = decoderMethod;
+    dictionary.signalIDsToCollect = { 51 };
+
+    auto plan = CANChannelDecodePlan::build( dictionary, 1 );
+    auto framePlan = plan->find( 0x300 );
+    ASSERT_NE( framePlan, nullptr );
+    ASSERT_FALSE( framePlan->hasMultiplexorSignal );
+
+    std::vector<uint8_t> frameData = { 0x05, 0x02, 0x0B, 0x00, 0xD3, 0x00, 0x4B, 0x18 };
+    CANDecoder decoder;
+    CANDecodedMessage decodedMsg;
+    ASSERT_FALSE( decoder.decodeCANMessage( frameData.data(), frameData.size(), *framePlan, decodedMsg ) );
+    ASSERT_TRUE( decodedMsg.mFrameInfo.mSignals.empty() );
+}
+
+TEST( CANDecodePlanTest, OutOfBoundSignalsAreSkipped )
+{
+    CANDecoderDictionary dictionary;
+    dictionary.canMessageDecoderMethod[1][0x101] = makeDecoderMethod(
+        0x101, CANMessageCollectType::DECODE, { makeSignal( 1, 8, 8 ), makeSignal( 2, 64, 8 ) } );
+    dictionary.signalIDsToCollect = { 1, 2 };
+
+    auto plan = CANChannelDecodePlan::build( dictionary, 1 );
+    std::vector<uint8_t> frameData = { 0x08, 0x46, 0xFF, 0x4B, 0x00, 0xD0, 0x00, 0x00 };
+    CANDecoder decoder;
+    CANDecodedMessage decodedMsg;
+    ASSERT_FALSE( decoder.decodeCANMessage( frameData.data(), frameData.size(), *plan->find( 0x101 ), decodedMsg ) );
+    ASSERT_EQ( decodedMsg.mFrameInfo.mSignals.size(), 1 );
+    ASSERT_EQ( decodedMsg.mFrameInfo.mSignals[0].mSignalID, 1 );
+}
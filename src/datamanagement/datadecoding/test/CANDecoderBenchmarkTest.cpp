@@ -0,0 +1,138 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include "CANDecodePlan.h"
+#include "CANDecoder.h"
+
+using namespace Aws::IoTFleetWise::DataManagement;
+
+static constexpr CANChannelNumericID CHANNEL_ID = 1;
+static constexpr uint32_t NUMBER_OF_FRAMES = 200;
+static constexpr uint32_t SIGNALS_PER_FRAME = 8;
+
+/**
+ * @brief Dictionary with NUMBER_OF_FRAMES frames of which every second signal is collected. Half of the frames
+ * have extended IDs.
+ */
+static std::shared_ptr<CANDecoderDictionary>
+createDictionary()
+{
+    auto dictionary = std::make_shared<CANDecoderDictionary>();
+    for ( uint32_t i = 0; i < NUMBER_OF_FRAMES; i++ )
+    {
+        CANRawFrameID frameID = ( i % 2 == 0 ) ? ( 0x100 + i ) : ( 0x18DA0000 + i );
+        CANMessageDecoderMethod decoderMethod;
+        decoderMethod.collectType = CANMessageCollectType::DECODE;
+        decoderMethod.format.mMessageID = frameID;
+        decoderMethod.format.mSizeInBytes = 8;
+        for ( uint32_t j = 0; j < SIGNALS_PER_FRAME; j++ )
+        {
+            CANSignalFormat signal;
+            signal.mSignalID = i * SIGNALS_PER_FRAME + j;
+            signal.mIsBigEndian = false;
+            signal.mFirstBitPosition = static_cast<uint16_t>( j * 8 );
+            signal.mSizeInBits = 8;
+            signal.mFactor = 0.5;
+            decoderMethod.format.mSignals.emplace_back( signal );
+            if ( j % 2 == 0 )
+            {
+                dictionary->signalIDsToCollect.insert( signal.mSignalID );
+            }
+        }
+        dictionary->canMessageDecoderMethod[CHANNEL_ID][frameID] = decoderMethod;
+    }
+    return dictionary;
+}
+
+static std::vector<CANRawFrameID>
+getFrameIDs( const CANDecoderDictionary &dictionary )
+{
+    std::vector<CANRawFrameID> frameIDs;
+    for ( const auto &decoderMethod : dictionary.canMessageDecoderMethod.at( CHANNEL_ID ) )
+    {
+        frameIDs.emplace_back( decoderMethod.first );
+    }
+    return frameIDs;
+}
+
+static void
+BM_decodeWithDecoderDictionary( benchmark::State &state )
+{
+    // Replicates the lookups done per frame before the decoding plan was introduced
+    std::shared_ptr<const DecoderDictionary> genericDictionary = createDictionary();
+    auto frameIDs = getFrameIDs( *std::dynamic_pointer_cast<const CANDecoderDictionary>( genericDictionary ) );
+    std::array<uint8_t, 8> frameData = { 0x01, 0x23, 0x45, 0x67, 0x89, 0xAB, 0xCD, 0xEF };
+    CANDecoder decoder;
+    CANDecodedMessage decodedMessage;
+    size_t frameIndex = 0;
+    for ( auto _ : state )
+    {
+        auto frameID = frameIDs[frameIndex];
+        frameIndex = ( frameIndex + 1 ) % frameIDs.size();
+        auto decoderDictPtr = std::dynamic_pointer_cast<const CANDecoderDictionary>( genericDictionary );
+        const auto &decoderMethod = decoderDictPtr->canMessageDecoderMethod;
+        if ( decoderMethod.find( CHANNEL_ID ) != decoderMethod.cend() &&
+             decoderMethod.at( CHANNEL_ID ).find( frameID ) != decoderMethod.at( CHANNEL_ID ).cend() )
+        {
+            const auto &format = decoderMethod.at( CHANNEL_ID ).at( frameID ).format;
+            decodedMessage.mFrameInfo.mSignals.clear();
+            decoder.decodeCANMessage(
+                frameData.data(), frameData.size(), format, decoderDictPtr->signalIDsToCollect, decodedMessage );
+            benchmark::DoNotOptimize( decodedMessage.mFrameInfo.mSignals.data() );
+        }
+    }
+    state.SetItemsProcessed( static_cast<int64_t>( state.iterations() ) );
+}
+BENCHMARK( BM_decodeWithDecoderDictionary );
+
+static void
+BM_decodeWithDecodePlan( benchmark::State &state )
+{
+    auto dictionary = createDictionary();
+    auto frameIDs = getFrameIDs( *dictionary );
+    auto plan = CANChannelDecodePlan::build( *dictionary, CHANNEL_ID );
+    std::array<uint8_t, 8> frameData = { 0x01, 0x23, 0x45, 0x67, 0x89, 0xAB, 0xCD, 0xEF };
+    CANDecoder decoder;
+    CANDecodedMessage decodedMessage;
+    size_t frameIndex = 0;
+    for ( auto _ : state )
+    {
+        auto frameID = frameIDs[frameIndex];
+        frameIndex = ( frameIndex + 1 ) % frameIDs.size();
+        const auto *framePlan = plan->find( frameID );
+        if ( framePlan != nullptr )
+        {
+            decodedMessage.mFrameInfo.mSignals.clear();
+            decoder.decodeCANMessage( frameData.data(), frameData.size(), *framePlan, decodedMessage );
+            benchmark::DoNotOptimize( decodedMessage.mFrameInfo.mSignals.data() );
+        }
+    }
+    state.SetItemsProcessed( static_cast<int64_t>( state.iterations() ) );
+}
+BENCHMARK( BM_decodeWithDecodePlan );
+
+static void
+BM_buildDecodePlan( benchmark::State &state )
+{
+    auto dictionary = createDictionary();
+    for ( auto _ : state )
+    {
+        auto plan = CANChannelDecodePlan::build( *dictionary, CHANNEL_ID );
+        benchmark::DoNotOptimize( plan.get() );
+    }
+}
+BENCHMARK( BM_buildDecodePlan );
+
+BENCHMARK_MAIN();
@@ -506,4 +506,56 @@ TEST( CANDecoderTest, CANDecoderTestSkippingOutOfBoundSignals2 )
     std::unordered_set<SignalID> signalIDsToCollect = { 1, 2 };
     ASSERT_FALSE( decoder.decodeCANMessage( frameData.data(), frameSize, msgFormat, signalIDsToCollect, decodedMsg ) );
     ASSERT_EQ( decodedMsg.mFrameInfo.mSignals.size(), 1 );
-}
\ No newline at end of file
+}
+TEST( CANDecoderTest, CANDecoderTestCANFDMessage )
+{
+    // Signals beyond the first 256 bits of a 64 byte CAN FD frame
+    std::vector<uint8_t> frameData( 64, 0x00 );
+    frameData[50] = 0x34;
+    frameData[51] = 0x12;
+    frameData[62] = 0xAB;
+    frameData[63] = 0xCD;
+
+    CANSignalFormat sigFormat1;
+    sigFormat1.mSignalID = 1;
+    sigFormat1.mIsBigEndian = false;
+    sigFormat1.mIsSigned = false;
+    sigFormat1.mFirstBitPosition = 400;
+    sigFormat1.mSizeInBits = 16;
+    sigFormat1.mOffset = 0.0;
+    sigFormat1.mFactor = 1.0;
+
+    CANSignalFormat sigFormat2;
+    sigFormat2.mSignalID = 2;
+    sigFormat2.mIsBigEndian = true;
+    sigFormat2.mIsSigned = false;
+    sigFormat2.mFirstBitPosition = 504;
+    sigFormat2.mSizeInBits = 16;
+    sigFormat2.mOffset = 0.0;
+    sigFormat2.mFactor = 1.0;
+
+    CANSignalFormat sigFormat3;
+    sigFormat3.mSignalID = 3;
+    sigFormat3.mIsBigEndian = false;
+    sigFormat3.mIsSigned = false;
+    sigFormat3.mFirstBitPosition = 504;
+    sigFormat3.mSizeInBits = 16;
+    sigFormat3.mOffset = 0.0;
+    sigFormat3.mFactor = 1.0;
+
+    CANMessageFormat msgFormat;
+    msgFormat.mMessageID = 0x100;
+    msgFormat.mSizeInBytes = 64;
+    msgFormat.mSignals.emplace_back( sigFormat1 );
+    msgFormat.mSignals.emplace_back( sigFormat2 );
+    msgFormat.mSignals.emplace_back( sigFormat3 );
+
+    CANDecoder decoder;
+    CANDecodedMessage decodedMsg;
+    std::unordered_set<SignalID> signalIDsToCollect = { 1, 2, 3 };
+    // The little endian signal 3 extends past the end of the frame
+    ASSERT_FALSE( decoder.decodeCANMessage( frameData.data(), 64, msgFormat, signalIDsToCollect, decodedMsg ) );
+    ASSERT_EQ( decodedMsg.mFrameInfo.mSignals.size(), 2 );
+    ASSERT_EQ( decodedMsg.mFrameInfo.mSignals[0].mRawValue, 0x1234 );
+    ASSERT_EQ( decodedMsg.mFrameInfo.mSignals[1].mRawValue, 0xABCD );
+}
@@ -0,0 +1,108 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include "DecoderManifestImage.h"
+#include "DecoderManifestIngestion.h"
+
+using namespace Aws::IoTFleetWise::DataManagement;
+
+static constexpr uint32_t NUMBER_OF_FRAMES = 2500;
+static constexpr uint32_t SIGNALS_PER_FRAME = 8;
+
+/**
+ * @brief Decoder manifest protobuf with NUMBER_OF_FRAMES * SIGNALS_PER_FRAME CAN signals on two interfaces
+ */
+static std::string
+createDecoderManifestProto()
+{
+    DecoderManifestMsg::DecoderManifest protoDM;
+    protoDM.set_arn( "arn:aws:iotfleetwise:us-west-2:123456789012:decoder-manifest/benchmark" );
+    for ( uint32_t i = 0; i < NUMBER_OF_FRAMES; i++ )
+    {
+        for ( uint32_t j = 0; j < SIGNALS_PER_FRAME; j++ )
+        {
+            DecoderManifestMsg::CANSignal *protoCANSignal = protoDM.add_can_signals();
+            protoCANSignal->set_signal_id( i * SIGNALS_PER_FRAME + j );
+            protoCANSignal->set_interface_id( ( i % 2 == 0 ) ? "can0" : "can1" );
+            protoCANSignal->set_message_id( 0x100 + i );
+            protoCANSignal->set_start_bit( j * 8 );
+            protoCANSignal->set_length( 8 );
+            protoCANSignal->set_factor( 0.5 );
+        }
+    }
+    std::string protoSerializedBuffer;
+    protoDM.SerializeToString( &protoSerializedBuffer );
+    return protoSerializedBuffer;
+}
+
+/**
+ * @brief Builds the decoder manifest and looks up the decoding rules of the frames of 200 signals, as done when the
+ * inspection matrix and decoder dictionary are extracted for a few collection schemes
+ */
+static void
+buildAndLookUp( benchmark::State &state, DecoderManifestIngestion &decoderManifest )
+{
+    if ( !decoderManifest.build() )
+    {
+        state.SkipWithError( "Build failed" );
+        return;
+    }
+    for ( SignalID signalID = 0; signalID < NUMBER_OF_FRAMES * SIGNALS_PER_FRAME; signalID += 100 )
+    {
+        auto frame = decoderManifest.getCANFrameAndInterfaceID( signalID );
+        benchmark::DoNotOptimize( decoderManifest.getCANMessageFormat( frame.first, frame.second ) );
+    }
+}
+
+static void
+BM_BuildFromProto( benchmark::State &state )
+{
+    auto proto = createDecoderManifestProto();
+    for ( auto _ : state )
+    {
+        DecoderManifestIngestion decoderManifest;
+        decoderManifest.copyData( reinterpret_cast<const uint8_t *>( proto.data() ), proto.size() );
+        buildAndLookUp( state, decoderManifest );
+    }
+}
+
+static void
+BM_BuildFromImage( benchmark::State &state )
+{
+    auto proto = createDecoderManifestProto();
+    DecoderManifestIngestion protoBuiltDecoderManifest;
+    protoBuiltDecoderManifest.copyData( reinterpret_cast<const uint8_t *>( proto.data() ), proto.size() );
+    protoBuiltDecoderManifest.build();
+    auto imageData = std::make_shared<const std::vector<uint8_t>>( protoBuiltDecoderManifest.compileImage() );
+    state.counters["ImageBytes"] = static_cast<double>( imageData->size() );
+    for ( auto _ : state )
+    {
+        auto image = std::make_shared<DecoderManifestImage>();
+        if ( !image->init( imageData->data(), imageData->size(), imageData ) )
+        {
+            state.SkipWithError( "Invalid image" );
+            return;
+        }
+        DecoderManifestIngestion decoderManifest;
+        decoderManifest.copyData( reinterpret_cast<const uint8_t *>( proto.data() ), proto.size() );
+        decoderManifest.setImage( image );
+        buildAndLookUp( state, decoderManifest );
+    }
+}
+
+BENCHMARK( BM_BuildFromProto );
+BENCHMARK( BM_BuildFromImage );
+
+BENCHMARK_MAIN();
@@ -15,13 +15,16 @@
 
 // Includes
 
+#include "CANDecodePlan.h"
 #include "CANDecoder.h"
 #include "ClockHandler.h"
 #include "IVehicleDataConsumer.h"
+#include "LoadShedding.h"
 #include "LoggingModule.h"
 #include "Signal.h"
 #include "Thread.h"
 #include "Timer.h"
+#include <array>
 #include <iostream>
 
 namespace Aws
@@ -33,7 +36,7 @@ namespace DataInspection
 using namespace Aws::IoTFleetWise::Platform::Linux;
 /**
  * @brief CAN Network Data Consumer impl, outputs data to an in-memory buffer.
- *        Operates in Polling mode.
+ *        Operates in Polling mode, or decodes the frames in the thread that receives them.
  */
 class CANDataConsumer : public IVehicleDataConsumer
 {
@@ -80,6 +83,22 @@ public:
         return mCANBufferPtr;
     }
 
+    /**
+     * @brief Decode the frames in the thread that receives them instead of an own thread. connect() then does
+     * not start a thread and consumeAvailableFrames() must be called after frames were pushed to the input buffer.
+     * Must be called before connect.
+     */
+    inline void
+    setConsumeInReceivingThread()
+    {
+        mConsumeInReceivingThread = true;
+    }
+
+    /**
+     * @brief Decode all frames in the input buffer. Only used if the frames are consumed in the receiving thread.
+     */
+    void consumeAvailableFrames();
+
 private:
     // Start the  thread
     bool start();
@@ -93,6 +112,9 @@ private:
     // Decodes the messages and puts the results in the output buffer.
     static void doWork( void *data );
 
+    // Pops one frame from the input buffer and decodes it. Returns false if the buffer was empty.
+    bool consumeFrame( bool traceEnabled );
+
     bool switchCollectionSchemeIfNeeded();
 
     Thread mThread;
@@ -101,13 +123,42 @@ private:
     mutable std::mutex mThreadMutex;
     LoggingModule mLogger;
     std::shared_ptr<const Clock> mClock = ClockHandler::getClock();
+    // Protects the publication of a new decoder dictionary and decoding plan
     std::mutex mDecoderDictMutex;
+    // Latest published decoding plan of this channel
+    CANChannelDecodePlanConstPtr mDecodePlan;
+    // Incremented on every publication so that the decoding thread can detect a new plan without locking
+    std::atomic<uint32_t> mDecodePlanGeneration{ 0 };
     std::unique_ptr<CANDecoder> mCANDecoder;
     Platform::Linux::Signal mWait;
     uint32_t mIdleTime{ DEFAULT_THREAD_IDLE_TIME_MS };
     static constexpr uint32_t DEFAULT_THREAD_IDLE_TIME_MS = 1000;
     // Raw CAN Frame Buffer shared pointer
     CANBufferPtr mCANBufferPtr;
+    bool mConsumeInReceivingThread{ false };
+    std::atomic<bool> mConnected{ false };
+    // State of the consuming thread
+    // The decoded message is reused across frames so that the channel metadata and the signal vector capacity
+    // are set up only once and not for every frame.
+    CANDecodedMessage mDecodedMessage;
+    // Own lane of this consumer in the signal buffer, and the signals of a frame that are pushed to it as one batch
+    SignalBuffer::Lane *mSignalBufferLane{ nullptr };
+    std::vector<CollectedSignal> mCollectedSignals;
+    // Backpressure: signals are sampled down when the own lane fills up, and the dropped elements are reported in
+    // aggregated form
+    SignalLoadShedder mSignalLoadShedder;
+    DropCounters<SignalID> mShedSignals{ "CANDataConsumer::consumeFrame",
+                                         "decoded signals to relieve the Signal Buffer" };
+    DropCounters<SignalID> mDroppedSignals{ "CANDataConsumer::consumeFrame", "signals as the Signal Buffer was full" };
+    DropCounters<CANRawFrameID> mDroppedFrames{ "CANDataConsumer::consumeFrame",
+                                                "raw CAN frames as the RAW CAN Frame Buffer was full" };
+    // Local reference to the currently used decoding plan, it is kept alive until a newer plan is picked up
+    CANChannelDecodePlanConstPtr mActiveDecodePlan;
+    uint32_t mActiveDecodePlanGeneration{ 0 };
+    // Only used for TRACE log level logging
+    std::array<std::pair<uint32_t, uint32_t>, 8> mLastFrameIds{}; // .first=can id, .second=counter
+    uint8_t mLastFrameIdPos{ 0 };
+    uint32_t mProcessedFramesCounter{ 0 };
 };
 } // namespace DataInspection
 } // namespace IoTFleetWise
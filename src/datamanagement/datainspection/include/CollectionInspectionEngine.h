@@ -19,10 +19,15 @@
 #include "InspectionEventListener.h"
 #include "Listener.h"
 #include "LoggingModule.h"
+#include <algorithm>
+#include <boost/dynamic_bitset.hpp>
 #include <limits>
+#include <map>
+#include <memory>
+#include <string>
 #include <unordered_map>
-// As _Find_first() is not part of C++ standard and compiler specific other structure could be considered
-#include <bitset>
+#include <utility>
+#include <vector>
 
 namespace Aws
 {
@@ -98,6 +103,18 @@ public:
      */
     void addNewSignal( InspectionSignalID id, InspectionTimestamp receiveTime, InspectionValue value );
 
+    /**
+     * @brief Give a batch of new signals to the collection engine to cache them
+     *
+     * Same as calling addNewSignal for every element but intended to be used after draining
+     * multiple signals from the input queue at once. Conditions are not evaluated by this call,
+     * so evaluateConditions should be called once after the whole batch was added.
+     *
+     * @param signals pointer to the first signal of the batch, ordered by time (oldest signals first)
+     * @param count number of signals in the batch
+     */
+    void addNewSignals( const CollectedSignal *signals, size_t count );
+
     /**
      * @brief Add new raw CAN Frame history buffer. If frame is not needed call will be just ignored
      *
@@ -131,6 +148,21 @@ public:
 
     void setActiveDTCs( const DTCInfo &activeDTCs );
 
+    /**
+     * @brief Select how the conditions are evaluated
+     *
+     * By default every condition is compiled to bytecode when the inspection matrix changes and the bytecode
+     * is evaluated. The recursive evaluation directly on the expression tree is kept as reference for
+     * tests and benchmarks.
+     *
+     * @param useRecursiveEvaluation true to evaluate the expression trees recursively
+     */
+    void
+    setUseRecursiveEvaluation( bool useRecursiveEvaluation )
+    {
+        mUseRecursiveEvaluation = useRecursiveEvaluation;
+    }
+
 private:
     static const uint32_t MAX_SAMPLE_MEMORY = 20 * 1024 * 1024; // 20MB max for all samples
     static inline InspectionValue
@@ -139,49 +171,29 @@ private:
         return 0.001;
     } // because static const double (non-integral type) not possible
 
-    struct SampleConsumed
-    {
-        bool
-        isAlreadyConsumed( uint32_t conditionId )
-        {
-            return mAlreadyConsumed.test( conditionId );
-        }
-        void
-        setAlreadyConsumed( uint32_t conditionId, bool value )
-        {
-            if ( conditionId == ALL_CONDITIONS )
-            {
-                if ( value )
-                {
-                    mAlreadyConsumed.set();
-                }
-                else
-                {
-                    mAlreadyConsumed.reset();
-                }
-            }
-            else
-            {
-                mAlreadyConsumed[conditionId] = value;
-            }
-        }
+    /**
+     * @brief Bytes every sample needed when each sample had one "already consumed" flag per possible condition.
+     * Only used to report the memory saved by tracking the consumption with watermarks per condition.
+     */
+    static constexpr uint32_t CONSUMED_FLAGS_BYTES_PER_SAMPLE = 256 / 8;
 
-    private:
-        std::bitset<MAX_NUMBER_OF_ACTIVE_CONDITION> mAlreadyConsumed{ 0 };
-    };
-    struct SignalSample : SampleConsumed
+    /**
+     * @brief Set of conditions, the index of a bit is the index in mConditions
+     */
+    using ConditionSet = boost::dynamic_bitset<>;
+
+    struct SignalSample
     {
         InspectionValue mValue{ 0.0 };
         InspectionTimestamp mTimestamp{ 0 };
     };
 
-    struct CanFrameSample : SampleConsumed
+    struct CanFrameSample
     {
-        uint8_t mSize{ 0 }; /**< elements in buffer variable used. So if the raw can messages is only 3 bytes big this
-                           uint8_t will be 3 and only the first three bytes of buffer will contain meaningful data. size
-                           optimized sizeof(size)+sizeof(buffer) = 9 < sizeof(std:vector) = 24 so also for empty
-                           messages its mor efficient to preallocate 8 bytes even if not all will be used*/
-        std::array<uint8_t, MAX_CAN_FRAME_BYTE_SIZE> mBuffer{};
+        uint8_t mSize{ 0 }; /**< number of payload bytes. Payloads of classic CAN frames are stored in mBuffer, so
+                               they do not pay for the size of CAN FD payloads. Longer payloads are stored in
+                               mFdPayloads of the history buffer */
+        std::array<uint8_t, MAX_CLASSIC_CAN_FRAME_BYTE_SIZE> mBuffer{};
         InspectionTimestamp mTimestamp{ 0 };
     };
 
@@ -274,25 +286,27 @@ private:
     struct SignalHistoryBuffer
     {
         SignalHistoryBuffer() = default;
-        SignalHistoryBuffer( uint32_t sizeIn, uint32_t sampleInterval )
-            : mMinimumSampleIntervalMs( sampleInterval )
+        SignalHistoryBuffer( InspectionSignalID signalID, uint32_t sizeIn, uint32_t sampleInterval )
+            : mSignalID( signalID )
+            , mMinimumSampleIntervalMs( sampleInterval )
             , mSize( sizeIn )
             , mCurrentPosition( mSize - 1 )
         {
         }
 
+        InspectionSignalID mSignalID{ INVALID_SIGNAL_ID };
         uint32_t mMinimumSampleIntervalMs{ 0 };
-        std::vector<struct SignalSample>
-            mBuffer; // ringbuffer, Consider to move to raw pointer allocated with new[] if vector allocates too much
+        struct SignalSample *mBuffer{ nullptr }; /**< ringbuffer of mSize samples carved out of mSampleArena. nullptr
+                                                    if no memory could be assigned */
         uint32_t mSize{ 0 };            // minimum size needed by all conditions, buffer must be at least this big
         uint32_t mCurrentPosition{ 0 }; /**< position in ringbuffer needs to come after size as it depends on it */
-        uint32_t mCounter{ 0 };         /**< over all recorded samples*/
+        uint32_t mCounter{ 0 };         /**< over all recorded samples. The newest sample is the mCounter-th sample */
         InspectionTimestamp mLastSample{ 0 };
         std::vector<FixedTimeWindowFunctionData>
             mWindowFunctionData; /**< every signal buffer can have multiple windows over different time periods*/
-        std::bitset<MAX_NUMBER_OF_ACTIVE_CONDITION>
-            mConditionsThatEvaluateOnThisSignal; /**< if bit 0 is set it means element with index 0 of vector conditions
-                                                 needs to reevaluate if this signal changes*/
+        std::vector<uint32_t>
+            mConditionsThatEvaluateOnThisSignal; /**< indices into mConditions of the conditions that need to reevaluate
+                                                    if this signal changes */
 
         inline FixedTimeWindowFunctionData *
         addFixedWindow( uint32_t windowSizeMs )
@@ -326,6 +340,12 @@ private:
             }
             return nullptr;
         }
+
+        inline bool
+        hasSameSource( const SignalHistoryBuffer &other ) const
+        {
+            return ( mSignalID == other.mSignalID ) && ( mMinimumSampleIntervalMs == other.mMinimumSampleIntervalMs );
+        }
     };
 
     /**
@@ -349,14 +369,110 @@ private:
         CANRawFrameID mFrameID{ INVALID_CAN_FRAME_ID };
         CANChannelNumericID mChannelID{ INVALID_CAN_SOURCE_NUMERIC_ID };
         uint32_t mMinimumSampleIntervalMs{ 0 };
-        std::vector<struct CanFrameSample>
-            mBuffer; // ringbuffer, Consider to move to raw pointer allocated with new[] if vector allocates too much
+        struct CanFrameSample *mBuffer{ nullptr }; /**< ringbuffer of mSize samples carved out of mSampleArena.
+                                                      nullptr if no memory could be assigned */
         uint32_t mSize{ 0 };
         uint32_t mCurrentPosition{ mSize - 1 }; // position in ringbuffer
-        uint32_t mCounter{ 0 };
+        uint32_t mCounter{ 0 };                 /**< over all recorded samples */
         InspectionTimestamp mLastSample{ 0 };
+        std::vector<uint8_t> mFdPayloads; /**< MAX_CAN_FRAME_BYTE_SIZE bytes per sample, only allocated with the
+                                             first CAN FD frame that does not fit into CanFrameSample::mBuffer */
+        bool mFdPayloadsUnavailable{ false }; /**< true if mFdPayloads could not be allocated */
+
+        inline bool
+        hasSameSource( const CanFrameHistoryBuffer &other ) const
+        {
+            return ( mFrameID == other.mFrameID ) && ( mChannelID == other.mChannelID ) &&
+                   ( mMinimumSampleIntervalMs == other.mMinimumSampleIntervalMs );
+        }
+    };
+
+    /**
+     * @brief A history buffer a condition publishes data from
+     *
+     * Instead of flagging every sample as consumed, each condition remembers for each of its buffers the value of
+     * mCounter when it last collected data from it. All samples up to this counter were already sent out by this
+     * condition.
+     */
+    template <typename HistoryBuffer>
+    struct CollectedBuffer
+    {
+        CollectedBuffer( HistoryBuffer *buffer, uint32_t maxNumberOfSamples )
+            : mBuffer( buffer )
+            , mMaxNumberOfSamples( maxNumberOfSamples )
+        {
+        }
+        HistoryBuffer *mBuffer{ nullptr };
+        uint32_t mMaxNumberOfSamples{ 0 }; /**< number of newest samples the condition publishes */
+        uint32_t mConsumedCounter{ 0 };    /**< watermark: value of mBuffer->mCounter at the last collection */
+    };
+
+    enum class ExpressionErrorCode
+    {
+        SUCCESSFUL,
+        SIGNAL_NOT_FOUND,
+        FUNCTION_DATA_NOT_AVAILABLE,
+        STACK_DEPTH_REACHED,
+        NOT_IMPLEMENTED_TYPE,
+        NOT_IMPLEMENTED_FUNCTION
+    };
+
+    enum class ConditionOpCode : uint8_t
+    {
+        PUSH_FLOAT,
+        PUSH_BOOLEAN,
+        PUSH_SIGNAL,
+        PUSH_WINDOW_FUNCTION,
+        GEOHASH,
+        SMALLER,
+        BIGGER,
+        SMALLER_EQUAL,
+        BIGGER_EQUAL,
+        EQUAL,
+        LOGICAL_AND,
+        LOGICAL_OR,
+        LOGICAL_NOT,
+        ARITHMETIC_PLUS,
+        ARITHMETIC_MINUS,
+        ARITHMETIC_MULTIPLY,
+        ARITHMETIC_DIVIDE,
+        FAIL /**< stops the evaluation with mErrorCode */
+    };
+
+    /**
+     * @brief One instruction of a condition compiled to bytecode for a stack machine
+     *
+     * The instructions are executed in post order of the expression tree, so each operator finds its operands
+     * on top of the stack. Signals and window functions are resolved when the inspection matrix changes so
+     * evaluating the instruction does not need any lookup.
+     */
+    struct ConditionInstruction
+    {
+        ConditionOpCode mOpCode{ ConditionOpCode::FAIL };
+        ExpressionErrorCode mErrorCode{ ExpressionErrorCode::SUCCESSFUL }; /**< only used by FAIL */
+        bool mBooleanValue{ false };                                       /**< only used by PUSH_BOOLEAN */
+        WindowFunction mWindowFunction{ WindowFunction::NONE };            /**< only used by PUSH_WINDOW_FUNCTION */
+        InspectionValue mFloatingValue{ 0.0 };                             /**< only used by PUSH_FLOAT */
+        const SignalHistoryBuffer *mSignal{ nullptr };         /**< PUSH_SIGNAL signal or GEOHASH latitude signal */
+        const SignalHistoryBuffer *mSecondSignal{ nullptr };   /**< GEOHASH longitude signal */
+        const FixedTimeWindowFunctionData *mWindow{ nullptr }; /**< only used by PUSH_WINDOW_FUNCTION */
+        const GeohashFunction *mGeohashFunction{ nullptr };    /**< only used by GEOHASH */
+    };
+
+    /**
+     * @brief Result of an already evaluated subexpression on the stack of the stack machine
+     */
+    struct ConditionStackEntry
+    {
+        InspectionValue mValue{ 0.0 };
+        bool mBoolean{ false };
     };
 
+    /**
+     * @brief The stack never gets deeper than the expression tree, which is limited by MAX_EQUATION_DEPTH
+     */
+    static constexpr uint32_t MAX_CONDITION_STACK_SIZE = MAX_EQUATION_DEPTH;
+
     /**
      * @brief Stores information specific to one condition like the last time if was true
      */
@@ -364,6 +480,7 @@ private:
     {
         ActiveCondition( const ConditionWithCollectedData &conditionIn )
             : mCondition( conditionIn )
+            , mCollectionSchemeID( conditionIn.metaData.collectionSchemeID )
         {
         }
         InspectionTimestamp mLastDataTimestampPublished{ 0 };
@@ -372,27 +489,153 @@ private:
             mEvaluationSignals; // for fast lookup signals used for evaluation
         std::unordered_map<InspectionSignalID, FixedTimeWindowFunctionData *>
             mEvaluationFunctions; // for fast lookup functions used for evaluation
+        std::vector<ConditionInstruction> mInstructions; // condition compiled to bytecode
+        std::vector<CollectedBuffer<SignalHistoryBuffer>> mCollectedSignals; // signals to publish, first occurrence
+                                                                             // order of the signals of the condition
+        std::vector<CollectedBuffer<CanFrameHistoryBuffer>> mCollectedCanFrames; // raw can frames to publish
+        uint32_t mActiveDTCsConsumedCounter{ 0 }; // value of mActiveDTCsCounter when DTCs were last collected
         const ConditionWithCollectedData &mCondition;
+        // Copy of the ID, as the previous inspection matrix can't be accessed anymore when the state of the condition
+        // is carried over to a new inspection matrix
+        std::string mCollectionSchemeID;
         // Unique Identifier of the Event matched by this condition.
         EventID mEventID{ 0 };
     };
 
-    enum class ExpressionErrorCode
+    /**
+     * @brief One allocation holding the ringbuffers of several signal and can frame history buffers
+     */
+    struct SampleArena
     {
-        SUCCESSFUL,
-        SIGNAL_NOT_FOUND,
-        FUNCTION_DATA_NOT_AVAILABLE,
-        STACK_DEPTH_REACHED,
-        NOT_IMPLEMENTED_TYPE,
-        NOT_IMPLEMENTED_FUNCTION
+        std::unique_ptr<uint8_t[]> mMemory;
+        uint64_t mSize{ 0 };
     };
 
-    SignalHistoryBuffer &addSignalToBuffer( const InspectionMatrixSignalCollectionInfo &signal );
-    bool preAllocateBuffers();
+    /**
+     * @brief Everything set up for the previous inspection matrix, kept while the state of the conditions and
+     * history buffers that are still needed is carried over to the new inspection matrix
+     */
+    struct PreviousInspectionState
+    {
+        std::shared_ptr<const InspectionMatrix> mInspectionMatrix;
+        std::vector<SignalHistoryBuffer> mSignalBuffers;
+        std::vector<CanFrameHistoryBuffer> mCanFrameBuffers;
+        std::vector<SampleArena> mSampleArenas;
+        std::vector<ActiveCondition> mConditions;
+        ConditionSet mConditionsWithInputSignalChanged;
+        ConditionSet mConditionsWithConditionCurrentlyTrue;
+        ConditionSet mConditionsNotTriggeredWaitingPublished;
+    };
+
+    using SignalHistoryBufferCollection = std::map<InspectionSignalID, std::vector<SignalHistoryBuffer>>;
+    static SignalHistoryBuffer &addSignalToBuffer( const InspectionMatrixSignalCollectionInfo &signal,
+                                                   SignalHistoryBufferCollection &signalBuffers );
+    void buildSignalBufferIndex( SignalHistoryBufferCollection &signalBuffers );
+    SignalHistoryBuffer *findSignalBuffer( InspectionSignalID id, uint32_t minimumSampleIntervalMs );
+
+    /**
+     * @brief Assign the memory for the ringbuffers of all history buffers and carry over their samples and window
+     * function state from the previous inspection matrix
+     *
+     * Buffers that existed before with the same size keep their ringbuffer, so only the memory for new or resized
+     * buffers is allocated. If more than half of the arenas would be unused, all ringbuffers are moved to one new
+     * arena instead.
+     *
+     * @param previous the state of the previous inspection matrix
+     * @return false if not all buffers fit into MAX_SAMPLE_MEMORY
+     */
+    bool preAllocateBuffers( PreviousInspectionState &previous );
+
+    /**
+     * @brief Carry over the trigger state and the collected data watermarks of conditions that were already active
+     * with the previous inspection matrix. Conditions are matched by their collection scheme ID.
+     */
+    void carryOverConditionState( const PreviousInspectionState &previous );
+
+    /**
+     * @brief Copy the samples of a history buffer of the previous inspection matrix to the new one
+     *
+     * If the new buffer got the same ringbuffer nothing is copied. Otherwise the newest samples are copied in order
+     * to the start of the new ringbuffer and the counter starts again at the number of copied samples.
+     *
+     * @param previousBuffer buffer of the previous inspection matrix
+     * @param buffer buffer of the new inspection matrix with its ringbuffer already assigned
+     * @param copySample called with the position in the previous and new ringbuffer of every sample to copy
+     */
+    template <typename HistoryBuffer, typename CopySample>
+    static void carryOverSamples( const HistoryBuffer &previousBuffer, HistoryBuffer &buffer, CopySample copySample );
+
+    /**
+     * @brief Translate the watermark of a condition to the counter of the carried over history buffer
+     * @param previousCollectedBuffer the watermark of the condition on the previous buffer
+     * @param buffer the carried over history buffer
+     * @return the watermark for buffer
+     */
+    template <typename HistoryBuffer>
+    static uint32_t carryOverConsumedCounter( const CollectedBuffer<HistoryBuffer> &previousCollectedBuffer,
+                                              const HistoryBuffer &buffer );
+
+    /**
+     * @brief Lookup the first history buffer of a signal in mSignalBuffers
+     * @param id the signal ID
+     * @return index into mSignalBuffers or INVALID_SIGNAL_BUFFER_INDEX if the signal is not collected. All buffers
+     * of the same signal with different sample intervals follow each other.
+     */
+    inline uint32_t
+    getSignalBufferIndex( InspectionSignalID id ) const
+    {
+        if ( id < mSignalBufferDirectIndex.size() )
+        {
+            return mSignalBufferDirectIndex[id];
+        }
+        if ( id <= MAX_DIRECT_INDEXED_SIGNAL_ID )
+        {
+            return INVALID_SIGNAL_BUFFER_INDEX;
+        }
+        auto it = std::lower_bound( mSignalBufferSortedIndex.begin(),
+                                    mSignalBufferSortedIndex.end(),
+                                    id,
+                                    []( const std::pair<InspectionSignalID, uint32_t> &entry, InspectionSignalID key ) {
+                                        return entry.first < key;
+                                    } );
+        if ( ( it == mSignalBufferSortedIndex.end() ) || ( it->first != id ) )
+        {
+            return INVALID_SIGNAL_BUFFER_INDEX;
+        }
+        return it->second;
+    }
     bool isSignalPartOfEval( const struct ExpressionNode *expression,
                              InspectionSignalID signalID,
                              int remainingStackDepth );
 
+    /**
+     * @brief Compile the expression tree to bytecode and append it to condition.mInstructions
+     *
+     * mEvaluationSignals and mEvaluationFunctions of the condition must already be set up. All errors the
+     * recursive eval would detect on the structure of the tree are compiled to a FAIL instruction at the
+     * same position, so both evaluations behave the same.
+     */
+    void compileExpression( const struct ExpressionNode *expression,
+                            ActiveCondition &condition,
+                            int remainingStackDepth );
+
+    /**
+     * @brief Compile the conditions of all active conditions and check that the stack can never overflow
+     */
+    void compileConditions();
+
+    /**
+     * @brief Evaluate the bytecode of a condition
+     * @param condition the condition whose mInstructions are executed
+     * @param resultValueBool the boolean result of the condition
+     * @return SUCCESSFUL or the first error that occurred
+     */
+    ExpressionErrorCode evalInstructions( const ActiveCondition &condition, bool &resultValueBool );
+    static ExpressionErrorCode applyOperator( ConditionOpCode opCode,
+                                              const ConditionStackEntry &left,
+                                              const ConditionStackEntry &right,
+                                              ConditionStackEntry &result );
+
     ExpressionErrorCode eval( const struct ExpressionNode *expression,
                               ActiveCondition &condition,
                               InspectionValue &resultValueDouble,
@@ -401,6 +644,14 @@ private:
     ExpressionErrorCode getLatestSignalValue( InspectionSignalID id,
                                               ActiveCondition &condition,
                                               InspectionValue &result );
+    static ExpressionErrorCode getLatestSignalValue( const SignalHistoryBuffer &signal, InspectionValue &result );
+    static ExpressionErrorCode getWindowFunctionValue( WindowFunction function,
+                                                      const FixedTimeWindowFunctionData &window,
+                                                      InspectionValue &result );
+    ExpressionErrorCode getGeohashFunctionNode( const GeohashFunction &geohashFunction,
+                                                const SignalHistoryBuffer *latitudeSignal,
+                                                const SignalHistoryBuffer *longitudeSignal,
+                                                bool &resultValueBool );
     static ExpressionErrorCode getSampleWindowFunction( WindowFunction function,
                                                         InspectionSignalID signalID,
                                                         ActiveCondition &condition,
@@ -408,20 +659,23 @@ private:
     ExpressionErrorCode getGeohashFunctionNode( const struct ExpressionNode *expression,
                                                 ActiveCondition &condition,
                                                 bool &resultValueBool );
-    void collectLastSignals( InspectionSignalID id,
-                             uint32_t minimumSamplingInterval,
-                             uint32_t maxNumberOfSignalsToCollect,
-                             uint32_t conditionId,
+    /**
+     * @brief Resolve the signal and can frame history buffers a condition publishes data from
+     */
+    void setupCollectedBuffers( ActiveCondition &condition );
+    void collectLastSignals( CollectedBuffer<SignalHistoryBuffer> &collectedBuffer,
                              InspectionTimestamp &newestSignalTimestamp,
                              std::vector<CollectedSignal> &output );
-    void collectLastCanFrames( CANRawFrameID canID,
-                               CANChannelNumericID channelID,
-                               uint32_t minimumSamplingInterval,
-                               uint32_t maxNumberOfSignalsToCollect,
-                               uint32_t conditionId,
+    void collectLastCanFrames( CollectedBuffer<CanFrameHistoryBuffer> &collectedBuffer,
                                InspectionTimestamp &newestSignalTimestamp,
                                std::vector<CollectedCanRawFrame> &output );
 
+    /**
+     * @brief Allocate the storage for CAN FD payloads of a history buffer if it fits into MAX_SAMPLE_MEMORY
+     * @param buf the history buffer that received a CAN FD frame
+     */
+    void allocateFdPayloads( CanFrameHistoryBuffer &buf );
+
     void updateAllFixedWindowFunctions( InspectionTimestamp timestamp );
 
     /**
@@ -454,43 +708,42 @@ private:
         return ++counter;
     }
 
-    using SignalHistoryBufferCollection = std::unordered_map<InspectionSignalID, std::vector<SignalHistoryBuffer>>;
-    SignalHistoryBufferCollection
-        mSignalBuffers; /**< signal history buffer. First vector has the signalID as index. In the nested vector
-                         * the different subsampling of this signal are stored. */
+    static constexpr InspectionSignalID MAX_DIRECT_INDEXED_SIGNAL_ID = 0xFFFF;
+    static constexpr uint32_t INVALID_SIGNAL_BUFFER_INDEX = 0xFFFFFFFF;
+
+    std::vector<SignalHistoryBuffer>
+        mSignalBuffers; /**< signal history buffers of all signals, sorted by signal ID. The different subsampling of
+                         * the same signal follow each other. Never resized after the inspection matrix was applied,
+                         * so pointers into it stay valid. */
+    std::vector<uint32_t> mSignalBufferDirectIndex; /**< signal ID as index, value is the index into mSignalBuffers.
+                                                     * Only for IDs up to MAX_DIRECT_INDEXED_SIGNAL_ID */
+    std::vector<std::pair<InspectionSignalID, uint32_t>>
+        mSignalBufferSortedIndex; /**< index into mSignalBuffers for IDs above MAX_DIRECT_INDEXED_SIGNAL_ID, sorted */
+    std::vector<SampleArena> mSampleArenas; /**< the ringbuffers of all signal and can frame history buffers, limited
+                                             * to MAX_SAMPLE_MEMORY. Each inspection matrix change adds at most one
+                                             * arena for the new buffers. */
+    uint64_t mSampleMemoryBytes{ 0 }; /**< memory used for samples including the CAN FD payloads */
 
     using CanFrameHistoryBufferCollection = std::vector<CanFrameHistoryBuffer>;
     CanFrameHistoryBufferCollection mCanFrameBuffers; /**< signal history buffer for raw can frames. */
     DTCInfo mActiveDTCs;
-    SampleConsumed mActiveDTCsConsumed;
-
-    bool
-    isActiveDTCsConsumed( uint32_t conditionId )
-    {
-        return mActiveDTCsConsumed.isAlreadyConsumed( conditionId );
-    }
-    void
-    setActiveDTCsConsumed( uint32_t conditionId, bool value )
-    {
-        mActiveDTCsConsumed.setAlreadyConsumed( conditionId, value );
-    }
+    uint32_t mActiveDTCsCounter{ 1 }; /**< incremented every time new active DTCs are set */
 
     GeohashFunctionNode mGeohashFunctionNode;
-    // index in this bitset also the index in conditions vector.
-    std::bitset<MAX_NUMBER_OF_ACTIVE_CONDITION>
-        mConditionsWithInputSignalChanged; // bit is set if any signal or fixed window that this condition uses in its
-                                           // condition changed
-    std::bitset<MAX_NUMBER_OF_ACTIVE_CONDITION>
+    // index in this bitset also the index in conditions vector. All sets have one bit per active condition
+    ConditionSet mConditionsWithInputSignalChanged; // bit is set if any signal or fixed window that this condition uses
+                                                    // in its condition changed
+    ConditionSet
         mConditionsWithConditionCurrentlyTrue; // bit is set if the condition evaluated to true the last time
-    std::bitset<MAX_NUMBER_OF_ACTIVE_CONDITION>
+    ConditionSet
         mConditionsNotTriggeredWaitingPublished; // bit is set if condition is not triggered, if bit is not set it means
                                                  // condition is triggered and waits for its data to be sent out
+    ConditionSet mConditionsToEvaluate; // only used inside evaluateConditions, kept to avoid allocations
 
     std::vector<ActiveCondition> mConditions;
     std::shared_ptr<const InspectionMatrix> mActiveInspectionMatrix;
 
     std::shared_ptr<const TriggeredCollectionSchemeData> collectData( ActiveCondition &condition,
-                                                                      uint32_t conditionId,
                                                                       InspectionTimestamp &newestSignalTimestamp );
     uint32_t mNextConditionToCollectedIndex{ 0 };
 
@@ -498,6 +751,7 @@ private:
     Aws::IoTFleetWise::Platform::Linux::LoggingModule mLogger;
     DataReduction mDataReduction;
     bool mSendDataOnlyOncePerCondition{ false };
+    bool mUseRecursiveEvaluation{ false };
 };
 
 } // namespace DataInspection
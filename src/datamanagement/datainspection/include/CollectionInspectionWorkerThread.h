@@ -17,10 +17,16 @@
 #include "CollectionInspectionEngine.h"
 #include "IDataReadyToPublishListener.h"
 #include "Listener.h"
+#include "LoadShedding.h"
 #include "LoggingModule.h"
 #include "Signal.h"
 #include "Thread.h"
 #include "Timer.h"
+#include <limits>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
 namespace Aws
 {
 namespace IoTFleetWise
@@ -30,10 +36,27 @@ namespace DataInspection
 using namespace Aws::IoTFleetWise::DataManagement;
 using Aws::IoTFleetWise::Platform::Linux::ThreadListeners;
 
+/**
+ * @brief Thread running the CollectionInspectionEngine
+ *
+ * Optionally the conditions can be sharded over multiple inspection engines. Then every shard is an own
+ * CollectionInspectionWorkerThread with its own input and output queues. This thread only dispatches the input
+ * data to the shards which have at least one condition using it and merges the collected data of all shards into
+ * the output queue. As every condition belongs to exactly one shard and the output queue of every shard is
+ * drained in order, the data of one campaign is published in the same order as without sharding.
+ */
 class CollectionInspectionWorkerThread : public IActiveConditionProcessor,
                                          public ThreadListeners<IDataReadyToPublishListener>
 {
 public:
+    static constexpr uint32_t MAX_NUMBER_OF_SHARDS = 64;
+    /**
+     * @brief Once the output queue is filled up to this level, only the collected data of the collection schemes
+     * with the highest priority (smallest PassThroughMetaData::priority) is pushed to it. The rest of the queue is
+     * kept for them.
+     */
+    static constexpr size_t OUTPUT_HIGH_PRIORITY_ONLY_FILL_PERCENT = 75;
+
     CollectionInspectionWorkerThread() = default;
     ~CollectionInspectionWorkerThread() override;
 
@@ -58,6 +81,13 @@ public:
      * @param outputCollectedData this thread will put data that should be sent to cloud into this queue
      * @param idleTimeMs if no new data is available sleep for this amount of milliseconds
      * @param dataReductionProbability set to true to disable data reduction using probability
+     * @param batchSize maximum number of signals and maximum number of raw CAN frames drained from the
+     * input queues before the conditions are evaluated. 0 means the default is used.
+     * @param batchMaxLatencyMs the conditions are evaluated as soon as the drained data spans this amount
+     * of milliseconds, even if the batch is not full. 0 means the default is used.
+     * @param numberOfShards number of inspection engines the conditions are distributed over, each running in its
+     * own thread pinned to one CPU. 0 or 1 means all conditions are inspected by this thread. At most
+     * MAX_NUMBER_OF_SHARDS.
      *
      * @return true if initialization was successful
      * */
@@ -66,7 +96,10 @@ public:
                const std::shared_ptr<ActiveDTCBuffer> &inputActiveDTCBuffer,
                const std::shared_ptr<CollectedDataReadyToPublish> &outputCollectedData,
                uint32_t idleTimeMs,
-               bool dataReductionProbability = false );
+               bool dataReductionProbability = false,
+               uint32_t batchSize = 0,
+               uint32_t batchMaxLatencyMs = 0,
+               uint32_t numberOfShards = 0 );
 
     /**
      * @brief stops the internal thread if started and wait until it finishes
@@ -93,11 +126,7 @@ public:
      * @param listener an InspectionEventListener instance
      * @return the outcome of the Listener interface subscribeListener()
      */
-    inline bool
-    subscribeToEvents( InspectionEventListener *listener )
-    {
-        return fCollectionInspectionEngine.subscribeListener( listener );
-    }
+    bool subscribeToEvents( InspectionEventListener *listener );
 
     /**
      * @brief unRegister a thread as a listener from the Inspection Engine events.
@@ -105,15 +134,47 @@ public:
      * @param listener an InspectionEventListener instance
      * @return the outcome of the Listener interface unSubscribeListener()
      */
-    inline bool
-    unSubscribeFromEvents( InspectionEventListener *listener )
-    {
-        return fCollectionInspectionEngine.unSubscribeListener( listener );
-    }
+    bool unSubscribeFromEvents( InspectionEventListener *listener );
 
 private:
     static constexpr Timestamp EVALUATE_INTERVAL_MS = 1; // Evaluate every millisecond
     static constexpr uint32_t DEFAULT_THREAD_IDLE_TIME_MS = 1000;
+    static constexpr uint32_t DEFAULT_BATCH_SIZE = 256;
+    static constexpr uint32_t DEFAULT_BATCH_MAX_LATENCY_MS = EVALUATE_INTERVAL_MS;
+    static constexpr size_t SHARD_INPUT_BUFFER_SIZE = 10000;
+    static constexpr size_t SHARD_ACTIVE_DTC_BUFFER_SIZE = 10;
+    static constexpr size_t SHARD_OUTPUT_BUFFER_SIZE = 100;
+
+    /**
+     * @brief Conditions of one shard. They still point into the expression nodes of the complete inspection
+     * matrix, so it is kept alive as long as the shard uses the conditions.
+     */
+    struct ShardInspectionMatrix : InspectionMatrix
+    {
+        std::shared_ptr<const InspectionMatrix> completeInspectionMatrix;
+    };
+
+    /**
+     * @brief Wakes up the dispatching thread as soon as a shard has collected data
+     */
+    class ShardDataReadyListener : public IDataReadyToPublishListener
+    {
+    public:
+        ShardDataReadyListener( Platform::Linux::Signal &wait )
+            : fWait( wait )
+        {
+        }
+        void
+        onDataReadyToPublish() override
+        {
+            fWait.notify();
+        }
+
+    private:
+        Platform::Linux::Signal &fWait;
+    };
+
+    using ShardMask = uint64_t;
 
     // Stop the  thread
     // Intercepts stop signals.
@@ -121,12 +182,86 @@ private:
 
     static void doWork( void *data );
 
+    /**
+     * @brief Main loop if the conditions are sharded. Only dispatches input data and merges the collected data.
+     */
+    static void doDispatchWork( void *data );
+
+    /**
+     * @brief Split the conditions of the inspection matrix over the shards and build the routing tables which
+     * signals and raw CAN frames are needed by which shards
+     */
+    void distributeInspectionMatrix( const std::shared_ptr<const InspectionMatrix> &inspectionMatrix );
+
+    /**
+     * @brief Pass up to fBatchSize signals and raw CAN frames from the input queues to the shards needing them
+     * @return number of consumed inputs
+     */
+    uint32_t dispatchInputs();
+
+    /**
+     * @brief Move the collected data of all shards to the output queue
+     * @return number of moved collected data
+     */
+    uint32_t mergeShardOutputs();
+
+    /**
+     * @brief Push collected data to the output queue according to the backpressure policy and notify the listeners
+     * @return True if the data was pushed, false if it was dropped
+     */
+    bool pushCollectedData( const TriggeredCollectionSchemeDataPtr &collectedData );
+
+    /**
+     * @return the smallest priority value of all conditions, which is the highest priority
+     */
+    static uint32_t getHighestPriority( const std::shared_ptr<const InspectionMatrix> &inspectionMatrix );
+
+    static inline uint64_t
+    getCanFrameRoutingKey( CANChannelNumericID channelID, CANRawFrameID frameID )
+    {
+        return ( static_cast<uint64_t>( channelID ) << 32 ) | frameID;
+    }
+
+    /**
+     * @brief Drain up to fBatchSize signals from the input signal buffer and pass them to the inspection engine
+     *
+     * Draining stops early as soon as the drained signals span fBatchMaxLatencyMs since lastInputTimeEvaluated.
+     * @param lastInputTimeEvaluated timestamp of the latest input when the conditions were evaluated last time
+     * @param latestSignalTime will be updated with the latest timestamp of the drained signals
+     * @return number of drained signals
+     */
+    uint32_t drainSignals( Timestamp lastInputTimeEvaluated, Timestamp &latestSignalTime );
+
+    /**
+     * @brief Drain up to fBatchSize raw CAN frames from the input CAN buffer and pass them to the inspection engine
+     *
+     * Draining stops early as soon as the drained frames span fBatchMaxLatencyMs since lastInputTimeEvaluated.
+     * @param lastInputTimeEvaluated timestamp of the latest input when the conditions were evaluated last time
+     * @param latestSignalTime will be updated with the latest timestamp of the drained frames
+     * @return number of drained frames
+     */
+    uint32_t drainCANFrames( Timestamp lastInputTimeEvaluated, Timestamp &latestSignalTime );
+
+    /**
+     * @brief Evaluate the conditions of the inspection engine and trace the execution time
+     * @param currentTime the time passed to the inspection engine
+     */
+    void evaluateConditions( Timestamp currentTime );
+
     CollectionInspectionEngine fCollectionInspectionEngine;
 
     std::shared_ptr<SignalBuffer> fInputSignalBuffer;
     std::shared_ptr<CANBuffer> fInputCANBuffer;
     std::shared_ptr<ActiveDTCBuffer> fInputActiveDTCBuffer;
     std::shared_ptr<CollectedDataReadyToPublish> fOutputCollectedData;
+    size_t fOutputCapacity{ 0 };
+    uint32_t fHighestPriority{ std::numeric_limits<uint32_t>::max() }; /**< of the current inspection matrix */
+    DropCounters<std::string> fDroppedCollectedData{ "CollectionInspectionWorkerThread::pushCollectedData",
+                                                     "collected data as the output buffer was full" };
+    DropCounters<SignalID> fDroppedShardSignals{ "CollectionInspectionWorkerThread::dispatchInputs",
+                                                 "signals as the input buffer of a shard was full" };
+    DropCounters<CANRawFrameID> fDroppedShardCANFrames{ "CollectionInspectionWorkerThread::dispatchInputs",
+                                                        "raw CAN frames as the input buffer of a shard was full" };
     Thread fThread;
     std::atomic<bool> fShouldStop{ false };
     std::atomic<bool> fUpdatedInspectionMatrixAvailable{ false };
@@ -136,6 +271,17 @@ private:
     Platform::Linux::Signal fWait;
     LoggingModule fLogger;
     uint32_t fIdleTimeMs{ DEFAULT_THREAD_IDLE_TIME_MS };
+    uint32_t fBatchSize{ DEFAULT_BATCH_SIZE };
+    uint32_t fBatchMaxLatencyMs{ DEFAULT_BATCH_MAX_LATENCY_MS };
+    std::vector<CollectedSignal> fSignalBatch;
+    bool fIsShard{ false }; /**< the input queues of a shard are not the queues traced by TraceModule */
+    uint32_t fShardIndex{ 0 };
+    std::unique_ptr<ShardDataReadyListener> fShardDataReadyListener; // must outlive the shards
+    std::vector<std::unique_ptr<CollectionInspectionWorkerThread>> fShards;
+    std::vector<SignalBuffer::Lane *> fShardSignalLanes; /**< lane of the dispatcher in the input buffer of a shard */
+    std::unordered_map<SignalID, ShardMask> fSignalRouting; /**< which shards need a signal */
+    std::unordered_map<uint64_t, ShardMask> fCanFrameRouting; /**< which shards need a raw CAN frame */
+    std::unordered_map<std::string, size_t> fConditionShards; /**< shard of each collection scheme ID */
     std::shared_ptr<const Clock> fClock = ClockHandler::getClock();
 };
 
@@ -106,7 +106,7 @@ public:
      * @param producerBufferPtr Pointer to the Producer
      */
     inline void
-    setInputBuffer( VehicleMessageCircularBufferPtr producerBufferPtr )
+    setInputBuffer( CANRawFrameCircularBufferPtr producerBufferPtr )
     {
         mInputBufferPtr = std::move( producerBufferPtr );
     }
@@ -120,6 +120,15 @@ public:
         return mID;
     }
 
+    /**
+     * @return the ID of the channel whose frames the consumer decodes, as passed to init
+     */
+    inline VehicleDataSourceID
+    getChannelID() const
+    {
+        return mDataSourceID;
+    }
+
     /**
      * @brief Set the consumption buffer of the consumer.
      */
@@ -152,7 +161,7 @@ protected:
 
     VehicleDataSourceID mDataSourceID;
     // Input Buffer on which the consumer will run the decoding rules.
-    VehicleMessageCircularBufferPtr mInputBufferPtr;
+    CANRawFrameCircularBufferPtr mInputBufferPtr;
     // shared pointer to decoder dictionary
     std::shared_ptr<const DecoderDictionary> mDecoderDictionaryConstPtr;
     // Signal Buffer shared pointer
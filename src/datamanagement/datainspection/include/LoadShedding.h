@@ -0,0 +1,165 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#pragma once
+
+#include "ClockHandler.h"
+#include "LoggingModule.h"
+#include "SignalTypes.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace DataInspection
+{
+using namespace Aws::IoTFleetWise::DataManagement;
+using namespace Aws::IoTFleetWise::Platform::Linux;
+
+/**
+ * @brief Counts the elements that were not pushed to a buffer, per signal, CAN frame or campaign, and logs them as
+ * one warning per LoggingModule::LOG_AGGREGATION_TIME_MS instead of one warning per element.
+ *
+ * Not thread safe, every producer has its own counters.
+ */
+template <typename Key>
+class DropCounters
+{
+public:
+    /**
+     * @param function name of the function used in the log
+     * @param description what is dropped, e.g. "signals", used in the log
+     */
+    DropCounters( std::string function, std::string description )
+        : mFunction( std::move( function ) )
+        , mDescription( std::move( description ) )
+    {
+    }
+
+    void
+    add( const Key &key, uint64_t count = 1 )
+    {
+        mCounters[key] += count;
+        mTotal += count;
+    }
+
+    /**
+     * @return number of dropped elements since the last log
+     */
+    uint64_t
+    getTotal() const
+    {
+        return mTotal;
+    }
+
+    /**
+     * @brief Logs and resets the counters if something was dropped and the last log is long enough ago. Cheap if
+     * nothing was dropped, so it can be called after every batch.
+     */
+    void
+    logIfDue()
+    {
+        if ( mTotal == 0 )
+        {
+            return;
+        }
+        auto currentTime = mClock->timeSinceEpochMs();
+        if ( ( mLastLogTime != 0 ) && ( currentTime < ( mLastLogTime + LoggingModule::LOG_AGGREGATION_TIME_MS ) ) )
+        {
+            return;
+        }
+        std::string counters;
+        for ( const auto &counter : mCounters )
+        {
+            counters += " " + toString( counter.first ) + ":" + std::to_string( counter.second );
+        }
+        mLogger.warn( mFunction,
+                      "Dropped " + std::to_string( mTotal ) + " " + mDescription + " since the last report." +
+                          " Dropped per ID:" + counters );
+        mCounters.clear();
+        mTotal = 0;
+        mLastLogTime = currentTime;
+    }
+
+private:
+    static std::string
+    toString( const std::string &key )
+    {
+        return key;
+    }
+
+    template <typename T>
+    static std::string
+    toString( T key )
+    {
+        return std::to_string( key );
+    }
+
+    std::string mFunction;
+    std::string mDescription;
+    std::unordered_map<Key, uint64_t> mCounters;
+    uint64_t mTotal{ 0 };
+    Timestamp mLastLogTime{ 0 };
+    std::shared_ptr<const Clock> mClock = ClockHandler::getClock();
+    LoggingModule mLogger;
+};
+
+/**
+ * @brief Backpressure policy of a producer of decoded signals, based on how full its lane of the signal buffer is.
+ *
+ * Below SAMPLE_DOWN_FILL_PERCENT all signals are pushed. Above it, signals that are not used by the conditions of the
+ * highest priority collection schemes are sampled down to one in SAMPLE_DOWN_FACTOR per signal. Above
+ * HIGH_PRIORITY_ONLY_FILL_PERCENT only the signals of these conditions are pushed, so that the rest of the lane is
+ * kept for them.
+ */
+class SignalLoadShedder
+{
+public:
+    static constexpr size_t SAMPLE_DOWN_FILL_PERCENT = 50;
+    static constexpr size_t HIGH_PRIORITY_ONLY_FILL_PERCENT = 90;
+    static constexpr uint32_t SAMPLE_DOWN_FACTOR = 4;
+
+    /**
+     * @brief Decides if a signal is pushed
+     * @param signalID the decoded signal
+     * @param fillPercent how full the lane is
+     * @param highPrioritySignalIDs signals used by the conditions of the highest priority collection schemes
+     * @return True if the signal should be pushed, false if it is shed
+     */
+    inline bool
+    shouldPush( SignalID signalID, size_t fillPercent, const std::unordered_set<SignalID> &highPrioritySignalIDs )
+    {
+        if ( fillPercent < SAMPLE_DOWN_FILL_PERCENT )
+        {
+            return true;
+        }
+        return shouldPushUnderPressure( signalID, fillPercent, highPrioritySignalIDs );
+    }
+
+private:
+    bool shouldPushUnderPressure( SignalID signalID,
+                                  size_t fillPercent,
+                                  const std::unordered_set<SignalID> &highPrioritySignalIDs );
+
+    std::unordered_map<SignalID, uint32_t> mSampleCounters;
+};
+
+} // namespace DataInspection
+} // namespace IoTFleetWise
+} // namespace Aws
@@ -18,16 +18,20 @@
 #include "CollectionInspectionAPITypes.h"
 #include "IActiveConditionProcessor.h"
 #include "IActiveDecoderDictionaryListener.h"
+#include "LoadShedding.h"
 #include "LoggingModule.h"
 #include "OBDDataDecoder.h"
 #include "OBDDataTypes.h"
 #include "OBDOverCANSessionManager.h"
+#include "OBDPIDScheduler.h"
 #include "Signal.h"
 #include "Thread.h"
 #include "Timer.h"
 #include "businterfaces/ISOTPOverCANSenderReceiver.h"
 #include <boost/lockfree/spsc_queue.hpp>
+#include <deque>
 #include <iostream>
+#include <memory>
 
 namespace Aws
 {
@@ -153,6 +157,42 @@ public:
     }
 
 private:
+    enum class OBDRequestType
+    {
+        VIN,
+        SUPPORTED_PIDS,
+        EMISSION_PIDS,
+        DTCS
+    };
+
+    struct OBDRequest
+    {
+        OBDRequestType type{ OBDRequestType::EMISSION_PIDS };
+        SID sid{ SID::INVALID_SERVICE_MODE };
+        std::vector<PID> pids;
+    };
+
+    // ISO-TP session to one ECU. At most one request per ECU is outstanding at any time, but the
+    // sessions to the different ECUs run concurrently.
+    struct ECUSession
+    {
+        uint32_t requestCANId{ 0 };
+        uint32_t responseCANId{ 0 };
+        std::unique_ptr<ISOTPOverCANSenderReceiver> senderReceiver;
+        std::map<SID, SupportedPIDs> supportedPIDs;
+        // PIDs supported by the ECU and needed by the decoder dictionary
+        std::map<SID, std::vector<PID>> pidsToRequest;
+        OBDPIDScheduler pidScheduler;
+        std::deque<OBDRequest> pendingRequests;
+        bool requestInFlight{ false };
+        OBDRequest activeRequest;
+        Timestamp responseDeadline{ 0 };
+        // Supported PIDs collected over the requests of the supported PID ranges
+        SupportedPIDs receivedSupportedPIDs;
+        bool supportedPIDsReceived{ false };
+        Timestamp nextSupportedPIDsRequestTime{ 0 };
+    };
+
     // Start the  thread
     bool start();
     // Stop the  thread
@@ -160,57 +200,63 @@ private:
     // Intercepts stop signals.
     bool shouldStop() const;
     // Main worker function. The following operations are coded by the function
-    // 1- Sends  Supported PIDs request to Engine and TX ECUs
+    // 1- Sends Supported PIDs request to all ECUs
     // 2- Stores the supported PIDs
     // Cyclically:
-    // 3- Send  PID requests ( up to 6 at a time )
-    // 4- waits for the response from the ECU
+    // 3- Queues the requests of the PIDs that are due ( up to 6 PIDs per request ) and of the DTCs
+    // 4- Sends the next request of each ECU and waits for the responses of all ECUs at once
     // 5- If an RX PDU arrives, decodes the value and puts the result to the
     // output buffer
     static void doWork( void *data );
 
-    // Receives the supported PID request to the specific ECU and SID
-    bool receiveSupportedPIDs( const SID &sid,
-                               ISOTPOverCANSenderReceiver &isoTPSendReceive,
-                               SupportedPIDs &supportedPIDs );
+    // Sends a functional Supported PIDs request and returns the CAN IDs of all ECUs that responded
+    // in the discovery window, as pairs of physical request and response IDs
+    std::vector<std::pair<uint32_t, uint32_t>> discoverECUs();
+    // Creates and connects the ISO-TP sessions of the discovered ECUs, or of the configured ECUs if none responded
+    bool connectECUs();
+    // Copies the decoder dictionary and the sample intervals over to the worker thread state
+    void applyConfigurationChanges( Timestamp now );
     // Update the PID Request List with PIDs that are common between decoder dictionary and the PIDs supported by ECU
-    void updatePIDRequestList( const SID &sid,
-                               const ECUType &type,
-                               std::map<SID, SupportedPIDs> &supportedPIDs,
-                               std::map<SID, std::vector<PID>> &pidsToRequestPerService );
-    // Request a set of PIDs from one ECU ( up to 6 PIDs at a time )
+    void updatePIDRequestList( const SID &sid, ECUSession &ecu );
+    // Derives the request interval of each PID the ECU should be asked for
+    void updatePIDSchedule( ECUSession &ecu, Timestamp now );
+    // Queues the requests that are due
+    void scheduleRequests( Timestamp now );
+    // Sends the next pending request of the ECU, if it is not already waiting for a response
+    void sendNextRequest( ECUSession &ecu, Timestamp now );
+    // Handles the response to the outstanding request of the ECU. An empty response means the request failed.
+    void handleResponse( ECUSession &ecu, const std::vector<uint8_t> &response, Timestamp now );
+    // Waits for responses of the ECUs with an outstanding request, at most until the given time
+    void waitForResponses( Timestamp until );
+    // Earliest time at which a request is due or a response times out
+    Timestamp getNextWakeUpTime() const;
+    bool requestsInFlight() const;
+    void pushEmissionInfo( const EmissionInfo &info );
+    std::string getECUName( const ECUSession &ecu ) const;
+
+    // Sends a request for the SID and up to 6 PIDs
     bool requestPIDs( const SID &sid, const std::vector<PID> &pids, ISOTPOverCANSenderReceiver &isoTPSendReceive );
-    bool receivePIDs( const SID &sid,
-                      const std::vector<PID> &pids,
-                      ISOTPOverCANSenderReceiver &isoTPSendReceive,
-                      EmissionInfo &info );
-
-    bool requestReceiveSupportedPIDs( const SID &sid,
-                                      ISOTPOverCANSenderReceiver &isoTPSendReceive,
-                                      SupportedPIDs &supportedPIDs );
-
-    bool requestReceiveEmissionPIDs( const SID &sid,
-                                     const SupportedPIDs &pids,
-                                     ISOTPOverCANSenderReceiver &isoTPSendReceive,
-                                     EmissionInfo &info );
-
-    // For SID 9/pid 0x02
-    bool requestReceiveVIN( std::string &vin );
-    // For SID 3 and 7
-    bool requestDTCs( const SID &sid, ISOTPOverCANSenderReceiver &isoTPSendReceive );
-    bool receiveDTCs( const SID &sid, ISOTPOverCANSenderReceiver &isoTPSendReceive, DTCInfo &info );
-    bool requestReceiveDTCs( const SID &sid, ISOTPOverCANSenderReceiver &isoTPSendReceive, DTCInfo &info );
 
     static constexpr size_t MAX_PID_RANGE = 6U;
+    // Time the ECUs get to respond to the functional discovery request
+    static constexpr uint32_t ECU_DISCOVERY_TIMEOUT_MS = 200U;
+    // No PID is requested more often than this, whatever the collection schemes ask for
+    static constexpr uint32_t MIN_PID_REQUEST_INTERVAL_MS = 100U;
     Thread mThread;
     std::atomic<bool> mShouldStop{ false };
     std::atomic<bool> mDecoderManifestAvailable{ false };
+    std::atomic<bool> mSignalIntervalsChanged{ false };
     std::atomic<bool> mShouldRequestDTCs{ false };
     mutable std::mutex mThreadMutex;
     LoggingModule mLogger;
     std::shared_ptr<const Clock> mClock = ClockHandler::getClock();
-    ISOTPOverCANSenderReceiver mEngineECUSenderReceiver;
-    ISOTPOverCANSenderReceiver mTransmissionECUSenderReceiver;
+    std::string mGatewayCanInterfaceName;
+    bool mUseExtendedIDs{ false };
+    // Sessions of all ECUs, the first one is asked for the VIN
+    std::vector<std::unique_ptr<ECUSession>> mECUs;
+    // Protects mECUs and the PIDs to request against concurrent reads from getPIDsToRequest
+    mutable std::mutex mECUsMutex;
+    int mEpollFd{ -1 };
     // Stop signal
     Platform::Linux::Signal mWait;
     // Decoder Manifest and campaigns availability Signal
@@ -219,34 +265,41 @@ private:
     std::vector<uint8_t> mRxPDU;
     // Signal Buffer shared pointer
     SignalBufferPtr mSignalBufferPtr;
+    // Own lane of the module in the Signal Buffer, and the signals of a response that are pushed to it as one batch
+    SignalBuffer::Lane *mSignalBufferLane{ nullptr };
+    std::vector<CollectedSignal> mCollectedSignals;
+    // OBD signals arrive at a low rate and are not shed, only the signals dropped because of a full lane are reported
+    DropCounters<SignalID> mDroppedSignals{ "OBDOverCANModule::pushEmissionInfo",
+                                            "signals as the Signal Buffer was full" };
     // Active DTC Buffer shared pointer
     ActiveDTCBufferPtr mActiveDTCBufferPtr;
     uint32_t mPIDRequestIntervalSeconds;
     uint32_t mDTCRequestIntervalSeconds;
-    uint32_t mOBDHeartBeatIntervalSeconds;
     bool mHasTransmission;
     std::string mVIN;
-    Timer mTimer;
-    Timer mDTCTimer;
-    Timer mPIDTimer;
-    // Supported PIDs for both ECUs
-    std::map<SID, SupportedPIDs> mSupportedPIDsEngine;
-    std::map<SID, SupportedPIDs> mSupportedPIDsTransmission;
-    // PIDs that are required by decoder dictionary
+    Timestamp mNextVINRequestTime{ 0 };
+    Timestamp mNextDTCRequestTime{ 0 };
+    // DTCs of the current DTC request round, pushed once all ECUs responded or timed out
+    DTCInfo mDTCInfo;
+    size_t mPendingDTCResponses{ 0 };
+    bool mDTCRequestSucceeded{ false };
+    // PIDs that are required by decoder dictionary, and the signals collected from each of them
     std::unordered_map<SID, std::vector<PID>> mPIDsRequestedByDecoderDict;
-    // The PIDs to request from ECUs. It will be the common PIDs that are required by
-    // decoder dictionary as well as supported by ECU
-    std::map<SID, std::vector<PID>> mPIDsToRequestEngine;
-    std::map<SID, std::vector<PID>> mPIDsToRequestTransmission;
-
-    // OBD Session Manager
-    // Will not be used. This is for Future use for ECU discovery.
-    // OBDOverCANSessionManager mSessionManager;
+    std::map<PID, std::vector<SignalID>> mPIDSignals;
+    // Shortest minimum sample interval of each signal of the inspection matrix
+    std::unordered_map<SignalID, uint32_t> mSignalIntervalsMs;
+
     std::unique_ptr<OBDDataDecoder> mOBDDataDecoder;
     // Mutex to ensure atomic decoder dictionary shared pointer content assignment
     std::mutex mDecoderDictMutex;
     // shared pointer to decoder dictionary
     std::shared_ptr<OBDDecoderDictionary> mDecoderDictionaryPtr;
+    // Decoder dictionary inputs handed over from onChangeOfActiveDictionary to the worker thread
+    std::vector<PID> mNewPIDsRequestedByDecoderDict;
+    std::map<PID, std::vector<SignalID>> mNewPIDSignals;
+    // Sample intervals handed over from onChangeInspectionMatrix to the worker thread
+    std::mutex mSignalIntervalsMutex;
+    std::unordered_map<SignalID, uint32_t> mNewSignalIntervalsMs;
 };
 } // namespace DataInspection
 } // namespace IoTFleetWise
@@ -0,0 +1,108 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#pragma once
+
+// Includes
+#include "OBDDataTypes.h"
+#include "SignalTypes.h"
+#include "TimeTypes.h"
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <unordered_map>
+#include <vector>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace DataInspection
+{
+using namespace Aws::IoTFleetWise::DataManagement;
+
+/**
+ * @brief Schedules the Mode 1 PID requests to one ECU, each PID at its own interval.
+ *
+ * Fast changing PIDs like the engine speed can be requested several times a second while slowly
+ * changing ones like the fuel level are only requested every few minutes. PIDs becoming due within
+ * SCHEDULING_TOLERANCE_MS are returned together, so that they can share one request.
+ */
+class OBDPIDScheduler
+{
+public:
+    static constexpr Timestamp SCHEDULING_TOLERANCE_MS = 50;
+    static constexpr Timestamp NOTHING_SCHEDULED = std::numeric_limits<Timestamp>::max();
+
+    /**
+     * @brief Derives the request interval of each PID from the sample intervals the collection schemes need
+     *
+     * A PID is requested at the shortest minimum sample interval of its collected signals. Signals without
+     * a minimum sample interval are requested at the default interval.
+     * @param pidSignals the collected signals of each PID
+     * @param signalIntervalsMs shortest non-zero minimum sample interval of each signal in the inspection matrix
+     * @param defaultIntervalMs interval for PIDs whose signals do not specify a minimum sample interval
+     * @param minIntervalMs PIDs are not requested more often than this
+     * @return request interval in milliseconds per PID
+     */
+    static std::map<PID, uint32_t> calculatePIDIntervals(
+        const std::map<PID, std::vector<SignalID>> &pidSignals,
+        const std::unordered_map<SignalID, uint32_t> &signalIntervalsMs,
+        uint32_t defaultIntervalMs,
+        uint32_t minIntervalMs );
+
+    /**
+     * @brief Sets the PIDs to request and their intervals.
+     * New PIDs are due immediately. PIDs that were already scheduled keep their due time, unless their
+     * new interval would make them due earlier.
+     * @param pidIntervalsMs request interval in milliseconds per PID. PIDs with an interval of zero are not requested.
+     * @param now current time in milliseconds
+     */
+    void setPIDIntervals( const std::map<PID, uint32_t> &pidIntervalsMs, Timestamp now );
+
+    /**
+     * @brief Returns the PIDs that are due and schedules their next request one interval from now
+     * @param now current time in milliseconds
+     * @return the due PIDs in ascending order
+     */
+    std::vector<PID> getDuePIDs( Timestamp now );
+
+    /**
+     * @brief Returns the time when the next PID is due, NOTHING_SCHEDULED if there are no PIDs
+     */
+    Timestamp getNextDueTime() const;
+
+    /**
+     * @brief Returns the request interval of the PID in milliseconds, zero if the PID is not scheduled
+     */
+    uint32_t getInterval( PID pid ) const;
+
+    bool
+    empty() const
+    {
+        return mSchedule.empty();
+    }
+
+private:
+    struct ScheduledPID
+    {
+        uint32_t intervalMs;
+        Timestamp nextDueTime;
+    };
+    // Ordered by PID, so that the due PIDs are sorted
+    std::map<PID, ScheduledPID> mSchedule;
+};
+
+} // namespace DataInspection
+} // namespace IoTFleetWise
+} // namespace Aws
@@ -15,7 +15,12 @@
 #include "ClockHandler.h"
 #include "TraceModule.h"
 #include <algorithm>
+#include <array>
+#include <cmath>
+#include <functional>
 #include <iostream>
+#include <memory>
+#include <type_traits>
 
 namespace Aws
 {
@@ -27,14 +32,19 @@ namespace DataInspection
 CollectionInspectionEngine::CollectionInspectionEngine( bool sendDataOnlyOncePerCondition )
     : mSendDataOnlyOncePerCondition( sendDataOnlyOncePerCondition )
 {
-    setActiveDTCsConsumed( ALL_CONDITIONS, false );
 }
 
+constexpr uint32_t CollectionInspectionEngine::CONSUMED_FLAGS_BYTES_PER_SAMPLE;
+constexpr CollectionInspectionEngine::InspectionSignalID CollectionInspectionEngine::MAX_DIRECT_INDEXED_SIGNAL_ID;
+constexpr uint32_t CollectionInspectionEngine::INVALID_SIGNAL_BUFFER_INDEX;
+constexpr uint32_t CollectionInspectionEngine::MAX_CONDITION_STACK_SIZE;
+
 CollectionInspectionEngine::SignalHistoryBuffer &
-CollectionInspectionEngine::addSignalToBuffer( const InspectionMatrixSignalCollectionInfo &signal )
+CollectionInspectionEngine::addSignalToBuffer( const InspectionMatrixSignalCollectionInfo &signal,
+                                               SignalHistoryBufferCollection &signalBuffers )
 {
-
-    for ( auto &buffer : mSignalBuffers[signal.signalID] )
+    auto &buffers = signalBuffers[signal.signalID];
+    for ( auto &buffer : buffers )
     {
         if ( buffer.mMinimumSampleIntervalMs == signal.minimumSampleIntervalMs )
         {
@@ -43,8 +53,60 @@ CollectionInspectionEngine::addSignalToBuffer( const InspectionMatrixSignalColle
         }
     }
     // No entry with same sample interval found
-    mSignalBuffers[signal.signalID].emplace_back( signal.sampleBufferSize, signal.minimumSampleIntervalMs );
-    return mSignalBuffers[signal.signalID].back();
+    buffers.emplace_back( signal.signalID, signal.sampleBufferSize, signal.minimumSampleIntervalMs );
+    return buffers.back();
+}
+
+void
+CollectionInspectionEngine::buildSignalBufferIndex( SignalHistoryBufferCollection &signalBuffers )
+{
+    size_t numberOfBuffers = 0;
+    InspectionSignalID maxDirectIndexedID = 0;
+    for ( const auto &buffers : signalBuffers )
+    {
+        numberOfBuffers += buffers.second.size();
+        if ( buffers.first <= MAX_DIRECT_INDEXED_SIGNAL_ID )
+        {
+            maxDirectIndexedID = std::max( maxDirectIndexedID, buffers.first );
+        }
+    }
+    // Reserve first so pointers into mSignalBuffers never get invalidated
+    mSignalBuffers.reserve( numberOfBuffers );
+    if ( !signalBuffers.empty() )
+    {
+        mSignalBufferDirectIndex.assign( maxDirectIndexedID + 1, INVALID_SIGNAL_BUFFER_INDEX );
+    }
+    // std::map iterates ordered by signal ID so mSignalBufferSortedIndex is sorted
+    for ( auto &buffers : signalBuffers )
+    {
+        auto index = static_cast<uint32_t>( mSignalBuffers.size() );
+        if ( buffers.first <= MAX_DIRECT_INDEXED_SIGNAL_ID )
+        {
+            mSignalBufferDirectIndex[buffers.first] = index;
+        }
+        else
+        {
+            mSignalBufferSortedIndex.emplace_back( buffers.first, index );
+        }
+        for ( auto &buffer : buffers.second )
+        {
+            mSignalBuffers.emplace_back( std::move( buffer ) );
+        }
+    }
+}
+
+CollectionInspectionEngine::SignalHistoryBuffer *
+CollectionInspectionEngine::findSignalBuffer( InspectionSignalID id, uint32_t minimumSampleIntervalMs )
+{
+    for ( auto i = getSignalBufferIndex( id ); ( i < mSignalBuffers.size() ) && ( mSignalBuffers[i].mSignalID == id );
+          i++ )
+    {
+        if ( mSignalBuffers[i].mMinimumSampleIntervalMs == minimumSampleIntervalMs )
+        {
+            return &mSignalBuffers[i];
+        }
+    }
+    return nullptr;
 }
 
 bool
@@ -76,11 +138,30 @@ void
 CollectionInspectionEngine::onChangeInspectionMatrix(
     const std::shared_ptr<const InspectionMatrix> &activeInspectionMatrix )
 {
-    // Clears everything in this class including all data in the signal history buffer
+    // Conditions and history buffers that are still needed with the new inspection matrix keep their state and
+    // samples, so changing one collection scheme causes no gap in the data of the others. Everything set up for the
+    // previous inspection matrix is moved out here and carried over once the new buffers are set up.
+    PreviousInspectionState previous;
+    previous.mInspectionMatrix = std::move( mActiveInspectionMatrix );
+    previous.mSignalBuffers = std::move( mSignalBuffers );
+    previous.mCanFrameBuffers = std::move( mCanFrameBuffers );
+    previous.mSampleArenas = std::move( mSampleArenas );
+    previous.mConditions = std::move( mConditions );
+    previous.mConditionsWithInputSignalChanged = std::move( mConditionsWithInputSignalChanged );
+    previous.mConditionsWithConditionCurrentlyTrue = std::move( mConditionsWithConditionCurrentlyTrue );
+    previous.mConditionsNotTriggeredWaitingPublished = std::move( mConditionsNotTriggeredWaitingPublished );
     clear();
     mActiveInspectionMatrix = activeInspectionMatrix; // Pointers and references into this memory are maintained so hold
                                                       // a shared_ptr to it so it does not get deleted
-    mConditionsNotTriggeredWaitingPublished.set();
+    // One bit per condition that can become active
+    auto numberOfConditions =
+        std::min<size_t>( mActiveInspectionMatrix->conditions.size(), MAX_NUMBER_OF_ACTIVE_CONDITION );
+    mConditions.reserve( numberOfConditions );
+    mConditionsWithInputSignalChanged.resize( numberOfConditions, false );
+    mConditionsWithConditionCurrentlyTrue.resize( numberOfConditions, false );
+    mConditionsNotTriggeredWaitingPublished.resize( numberOfConditions, true );
+    mConditionsToEvaluate.resize( numberOfConditions, false );
+    SignalHistoryBufferCollection signalBuffers;
     for ( auto &p : mActiveInspectionMatrix->conditions )
     {
         // Check if we can add an additional condition to mConditions
@@ -100,6 +181,7 @@ CollectionInspectionEngine::onChangeInspectionMatrix(
             mLogger.error( "CollectionInspectionEngine::onChangeInspectionMatrix",
                            "There can be only " + std::to_string( MAX_DIFFERENT_SIGNAL_IDS ) +
                                " different signal IDs" );
+            compileConditions();
             return;
         }
         for ( auto &s : p.signals )
@@ -108,6 +190,7 @@ CollectionInspectionEngine::onChangeInspectionMatrix(
             {
                 mLogger.error( "CollectionInspectionEngine::onChangeInspectionMatrix",
                                "A SignalID with value" + std::to_string( INVALID_SIGNAL_ID ) + " is not allowed" );
+                compileConditions();
                 return;
             }
             if ( s.sampleBufferSize == 0 )
@@ -115,9 +198,10 @@ CollectionInspectionEngine::onChangeInspectionMatrix(
                 TraceModule::get().incrementVariable( TraceVariable::CE_SAMPLE_SIZE_ZERO );
                 mLogger.error( "CollectionInspectionEngine::onChangeInspectionMatrix",
                                "A Sample buffer size of 0 is not allowed" );
+                compileConditions();
                 return;
             }
-            SignalHistoryBuffer &buf = addSignalToBuffer( s );
+            SignalHistoryBuffer &buf = addSignalToBuffer( s, signalBuffers );
             buf.addFixedWindow( s.fixedWindowPeriod );
         }
         for ( auto &c : p.canFrames )
@@ -140,24 +224,21 @@ CollectionInspectionEngine::onChangeInspectionMatrix(
         }
     }
 
-    // At this point all buffers should be resized to correct size. Now pointer to std::vector elements can be used
+    // Remap the signal IDs to one flat array of buffers. After this pointers to its elements can be used
+    buildSignalBufferIndex( signalBuffers );
     for ( size_t conditionIndex = 0; conditionIndex < mConditions.size(); conditionIndex++ )
     {
         auto &ac = mConditions[conditionIndex];
         for ( auto &s : ac.mCondition.signals )
         {
-            SignalHistoryBuffer *buf = nullptr;
-            for ( auto &buffer : mSignalBuffers[s.signalID] )
+            SignalHistoryBuffer *buf = findSignalBuffer( s.signalID, s.minimumSampleIntervalMs );
+            if ( buf != nullptr && isSignalPartOfEval( ac.mCondition.condition, s.signalID, MAX_EQUATION_DEPTH ) )
             {
-                if ( buffer.mMinimumSampleIntervalMs == s.minimumSampleIntervalMs )
+                if ( buf->mConditionsThatEvaluateOnThisSignal.empty() ||
+                     buf->mConditionsThatEvaluateOnThisSignal.back() != conditionIndex )
                 {
-                    buf = &buffer;
-                    break;
+                    buf->mConditionsThatEvaluateOnThisSignal.push_back( static_cast<uint32_t>( conditionIndex ) );
                 }
-            }
-            if ( buf != nullptr && isSignalPartOfEval( ac.mCondition.condition, s.signalID, MAX_EQUATION_DEPTH ) )
-            {
-                buf->mConditionsThatEvaluateOnThisSignal.set( conditionIndex );
                 ac.mEvaluationSignals[s.signalID] = buf;
                 FixedTimeWindowFunctionData *window = buf->getFixedWindow( s.fixedWindowPeriod );
                 if ( window != nullptr )
@@ -166,42 +247,91 @@ CollectionInspectionEngine::onChangeInspectionMatrix(
                 }
             }
         }
+        setupCollectedBuffers( ac );
     }
 
-    // Assume all conditions are currently true;
+    // All signals and window functions are resolved so the conditions can be compiled
+    compileConditions();
+
+    // Assume all new conditions are currently true;
     mConditionsWithConditionCurrentlyTrue.set();
 
-    (void)preAllocateBuffers();
+    (void)preAllocateBuffers( previous );
+    carryOverConditionState( previous );
+}
+
+template <typename HistoryBuffer, typename CopySample>
+void
+CollectionInspectionEngine::carryOverSamples( const HistoryBuffer &previousBuffer,
+                                              HistoryBuffer &buffer,
+                                              CopySample copySample )
+{
+    buffer.mLastSample = previousBuffer.mLastSample;
+    if ( buffer.mBuffer == previousBuffer.mBuffer )
+    {
+        // Same ringbuffer, the samples stay where they are
+        buffer.mCurrentPosition = previousBuffer.mCurrentPosition;
+        buffer.mCounter = previousBuffer.mCounter;
+        return;
+    }
+    if ( ( buffer.mBuffer == nullptr ) || ( previousBuffer.mBuffer == nullptr ) )
+    {
+        return;
+    }
+    // The counter limits how many samples are collected, so it must not be bigger than the number of samples in the
+    // ringbuffer until it was filled once
+    auto count = std::min( std::min( previousBuffer.mCounter, previousBuffer.mSize ), buffer.mSize );
+    auto from = ( previousBuffer.mCurrentPosition + previousBuffer.mSize + 1 - count ) % previousBuffer.mSize;
+    for ( uint32_t to = 0; to < count; to++ )
+    {
+        copySample( from, to );
+        from = ( from + 1 ) % previousBuffer.mSize;
+    }
+    buffer.mCounter = count;
+    buffer.mCurrentPosition = ( count == 0 ) ? ( buffer.mSize - 1 ) : ( count - 1 );
+}
+
+template <typename HistoryBuffer>
+uint32_t
+CollectionInspectionEngine::carryOverConsumedCounter( const CollectedBuffer<HistoryBuffer> &previousCollectedBuffer,
+                                                      const HistoryBuffer &buffer )
+{
+    // The counter of a buffer that got a new ringbuffer starts again at the number of copied samples. The samples
+    // that were not copied are the oldest ones.
+    auto droppedSamples = previousCollectedBuffer.mBuffer->mCounter - buffer.mCounter;
+    return ( previousCollectedBuffer.mConsumedCounter > droppedSamples )
+               ? ( previousCollectedBuffer.mConsumedCounter - droppedSamples )
+               : 0U;
 }
+
 bool
-CollectionInspectionEngine::preAllocateBuffers()
+CollectionInspectionEngine::preAllocateBuffers( PreviousInspectionState &previous )
 {
-    // Allocate size
-    uint32_t usedBytes = 0;
-    // Allocate Signal Buffer
-    for ( auto &bufferVector : mSignalBuffers )
+    static_assert( std::is_trivially_destructible<SignalSample>::value &&
+                       std::is_trivially_destructible<CanFrameSample>::value,
+                   "Samples in the arena are never destructed" );
+    static_assert( ( sizeof( SignalSample ) % alignof( CanFrameSample ) ) == 0,
+                   "Can frame samples must stay aligned when placed behind the signal samples" );
+    bool allFit = true;
+    // First calculate the size of all ringbuffers. Buffers not fitting into MAX_SAMPLE_MEMORY get no memory
+    uint64_t usedBytes = 0;
+    uint64_t numberOfSamples = 0;
+    for ( auto &signal : mSignalBuffers )
     {
-        // Go trough different sample intervals
-        for ( auto &signal : bufferVector.second )
+        uint64_t requiredBytes = signal.mSize * static_cast<uint64_t>( sizeof( struct SignalSample ) );
+        if ( usedBytes + requiredBytes > MAX_SAMPLE_MEMORY )
         {
-            uint64_t requiredBytes = signal.mSize * static_cast<uint64_t>( sizeof( struct SignalSample ) );
-            if ( usedBytes + requiredBytes > MAX_SAMPLE_MEMORY )
-            {
-                mLogger.warn( "CollectionInspectionEngine::preAllocateBuffers",
-                              "The requested " + std::to_string( signal.mSize ) +
-                                  " number of signal samples leads to a memory requirement  that's above the maximum "
-                                  "configured of " +
-                                  std::to_string( MAX_SAMPLE_MEMORY ) + "Bytes" );
-                signal.mSize = 0;
-                return false;
-            }
-            usedBytes += static_cast<uint32_t>( requiredBytes );
-
-            // reserve the size like new[]
-            signal.mBuffer.resize( signal.mSize );
+            mLogger.warn( "CollectionInspectionEngine::preAllocateBuffers",
+                          "The requested " + std::to_string( signal.mSize ) +
+                              " number of signal samples leads to a memory requirement  that's above the maximum "
+                              "configured of " +
+                              std::to_string( MAX_SAMPLE_MEMORY ) + "Bytes" );
+            signal.mSize = 0;
+            allFit = false;
         }
+        usedBytes += signal.mSize * static_cast<uint64_t>( sizeof( struct SignalSample ) );
+        numberOfSamples += signal.mSize;
     }
-    // Allocate Can buffer
     for ( auto &buf : mCanFrameBuffers )
     {
         uint64_t requiredBytes = buf.mSize * static_cast<uint64_t>( sizeof( struct CanFrameSample ) );
@@ -213,43 +343,295 @@ CollectionInspectionEngine::preAllocateBuffers()
                               "configured of" +
                               std::to_string( MAX_SAMPLE_MEMORY ) + "Bytes" );
             buf.mSize = 0;
-            return false;
+            allFit = false;
+        }
+        usedBytes += buf.mSize * static_cast<uint64_t>( sizeof( struct CanFrameSample ) );
+        numberOfSamples += buf.mSize;
+    }
+    mSampleMemoryBytes = usedBytes;
+    // Consumption is tracked with one watermark per condition and buffer instead of flags in every sample
+    TraceModule::get().setVariable( TraceVariable::CE_SAMPLE_MEMORY_SAVED_BYTES,
+                                    numberOfSamples * CONSUMED_FLAGS_BYTES_PER_SAMPLE );
+
+    // Buffers that existed before with the same size keep their ringbuffer. The previous buffers are sorted by
+    // signal ID like the new ones, so they are matched in one pass.
+    std::vector<const SignalHistoryBuffer *> previousSignals( mSignalBuffers.size(), nullptr );
+    std::vector<CanFrameHistoryBuffer *> previousCanFrames( mCanFrameBuffers.size(), nullptr );
+    uint64_t newBytes = 0;
+    size_t previousIndex = 0;
+    for ( size_t i = 0; i < mSignalBuffers.size(); i++ )
+    {
+        auto &signal = mSignalBuffers[i];
+        while ( ( previousIndex < previous.mSignalBuffers.size() ) &&
+                ( previous.mSignalBuffers[previousIndex].mSignalID < signal.mSignalID ) )
+        {
+            previousIndex++;
+        }
+        for ( auto j = previousIndex; ( j < previous.mSignalBuffers.size() ) &&
+                                      ( previous.mSignalBuffers[j].mSignalID == signal.mSignalID );
+              j++ )
+        {
+            if ( previous.mSignalBuffers[j].hasSameSource( signal ) )
+            {
+                previousSignals[i] = &previous.mSignalBuffers[j];
+                break;
+            }
+        }
+        if ( ( previousSignals[i] != nullptr ) && ( previousSignals[i]->mSize == signal.mSize ) )
+        {
+            signal.mBuffer = previousSignals[i]->mBuffer;
+        }
+        else
+        {
+            newBytes += signal.mSize * static_cast<uint64_t>( sizeof( struct SignalSample ) );
+        }
+    }
+    for ( size_t i = 0; i < mCanFrameBuffers.size(); i++ )
+    {
+        auto &buf = mCanFrameBuffers[i];
+        for ( auto &previousBuf : previous.mCanFrameBuffers )
+        {
+            if ( previousBuf.hasSameSource( buf ) )
+            {
+                previousCanFrames[i] = &previousBuf;
+                break;
+            }
+        }
+        if ( ( previousCanFrames[i] != nullptr ) && ( previousCanFrames[i]->mSize == buf.mSize ) )
+        {
+            buf.mBuffer = previousCanFrames[i]->mBuffer;
+        }
+        else
+        {
+            newBytes += buf.mSize * static_cast<uint64_t>( sizeof( struct CanFrameSample ) );
         }
-        usedBytes += static_cast<uint32_t>( requiredBytes );
+    }
 
-        // reserve the size like new[]
-        buf.mBuffer.resize( buf.mSize );
+    // Keep the arenas that still hold ringbuffers of buffers in use
+    auto isInArena = []( const void *ringbuffer, const SampleArena &arena ) {
+        auto start = reinterpret_cast<const void *>( arena.mMemory.get() );
+        auto end = reinterpret_cast<const void *>( arena.mMemory.get() + arena.mSize );
+        return ( ringbuffer != nullptr ) && ( std::less_equal<const void *>()( start, ringbuffer ) ) &&
+               ( std::less<const void *>()( ringbuffer, end ) );
+    };
+    std::vector<bool> arenaInUse( previous.mSampleArenas.size(), false );
+    uint64_t keptArenaBytes = 0;
+    for ( size_t i = 0; i < previous.mSampleArenas.size(); i++ )
+    {
+        const auto &arena = previous.mSampleArenas[i];
+        arenaInUse[i] =
+            std::any_of( mSignalBuffers.begin(),
+                         mSignalBuffers.end(),
+                         [&]( const SignalHistoryBuffer &signal ) { return isInArena( signal.mBuffer, arena ); } ) ||
+            std::any_of( mCanFrameBuffers.begin(), mCanFrameBuffers.end(), [&]( const CanFrameHistoryBuffer &buf ) {
+                return isInArena( buf.mBuffer, arena );
+            } );
+        keptArenaBytes += arenaInUse[i] ? arena.mSize : 0U;
     }
-    return true;
+    if ( ( keptArenaBytes + newBytes > 2 * usedBytes ) || ( keptArenaBytes + newBytes > MAX_SAMPLE_MEMORY ) )
+    {
+        // Too much memory of the kept arenas is unused, so move all ringbuffers to one new arena
+        for ( auto &signal : mSignalBuffers )
+        {
+            signal.mBuffer = nullptr;
+        }
+        for ( auto &buf : mCanFrameBuffers )
+        {
+            buf.mBuffer = nullptr;
+        }
+        newBytes = usedBytes;
+        std::fill( arenaInUse.begin(), arenaInUse.end(), false );
+    }
+    for ( size_t i = 0; i < previous.mSampleArenas.size(); i++ )
+    {
+        if ( arenaInUse[i] )
+        {
+            mSampleArenas.emplace_back( std::move( previous.mSampleArenas[i] ) );
+        }
+    }
+
+    // One allocation for the ringbuffers of all new or resized buffers. Signal samples come first followed by the
+    // can frame samples
+    uint8_t *next = nullptr;
+    if ( newBytes > 0 )
+    {
+        SampleArena arena;
+        arena.mMemory.reset( new uint8_t[newBytes] );
+        arena.mSize = newBytes;
+        next = arena.mMemory.get();
+        mSampleArenas.emplace_back( std::move( arena ) );
+    }
+    for ( size_t i = 0; i < mSignalBuffers.size(); i++ )
+    {
+        auto &signal = mSignalBuffers[i];
+        if ( ( signal.mSize > 0 ) && ( signal.mBuffer == nullptr ) )
+        {
+            signal.mBuffer = reinterpret_cast<SignalSample *>( next );
+            std::uninitialized_fill_n( signal.mBuffer, signal.mSize, SignalSample() );
+            next += signal.mSize * sizeof( struct SignalSample );
+        }
+        const auto previousSignal = previousSignals[i];
+        if ( previousSignal == nullptr )
+        {
+            continue;
+        }
+        carryOverSamples( *previousSignal, signal, [&signal, previousSignal]( uint32_t from, uint32_t to ) {
+            signal.mBuffer[to] = previousSignal->mBuffer[from];
+        } );
+        for ( auto &window : signal.mWindowFunctionData )
+        {
+            for ( const auto &previousWindow : previousSignal->mWindowFunctionData )
+            {
+                if ( previousWindow.mWindowSizeMs == window.mWindowSizeMs )
+                {
+                    window = previousWindow;
+                }
+            }
+        }
+    }
+    for ( size_t i = 0; i < mCanFrameBuffers.size(); i++ )
+    {
+        auto &buf = mCanFrameBuffers[i];
+        if ( ( buf.mSize > 0 ) && ( buf.mBuffer == nullptr ) )
+        {
+            buf.mBuffer = reinterpret_cast<CanFrameSample *>( next );
+            std::uninitialized_fill_n( buf.mBuffer, buf.mSize, CanFrameSample() );
+            next += buf.mSize * sizeof( struct CanFrameSample );
+        }
+        auto previousBuf = previousCanFrames[i];
+        if ( previousBuf == nullptr )
+        {
+            continue;
+        }
+        if ( buf.mBuffer == previousBuf->mBuffer )
+        {
+            buf.mFdPayloads = std::move( previousBuf->mFdPayloads );
+            buf.mFdPayloadsUnavailable = previousBuf->mFdPayloadsUnavailable;
+            mSampleMemoryBytes += buf.mFdPayloads.size();
+        }
+        else if ( ( buf.mBuffer != nullptr ) && ( !previousBuf->mFdPayloads.empty() ) )
+        {
+            allocateFdPayloads( buf );
+        }
+        carryOverSamples( *previousBuf, buf, [&buf, previousBuf]( uint32_t from, uint32_t to ) {
+            auto &sample = buf.mBuffer[to];
+            sample = previousBuf->mBuffer[from];
+            if ( sample.mSize <= sample.mBuffer.size() )
+            {
+                return;
+            }
+            auto payload = previousBuf->mFdPayloads.begin() + ( from * MAX_CAN_FRAME_BYTE_SIZE );
+            if ( buf.mFdPayloads.empty() )
+            {
+                // No memory left for the CAN FD payloads of this buffer
+                sample.mSize = static_cast<uint8_t>( sample.mBuffer.size() );
+                std::copy( payload, payload + sample.mSize, sample.mBuffer.begin() );
+            }
+            else
+            {
+                std::copy(
+                    payload, payload + sample.mSize, buf.mFdPayloads.begin() + ( to * MAX_CAN_FRAME_BYTE_SIZE ) );
+            }
+        } );
+    }
+    TraceModule::get().setVariable( TraceVariable::CE_SAMPLE_MEMORY_BYTES, mSampleMemoryBytes );
+    mLogger.trace( "CollectionInspectionEngine::preAllocateBuffers",
+                   "Allocated " + std::to_string( newBytes ) + " of " + std::to_string( usedBytes ) +
+                       " bytes for samples, " + std::to_string( mSampleArenas.size() ) + " arenas in use" );
+    return allFit;
+}
+
+void
+CollectionInspectionEngine::carryOverConditionState( const PreviousInspectionState &previous )
+{
+    // Several conditions can have the same ID, e.g. if it is empty, so they are matched in order
+    std::unordered_map<std::string, std::vector<uint32_t>> previousConditionsByID;
+    for ( auto i = static_cast<uint32_t>( previous.mConditions.size() ); i > 0; i-- )
+    {
+        previousConditionsByID[previous.mConditions[i - 1].mCollectionSchemeID].push_back( i - 1 );
+    }
+    uint32_t carriedOverConditions = 0;
+    for ( uint32_t i = 0; i < mConditions.size(); i++ )
+    {
+        auto it = previousConditionsByID.find( mConditions[i].mCollectionSchemeID );
+        if ( ( it == previousConditionsByID.end() ) || it->second.empty() )
+        {
+            continue;
+        }
+        auto previousIndex = it->second.back();
+        it->second.pop_back();
+        const auto &previousCondition = previous.mConditions[previousIndex];
+        auto &condition = mConditions[i];
+        condition.mLastDataTimestampPublished = previousCondition.mLastDataTimestampPublished;
+        condition.mLastTrigger = previousCondition.mLastTrigger;
+        condition.mActiveDTCsConsumedCounter = previousCondition.mActiveDTCsConsumedCounter;
+        condition.mEventID = previousCondition.mEventID;
+        mConditionsWithInputSignalChanged[i] = previous.mConditionsWithInputSignalChanged[previousIndex];
+        mConditionsWithConditionCurrentlyTrue[i] = previous.mConditionsWithConditionCurrentlyTrue[previousIndex];
+        mConditionsNotTriggeredWaitingPublished[i] = previous.mConditionsNotTriggeredWaitingPublished[previousIndex];
+        for ( auto &collectedSignal : condition.mCollectedSignals )
+        {
+            for ( const auto &previousCollectedSignal : previousCondition.mCollectedSignals )
+            {
+                if ( previousCollectedSignal.mBuffer->hasSameSource( *collectedSignal.mBuffer ) )
+                {
+                    collectedSignal.mConsumedCounter =
+                        carryOverConsumedCounter( previousCollectedSignal, *collectedSignal.mBuffer );
+                    break;
+                }
+            }
+        }
+        for ( auto &collectedCanFrame : condition.mCollectedCanFrames )
+        {
+            for ( const auto &previousCollectedCanFrame : previousCondition.mCollectedCanFrames )
+            {
+                if ( previousCollectedCanFrame.mBuffer->hasSameSource( *collectedCanFrame.mBuffer ) )
+                {
+                    collectedCanFrame.mConsumedCounter =
+                        carryOverConsumedCounter( previousCollectedCanFrame, *collectedCanFrame.mBuffer );
+                    break;
+                }
+            }
+        }
+        carriedOverConditions++;
+    }
+    mLogger.trace( "CollectionInspectionEngine::carryOverConditionState",
+                   "Carried over the state of " + std::to_string( carriedOverConditions ) + " of " +
+                       std::to_string( mConditions.size() ) + " conditions" );
 }
 
 void
 CollectionInspectionEngine::clear()
 {
     mSignalBuffers.clear();
+    mSignalBufferDirectIndex.clear();
+    mSignalBufferSortedIndex.clear();
     mCanFrameBuffers.clear();
+    mSampleArenas.clear();
+    mSampleMemoryBytes = 0;
     mConditions.clear();
     mNextConditionToCollectedIndex = 0;
     mNextWindowFunctionTimesOut = 0;
-    mConditionsWithInputSignalChanged.reset();
-    mConditionsWithConditionCurrentlyTrue.reset();
-    mConditionsNotTriggeredWaitingPublished.reset();
+    mConditionsWithInputSignalChanged.clear();
+    mConditionsWithConditionCurrentlyTrue.clear();
+    mConditionsNotTriggeredWaitingPublished.clear();
+    mConditionsToEvaluate.clear();
 }
 
 void
 CollectionInspectionEngine::updateAllFixedWindowFunctions( InspectionTimestamp timestamp )
 {
     mNextWindowFunctionTimesOut = std::numeric_limits<InspectionTimestamp>::max();
-    for ( auto &signalVector : mSignalBuffers )
+    for ( auto &signal : mSignalBuffers )
     {
-        for ( auto &signal : signalVector.second )
+        for ( auto &functionWindow : signal.mWindowFunctionData )
         {
-            for ( auto &functionWindow : signal.mWindowFunctionData )
+            bool changed = functionWindow.updateWindow( timestamp, mNextWindowFunctionTimesOut );
+            if ( changed )
             {
-                bool changed = functionWindow.updateWindow( timestamp, mNextWindowFunctionTimesOut );
-                if ( changed )
+                for ( auto conditionIndex : signal.mConditionsThatEvaluateOnThisSignal )
                 {
-                    mConditionsWithInputSignalChanged |= signal.mConditionsThatEvaluateOnThisSignal;
+                    mConditionsWithInputSignalChanged.set( conditionIndex );
                 }
             }
         }
@@ -265,42 +647,42 @@ CollectionInspectionEngine::evaluateConditions( InspectionTimestamp currentTime
     {
         updateAllFixedWindowFunctions( currentTime );
     }
-    auto conditionsToEvaluate = ( mConditionsWithConditionCurrentlyTrue | mConditionsWithInputSignalChanged ) &
-                                mConditionsNotTriggeredWaitingPublished;
-    if ( conditionsToEvaluate.none() )
+    // Assigning a set of the same size reuses the memory of mConditionsToEvaluate
+    mConditionsToEvaluate = mConditionsWithConditionCurrentlyTrue;
+    mConditionsToEvaluate |= mConditionsWithInputSignalChanged;
+    mConditionsToEvaluate &= mConditionsNotTriggeredWaitingPublished;
+    if ( mConditionsToEvaluate.none() )
     {
         // No conditions to evaluate
         return false;
     }
-    // faster implementation like find next bit set to one would be possible but for example
-    // conditionsToEvaluate._Find_first is not part of C++ standard
-    for ( uint32_t i = 0; i < mConditions.size(); i++ )
+    for ( auto bit = mConditionsToEvaluate.find_first(); bit != ConditionSet::npos;
+          bit = mConditionsToEvaluate.find_next( bit ) )
     {
-        if ( conditionsToEvaluate.test( i ) )
+        auto i = static_cast<uint32_t>( bit );
+        ActiveCondition &condition = mConditions[i];
+        if ( ( currentTime >= condition.mLastTrigger + condition.mCondition.minimumPublishInterval ) )
         {
-            ActiveCondition &condition = mConditions[i];
-            if ( ( currentTime >= condition.mLastTrigger + condition.mCondition.minimumPublishInterval ) )
+            InspectionValue result = 0;
+            bool resultBool = false;
+            mConditionsWithInputSignalChanged.reset( i );
+            ExpressionErrorCode ret =
+                mUseRecursiveEvaluation
+                    ? eval( condition.mCondition.condition, condition, result, resultBool, MAX_EQUATION_DEPTH )
+                    : evalInstructions( condition, resultBool );
+            if ( ret == ExpressionErrorCode::SUCCESSFUL && resultBool )
             {
-                InspectionValue result = 0;
-                bool resultBool = false;
-                mConditionsWithInputSignalChanged.reset( i );
-                ExpressionErrorCode ret =
-                    eval( condition.mCondition.condition, condition, result, resultBool, MAX_EQUATION_DEPTH );
-                if ( ret == ExpressionErrorCode::SUCCESSFUL && resultBool )
-                {
-                    if ( !condition.mCondition.triggerOnlyOnRisingEdge ||
-                         !mConditionsWithConditionCurrentlyTrue.test( i ) )
-                    {
-                        mConditionsNotTriggeredWaitingPublished.reset( i );
-                        condition.mLastTrigger = currentTime;
-                    }
-                    mConditionsWithConditionCurrentlyTrue.set( i );
-                    oneConditionIsTrue = true;
-                }
-                else
+                if ( !condition.mCondition.triggerOnlyOnRisingEdge || !mConditionsWithConditionCurrentlyTrue.test( i ) )
                 {
-                    mConditionsWithConditionCurrentlyTrue.reset( i );
+                    mConditionsNotTriggeredWaitingPublished.reset( i );
+                    condition.mLastTrigger = currentTime;
                 }
+                mConditionsWithConditionCurrentlyTrue.set( i );
+                oneConditionIsTrue = true;
+            }
+            else
+            {
+                mConditionsWithConditionCurrentlyTrue.reset( i );
             }
         }
     }
@@ -308,128 +690,152 @@ CollectionInspectionEngine::evaluateConditions( InspectionTimestamp currentTime
 }
 
 void
-CollectionInspectionEngine::collectLastSignals( InspectionSignalID id,
-                                                uint32_t minimumSamplingInterval,
-                                                uint32_t maxNumberOfSignalsToCollect,
-                                                uint32_t conditionId,
+CollectionInspectionEngine::setupCollectedBuffers( ActiveCondition &condition )
+{
+    for ( auto &s : condition.mCondition.signals )
+    {
+        if ( s.isConditionOnlySignal )
+        {
+            continue;
+        }
+        SignalHistoryBuffer *buf = findSignalBuffer( s.signalID, s.minimumSampleIntervalMs );
+        if ( buf == nullptr )
+        {
+            continue;
+        }
+        // The same buffer listed twice shares one watermark, otherwise data would be sent out twice
+        auto it = std::find_if( condition.mCollectedSignals.begin(),
+                                condition.mCollectedSignals.end(),
+                                [buf]( const CollectedBuffer<SignalHistoryBuffer> &c ) { return c.mBuffer == buf; } );
+        if ( it != condition.mCollectedSignals.end() )
+        {
+            it->mMaxNumberOfSamples = std::max( it->mMaxNumberOfSamples, s.sampleBufferSize );
+            continue;
+        }
+        condition.mCollectedSignals.emplace_back( buf, s.sampleBufferSize );
+    }
+    for ( auto &c : condition.mCondition.canFrames )
+    {
+        auto bufIt =
+            std::find_if( mCanFrameBuffers.begin(), mCanFrameBuffers.end(), [&c]( const CanFrameHistoryBuffer &b ) {
+                return b.mFrameID == c.frameID && b.mChannelID == c.channelID &&
+                       b.mMinimumSampleIntervalMs == c.minimumSampleIntervalMs;
+            } );
+        if ( bufIt == mCanFrameBuffers.end() )
+        {
+            continue;
+        }
+        CanFrameHistoryBuffer *buf = &( *bufIt );
+        auto it = std::find_if( condition.mCollectedCanFrames.begin(),
+                                condition.mCollectedCanFrames.end(),
+                                [buf]( const CollectedBuffer<CanFrameHistoryBuffer> &f ) { return f.mBuffer == buf; } );
+        if ( it != condition.mCollectedCanFrames.end() )
+        {
+            it->mMaxNumberOfSamples = std::max( it->mMaxNumberOfSamples, c.sampleBufferSize );
+            continue;
+        }
+        condition.mCollectedCanFrames.emplace_back( buf, c.sampleBufferSize );
+    }
+}
+
+void
+CollectionInspectionEngine::collectLastSignals( CollectedBuffer<SignalHistoryBuffer> &collectedBuffer,
                                                 InspectionTimestamp &newestSignalTimestamp,
                                                 std::vector<CollectedSignal> &output )
 {
-    if ( mSignalBuffers[id].empty() )
+    auto &buf = *collectedBuffer.mBuffer;
+    if ( buf.mBuffer == nullptr )
     {
-        // Signal not collected by any active condition
+        // No memory available
         return;
     }
-    // Iterate through all sampling intervals of the signal
-    for ( auto &buf : mSignalBuffers[id] )
+    // Samples newer than the watermark were not yet sent out by this condition
+    uint32_t newSamples = buf.mCounter - collectedBuffer.mConsumedCounter;
+    int pos = static_cast<int>( buf.mCurrentPosition );
+    for ( uint32_t i = 0; i < std::min( collectedBuffer.mMaxNumberOfSamples, buf.mCounter ); i++ )
     {
-        if ( buf.mMinimumSampleIntervalMs == minimumSamplingInterval && buf.mSize > 0 )
+        // Ensure access is in bounds
+        if ( pos < 0 )
         {
-            int pos = static_cast<int>( buf.mCurrentPosition );
-            for ( uint32_t i = 0; i < std::min( maxNumberOfSignalsToCollect, buf.mCounter ); i++ )
-            {
-                // Ensure access is in bounds
-                if ( pos < 0 )
-                {
-                    pos = static_cast<int>( buf.mSize ) - 1;
-                }
-                if ( pos >= static_cast<int>( buf.mSize ) )
-                {
-                    pos = 0;
-                }
-                auto &sample = buf.mBuffer[static_cast<uint32_t>( pos )];
-                if ( !sample.isAlreadyConsumed( conditionId ) || !mSendDataOnlyOncePerCondition )
-                {
-                    output.emplace_back( id, sample.mTimestamp, sample.mValue );
-                    sample.setAlreadyConsumed( conditionId, true );
-                }
-                newestSignalTimestamp = std::max( newestSignalTimestamp, sample.mTimestamp );
-                pos--;
-            }
-            return;
+            pos = static_cast<int>( buf.mSize ) - 1;
+        }
+        if ( pos >= static_cast<int>( buf.mSize ) )
+        {
+            pos = 0;
         }
+        const auto &sample = buf.mBuffer[static_cast<uint32_t>( pos )];
+        if ( i < newSamples || !mSendDataOnlyOncePerCondition )
+        {
+            output.emplace_back( buf.mSignalID, sample.mTimestamp, sample.mValue );
+        }
+        newestSignalTimestamp = std::max( newestSignalTimestamp, sample.mTimestamp );
+        pos--;
     }
+    // Older samples can never be collected again as only the newest samples are collected
+    collectedBuffer.mConsumedCounter = buf.mCounter;
 }
 
 void
-CollectionInspectionEngine::collectLastCanFrames( CANRawFrameID canID,
-                                                  CANChannelNumericID channelID,
-                                                  uint32_t minimumSamplingInterval,
-                                                  uint32_t maxNumberOfSignalsToCollect,
-                                                  uint32_t conditionId,
+CollectionInspectionEngine::collectLastCanFrames( CollectedBuffer<CanFrameHistoryBuffer> &collectedBuffer,
                                                   InspectionTimestamp &newestSignalTimestamp,
                                                   std::vector<CollectedCanRawFrame> &output )
 {
-    for ( auto &buf : mCanFrameBuffers )
+    auto &buf = *collectedBuffer.mBuffer;
+    if ( buf.mBuffer == nullptr )
     {
-        if ( buf.mFrameID == canID && buf.mChannelID == channelID &&
-             buf.mMinimumSampleIntervalMs == minimumSamplingInterval )
+        // No memory available
+        return;
+    }
+    uint32_t newSamples = buf.mCounter - collectedBuffer.mConsumedCounter;
+    int pos = static_cast<int>( buf.mCurrentPosition );
+    for ( uint32_t i = 0; i < std::min( collectedBuffer.mMaxNumberOfSamples, buf.mCounter ); i++ )
+    {
+        // Ensure access is in bounds
+        if ( pos < 0 )
         {
-            int pos = static_cast<int>( buf.mCurrentPosition );
-            for ( uint32_t i = 0; i < std::min( maxNumberOfSignalsToCollect, buf.mCounter ); i++ )
-            {
-                // Ensure access is in bounds
-                if ( pos < 0 )
-                {
-                    pos = static_cast<int>( buf.mSize ) - 1;
-                }
-                if ( pos >= static_cast<int>( buf.mSize ) )
-                {
-                    pos = 0;
-                }
-                auto &sample = buf.mBuffer[static_cast<uint32_t>( pos )];
-                if ( !sample.isAlreadyConsumed( conditionId ) || !mSendDataOnlyOncePerCondition )
-                {
-                    output.emplace_back( canID, channelID, sample.mTimestamp, sample.mBuffer, sample.mSize );
-                    sample.setAlreadyConsumed( conditionId, true );
-                }
-                newestSignalTimestamp = std::max( newestSignalTimestamp, sample.mTimestamp );
-                pos--;
-            }
-            return;
+            pos = static_cast<int>( buf.mSize ) - 1;
+        }
+        if ( pos >= static_cast<int>( buf.mSize ) )
+        {
+            pos = 0;
         }
+        auto &sample = buf.mBuffer[static_cast<uint32_t>( pos )];
+        if ( i < newSamples || !mSendDataOnlyOncePerCondition )
+        {
+            const uint8_t *payload = ( sample.mSize <= sample.mBuffer.size() )
+                                         ? sample.mBuffer.data()
+                                         : &buf.mFdPayloads[static_cast<uint32_t>( pos ) * MAX_CAN_FRAME_BYTE_SIZE];
+            output.emplace_back( buf.mFrameID, buf.mChannelID, sample.mTimestamp, payload, sample.mSize );
+        }
+        newestSignalTimestamp = std::max( newestSignalTimestamp, sample.mTimestamp );
+        pos--;
     }
+    collectedBuffer.mConsumedCounter = buf.mCounter;
 }
 
 std::shared_ptr<const TriggeredCollectionSchemeData>
-CollectionInspectionEngine::collectData( ActiveCondition &condition,
-                                         uint32_t conditionId,
-                                         InspectionTimestamp &newestSignalTimestamp )
+CollectionInspectionEngine::collectData( ActiveCondition &condition, InspectionTimestamp &newestSignalTimestamp )
 {
     std::shared_ptr<TriggeredCollectionSchemeData> collectedData = std::make_shared<TriggeredCollectionSchemeData>();
     collectedData->metaData = condition.mCondition.metaData;
     collectedData->triggerTime = condition.mLastTrigger;
     // Pack signals
-    for ( auto &s : condition.mCondition.signals )
+    for ( auto &collectedSignal : condition.mCollectedSignals )
     {
-        if ( !s.isConditionOnlySignal )
-        {
-            collectLastSignals( s.signalID,
-                                s.minimumSampleIntervalMs,
-                                s.sampleBufferSize,
-                                conditionId,
-                                newestSignalTimestamp,
-                                collectedData->signals );
-        }
+        collectLastSignals( collectedSignal, newestSignalTimestamp, collectedData->signals );
     }
 
     // Pack raw frames
-    for ( auto &c : condition.mCondition.canFrames )
+    for ( auto &collectedCanFrame : condition.mCollectedCanFrames )
     {
-        collectLastCanFrames( c.frameID,
-                              c.channelID,
-                              c.minimumSampleIntervalMs,
-                              c.sampleBufferSize,
-                              conditionId,
-                              newestSignalTimestamp,
-                              collectedData->canFrames );
+        collectLastCanFrames( collectedCanFrame, newestSignalTimestamp, collectedData->canFrames );
     }
     // Pack active DTCs if any
     if ( condition.mCondition.includeActiveDtcs &&
-         ( !isActiveDTCsConsumed( conditionId ) || mSendDataOnlyOncePerCondition ) )
+         ( ( condition.mActiveDTCsConsumedCounter != mActiveDTCsCounter ) || mSendDataOnlyOncePerCondition ) )
     {
         collectedData->mDTCInfo = mActiveDTCs;
-        setActiveDTCsConsumed( conditionId, true );
+        condition.mActiveDTCsConsumedCounter = mActiveDTCsCounter;
     }
     // Pack geohash into data sender buffer if there's new geohash.
     // A new geohash is generated during geohash function node evaluation
@@ -473,7 +879,7 @@ CollectionInspectionEngine::collectNextDataToSend( InspectionTimestamp currentTi
                     evaluateAndTriggerRichSensorCapture( condition );
                     // Return the collected data
                     InspectionTimestamp newestSignalTimeStamp = 0;
-                    auto cd = collectData( condition, mNextConditionToCollectedIndex, newestSignalTimeStamp );
+                    auto cd = collectData( condition, newestSignalTimeStamp );
                     // After collecting the data set the newest timestamp from any data that was
                     // collected
                     condition.mLastDataTimestampPublished = std::min( newestSignalTimeStamp, currentTime );
@@ -529,15 +935,12 @@ CollectionInspectionEngine::addNewSignal( InspectionSignalID id,
                                           InspectionTimestamp receiveTime,
                                           InspectionValue value )
 {
-    if ( mSignalBuffers.find( id ) == mSignalBuffers.end() || mSignalBuffers[id].empty() )
-    {
-        // Signal not collected by any active condition
-        return;
-    }
     // Iterate through all sampling intervals of the signal
-    for ( auto &buf : mSignalBuffers[id] )
+    for ( auto i = getSignalBufferIndex( id ); ( i < mSignalBuffers.size() ) && ( mSignalBuffers[i].mSignalID == id );
+          i++ )
     {
-        if ( buf.mSize > 0 && buf.mSize <= buf.mBuffer.size() &&
+        auto &buf = mSignalBuffers[i];
+        if ( buf.mBuffer != nullptr &&
              ( buf.mMinimumSampleIntervalMs == 0 ||
                ( receiveTime >= buf.mLastSample + buf.mMinimumSampleIntervalMs ) ) )
         {
@@ -548,18 +951,29 @@ CollectionInspectionEngine::addNewSignal( InspectionSignalID id,
             }
             buf.mBuffer[buf.mCurrentPosition].mValue = value;
             buf.mBuffer[buf.mCurrentPosition].mTimestamp = receiveTime;
-            buf.mBuffer[buf.mCurrentPosition].setAlreadyConsumed( ALL_CONDITIONS, false );
             buf.mCounter++;
             buf.mLastSample = receiveTime;
             for ( auto &window : buf.mWindowFunctionData )
             {
                 window.addValue( value, receiveTime, mNextWindowFunctionTimesOut );
             }
-            mConditionsWithInputSignalChanged |= buf.mConditionsThatEvaluateOnThisSignal;
+            for ( auto conditionIndex : buf.mConditionsThatEvaluateOnThisSignal )
+            {
+                mConditionsWithInputSignalChanged.set( conditionIndex );
+            }
         }
     }
 }
 
+void
+CollectionInspectionEngine::addNewSignals( const CollectedSignal *signals, size_t count )
+{
+    for ( size_t i = 0; i < count; i++ )
+    {
+        addNewSignal( signals[i].signalID, signals[i].receiveTime, signals[i].value );
+    }
+}
+
 void
 CollectionInspectionEngine::addNewRawCanFrame( CANRawFrameID canID,
                                                CANChannelNumericID channelID,
@@ -571,7 +985,7 @@ CollectionInspectionEngine::addNewRawCanFrame( CANRawFrameID canID,
     {
         if ( buf.mFrameID == canID && buf.mChannelID == channelID )
         {
-            if ( buf.mSize > 0 && buf.mSize <= buf.mBuffer.size() &&
+            if ( buf.mBuffer != nullptr &&
                  ( buf.mMinimumSampleIntervalMs == 0 ||
                    ( receiveTime >= buf.mLastSample + buf.mMinimumSampleIntervalMs ) ) )
             {
@@ -580,13 +994,30 @@ CollectionInspectionEngine::addNewRawCanFrame( CANRawFrameID canID,
                 {
                     buf.mCurrentPosition = 0;
                 }
-                buf.mBuffer[buf.mCurrentPosition].mSize = std::min( size, static_cast<uint8_t>( buf.mBuffer.size() ) );
-                for ( size_t i = 0; i < buf.mBuffer[buf.mCurrentPosition].mSize; i++ )
+                auto &sample = buf.mBuffer[buf.mCurrentPosition];
+                sample.mSize = std::min( size, MAX_CAN_FRAME_BYTE_SIZE );
+                if ( ( sample.mSize > sample.mBuffer.size() ) && buf.mFdPayloads.empty() &&
+                     ( !buf.mFdPayloadsUnavailable ) )
+                {
+                    allocateFdPayloads( buf );
+                }
+                if ( sample.mSize <= sample.mBuffer.size() )
                 {
-                    buf.mBuffer[buf.mCurrentPosition].mBuffer[i] = buffer[i];
+                    std::copy( buffer.begin(), buffer.begin() + sample.mSize, sample.mBuffer.begin() );
                 }
-                buf.mBuffer[buf.mCurrentPosition].mTimestamp = receiveTime;
-                buf.mBuffer[buf.mCurrentPosition].setAlreadyConsumed( ALL_CONDITIONS, false );
+                else if ( !buf.mFdPayloads.empty() )
+                {
+                    std::copy( buffer.begin(),
+                               buffer.begin() + sample.mSize,
+                               buf.mFdPayloads.begin() + ( buf.mCurrentPosition * MAX_CAN_FRAME_BYTE_SIZE ) );
+                }
+                else
+                {
+                    // No memory left for the CAN FD payloads of this buffer
+                    sample.mSize = static_cast<uint8_t>( sample.mBuffer.size() );
+                    std::copy( buffer.begin(), buffer.begin() + sample.mSize, sample.mBuffer.begin() );
+                }
+                sample.mTimestamp = receiveTime;
                 buf.mCounter++;
                 buf.mLastSample = receiveTime;
             }
@@ -594,10 +1025,29 @@ CollectionInspectionEngine::addNewRawCanFrame( CANRawFrameID canID,
     }
 }
 
+void
+CollectionInspectionEngine::allocateFdPayloads( CanFrameHistoryBuffer &buf )
+{
+    uint64_t requiredBytes = buf.mSize * static_cast<uint64_t>( MAX_CAN_FRAME_BYTE_SIZE );
+    if ( mSampleMemoryBytes + requiredBytes > MAX_SAMPLE_MEMORY )
+    {
+        mLogger.warn( "CollectionInspectionEngine::allocateFdPayloads",
+                      "No memory left for CAN FD payloads of frame " + std::to_string( buf.mFrameID ) +
+                          ", payloads are truncated to " + std::to_string( MAX_CLASSIC_CAN_FRAME_BYTE_SIZE ) +
+                          " bytes" );
+        // Do not try again for every frame
+        buf.mFdPayloadsUnavailable = true;
+        return;
+    }
+    buf.mFdPayloads.resize( static_cast<size_t>( requiredBytes ) );
+    mSampleMemoryBytes += requiredBytes;
+    TraceModule::get().setVariable( TraceVariable::CE_SAMPLE_MEMORY_BYTES, mSampleMemoryBytes );
+}
+
 void
 CollectionInspectionEngine::setActiveDTCs( const DTCInfo &activeDTCs )
 {
-    setActiveDTCsConsumed( ALL_CONDITIONS, false );
+    mActiveDTCsCounter++;
     mActiveDTCs = activeDTCs;
 }
 
@@ -613,13 +1063,18 @@ CollectionInspectionEngine::getLatestSignalValue( InspectionSignalID id,
         // Signal not collected by any active condition
         return ExpressionErrorCode::SIGNAL_NOT_FOUND;
     }
-    SignalHistoryBuffer *s = mapLookup->second;
-    if ( s->mCounter == 0 )
+    return getLatestSignalValue( *mapLookup->second, result );
+}
+
+CollectionInspectionEngine::ExpressionErrorCode
+CollectionInspectionEngine::getLatestSignalValue( const SignalHistoryBuffer &signal, InspectionValue &result )
+{
+    if ( signal.mCounter == 0 )
     {
         // Not a single sample collected yet
         return ExpressionErrorCode::SIGNAL_NOT_FOUND;
     }
-    result = s->mBuffer[s->mCurrentPosition].mValue;
+    result = signal.mBuffer[signal.mCurrentPosition].mValue;
     return ExpressionErrorCode::SUCCESSFUL;
 }
 
@@ -635,31 +1090,40 @@ CollectionInspectionEngine::getSampleWindowFunction( WindowFunction function,
         // Signal not collected by any active condition
         return ExpressionErrorCode::SIGNAL_NOT_FOUND;
     }
-    auto w = mapLookup->second;
+    return getWindowFunctionValue( function, *mapLookup->second, result );
+}
 
+CollectionInspectionEngine::ExpressionErrorCode
+CollectionInspectionEngine::getWindowFunctionValue( WindowFunction function,
+                                                    const FixedTimeWindowFunctionData &window,
+                                                    InspectionValue &result )
+{
     switch ( function )
     {
     case WindowFunction::LAST_FIXED_WINDOW_AVG:
-        result = w->mLastAvg;
-        return w->mLastAvailable ? ExpressionErrorCode::SUCCESSFUL : ExpressionErrorCode::FUNCTION_DATA_NOT_AVAILABLE;
+        result = window.mLastAvg;
+        return window.mLastAvailable ? ExpressionErrorCode::SUCCESSFUL
+                                     : ExpressionErrorCode::FUNCTION_DATA_NOT_AVAILABLE;
     case WindowFunction::LAST_FIXED_WINDOW_MIN:
-        result = w->mLastMin;
-        return w->mLastAvailable ? ExpressionErrorCode::SUCCESSFUL : ExpressionErrorCode::FUNCTION_DATA_NOT_AVAILABLE;
+        result = window.mLastMin;
+        return window.mLastAvailable ? ExpressionErrorCode::SUCCESSFUL
+                                     : ExpressionErrorCode::FUNCTION_DATA_NOT_AVAILABLE;
     case WindowFunction::LAST_FIXED_WINDOW_MAX:
-        result = w->mLastMax;
-        return w->mLastAvailable ? ExpressionErrorCode::SUCCESSFUL : ExpressionErrorCode::FUNCTION_DATA_NOT_AVAILABLE;
+        result = window.mLastMax;
+        return window.mLastAvailable ? ExpressionErrorCode::SUCCESSFUL
+                                     : ExpressionErrorCode::FUNCTION_DATA_NOT_AVAILABLE;
     case WindowFunction::PREV_LAST_FIXED_WINDOW_AVG:
-        result = w->mPreviousLastAvg;
-        return w->mPreviousLastAvailable ? ExpressionErrorCode::SUCCESSFUL
-                                         : ExpressionErrorCode::FUNCTION_DATA_NOT_AVAILABLE;
+        result = window.mPreviousLastAvg;
+        return window.mPreviousLastAvailable ? ExpressionErrorCode::SUCCESSFUL
+                                             : ExpressionErrorCode::FUNCTION_DATA_NOT_AVAILABLE;
     case WindowFunction::PREV_LAST_FIXED_WINDOW_MIN:
-        result = w->mPreviousLastMin;
-        return w->mPreviousLastAvailable ? ExpressionErrorCode::SUCCESSFUL
-                                         : ExpressionErrorCode::FUNCTION_DATA_NOT_AVAILABLE;
+        result = window.mPreviousLastMin;
+        return window.mPreviousLastAvailable ? ExpressionErrorCode::SUCCESSFUL
+                                             : ExpressionErrorCode::FUNCTION_DATA_NOT_AVAILABLE;
     case WindowFunction::PREV_LAST_FIXED_WINDOW_MAX:
-        result = w->mPreviousLastMax;
-        return w->mPreviousLastAvailable ? ExpressionErrorCode::SUCCESSFUL
-                                         : ExpressionErrorCode::FUNCTION_DATA_NOT_AVAILABLE;
+        result = window.mPreviousLastMax;
+        return window.mPreviousLastAvailable ? ExpressionErrorCode::SUCCESSFUL
+                                             : ExpressionErrorCode::FUNCTION_DATA_NOT_AVAILABLE;
     default:
         return ExpressionErrorCode::NOT_IMPLEMENTED_FUNCTION;
     }
@@ -669,11 +1133,28 @@ CollectionInspectionEngine::ExpressionErrorCode
 CollectionInspectionEngine::getGeohashFunctionNode( const struct ExpressionNode *expression,
                                                     ActiveCondition &condition,
                                                     bool &resultValueBool )
+{
+    const auto &geohashFunction = expression->function.geohashFunction;
+    auto latitudeSignal = condition.mEvaluationSignals.find( geohashFunction.latitudeSignalID );
+    auto longitudeSignal = condition.mEvaluationSignals.find( geohashFunction.longitudeSignalID );
+    return getGeohashFunctionNode(
+        geohashFunction,
+        latitudeSignal == condition.mEvaluationSignals.end() ? nullptr : latitudeSignal->second,
+        longitudeSignal == condition.mEvaluationSignals.end() ? nullptr : longitudeSignal->second,
+        resultValueBool );
+}
+
+CollectionInspectionEngine::ExpressionErrorCode
+CollectionInspectionEngine::getGeohashFunctionNode( const GeohashFunction &geohashFunction,
+                                                    const SignalHistoryBuffer *latitudeSignal,
+                                                    const SignalHistoryBuffer *longitudeSignal,
+                                                    bool &resultValueBool )
 {
     resultValueBool = false;
     // First we need to grab Latitude / longitude signal from collected signal buffer
     InspectionValue latitude = 0;
-    auto status = getLatestSignalValue( expression->function.geohashFunction.latitudeSignalID, condition, latitude );
+    auto status = latitudeSignal == nullptr ? ExpressionErrorCode::SIGNAL_NOT_FOUND
+                                            : getLatestSignalValue( *latitudeSignal, latitude );
     if ( status != ExpressionErrorCode::SUCCESSFUL )
     {
         mLogger.warn( "CollectionInspectionEngine::getGeohashFunctionNode",
@@ -681,20 +1162,306 @@ CollectionInspectionEngine::getGeohashFunctionNode( const struct ExpressionNode
         return status;
     }
     InspectionValue longitude = 0;
-    status = getLatestSignalValue( expression->function.geohashFunction.longitudeSignalID, condition, longitude );
+    status = longitudeSignal == nullptr ? ExpressionErrorCode::SIGNAL_NOT_FOUND
+                                        : getLatestSignalValue( *longitudeSignal, longitude );
     if ( status != ExpressionErrorCode::SUCCESSFUL )
     {
         mLogger.warn( "CollectionInspectionEngine::getGeohashFunctionNode",
                       "Unable to evaluate Geohash due to missing longitude signal!" );
         return status;
     }
-    resultValueBool = mGeohashFunctionNode.evaluateGeohash( latitude,
-                                                            longitude,
-                                                            expression->function.geohashFunction.precision,
-                                                            expression->function.geohashFunction.gpsUnitType );
+    resultValueBool = mGeohashFunctionNode.evaluateGeohash(
+        latitude, longitude, geohashFunction.precision, geohashFunction.gpsUnitType );
+    return ExpressionErrorCode::SUCCESSFUL;
+}
+
+void
+CollectionInspectionEngine::compileConditions()
+{
+    for ( auto &condition : mConditions )
+    {
+        condition.mInstructions.clear();
+        compileExpression( condition.mCondition.condition, condition, MAX_EQUATION_DEPTH );
+
+        // Verify the stack of the stack machine can never overflow. If the expression tree could be compiled
+        // this is guaranteed by MAX_EQUATION_DEPTH.
+        uint32_t stackSize = 0;
+        uint32_t maxStackSize = 0;
+        for ( const auto &instruction : condition.mInstructions )
+        {
+            if ( instruction.mOpCode == ConditionOpCode::FAIL )
+            {
+                // Evaluation stops here
+                break;
+            }
+            switch ( instruction.mOpCode )
+            {
+            case ConditionOpCode::PUSH_FLOAT:
+            case ConditionOpCode::PUSH_BOOLEAN:
+            case ConditionOpCode::PUSH_SIGNAL:
+            case ConditionOpCode::PUSH_WINDOW_FUNCTION:
+            case ConditionOpCode::GEOHASH:
+                stackSize++;
+                break;
+            case ConditionOpCode::LOGICAL_NOT:
+                break;
+            default:
+                // Binary operators take two operands and push one result
+                stackSize--;
+                break;
+            }
+            maxStackSize = std::max( maxStackSize, stackSize );
+        }
+        if ( maxStackSize > MAX_CONDITION_STACK_SIZE )
+        {
+            mLogger.warn( "CollectionInspectionEngine::compileConditions",
+                          "Condition needs a stack of " + std::to_string( maxStackSize ) +
+                              " so it can't be evaluated" );
+            condition.mInstructions.clear();
+            ConditionInstruction instruction;
+            instruction.mOpCode = ConditionOpCode::FAIL;
+            instruction.mErrorCode = ExpressionErrorCode::STACK_DEPTH_REACHED;
+            condition.mInstructions.emplace_back( instruction );
+        }
+    }
+}
+
+void
+CollectionInspectionEngine::compileExpression( const struct ExpressionNode *expression,
+                                               ActiveCondition &condition,
+                                               int remainingStackDepth )
+{
+    ConditionInstruction instruction;
+    if ( remainingStackDepth <= 0 || expression == nullptr )
+    {
+        mLogger.warn( "CollectionInspectionEngine::compileExpression", "STACK_DEPTH_REACHED or nullptr" );
+        instruction.mOpCode = ConditionOpCode::FAIL;
+        instruction.mErrorCode = ExpressionErrorCode::STACK_DEPTH_REACHED;
+        condition.mInstructions.emplace_back( instruction );
+        return;
+    }
+    switch ( expression->nodeType )
+    {
+    case ExpressionNodeType::FLOAT:
+        instruction.mOpCode = ConditionOpCode::PUSH_FLOAT;
+        instruction.mFloatingValue = expression->floatingValue;
+        condition.mInstructions.emplace_back( instruction );
+        return;
+    case ExpressionNodeType::BOOLEAN:
+        instruction.mOpCode = ConditionOpCode::PUSH_BOOLEAN;
+        instruction.mBooleanValue = expression->booleanValue;
+        condition.mInstructions.emplace_back( instruction );
+        return;
+    case ExpressionNodeType::SIGNAL:
+    {
+        auto signal = condition.mEvaluationSignals.find( expression->signalID );
+        if ( signal == condition.mEvaluationSignals.end() || signal->second == nullptr )
+        {
+            mLogger.warn( "CollectionInspectionEngine::compileExpression", "SIGNAL_NOT_FOUND" );
+            instruction.mOpCode = ConditionOpCode::FAIL;
+            instruction.mErrorCode = ExpressionErrorCode::SIGNAL_NOT_FOUND;
+        }
+        else
+        {
+            instruction.mOpCode = ConditionOpCode::PUSH_SIGNAL;
+            instruction.mSignal = signal->second;
+        }
+        condition.mInstructions.emplace_back( instruction );
+        return;
+    }
+    case ExpressionNodeType::WINDOWFUNCTION:
+    {
+        auto window = condition.mEvaluationFunctions.find( expression->signalID );
+        if ( window == condition.mEvaluationFunctions.end() || window->second == nullptr )
+        {
+            instruction.mOpCode = ConditionOpCode::FAIL;
+            instruction.mErrorCode = ExpressionErrorCode::SIGNAL_NOT_FOUND;
+        }
+        else
+        {
+            instruction.mOpCode = ConditionOpCode::PUSH_WINDOW_FUNCTION;
+            instruction.mWindowFunction = expression->function.windowFunction;
+            instruction.mWindow = window->second;
+        }
+        condition.mInstructions.emplace_back( instruction );
+        return;
+    }
+    case ExpressionNodeType::GEOHASHFUNCTION:
+    {
+        const auto &geohashFunction = expression->function.geohashFunction;
+        auto latitudeSignal = condition.mEvaluationSignals.find( geohashFunction.latitudeSignalID );
+        auto longitudeSignal = condition.mEvaluationSignals.find( geohashFunction.longitudeSignalID );
+        instruction.mOpCode = ConditionOpCode::GEOHASH;
+        instruction.mGeohashFunction = &geohashFunction;
+        instruction.mSignal =
+            latitudeSignal == condition.mEvaluationSignals.end() ? nullptr : latitudeSignal->second;
+        instruction.mSecondSignal =
+            longitudeSignal == condition.mEvaluationSignals.end() ? nullptr : longitudeSignal->second;
+        condition.mInstructions.emplace_back( instruction );
+        return;
+    }
+    default:
+        break;
+    }
+
+    // Operands are evaluated left to right before the operator, same as the recursive evaluation
+    compileExpression( expression->left, condition, remainingStackDepth - 1 );
+    // Logical NOT operator does not have a right operand, hence expression->right can be nullptr
+    if ( expression->nodeType != ExpressionNodeType::OPERATOR_LOGICAL_NOT )
+    {
+        compileExpression( expression->right, condition, remainingStackDepth - 1 );
+    }
+
+    switch ( expression->nodeType )
+    {
+    case ExpressionNodeType::OPERATOR_SMALLER:
+        instruction.mOpCode = ConditionOpCode::SMALLER;
+        break;
+    case ExpressionNodeType::OPERATOR_BIGGER:
+        instruction.mOpCode = ConditionOpCode::BIGGER;
+        break;
+    case ExpressionNodeType::OPERATOR_SMALLER_EQUAL:
+        instruction.mOpCode = ConditionOpCode::SMALLER_EQUAL;
+        break;
+    case ExpressionNodeType::OPERATOR_BIGGER_EQUAL:
+        instruction.mOpCode = ConditionOpCode::BIGGER_EQUAL;
+        break;
+    case ExpressionNodeType::OPERATOR_EQUAL:
+        instruction.mOpCode = ConditionOpCode::EQUAL;
+        break;
+    case ExpressionNodeType::OPERATOR_LOGICAL_AND:
+        instruction.mOpCode = ConditionOpCode::LOGICAL_AND;
+        break;
+    case ExpressionNodeType::OPERATOR_LOGICAL_OR:
+        instruction.mOpCode = ConditionOpCode::LOGICAL_OR;
+        break;
+    case ExpressionNodeType::OPERATOR_LOGICAL_NOT:
+        instruction.mOpCode = ConditionOpCode::LOGICAL_NOT;
+        break;
+    case ExpressionNodeType::OPERATOR_ARITHMETIC_PLUS:
+        instruction.mOpCode = ConditionOpCode::ARITHMETIC_PLUS;
+        break;
+    case ExpressionNodeType::OPERATOR_ARITHMETIC_MINUS:
+        instruction.mOpCode = ConditionOpCode::ARITHMETIC_MINUS;
+        break;
+    case ExpressionNodeType::OPERATOR_ARITHMETIC_MULTIPLY:
+        instruction.mOpCode = ConditionOpCode::ARITHMETIC_MULTIPLY;
+        break;
+    case ExpressionNodeType::OPERATOR_ARITHMETIC_DIVIDE:
+        instruction.mOpCode = ConditionOpCode::ARITHMETIC_DIVIDE;
+        break;
+    default:
+        instruction.mOpCode = ConditionOpCode::FAIL;
+        instruction.mErrorCode = ExpressionErrorCode::NOT_IMPLEMENTED_TYPE;
+        break;
+    }
+    condition.mInstructions.emplace_back( instruction );
+}
+
+CollectionInspectionEngine::ExpressionErrorCode
+CollectionInspectionEngine::evalInstructions( const ActiveCondition &condition, bool &resultValueBool )
+{
+    // Every entry holds the double and the boolean result of a subexpression like the recursive evaluation
+    std::array<ConditionStackEntry, MAX_CONDITION_STACK_SIZE> stack;
+    uint32_t stackSize = 0;
+    for ( const auto &instruction : condition.mInstructions )
+    {
+        ConditionStackEntry result;
+        ExpressionErrorCode ret = ExpressionErrorCode::SUCCESSFUL;
+        switch ( instruction.mOpCode )
+        {
+        case ConditionOpCode::PUSH_FLOAT:
+            result.mValue = instruction.mFloatingValue;
+            break;
+        case ConditionOpCode::PUSH_BOOLEAN:
+            result.mBoolean = instruction.mBooleanValue;
+            break;
+        case ConditionOpCode::PUSH_SIGNAL:
+            ret = getLatestSignalValue( *instruction.mSignal, result.mValue );
+            break;
+        case ConditionOpCode::PUSH_WINDOW_FUNCTION:
+            ret = getWindowFunctionValue( instruction.mWindowFunction, *instruction.mWindow, result.mValue );
+            break;
+        case ConditionOpCode::GEOHASH:
+            ret = getGeohashFunctionNode(
+                *instruction.mGeohashFunction, instruction.mSignal, instruction.mSecondSignal, result.mBoolean );
+            break;
+        case ConditionOpCode::LOGICAL_NOT:
+            stackSize--;
+            result.mBoolean = !stack[stackSize].mBoolean;
+            break;
+        case ConditionOpCode::FAIL:
+            return instruction.mErrorCode;
+        default:
+        {
+            stackSize -= 2;
+            const auto &left = stack[stackSize];
+            const auto &right = stack[stackSize + 1];
+            ret = applyOperator( instruction.mOpCode, left, right, result );
+            break;
+        }
+        }
+        if ( ret != ExpressionErrorCode::SUCCESSFUL )
+        {
+            return ret;
+        }
+        stack[stackSize] = result;
+        stackSize++;
+    }
+    if ( stackSize != 1 )
+    {
+        return ExpressionErrorCode::STACK_DEPTH_REACHED;
+    }
+    resultValueBool = stack[0].mBoolean;
     return ExpressionErrorCode::SUCCESSFUL;
 }
 
+CollectionInspectionEngine::ExpressionErrorCode
+CollectionInspectionEngine::applyOperator( ConditionOpCode opCode,
+                                           const ConditionStackEntry &left,
+                                           const ConditionStackEntry &right,
+                                           ConditionStackEntry &result )
+{
+    switch ( opCode )
+    {
+    case ConditionOpCode::SMALLER:
+        result.mBoolean = left.mValue < right.mValue;
+        return ExpressionErrorCode::SUCCESSFUL;
+    case ConditionOpCode::BIGGER:
+        result.mBoolean = left.mValue > right.mValue;
+        return ExpressionErrorCode::SUCCESSFUL;
+    case ConditionOpCode::SMALLER_EQUAL:
+        result.mBoolean = left.mValue <= right.mValue;
+        return ExpressionErrorCode::SUCCESSFUL;
+    case ConditionOpCode::BIGGER_EQUAL:
+        result.mBoolean = left.mValue >= right.mValue;
+        return ExpressionErrorCode::SUCCESSFUL;
+    case ConditionOpCode::EQUAL:
+        result.mBoolean = std::abs( left.mValue - right.mValue ) < EVAL_EQUAL_DISTANCE();
+        return ExpressionErrorCode::SUCCESSFUL;
+    case ConditionOpCode::LOGICAL_AND:
+        result.mBoolean = left.mBoolean && right.mBoolean;
+        return ExpressionErrorCode::SUCCESSFUL;
+    case ConditionOpCode::LOGICAL_OR:
+        result.mBoolean = left.mBoolean || right.mBoolean;
+        return ExpressionErrorCode::SUCCESSFUL;
+    case ConditionOpCode::ARITHMETIC_PLUS:
+        result.mValue = left.mValue + right.mValue;
+        return ExpressionErrorCode::SUCCESSFUL;
+    case ConditionOpCode::ARITHMETIC_MINUS:
+        result.mValue = left.mValue - right.mValue;
+        return ExpressionErrorCode::SUCCESSFUL;
+    case ConditionOpCode::ARITHMETIC_MULTIPLY:
+        result.mValue = left.mValue * right.mValue;
+        return ExpressionErrorCode::SUCCESSFUL;
+    case ConditionOpCode::ARITHMETIC_DIVIDE:
+        result.mValue = left.mValue / right.mValue;
+        return ExpressionErrorCode::SUCCESSFUL;
+    default:
+        return ExpressionErrorCode::NOT_IMPLEMENTED_TYPE;
+    }
+}
+
 CollectionInspectionEngine::ExpressionErrorCode
 CollectionInspectionEngine::eval( const struct ExpressionNode *expression,
                                   ActiveCondition &condition,
@@ -13,6 +13,8 @@
 
 #include "CollectionInspectionWorkerThread.h"
 #include "TraceModule.h"
+#include <algorithm>
+#include <chrono>
 
 namespace Aws
 {
@@ -21,24 +23,86 @@ namespace IoTFleetWise
 namespace DataInspection
 {
 
+constexpr uint32_t CollectionInspectionWorkerThread::MAX_NUMBER_OF_SHARDS;
+constexpr size_t CollectionInspectionWorkerThread::OUTPUT_HIGH_PRIORITY_ONLY_FILL_PERCENT;
+constexpr size_t CollectionInspectionWorkerThread::SHARD_INPUT_BUFFER_SIZE;
+constexpr size_t CollectionInspectionWorkerThread::SHARD_ACTIVE_DTC_BUFFER_SIZE;
+constexpr size_t CollectionInspectionWorkerThread::SHARD_OUTPUT_BUFFER_SIZE;
+
 bool
 CollectionInspectionWorkerThread::init( const std::shared_ptr<SignalBuffer> &inputSignalBufferIn,
                                         const std::shared_ptr<CANBuffer> &inputCANBufferIn,
                                         const std::shared_ptr<ActiveDTCBuffer> &inputActiveDTCBuffer,
                                         const std::shared_ptr<CollectedDataReadyToPublish> &outputCollectedDataIn,
                                         uint32_t idleTimeMs,
-                                        bool dataReductionProbabilityDisabled )
+                                        bool dataReductionProbabilityDisabled,
+                                        uint32_t batchSize,
+                                        uint32_t batchMaxLatencyMs,
+                                        uint32_t numberOfShards )
 {
     fInputSignalBuffer = inputSignalBufferIn;
     fInputCANBuffer = inputCANBufferIn;
     fInputActiveDTCBuffer = inputActiveDTCBuffer;
     fOutputCollectedData = outputCollectedDataIn;
+    if ( fOutputCollectedData != nullptr )
+    {
+        // The thread is not running yet, so both sides of the queue can be looked at
+        fOutputCapacity = fOutputCollectedData->write_available() + fOutputCollectedData->read_available();
+    }
     if ( idleTimeMs != 0 )
     {
         fIdleTimeMs = idleTimeMs;
     }
+    if ( batchSize != 0 )
+    {
+        fBatchSize = batchSize;
+    }
+    if ( batchMaxLatencyMs != 0 )
+    {
+        fBatchMaxLatencyMs = batchMaxLatencyMs;
+    }
+    fSignalBatch.resize( fBatchSize );
     fCollectionInspectionEngine.setDataReductionParameters( dataReductionProbabilityDisabled );
 
+    if ( numberOfShards > MAX_NUMBER_OF_SHARDS )
+    {
+        fLogger.error( "CollectionInspectionWorkerThread::init",
+                       "At most " + std::to_string( MAX_NUMBER_OF_SHARDS ) + " shards are supported" );
+        return false;
+    }
+    fShards.clear();
+    fShardSignalLanes.clear();
+    if ( numberOfShards > 1 )
+    {
+        fShardDataReadyListener = std::make_unique<ShardDataReadyListener>( fWait );
+        for ( uint32_t i = 0; i < numberOfShards; i++ )
+        {
+            auto shard = std::make_unique<CollectionInspectionWorkerThread>();
+            shard->fIsShard = true;
+            shard->fShardIndex = i;
+            if ( !shard->init( std::make_shared<SignalBuffer>( SHARD_INPUT_BUFFER_SIZE ),
+                               std::make_shared<CANBuffer>( SHARD_INPUT_BUFFER_SIZE ),
+                               std::make_shared<ActiveDTCBuffer>( SHARD_ACTIVE_DTC_BUFFER_SIZE ),
+                               std::make_shared<CollectedDataReadyToPublish>( SHARD_OUTPUT_BUFFER_SIZE ),
+                               idleTimeMs,
+                               dataReductionProbabilityDisabled,
+                               batchSize,
+                               batchMaxLatencyMs ) ||
+                 !shard->subscribeListener( fShardDataReadyListener.get() ) )
+            {
+                fLogger.error( "CollectionInspectionWorkerThread::init",
+                               "Failed to init shard " + std::to_string( i ) );
+                fShards.clear();
+                fShardSignalLanes.clear();
+                return false;
+            }
+            fShardSignalLanes.emplace_back( shard->fInputSignalBuffer->createLane() );
+            fShards.emplace_back( std::move( shard ) );
+        }
+        fLogger.info( "CollectionInspectionWorkerThread::init",
+                      "Conditions are sharded over " + std::to_string( numberOfShards ) + " inspection engines" );
+    }
+
     return true;
 }
 
@@ -52,19 +116,39 @@ CollectionInspectionWorkerThread::start()
                        " Collection Engine cannot be started without correct configurations " );
         return false;
     }
+    // Shards are started first so they are ready as soon as data is dispatched to them
+    for ( auto &shard : fShards )
+    {
+        if ( !shard->start() )
+        {
+            return false;
+        }
+    }
     // Prevent concurrent stop/init
     std::lock_guard<std::mutex> lock( fThreadMutex );
     // On multi core systems the shared variable fShouldStop must be updated for
     // all cores before starting the thread otherwise thread will directly end
     fShouldStop.store( false );
-    if ( !fThread.create( doWork, this ) )
+    if ( !fThread.create( fShards.empty() ? doWork : doDispatchWork, this ) )
     {
         fLogger.trace( "CollectionInspectionWorkerThread::start", " Inspection Thread failed to start " );
     }
     else
     {
         fLogger.trace( "CollectionInspectionWorkerThread::start", " Inspection Thread started " );
-        fThread.setThreadName( "fwDICollInsEng" );
+        if ( fIsShard )
+        {
+            fThread.setThreadName( "fwDICollInsS" + std::to_string( fShardIndex + 1 ) );
+            if ( !fThread.setThreadAffinity( fShardIndex ) )
+            {
+                fLogger.warn( "CollectionInspectionWorkerThread::start",
+                              "Failed to pin shard " + std::to_string( fShardIndex ) + " to a CPU" );
+            }
+        }
+        else
+        {
+            fThread.setThreadName( "fwDICollInsEng" );
+        }
     }
 
     return fThread.isActive() && fThread.isValid();
@@ -73,18 +157,24 @@ CollectionInspectionWorkerThread::start()
 bool
 CollectionInspectionWorkerThread::stop()
 {
-    if ( !fThread.isValid() || !fThread.isActive() )
+    bool stopped = true;
+    if ( fThread.isValid() && fThread.isActive() )
     {
-        return true;
+        std::lock_guard<std::mutex> lock( fThreadMutex );
+        fShouldStop.store( true, std::memory_order_relaxed );
+        fLogger.trace( "CollectionInspectionWorkerThread::stop", " Request stop " );
+        fWait.notify();
+        fThread.release();
+        fLogger.trace( "CollectionInspectionWorkerThread::stop", " Stop finished " );
+        fShouldStop.store( false, std::memory_order_relaxed );
+        stopped = !fThread.isActive();
     }
-    std::lock_guard<std::mutex> lock( fThreadMutex );
-    fShouldStop.store( true, std::memory_order_relaxed );
-    fLogger.trace( "CollectionInspectionWorkerThread::stop", " Request stop " );
-    fWait.notify();
-    fThread.release();
-    fLogger.trace( "CollectionInspectionWorkerThread::stop", " Stop finished " );
-    fShouldStop.store( false, std::memory_order_relaxed );
-    return !fThread.isActive();
+    // Shards are stopped after the dispatching thread so no more data is handed over to them
+    for ( auto &shard : fShards )
+    {
+        stopped = shard->stop() && stopped;
+    }
+    return stopped;
 }
 
 bool
@@ -114,6 +204,28 @@ CollectionInspectionWorkerThread::onNewDataAvailable()
     fWait.notify();
 }
 
+bool
+CollectionInspectionWorkerThread::subscribeToEvents( InspectionEventListener *listener )
+{
+    bool result = fCollectionInspectionEngine.subscribeListener( listener );
+    for ( auto &shard : fShards )
+    {
+        result = shard->subscribeToEvents( listener ) && result;
+    }
+    return result;
+}
+
+bool
+CollectionInspectionWorkerThread::unSubscribeFromEvents( InspectionEventListener *listener )
+{
+    bool result = fCollectionInspectionEngine.unSubscribeListener( listener );
+    for ( auto &shard : fShards )
+    {
+        result = shard->unSubscribeFromEvents( listener ) && result;
+    }
+    return result;
+}
+
 void
 CollectionInspectionWorkerThread::doWork( void *data )
 {
@@ -138,41 +250,19 @@ CollectionInspectionWorkerThread::doWork( void *data )
                 newInspectionMatrix = consumer->fUpdatedInspectionMatrix;
             }
             consumer->fCollectionInspectionEngine.onChangeInspectionMatrix( newInspectionMatrix );
+            consumer->fHighestPriority = getHighestPriority( newInspectionMatrix );
         }
         // Only run the main inspection loop if there is an inspection matrix
         // Otherwise, go to sleep.
         if ( consumer->fUpdatedInspectionMatrix )
         {
-            bool readyToSleep = true;
             Timestamp latestSignalTime = 0;
-            CollectedSignal inputSignal( 0, 0, 0.0 );
-            std::array<uint8_t, MAX_CAN_FRAME_BYTE_SIZE> buf = {};
-            CollectedCanRawFrame inputCANFrame( 0, 0, 0, buf, 0 );
-            // Consume any new signals and pass them over to the inspection Engine
-            if ( consumer->fInputSignalBuffer->pop( inputSignal ) )
-            {
-                TraceModule::get().decrementAtomicVariable( TraceAtomicVariable::QUEUE_CONSUMER_TO_INSPECTION_SIGNALS );
-                readyToSleep = false;
-                consumer->fCollectionInspectionEngine.addNewSignal(
-                    inputSignal.signalID, inputSignal.receiveTime, inputSignal.value );
-                latestSignalTime = std::max( latestSignalTime, inputSignal.receiveTime );
-                inputCounterSinceLastEvaluate++;
-                statisticInputMessagesProcessed++;
-            }
-            // Consume any raw frames
-            if ( consumer->fInputCANBuffer->pop( inputCANFrame ) )
-            {
-                TraceModule::get().decrementAtomicVariable( TraceAtomicVariable::QUEUE_CONSUMER_TO_INSPECTION_CAN );
-                readyToSleep = false;
-                consumer->fCollectionInspectionEngine.addNewRawCanFrame( inputCANFrame.frameID,
-                                                                         inputCANFrame.channelId,
-                                                                         inputCANFrame.receiveTime,
-                                                                         inputCANFrame.data,
-                                                                         inputCANFrame.size );
-                latestSignalTime = std::max( latestSignalTime, inputCANFrame.receiveTime );
-                inputCounterSinceLastEvaluate++;
-                statisticInputMessagesProcessed++;
-            }
+            // Drain a batch of signals and raw frames and pass them over to the inspection Engine
+            uint32_t inputsConsumed = consumer->drainSignals( lastInputTimeEvaluated, latestSignalTime );
+            inputsConsumed += consumer->drainCANFrames( lastInputTimeEvaluated, latestSignalTime );
+            bool readyToSleep = inputsConsumed == 0;
+            inputCounterSinceLastEvaluate += inputsConsumed;
+            statisticInputMessagesProcessed += inputsConsumed;
 
             // Consume any Active DTCs
             // We could check if the DTCs have changed here, but not necessary
@@ -187,44 +277,38 @@ CollectionInspectionWorkerThread::doWork( void *data )
                 consumer->fCollectionInspectionEngine.setActiveDTCs( activeDTCs );
             }
 
-            // Trigger inspection on whatever that has been consumed.
-            if ( ( ( latestSignalTime - lastInputTimeEvaluated ) >= EVALUATE_INTERVAL_MS ) ||
-                 ( inputCounterSinceLastEvaluate >= 256 ) )
+            // Trigger inspection once on the whole batch that has been consumed.
+            Timestamp currentTime = consumer->fClock->timeSinceEpochMs();
+            if ( ( ( latestSignalTime - lastInputTimeEvaluated ) >= consumer->fBatchMaxLatencyMs ) ||
+                 ( inputCounterSinceLastEvaluate >= consumer->fBatchSize ) )
             {
                 lastInputTimeEvaluated = latestSignalTime;
-                lastTimeEvaluated = consumer->fClock->timeSinceEpochMs();
-                consumer->fCollectionInspectionEngine.evaluateConditions( lastTimeEvaluated );
+                lastTimeEvaluated = currentTime;
+                consumer->evaluateConditions( lastTimeEvaluated );
                 inputCounterSinceLastEvaluate = 0;
             }
 
             // before going to sleep do another evaluation if last evaluation is more than EVALUATE_INTERVAL_MS ago
-            if ( readyToSleep &&
-                 ( ( consumer->fClock->timeSinceEpochMs() - lastTimeEvaluated ) >= EVALUATE_INTERVAL_MS ) )
+            if ( readyToSleep && ( ( currentTime - lastTimeEvaluated ) >= EVALUATE_INTERVAL_MS ) )
             {
                 lastInputTimeEvaluated = latestSignalTime;
-                lastTimeEvaluated = consumer->fClock->timeSinceEpochMs();
-                consumer->fCollectionInspectionEngine.evaluateConditions( lastTimeEvaluated );
+                lastTimeEvaluated = currentTime;
+                consumer->evaluateConditions( lastTimeEvaluated );
                 inputCounterSinceLastEvaluate = 0;
             }
             uint32_t waitTimeMs = consumer->fIdleTimeMs;
             std::shared_ptr<const TriggeredCollectionSchemeData> collectedData =
-                consumer->fCollectionInspectionEngine.collectNextDataToSend( consumer->fClock->timeSinceEpochMs(),
-                                                                             waitTimeMs );
+                consumer->fCollectionInspectionEngine.collectNextDataToSend( currentTime, waitTimeMs );
             while ( collectedData != nullptr && !consumer->shouldStop() )
             {
-                if ( !consumer->fOutputCollectedData->push( collectedData ) )
-                {
-                    consumer->fLogger.warn( "CollectionInspectionWorkerThread::doWork",
-                                            "Collected data output buffer is full" );
-                }
-                else
+                if ( consumer->pushCollectedData( collectedData ) )
                 {
                     statisticDataSentOut++;
-                    consumer->notifyListeners<>( &IDataReadyToPublishListener::onDataReadyToPublish );
                 }
                 collectedData = consumer->fCollectionInspectionEngine.collectNextDataToSend(
                     consumer->fClock->timeSinceEpochMs(), waitTimeMs );
             }
+            consumer->fDroppedCollectedData.logIfDue();
 
             if ( readyToSleep )
             {
@@ -234,14 +318,17 @@ CollectionInspectionWorkerThread::doWork( void *data )
                 if ( consumer->fClock->timeSinceEpochMs() >
                      ( lastTraceOutput + LoggingModule::LOG_AGGREGATION_TIME_MS ) )
                 {
-                    consumer->fLogger.trace(
-                        "CollectionInspectionWorkerThread::doWork",
-                        "Activations: " + std::to_string( activations ) +
-                            ". Waiting for some data to come. Idling for :" + std::to_string( timeToWait ) +
-                            " ms or until notify. Since last idling processed " +
-                            std::to_string( statisticInputMessagesProcessed ) +
-                            " incoming data packages and sent out " + std::to_string( statisticDataSentOut ) +
-                            " packages out" );
+                    if ( LoggingModule::isEnabled( LogLevel::Trace ) )
+                    {
+                        consumer->fLogger.trace(
+                            "CollectionInspectionWorkerThread::doWork",
+                            "Activations: " + std::to_string( activations ) +
+                                ". Waiting for some data to come. Idling for :" + std::to_string( timeToWait ) +
+                                " ms or until notify. Since last idling processed " +
+                                std::to_string( statisticInputMessagesProcessed ) +
+                                " incoming data packages and sent out " + std::to_string( statisticDataSentOut ) +
+                                " packages out" );
+                    }
                     activations = 0;
                     statisticInputMessagesProcessed = 0;
                     statisticDataSentOut = 0;
@@ -258,9 +345,367 @@ CollectionInspectionWorkerThread::doWork( void *data )
     } while ( !consumer->shouldStop() );
 }
 
+void
+CollectionInspectionWorkerThread::evaluateConditions( Timestamp currentTime )
+{
+    auto startTime = std::chrono::steady_clock::now();
+    fCollectionInspectionEngine.evaluateConditions( currentTime );
+    auto executionTime =
+        std::chrono::duration_cast<std::chrono::microseconds>( std::chrono::steady_clock::now() - startTime );
+    TraceModule::get().addToHistogram( TraceHistogram::CE_EVALUATE_CONDITIONS_TIME,
+                                       static_cast<uint64_t>( executionTime.count() ) );
+}
+
+uint32_t
+CollectionInspectionWorkerThread::drainSignals( Timestamp lastInputTimeEvaluated, Timestamp &latestSignalTime )
+{
+    if ( !fIsShard )
+    {
+        // Sampled by the only consumer, so that the producers do not need to count every signal they push
+        TraceModule::get().setAtomicVariable( TraceAtomicVariable::QUEUE_CONSUMER_TO_INSPECTION_SIGNALS,
+                                              fInputSignalBuffer->sizeApprox() );
+    }
+    uint32_t count = 0;
+    while ( ( count < fBatchSize ) && fInputSignalBuffer->pop( fSignalBatch[count] ) )
+    {
+        latestSignalTime = std::max( latestSignalTime, fSignalBatch[count].receiveTime );
+        count++;
+        if ( latestSignalTime >= ( lastInputTimeEvaluated + fBatchMaxLatencyMs ) )
+        {
+            break;
+        }
+    }
+    if ( count > 0 )
+    {
+        auto currentTime = fClock->timeSinceEpochMs();
+        for ( uint32_t i = 0; i < count; i++ )
+        {
+            TraceModule::get().addLatencyToHistogram(
+                TraceHistogram::CAN_TO_INSPECTION_LATENCY, fSignalBatch[i].receiveTime, currentTime );
+        }
+        fCollectionInspectionEngine.addNewSignals( fSignalBatch.data(), count );
+    }
+    return count;
+}
+
+uint32_t
+CollectionInspectionWorkerThread::drainCANFrames( Timestamp lastInputTimeEvaluated, Timestamp &latestSignalTime )
+{
+    uint32_t count = 0;
+    std::array<uint8_t, MAX_CAN_FRAME_BYTE_SIZE> buf = {};
+    CollectedCanRawFrame inputCANFrame( 0, 0, 0, buf, 0 );
+    Timestamp currentTime = 0;
+    while ( ( count < fBatchSize ) && fInputCANBuffer->pop( inputCANFrame ) )
+    {
+        if ( currentTime == 0 )
+        {
+            currentTime = fClock->timeSinceEpochMs();
+        }
+        TraceModule::get().addLatencyToHistogram(
+            TraceHistogram::CAN_TO_INSPECTION_LATENCY, inputCANFrame.receiveTime, currentTime );
+        fCollectionInspectionEngine.addNewRawCanFrame( inputCANFrame.frameID,
+                                                       inputCANFrame.channelId,
+                                                       inputCANFrame.receiveTime,
+                                                       inputCANFrame.data,
+                                                       inputCANFrame.size );
+        latestSignalTime = std::max( latestSignalTime, inputCANFrame.receiveTime );
+        count++;
+        if ( latestSignalTime >= ( lastInputTimeEvaluated + fBatchMaxLatencyMs ) )
+        {
+            break;
+        }
+    }
+    if ( ( count > 0 ) && ( !fIsShard ) )
+    {
+        TraceModule::get().subtractFromAtomicVariable( TraceAtomicVariable::QUEUE_CONSUMER_TO_INSPECTION_CAN, count );
+    }
+    return count;
+}
+
+void
+CollectionInspectionWorkerThread::doDispatchWork( void *data )
+{
+    CollectionInspectionWorkerThread *consumer = static_cast<CollectionInspectionWorkerThread *>( data );
+    Timestamp lastTraceOutput = 0;
+    uint32_t statisticInputMessagesProcessed = 0;
+    uint32_t statisticDataSentOut = 0;
+    uint32_t activations = 0;
+    do
+    {
+        activations++;
+        if ( consumer->fUpdatedInspectionMatrixAvailable )
+        {
+            std::shared_ptr<const InspectionMatrix> newInspectionMatrix;
+            {
+                std::lock_guard<std::mutex> lock( consumer->fInspectionMatrixMutex );
+                consumer->fUpdatedInspectionMatrixAvailable = false;
+                newInspectionMatrix = consumer->fUpdatedInspectionMatrix;
+            }
+            consumer->distributeInspectionMatrix( newInspectionMatrix );
+        }
+        if ( consumer->fUpdatedInspectionMatrix )
+        {
+            uint32_t inputsConsumed = consumer->dispatchInputs();
+            statisticInputMessagesProcessed += inputsConsumed;
+
+            // Every shard gets the latest DTCs as conditions of all shards can include them
+            DTCInfo activeDTCs = {};
+            if ( consumer->fInputActiveDTCBuffer->pop( activeDTCs ) )
+            {
+                for ( auto &shard : consumer->fShards )
+                {
+                    if ( !shard->fInputActiveDTCBuffer->push( activeDTCs ) )
+                    {
+                        consumer->fLogger.warn( "CollectionInspectionWorkerThread::doDispatchWork",
+                                                "Active DTC buffer of shard " +
+                                                    std::to_string( shard->fShardIndex ) + " is full" );
+                    }
+                    shard->onNewDataAvailable();
+                }
+            }
+
+            uint32_t dataSentOut = consumer->mergeShardOutputs();
+            statisticDataSentOut += dataSentOut;
+
+            if ( ( inputsConsumed == 0 ) && ( dataSentOut == 0 ) )
+            {
+                // Print only every THREAD_IDLE_TIME_MS to avoid console spam
+                if ( consumer->fClock->timeSinceEpochMs() >
+                     ( lastTraceOutput + LoggingModule::LOG_AGGREGATION_TIME_MS ) )
+                {
+                    if ( LoggingModule::isEnabled( LogLevel::Trace ) )
+                    {
+                        consumer->fLogger.trace(
+                            "CollectionInspectionWorkerThread::doDispatchWork",
+                            "Activations: " + std::to_string( activations ) + ". Dispatched " +
+                                std::to_string( statisticInputMessagesProcessed ) +
+                                " incoming data packages to the shards and sent out " +
+                                std::to_string( statisticDataSentOut ) + " packages out" );
+                    }
+                    activations = 0;
+                    statisticInputMessagesProcessed = 0;
+                    statisticDataSentOut = 0;
+                    lastTraceOutput = consumer->fClock->timeSinceEpochMs();
+                }
+                // Woken up by new input data or by a shard that collected data
+                consumer->fWait.wait( consumer->fIdleTimeMs );
+            }
+        }
+        else
+        {
+            // No inspection Matrix available. Wait for it from the CollectionScheme manager
+            consumer->fWait.wait( Platform::Linux::Signal::WaitWithPredicate );
+        }
+    } while ( !consumer->shouldStop() );
+}
+
+void
+CollectionInspectionWorkerThread::distributeInspectionMatrix(
+    const std::shared_ptr<const InspectionMatrix> &inspectionMatrix )
+{
+    fSignalRouting.clear();
+    fCanFrameRouting.clear();
+    fHighestPriority = getHighestPriority( inspectionMatrix );
+    if ( inspectionMatrix == nullptr )
+    {
+        return;
+    }
+    std::vector<std::shared_ptr<ShardInspectionMatrix>> shardInspectionMatrices;
+    for ( size_t i = 0; i < fShards.size(); i++ )
+    {
+        shardInspectionMatrices.emplace_back( std::make_shared<ShardInspectionMatrix>() );
+        shardInspectionMatrices.back()->completeInspectionMatrix = inspectionMatrix;
+    }
+    // A condition stays on the shard it was on before, so that the shard can carry over its buffers and state.
+    // New conditions go to the shard with the fewest conditions.
+    std::unordered_map<std::string, size_t> conditionShards;
+    std::vector<size_t> shardOfCondition( inspectionMatrix->conditions.size(), fShards.size() );
+    std::vector<size_t> conditionsPerShard( fShards.size(), 0 );
+    for ( size_t i = 0; i < inspectionMatrix->conditions.size(); i++ )
+    {
+        const auto &collectionSchemeID = inspectionMatrix->conditions[i].metaData.collectionSchemeID;
+        auto previousShard = fConditionShards.find( collectionSchemeID );
+        if ( ( !collectionSchemeID.empty() ) && ( previousShard != fConditionShards.end() ) )
+        {
+            shardOfCondition[i] = previousShard->second;
+            conditionsPerShard[previousShard->second]++;
+        }
+    }
+    for ( size_t i = 0; i < inspectionMatrix->conditions.size(); i++ )
+    {
+        if ( shardOfCondition[i] == fShards.size() )
+        {
+            shardOfCondition[i] = static_cast<size_t>(
+                std::min_element( conditionsPerShard.begin(), conditionsPerShard.end() ) - conditionsPerShard.begin() );
+            conditionsPerShard[shardOfCondition[i]]++;
+        }
+        conditionShards[inspectionMatrix->conditions[i].metaData.collectionSchemeID] = shardOfCondition[i];
+    }
+    fConditionShards = std::move( conditionShards );
+    for ( size_t i = 0; i < inspectionMatrix->conditions.size(); i++ )
+    {
+        auto shardIndex = shardOfCondition[i];
+        const auto &condition = inspectionMatrix->conditions[i];
+        shardInspectionMatrices[shardIndex]->conditions.emplace_back( condition );
+        ShardMask shardBit = static_cast<ShardMask>( 1 ) << shardIndex;
+        for ( const auto &signal : condition.signals )
+        {
+            fSignalRouting[signal.signalID] |= shardBit;
+        }
+        for ( const auto &canFrame : condition.canFrames )
+        {
+            fCanFrameRouting[getCanFrameRoutingKey( canFrame.channelID, canFrame.frameID )] |= shardBit;
+        }
+    }
+    for ( size_t i = 0; i < fShards.size(); i++ )
+    {
+        fShards[i]->onChangeInspectionMatrix( shardInspectionMatrices[i] );
+    }
+}
+
+uint32_t
+CollectionInspectionWorkerThread::dispatchInputs()
+{
+    ShardMask shardsWithNewData = 0;
+    TraceModule::get().setAtomicVariable( TraceAtomicVariable::QUEUE_CONSUMER_TO_INSPECTION_SIGNALS,
+                                          fInputSignalBuffer->sizeApprox() );
+    auto signalCount = static_cast<uint32_t>( fInputSignalBuffer->pop( fSignalBatch.data(), fBatchSize ) );
+    for ( uint32_t j = 0; j < signalCount; j++ )
+    {
+        const auto &signal = fSignalBatch[j];
+        auto routing = fSignalRouting.find( signal.signalID );
+        if ( routing == fSignalRouting.end() )
+        {
+            continue;
+        }
+        for ( uint32_t i = 0; i < fShards.size(); i++ )
+        {
+            ShardMask shardBit = static_cast<ShardMask>( 1 ) << i;
+            if ( ( routing->second & shardBit ) != 0 )
+            {
+                if ( fShardSignalLanes[i]->push( signal ) )
+                {
+                    shardsWithNewData |= shardBit;
+                }
+                else
+                {
+                    fDroppedShardSignals.add( signal.signalID );
+                }
+            }
+        }
+    }
+    uint32_t canFrameCount = 0;
+    std::array<uint8_t, MAX_CAN_FRAME_BYTE_SIZE> buf = {};
+    CollectedCanRawFrame canFrame( 0, 0, 0, buf, 0 );
+    while ( ( canFrameCount < fBatchSize ) && fInputCANBuffer->pop( canFrame ) )
+    {
+        canFrameCount++;
+        auto routing = fCanFrameRouting.find( getCanFrameRoutingKey( canFrame.channelId, canFrame.frameID ) );
+        if ( routing == fCanFrameRouting.end() )
+        {
+            continue;
+        }
+        for ( uint32_t i = 0; i < fShards.size(); i++ )
+        {
+            ShardMask shardBit = static_cast<ShardMask>( 1 ) << i;
+            if ( ( routing->second & shardBit ) != 0 )
+            {
+                if ( fShards[i]->fInputCANBuffer->push( canFrame ) )
+                {
+                    shardsWithNewData |= shardBit;
+                }
+                else
+                {
+                    fDroppedShardCANFrames.add( canFrame.frameID );
+                }
+            }
+        }
+    }
+    if ( canFrameCount > 0 )
+    {
+        TraceModule::get().subtractFromAtomicVariable( TraceAtomicVariable::QUEUE_CONSUMER_TO_INSPECTION_CAN,
+                                                       canFrameCount );
+    }
+
+    fDroppedShardSignals.logIfDue();
+    fDroppedShardCANFrames.logIfDue();
+    for ( uint32_t i = 0; i < fShards.size(); i++ )
+    {
+        if ( ( shardsWithNewData & ( static_cast<ShardMask>( 1 ) << i ) ) != 0 )
+        {
+            fShards[i]->onNewDataAvailable();
+        }
+    }
+    return signalCount + canFrameCount;
+}
+
+uint32_t
+CollectionInspectionWorkerThread::mergeShardOutputs()
+{
+    uint32_t dataSentOut = 0;
+    for ( auto &shard : fShards )
+    {
+        TriggeredCollectionSchemeDataPtr collectedData;
+        while ( !shouldStop() && shard->fOutputCollectedData->pop( collectedData ) )
+        {
+            if ( pushCollectedData( collectedData ) )
+            {
+                dataSentOut++;
+            }
+        }
+    }
+    fDroppedCollectedData.logIfDue();
+    return dataSentOut;
+}
+
+bool
+CollectionInspectionWorkerThread::pushCollectedData( const TriggeredCollectionSchemeDataPtr &collectedData )
+{
+    // A shard pushes everything to its own output queue, the policy is applied when the outputs are merged
+    if ( ( !fIsShard ) && ( fOutputCapacity > 0 ) && ( collectedData->metaData.priority > fHighestPriority ) )
+    {
+        auto writeAvailable = std::min( fOutputCollectedData->write_available(), fOutputCapacity );
+        auto fillPercent = ( ( fOutputCapacity - writeAvailable ) * 100 ) / fOutputCapacity;
+        if ( fillPercent >= OUTPUT_HIGH_PRIORITY_ONLY_FILL_PERCENT )
+        {
+            fDroppedCollectedData.add( collectedData->metaData.collectionSchemeID );
+            return false;
+        }
+    }
+    if ( !fOutputCollectedData->push( collectedData ) )
+    {
+        fDroppedCollectedData.add( collectedData->metaData.collectionSchemeID );
+        return false;
+    }
+    notifyListeners<>( &IDataReadyToPublishListener::onDataReadyToPublish );
+    return true;
+}
+
+uint32_t
+CollectionInspectionWorkerThread::getHighestPriority( const std::shared_ptr<const InspectionMatrix> &inspectionMatrix )
+{
+    auto highestPriority = std::numeric_limits<uint32_t>::max();
+    if ( inspectionMatrix == nullptr )
+    {
+        return highestPriority;
+    }
+    for ( const auto &condition : inspectionMatrix->conditions )
+    {
+        highestPriority = std::min( highestPriority, condition.metaData.priority );
+    }
+    return highestPriority;
+}
+
 bool
 CollectionInspectionWorkerThread::isAlive()
 {
+    for ( auto &shard : fShards )
+    {
+        if ( !shard->isAlive() )
+        {
+            return false;
+        }
+    }
     return fThread.isValid() && fThread.isActive();
 }
 
@@ -0,0 +1,48 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include "LoadShedding.h"
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace DataInspection
+{
+constexpr size_t SignalLoadShedder::SAMPLE_DOWN_FILL_PERCENT;
+constexpr size_t SignalLoadShedder::HIGH_PRIORITY_ONLY_FILL_PERCENT;
+constexpr uint32_t SignalLoadShedder::SAMPLE_DOWN_FACTOR;
+
+bool
+SignalLoadShedder::shouldPushUnderPressure( SignalID signalID,
+                                            size_t fillPercent,
+                                            const std::unordered_set<SignalID> &highPrioritySignalIDs )
+{
+    if ( highPrioritySignalIDs.find( signalID ) != highPrioritySignalIDs.end() )
+    {
+        return true;
+    }
+    if ( fillPercent >= HIGH_PRIORITY_ONLY_FILL_PERCENT )
+    {
+        return false;
+    }
+    // Keep the first of every SAMPLE_DOWN_FACTOR samples of the signal
+    auto &sampleCounter = mSampleCounters[signalID];
+    bool push = ( sampleCounter == 0 );
+    sampleCounter = ( sampleCounter + 1 ) % SAMPLE_DOWN_FACTOR;
+    return push;
+}
+
+} // namespace DataInspection
+} // namespace IoTFleetWise
+} // namespace Aws
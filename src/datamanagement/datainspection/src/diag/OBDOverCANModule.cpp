@@ -11,6 +11,7 @@
  * permissions and limitations under the License.
  */
 
+
 // Includes
 #include "OBDOverCANModule.h"
 #include "EnumUtility.h"
@@ -19,10 +20,19 @@
 
 #include <algorithm>
 #include <bitset>
+#include <cerrno>
+#include <climits>
 #include <cstring>
 #include <iostream>
 #include <iterator>
+#include <linux/can.h>
+#include <linux/can/raw.h>
+#include <net/if.h>
+#include <poll.h>
 #include <sstream>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
 
 namespace Aws
 {
@@ -32,10 +42,37 @@ namespace DataInspection
 {
 
 constexpr size_t OBDOverCANModule::MAX_PID_RANGE;
+constexpr uint32_t OBDOverCANModule::ECU_DISCOVERY_TIMEOUT_MS;
+constexpr uint32_t OBDOverCANModule::MIN_PID_REQUEST_INTERVAL_MS;
+
+namespace
+{
+// Responses of the ECUs to functional requests, J1979 / ISO 15765-4
+constexpr uint32_t ECU_RESPONSE_ID_MASK = 0x7F8;
+constexpr uint32_t ECU_RESPONSE_EXTENDED_ID_BASE = 0x18DAF100;
+constexpr uint32_t ECU_RESPONSE_EXTENDED_ID_MASK = 0x1FFFFF00;
+constexpr uint32_t ECU_REQUEST_EXTENDED_ID_BASE = 0x18DA00F1;
+// Offset between the physical request and response IDs of an ECU with 11-bit IDs
+constexpr uint32_t ECU_RESPONSE_ID_OFFSET = 0x08;
+constexpr uint8_t POSITIVE_RESPONSE_OFFSET = 0x40;
+constexpr uint8_t ISOTP_PADDING_BYTE = 0xCC;
+constexpr int MAX_EPOLL_EVENTS = 16;
+
+std::string
+toString( const std::vector<uint8_t> &bytes )
+{
+    std::ostringstream oss;
+    if ( !bytes.empty() )
+    {
+        std::copy( bytes.begin(), bytes.end() - 1, std::ostream_iterator<int>( oss, "," ) );
+        oss << std::to_string( bytes.back() );
+    }
+    return oss.str();
+}
+} // namespace
 
 OBDOverCANModule::OBDOverCANModule()
 {
-    mOBDHeartBeatIntervalSeconds = 0;
     mPIDRequestIntervalSeconds = 0;
     mDTCRequestIntervalSeconds = 0;
     mHasTransmission = false;
@@ -49,6 +86,10 @@ OBDOverCANModule::~OBDOverCANModule()
     {
         stop();
     }
+    if ( mEpollFd >= 0 )
+    {
+        close( mEpollFd );
+    }
 }
 
 bool
@@ -66,33 +107,6 @@ OBDOverCANModule::init( SignalBufferPtr signalBufferPtr,
         // We should not start the module if both intervals are zero
         return false;
     }
-    // Establish a bi-directional P2P channel on ISO-TP between FWE, Engine ECU and Transmission ECU.
-    // Each ECU listens on the bus for their RX IDs, and respond with their TX IDs.
-    ISOTPOverCANSenderReceiverOptions optionsEngine;
-    ISOTPOverCANSenderReceiverOptions optionsTransmission;
-    optionsEngine.mSocketCanIFName = gatewayCanInterfaceName;
-    optionsTransmission.mSocketCanIFName = gatewayCanInterfaceName;
-
-    if ( useExtendedIDs )
-    {
-        // ECM
-        optionsEngine.mIsExtendedId = true;
-        optionsEngine.mSourceCANId = toUType( ECUID::ENGINE_ECU_TX_EXTENDED );
-        optionsEngine.mDestinationCANId = toUType( ECUID::ENGINE_ECU_RX_EXTENDED );
-        // TCM
-        optionsTransmission.mIsExtendedId = true;
-        optionsTransmission.mSourceCANId = toUType( ECUID::TRANSMISSION_ECU_TX_EXTENDED );
-        optionsTransmission.mDestinationCANId = toUType( ECUID::TRANSMISSION_ECU_RX_EXTENDED );
-    }
-    else
-    {
-        // ECM
-        optionsEngine.mSourceCANId = toUType( ECUID::ENGINE_ECU_TX );
-        optionsEngine.mDestinationCANId = toUType( ECUID::ENGINE_ECU_RX );
-        // TCM
-        optionsTransmission.mSourceCANId = toUType( ECUID::TRANSMISSION_ECU_TX );
-        optionsTransmission.mDestinationCANId = toUType( ECUID::TRANSMISSION_ECU_RX );
-    }
 
     mPIDRequestIntervalSeconds = pidRequestIntervalSeconds;
     mDTCRequestIntervalSeconds = dtcRequestIntervalSeconds;
@@ -105,40 +119,19 @@ OBDOverCANModule::init( SignalBufferPtr signalBufferPtr,
     else
     {
         mSignalBufferPtr = signalBufferPtr;
+        mSignalBufferLane = signalBufferPtr->createLane();
         mActiveDTCBufferPtr = activeDTCBufferPtr;
     }
 
     // Init the OBD Decoder
     mOBDDataDecoder = std::make_unique<OBDDataDecoder>();
 
-    // Init the Transmission ECU
-    if ( hasTransmissionECU )
-    {
-        if ( mTransmissionECUSenderReceiver.init( optionsTransmission ) )
-        {
-            mLogger.trace( "OBDOverCANModule::init", "Transmission ECU Initialized" );
-            mHasTransmission = true;
-        }
-        else
-        {
-            mLogger.error( "OBDOverCANModule::init", "Failed to the Transmission ECU" );
-            mHasTransmission = false;
-            return false;
-        }
-    }
-    // Init the Engine ECU
-    if ( mEngineECUSenderReceiver.init( optionsEngine ) )
-    {
-
-        mLogger.trace( "OBDOverCANModule::init", "Engine ECU Initialized" );
-        mLogger.info( "OBDOverCANModule::init", "OBD Module Initialized" );
-    }
-    else
-    {
-        mLogger.error( "OBDOverCANModule::init", "Failed to init the Engine ECU" );
-        return false;
-    }
-
+    // The ECUs are discovered on connect. The Engine ECU, and the Transmission ECU if present,
+    // are used if none of the ECUs responds to the discovery request.
+    mGatewayCanInterfaceName = gatewayCanInterfaceName;
+    mUseExtendedIDs = useExtendedIDs;
+    mHasTransmission = hasTransmissionECU;
+    mLogger.info( "OBDOverCANModule::init", "OBD Module Initialized" );
     return true;
 }
 
@@ -198,8 +191,9 @@ OBDOverCANModule::doWork( void *data )
 {
     OBDOverCANModule *OBDModule = static_cast<OBDOverCANModule *>( data );
 
-    OBDModule->mDTCTimer.reset();
-    OBDModule->mPIDTimer.reset();
+    auto now = OBDModule->mClock->timeSinceEpochMs();
+    OBDModule->mNextVINRequestTime = now;
+    OBDModule->mNextDTCRequestTime = now + static_cast<Timestamp>( OBDModule->mDTCRequestIntervalSeconds ) * 1000;
     while ( !OBDModule->shouldStop() )
     {
 
@@ -214,432 +208,706 @@ OBDOverCANModule::doWork( void *data )
             OBDModule->mDataAvailableWait.wait( Platform::Linux::Signal::WaitWithPredicate );
         }
 
-        // Check if we need to request PIDs and we have a decoder manifest to decode them.
-        if ( OBDModule->mDecoderManifestAvailable.load( std::memory_order_relaxed ) )
+        now = OBDModule->mClock->timeSinceEpochMs();
+        // Pick up a new decoder manifest or new sample intervals from the collection schemes
+        OBDModule->applyConfigurationChanges( now );
+        // Queue the requests that are due, then get each ECU going with its next request.
+        // The ECUs are served concurrently, so an ECU that does not respond only delays its own requests.
+        OBDModule->scheduleRequests( now );
+        for ( auto &ecu : OBDModule->mECUs )
+        {
+            OBDModule->sendNextRequest( *ecu, now );
+        }
+
+        auto wakeUpTime = OBDModule->getNextWakeUpTime();
+        if ( OBDModule->requestsInFlight() )
+        {
+            OBDModule->waitForResponses( wakeUpTime );
+        }
+        else if ( wakeUpTime == OBDPIDScheduler::NOTHING_SCHEDULED )
         {
-            // A new decoder manifest arrived. Pass it over to the OBD decoder.
+            OBDModule->mLogger.trace( "OBDOverCANModule::doWork", " Nothing scheduled, waiting for a change" );
+            OBDModule->mWait.wait( Platform::Linux::Signal::WaitWithPredicate );
+        }
+        else
+        {
+            now = OBDModule->mClock->timeSinceEpochMs();
+            // WaitWithPredicate is reserved for waiting without timeout
+            uint32_t sleepTime = 0;
+            if ( wakeUpTime > now )
             {
-                std::lock_guard<std::mutex> lock( OBDModule->mDecoderDictMutex );
-                OBDModule->mOBDDataDecoder->setDecoderDictionary( OBDModule->mDecoderDictionaryPtr );
-                OBDModule->mLogger.trace( "OBDOverCANModule::doWork", "Decoder Manifest set on the OBD Decoder " );
-                // Reset the atomic state
-                OBDModule->mDecoderManifestAvailable.store( false, std::memory_order_relaxed );
+                sleepTime = static_cast<uint32_t>( std::min<Timestamp>( wakeUpTime - now, UINT32_MAX - 1 ) );
             }
+            OBDModule->mLogger.trace( "OBDOverCANModule::doWork",
+                                      " Waiting for :" + std::to_string( sleepTime ) + " milliseconds" );
+            OBDModule->mWait.wait( sleepTime );
+        }
+    }
+}
+
+void
+OBDOverCANModule::applyConfigurationChanges( Timestamp now )
+{
+    bool changed = false;
+    // Check if we need to request PIDs and we have a decoder manifest to decode them.
+    if ( mDecoderManifestAvailable.load( std::memory_order_relaxed ) )
+    {
+        // A new decoder manifest arrived. Pass it over to the OBD decoder.
+        std::lock_guard<std::mutex> lock( mDecoderDictMutex );
+        mOBDDataDecoder->setDecoderDictionary( mDecoderDictionaryPtr );
+        // For now we only support OBD Service Mode 1 PID
+        mPIDsRequestedByDecoderDict[SID::CURRENT_STATS] = mNewPIDsRequestedByDecoderDict;
+        mPIDSignals = mNewPIDSignals;
+        mLogger.trace( "OBDOverCANModule::applyConfigurationChanges", "Decoder Manifest set on the OBD Decoder " );
+        // Reset the atomic state
+        mDecoderManifestAvailable.store( false, std::memory_order_relaxed );
+        changed = true;
+    }
+    if ( mSignalIntervalsChanged.load( std::memory_order_relaxed ) )
+    {
+        std::lock_guard<std::mutex> lock( mSignalIntervalsMutex );
+        mSignalIntervalsMs = mNewSignalIntervalsMs;
+        mSignalIntervalsChanged.store( false, std::memory_order_relaxed );
+        changed = true;
+    }
+    if ( changed )
+    {
+        // If the supported PIDs of an ECU are already known, update the PIDs to request from it and their rates.
+        // Otherwise this is done once the supported PIDs are received.
+        for ( auto &ecu : mECUs )
+        {
+            updatePIDRequestList( SID::CURRENT_STATS, *ecu );
+            updatePIDSchedule( *ecu, now );
+        }
+    }
+}
+
+void
+OBDOverCANModule::scheduleRequests( Timestamp now )
+{
+    if ( mECUs.empty() )
+    {
+        return;
+    }
+    // Execute the PID request flow if activated.
+    if ( mDecoderDictionaryPtr && !mDecoderDictionaryPtr->empty() )
+    {
+        // Check if the VIN has been already successfully requested.
+        // If not, request it and store it.
+        // The request always goes to the first ECU, which is the ECM if it responds,
+        // even though the VIN is also available in other ECUs.
+        if ( mVIN.empty() && now >= mNextVINRequestTime )
+        {
+            mLogger.trace( "OBDOverCANModule::scheduleRequests",
+                           "Requesting VIN from " + getECUName( *mECUs.front() ) );
+            OBDRequest request;
+            request.type = OBDRequestType::VIN;
+            request.sid = vehicleIdentificationNumberRequest.mSID;
+            request.pids = { vehicleIdentificationNumberRequest.mPID };
+            mECUs.front()->pendingRequests.emplace_back( std::move( request ) );
+            // Rescheduled if the request fails
+            mNextVINRequestTime = OBDPIDScheduler::NOTHING_SCHEDULED;
         }
 
-        // Thread woken up. Execute the PID request flow if activated.
-        if ( OBDModule->mDecoderDictionaryPtr && !OBDModule->mDecoderDictionaryPtr->empty() )
-        {
-            // Start by requesting the VIN then
-            // Check whether the ECUs reported their support PIDs.
-            // If not, request and process them.
-            // We need to consolidate these functions into a generic implementation that
-            // takes the ECUType as an input. Currently we are limited to 2 ECUs only.
-            SupportedPIDs enginePIDs;
-            SupportedPIDs transmissionPIDs;
-            EmissionInfo enginePIDInfo;
-            EmissionInfo transmissionPIDInfo;
-            ECUDiagnosticInfo transmissionDiagnosticInfo;
-            ECUDiagnosticInfo engineDiagnosticInfo;
-            engineDiagnosticInfo.mEcuType = ECUType::ENGINE;
-            transmissionDiagnosticInfo.mEcuType = ECUType::TRANSMISSION;
-            // Check if the VIN has been already successfully requested.
-            // If not, request it and store it.
-            // The request always goes to the ECM, even though the VIN is also available
-            // in other ECUs.
-            if ( OBDModule->mVIN.empty() )
+        for ( auto &ecu : mECUs )
+        {
+            if ( mPIDRequestIntervalSeconds == 0 )
             {
-                OBDModule->mLogger.trace( "OBDOverCANModule::doWork", "Requesting VIN from Engine ECU" );
-                if ( OBDModule->requestReceiveVIN( OBDModule->mVIN ) )
-                {
-                    OBDModule->mLogger.trace( "OBDOverCANModule::doWork", "Received VIN from Engine ECU" );
-                }
-                else
-                {
-                    TraceModule::get().incrementVariable( TraceVariable::OBD_VIN_ERROR );
-                    OBDModule->mLogger.error( "OBDOverCANModule::doWork", "Failed to receive VIN from Engine ECU" );
-                }
+                break;
             }
-
-            // Set the VIN on the diagnostic infos
-            engineDiagnosticInfo.mVIN = OBDModule->mVIN;
-            transmissionDiagnosticInfo.mVIN = OBDModule->mVIN;
-            // Is it time to request PIDs ?
-            // If so, send the requests then reschedule PID requests
-            if ( OBDModule->mPIDRequestIntervalSeconds > 0 &&
-                 OBDModule->mPIDTimer.getElapsedSeconds() >= OBDModule->mPIDRequestIntervalSeconds )
+            // Check whether the ECU reported its supported PIDs. If not, request them.
+            if ( ecu->supportedPIDs.empty() )
             {
-                // Engine ECU
-                if ( OBDModule->mEngineECUSenderReceiver.isAlive() && OBDModule->mSupportedPIDsEngine.empty() )
+                if ( now >= ecu->nextSupportedPIDsRequestTime )
                 {
-                    OBDModule->mLogger.trace( "OBDOverCANModule::doWork", "Requesting Supported PIDs from Engine ECU" );
-                    // Send the Supported PID request
-                    SupportedPIDs enginePIDs;
-                    if ( OBDModule->requestReceiveSupportedPIDs(
-                             SID::CURRENT_STATS, OBDModule->mEngineECUSenderReceiver, enginePIDs ) )
-                    {
-                        std::sort( enginePIDs.begin(), enginePIDs.end() );
-                        OBDModule->mSupportedPIDsEngine.emplace( SID::CURRENT_STATS, enginePIDs );
-                        std::ostringstream oss;
-                        oss << ": ";
-                        if ( !enginePIDs.empty() )
-                        {
-                            std::copy(
-                                enginePIDs.begin(), enginePIDs.end() - 1, std::ostream_iterator<int>( oss, "," ) );
-                            oss << std::to_string( enginePIDs.back() );
-                        }
-                        OBDModule->mLogger.trace( "OBDOverCANModule::doWork",
-                                                  "Engine ECU supports PIDs for SID " +
-                                                      std::to_string( toUType( SID::CURRENT_STATS ) ) + oss.str() );
-                        // Take the common PIDs between the ECU supported PIDs and the PIDs that are requested by
-                        // Decoder Dictionary
-                        OBDModule->updatePIDRequestList( SID::CURRENT_STATS,
-                                                         ECUType::ENGINE,
-                                                         OBDModule->mSupportedPIDsEngine,
-                                                         OBDModule->mPIDsToRequestEngine );
-                    }
-                    else
+                    mLogger.trace( "OBDOverCANModule::scheduleRequests",
+                                   "Requesting Supported PIDs from " + getECUName( *ecu ) );
+                    static_assert( supportedPIDRange.size() <= 8,
+                                   "Array length for supported PID range shall be less or equal than 8" );
+                    ecu->receivedSupportedPIDs.clear();
+                    ecu->supportedPIDsReceived = false;
+                    // Request supported PID range. Per ISO 15765, we can only send six PID at one time
+                    for ( size_t i = 0; i < supportedPIDRange.size(); i += MAX_PID_RANGE )
                     {
-                        TraceModule::get().incrementVariable( TraceVariable::OBD_ENG_PID_REQ_ERROR );
-                        OBDModule->mLogger.error( "OBDOverCANModule::doWork",
-                                                  "Failed to request/receive Engine ECU PIDs for SID: " +
-                                                      std::to_string( toUType( SID::CURRENT_STATS ) ) );
+                        OBDRequest request;
+                        request.type = OBDRequestType::SUPPORTED_PIDS;
+                        request.sid = SID::CURRENT_STATS;
+                        request.pids = std::vector<PID>(
+                            supportedPIDRange.begin() + i,
+                            supportedPIDRange.begin() + std::min( i + MAX_PID_RANGE, supportedPIDRange.size() ) );
+                        ecu->pendingRequests.emplace_back( std::move( request ) );
                     }
+                    // Rescheduled if the requests fail
+                    ecu->nextSupportedPIDsRequestTime = OBDPIDScheduler::NOTHING_SCHEDULED;
                 }
-                // Transmission ECU
-                if ( OBDModule->mHasTransmission && OBDModule->mSupportedPIDsTransmission.empty() )
+            }
+            // To not overwhelm the ECU, the PIDs that became due while it was busy are
+            // requested once it is idle again.
+            else if ( !ecu->requestInFlight && ecu->pendingRequests.empty() )
+            {
+                // Request the due PIDs ( up to 6 at a time )
+                auto duePIDs = ecu->pidScheduler.getDuePIDs( now );
+                for ( size_t i = 0; i < duePIDs.size(); i += MAX_PID_RANGE )
                 {
-                    OBDModule->mLogger.trace( "OBDOverCANModule::doWork",
-                                              "Requesting Supported PIDs from Transmission ECU" );
-                    // Send the Supported PID request
-                    SupportedPIDs transmissionPIDs;
-                    if ( OBDModule->requestReceiveSupportedPIDs(
-                             SID::CURRENT_STATS, OBDModule->mTransmissionECUSenderReceiver, transmissionPIDs ) )
-                    {
-                        std::sort( transmissionPIDs.begin(), transmissionPIDs.end() );
-                        OBDModule->mSupportedPIDsTransmission.emplace( SID::CURRENT_STATS, transmissionPIDs );
-                        std::ostringstream oss;
-                        oss << ": ";
-                        if ( !transmissionPIDs.empty() )
-                        {
-                            std::copy( transmissionPIDs.begin(),
-                                       transmissionPIDs.end() - 1,
-                                       std::ostream_iterator<int>( oss, "," ) );
-                            oss << std::to_string( transmissionPIDs.back() );
-                        }
-                        OBDModule->mLogger.trace( "OBDOverCANModule::doWork",
-                                                  "Transmission ECU supports PIDs for SID " +
-                                                      std::to_string( toUType( SID::CURRENT_STATS ) ) + oss.str() );
-                        // Take the common PIDs between the ECU supported PIDs and the PIDs that are requested by
-                        // Decoder Dictionary
-                        OBDModule->updatePIDRequestList( SID::CURRENT_STATS,
-                                                         ECUType::TRANSMISSION,
-                                                         OBDModule->mSupportedPIDsTransmission,
-                                                         OBDModule->mPIDsToRequestTransmission );
-                    }
-                    else
-                    {
-                        TraceModule::get().incrementVariable( TraceVariable::OBD_TRA_PID_REQ_ERROR );
-                        OBDModule->mLogger.error( "OBDOverCANModule::doWork",
-                                                  "Failed to request/receive Transmission ECU PIDs for SID: " +
-                                                      std::to_string( toUType( SID::CURRENT_STATS ) ) );
-                    }
+                    OBDRequest request;
+                    request.type = OBDRequestType::EMISSION_PIDS;
+                    request.sid = SID::CURRENT_STATS;
+                    request.pids = std::vector<PID>( duePIDs.begin() + static_cast<std::ptrdiff_t>( i ),
+                                                     duePIDs.begin() + static_cast<std::ptrdiff_t>( std::min(
+                                                                           i + MAX_PID_RANGE, duePIDs.size() ) ) );
+                    ecu->pendingRequests.emplace_back( std::move( request ) );
                 }
+            }
+        }
+    }
+    // Request stored DTCs from each ECU, once the previous round completed
+    if ( mShouldRequestDTCs.load( std::memory_order_relaxed ) && mDTCRequestIntervalSeconds > 0 &&
+         mPendingDTCResponses == 0 && now >= mNextDTCRequestTime )
+    {
+        mDTCInfo = DTCInfo();
+        mDTCInfo.receiveTime = now;
+        mDTCRequestSucceeded = false;
+        for ( auto &ecu : mECUs )
+        {
+            OBDRequest request;
+            request.type = OBDRequestType::DTCS;
+            request.sid = SID::STORED_DTC;
+            ecu->pendingRequests.emplace_back( std::move( request ) );
+            mPendingDTCResponses++;
+        }
+        // Reschedule
+        mNextDTCRequestTime = now + static_cast<Timestamp>( mDTCRequestIntervalSeconds ) * 1000;
+    }
+}
 
-                // Request the PIDs ( up to 6 at a time )
-                // To not overwhelm the bus, we split the PIDs into group of 6
-                // and wait for the response.
-                // Start with the ECM
-                if ( OBDModule->getPIDsToRequest( SID::CURRENT_STATS, ECUType::ENGINE, enginePIDs ) &&
-                     !enginePIDs.empty() )
-                {
-                    OBDModule->mLogger.trace( "OBDOverCANModule::doWork", "Requesting Emission PIDs from the ECM" );
-                    if ( OBDModule->requestReceiveEmissionPIDs(
-                             SID::CURRENT_STATS, enginePIDs, OBDModule->mEngineECUSenderReceiver, enginePIDInfo ) )
-                    {
-                        auto receptionTime = OBDModule->mClock->timeSinceEpochMs();
-                        for ( auto const &signals : enginePIDInfo.mPIDsToValues )
-                        {
-                            // Note Signal buffer is a multi producer single consumer queue. Besides current thread,
-                            // Vehicle Data Consumer will also push signals onto this buffer
-                            TraceModule::get().incrementAtomicVariable(
-                                TraceAtomicVariable::QUEUE_CONSUMER_TO_INSPECTION_SIGNALS );
-                            if ( !OBDModule->mSignalBufferPtr->push(
-                                     CollectedSignal( signals.first, receptionTime, signals.second ) ) )
-                            {
-                                TraceModule::get().decrementAtomicVariable(
-                                    TraceAtomicVariable::QUEUE_CONSUMER_TO_INSPECTION_SIGNALS );
-                                OBDModule->mLogger.warn( "OBDOverCANModule::doWork", "Signal Buffer full!" );
-                            }
-                            OBDModule->mLogger.trace( "OBDOverCANModule::doWork",
-                                                      "Received Signal " + std::to_string( signals.first ) + " : " +
-                                                          std::to_string( signals.second ) );
-                        }
-                        OBDModule->mLogger.trace( "OBDOverCANModule::doWork",
-                                                  "Received Emission PIDs data from the ECM" );
-                    }
-                    else
-                    {
-                        OBDModule->mLogger.warn( "OBDOverCANModule::doWork",
-                                                 "Emission PIDs data from the ECM was not received" );
-                    }
-                }
-                // TCM
-                if ( OBDModule->mHasTransmission &&
-                     OBDModule->getPIDsToRequest( SID::CURRENT_STATS, ECUType::TRANSMISSION, transmissionPIDs ) &&
-                     !transmissionPIDs.empty() )
+void
+OBDOverCANModule::sendNextRequest( ECUSession &ecu, Timestamp now )
+{
+    while ( !ecu.requestInFlight && !ecu.pendingRequests.empty() )
+    {
+        ecu.activeRequest = std::move( ecu.pendingRequests.front() );
+        ecu.pendingRequests.pop_front();
+        bool sent = false;
+        if ( ecu.activeRequest.type == OBDRequestType::DTCS )
+        {
+            mTxPDU.clear();
+            // Only SID is required for DTC requests
+            mTxPDU.emplace_back( static_cast<uint8_t>( ecu.activeRequest.sid ) );
+            sent = ecu.senderReceiver->sendPDU( mTxPDU );
+        }
+        else
+        {
+            sent = requestPIDs( ecu.activeRequest.sid, ecu.activeRequest.pids, *ecu.senderReceiver );
+        }
+        if ( sent )
+        {
+            ecu.requestInFlight = true;
+            ecu.responseDeadline = now + P2_TIMEOUT_DEFAULT_MS;
+        }
+        else
+        {
+            mLogger.warn( "OBDOverCANModule::sendNextRequest", "Failed to send request to " + getECUName( ecu ) );
+            mRxPDU.clear();
+            handleResponse( ecu, mRxPDU, now );
+        }
+    }
+}
+
+void
+OBDOverCANModule::waitForResponses( Timestamp until )
+{
+    auto now = mClock->timeSinceEpochMs();
+    int timeoutMs = until > now ? static_cast<int>( std::min<Timestamp>( until - now, INT_MAX ) ) : 0;
+    struct epoll_event events[MAX_EPOLL_EVENTS];
+    int eventCount = epoll_wait( mEpollFd, events, MAX_EPOLL_EVENTS, timeoutMs );
+    if ( eventCount < 0 && errno != EINTR )
+    {
+        mLogger.error( "OBDOverCANModule::waitForResponses", "epoll_wait failed: " + std::to_string( errno ) );
+    }
+    now = mClock->timeSinceEpochMs();
+    for ( int i = 0; i < eventCount; i++ )
+    {
+        auto ecu = static_cast<ECUSession *>( events[i].data.ptr );
+        // Reading does not block, as the socket is readable
+        if ( !ecu->senderReceiver->receivePDU( mRxPDU ) )
+        {
+            mRxPDU.clear();
+        }
+        if ( !ecu->requestInFlight )
+        {
+            // Late response to a request that already timed out
+            mLogger.trace( "OBDOverCANModule::waitForResponses",
+                           "Dropping unexpected response from " + getECUName( *ecu ) );
+            continue;
+        }
+        if ( LoggingModule::isEnabled( LogLevel::Trace ) )
+        {
+            mLogger.trace( "OBDOverCANModule::waitForResponses",
+                           getECUName( *ecu ) + " Response: " + toString( mRxPDU ) );
+        }
+        handleResponse( *ecu, mRxPDU, now );
+        sendNextRequest( *ecu, now );
+    }
+    for ( auto &ecu : mECUs )
+    {
+        if ( ecu->requestInFlight && now >= ecu->responseDeadline )
+        {
+            TraceModule::get().incrementVariable( TraceVariable::OBD_REQUEST_TIMEOUT );
+            mLogger.warn( "OBDOverCANModule::waitForResponses", "Request to " + getECUName( *ecu ) + " timed out" );
+            mRxPDU.clear();
+            handleResponse( *ecu, mRxPDU, now );
+            sendNextRequest( *ecu, now );
+        }
+    }
+}
+
+void
+OBDOverCANModule::handleResponse( ECUSession &ecu, const std::vector<uint8_t> &response, Timestamp now )
+{
+    ecu.requestInFlight = false;
+    const auto &request = ecu.activeRequest;
+    switch ( request.type )
+    {
+    case OBDRequestType::VIN:
+        if ( !response.empty() && mOBDDataDecoder->decodeVIN( response, mVIN ) )
+        {
+            mLogger.trace( "OBDOverCANModule::handleResponse", "Received VIN from " + getECUName( ecu ) );
+        }
+        else
+        {
+            TraceModule::get().incrementVariable( TraceVariable::OBD_VIN_ERROR );
+            mLogger.error( "OBDOverCANModule::handleResponse", "Failed to receive VIN from " + getECUName( ecu ) );
+            mNextVINRequestTime =
+                now + static_cast<Timestamp>(
+                          mPIDRequestIntervalSeconds > 0 ? mPIDRequestIntervalSeconds : mDTCRequestIntervalSeconds ) *
+                          1000;
+        }
+        break;
+    case OBDRequestType::SUPPORTED_PIDS:
+        // Receive the PDU that has the Supported PIDs for this SID
+        // decoded according to J1979 8.1.2.2
+        if ( !response.empty() &&
+             mOBDDataDecoder->decodeSupportedPIDs( request.sid, response, ecu.receivedSupportedPIDs ) )
+        {
+            ecu.supportedPIDsReceived = true;
+        }
+        else
+        {
+            // log warning as all emissions-related OBD ECUs which support at least one of the
+            // services defined in J1979 shall support Service $01 and PID $00
+            mLogger.warn( "OBDOverCANModule::handleResponse",
+                          "Fail to receive supported PID range from " + getECUName( ecu ) );
+        }
+        // Once all supported PID ranges are requested, store the result
+        if ( ecu.pendingRequests.empty() || ecu.pendingRequests.front().type != OBDRequestType::SUPPORTED_PIDS )
+        {
+            if ( ecu.supportedPIDsReceived )
+            {
+                std::sort( ecu.receivedSupportedPIDs.begin(), ecu.receivedSupportedPIDs.end() );
                 {
-                    OBDModule->mLogger.trace( "OBDOverCANModule::doWork", "Requesting Emission PIDs from the TCM" );
-                    if ( OBDModule->requestReceiveEmissionPIDs( SID::CURRENT_STATS,
-                                                                transmissionPIDs,
-                                                                OBDModule->mTransmissionECUSenderReceiver,
-                                                                transmissionPIDInfo ) )
-                    {
-                        auto receptionTime = OBDModule->mClock->timeSinceEpochMs();
-                        for ( auto const &signals : transmissionPIDInfo.mPIDsToValues )
-                        {
-                            // Note Signal buffer is a multi producer single consumer queue. Besides current thread,
-                            // Vehicle Data Consumer will also push signals onto this buffer
-                            TraceModule::get().incrementAtomicVariable(
-                                TraceAtomicVariable::QUEUE_CONSUMER_TO_INSPECTION_SIGNALS );
-                            if ( !OBDModule->mSignalBufferPtr->push(
-                                     CollectedSignal( signals.first, receptionTime, signals.second ) ) )
-                            {
-                                TraceModule::get().decrementAtomicVariable(
-                                    TraceAtomicVariable::QUEUE_CONSUMER_TO_INSPECTION_SIGNALS );
-                                OBDModule->mLogger.warn( "OBDOverCANModule::doWork", "Signal Buffer full!" );
-                            }
-                        }
-                        OBDModule->mLogger.trace( "OBDOverCANModule::doWork",
-                                                  "Received Emission PIDs data from the TCM" );
-                    }
-                    else
-                    {
-                        OBDModule->mLogger.warn( "OBDOverCANModule::doWork",
-                                                 "Emission PIDs data from the TCM was not received" );
-                    }
+                    std::lock_guard<std::mutex> lock( mECUsMutex );
+                    ecu.supportedPIDs[request.sid] = ecu.receivedSupportedPIDs;
                 }
-                // Reschedule
-                OBDModule->mPIDTimer.reset();
+                mLogger.trace( "OBDOverCANModule::handleResponse",
+                               getECUName( ecu ) + " supports PIDs for SID " +
+                                   std::to_string( toUType( request.sid ) ) + ": " +
+                                   toString( ecu.receivedSupportedPIDs ) );
+                // Take the common PIDs between the ECU supported PIDs and the PIDs that are requested by
+                // Decoder Dictionary
+                updatePIDRequestList( request.sid, ecu );
+                updatePIDSchedule( ecu, now );
+            }
+            else
+            {
+                TraceModule::get().incrementVariable( ecu.responseCANId == mECUs.front()->responseCANId
+                                                          ? TraceVariable::OBD_ENG_PID_REQ_ERROR
+                                                          : TraceVariable::OBD_TRA_PID_REQ_ERROR );
+                mLogger.error( "OBDOverCANModule::handleResponse",
+                               "Failed to request/receive " + getECUName( ecu ) +
+                                   " PIDs for SID: " + std::to_string( toUType( request.sid ) ) );
+                ecu.nextSupportedPIDsRequestTime = now + static_cast<Timestamp>( mPIDRequestIntervalSeconds ) * 1000;
             }
         }
-        // Execute the DTC flow if enabled
-        if ( OBDModule->mShouldRequestDTCs.load( std::memory_order_relaxed ) )
+        break;
+    case OBDRequestType::EMISSION_PIDS:
+    {
+        EmissionInfo info;
+        info.mSID = request.sid;
+        if ( !response.empty() && mOBDDataDecoder->decodeEmissionPIDs( request.sid, request.pids, response, info ) )
+        {
+            pushEmissionInfo( info );
+            mLogger.trace( "OBDOverCANModule::handleResponse",
+                           "Received Emission PIDs data from " + getECUName( ecu ) );
+        }
+        else
+        {
+            mLogger.warn( "OBDOverCANModule::handleResponse",
+                          "Emission PIDs data from " + getECUName( ecu ) + " was not received" );
+        }
+        break;
+    }
+    case OBDRequestType::DTCS:
+        // The DTC info structure will be appended with the new decoded DTCs
+        if ( !response.empty() && mOBDDataDecoder->decodeDTCs( request.sid, response, mDTCInfo ) )
+        {
+            mDTCRequestSucceeded = true;
+            mLogger.trace( "OBDOverCANModule::handleResponse", "Received DTC data from " + getECUName( ecu ) );
+        }
+        else
         {
-            bool successfulDTCRequest = false;
-            DTCInfo dtcInfo;
-            dtcInfo.receiveTime = OBDModule->mClock->timeSinceEpochMs();
-            // Request then reschedule DTC requests stored DTCs from each ECU
-            if ( OBDModule->mDTCRequestIntervalSeconds > 0 &&
-                 OBDModule->mDTCTimer.getElapsedSeconds() >= OBDModule->mDTCRequestIntervalSeconds )
+            mLogger.warn( "OBDOverCANModule::handleResponse", "Failed to receive DTCs from " + getECUName( ecu ) );
+        }
+        if ( mPendingDTCResponses > 0 )
+        {
+            mPendingDTCResponses--;
+            // Also DTCInfo strutcs without any DTCs must be pushed to the queue because it means
+            // there was a OBD request that did not return any SID::STORED_DTCs
+            if ( mPendingDTCResponses == 0 && mDTCRequestSucceeded )
             {
-                // ECM
-                if ( OBDModule->requestReceiveDTCs( SID::STORED_DTC, OBDModule->mEngineECUSenderReceiver, dtcInfo ) )
-                {
-                    successfulDTCRequest = true;
-                    OBDModule->mLogger.trace( "OBDOverCANModule::doWork", "Received DTC data from the ECM" );
-                }
-                else
-                {
-                    OBDModule->mLogger.warn( "OBDOverCANModule::doWork", "Failed to receive DTCs from the ECM" );
-                }
-                // TCM
-                if ( OBDModule->mHasTransmission )
+                // Note DTC buffer is a single producer single consumer queue. This is the only
+                // thread to push DTC Info to the queue
+                if ( !mActiveDTCBufferPtr->push( mDTCInfo ) )
                 {
-                    if ( OBDModule->requestReceiveDTCs(
-                             SID::STORED_DTC, OBDModule->mTransmissionECUSenderReceiver, dtcInfo ) )
-                    {
-                        successfulDTCRequest = true;
-                        OBDModule->mLogger.trace( "OBDOverCANModule::doWork", "Received DTC data from the TCM" );
-                    }
-                    else
-                    {
-                        OBDModule->mLogger.warn( "OBDOverCANModule::doWork", "Failed to receive DTCs from the TCM" );
-                    }
+                    mLogger.warn( "OBDOverCANModule::handleResponse", "DTC Buffer full!" );
                 }
-                // Also DTCInfo strutcs without any DTCs must be pushed to the queue because it means
-                // there was a OBD request that did not return any SID::STORED_DTCs
-                if ( successfulDTCRequest )
-                {
-                    // Note DTC buffer is a single producer single consumer queue. This is the only
-                    // thread to push DTC Info to the queue
-                    if ( !OBDModule->mActiveDTCBufferPtr->push( dtcInfo ) )
-                    {
-                        OBDModule->mLogger.warn( "OBDOverCANModule::doWork", "DTC Buffer full!" );
-                    }
-                }
-
-                // Reschedule
-                OBDModule->mDTCTimer.reset();
             }
         }
+        break;
+    }
+}
 
-        // Wait for the next cycle
-        uint32_t sleepTime =
-            OBDModule->mDTCRequestIntervalSeconds > 0
-                ? std::min( OBDModule->mPIDRequestIntervalSeconds, OBDModule->mDTCRequestIntervalSeconds )
-                : OBDModule->mPIDRequestIntervalSeconds;
+void
+OBDOverCANModule::pushEmissionInfo( const EmissionInfo &info )
+{
+    auto receptionTime = mClock->timeSinceEpochMs();
+    mCollectedSignals.clear();
+    for ( auto const &signals : info.mPIDsToValues )
+    {
+        mCollectedSignals.emplace_back( signals.first, receptionTime, signals.second );
+        if ( LoggingModule::isEnabled( LogLevel::Trace ) )
+        {
+            mLogger.trace( "OBDOverCANModule::pushEmissionInfo",
+                           "Received Signal " + std::to_string( signals.first ) + " : " +
+                               std::to_string( signals.second ) );
+        }
+    }
+    // Note Signal buffer is a multi producer single consumer queue. Besides current thread, Vehicle Data Consumers
+    // push signals onto this buffer, each through its own lane
+    auto pushed = mSignalBufferLane->push( mCollectedSignals.data(), mCollectedSignals.size() );
+    for ( auto i = pushed; i < mCollectedSignals.size(); i++ )
+    {
+        mDroppedSignals.add( mCollectedSignals[i].signalID );
+    }
+    mDroppedSignals.logIfDue();
+}
 
-        OBDModule->mLogger.trace( "OBDOverCANModule::doWork",
-                                  " Waiting for :" + std::to_string( sleepTime ) + " seconds" );
-        OBDModule->mWait.wait( static_cast<uint32_t>( sleepTime * 1000 ) );
+Timestamp
+OBDOverCANModule::getNextWakeUpTime() const
+{
+    Timestamp wakeUpTime = OBDPIDScheduler::NOTHING_SCHEDULED;
+    bool hasDictionary = mDecoderDictionaryPtr && !mDecoderDictionaryPtr->empty();
+    for ( const auto &ecu : mECUs )
+    {
+        if ( ecu->requestInFlight )
+        {
+            wakeUpTime = std::min( wakeUpTime, ecu->responseDeadline );
+        }
+        else if ( ecu->pendingRequests.empty() && hasDictionary && mPIDRequestIntervalSeconds > 0 )
+        {
+            wakeUpTime = std::min( wakeUpTime,
+                                   ecu->supportedPIDs.empty() ? ecu->nextSupportedPIDsRequestTime
+                                                              : ecu->pidScheduler.getNextDueTime() );
+        }
+    }
+    if ( hasDictionary && mVIN.empty() && !mECUs.empty() )
+    {
+        wakeUpTime = std::min( wakeUpTime, mNextVINRequestTime );
     }
+    if ( mShouldRequestDTCs.load( std::memory_order_relaxed ) && mDTCRequestIntervalSeconds > 0 &&
+         mPendingDTCResponses == 0 && !mECUs.empty() )
+    {
+        wakeUpTime = std::min( wakeUpTime, mNextDTCRequestTime );
+    }
+    return wakeUpTime;
 }
 
 bool
-OBDOverCANModule::requestReceiveEmissionPIDs( const SID &sid,
-                                              const SupportedPIDs &pids,
-                                              ISOTPOverCANSenderReceiver &isoTPSendReceive,
-                                              EmissionInfo &info )
+OBDOverCANModule::requestsInFlight() const
 {
-    size_t rangeCount = pids.size() / OBDOverCANModule::MAX_PID_RANGE;
-    size_t rangeLeft = pids.size() % OBDOverCANModule::MAX_PID_RANGE;
+    return std::any_of(
+        mECUs.begin(), mECUs.end(), []( const std::unique_ptr<ECUSession> &ecu ) { return ecu->requestInFlight; } );
+}
 
-    while ( rangeCount > 0 )
+std::string
+OBDOverCANModule::getECUName( const ECUSession &ecu ) const
+{
+    if ( ecu.responseCANId ==
+         static_cast<uint32_t>( toUType( mUseExtendedIDs ? ECUID::ENGINE_ECU_RX_EXTENDED : ECUID::ENGINE_ECU_RX ) ) )
     {
-        auto pidList =
-            std::vector<PID>( pids.begin() + static_cast<uint32_t>( rangeCount - 1U ) * OBDOverCANModule::MAX_PID_RANGE,
-                              pids.begin() + static_cast<uint32_t>( rangeCount ) * OBDOverCANModule::MAX_PID_RANGE );
-        // start from the tail and walk backwards.
-        if ( requestPIDs( sid, pidList, isoTPSendReceive ) )
-        {
-            if ( receivePIDs( sid, pidList, isoTPSendReceive, info ) )
-            {
-                mLogger.trace( "OBDOverCANModule::doWork",
-                               "Received Emission PID data for SID: " + std::to_string( toUType( sid ) ) );
-            }
-            else
-            {
-                mLogger.warn( "OBDOverCANModule::doWork",
-                              "Emission PID data for SID: " + std::to_string( toUType( sid ) ) + " Not received" );
-            }
-        }
-        rangeCount--;
+        return "Engine ECU";
+    }
+    if ( ecu.responseCANId == static_cast<uint32_t>( toUType( mUseExtendedIDs ? ECUID::TRANSMISSION_ECU_RX_EXTENDED
+                                                                              : ECUID::TRANSMISSION_ECU_RX ) ) )
+    {
+        return "Transmission ECU";
+    }
+    std::ostringstream oss;
+    oss << "ECU 0x" << std::hex << std::uppercase << ecu.responseCANId;
+    return oss.str();
+}
+
+std::vector<std::pair<uint32_t, uint32_t>>
+OBDOverCANModule::discoverECUs()
+{
+    std::vector<std::pair<uint32_t, uint32_t>> ecus;
+    int discoverySocket = socket( PF_CAN, SOCK_RAW | SOCK_NONBLOCK, CAN_RAW );
+    if ( discoverySocket < 0 )
+    {
+        mLogger.warn( "OBDOverCANModule::discoverECUs", "Failed to create the discovery socket" );
+        return ecus;
+    }
+    // Only receive the physical responses of the ECUs to the functional request
+    struct can_filter filter = {};
+    if ( mUseExtendedIDs )
+    {
+        filter.can_id = ECU_RESPONSE_EXTENDED_ID_BASE | CAN_EFF_FLAG;
+        filter.can_mask = ECU_RESPONSE_EXTENDED_ID_MASK | CAN_EFF_FLAG;
+    }
+    else
+    {
+        filter.can_id = toUType( ECUID::ENGINE_ECU_RX );
+        filter.can_mask = ECU_RESPONSE_ID_MASK | CAN_EFF_FLAG;
+    }
+    struct sockaddr_can interfaceAddress = {};
+    interfaceAddress.can_family = AF_CAN;
+    interfaceAddress.can_ifindex = static_cast<int>( if_nametoindex( mGatewayCanInterfaceName.c_str() ) );
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-cstyle-cast)
+    if ( setsockopt( discoverySocket, SOL_CAN_RAW, CAN_RAW_FILTER, &filter, sizeof( filter ) ) != 0 ||
+         bind( discoverySocket, (struct sockaddr *)&interfaceAddress, sizeof( interfaceAddress ) ) != 0 )
+    {
+        mLogger.warn( "OBDOverCANModule::discoverECUs",
+                      "Failed to bind the discovery socket to IF:" + mGatewayCanInterfaceName );
+        close( discoverySocket );
+        return ecus;
+    }
+
+    // Functional Supported PIDs request as ISO-TP single frame. All emission related ECUs shall respond to it.
+    struct can_frame frame = {};
+    frame.can_id = mUseExtendedIDs ? ( toUType( ECUID::BROADCAST_EXTENDED_ID ) | CAN_EFF_FLAG )
+                                   : toUType( ECUID::BROADCAST_ID );
+    frame.can_dlc = CAN_MAX_DLEN;
+    std::fill( std::begin( frame.data ), std::end( frame.data ), ISOTP_PADDING_BYTE );
+    frame.data[0] = 0x02;
+    frame.data[1] = toUType( SID::CURRENT_STATS );
+    frame.data[2] = supportedPIDRange[0];
+    if ( write( discoverySocket, &frame, sizeof( frame ) ) != static_cast<ssize_t>( sizeof( frame ) ) )
+    {
+        mLogger.warn( "OBDOverCANModule::discoverECUs", "Failed to send the discovery request" );
+        close( discoverySocket );
+        return ecus;
     }
-    // request the remaining PIDs if any.
-    if ( rangeLeft > 0 )
+
+    auto now = mClock->timeSinceEpochMs();
+    const auto deadline = now + ECU_DISCOVERY_TIMEOUT_MS;
+    while ( now < deadline )
     {
-        auto pidList = std::vector<PID>( pids.end() - static_cast<uint32_t>( rangeLeft ), pids.end() );
-        if ( requestPIDs( sid, pidList, isoTPSendReceive ) )
+        struct pollfd pfd = { discoverySocket, POLLIN, 0 };
+        if ( poll( &pfd, 1U, static_cast<int>( deadline - now ) ) <= 0 )
+        {
+            break;
+        }
+        while ( read( discoverySocket, &frame, sizeof( frame ) ) == static_cast<ssize_t>( sizeof( frame ) ) )
         {
-            if ( receivePIDs( sid, pidList, isoTPSendReceive, info ) )
+            // Positive response in a single frame, or in the first frame of a multi frame PDU
+            uint8_t frameType = frame.data[0] & 0xF0;
+            bool positiveResponse =
+                ( frameType == 0x00 &&
+                  frame.data[1] == ( toUType( SID::CURRENT_STATS ) + POSITIVE_RESPONSE_OFFSET ) ) ||
+                ( frameType == 0x10 && frame.data[2] == ( toUType( SID::CURRENT_STATS ) + POSITIVE_RESPONSE_OFFSET ) );
+            if ( !positiveResponse )
             {
-                mLogger.trace( "OBDOverCANModule::doWork",
-                               "Received Emission PID data for SID: " + std::to_string( toUType( sid ) ) );
+                continue;
             }
-            else
+            uint32_t responseCANId = frame.can_id & CAN_EFF_MASK;
+            uint32_t requestCANId = mUseExtendedIDs
+                                        ? ( ECU_REQUEST_EXTENDED_ID_BASE | ( ( responseCANId & 0xFF ) << 8 ) )
+                                        : responseCANId - ECU_RESPONSE_ID_OFFSET;
+            if ( std::none_of( ecus.begin(), ecus.end(), [responseCANId]( const std::pair<uint32_t, uint32_t> &ecu ) {
+                     return ecu.second == responseCANId;
+                 } ) )
             {
-                mLogger.warn( "OBDOverCANModule::doWork",
-                              "Emission PID data for SID: " + std::to_string( toUType( sid ) ) + " Not received" );
+                ecus.emplace_back( requestCANId, responseCANId );
             }
         }
+        now = mClock->timeSinceEpochMs();
     }
-
-    return !info.mPIDsToValues.empty();
+    close( discoverySocket );
+    std::sort( ecus.begin(),
+               ecus.end(),
+               []( const std::pair<uint32_t, uint32_t> &a, const std::pair<uint32_t, uint32_t> &b ) {
+                   return a.second < b.second;
+               } );
+    return ecus;
 }
 
 bool
-OBDOverCANModule::requestReceiveSupportedPIDs( const SID &sid,
-                                               ISOTPOverCANSenderReceiver &isoTPSendReceive,
-                                               SupportedPIDs &supportedPIDs )
-{
-    // Function will return true if it receive supported PIDs from the ECU
-    bool requestStatus = false;
-    static_assert( supportedPIDRange.size() <= 8,
-                   "Array length for supported PID range shall be less or equal than 8" );
-    mLogger.trace( "OBDOverCANModule::requestReceiveSupportedPIDs", "send supported PID requests" );
-    supportedPIDs.clear();
-    // Request supported PID range. Per ISO 15765, we can only send six PID at one time
-    auto pidList = std::vector<PID>( supportedPIDRange.begin(),
-                                     supportedPIDRange.begin() +
-                                         std::min( OBDOverCANModule::MAX_PID_RANGE, supportedPIDRange.size() ) );
-    if ( requestPIDs( sid, pidList, isoTPSendReceive ) )
-    {
-        // Wait and process the response
-        if ( receiveSupportedPIDs( sid, isoTPSendReceive, supportedPIDs ) )
-        {
-            // we have received a list of supported PIDs
-            requestStatus = true;
-        }
-        else
+OBDOverCANModule::connectECUs()
+{
+    const uint32_t engineRequestCANId =
+        toUType( mUseExtendedIDs ? ECUID::ENGINE_ECU_TX_EXTENDED : ECUID::ENGINE_ECU_TX );
+    const uint32_t engineResponseCANId =
+        toUType( mUseExtendedIDs ? ECUID::ENGINE_ECU_RX_EXTENDED : ECUID::ENGINE_ECU_RX );
+    const uint32_t transmissionRequestCANId =
+        toUType( mUseExtendedIDs ? ECUID::TRANSMISSION_ECU_TX_EXTENDED : ECUID::TRANSMISSION_ECU_TX );
+    const uint32_t transmissionResponseCANId =
+        toUType( mUseExtendedIDs ? ECUID::TRANSMISSION_ECU_RX_EXTENDED : ECUID::TRANSMISSION_ECU_RX );
+
+    auto ecuCANIds = discoverECUs();
+    if ( ecuCANIds.empty() )
+    {
+        mLogger.info( "OBDOverCANModule::connectECUs", "No ECU responded to the discovery, using the configured ECUs" );
+        ecuCANIds.emplace_back( engineRequestCANId, engineResponseCANId );
+        if ( mHasTransmission )
         {
-            // log warning as all emissions-related OBD ECUs which support at least one of the
-            // services defined in J1979 shall support Service $01 and PID $00
-            mLogger.warn( "OBDOverCANModule::requestReceiveSupportedPIDs", "Fail to receive supported PID range" );
+            ecuCANIds.emplace_back( transmissionRequestCANId, transmissionResponseCANId );
         }
     }
-    // check if we need to send out more PID range request
-    if ( OBDOverCANModule::MAX_PID_RANGE < supportedPIDRange.size() )
+    else
     {
-        pidList =
-            std::vector<PID>( supportedPIDRange.begin() + OBDOverCANModule::MAX_PID_RANGE, supportedPIDRange.end() );
-        if ( requestPIDs( sid, pidList, isoTPSendReceive ) )
+        // Keep the configured request IDs of the known ECUs
+        for ( auto &ecuCANId : ecuCANIds )
         {
-            // Wait and process the response
-            if ( receiveSupportedPIDs( sid, isoTPSendReceive, supportedPIDs ) )
+            if ( ecuCANId.second == engineResponseCANId )
             {
-                // we have received a list of supported PIDs
-                requestStatus = true;
+                ecuCANId.first = engineRequestCANId;
             }
+            else if ( ecuCANId.second == transmissionResponseCANId )
+            {
+                ecuCANId.first = transmissionRequestCANId;
+            }
+        }
+        mLogger.info( "OBDOverCANModule::connectECUs",
+                      "Discovered " + std::to_string( ecuCANIds.size() ) + " ECUs on IF:" +
+                          mGatewayCanInterfaceName );
+    }
+
+    mEpollFd = epoll_create1( EPOLL_CLOEXEC );
+    if ( mEpollFd < 0 )
+    {
+        mLogger.error( "OBDOverCANModule::connectECUs", "Failed to create the epoll instance" );
+        return false;
+    }
+    // Establish a bi-directional P2P channel on ISO-TP between FWE and each ECU.
+    // Each ECU listens on the bus for their RX IDs, and respond with their TX IDs.
+    std::vector<std::unique_ptr<ECUSession>> ecus;
+    for ( const auto &ecuCANId : ecuCANIds )
+    {
+        auto ecu = std::make_unique<ECUSession>();
+        ecu->requestCANId = ecuCANId.first;
+        ecu->responseCANId = ecuCANId.second;
+        ecu->senderReceiver = std::make_unique<ISOTPOverCANSenderReceiver>();
+        ISOTPOverCANSenderReceiverOptions options;
+        options.mSocketCanIFName = mGatewayCanInterfaceName;
+        options.mIsExtendedId = mUseExtendedIDs;
+        options.mSourceCANId = ecu->requestCANId;
+        options.mDestinationCANId = ecu->responseCANId;
+        if ( !ecu->senderReceiver->init( options ) || !ecu->senderReceiver->connect() )
+        {
+            mLogger.error( "OBDOverCANModule::connectECUs", "Failed to connect to " + getECUName( *ecu ) );
+            continue;
         }
+        struct epoll_event event = {};
+        event.events = EPOLLIN;
+        event.data.ptr = ecu.get();
+        if ( epoll_ctl( mEpollFd, EPOLL_CTL_ADD, ecu->senderReceiver->getSocket(), &event ) != 0 )
+        {
+            mLogger.error( "OBDOverCANModule::connectECUs", "Failed to watch the socket of " + getECUName( *ecu ) );
+            ecu->senderReceiver->disconnect();
+            continue;
+        }
+        mLogger.trace( "OBDOverCANModule::connectECUs", getECUName( *ecu ) + " Initialized" );
+        ecus.emplace_back( std::move( ecu ) );
     }
-    return requestStatus;
+    // Ask the ECM for the VIN
+    std::stable_partition( ecus.begin(), ecus.end(), [engineResponseCANId]( const std::unique_ptr<ECUSession> &ecu ) {
+        return ecu->responseCANId == engineResponseCANId;
+    } );
+
+    std::lock_guard<std::mutex> lock( mECUsMutex );
+    mECUs = std::move( ecus );
+    return !mECUs.empty();
 }
 
 bool
 OBDOverCANModule::connect()
 {
-    if ( mHasTransmission )
-    {
-        mTransmissionECUSenderReceiver.connect();
-    }
-
-    return mEngineECUSenderReceiver.connect() && start();
+    return connectECUs() && start();
 }
 
 bool
 OBDOverCANModule::disconnect()
 {
-    if ( mHasTransmission )
+    bool stopped = stop();
+    bool disconnected = true;
+    std::lock_guard<std::mutex> lock( mECUsMutex );
+    for ( auto &ecu : mECUs )
     {
-        mTransmissionECUSenderReceiver.disconnect();
+        disconnected = ecu->senderReceiver->disconnect() && disconnected;
     }
-    return mEngineECUSenderReceiver.disconnect() && stop();
+    mECUs.clear();
+    if ( mEpollFd >= 0 )
+    {
+        close( mEpollFd );
+        mEpollFd = -1;
+    }
+    return disconnected && stopped;
 }
 
 bool
 OBDOverCANModule::isAlive()
 {
-    if ( mHasTransmission )
-    {
-        return mThread.isValid() && mThread.isActive() && mEngineECUSenderReceiver.isAlive() &&
-               mTransmissionECUSenderReceiver.isAlive();
-    }
-    else
-    {
-        return mThread.isValid() && mThread.isActive() && mEngineECUSenderReceiver.isAlive();
-    }
+    std::lock_guard<std::mutex> lock( mECUsMutex );
+    return mThread.isValid() && mThread.isActive() && !mECUs.empty() &&
+           std::all_of( mECUs.begin(), mECUs.end(), []( const std::unique_ptr<ECUSession> &ecu ) {
+               return ecu->senderReceiver->isAlive();
+           } );
 }
 
 void
 OBDOverCANModule::onChangeInspectionMatrix( const std::shared_ptr<const InspectionMatrix> &activeConditions )
 {
-    // We check here that at least one condition needs DTCs. If yes, we activate that.
     if ( activeConditions )
     {
+        // The PIDs are requested at the rate the collection schemes need their signals
+        std::unordered_map<SignalID, uint32_t> signalIntervalsMs;
+        bool shouldRequestDTCs = false;
         for ( auto const &condition : activeConditions->conditions )
         {
-            if ( condition.includeActiveDtcs )
+            // We check here that at least one condition needs DTCs. If yes, we activate that.
+            shouldRequestDTCs = shouldRequestDTCs || condition.includeActiveDtcs;
+            for ( auto const &signal : condition.signals )
             {
-                mShouldRequestDTCs.store( true, std::memory_order_relaxed );
-                mDataAvailableWait.notify();
-                mLogger.info( "OBDOverCANModule::onChangeInspectionMatrix", "Requesting DTC is enabled" );
-                return;
+                if ( signal.minimumSampleIntervalMs == 0 )
+                {
+                    continue;
+                }
+                auto signalInterval = signalIntervalsMs.emplace( signal.signalID, signal.minimumSampleIntervalMs );
+                signalInterval.first->second = std::min( signalInterval.first->second, signal.minimumSampleIntervalMs );
             }
         }
-        // If we are here, that means no condition had DTC collection active. So disabling DTC requests.
-        mShouldRequestDTCs.store( false, std::memory_order_relaxed );
-        // No need to notify, thread will pick it up in the next cycle.
+        {
+            std::lock_guard<std::mutex> lock( mSignalIntervalsMutex );
+            mNewSignalIntervalsMs = std::move( signalIntervalsMs );
+            mSignalIntervalsChanged.store( true, std::memory_order_relaxed );
+        }
+        mShouldRequestDTCs.store( shouldRequestDTCs, std::memory_order_relaxed );
+        if ( shouldRequestDTCs )
+        {
+            mDataAvailableWait.notify();
+            mLogger.info( "OBDOverCANModule::onChangeInspectionMatrix", "Requesting DTC is enabled" );
+        }
+        // If no condition had DTC collection active, the thread will pick it up in the next cycle.
+        mWait.notify();
     }
 }
 
@@ -660,6 +928,7 @@ OBDOverCANModule::onChangeOfActiveDictionary( ConstDecoderDictionaryConstPtr &di
             {
                 // Iterate through the received generic decoder dictionary to construct the OBD specific dictionary
                 std::vector<PID> pidsRequestedByDecoderDict{};
+                std::map<PID, std::vector<SignalID>> pidSignals;
                 if ( canDecoderDictionaryPtr->canMessageDecoderMethod.size() == 1 )
                 {
                     for ( const auto &canMessageDecoderMethod :
@@ -672,50 +941,40 @@ OBDOverCANModule::onChangeOfActiveDictionary( ConstDecoderDictionaryConstPtr &di
                         // Decoder Dictionary. If so, add the PID to pidsRequestedByDecoderDict
                         // Note in worst case scenario when no OBD signals are to be collected, this will
                         // iterate through the entire OBD signal lists which only contains a few hundreds signals.
+                        auto pid = static_cast<PID>( canMessageDecoderMethod.first );
                         for ( const auto &signal : canMessageDecoderMethod.second.format.mSignals )
                         {
                             // if the signal is to be collected according to decoder dictionary, push
-                            // the corresponding PID to the pidsRequestedByDecoderDict
+                            // the corresponding PID to the pidsRequestedByDecoderDict. The collected
+                            // signals of the PID determine how often it is requested.
                             if ( canDecoderDictionaryPtr->signalIDsToCollect.find( signal.mSignalID ) !=
                                  canDecoderDictionaryPtr->signalIDsToCollect.end() )
                             {
-                                pidsRequestedByDecoderDict.emplace_back(
-                                    static_cast<PID>( canMessageDecoderMethod.first ) );
-                                // We know this PID needs to be requested, break to move on next PID
-                                break;
+                                pidSignals[pid].emplace_back( signal.mSignalID );
                             }
                         }
+                        if ( pidSignals.find( pid ) != pidSignals.end() )
+                        {
+                            pidsRequestedByDecoderDict.emplace_back( pid );
+                        }
                     }
                 }
                 // Need to sort the vector to make it easier to search for common PIDs between this vector
                 // and the PIDs supported by ECU.
                 std::sort( pidsRequestedByDecoderDict.begin(), pidsRequestedByDecoderDict.end() );
-                std::ostringstream oss;
-                if ( !pidsRequestedByDecoderDict.empty() )
-                {
-                    std::copy( pidsRequestedByDecoderDict.begin(),
-                               pidsRequestedByDecoderDict.end() - 1,
-                               std::ostream_iterator<int>( oss, "," ) );
-                    oss << std::to_string( pidsRequestedByDecoderDict.back() );
-                }
                 mLogger.trace( "OBDOverCANModule::onChangeOfActiveDictionary",
-                               "Decoder Dictionary requests PIDs: " + oss.str() );
-                // For now we only support OBD Service Mode 1 PID
-                mPIDsRequestedByDecoderDict[SID::CURRENT_STATS] = pidsRequestedByDecoderDict;
-                // If the program already know the supported PIDs from ECU, below two update will update
-                // the PIDs list to request from ECU. Otherwise, the two function below will not perform anything.
-                updatePIDRequestList( SID::CURRENT_STATS, ECUType::ENGINE, mSupportedPIDsEngine, mPIDsToRequestEngine );
-                updatePIDRequestList(
-                    SID::CURRENT_STATS, ECUType::TRANSMISSION, mSupportedPIDsTransmission, mPIDsToRequestTransmission );
+                               "Decoder Dictionary requests PIDs: " + toString( pidsRequestedByDecoderDict ) );
+                mNewPIDsRequestedByDecoderDict = std::move( pidsRequestedByDecoderDict );
+                mNewPIDSignals = std::move( pidSignals );
                 // Pass on the decoder manifest to the OBD Decoder and wake up the thread.
-                // Before that we should interrupt the thread so that no further decoding
-                // is done using the previous decoder, then assign the new decoder manifest,
-                // the wake up the thread.
+                // The thread assigns the new decoder manifest and updates the PIDs to request
+                // from the ECUs before it sends the next requests.
                 if ( !mDecoderDictionaryPtr->empty() )
                 {
                     mDecoderManifestAvailable.store( true, std::memory_order_relaxed );
                     // Wake up the worker thread.
                     mDataAvailableWait.notify();
+                    mWait.notify();
                     mLogger.info( "OBDOverCANModule::onChangeOfActiveDictionary", "Decoder Manifest Updated" );
                 }
             }
@@ -729,66 +988,52 @@ OBDOverCANModule::onChangeOfActiveDictionary( ConstDecoderDictionaryConstPtr &di
 }
 
 void
-OBDOverCANModule::updatePIDRequestList( const SID &sid,
-                                        const ECUType &type,
-                                        std::map<SID, SupportedPIDs> &supportedPIDs,
-                                        std::map<SID, std::vector<PID>> &pidsToRequestPerService )
+OBDOverCANModule::updatePIDRequestList( const SID &sid, ECUSession &ecu )
 {
     // Update the PID Request List with PIDs that are common between decoder dictionary and the PIDs supported by ECU
-    if ( supportedPIDs.find( sid ) != supportedPIDs.end() &&
-         mPIDsRequestedByDecoderDict.find( sid ) != mPIDsRequestedByDecoderDict.end() )
+    auto supportedPIDs = ecu.supportedPIDs.find( sid );
+    auto requestedPIDs = mPIDsRequestedByDecoderDict.find( sid );
+    if ( supportedPIDs != ecu.supportedPIDs.end() && requestedPIDs != mPIDsRequestedByDecoderDict.end() )
     {
         std::vector<PID> pidsToRequest{};
         // Note that the two vector has to be sorted previously to use the function below properly
-        std::set_intersection( supportedPIDs[sid].begin(),
-                               supportedPIDs[sid].end(),
-                               mPIDsRequestedByDecoderDict[sid].begin(),
-                               mPIDsRequestedByDecoderDict[sid].end(),
+        std::set_intersection( supportedPIDs->second.begin(),
+                               supportedPIDs->second.end(),
+                               requestedPIDs->second.begin(),
+                               requestedPIDs->second.end(),
                                std::back_inserter( pidsToRequest ) );
-        std::ostringstream oss;
-        oss << "The PIDs to Request from ";
-        switch ( type )
-        {
-        case ECUType::ENGINE:
-            oss << "Engine ECU are: ";
-            break;
-        case ECUType::TRANSMISSION:
-            oss << "Transmission ECU are: ";
-            break;
-        default:
-            oss << "ECU are: ";
-        }
-        if ( !pidsToRequest.empty() )
-        {
-            std::copy( pidsToRequest.begin(), pidsToRequest.end() - 1, std::ostream_iterator<int>( oss, "," ) );
-            oss << std::to_string( pidsToRequest.back() );
-        }
-        mLogger.trace( "OBDOverCANModule::updatePIDRequestList", oss.str() );
-        pidsToRequestPerService[sid] = pidsToRequest;
+        mLogger.trace( "OBDOverCANModule::updatePIDRequestList",
+                       "The PIDs to Request from " + getECUName( ecu ) + " are: " + toString( pidsToRequest ) );
+        std::lock_guard<std::mutex> lock( mECUsMutex );
+        ecu.pidsToRequest[sid] = std::move( pidsToRequest );
     }
 }
 
-bool
-OBDOverCANModule::receiveSupportedPIDs( const SID &sid,
-                                        ISOTPOverCANSenderReceiver &isoTPSendReceive,
-                                        SupportedPIDs &supportedPIDs )
+void
+OBDOverCANModule::updatePIDSchedule( ECUSession &ecu, Timestamp now )
 {
-    std::vector<uint8_t> ecuResponse;
-    // Receive the PDU that has the Supported PIDs for this SID
-    // decoded according to J1979 8.1.2.2
-    if ( !isoTPSendReceive.receivePDU( ecuResponse ) )
+    if ( mPIDRequestIntervalSeconds == 0 )
     {
-        return false;
+        return;
     }
-    if ( !ecuResponse.empty() )
+    std::map<PID, std::vector<SignalID>> pidSignals;
+    auto pidsToRequest = ecu.pidsToRequest.find( SID::CURRENT_STATS );
+    if ( pidsToRequest != ecu.pidsToRequest.end() )
     {
-        std::ostringstream oss;
-        std::copy( ecuResponse.begin(), ecuResponse.end() - 1, std::ostream_iterator<int>( oss, "," ) );
-        oss << std::to_string( ecuResponse.back() );
-        mLogger.trace( "OBDOverCANModule::receiveSupportedPIDs", "ECU Response: " + oss.str() );
-        return mOBDDataDecoder->decodeSupportedPIDs( sid, ecuResponse, supportedPIDs );
+        for ( auto pid : pidsToRequest->second )
+        {
+            auto signals = mPIDSignals.find( pid );
+            if ( signals != mPIDSignals.end() )
+            {
+                pidSignals.emplace( pid, signals->second );
+            }
+        }
     }
-    return false;
+    // PIDs whose signals have no minimum sample interval are requested every pidRequestIntervalSeconds
+    ecu.pidScheduler.setPIDIntervals(
+        OBDPIDScheduler::calculatePIDIntervals(
+            pidSignals, mSignalIntervalsMs, mPIDRequestIntervalSeconds * 1000, MIN_PID_REQUEST_INTERVAL_MS ),
+        now );
 }
 
 bool
@@ -808,119 +1053,40 @@ OBDOverCANModule::requestPIDs( const SID &sid,
     mTxPDU.emplace_back( static_cast<uint8_t>( sid ) );
     // Then insert the items of the PIDs
     mTxPDU.insert( std::end( mTxPDU ), std::begin( pids ), std::end( pids ) );
-    std::ostringstream oss;
-    std::copy( mTxPDU.begin(), mTxPDU.end() - 1, std::ostream_iterator<int>( oss, "," ) );
-    oss << std::to_string( mTxPDU.back() );
-    mLogger.trace( "OBDOverCANModule::requestPIDs", "Transmit PDU: " + oss.str() );
-    // Send
-    return isoTPSendReceive.sendPDU( mTxPDU );
-}
-
-bool
-OBDOverCANModule::receivePIDs( const SID &sid,
-                               const std::vector<PID> &pids,
-                               ISOTPOverCANSenderReceiver &isoTPSendReceive,
-                               EmissionInfo &info )
-{
-    std::vector<uint8_t> ecuResponse;
-    // Receive the PDU that has the Supported PIDs for this SID
-    // decoded according to J1979 8.1.2.2
-    if ( !isoTPSendReceive.receivePDU( ecuResponse ) )
-    {
-        return false;
-    }
-    // The info structure will be appended with the new decoded PIDs
-    if ( !ecuResponse.empty() )
-    {
-        std::ostringstream oss;
-        std::copy( ecuResponse.begin(), ecuResponse.end() - 1, std::ostream_iterator<int>( oss, "," ) );
-        oss << std::to_string( ecuResponse.back() );
-        mLogger.trace( "OBDOverCANModule::receivePIDs", "ECU Response: " + oss.str() );
-        return mOBDDataDecoder->decodeEmissionPIDs( sid, pids, ecuResponse, info );
-    }
-
-    return false;
-}
-
-bool
-OBDOverCANModule::requestReceiveVIN( std::string &vin )
-{
-    mTxPDU.clear();
-    mTxPDU = { static_cast<uint8_t>( vehicleIdentificationNumberRequest.mSID ),
-               static_cast<uint8_t>( vehicleIdentificationNumberRequest.mPID ) };
-    // Send
-    if ( mEngineECUSenderReceiver.sendPDU( mTxPDU ) )
+    if ( LoggingModule::isEnabled( LogLevel::Trace ) )
     {
-        std::vector<uint8_t> ecuResponse;
-        // Receive the PDU and extract the VIN
-        if ( mEngineECUSenderReceiver.receivePDU( ecuResponse ) && !ecuResponse.empty() &&
-             mOBDDataDecoder->decodeVIN( ecuResponse, vin ) )
-        {
-            return true;
-        }
+        mLogger.trace( "OBDOverCANModule::requestPIDs", "Transmit PDU: " + toString( mTxPDU ) );
     }
-    return false;
-}
-
-bool
-OBDOverCANModule::requestDTCs( const SID &sid, ISOTPOverCANSenderReceiver &isoTPSendReceive )
-{
-    mTxPDU.clear();
-    // Only SID is required for DTC requests
-    mTxPDU.emplace_back( static_cast<uint8_t>( sid ) );
     // Send
     return isoTPSendReceive.sendPDU( mTxPDU );
 }
 
 bool
-OBDOverCANModule::receiveDTCs( const SID &sid, ISOTPOverCANSenderReceiver &isoTPSendReceive, DTCInfo &info )
+OBDOverCANModule::getPIDsToRequest( const SID &sid, const ECUType &type, SupportedPIDs &supportedPIDs ) const
 {
-    std::vector<uint8_t> ecuResponse;
-    if ( !isoTPSendReceive.receivePDU( ecuResponse ) )
+    uint32_t responseCANId = 0;
+    if ( type == ECUType::ENGINE )
     {
-        return false;
+        responseCANId = toUType( mUseExtendedIDs ? ECUID::ENGINE_ECU_RX_EXTENDED : ECUID::ENGINE_ECU_RX );
     }
-    // The info structure will be appended with the new decoded DTCs
-    if ( !ecuResponse.empty() && mOBDDataDecoder->decodeDTCs( sid, ecuResponse, info ) )
+    else if ( type == ECUType::TRANSMISSION )
     {
-        return true;
+        responseCANId = toUType( mUseExtendedIDs ? ECUID::TRANSMISSION_ECU_RX_EXTENDED : ECUID::TRANSMISSION_ECU_RX );
     }
-
-    return false;
-}
-
-bool
-OBDOverCANModule::requestReceiveDTCs( const SID &sid, ISOTPOverCANSenderReceiver &isoTPSendReceive, DTCInfo &info )
-{
-    // Request and try to receive within the time interval
-    if ( requestDTCs( sid, isoTPSendReceive ) )
+    else
     {
-        // Wait and process the response
-        if ( receiveDTCs( sid, isoTPSendReceive, info ) )
-        {
-            return true;
-        }
+        return false;
     }
-    return false;
-}
 
-bool
-OBDOverCANModule::getPIDsToRequest( const SID &sid, const ECUType &type, SupportedPIDs &supportedPIDs ) const
-{
-    if ( type == ECUType::ENGINE )
+    std::lock_guard<std::mutex> lock( mECUsMutex );
+    for ( const auto &ecu : mECUs )
     {
-        auto pidIterator = mPIDsToRequestEngine.find( sid );
-        if ( pidIterator == mPIDsToRequestEngine.end() )
+        if ( ecu->responseCANId != responseCANId )
         {
-            return false;
+            continue;
         }
-        supportedPIDs = pidIterator->second;
-        return true;
-    }
-    else if ( type == ECUType::TRANSMISSION )
-    {
-        auto pidIterator = mPIDsToRequestTransmission.find( sid );
-        if ( pidIterator == mPIDsToRequestTransmission.end() )
+        auto pidIterator = ecu->pidsToRequest.find( sid );
+        if ( pidIterator == ecu->pidsToRequest.end() )
         {
             return false;
         }
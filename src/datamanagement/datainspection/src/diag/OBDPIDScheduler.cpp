@@ -0,0 +1,112 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+// Includes
+#include "OBDPIDScheduler.h"
+#include <algorithm>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace DataInspection
+{
+
+constexpr Timestamp OBDPIDScheduler::SCHEDULING_TOLERANCE_MS;
+constexpr Timestamp OBDPIDScheduler::NOTHING_SCHEDULED;
+
+std::map<PID, uint32_t>
+OBDPIDScheduler::calculatePIDIntervals( const std::map<PID, std::vector<SignalID>> &pidSignals,
+                                        const std::unordered_map<SignalID, uint32_t> &signalIntervalsMs,
+                                        uint32_t defaultIntervalMs,
+                                        uint32_t minIntervalMs )
+{
+    std::map<PID, uint32_t> pidIntervalsMs;
+    for ( const auto &pid : pidSignals )
+    {
+        uint32_t intervalMs = 0;
+        for ( auto signalID : pid.second )
+        {
+            auto signalInterval = signalIntervalsMs.find( signalID );
+            uint32_t signalIntervalMs =
+                ( signalInterval == signalIntervalsMs.end() || signalInterval->second == 0 ) ? defaultIntervalMs
+                                                                                              : signalInterval->second;
+            intervalMs = ( intervalMs == 0 ) ? signalIntervalMs : std::min( intervalMs, signalIntervalMs );
+        }
+        if ( intervalMs > 0 )
+        {
+            pidIntervalsMs[pid.first] = std::max( intervalMs, minIntervalMs );
+        }
+    }
+    return pidIntervalsMs;
+}
+
+void
+OBDPIDScheduler::setPIDIntervals( const std::map<PID, uint32_t> &pidIntervalsMs, Timestamp now )
+{
+    std::map<PID, ScheduledPID> schedule;
+    for ( const auto &pidInterval : pidIntervalsMs )
+    {
+        if ( pidInterval.second == 0 )
+        {
+            continue;
+        }
+        Timestamp nextDueTime = now;
+        auto previous = mSchedule.find( pidInterval.first );
+        if ( previous != mSchedule.end() )
+        {
+            // Keep the phase of the PID, but do not wait longer than the new interval
+            nextDueTime = std::min( previous->second.nextDueTime, now + pidInterval.second );
+        }
+        schedule.emplace( pidInterval.first, ScheduledPID{ pidInterval.second, nextDueTime } );
+    }
+    mSchedule = std::move( schedule );
+}
+
+std::vector<PID>
+OBDPIDScheduler::getDuePIDs( Timestamp now )
+{
+    std::vector<PID> duePIDs;
+    for ( auto &scheduledPID : mSchedule )
+    {
+        if ( scheduledPID.second.nextDueTime <= now + SCHEDULING_TOLERANCE_MS )
+        {
+            duePIDs.push_back( scheduledPID.first );
+            // Schedule from now instead of from the due time, so that a late cycle does not cause a burst of requests
+            scheduledPID.second.nextDueTime = now + scheduledPID.second.intervalMs;
+        }
+    }
+    return duePIDs;
+}
+
+Timestamp
+OBDPIDScheduler::getNextDueTime() const
+{
+    Timestamp nextDueTime = NOTHING_SCHEDULED;
+    for ( const auto &scheduledPID : mSchedule )
+    {
+        nextDueTime = std::min( nextDueTime, scheduledPID.second.nextDueTime );
+    }
+    return nextDueTime;
+}
+
+uint32_t
+OBDPIDScheduler::getInterval( PID pid ) const
+{
+    auto scheduledPID = mSchedule.find( pid );
+    return scheduledPID == mSchedule.end() ? 0 : scheduledPID->second.intervalMs;
+}
+
+} // namespace DataInspection
+} // namespace IoTFleetWise
+} // namespace Aws
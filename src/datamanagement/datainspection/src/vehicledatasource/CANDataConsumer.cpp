@@ -50,6 +50,7 @@ CANDataConsumer::init( VehicleDataSourceID canChannelID, SignalBufferPtr signalB
                        "Init Network channel consumer with id: " + std::to_string( canChannelID ) );
         mDataSourceID = canChannelID;
         mSignalBufferPtr = signalBufferPtr;
+        mSignalBufferLane = signalBufferPtr->createLane();
     }
     if ( idleTimeMs != 0 )
     {
@@ -72,32 +73,24 @@ CANDataConsumer::resumeDataConsumption( ConstDecoderDictionaryConstPtr &dictiona
 {
     if ( dictionary.get() != nullptr )
     {
+        // Convert the Generic Decoder Dictionary to CAN Decoder Dictionary
+        auto decoderDictPtr = std::dynamic_pointer_cast<const CANDecoderDictionary>( dictionary );
+        if ( decoderDictPtr != nullptr )
         {
-            // As this function can be asynchronously invoked by other module in the middle of
-            // CAN message Decoding, a mutex has to be used to avoid decoding race condition in which
-            // a single CAN message could got decoded by two different formula. This mutex ensure
-            // the shared pointer assignment is atomic
-            std::lock_guard<std::mutex> lock( mDecoderDictMutex );
-            // Convert the Generic Decoder Dictionary to CAN Decoder Dictionary
-            // TODO : This downcast is done three times in this entity. One time when the generic decoder is
-            // provider and another one on every work iteration. As we plan to consolidate all decoding
-            // rules for different data source types in one single decoder instance, this down cast
-            // shall be removed.
-            mDecoderDictionaryConstPtr = std::dynamic_pointer_cast<const CANDecoderDictionary>( dictionary );
-        }
-        if ( mDecoderDictionaryConstPtr != nullptr )
-        {
-            // Decoder dictionary
-            auto decoderDictPtr = std::dynamic_pointer_cast<const CANDecoderDictionary>( mDecoderDictionaryConstPtr );
-            const auto &decoderMethod = decoderDictPtr->canMessageDecoderMethod;
+            // Compile the decoding plan of this channel here, outside of the decoding thread. Once published the
+            // plan is never modified, the decoding thread keeps a reference to the plan it is working with until it
+            // picks up the new one.
+            auto decodePlan = CANChannelDecodePlan::build( *decoderDictPtr, mDataSourceID );
+            {
+                std::lock_guard<std::mutex> lock( mDecoderDictMutex );
+                mDecoderDictionaryConstPtr = decoderDictPtr;
+                mDecodePlan = decodePlan;
+                mDecodePlanGeneration.fetch_add( 1, std::memory_order_release );
+            }
             std::string canIds;
-            // check if this CAN message ID on this CAN Channel has the decoder method and if yes log the number
-            if ( decoderMethod.find( mDataSourceID ) != decoderMethod.cend() )
+            for ( const auto &framePlan : decodePlan->getFrames() )
             {
-                for ( auto &decode : decoderMethod.at( mDataSourceID ) )
-                {
-                    canIds += std::to_string( decode.first ) + ", ";
-                }
+                canIds += std::to_string( framePlan.frameID ) + ", ";
             }
             mLogger.trace( "CANDataConsumer::resumeDataConsumption",
                            " Changing Decoder Dictionary on Consumer :" + std::to_string( mID ) +
@@ -171,14 +164,11 @@ CANDataConsumer::doWork( void *data )
 
     uint32_t activations = 0;
     Timer logTimer;
-
-    // Only used for TRACE log level logging
-    std::array<std::pair<uint32_t, uint32_t>, 8> lastFrameIds{}; // .first=can id, .second=counter
-    uint8_t lastFrameIdPos = 0;
-    uint32_t processedFramesCounter = 0;
     do
     {
         activations++;
+        // Checked once per activation instead of once per frame
+        const bool traceEnabled = LoggingModule::isEnabled( LogLevel::Trace );
         if ( consumer->shouldSleep() )
         {
             // We either just started or there was a decoder manifest update that we can't use.
@@ -190,218 +180,228 @@ CANDataConsumer::doWork( void *data )
             // At this point, we should be able to see events coming as the channel is also
             // woken up.
         }
-        // Below section utilize decoder dictionary to perform CAN message decoding and collection.
-        // Use a Mutex to prevent updating decoder dictionary in the middle of CAN Frame processing.
-        std::shared_ptr<const CANDecoderDictionary> decoderDictPtr;
-        {
-            std::lock_guard<std::mutex> lock( consumer->mDecoderDictMutex );
-            decoderDictPtr =
-                std::dynamic_pointer_cast<const CANDecoderDictionary>( consumer->mDecoderDictionaryConstPtr );
-        }
 
-        // Pop any message from the Input Buffer
-        VehicleDataMessage message;
-        if ( consumer->mInputBufferPtr->pop( message ) )
+        if ( !consumer->consumeFrame( traceEnabled ) )
         {
-            TraceVariable traceQueue = static_cast<TraceVariable>(
-                consumer->mDataSourceID + toUType( TraceVariable::QUEUE_SOCKET_TO_CONSUMER_0 ) );
-            TraceModule::get().setVariable( ( traceQueue < TraceVariable::QUEUE_SOCKET_TO_CONSUMER_MAX )
-                                                ? traceQueue
-                                                : TraceVariable::QUEUE_SOCKET_TO_CONSUMER_MAX,
-                                            consumer->mInputBufferPtr->read_available() + 1 );
-            CANDecodedMessage decodedMessage;
-            decodedMessage.mChannelProtocol = consumer->mDataSourceProtocol;
-            decodedMessage.mChannelType = consumer->mType;
-            decodedMessage.mChannelIfName = consumer->mIfName;
-            decodedMessage.mReceptionTime = message.getReceptionTimestamp();
-            decodedMessage.mFrameInfo.mFrameID = static_cast<uint32_t>( message.getMessageID() );
-            decodedMessage.mFrameInfo.mFrameRawData.assign( message.getRawData().data(),
-                                                            message.getRawData().size() + message.getRawData().data() );
-            // get decoderMethod from the decoder dictionary
-            const auto &decoderMethod = decoderDictPtr->canMessageDecoderMethod;
-            // a set of signalID specifying which signal to collect
-            const auto &signalIDsToCollect = decoderDictPtr->signalIDsToCollect;
-            // check if this CAN message ID on this CAN Channel has the decoder method
-            if ( decoderMethod.find( consumer->mDataSourceID ) != decoderMethod.cend() &&
-                 decoderMethod.at( consumer->mDataSourceID ).find( static_cast<uint32_t>( message.getMessageID() ) ) !=
-                     decoderMethod.at( consumer->mDataSourceID ).cend() )
+            if ( logTimer.getElapsedMs().count() > static_cast<int64_t>( LoggingModule::LOG_AGGREGATION_TIME_MS ) )
             {
-                // format to be used for decoding
-                const auto &format = decoderMethod.at( consumer->mDataSourceID )
-                                         .at( static_cast<uint32_t>( message.getMessageID() ) )
-                                         .format;
-                const auto &collectType = decoderMethod.at( consumer->mDataSourceID )
-                                              .at( static_cast<uint32_t>( message.getMessageID() ) )
-                                              .collectType;
-
-                // Only used for TRACE log level logging
-                if ( collectType == CANMessageCollectType::RAW ||
-                     collectType == CANMessageCollectType::RAW_AND_DECODE ||
-                     collectType == CANMessageCollectType::DECODE )
+                // Nothing is in the ring buffer to consume. Go to idle mode for some time.
+                if ( LoggingModule::isEnabled( LogLevel::Trace ) )
                 {
-                    bool found = false;
-                    for ( auto &p : lastFrameIds )
+                    std::stringstream logMessage;
+                    logMessage << "Channel Id: " << consumer->mDataSourceID
+                               << ". Activations since last print: " << std::to_string( activations )
+                               << ". Number of frames over all processed " << consumer->mProcessedFramesCounter
+                               << ".Last CAN IDs processed:";
+                    for ( auto id : consumer->mLastFrameIds )
                     {
-                        if ( p.first == static_cast<uint32_t>( message.getMessageID() ) )
-                        {
-                            found = true;
-                            p.second++;
-                            break;
-                        }
+                        logMessage << id.first << " (x " << id.second << "), ";
                     }
-                    if ( !found )
-                    {
-                        lastFrameIdPos++;
-                        if ( lastFrameIdPos >= lastFrameIds.size() )
-                        {
-                            lastFrameIdPos = 0;
-                        }
-                        lastFrameIds[lastFrameIdPos] =
-                            std::pair<uint32_t, uint32_t>( static_cast<uint32_t>( message.getMessageID() ), 1 );
-                    }
-                    processedFramesCounter++;
+                    logMessage << ". Waiting for some data to come. Idling for :" +
+                                      std::to_string( consumer->mIdleTime ) + " ms";
+                    consumer->mLogger.trace( "CANDataConsumer::doWork", logMessage.str() );
                 }
+                activations = 0;
+                logTimer.reset();
+            }
+            consumer->mWait.wait( consumer->mIdleTime );
+        }
+    } while ( !consumer->shouldStop() );
+}
+
+void
+CANDataConsumer::consumeAvailableFrames()
+{
+    if ( shouldSleep() || !mConnected.load( std::memory_order_relaxed ) )
+    {
+        return;
+    }
+    const bool traceEnabled = LoggingModule::isEnabled( LogLevel::Trace );
+    while ( consumeFrame( traceEnabled ) )
+    {
+    }
+}
 
-                // Check if we want to collect RAW CAN Frame; If so we also need to ensure Buffer is valid
-                if ( consumer->mCANBufferPtr.get() != nullptr &&
-                     ( collectType == CANMessageCollectType::RAW ||
-                       collectType == CANMessageCollectType::RAW_AND_DECODE ) )
+bool
+CANDataConsumer::consumeFrame( bool traceEnabled )
+{
+    // Pick up a newly published decoding plan. The plan itself is immutable, so only the generation counter
+    // has to be checked per iteration and the mutex is only taken when a new plan was published.
+    auto publishedGeneration = mDecodePlanGeneration.load( std::memory_order_acquire );
+    if ( publishedGeneration != mActiveDecodePlanGeneration )
+    {
+        std::lock_guard<std::mutex> lock( mDecoderDictMutex );
+        mActiveDecodePlan = mDecodePlan;
+        mActiveDecodePlanGeneration = publishedGeneration;
+    }
+
+    // Pop any message from the Input Buffer
+    CANRawFrameMessage message;
+    if ( !mInputBufferPtr->pop( message ) )
+    {
+        return false;
+    }
+    TraceVariable traceQueue =
+        static_cast<TraceVariable>( mDataSourceID + toUType( TraceVariable::QUEUE_SOCKET_TO_CONSUMER_0 ) );
+    TraceModule::get().setVariable( ( traceQueue < TraceVariable::QUEUE_SOCKET_TO_CONSUMER_MAX )
+                                        ? traceQueue
+                                        : TraceVariable::QUEUE_SOCKET_TO_CONSUMER_MAX,
+                                    mInputBufferPtr->read_available() + 1 );
+    TraceModule::get().addLatencyToHistogram(
+        TraceHistogram::CAN_TO_CONSUMER_LATENCY, message.getReceptionTimestamp(), mClock->timeSinceEpochMs() );
+    // check if this CAN message ID on this CAN Channel has a decoding plan
+    const CANFrameDecodePlan *framePlan =
+        ( mActiveDecodePlan != nullptr ) ? mActiveDecodePlan->find( message.getMessageID() ) : nullptr;
+    if ( framePlan != nullptr )
+    {
+        const auto collectType = framePlan->collectType;
+
+        // Only used for TRACE log level logging
+        if ( traceEnabled )
+        {
+            bool found = false;
+            for ( auto &p : mLastFrameIds )
+            {
+                if ( p.first == message.getMessageID() )
                 {
-                    // prepare the raw CAN Frame
-                    struct CollectedCanRawFrame canRawFrame;
-                    canRawFrame.frameID = static_cast<uint32_t>( message.getMessageID() );
-                    canRawFrame.channelId = consumer->mDataSourceID;
-                    canRawFrame.receiveTime = message.getReceptionTimestamp();
-                    // CollectedCanRawFrame only receive 8 CAN Raw Bytes
-                    canRawFrame.size =
-                        std::min( static_cast<uint8_t>( message.getRawData().size() ), MAX_CAN_FRAME_BYTE_SIZE );
-                    std::copy( message.getRawData().begin(),
-                               message.getRawData().begin() + canRawFrame.size,
-                               canRawFrame.data.begin() );
-                    // Push raw CAN Frame to the Buffer for next stage to consume
-                    // Note buffer is lock_free buffer and multiple Vehicle Data Source Instance could push
-                    // data to it.
-                    TraceModule::get().incrementAtomicVariable( TraceAtomicVariable::QUEUE_CONSUMER_TO_INSPECTION_CAN );
-                    if ( !consumer->mCANBufferPtr->push( canRawFrame ) )
-                    {
-                        TraceModule::get().decrementAtomicVariable(
-                            TraceAtomicVariable::QUEUE_CONSUMER_TO_INSPECTION_CAN );
-                        consumer->mLogger.warn( "CANDataConsumer::doWork", "RAW CAN Frame Buffer Full! " );
-                    }
-                    else
-                    {
-                        // Enable below logging for debugging
-                        // consumer->mLogger.trace( "CANDataConsumer::doWork",
-                        //                             "Collect RAW CAN Frame ID: " +
-                        //                                 std::to_string( static_cast<uint32_t>(
-                        //                                 message.getMessageID() ) ) );
-                    }
+                    found = true;
+                    p.second++;
+                    break;
                 }
-                // check if we want to decode can frame into signals and collect signals
-                if ( consumer->mSignalBufferPtr.get() != nullptr &&
-                     ( collectType == CANMessageCollectType::DECODE ||
-                       collectType == CANMessageCollectType::RAW_AND_DECODE ) )
+            }
+            if ( !found )
+            {
+                mLastFrameIdPos++;
+                if ( mLastFrameIdPos >= mLastFrameIds.size() )
+                {
+                    mLastFrameIdPos = 0;
+                }
+                mLastFrameIds[mLastFrameIdPos] = std::pair<uint32_t, uint32_t>( message.getMessageID(), 1 );
+            }
+        }
+        mProcessedFramesCounter++;
+
+        // Check if we want to collect RAW CAN Frame; If so we also need to ensure Buffer is valid
+        if ( mCANBufferPtr.get() != nullptr &&
+             ( collectType == CANMessageCollectType::RAW ||
+               collectType == CANMessageCollectType::RAW_AND_DECODE ) )
+        {
+            // prepare the raw CAN Frame
+            struct CollectedCanRawFrame canRawFrame;
+            canRawFrame.frameID = message.getMessageID();
+            canRawFrame.channelId = mDataSourceID;
+            canRawFrame.receiveTime = message.getReceptionTimestamp();
+            // CollectedCanRawFrame holds up to the 64 bytes of a CAN FD frame
+            canRawFrame.size = std::min( message.getSize(), MAX_CAN_FRAME_BYTE_SIZE );
+            std::copy( message.getData(), message.getData() + canRawFrame.size, canRawFrame.data.begin() );
+            // Push raw CAN Frame to the Buffer for next stage to consume
+            // Note buffer is lock_free buffer and multiple Vehicle Data Source Instance could push
+            // data to it.
+            TraceModule::get().incrementAtomicVariable( TraceAtomicVariable::QUEUE_CONSUMER_TO_INSPECTION_CAN );
+            if ( !mCANBufferPtr->push( canRawFrame ) )
+            {
+                TraceModule::get().decrementAtomicVariable( TraceAtomicVariable::QUEUE_CONSUMER_TO_INSPECTION_CAN );
+                mDroppedFrames.add( canRawFrame.frameID );
+            }
+        }
+        // check if we want to decode can frame into signals and collect signals
+        if ( mSignalBufferPtr.get() != nullptr &&
+             ( collectType == CANMessageCollectType::DECODE ||
+               collectType == CANMessageCollectType::RAW_AND_DECODE ) )
+        {
+            if ( framePlan->isFormatValid )
+            {
+                mDecodedMessage.mReceptionTime = message.getReceptionTimestamp();
+                mDecodedMessage.mFrameInfo.mFrameID = message.getMessageID();
+                mDecodedMessage.mFrameInfo.mFrameRawData.assign( message.getData(),
+                                                                 message.getData() + message.getSize() );
+                mDecodedMessage.mFrameInfo.mSignals.clear();
+                if ( mCANDecoder->decodeCANMessage(
+                         message.getData(), message.getSize(), *framePlan, mDecodedMessage ) )
                 {
-                    if ( format.isValid() )
+                    mCollectedSignals.clear();
+                    auto fillPercent = mSignalBufferLane->fillPercent();
+                    for ( auto const &signal : mDecodedMessage.mFrameInfo.mSignals )
                     {
-                        if ( consumer->mCANDecoder->decodeCANMessage( message.getRawData().data(),
-                                                                      message.getRawData().size(),
-                                                                      format,
-                                                                      signalIDsToCollect,
-                                                                      decodedMessage ) )
-                        {
-                            for ( auto const &signal : decodedMessage.mFrameInfo.mSignals )
-                            {
-                                // Create Collected Signal Object
-                                struct CollectedSignal collectedSignal(
-                                    signal.mSignalID, decodedMessage.mReceptionTime, signal.mPhysicalValue );
-                                // Push collected signal to the Signal Buffer
-                                TraceModule::get().incrementAtomicVariable(
-                                    TraceAtomicVariable::QUEUE_CONSUMER_TO_INSPECTION_SIGNALS );
-                                if ( !consumer->mSignalBufferPtr->push( collectedSignal ) )
-                                {
-                                    TraceModule::get().decrementAtomicVariable(
-                                        TraceAtomicVariable::QUEUE_CONSUMER_TO_INSPECTION_SIGNALS );
-                                    consumer->mLogger.warn( "CANDataConsumer::doWork", "Signal Buffer Full! " );
-                                }
-                                else
-                                {
-                                    // Enable below logging for debugging
-                                    // consumer->mLogger.trace( "CANDataConsumer::doWork",
-                                    //                             "Acquire Signal ID: " +
-                                    //                                 std::to_string( signal.mSignalID )
-                                    //                                 );
-                                }
-                            }
-                        }
-                        else
+                        if ( !mSignalLoadShedder.shouldPush(
+                                 signal.mSignalID, fillPercent, mActiveDecodePlan->getHighPrioritySignalIDs() ) )
                         {
-                            // The decoding was not fully successful
-                            consumer->mLogger.warn(
-                                "CANDataConsumer::doWork",
-                                "CAN Frame " + std::to_string( static_cast<uint32_t>( message.getMessageID() ) ) +
-                                    " decoding failed! " );
+                            mShedSignals.add( signal.mSignalID );
+                            continue;
                         }
+                        // Create Collected Signal Object
+                        mCollectedSignals.emplace_back(
+                            signal.mSignalID, mDecodedMessage.mReceptionTime, signal.mPhysicalValue );
                     }
-                    else
+                    // Push all signals of the frame to the own lane of the Signal Buffer at once
+                    auto pushed = mSignalBufferLane->push( mCollectedSignals.data(), mCollectedSignals.size() );
+                    for ( auto i = pushed; i < mCollectedSignals.size(); i++ )
                     {
-                        // The CAN Message format is not valid, report as warning
-                        consumer->mLogger.warn(
-                            "CANDataConsumer::doWork",
-                            "CANMessageFormat Invalid for format message id: " + std::to_string( format.mMessageID ) +
-                                " can message id: " +
-                                std::to_string( static_cast<uint32_t>( message.getMessageID() ) ) +
-                                " on CAN Channel Id: " + std::to_string( consumer->mDataSourceID ) );
+                        mDroppedSignals.add( mCollectedSignals[i].signalID );
                     }
                 }
-            }
-        }
-        else
-        {
-            if ( logTimer.getElapsedMs().count() > static_cast<int64_t>( LoggingModule::LOG_AGGREGATION_TIME_MS ) )
-            {
-                // Nothing is in the ring buffer to consume. Go to idle mode for some time.
-                std::stringstream logMessage;
-                logMessage << "Channel Id: " << consumer->mDataSourceID
-                           << ". Activations since last print: " << std::to_string( activations )
-                           << ". Number of frames over all processed " << processedFramesCounter
-                           << ".Last CAN IDs processed:";
-                for ( auto id : lastFrameIds )
+                else
                 {
-                    logMessage << id.first << " (x " << id.second << "), ";
+                    // The decoding was not fully successful
+                    mLogger.warn( "CANDataConsumer::consumeFrame",
+                                  "CAN Frame " + std::to_string( message.getMessageID() ) + " decoding failed! " );
                 }
-                logMessage << ". Waiting for some data to come. Idling for :" + std::to_string( consumer->mIdleTime ) +
-                                  " ms";
-                consumer->mLogger.trace( "CANDataConsumer::doWork", logMessage.str() );
-                activations = 0;
-                logTimer.reset();
             }
-            consumer->mWait.wait( consumer->mIdleTime );
+            else
+            {
+                // The CAN Message format is not valid, report as warning
+                mLogger.warn( "CANDataConsumer::consumeFrame",
+                              "CANMessageFormat Invalid for format message id: " +
+                                  std::to_string( framePlan->formatMessageID ) +
+                                  " can message id: " + std::to_string( message.getMessageID() ) +
+                                  " on CAN Channel Id: " + std::to_string( mDataSourceID ) );
+            }
         }
-    } while ( !consumer->shouldStop() );
+        mShedSignals.logIfDue();
+        mDroppedSignals.logIfDue();
+        mDroppedFrames.logIfDue();
+    }
+    return true;
 }
 
 bool
 CANDataConsumer::connect()
 {
-    if ( mInputBufferPtr.get() != nullptr && mSignalBufferPtr.get() != nullptr && mCANBufferPtr.get() != nullptr &&
-         start() )
+    if ( mInputBufferPtr.get() == nullptr || mSignalBufferPtr.get() == nullptr || mCANBufferPtr.get() == nullptr )
+    {
+        return false;
+    }
+    mDecodedMessage.mChannelProtocol = mDataSourceProtocol;
+    mDecodedMessage.mChannelType = mType;
+    mDecodedMessage.mChannelIfName = mIfName;
+    if ( mConsumeInReceivingThread )
     {
+        // Like the own thread, frames are only consumed after the consumption is resumed
+        mShouldSleep.store( true );
+        mConnected.store( true );
         return true;
     }
-
-    return false;
+    return start();
 }
 
 bool
 CANDataConsumer::disconnect()
 {
+    if ( mConsumeInReceivingThread )
+    {
+        mConnected.store( false );
+        return true;
+    }
     return stop();
 }
 
 bool
 CANDataConsumer::isAlive()
 {
+    if ( mConsumeInReceivingThread )
+    {
+        return mConnected.load();
+    }
     return mThread.isValid() && mThread.isActive();
 }
 
@@ -13,6 +13,7 @@
 
 // Includes
 #include "VehicleDataSourceBinder.h"
+#include <vector>
 
 namespace Aws
 {
@@ -467,6 +468,8 @@ VehicleDataSourceBinder::onChangeOfActiveDictionary( ConstDecoderDictionaryConst
     std::lock_guard<std::mutex> lockConsumer( mConsumersMutex );
     if ( dictionary.get() != nullptr )
     {
+        // Only the frames of a CAN decoder dictionary are known, all other sources are not filtered
+        auto canDictionary = std::dynamic_pointer_cast<const CANDecoderDictionary>( dictionary );
 
         std::for_each( mDataSourcesToConsumers.begin(),
                        mDataSourcesToConsumers.end(),
@@ -485,6 +488,22 @@ VehicleDataSourceBinder::onChangeOfActiveDictionary( ConstDecoderDictionaryConst
                        [&]( const std::pair<VehicleDataSourceID, VehicleDataSourcePtr> &source ) {
                            if ( networkProtocol == source.second->getVehicleDataSourceProtocol() )
                            {
+                               auto consumer = mDataSourcesToConsumers.find( source.first );
+                               if ( ( canDictionary != nullptr ) && ( consumer != mDataSourcesToConsumers.end() ) )
+                               {
+                                   // Let the source drop all frames that the consumer would not decode or collect
+                                   std::vector<uint32_t> frameIds;
+                                   auto channel =
+                                       canDictionary->canMessageDecoderMethod.find( consumer->second->getChannelID() );
+                                   if ( channel != canDictionary->canMessageDecoderMethod.end() )
+                                   {
+                                       for ( const auto &frame : channel->second )
+                                       {
+                                           frameIds.push_back( frame.first );
+                                       }
+                                   }
+                                   source.second->setFrameFilter( frameIds );
+                               }
                                source.second->resumeDataAcquisition();
                                mLogger.trace( "VehicleDataSourceBinder::onChangeOfActiveDictionary",
                                               "Resuming Consumption on Data source : " +
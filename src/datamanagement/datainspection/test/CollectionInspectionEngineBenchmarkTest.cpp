@@ -0,0 +1,143 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include "CollectionInspectionEngine.h"
+#include <benchmark/benchmark.h>
+
+using namespace Aws::IoTFleetWise::DataInspection;
+using namespace Aws::IoTFleetWise::DataManagement;
+
+static constexpr uint32_t NUMBER_OF_CONDITIONS = 200;
+static constexpr uint32_t NUMBER_OF_SIGNALS = 20;
+
+/**
+ * @brief Inspection matrix with NUMBER_OF_CONDITIONS conditions which never trigger, so all of them are
+ * evaluated again as soon as one of their signals changes. Every condition looks like:
+ * ( signalA > threshold && signalB * 2 < threshold ) || LAST_FIXED_WINDOW_AVG( signalA ) - signalB > threshold
+ */
+class BenchmarkInspectionMatrix
+{
+public:
+    BenchmarkInspectionMatrix()
+    {
+        auto matrix = std::make_shared<InspectionMatrix>();
+        matrix->conditions.resize( NUMBER_OF_CONDITIONS );
+        for ( uint32_t i = 0; i < NUMBER_OF_CONDITIONS; i++ )
+        {
+            SignalID signalA = i % NUMBER_OF_SIGNALS;
+            SignalID signalB = ( i + 1 ) % NUMBER_OF_SIGNALS;
+            auto &condition = matrix->conditions[i];
+            condition.probabilityToSend = 1.0;
+            condition.minimumPublishInterval = 0;
+            for ( auto id : { signalA, signalB } )
+            {
+                InspectionMatrixSignalCollectionInfo signal{};
+                signal.signalID = id;
+                signal.sampleBufferSize = 10;
+                signal.minimumSampleIntervalMs = 0;
+                signal.fixedWindowPeriod = 1000;
+                condition.signals.push_back( signal );
+            }
+            auto threshold = static_cast<double>( 1000 + i );
+            auto bigger = binary( ExpressionNodeType::OPERATOR_BIGGER, signal( signalA ), value( threshold ) );
+            auto multiply =
+                binary( ExpressionNodeType::OPERATOR_ARITHMETIC_MULTIPLY, signal( signalB ), value( 2.0 ) );
+            auto smaller = binary( ExpressionNodeType::OPERATOR_SMALLER, multiply, value( -threshold ) );
+            auto leftAnd = binary( ExpressionNodeType::OPERATOR_LOGICAL_AND, bigger, smaller );
+            auto minus = binary( ExpressionNodeType::OPERATOR_ARITHMETIC_MINUS, window( signalA ), signal( signalB ) );
+            auto right = binary( ExpressionNodeType::OPERATOR_BIGGER, minus, value( threshold ) );
+            condition.condition = binary( ExpressionNodeType::OPERATOR_LOGICAL_OR, leftAnd, right );
+        }
+        mMatrix = matrix;
+    }
+
+    std::shared_ptr<const InspectionMatrix> mMatrix;
+
+private:
+    ExpressionNode *
+    newNode( ExpressionNodeType type )
+    {
+        mNodes.push_back( std::make_shared<ExpressionNode>() );
+        mNodes.back()->nodeType = type;
+        return mNodes.back().get();
+    }
+    ExpressionNode *
+    binary( ExpressionNodeType type, ExpressionNode *left, ExpressionNode *right )
+    {
+        auto node = newNode( type );
+        node->left = left;
+        node->right = right;
+        return node;
+    }
+    ExpressionNode *
+    signal( SignalID id )
+    {
+        auto node = newNode( ExpressionNodeType::SIGNAL );
+        node->signalID = id;
+        return node;
+    }
+    ExpressionNode *
+    window( SignalID id )
+    {
+        auto node = newNode( ExpressionNodeType::WINDOWFUNCTION );
+        node->signalID = id;
+        node->function.windowFunction = WindowFunction::LAST_FIXED_WINDOW_AVG;
+        return node;
+    }
+    ExpressionNode *
+    value( double floatingValue )
+    {
+        auto node = newNode( ExpressionNodeType::FLOAT );
+        node->floatingValue = floatingValue;
+        return node;
+    }
+
+    std::vector<std::shared_ptr<ExpressionNode>> mNodes;
+};
+
+static void
+evaluateConditions( benchmark::State &state, bool useRecursiveEvaluation )
+{
+    BenchmarkInspectionMatrix matrix;
+    CollectionInspectionEngine engine;
+    engine.setUseRecursiveEvaluation( useRecursiveEvaluation );
+    engine.onChangeInspectionMatrix( matrix.mMatrix );
+    uint64_t timestamp = 160000000;
+    for ( auto _ : state )
+    {
+        // A new value for every signal, so all conditions have to be evaluated
+        for ( SignalID id = 0; id < NUMBER_OF_SIGNALS; id++ )
+        {
+            engine.addNewSignal( id, timestamp, static_cast<double>( id ) );
+        }
+        benchmark::DoNotOptimize( engine.evaluateConditions( timestamp ) );
+        timestamp++;
+    }
+    state.SetItemsProcessed( static_cast<int64_t>( state.iterations() * NUMBER_OF_CONDITIONS ) );
+}
+
+static void
+BM_evaluateConditionsRecursive( benchmark::State &state )
+{
+    evaluateConditions( state, true );
+}
+BENCHMARK( BM_evaluateConditionsRecursive );
+
+static void
+BM_evaluateConditionsBytecode( benchmark::State &state )
+{
+    evaluateConditions( state, false );
+}
+BENCHMARK( BM_evaluateConditionsBytecode );
+
+BENCHMARK_MAIN();
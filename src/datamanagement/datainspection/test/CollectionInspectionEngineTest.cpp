@@ -262,6 +262,67 @@ protected:
         return smallerEqual1;
     }
 
+    /**
+     * @brief Builds a random expression tree out of all node types except geohash. Trees can be deeper than
+     * MAX_EQUATION_DEPTH and can contain missing operands.
+     */
+    ExpressionNode *
+    getRandomCondition( std::mt19937 &gen, const std::vector<SignalID> &signalIDs, uint32_t depth )
+    {
+        static const std::vector<ExpressionNodeType> operators = { ExpressionNodeType::OPERATOR_SMALLER,
+                                                                   ExpressionNodeType::OPERATOR_BIGGER,
+                                                                   ExpressionNodeType::OPERATOR_SMALLER_EQUAL,
+                                                                   ExpressionNodeType::OPERATOR_BIGGER_EQUAL,
+                                                                   ExpressionNodeType::OPERATOR_EQUAL,
+                                                                   ExpressionNodeType::OPERATOR_LOGICAL_AND,
+                                                                   ExpressionNodeType::OPERATOR_LOGICAL_OR,
+                                                                   ExpressionNodeType::OPERATOR_LOGICAL_NOT,
+                                                                   ExpressionNodeType::OPERATOR_ARITHMETIC_PLUS,
+                                                                   ExpressionNodeType::OPERATOR_ARITHMETIC_MINUS,
+                                                                   ExpressionNodeType::OPERATOR_ARITHMETIC_MULTIPLY,
+                                                                   ExpressionNodeType::OPERATOR_ARITHMETIC_DIVIDE };
+        std::uniform_int_distribution<uint32_t> percent( 0, 99 );
+        if ( percent( gen ) < 2 )
+        {
+            return nullptr;
+        }
+        expressionNodes.push_back( std::make_shared<ExpressionNode>() );
+        auto node = expressionNodes.back();
+        if ( depth == 0 || percent( gen ) < 30 )
+        {
+            switch ( percent( gen ) % 4 )
+            {
+            case 0:
+                node->nodeType = ExpressionNodeType::FLOAT;
+                node->floatingValue = static_cast<double>( percent( gen ) ) / 10.0;
+                break;
+            case 1:
+                node->nodeType = ExpressionNodeType::BOOLEAN;
+                node->booleanValue = percent( gen ) < 50;
+                break;
+            case 2:
+                node->nodeType = ExpressionNodeType::SIGNAL;
+                // Sometimes use a signal not collected by the condition
+                node->signalID = percent( gen ) < 5 ? 9999 : signalIDs[percent( gen ) % signalIDs.size()];
+                break;
+            default:
+                node->nodeType = ExpressionNodeType::WINDOWFUNCTION;
+                node->signalID = signalIDs[percent( gen ) % signalIDs.size()];
+                node->function.windowFunction = static_cast<WindowFunction>( percent( gen ) % 7 );
+                break;
+            }
+            return node.get();
+        }
+        node->nodeType = operators[percent( gen ) % operators.size()];
+        if ( percent( gen ) < 1 )
+        {
+            node->nodeType = static_cast<ExpressionNodeType>( -1 );
+        }
+        node->left = getRandomCondition( gen, signalIDs, depth - 1 );
+        node->right = getRandomCondition( gen, signalIDs, depth - 1 );
+        return node.get();
+    }
+
     std::shared_ptr<ExpressionNode>
     getLastAvgWindowBiggerCondition( SignalID id1, double threshold1 )
     {
@@ -420,7 +481,84 @@ TEST_F( CollectionInspectionEngineTest, TooBigForSignalBufferOverflow )
     ASSERT_EQ( collectedData->signals.size(), 0 );
 }
 
-TEST_F( CollectionInspectionEngineTest, SignalBufferErasedAfterNewConditions )
+TEST_F( CollectionInspectionEngineTest, TooBigForSignalBufferOtherSignalsStillCollected )
+{
+    CollectionInspectionEngine engine;
+    InspectionMatrixSignalCollectionInfo s1{};
+    s1.signalID = 1;
+    s1.sampleBufferSize = 50;
+    s1.minimumSampleIntervalMs = 0;
+    s1.fixedWindowPeriod = 77777;
+    addSignalToCollect( collectionSchemes->conditions[0], s1 );
+    InspectionMatrixSignalCollectionInfo s2 = s1;
+    s2.signalID = 2;
+    s2.sampleBufferSize =
+        500000000; // this number of samples should exceed the maximum buffer size defined in MAX_SAMPLE_MEMORY
+    addSignalToCollect( collectionSchemes->conditions[0], s2 );
+    InspectionMatrixSignalCollectionInfo s3 = s1;
+    s3.signalID = 3;
+    addSignalToCollect( collectionSchemes->conditions[0], s3 );
+    collectionSchemes->conditions[0].condition = getAlwaysTrueCondition().get();
+    engine.onChangeInspectionMatrix( consCollectionSchemes );
+
+    uint64_t timestamp = 160000000;
+    engine.addNewSignal( s1.signalID, timestamp, 0.1 );
+    engine.addNewSignal( s2.signalID, timestamp, 0.2 );
+    engine.addNewSignal( s3.signalID, timestamp, 0.3 );
+
+    engine.evaluateConditions( timestamp );
+
+    uint32_t waitTimeMs = 0;
+    auto collectedData = engine.collectNextDataToSend( timestamp, waitTimeMs );
+    ASSERT_NE( collectedData, nullptr );
+    ASSERT_EQ( collectedData->signals.size(), 2 );
+    EXPECT_EQ( collectedData->signals[0].signalID, s1.signalID );
+    EXPECT_EQ( collectedData->signals[1].signalID, s3.signalID );
+}
+
+TEST_F( CollectionInspectionEngineTest, SparseSignalIDs )
+{
+    CollectionInspectionEngine engine;
+    // Signal IDs can be spread across the whole 32 bit range
+    std::vector<SignalID> signalIDs = { 0xFFFFFF00, 5, 70000, 0 };
+    for ( auto id : signalIDs )
+    {
+        InspectionMatrixSignalCollectionInfo s{};
+        s.signalID = id;
+        s.sampleBufferSize = 10;
+        s.minimumSampleIntervalMs = 0;
+        s.fixedWindowPeriod = 77777;
+        addSignalToCollect( collectionSchemes->conditions[0], s );
+        // Same signal with a different sample interval
+        s.minimumSampleIntervalMs = 100;
+        addSignalToCollect( collectionSchemes->conditions[1], s );
+    }
+    collectionSchemes->conditions[0].condition = getAlwaysTrueCondition().get();
+    engine.onChangeInspectionMatrix( consCollectionSchemes );
+
+    uint64_t timestamp = 160000000;
+    for ( auto id : signalIDs )
+    {
+        engine.addNewSignal( id, timestamp, static_cast<double>( id ) );
+    }
+    // Not collected by any condition
+    engine.addNewSignal( 6, timestamp, 6.0 );
+    engine.addNewSignal( 0xFFFFFFFE, timestamp, 7.0 );
+
+    engine.evaluateConditions( timestamp );
+
+    uint32_t waitTimeMs = 0;
+    auto collectedData = engine.collectNextDataToSend( timestamp, waitTimeMs );
+    ASSERT_NE( collectedData, nullptr );
+    ASSERT_EQ( collectedData->signals.size(), signalIDs.size() );
+    for ( size_t i = 0; i < signalIDs.size(); i++ )
+    {
+        EXPECT_EQ( collectedData->signals[i].signalID, signalIDs[i] );
+        EXPECT_EQ( collectedData->signals[i].value, static_cast<double>( signalIDs[i] ) );
+    }
+}
+
+TEST_F( CollectionInspectionEngineTest, SignalBufferKeptAfterNewConditions )
 {
     CollectionInspectionEngine engine;
     // minimumSampleIntervalMs=0 means no subsampling
@@ -439,8 +577,7 @@ TEST_F( CollectionInspectionEngineTest, SignalBufferErasedAfterNewConditions )
     engine.addNewSignal( s1.signalID, timestamp + 1, 0.2 );
     engine.addNewSignal( s1.signalID, timestamp + 2, 0.3 );
 
-    // This call will flush the signal history buffer even when
-    // exactly the same conditions are handed over.
+    // The signal history buffer is kept when the same conditions are handed over again
     engine.onChangeInspectionMatrix( consCollectionSchemes );
 
     engine.addNewSignal( s1.signalID, timestamp + 3, 0.4 );
@@ -450,9 +587,225 @@ TEST_F( CollectionInspectionEngineTest, SignalBufferErasedAfterNewConditions )
     uint32_t waitTimeMs = 0;
     auto collectedData = engine.collectNextDataToSend( timestamp + 3, waitTimeMs );
     ASSERT_NE( collectedData, nullptr );
-    ASSERT_EQ( collectedData->signals.size(), 1 );
+    ASSERT_EQ( collectedData->signals.size(), 4 );
 
     EXPECT_EQ( collectedData->signals[0].value, 0.4 );
+    EXPECT_EQ( collectedData->signals[3].value, 0.1 );
+}
+
+TEST_F( CollectionInspectionEngineTest, CollectedDataKeptWhenCollectionSchemeAdded )
+{
+    CollectionInspectionEngine engine;
+    InspectionMatrixSignalCollectionInfo s1{};
+    s1.signalID = 1;
+    s1.sampleBufferSize = 10;
+    collectionSchemes->conditions.resize( 1 );
+    collectionSchemes->conditions[0].metaData.collectionSchemeID = "A";
+    collectionSchemes->conditions[0].condition = getAlwaysTrueCondition().get();
+    addSignalToCollect( collectionSchemes->conditions[0], s1 );
+    engine.onChangeInspectionMatrix( consCollectionSchemes );
+
+    uint64_t timestamp = 160000000;
+    engine.addNewSignal( s1.signalID, timestamp, 1.0 );
+    engine.addNewSignal( s1.signalID, timestamp + 1, 2.0 );
+    engine.evaluateConditions( timestamp + 1 );
+    uint32_t waitTimeMs = 0;
+    auto collectedData = engine.collectNextDataToSend( timestamp + 1, waitTimeMs );
+    ASSERT_NE( collectedData, nullptr );
+    ASSERT_EQ( collectedData->signals.size(), 2 );
+    engine.addNewSignal( s1.signalID, timestamp + 2, 3.0 );
+    engine.addNewSignal( s1.signalID, timestamp + 3, 4.0 );
+
+    // The new collection scheme needs a bigger buffer for the same signal, so the samples are copied
+    auto newMatrix = std::make_shared<InspectionMatrix>( *collectionSchemes );
+    newMatrix->conditions.emplace_back();
+    newMatrix->conditions[1].metaData.collectionSchemeID = "B";
+    newMatrix->conditions[1].condition = getAlwaysFalseCondition().get();
+    InspectionMatrixSignalCollectionInfo s2 = s1;
+    s2.sampleBufferSize = 20;
+    addSignalToCollect( newMatrix->conditions[1], s2 );
+    engine.onChangeInspectionMatrix( newMatrix );
+
+    engine.addNewSignal( s1.signalID, timestamp + 4, 5.0 );
+    engine.evaluateConditions( timestamp + 4 );
+    collectedData = engine.collectNextDataToSend( timestamp + 4, waitTimeMs );
+    ASSERT_NE( collectedData, nullptr );
+    // Only the samples not yet sent out by the condition are collected
+    ASSERT_EQ( collectedData->signals.size(), 3 );
+    EXPECT_EQ( collectedData->signals[0].value, 5.0 );
+    EXPECT_EQ( collectedData->signals[1].value, 4.0 );
+    EXPECT_EQ( collectedData->signals[2].value, 3.0 );
+}
+
+TEST_F( CollectionInspectionEngineTest, TriggeredConditionKeptWhenOtherCollectionSchemeRemoved )
+{
+    CollectionInspectionEngine engine;
+    InspectionMatrixSignalCollectionInfo s1{};
+    s1.signalID = 1;
+    s1.sampleBufferSize = 10;
+    InspectionMatrixSignalCollectionInfo s2{};
+    s2.signalID = 2;
+    s2.sampleBufferSize = 10;
+    collectionSchemes->conditions[0].metaData.collectionSchemeID = "A";
+    collectionSchemes->conditions[0].condition = getAlwaysFalseCondition().get();
+    addSignalToCollect( collectionSchemes->conditions[0], s2 );
+    collectionSchemes->conditions[1].metaData.collectionSchemeID = "B";
+    collectionSchemes->conditions[1].condition = getAlwaysTrueCondition().get();
+    collectionSchemes->conditions[1].afterDuration = 100;
+    addSignalToCollect( collectionSchemes->conditions[1], s1 );
+    engine.onChangeInspectionMatrix( consCollectionSchemes );
+
+    uint64_t timestamp = 160000000;
+    engine.addNewSignal( s1.signalID, timestamp, 1.0 );
+    engine.addNewSignal( s2.signalID, timestamp, 2.0 );
+    engine.evaluateConditions( timestamp );
+    uint32_t waitTimeMs = 0;
+    ASSERT_EQ( engine.collectNextDataToSend( timestamp, waitTimeMs ), nullptr );
+
+    // Collection scheme A is removed while B waits for its after duration
+    auto newMatrix = std::make_shared<InspectionMatrix>();
+    newMatrix->conditions.emplace_back( collectionSchemes->conditions[1] );
+    engine.onChangeInspectionMatrix( newMatrix );
+
+    engine.addNewSignal( s1.signalID, timestamp + 50, 3.0 );
+    auto collectedData = engine.collectNextDataToSend( timestamp + 100, waitTimeMs );
+    ASSERT_NE( collectedData, nullptr );
+    EXPECT_EQ( collectedData->triggerTime, timestamp );
+    ASSERT_EQ( collectedData->signals.size(), 2 );
+    EXPECT_EQ( collectedData->signals[0].value, 3.0 );
+    EXPECT_EQ( collectedData->signals[1].value, 1.0 );
+}
+
+TEST_F( CollectionInspectionEngineTest, WindowFunctionKeptWhenCollectionSchemeAdded )
+{
+    CollectionInspectionEngine engine;
+    InspectionMatrixSignalCollectionInfo s1{};
+    s1.signalID = 1234;
+    s1.sampleBufferSize = 50;
+    s1.fixedWindowPeriod = 1000;
+    collectionSchemes->conditions.resize( 1 );
+    collectionSchemes->conditions[0].metaData.collectionSchemeID = "A";
+    addSignalToCollect( collectionSchemes->conditions[0], s1 );
+    // function is: LAST_FIXED_WINDOW_AVG(SignalID(1234)) > -50.0
+    collectionSchemes->conditions[0].condition = getLastAvgWindowBiggerCondition( s1.signalID, -50.0 ).get();
+    engine.onChangeInspectionMatrix( consCollectionSchemes );
+
+    uint64_t timestamp = 160000000;
+    uint32_t waitTimeMs = 0;
+    for ( uint32_t i = 0; i < s1.fixedWindowPeriod; i += 10 )
+    {
+        engine.addNewSignal( s1.signalID, timestamp + i, 0.0 );
+        engine.evaluateConditions( timestamp + i );
+        ASSERT_EQ( engine.collectNextDataToSend( timestamp + i, waitTimeMs ), nullptr );
+    }
+
+    auto newMatrix = std::make_shared<InspectionMatrix>( *collectionSchemes );
+    newMatrix->conditions.emplace_back();
+    newMatrix->conditions[1].metaData.collectionSchemeID = "B";
+    newMatrix->conditions[1].condition = getAlwaysFalseCondition().get();
+    InspectionMatrixSignalCollectionInfo s2{};
+    s2.signalID = 5678;
+    s2.sampleBufferSize = 10;
+    addSignalToCollect( newMatrix->conditions[1], s2 );
+    engine.onChangeInspectionMatrix( newMatrix );
+
+    // The first window is complete without waiting for another window after the change
+    engine.addNewSignal( s1.signalID, timestamp + s1.fixedWindowPeriod, 0.0 );
+    engine.evaluateConditions( timestamp + s1.fixedWindowPeriod );
+    ASSERT_NE( engine.collectNextDataToSend( timestamp + s1.fixedWindowPeriod, waitTimeMs ), nullptr );
+}
+
+TEST_F( CollectionInspectionEngineTest, CanFramesKeptWhenCollectionSchemeChanged )
+{
+    CollectionInspectionEngine engine;
+    InspectionMatrixCanFrameCollectionInfo c1;
+    c1.frameID = 0x380;
+    c1.channelID = 3;
+    c1.sampleBufferSize = 10;
+    c1.minimumSampleIntervalMs = 0;
+    collectionSchemes->conditions.resize( 1 );
+    collectionSchemes->conditions[0].metaData.collectionSchemeID = "A";
+    collectionSchemes->conditions[0].canFrames.push_back( c1 );
+    collectionSchemes->conditions[0].condition = getAlwaysTrueCondition().get();
+    engine.onChangeInspectionMatrix( consCollectionSchemes );
+
+    uint64_t timestamp = 160000000;
+    std::array<uint8_t, MAX_CAN_FRAME_BYTE_SIZE> classicFrame = { 0xDE, 0xAD, 0xBE, 0xEF };
+    std::array<uint8_t, MAX_CAN_FRAME_BYTE_SIZE> fdFrame{};
+    for ( size_t i = 0; i < fdFrame.size(); i++ )
+    {
+        fdFrame[i] = static_cast<uint8_t>( i );
+    }
+    engine.addNewRawCanFrame( c1.frameID, c1.channelID, timestamp, classicFrame, 4 );
+    engine.addNewRawCanFrame( c1.frameID, c1.channelID, timestamp + 1, fdFrame, MAX_CAN_FRAME_BYTE_SIZE );
+
+    // The buffer of the frame is resized, so the frames including the CAN FD payload are copied
+    auto newMatrix = std::make_shared<InspectionMatrix>( *collectionSchemes );
+    newMatrix->conditions.emplace_back();
+    newMatrix->conditions[1].metaData.collectionSchemeID = "B";
+    newMatrix->conditions[1].condition = getAlwaysFalseCondition().get();
+    InspectionMatrixCanFrameCollectionInfo c2 = c1;
+    c2.sampleBufferSize = 20;
+    newMatrix->conditions[1].canFrames.push_back( c2 );
+    engine.onChangeInspectionMatrix( newMatrix );
+
+    engine.evaluateConditions( timestamp + 2 );
+    uint32_t waitTimeMs = 0;
+    auto collectedData = engine.collectNextDataToSend( timestamp + 2, waitTimeMs );
+    ASSERT_NE( collectedData, nullptr );
+    ASSERT_EQ( collectedData->canFrames.size(), 2 );
+    EXPECT_EQ( collectedData->canFrames[0].size, MAX_CAN_FRAME_BYTE_SIZE );
+    EXPECT_EQ( collectedData->canFrames[0].data, fdFrame );
+    EXPECT_EQ( collectedData->canFrames[1].size, 4 );
+    EXPECT_TRUE( 0 == std::memcmp( collectedData->canFrames[1].data.data(), classicFrame.data(), 4 ) );
+}
+
+TEST_F( CollectionInspectionEngineTest, SamplesKeptWhileCollectionSchemesAreAddedAndRemoved )
+{
+    CollectionInspectionEngine engine;
+    InspectionMatrixSignalCollectionInfo s1{};
+    s1.signalID = 1;
+    s1.sampleBufferSize = 100;
+    collectionSchemes->conditions.resize( 1 );
+    collectionSchemes->conditions[0].metaData.collectionSchemeID = "A";
+    collectionSchemes->conditions[0].condition = getAlwaysFalseCondition().get();
+    addSignalToCollect( collectionSchemes->conditions[0], s1 );
+    engine.onChangeInspectionMatrix( consCollectionSchemes );
+
+    // Other collection schemes with buffers of different sizes come and go, which leaves unused memory behind
+    // until the ringbuffers are moved to a new arena
+    uint64_t timestamp = 160000000;
+    const uint32_t changes = 30;
+    for ( uint32_t i = 0; i < changes; i++ )
+    {
+        engine.addNewSignal( s1.signalID, timestamp + i, static_cast<double>( i ) );
+        auto newMatrix = std::make_shared<InspectionMatrix>( *collectionSchemes );
+        for ( uint32_t j = 0; j < i % 4; j++ )
+        {
+            newMatrix->conditions.emplace_back();
+            newMatrix->conditions.back().metaData.collectionSchemeID =
+                "B" + std::to_string( i ) + "_" + std::to_string( j );
+            newMatrix->conditions.back().condition = getAlwaysFalseCondition().get();
+            InspectionMatrixSignalCollectionInfo s2{};
+            s2.signalID = 100 + j;
+            s2.sampleBufferSize = 10 * ( i + 1 );
+            addSignalToCollect( newMatrix->conditions.back(), s2 );
+        }
+        engine.onChangeInspectionMatrix( newMatrix );
+        engine.addNewSignal( 100, timestamp + i, 0.0 );
+    }
+
+    collectionSchemes->conditions[0].condition = getAlwaysTrueCondition().get();
+    engine.onChangeInspectionMatrix( consCollectionSchemes );
+    engine.evaluateConditions( timestamp + changes );
+    uint32_t waitTimeMs = 0;
+    auto collectedData = engine.collectNextDataToSend( timestamp + changes, waitTimeMs );
+    ASSERT_NE( collectedData, nullptr );
+    ASSERT_EQ( collectedData->signals.size(), changes );
+    for ( uint32_t i = 0; i < changes; i++ )
+    {
+        EXPECT_EQ( collectedData->signals[i].value, static_cast<double>( changes - 1 - i ) );
+    }
 }
 
 TEST_F( CollectionInspectionEngineTest, CollectBurstWithoutSubsampling )
@@ -486,6 +839,40 @@ TEST_F( CollectionInspectionEngineTest, CollectBurstWithoutSubsampling )
     EXPECT_EQ( collectedData->signals[2].value, 0.1 );
 }
 
+TEST_F( CollectionInspectionEngineTest, CollectBurstAddedAsBatch )
+{
+    CollectionInspectionEngine engine;
+    InspectionMatrixSignalCollectionInfo s1{};
+    s1.signalID = 1234;
+    s1.sampleBufferSize = 50;
+    s1.minimumSampleIntervalMs = 0;
+    s1.fixedWindowPeriod = 77777;
+    addSignalToCollect( collectionSchemes->conditions[0], s1 );
+    collectionSchemes->conditions[0].condition = getAlwaysTrueCondition().get();
+    engine.onChangeInspectionMatrix( consCollectionSchemes );
+
+    uint64_t timestamp = 160000000;
+    // Signals not collected by any condition in the same batch are ignored
+    std::vector<CollectedSignal> batch = { CollectedSignal( s1.signalID, timestamp, 0.1 ),
+                                           CollectedSignal( 5678, timestamp, 9.9 ),
+                                           CollectedSignal( s1.signalID, timestamp + 1, 0.2 ),
+                                           CollectedSignal( s1.signalID, timestamp + 2, 0.3 ) };
+    engine.addNewSignals( batch.data(), batch.size() );
+    // Empty batch should have no effect
+    engine.addNewSignals( batch.data(), 0 );
+
+    engine.evaluateConditions( timestamp + 2 );
+
+    uint32_t waitTimeMs = 0;
+    auto collectedData = engine.collectNextDataToSend( timestamp + 2, waitTimeMs );
+    ASSERT_NE( collectedData, nullptr );
+    ASSERT_EQ( collectedData->signals.size(), 3 );
+
+    EXPECT_EQ( collectedData->signals[0].value, 0.3 );
+    EXPECT_EQ( collectedData->signals[1].value, 0.2 );
+    EXPECT_EQ( collectedData->signals[2].value, 0.1 );
+}
+
 TEST_F( CollectionInspectionEngineTest, IllegalSignalID )
 {
     CollectionInspectionEngine engine;
@@ -566,6 +953,46 @@ TEST_F( CollectionInspectionEngineTest, CollectRawCanFrames )
     EXPECT_TRUE( 0 == std::memcmp( collectedData->canFrames[0].data.data(), buf.data(), sizeof( buf ) ) );
 }
 
+TEST_F( CollectionInspectionEngineTest, CollectCanFdFramesWithClassicFrames )
+{
+    CollectionInspectionEngine engine;
+    InspectionMatrixCanFrameCollectionInfo c1;
+    c1.frameID = 0x380;
+    c1.channelID = 3;
+    c1.sampleBufferSize = 10;
+    c1.minimumSampleIntervalMs = 0;
+    collectionSchemes->conditions[0].canFrames.push_back( c1 );
+
+    collectionSchemes->conditions[0].condition = getAlwaysTrueCondition().get();
+    engine.onChangeInspectionMatrix( consCollectionSchemes );
+
+    uint64_t timestamp = 160000000;
+    std::array<uint8_t, MAX_CAN_FRAME_BYTE_SIZE> classicBuf = { 0xDE, 0xAD, 0xBE, 0xEF };
+    std::array<uint8_t, MAX_CAN_FRAME_BYTE_SIZE> fdBuf{};
+    for ( size_t i = 0; i < fdBuf.size(); i++ )
+    {
+        fdBuf[i] = static_cast<uint8_t>( i + 1 );
+    }
+    engine.addNewRawCanFrame( c1.frameID, c1.channelID, timestamp, classicBuf, 4 );
+    engine.addNewRawCanFrame( c1.frameID, c1.channelID, timestamp + 1, fdBuf, MAX_CAN_FRAME_BYTE_SIZE );
+    engine.addNewRawCanFrame( c1.frameID, c1.channelID, timestamp + 2, classicBuf, 4 );
+
+    engine.evaluateConditions( timestamp + 2 );
+
+    uint32_t waitTimeMs = 0;
+    auto collectedData = engine.collectNextDataToSend( timestamp + 2, waitTimeMs );
+    ASSERT_NE( collectedData, nullptr );
+    ASSERT_EQ( collectedData->canFrames.size(), 3 );
+
+    // Frames are collected newest first
+    EXPECT_EQ( collectedData->canFrames[0].size, 4 );
+    EXPECT_TRUE( 0 == std::memcmp( collectedData->canFrames[0].data.data(), classicBuf.data(), 4 ) );
+    EXPECT_EQ( collectedData->canFrames[1].size, MAX_CAN_FRAME_BYTE_SIZE );
+    EXPECT_TRUE( 0 == std::memcmp( collectedData->canFrames[1].data.data(), fdBuf.data(), fdBuf.size() ) );
+    EXPECT_EQ( collectedData->canFrames[2].size, 4 );
+    EXPECT_TRUE( 0 == std::memcmp( collectedData->canFrames[2].data.data(), classicBuf.data(), 4 ) );
+}
+
 TEST_F( CollectionInspectionEngineTest, MultipleCanSubsampling )
 {
     CollectionInspectionEngine engine;
@@ -1118,6 +1545,54 @@ TEST_F( CollectionInspectionEngineTest, MoreCollectionSchemesThanSupported )
     engine.collectNextDataToSend( timestamp, waitTimeMs );
 }
 
+TEST_F( CollectionInspectionEngineTest, ThousandsOfConditionsSendDataOnlyOnce )
+{
+    CollectionInspectionEngine engine;
+    const uint32_t numberOfConditions = 3000;
+    InspectionMatrixSignalCollectionInfo s1{};
+    s1.signalID = 1234;
+    s1.sampleBufferSize = 50;
+    s1.minimumSampleIntervalMs = 0;
+    s1.fixedWindowPeriod = 77777;
+    collectionSchemes->conditions.resize( numberOfConditions );
+    for ( uint32_t i = 0; i < numberOfConditions; i++ )
+    {
+        collectionSchemes->conditions[i].condition = getAlwaysTrueCondition().get();
+        collectionSchemes->conditions[i].probabilityToSend = 1.0;
+        addSignalToCollect( collectionSchemes->conditions[i], s1 );
+        // The same signal listed twice must still be sent out only once
+        addSignalToCollect( collectionSchemes->conditions[i], s1 );
+    }
+    engine.onChangeInspectionMatrix( consCollectionSchemes );
+
+    uint64_t timestamp = 160000000;
+    uint32_t waitTimeMs = 0;
+    engine.addNewSignal( s1.signalID, timestamp, 0.1 );
+    engine.addNewSignal( s1.signalID, timestamp + 1, 0.2 );
+    ASSERT_TRUE( engine.evaluateConditions( timestamp + 1 ) );
+    for ( uint32_t i = 0; i < numberOfConditions; i++ )
+    {
+        auto collectedData = engine.collectNextDataToSend( timestamp + 1, waitTimeMs );
+        ASSERT_NE( collectedData, nullptr );
+        ASSERT_EQ( collectedData->signals.size(), 2 );
+        EXPECT_EQ( collectedData->signals[0].value, 0.2 );
+        EXPECT_EQ( collectedData->signals[1].value, 0.1 );
+    }
+    ASSERT_EQ( engine.collectNextDataToSend( timestamp + 1, waitTimeMs ), nullptr );
+
+    // Every condition only sends out the sample it did not send before
+    engine.addNewSignal( s1.signalID, timestamp + 2, 0.3 );
+    ASSERT_TRUE( engine.evaluateConditions( timestamp + 2 ) );
+    for ( uint32_t i = 0; i < numberOfConditions; i++ )
+    {
+        auto collectedData = engine.collectNextDataToSend( timestamp + 2, waitTimeMs );
+        ASSERT_NE( collectedData, nullptr );
+        ASSERT_EQ( collectedData->signals.size(), 1 );
+        EXPECT_EQ( collectedData->signals[0].value, 0.3 );
+    }
+    ASSERT_EQ( engine.collectNextDataToSend( timestamp + 2, waitTimeMs ), nullptr );
+}
+
 /**
  * @brief This test aims to test Inspection Engine to evaluate Geohash Function Node.
  * Here's the test procedure:
@@ -1681,3 +2156,54 @@ TEST_F( CollectionInspectionEngineTest, NoCollectionSchemes )
     engine.onChangeInspectionMatrix( consCollectionSchemes );
     ASSERT_FALSE( engine.evaluateConditions( timestamp ) );
 }
+
+TEST_F( CollectionInspectionEngineTest, BytecodeSameAsRecursiveEvaluation )
+{
+    std::mt19937 gen( 1234 );
+    std::uniform_real_distribution<double> signalValue( -1.0, 10.0 );
+    std::vector<SignalID> signalIDs = { 1, 2, 3 };
+    for ( int tree = 0; tree < 500; tree++ )
+    {
+        auto matrix = std::make_shared<InspectionMatrix>();
+        matrix->conditions.resize( 1 );
+        matrix->conditions[0].probabilityToSend = 1.0;
+        matrix->conditions[0].condition = getRandomCondition( gen, signalIDs, 12 );
+        for ( auto id : signalIDs )
+        {
+            InspectionMatrixSignalCollectionInfo s{};
+            s.signalID = id;
+            s.sampleBufferSize = 5;
+            s.minimumSampleIntervalMs = 0;
+            s.fixedWindowPeriod = 100;
+            addSignalToCollect( matrix->conditions[0], s );
+        }
+        std::shared_ptr<const InspectionMatrix> constMatrix = matrix;
+        CollectionInspectionEngine recursiveEngine;
+        recursiveEngine.setUseRecursiveEvaluation( true );
+        recursiveEngine.onChangeInspectionMatrix( constMatrix );
+        CollectionInspectionEngine bytecodeEngine;
+        bytecodeEngine.onChangeInspectionMatrix( constMatrix );
+
+        uint64_t timestamp = 160000000;
+        for ( int step = 0; step < 20; step++ )
+        {
+            // Some steps don't provide all signals and some steps complete a fixed window
+            for ( auto id : signalIDs )
+            {
+                if ( ( step + id ) % 4 != 0 )
+                {
+                    auto value = signalValue( gen );
+                    recursiveEngine.addNewSignal( id, timestamp, value );
+                    bytecodeEngine.addNewSignal( id, timestamp, value );
+                }
+            }
+            ASSERT_EQ( recursiveEngine.evaluateConditions( timestamp ), bytecodeEngine.evaluateConditions( timestamp ) )
+                << "tree " << tree << " step " << step;
+            uint32_t waitTimeMs = 0;
+            auto recursiveData = recursiveEngine.collectNextDataToSend( timestamp, waitTimeMs );
+            auto bytecodeData = bytecodeEngine.collectNextDataToSend( timestamp, waitTimeMs );
+            ASSERT_EQ( recursiveData == nullptr, bytecodeData == nullptr ) << "tree " << tree << " step " << step;
+            timestamp += 30;
+        }
+    }
+}
@@ -14,6 +14,7 @@
 #include "CollectionInspectionWorkerThread.h"
 #include <cstring>
 #include <gtest/gtest.h>
+#include <map>
 #include <random>
 #include <thread>
 
@@ -160,6 +161,112 @@ TEST_F( CollectionInspectionWorkerThreadTest, CollectBurstWithoutSubsampling )
     worker.stop();
 }
 
+TEST_F( CollectionInspectionWorkerThreadTest, BurstLargerThanBatchSize )
+{
+    CollectionInspectionWorkerThread worker;
+    // Drain at most 4 signals per batch and evaluate at the latest after 10 ms
+    ASSERT_TRUE(
+        worker.init( signalBufferPtr, canRawBufferPtr, activeDTCBufferPtr, outputCollectedData, 1000, false, 4, 10 ) );
+    ASSERT_TRUE( worker.start() );
+    InspectionMatrixSignalCollectionInfo s1{};
+    s1.signalID = 1234;
+    s1.sampleBufferSize = 50;
+    s1.minimumSampleIntervalMs = 0;
+    s1.fixedWindowPeriod = 77777;
+    s1.isConditionOnlySignal = false;
+    collectionSchemes->conditions[0].triggerOnlyOnRisingEdge = true;
+    collectionSchemes->conditions[0].signals.push_back( s1 );
+    collectionSchemes->conditions[0].condition = getSignalsBiggerCondition( s1.signalID, 1 ).get();
+    worker.onChangeInspectionMatrix( consCollectionSchemes );
+    Timestamp timestamp = fClock->timeSinceEpochMs();
+    for ( int i = 0; i < 9; i++ )
+    {
+        signalBufferPtr->push( CollectedSignal( s1.signalID, timestamp, 0.1 * i ) );
+    }
+    // Only the last signal of the burst fulfills the condition
+    signalBufferPtr->push( CollectedSignal( s1.signalID, timestamp, 1.5 ) );
+
+    worker.onNewDataAvailable();
+
+    std::this_thread::sleep_for( std::chrono::milliseconds( 1000 ) );
+
+    ASSERT_TRUE( signalBufferPtr->empty() );
+    std::shared_ptr<const TriggeredCollectionSchemeData> collectedData;
+    ASSERT_TRUE( outputCollectedData->pop( collectedData ) );
+    ASSERT_EQ( collectedData->signals.size(), 10 );
+    EXPECT_EQ( collectedData->signals[0].value, 1.5 );
+    ASSERT_FALSE( outputCollectedData->pop( collectedData ) );
+
+    worker.stop();
+}
+
+TEST_F( CollectionInspectionWorkerThreadTest, ShardedConditionsKeepOrderPerCampaign )
+{
+    CollectionInspectionWorkerThread worker;
+    outputCollectedData = std::make_shared<CollectedDataReadyToPublish>( 100 );
+    // 4 conditions distributed over 3 shards
+    ASSERT_TRUE( worker.init(
+        signalBufferPtr, canRawBufferPtr, activeDTCBufferPtr, outputCollectedData, 1000, false, 0, 0, 3 ) );
+    ASSERT_TRUE( worker.start() );
+    ASSERT_TRUE( worker.isAlive() );
+    for ( uint32_t i = 0; i < collectionSchemes->conditions.size(); i++ )
+    {
+        InspectionMatrixSignalCollectionInfo s{};
+        s.signalID = 100 + i;
+        s.sampleBufferSize = 10;
+        s.minimumSampleIntervalMs = 0;
+        s.fixedWindowPeriod = 77777;
+        s.isConditionOnlySignal = false;
+        collectionSchemes->conditions[i].signals.push_back( s );
+        collectionSchemes->conditions[i].condition = getSignalsBiggerCondition( s.signalID, 1 ).get();
+        collectionSchemes->conditions[i].triggerOnlyOnRisingEdge = true;
+        collectionSchemes->conditions[i].probabilityToSend = 1.0;
+        collectionSchemes->conditions[i].metaData.collectionSchemeID = std::to_string( i );
+    }
+    worker.onChangeInspectionMatrix( consCollectionSchemes );
+    std::this_thread::sleep_for( std::chrono::milliseconds( 100 ) );
+
+    // Every condition triggers three times, each time with a higher value
+    for ( int trigger = 1; trigger <= 3; trigger++ )
+    {
+        Timestamp timestamp = fClock->timeSinceEpochMs();
+        for ( uint32_t i = 0; i < collectionSchemes->conditions.size(); i++ )
+        {
+            signalBufferPtr->push( CollectedSignal( 100 + i, timestamp, 0.5 ) );
+        }
+        worker.onNewDataAvailable();
+        std::this_thread::sleep_for( std::chrono::milliseconds( 50 ) );
+        for ( uint32_t i = 0; i < collectionSchemes->conditions.size(); i++ )
+        {
+            signalBufferPtr->push( CollectedSignal( 100 + i, timestamp + 1, 1.0 + trigger ) );
+        }
+        worker.onNewDataAvailable();
+        std::this_thread::sleep_for( std::chrono::milliseconds( 50 ) );
+    }
+    std::this_thread::sleep_for( std::chrono::milliseconds( 500 ) );
+
+    std::map<std::string, std::vector<double>> triggerValuesPerCampaign;
+    std::shared_ptr<const TriggeredCollectionSchemeData> collectedData;
+    while ( outputCollectedData->pop( collectedData ) )
+    {
+        ASSERT_FALSE( collectedData->signals.empty() );
+        triggerValuesPerCampaign[collectedData->metaData.collectionSchemeID].push_back(
+            collectedData->signals[0].value );
+    }
+    ASSERT_EQ( triggerValuesPerCampaign.size(), collectionSchemes->conditions.size() );
+    for ( auto &campaign : triggerValuesPerCampaign )
+    {
+        ASSERT_EQ( campaign.second.size(), 3 );
+        EXPECT_EQ( campaign.second[0], 2.0 );
+        EXPECT_EQ( campaign.second[1], 3.0 );
+        EXPECT_EQ( campaign.second[2], 4.0 );
+    }
+    ASSERT_TRUE( signalBufferPtr->empty() );
+
+    ASSERT_TRUE( worker.stop() );
+    ASSERT_FALSE( worker.isAlive() );
+}
+
 TEST_F( CollectionInspectionWorkerThreadTest, CollectionQueueFull )
 {
     CollectionInspectionWorkerThread worker;
@@ -195,6 +302,49 @@ TEST_F( CollectionInspectionWorkerThreadTest, CollectionQueueFull )
     worker.stop();
 }
 
+/** @brief Once the output queue fills up, the remaining space is kept for the highest priority campaigns */
+TEST_F( CollectionInspectionWorkerThreadTest, CollectionQueueReservedForHighPriority )
+{
+    outputCollectedData = std::make_shared<CollectedDataReadyToPublish>( 4 );
+    CollectionInspectionWorkerThread worker;
+    ASSERT_TRUE( worker.init( signalBufferPtr, canRawBufferPtr, activeDTCBufferPtr, outputCollectedData, 1000 ) );
+    ASSERT_TRUE( worker.start() );
+    InspectionMatrixSignalCollectionInfo s1{};
+    s1.signalID = 1234;
+    s1.sampleBufferSize = 50;
+    s1.minimumSampleIntervalMs = 0;
+    s1.fixedWindowPeriod = 77777;
+    s1.isConditionOnlySignal = false;
+    // Smaller value is higher priority
+    std::vector<uint32_t> priorities = { 5, 5, 1, 5 };
+    for ( size_t i = 0; i < collectionSchemes->conditions.size(); i++ )
+    {
+        collectionSchemes->conditions[i].signals.push_back( s1 );
+        collectionSchemes->conditions[i].condition = getAlwaysTrueCondition().get();
+        collectionSchemes->conditions[i].metaData.collectionSchemeID = "CAMPAIGN" + std::to_string( i );
+        collectionSchemes->conditions[i].metaData.priority = priorities[i];
+        collectionSchemes->conditions[i].probabilityToSend = 1.0;
+    }
+    worker.onChangeInspectionMatrix( consCollectionSchemes );
+    Timestamp timestamp = fClock->timeSinceEpochMs();
+    signalBufferPtr->push( CollectedSignal( s1.signalID, timestamp, 1 ) );
+    worker.onNewDataAvailable();
+    std::this_thread::sleep_for( std::chrono::milliseconds( 100 ) );
+
+    // CAMPAIGN3 would still fit, but the queue is filled up to the high priority only level. The always true
+    // conditions trigger again, then only CAMPAIGN2 can take the last place.
+    std::vector<std::string> collectionSchemeIDs;
+    std::shared_ptr<const TriggeredCollectionSchemeData> collectedData;
+    while ( outputCollectedData->pop( collectedData ) )
+    {
+        collectionSchemeIDs.emplace_back( collectedData->metaData.collectionSchemeID );
+    }
+    ASSERT_EQ( collectionSchemeIDs,
+               std::vector<std::string>( { "CAMPAIGN0", "CAMPAIGN1", "CAMPAIGN2", "CAMPAIGN2" } ) );
+
+    worker.stop();
+}
+
 TEST_F( CollectionInspectionWorkerThreadTest, ConsumeDataWithoutNotify )
 {
     CollectionInspectionWorkerThread worker;
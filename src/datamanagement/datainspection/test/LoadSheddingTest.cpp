@@ -0,0 +1,83 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include "LoadShedding.h"
+#include <gtest/gtest.h>
+
+using namespace Aws::IoTFleetWise::DataInspection;
+
+/** @brief All signals are pushed as long as the lane is not filled up to the sample down level */
+TEST( LoadSheddingTest, NoSheddingBelowSampleDownLevel )
+{
+    SignalLoadShedder shedder;
+    std::unordered_set<SignalID> highPrioritySignalIDs;
+    for ( int i = 0; i < 10; i++ )
+    {
+        ASSERT_TRUE( shedder.shouldPush( 1, 0, highPrioritySignalIDs ) );
+        ASSERT_TRUE( shedder.shouldPush( 1, SignalLoadShedder::SAMPLE_DOWN_FILL_PERCENT - 1, highPrioritySignalIDs ) );
+    }
+}
+
+/** @brief Low priority signals are sampled down per signal, high priority signals are always pushed */
+TEST( LoadSheddingTest, SampleDownLowPrioritySignals )
+{
+    SignalLoadShedder shedder;
+    std::unordered_set<SignalID> highPrioritySignalIDs = { 2 };
+    auto fillPercent = SignalLoadShedder::SAMPLE_DOWN_FILL_PERCENT;
+    uint32_t pushedSignal1 = 0;
+    uint32_t pushedSignal3 = 0;
+    for ( uint32_t i = 0; i < SignalLoadShedder::SAMPLE_DOWN_FACTOR * 10; i++ )
+    {
+        pushedSignal1 += shedder.shouldPush( 1, fillPercent, highPrioritySignalIDs ) ? 1 : 0;
+        ASSERT_TRUE( shedder.shouldPush( 2, fillPercent, highPrioritySignalIDs ) );
+        pushedSignal3 += shedder.shouldPush( 3, fillPercent, highPrioritySignalIDs ) ? 1 : 0;
+    }
+    ASSERT_EQ( pushedSignal1, 10 );
+    ASSERT_EQ( pushedSignal3, 10 );
+}
+
+/** @brief Only high priority signals are pushed once the lane is nearly full */
+TEST( LoadSheddingTest, HighPriorityOnly )
+{
+    SignalLoadShedder shedder;
+    std::unordered_set<SignalID> highPrioritySignalIDs = { 2 };
+    for ( int i = 0; i < 10; i++ )
+    {
+        ASSERT_FALSE(
+            shedder.shouldPush( 1, SignalLoadShedder::HIGH_PRIORITY_ONLY_FILL_PERCENT, highPrioritySignalIDs ) );
+        ASSERT_TRUE( shedder.shouldPush( 2, 100, highPrioritySignalIDs ) );
+    }
+}
+
+/** @brief Drops are counted per ID and reset once they are logged */
+TEST( LoadSheddingTest, DropCounters )
+{
+    DropCounters<SignalID> signalDrops( "LoadSheddingTest", "signals" );
+    signalDrops.logIfDue();
+    ASSERT_EQ( signalDrops.getTotal(), 0 );
+    signalDrops.add( 1 );
+    signalDrops.add( 2, 3 );
+    ASSERT_EQ( signalDrops.getTotal(), 4 );
+    // The first drop is logged immediately, later drops once per aggregation time
+    signalDrops.logIfDue();
+    ASSERT_EQ( signalDrops.getTotal(), 0 );
+    signalDrops.add( 1 );
+    signalDrops.logIfDue();
+    ASSERT_EQ( signalDrops.getTotal(), 1 );
+
+    DropCounters<std::string> campaignDrops( "LoadSheddingTest", "collected data" );
+    campaignDrops.add( "CAMPAIGN1" );
+    ASSERT_EQ( campaignDrops.getTotal(), 1 );
+    campaignDrops.logIfDue();
+    ASSERT_EQ( campaignDrops.getTotal(), 0 );
+}
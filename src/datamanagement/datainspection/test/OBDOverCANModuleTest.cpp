@@ -16,6 +16,7 @@
 #include "EnumUtility.h"
 #include "OBDDataTypes.h"
 #include "OBDOverCANSessionManager.h"
+#include "TraceModule.h"
 #include "businterfaces/ISOTPOverCANReceiver.h"
 #include <gtest/gtest.h>
 #include <stdio.h>
@@ -1116,3 +1117,259 @@ TEST_F( OBDOverCANModuleTest, OBDOverCANModuleRequestPIDAndDTCsTest )
     ASSERT_TRUE( transmissionECU.disconnect() );
     ASSERT_TRUE( obdModule.disconnect() );
 }
+
+// An ECU which is not configured (no Transmission ECU) answers the functional supported PIDs request on 0x7DF.
+// The module shall open a session to it and poll it.
+TEST_F( OBDOverCANModuleTest, OBDOverCANModuleDiscoveredECUIsPolled )
+{
+    std::vector<uint8_t> rxPDUData;
+    std::vector<uint8_t> txPDUData;
+    const uint32_t obdPIDRequestInterval = 2; // 2 seconds
+    const uint32_t obdDTCRequestInterval = 0; // no DTC request
+
+    // Answers the functional request sent on the broadcast ID
+    ISOTPOverCANSenderReceiver functionalResponder;
+    ISOTPOverCANSenderReceiverOptions functionalResponderOptions;
+    functionalResponderOptions.mSocketCanIFName = "vcan0";
+    functionalResponderOptions.mSourceCANId = toUType( ECUID::TRANSMISSION_ECU_RX );
+    functionalResponderOptions.mDestinationCANId = toUType( ECUID::BROADCAST_ID );
+    functionalResponderOptions.mP2TimeoutMs = P2_TIMEOUT_INFINITE;
+    ASSERT_TRUE( functionalResponder.init( functionalResponderOptions ) );
+    ASSERT_TRUE( functionalResponder.connect() );
+    // Physical channel of the same ECU
+    ISOTPOverCANSenderReceiver ecu;
+    ISOTPOverCANSenderReceiverOptions ecuOptions;
+    ecuOptions.mSocketCanIFName = "vcan0";
+    ecuOptions.mSourceCANId = toUType( ECUID::TRANSMISSION_ECU_RX );
+    ecuOptions.mDestinationCANId = toUType( ECUID::TRANSMISSION_ECU_TX );
+    ecuOptions.mP2TimeoutMs = P2_TIMEOUT_INFINITE;
+    ASSERT_TRUE( ecu.init( ecuOptions ) );
+    ASSERT_TRUE( ecu.connect() );
+
+    // The discovery blocks connect(), so the functional request is answered from another thread
+    std::vector<uint8_t> discoveryRequest;
+    std::thread responder( [&functionalResponder, &discoveryRequest]() {
+        if ( functionalResponder.receivePDU( discoveryRequest ) )
+        {
+            functionalResponder.sendPDU( { 0x41, 0x00, 0x18, 0x00, 0x00, 0x00 } );
+        }
+    } );
+
+    auto signalBufferPtr = std::make_shared<SignalBuffer>( 256 );
+    auto activeDTCBufferPtr = std::make_shared<ActiveDTCBuffer>( 256 );
+    OBDOverCANModule obdModule;
+    ASSERT_TRUE( obdModule.init(
+        signalBufferPtr, activeDTCBufferPtr, "vcan0", obdPIDRequestInterval, obdDTCRequestInterval, false, false ) );
+    ASSERT_TRUE( obdModule.connect() );
+    responder.join();
+    // Functional Supported PIDs request for SID 0x01 PID 0x00
+    ASSERT_EQ( discoveryRequest, std::vector<uint8_t>( { toUType( SID::CURRENT_STATS ), 0x00 } ) );
+    ASSERT_TRUE( functionalResponder.disconnect() );
+
+    obdModule.onChangeOfActiveDictionary( initDecoderDictionary(), VehicleDataSourceProtocol::OBD );
+    // Without an Engine ECU the VIN is requested from the discovered ECU
+    ASSERT_TRUE( ecu.receivePDU( rxPDUData ) );
+    ASSERT_EQ( rxPDUData[0], toUType( vehicleIdentificationNumberRequest.mSID ) );
+    ASSERT_EQ( rxPDUData[1], vehicleIdentificationNumberRequest.mPID );
+    txPDUData = { 0x49, 0x02, 0x01, 0x31, 0x47, 0x31, 0x4A, 0x43, 0x35, 0x34,
+                  0x34, 0x34, 0x52, 0x37, 0x32, 0x35, 0x32, 0x33, 0x36, 0x37 };
+    ASSERT_TRUE( ecu.sendPDU( txPDUData ) );
+    // Supported PIDs, in two requests
+    ASSERT_TRUE( ecu.receivePDU( rxPDUData ) );
+    ASSERT_EQ( rxPDUData[0], toUType( SID::CURRENT_STATS ) );
+    ASSERT_EQ( rxPDUData[1], 0x00 );
+    // Support PID 0x04,0x05
+    ASSERT_TRUE( ecu.sendPDU( { 0x41, 0x00, 0x18, 0x00, 0x00, 0x00 } ) );
+    ASSERT_TRUE( ecu.receivePDU( rxPDUData ) );
+    ASSERT_TRUE( ecu.sendPDU( { 0x41, 0xC0, 0x00, 0x00, 0x00, 0x00 } ) );
+    // The ECU is polled for its PIDs
+    ASSERT_TRUE( ecu.receivePDU( rxPDUData ) );
+    ASSERT_EQ( rxPDUData, std::vector<uint8_t>( { 0x01, 0x04, 0x05 } ) );
+    // 60% Engine load, 70 degrees Temperature
+    ASSERT_TRUE( ecu.sendPDU( { 0x41, 0x04, 0x99, 0x05, 0x6E } ) );
+    std::this_thread::sleep_for( std::chrono::milliseconds( 500 ) );
+
+    std::string vin;
+    ASSERT_TRUE( obdModule.getVIN( vin ) );
+    SupportedPIDs pids;
+    ASSERT_TRUE( obdModule.getPIDsToRequest( SID::CURRENT_STATS, ECUType::TRANSMISSION, pids ) );
+    ASSERT_EQ( pids, SupportedPIDs( { 0x04, 0x05 } ) );
+    // No session to the Engine ECU, as it did not respond to the discovery
+    ASSERT_FALSE( obdModule.getPIDsToRequest( SID::CURRENT_STATS, ECUType::ENGINE, pids ) );
+    std::map<SignalID, SignalValue> expectedPIDSignalValue = {
+        { toUType( EmissionPIDs::ENGINE_LOAD ), 60 }, { toUType( EmissionPIDs::ENGINE_COOLANT_TEMPERATURE ), 70 } };
+    CollectedSignal signal;
+    ASSERT_TRUE( obdModule.getSignalBufferPtr()->pop( signal ) );
+    ASSERT_DOUBLE_EQ( signal.value, expectedPIDSignalValue[signal.signalID] );
+    ASSERT_TRUE( obdModule.getSignalBufferPtr()->pop( signal ) );
+    ASSERT_DOUBLE_EQ( signal.value, expectedPIDSignalValue[signal.signalID] );
+
+    // Cleanup
+    ASSERT_TRUE( ecu.disconnect() );
+    ASSERT_TRUE( obdModule.disconnect() );
+}
+
+// Same as above with 29-bit IDs: the functional request is sent on the extended broadcast ID
+TEST_F( OBDOverCANModuleTest, OBDOverCANModuleDiscoveredECUWithExtendedIDs )
+{
+    std::vector<uint8_t> rxPDUData;
+    const uint32_t obdPIDRequestInterval = 2; // 2 seconds
+    const uint32_t obdDTCRequestInterval = 0; // no DTC request
+
+    ISOTPOverCANSenderReceiver functionalResponder;
+    ISOTPOverCANSenderReceiverOptions functionalResponderOptions;
+    functionalResponderOptions.mSocketCanIFName = "vcan0";
+    functionalResponderOptions.mIsExtendedId = true;
+    functionalResponderOptions.mSourceCANId = toUType( ECUID::TRANSMISSION_ECU_RX_EXTENDED );
+    functionalResponderOptions.mDestinationCANId = toUType( ECUID::BROADCAST_EXTENDED_ID );
+    functionalResponderOptions.mP2TimeoutMs = P2_TIMEOUT_INFINITE;
+    ASSERT_TRUE( functionalResponder.init( functionalResponderOptions ) );
+    ASSERT_TRUE( functionalResponder.connect() );
+    ISOTPOverCANSenderReceiver ecu;
+    ISOTPOverCANSenderReceiverOptions ecuOptions;
+    ecuOptions.mSocketCanIFName = "vcan0";
+    ecuOptions.mIsExtendedId = true;
+    ecuOptions.mSourceCANId = toUType( ECUID::TRANSMISSION_ECU_RX_EXTENDED );
+    ecuOptions.mDestinationCANId = toUType( ECUID::TRANSMISSION_ECU_TX_EXTENDED );
+    ecuOptions.mP2TimeoutMs = P2_TIMEOUT_INFINITE;
+    ASSERT_TRUE( ecu.init( ecuOptions ) );
+    ASSERT_TRUE( ecu.connect() );
+
+    std::vector<uint8_t> discoveryRequest;
+    std::thread responder( [&functionalResponder, &discoveryRequest]() {
+        if ( functionalResponder.receivePDU( discoveryRequest ) )
+        {
+            functionalResponder.sendPDU( { 0x41, 0x00, 0x18, 0x00, 0x00, 0x00 } );
+        }
+    } );
+
+    auto signalBufferPtr = std::make_shared<SignalBuffer>( 256 );
+    auto activeDTCBufferPtr = std::make_shared<ActiveDTCBuffer>( 256 );
+    OBDOverCANModule obdModule;
+    ASSERT_TRUE( obdModule.init(
+        signalBufferPtr, activeDTCBufferPtr, "vcan0", obdPIDRequestInterval, obdDTCRequestInterval, true, false ) );
+    ASSERT_TRUE( obdModule.connect() );
+    responder.join();
+    ASSERT_EQ( discoveryRequest, std::vector<uint8_t>( { toUType( SID::CURRENT_STATS ), 0x00 } ) );
+    ASSERT_TRUE( functionalResponder.disconnect() );
+
+    obdModule.onChangeOfActiveDictionary( initDecoderDictionary(), VehicleDataSourceProtocol::OBD );
+    // The discovered ECU is requested on its physical ID
+    ASSERT_TRUE( ecu.receivePDU( rxPDUData ) );
+    ASSERT_EQ( rxPDUData[0], toUType( vehicleIdentificationNumberRequest.mSID ) );
+    ASSERT_EQ( rxPDUData[1], vehicleIdentificationNumberRequest.mPID );
+
+    // Cleanup
+    ASSERT_TRUE( ecu.disconnect() );
+    ASSERT_TRUE( obdModule.disconnect() );
+}
+
+// The Engine ECU does not respond at all. The PIDs of the Transmission ECU shall still arrive before the P2 timeout
+// of the Engine ECU expires, and the timeout of the Engine ECU shall be traced.
+TEST_F( OBDOverCANModuleTest, OBDOverCANModuleSilentECUDoesNotBlockOtherECUs )
+{
+    std::vector<uint8_t> tcmRxPDUData;
+    const uint32_t obdPIDRequestInterval = 1; // 1 second
+    const uint32_t obdDTCRequestInterval = 0; // no DTC request
+
+    // Only the Transmission ECU is simulated. Nothing answers the discovery, so the configured ECUs are used.
+    ISOTPOverCANSenderReceiver transmissionECU;
+    ISOTPOverCANSenderReceiverOptions transmissionECUOptions;
+    transmissionECUOptions.mSocketCanIFName = "vcan0";
+    transmissionECUOptions.mSourceCANId = toUType( ECUID::TRANSMISSION_ECU_RX );
+    transmissionECUOptions.mDestinationCANId = toUType( ECUID::TRANSMISSION_ECU_TX );
+    transmissionECUOptions.mP2TimeoutMs = P2_TIMEOUT_INFINITE;
+    ASSERT_TRUE( transmissionECU.init( transmissionECUOptions ) );
+    ASSERT_TRUE( transmissionECU.connect() );
+
+    auto signalBufferPtr = std::make_shared<SignalBuffer>( 256 );
+    auto activeDTCBufferPtr = std::make_shared<ActiveDTCBuffer>( 256 );
+    OBDOverCANModule obdModule;
+    ASSERT_TRUE( obdModule.init(
+        signalBufferPtr, activeDTCBufferPtr, "vcan0", obdPIDRequestInterval, obdDTCRequestInterval, false, true ) );
+    ASSERT_TRUE( obdModule.connect() );
+    auto timeoutsBefore = TraceModule::get().getVariableMax( TraceVariable::OBD_REQUEST_TIMEOUT );
+    auto startTime = std::chrono::steady_clock::now();
+    // The VIN request goes to the silent Engine ECU
+    obdModule.onChangeOfActiveDictionary( initDecoderDictionary(), VehicleDataSourceProtocol::OBD );
+
+    ASSERT_TRUE( transmissionECU.receivePDU( tcmRxPDUData ) );
+    ASSERT_EQ( tcmRxPDUData[0], toUType( SID::CURRENT_STATS ) );
+    ASSERT_EQ( tcmRxPDUData[1], 0x00 );
+    // Support PID 0x0D
+    ASSERT_TRUE( transmissionECU.sendPDU( { 0x41, 0x00, 0x00, 0x08, 0x00, 0x00 } ) );
+    ASSERT_TRUE( transmissionECU.receivePDU( tcmRxPDUData ) );
+    ASSERT_TRUE( transmissionECU.sendPDU( { 0x41, 0xC0, 0x00, 0x00, 0x00, 0x00 } ) );
+    ASSERT_TRUE( transmissionECU.receivePDU( tcmRxPDUData ) );
+    ASSERT_EQ( tcmRxPDUData, std::vector<uint8_t>( { 0x01, 0x0D } ) );
+    // Vehicle speed of 35 kph
+    ASSERT_TRUE( transmissionECU.sendPDU( { 0x41, 0x0D, 0x23 } ) );
+    std::this_thread::sleep_for( std::chrono::milliseconds( 200 ) );
+    CollectedSignal signal;
+    ASSERT_TRUE( obdModule.getSignalBufferPtr()->pop( signal ) );
+    ASSERT_EQ( signal.signalID, toUType( EmissionPIDs::VEHICLE_SPEED ) );
+    ASSERT_DOUBLE_EQ( signal.value, 35 );
+    // The PIDs arrived while the request to the Engine ECU was still waiting for its response
+    ASSERT_LT( std::chrono::duration_cast<std::chrono::milliseconds>( std::chrono::steady_clock::now() - startTime )
+                   .count(),
+               P2_TIMEOUT_DEFAULT_MS );
+    ASSERT_EQ( TraceModule::get().getVariableMax( TraceVariable::OBD_REQUEST_TIMEOUT ), timeoutsBefore );
+
+    // Wait for the P2 timeout of the Engine ECU
+    std::this_thread::sleep_until( startTime + std::chrono::milliseconds( P2_TIMEOUT_DEFAULT_MS + 500 ) );
+    ASSERT_GT( TraceModule::get().getVariableMax( TraceVariable::OBD_REQUEST_TIMEOUT ), timeoutsBefore );
+    std::string vin;
+    ASSERT_FALSE( obdModule.getVIN( vin ) );
+
+    // Cleanup
+    ASSERT_TRUE( transmissionECU.disconnect() );
+    ASSERT_TRUE( obdModule.disconnect() );
+}
+
+// Nothing answers the discovery request. The module shall fall back to the configured Engine and Transmission ECUs.
+TEST_F( OBDOverCANModuleTest, OBDOverCANModuleFallsBackToConfiguredECUs )
+{
+    std::vector<uint8_t> ecmRxPDUData;
+    std::vector<uint8_t> tcmRxPDUData;
+    const uint32_t obdPIDRequestInterval = 2; // 2 seconds
+    const uint32_t obdDTCRequestInterval = 0; // no DTC request
+
+    ISOTPOverCANSenderReceiver engineECU;
+    ISOTPOverCANSenderReceiverOptions engineECUOptions;
+    engineECUOptions.mSocketCanIFName = "vcan0";
+    engineECUOptions.mSourceCANId = toUType( ECUID::ENGINE_ECU_RX );
+    engineECUOptions.mDestinationCANId = toUType( ECUID::ENGINE_ECU_TX );
+    engineECUOptions.mP2TimeoutMs = P2_TIMEOUT_INFINITE;
+    ASSERT_TRUE( engineECU.init( engineECUOptions ) );
+    ASSERT_TRUE( engineECU.connect() );
+    ISOTPOverCANSenderReceiver transmissionECU;
+    ISOTPOverCANSenderReceiverOptions transmissionECUOptions;
+    transmissionECUOptions.mSocketCanIFName = "vcan0";
+    transmissionECUOptions.mSourceCANId = toUType( ECUID::TRANSMISSION_ECU_RX );
+    transmissionECUOptions.mDestinationCANId = toUType( ECUID::TRANSMISSION_ECU_TX );
+    transmissionECUOptions.mP2TimeoutMs = P2_TIMEOUT_INFINITE;
+    ASSERT_TRUE( transmissionECU.init( transmissionECUOptions ) );
+    ASSERT_TRUE( transmissionECU.connect() );
+
+    auto signalBufferPtr = std::make_shared<SignalBuffer>( 256 );
+    auto activeDTCBufferPtr = std::make_shared<ActiveDTCBuffer>( 256 );
+    OBDOverCANModule obdModule;
+    ASSERT_TRUE( obdModule.init(
+        signalBufferPtr, activeDTCBufferPtr, "vcan0", obdPIDRequestInterval, obdDTCRequestInterval, false, true ) );
+    ASSERT_TRUE( obdModule.connect() );
+    obdModule.onChangeOfActiveDictionary( initDecoderDictionary(), VehicleDataSourceProtocol::OBD );
+
+    // Both configured ECUs are requested on their hard-wired IDs: the VIN from the Engine ECU and the supported PIDs
+    // from the Transmission ECU
+    ASSERT_TRUE( engineECU.receivePDU( ecmRxPDUData ) );
+    ASSERT_EQ( ecmRxPDUData[0], toUType( vehicleIdentificationNumberRequest.mSID ) );
+    ASSERT_EQ( ecmRxPDUData[1], vehicleIdentificationNumberRequest.mPID );
+    ASSERT_TRUE( transmissionECU.receivePDU( tcmRxPDUData ) );
+    ASSERT_EQ( tcmRxPDUData[0], toUType( SID::CURRENT_STATS ) );
+    ASSERT_EQ( tcmRxPDUData[1], 0x00 );
+
+    // Cleanup
+    ASSERT_TRUE( engineECU.disconnect() );
+    ASSERT_TRUE( transmissionECU.disconnect() );
+    ASSERT_TRUE( obdModule.disconnect() );
+}
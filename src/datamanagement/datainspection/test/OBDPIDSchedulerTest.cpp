@@ -0,0 +1,66 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+
+#include "OBDPIDScheduler.h"
+#include <gtest/gtest.h>
+
+using namespace Aws::IoTFleetWise::DataInspection;
+
+TEST( OBDPIDSchedulerTest, PIDIntervalsFollowTheFastestCollectedSignal )
+{
+    // PID 0x0C has two signals, PID 0x2F has no minimum sample interval
+    std::map<PID, std::vector<SignalID>> pidSignals = { { 0x0C, { 1, 2 } }, { 0x0D, { 3 } }, { 0x2F, { 4 } } };
+    std::unordered_map<SignalID, uint32_t> signalIntervalsMs = { { 1, 500 }, { 2, 200 }, { 3, 20 } };
+    auto pidIntervals = OBDPIDScheduler::calculatePIDIntervals( pidSignals, signalIntervalsMs, 10000, 100 );
+    ASSERT_EQ( pidIntervals.size(), 3 );
+    ASSERT_EQ( pidIntervals[0x0C], 200 );
+    // Clamped to the minimum interval
+    ASSERT_EQ( pidIntervals[0x0D], 100 );
+    ASSERT_EQ( pidIntervals[0x2F], 10000 );
+}
+
+TEST( OBDPIDSchedulerTest, PIDsAreDueAtTheirOwnRate )
+{
+    OBDPIDScheduler scheduler;
+    ASSERT_TRUE( scheduler.empty() );
+    ASSERT_EQ( scheduler.getNextDueTime(), OBDPIDScheduler::NOTHING_SCHEDULED );
+    scheduler.setPIDIntervals( { { 0x0C, 200 }, { 0x2F, 1000 }, { 0x05, 0 } }, 1000 );
+    ASSERT_FALSE( scheduler.empty() );
+    ASSERT_EQ( scheduler.getInterval( 0x05 ), 0 );
+    // New PIDs are due immediately
+    ASSERT_EQ( scheduler.getDuePIDs( 1000 ), std::vector<PID>( { 0x0C, 0x2F } ) );
+    ASSERT_EQ( scheduler.getNextDueTime(), 1200 );
+    ASSERT_TRUE( scheduler.getDuePIDs( 1100 ).empty() );
+    // Within the scheduling tolerance
+    ASSERT_EQ( scheduler.getDuePIDs( 1160 ), std::vector<PID>( { 0x0C } ) );
+    ASSERT_EQ( scheduler.getDuePIDs( 1360 ), std::vector<PID>( { 0x0C } ) );
+    ASSERT_EQ( scheduler.getDuePIDs( 1990 ), std::vector<PID>( { 0x0C, 0x2F } ) );
+}
+
+TEST( OBDPIDSchedulerTest, ChangedIntervalsKeepThePhase )
+{
+    OBDPIDScheduler scheduler;
+    scheduler.setPIDIntervals( { { 0x0C, 1000 }, { 0x0D, 1000 } }, 0 );
+    scheduler.getDuePIDs( 0 );
+    // 0x0C gets faster, 0x0D is removed and 0x2F is added
+    scheduler.setPIDIntervals( { { 0x0C, 100 }, { 0x2F, 5000 } }, 500 );
+    ASSERT_EQ( scheduler.getInterval( 0x0C ), 100 );
+    ASSERT_EQ( scheduler.getInterval( 0x0D ), 0 );
+    ASSERT_EQ( scheduler.getNextDueTime(), 500 );
+    ASSERT_EQ( scheduler.getDuePIDs( 500 ), std::vector<PID>( { 0x2F } ) );
+    ASSERT_EQ( scheduler.getDuePIDs( 600 ), std::vector<PID>( { 0x0C } ) );
+    // A slower interval does not delay the PID beyond the new interval from now
+    scheduler.setPIDIntervals( { { 0x0C, 2000 }, { 0x2F, 5000 } }, 650 );
+    ASSERT_EQ( scheduler.getNextDueTime(), 700 );
+}
@@ -821,3 +821,55 @@ TEST_F( VehicleDataSourceBinderTest, VehicleDataSourceBinderStartupAndShutdownCy
     ASSERT_FALSE( canConsumer->getCANBufferPtr()->empty() );
     ASSERT_TRUE( networkBinder.disconnect() );
 }
+
+TEST_F( VehicleDataSourceBinderTest, VehicleDataSourceBinderDecodeInCANMultiBusReader )
+{
+    ASSERT_TRUE( socketFD != -1 );
+    auto reader = std::make_shared<CANMultiBusReader>();
+    ASSERT_TRUE( reader->start() );
+    VehicleDataSourceConfig canSourceConfig;
+    canSourceConfig.transportProperties.emplace( "interfaceName", "vcan0" );
+    canSourceConfig.transportProperties.emplace( "threadIdleTimeMs", "1000" );
+    canSourceConfig.transportProperties.emplace( "receiveBatchSize", "64" );
+    canSourceConfig.maxNumberOfVehicleDataMessages = 1000;
+    std::vector<VehicleDataSourceConfig> canSourceConfigs = { canSourceConfig };
+    auto signalBufferPtr = std::make_shared<SignalBuffer>( 256 );
+    auto canRawBufferPtr = std::make_shared<CANBuffer>( 256 );
+    VehicleDataSourceBinder networkBinder;
+    ASSERT_TRUE( networkBinder.connect() );
+    // Two channels read and decoded by the same thread
+    for ( VehicleDataSourceID channelId = 0; channelId < 2; channelId++ )
+    {
+        auto canSource = std::make_shared<CANDataSource>();
+        auto canConsumer = std::make_shared<CANDataConsumer>();
+        ASSERT_TRUE( canSource->init( canSourceConfigs ) );
+        ASSERT_EQ( canSource->getReceiveBatchSize(), 64 );
+        ASSERT_TRUE( canConsumer->init( channelId, signalBufferPtr, 1000 ) );
+        canConsumer->setCANBufferPtr( canRawBufferPtr );
+        canSource->setMultiBusReader( reader );
+        canConsumer->setConsumeInReceivingThread();
+        canSource->setFramesReceivedCallback( [canConsumer]() { canConsumer->consumeAvailableFrames(); } );
+        ASSERT_TRUE( networkBinder.addVehicleDataSource( canSource ) );
+        ASSERT_TRUE(
+            networkBinder.bindConsumerToVehicleDataSource( canConsumer, canSource->getVehicleDataSourceID() ) );
+        ASSERT_TRUE( canSource->isAlive() );
+    }
+    // Not read while there is no decoder dictionary
+    struct can_frame frame = {};
+    sendTestMessage( socketFD, frame );
+    std::this_thread::sleep_for( std::chrono::milliseconds( 500 ) );
+    ASSERT_TRUE( canRawBufferPtr->empty() );
+
+    auto dictionary = std::make_shared<const CANDecoderDictionary>( generateDecoderDictionary1() );
+    networkBinder.onChangeOfActiveDictionary( dictionary, VehicleDataSourceProtocol::RAW_SOCKET );
+    std::this_thread::sleep_for( std::chrono::milliseconds( 100 ) );
+    sendTestMessage( socketFD, frame );
+    // The reader blocks until the sockets are readable, so no idle time has to pass
+    std::this_thread::sleep_for( std::chrono::milliseconds( 200 ) );
+    CollectedCanRawFrame rawCANMsg;
+    ASSERT_TRUE( canRawBufferPtr->pop( rawCANMsg ) );
+    ASSERT_TRUE( canRawBufferPtr->pop( rawCANMsg ) );
+    ASSERT_FALSE( canRawBufferPtr->pop( rawCANMsg ) );
+    ASSERT_TRUE( networkBinder.disconnect() );
+    ASSERT_TRUE( reader->stop() );
+}
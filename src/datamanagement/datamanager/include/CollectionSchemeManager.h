@@ -28,6 +28,7 @@
 #include "Signal.h"
 #include "Thread.h"
 #include "Timer.h"
+#include "TraceModule.h"
 #include <atomic>
 #include <map>
 #include <mutex>
@@ -197,6 +198,23 @@ private:
      */
     static void doWork( void *data );
 
+    /**
+     * @brief Function that runs on the build thread. It parses and validates the incoming DecoderManifest and
+     * CollectionSchemeList, and only hands successfully built documents over to the main thread. This way neither
+     * the AWS IoT callbacks nor the timeline and checkins of the main thread wait for large documents to be parsed.
+     * @param data collectionScheme manager object
+     */
+    static void doBuild( void *data );
+
+    /**
+     * @brief Parses a document on the calling thread
+     * @param document the DecoderManifest or CollectionSchemeList to build
+     * @param section trace section used to record the build time
+     * @return True if the document is ready to be used. False otherwise.
+     */
+    template <typename T>
+    static bool buildDocument( const T &document, TraceSection section );
+
     /**
      * @brief template function for generate a message on an event for mLogger usage
      * Include Event printed in string msg, collectionScheme ID, startTime, stopTime of the collectionScheme, and
@@ -290,6 +308,12 @@ protected:
 
     void store( DataType storeType ) override;
 
+    /**
+     * @brief Maps the persisted image of the decoder manifest and hands it to the retrieved decoder manifest, so that
+     * it does not need to parse the protobuf if the image is up to date.
+     */
+    void retrieveDecoderManifestImage();
+
     bool processDecoderManifest() override;
 
     bool processCollectionScheme() override;
@@ -310,6 +334,8 @@ private:
         VehicleDataSourceProtocol::RAW_SOCKET, VehicleDataSourceProtocol::OBD };
 
     Thread mThread;
+    // Thread that builds the incoming documents before they are handed over to the main thread
+    Thread mBuildThread;
     // Atomic flag to signal the state of main thread. If true, we should stop
     std::atomic<bool> mShouldStop{ false };
     // mutex that protects the thread
@@ -317,6 +343,8 @@ private:
 
     // Platform signal that wakes up main thread
     Platform::Linux::Signal mWait;
+    // Platform signal that wakes up build thread
+    Platform::Linux::Signal mBuildWait;
     std::shared_ptr<const Clock> mClock = ClockHandler::getClock();
     LoggingModule mLogger;
 
@@ -369,6 +397,14 @@ protected:
      */
     IDecoderManifestPtr mDecoderManifestInput;
 
+    /*
+     * While the build thread is running, the documents received in the callbacks are first parsed by it before they
+     * are made available to the main thread through the inputs above.
+     */
+    bool mBuildInBackground{ false };
+    ICollectionSchemeListPtr mCollectionSchemeListToBuild;
+    IDecoderManifestPtr mDecoderManifestToBuild;
+
     // flag used by main thread to check if collectionScheme needs to be processed
     bool mProcessCollectionScheme{ false };
     // flag used by main thread to check if DM needs to be processed
@@ -131,11 +131,32 @@ CollectionSchemeManager::retrieve( DataType retrieveType )
             mDecoderManifest = std::make_shared<DecoderManifestIngestion>();
         }
         mDecoderManifest->copyData( protoOutput.data(), protoSize );
+        retrieveDecoderManifestImage();
         mProcessDecoderManifest = true;
     }
     return true;
 }
 
+void
+CollectionSchemeManager::retrieveDecoderManifestImage()
+{
+    auto mappedImage = mSchemaPersistency->map( DataType::DECODER_MANIFEST_IMAGE );
+    if ( mappedImage == nullptr )
+    {
+        mLogger.info( "CollectionSchemeManager::retrieveDecoderManifestImage", "No DecoderManifest image persisted" );
+        return;
+    }
+    auto image = std::make_shared<DecoderManifestImage>();
+    if ( !image->init( mappedImage->getData(), mappedImage->getSize(), mappedImage ) )
+    {
+        mLogger.warn( "CollectionSchemeManager::retrieveDecoderManifestImage",
+                      "Ignoring invalid DecoderManifest image of size " + std::to_string( mappedImage->getSize() ) );
+        return;
+    }
+    // The image is only used if it was compiled from the retrieved DecoderManifest, which is checked by build()
+    mDecoderManifest->setImage( image );
+}
+
 void
 CollectionSchemeManager::store( DataType storeType )
 {
@@ -154,7 +175,8 @@ CollectionSchemeManager::store( DataType storeType )
         mLogger.error( "CollectionSchemeManager::store", "Invalid CollectionSchemeList" );
         return;
     }
-    if ( storeType == DataType::DECODER_MANIFEST && mDecoderManifest == nullptr )
+    if ( ( storeType == DataType::DECODER_MANIFEST || storeType == DataType::DECODER_MANIFEST_IMAGE ) &&
+         mDecoderManifest == nullptr )
     {
         mLogger.error( "CollectionSchemeManager::store", "Invalid DecoderManifest" );
         return;
@@ -169,6 +191,16 @@ CollectionSchemeManager::store( DataType storeType )
         protoInput = mDecoderManifest->getData();
         logStr = "The DecoderManifest";
         break;
+    case DataType::DECODER_MANIFEST_IMAGE:
+        protoInput = mDecoderManifest->compileImage();
+        logStr = "The DecoderManifest image";
+        if ( protoInput.empty() )
+        {
+            // The DecoderManifest was built from the persisted image, so it is up to date
+            mLogger.trace( "CollectionSchemeManager::store", logStr + " is up to date." );
+            return;
+        }
+        break;
     default:
         mLogger.error( "CollectionSchemeManager::store",
                        "cannot store unsupported type of " + std::to_string( toUType( storeType ) ) );
@@ -68,7 +68,18 @@ CollectionSchemeManager::start()
         mLogger.info( "CollectionSchemeManager::start", " Collection Scheme Thread started " );
         mThread.setThreadName( "fwDMColSchMngr" );
     }
-    return mThread.isValid();
+    if ( !mBuildThread.create( doBuild, this ) )
+    {
+        mLogger.error( "CollectionSchemeManager::start", " Collection Scheme Build Thread failed to start " );
+    }
+    else
+    {
+        mLogger.info( "CollectionSchemeManager::start", " Collection Scheme Build Thread started " );
+        mBuildThread.setThreadName( "fwDMColSchBld" );
+        std::lock_guard<std::mutex> schemaLock( mSchemaUpdateMutex );
+        mBuildInBackground = true;
+    }
+    return mThread.isValid() && mBuildThread.isValid();
 }
 
 bool
@@ -82,9 +93,27 @@ CollectionSchemeManager::stop()
      * be stopped any time, use notify() to wake up
      * immediately.
      */
+    {
+        std::lock_guard<std::mutex> schemaLock( mSchemaUpdateMutex );
+        mBuildInBackground = false;
+    }
     mWait.notify();
+    mBuildWait.notify();
     mThread.release();
+    mBuildThread.release();
     mShouldStop.store( false, std::memory_order_relaxed );
+    // Documents that were not built yet are left to the main thread, which builds them itself when restarted
+    std::lock_guard<std::mutex> schemaLock( mSchemaUpdateMutex );
+    if ( mCollectionSchemeListToBuild != nullptr )
+    {
+        mCollectionSchemeListInput = std::move( mCollectionSchemeListToBuild );
+        mCollectionSchemeAvailable = true;
+    }
+    if ( mDecoderManifestToBuild != nullptr )
+    {
+        mDecoderManifestInput = std::move( mDecoderManifestToBuild );
+        mDecoderManifestAvailable = true;
+    }
     mLogger.info( "CollectionSchemeManager::stop", " Collection Scheme Thread stopped " );
     return true;
 }
@@ -190,16 +219,12 @@ CollectionSchemeManager::doWork( void *data )
         if ( collectionSchemeManager->mProcessDecoderManifest )
         {
             collectionSchemeManager->mProcessDecoderManifest = false;
-            TraceModule::get().sectionBegin( TraceSection::MANAGER_DECODER_BUILD );
             enabledCollectionSchemeMapChanged |= collectionSchemeManager->processDecoderManifest();
-            TraceModule::get().sectionEnd( TraceSection::MANAGER_DECODER_BUILD );
         }
         if ( collectionSchemeManager->mProcessCollectionScheme )
         {
             collectionSchemeManager->mProcessCollectionScheme = false;
-            TraceModule::get().sectionBegin( TraceSection::MANAGER_COLLECTION_BUILD );
             enabledCollectionSchemeMapChanged |= collectionSchemeManager->processCollectionScheme();
-            TraceModule::get().sectionEnd( TraceSection::MANAGER_COLLECTION_BUILD );
         }
         auto checkTime = collectionSchemeManager->mClock->timeSinceEpochMs();
         enabledCollectionSchemeMapChanged |= collectionSchemeManager->checkTimeLine( checkTime );
@@ -216,23 +241,24 @@ CollectionSchemeManager::doWork( void *data )
              * input: mEnabledCollectionSchemeMap
              * output: shared_ptr to InspectionMatrix
              *
-             * Then, propagate inspection matrix to Inspection engine
-             */
-            enabledCollectionSchemeMapChanged = false;
-            std::shared_ptr<InspectionMatrix> inspectionMatrixOutput = std::make_shared<InspectionMatrix>();
-            collectionSchemeManager->inspectionMatrixExtractor( inspectionMatrixOutput );
-            collectionSchemeManager->inspectionMatrixUpdater( inspectionMatrixOutput );
-            /*
-             * extract decoder dictionary
+             * and extract decoder dictionary
              * input: mDecoderManifest
              * output: shared_ptr to decoderDictionary
              *
-             * the propagate the output to Vehicle Data Consumers
+             * Both are extracted before either is propagated, so that the Inspection engine and the Vehicle Data
+             * Consumers switch to the new collection schemes back to back.
              */
+            enabledCollectionSchemeMapChanged = false;
+            std::shared_ptr<InspectionMatrix> inspectionMatrixOutput = std::make_shared<InspectionMatrix>();
+            collectionSchemeManager->inspectionMatrixExtractor( inspectionMatrixOutput );
+            std::map<VehicleDataSourceProtocol, std::shared_ptr<CANDecoderDictionary>> decoderDictionaryMap;
             if ( !collectionSchemeManager->mUseLocalDictionary )
             {
-                std::map<VehicleDataSourceProtocol, std::shared_ptr<CANDecoderDictionary>> decoderDictionaryMap;
                 collectionSchemeManager->decoderDictionaryExtractor( decoderDictionaryMap );
+            }
+            collectionSchemeManager->inspectionMatrixUpdater( inspectionMatrixOutput );
+            if ( !collectionSchemeManager->mUseLocalDictionary )
+            {
                 // Publish decoder dictionaries update to all listeners
                 collectionSchemeManager->decoderDictionaryUpdater( decoderDictionaryMap );
                 // coverity[check_return : SUPPRESS]
@@ -297,10 +323,82 @@ CollectionSchemeManager::doWork( void *data )
 }
 
 /* callback function */
+template <typename T>
+bool
+CollectionSchemeManager::buildDocument( const T &document, TraceSection section )
+{
+    if ( document->isReady() )
+    {
+        return true;
+    }
+    TraceModule::get().sectionBegin( section );
+    bool built = document->build();
+    TraceModule::get().sectionEnd( section );
+    return built;
+}
+
+void
+CollectionSchemeManager::doBuild( void *data )
+{
+    CollectionSchemeManager *collectionSchemeManager = static_cast<CollectionSchemeManager *>( data );
+
+    while ( !collectionSchemeManager->shouldStop() )
+    {
+        collectionSchemeManager->mBuildWait.wait( Platform::Linux::Signal::WaitWithPredicate );
+        ICollectionSchemeListPtr collectionSchemeList;
+        IDecoderManifestPtr decoderManifest;
+        {
+            std::lock_guard<std::mutex> lock( collectionSchemeManager->mSchemaUpdateMutex );
+            collectionSchemeList = std::move( collectionSchemeManager->mCollectionSchemeListToBuild );
+            collectionSchemeManager->mCollectionSchemeListToBuild = nullptr;
+            decoderManifest = std::move( collectionSchemeManager->mDecoderManifestToBuild );
+            collectionSchemeManager->mDecoderManifestToBuild = nullptr;
+        }
+        if ( ( decoderManifest != nullptr ) &&
+             !buildDocument( decoderManifest, TraceSection::MANAGER_DECODER_BUILD ) )
+        {
+            collectionSchemeManager->mLogger.error( "CollectionSchemeManager::doBuild",
+                                                    " Failed to build the upcoming DecoderManifest." );
+            decoderManifest = nullptr;
+        }
+        if ( ( collectionSchemeList != nullptr ) &&
+             !buildDocument( collectionSchemeList, TraceSection::MANAGER_COLLECTION_BUILD ) )
+        {
+            collectionSchemeManager->mLogger.error( "CollectionSchemeManager::doBuild",
+                                                    "Incoming CollectionScheme fails to build!" );
+            collectionSchemeList = nullptr;
+        }
+        if ( ( decoderManifest == nullptr ) && ( collectionSchemeList == nullptr ) )
+        {
+            continue;
+        }
+        // Documents built together are handed over together, so that the main thread never sees a new
+        // CollectionSchemeList before the DecoderManifest it was sent with
+        std::lock_guard<std::mutex> lock( collectionSchemeManager->mSchemaUpdateMutex );
+        if ( decoderManifest != nullptr )
+        {
+            collectionSchemeManager->mDecoderManifestInput = decoderManifest;
+            collectionSchemeManager->mDecoderManifestAvailable = true;
+        }
+        if ( collectionSchemeList != nullptr )
+        {
+            collectionSchemeManager->mCollectionSchemeListInput = collectionSchemeList;
+            collectionSchemeManager->mCollectionSchemeAvailable = true;
+        }
+        collectionSchemeManager->mWait.notify();
+    }
+}
+
 void
 CollectionSchemeManager::onCollectionSchemeUpdate( const ICollectionSchemeListPtr &collectionSchemeList )
 {
     std::lock_guard<std::mutex> lock( mSchemaUpdateMutex );
+    if ( mBuildInBackground && ( collectionSchemeList != nullptr ) )
+    {
+        mCollectionSchemeListToBuild = collectionSchemeList;
+        mBuildWait.notify();
+        return;
+    }
     mCollectionSchemeListInput = collectionSchemeList;
     mCollectionSchemeAvailable = true;
     mWait.notify();
@@ -310,6 +408,12 @@ void
 CollectionSchemeManager::onDecoderManifestUpdate( const IDecoderManifestPtr &decoderManifest )
 {
     std::lock_guard<std::mutex> lock( mSchemaUpdateMutex );
+    if ( mBuildInBackground && ( decoderManifest != nullptr ) )
+    {
+        mDecoderManifestToBuild = decoderManifest;
+        mBuildWait.notify();
+        return;
+    }
     mDecoderManifestInput = decoderManifest;
     mDecoderManifestAvailable = true;
     mWait.notify();
@@ -395,7 +499,8 @@ CollectionSchemeManager::isCollectionSchemeLoaded()
 bool
 CollectionSchemeManager::processDecoderManifest()
 {
-    if ( mDecoderManifest == nullptr || !mDecoderManifest->build() )
+    // Documents received while the build thread is running arrive here already built
+    if ( mDecoderManifest == nullptr || !buildDocument( mDecoderManifest, TraceSection::MANAGER_DECODER_BUILD ) )
     {
         mLogger.error( "CollectionSchemeManager::processDecoderManifest",
                        " Failed to process the upcoming DecoderManifest." );
@@ -416,6 +521,7 @@ CollectionSchemeManager::processDecoderManifest()
     // store the new DM, update currentDecoderManifestID
     currentDecoderManifestID = mDecoderManifest->getID();
     store( DataType::DECODER_MANIFEST );
+    store( DataType::DECODER_MANIFEST_IMAGE );
     // when DM changes, check if we have collectionScheme loaded
     if ( isCollectionSchemeLoaded() )
     {
@@ -441,7 +547,8 @@ CollectionSchemeManager::processDecoderManifest()
 bool
 CollectionSchemeManager::processCollectionScheme()
 {
-    if ( mCollectionSchemeList == nullptr || !mCollectionSchemeList->build() )
+    if ( mCollectionSchemeList == nullptr ||
+         !buildDocument( mCollectionSchemeList, TraceSection::MANAGER_COLLECTION_BUILD ) )
     {
         mLogger.error( "CollectionSchemeManager::processCollectionScheme",
                        "Incoming CollectionScheme does not exist or fails to build!" );
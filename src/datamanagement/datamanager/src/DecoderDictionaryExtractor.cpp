@@ -14,7 +14,9 @@
 // Includes
 #include "CollectionSchemeManager.h"
 #include "TraceModule.h"
+#include <limits>
 #include <string>
+#include <unordered_set>
 #include <utility>
 
 namespace Aws
@@ -23,6 +25,35 @@ namespace IoTFleetWise
 {
 namespace DataManagement
 {
+namespace
+{
+/**
+ * @brief Collects the signals an expression depends on
+ * @param expression the expression, can be nullptr
+ * @param signalIDs the set the signals are added to
+ */
+void
+getConditionSignalIDs( const ExpressionNode *expression, std::unordered_set<SignalID> &signalIDs )
+{
+    if ( expression == nullptr )
+    {
+        return;
+    }
+    if ( ( expression->nodeType == ExpressionNodeType::SIGNAL ) ||
+         ( expression->nodeType == ExpressionNodeType::WINDOWFUNCTION ) )
+    {
+        signalIDs.insert( expression->signalID );
+    }
+    else if ( expression->nodeType == ExpressionNodeType::GEOHASHFUNCTION )
+    {
+        signalIDs.insert( expression->function.geohashFunction.latitudeSignalID );
+        signalIDs.insert( expression->function.geohashFunction.longitudeSignalID );
+    }
+    getConditionSignalIDs( expression->left, signalIDs );
+    getConditionSignalIDs( expression->right, signalIDs );
+}
+} // namespace
+
 constexpr std::array<VehicleDataSourceProtocol, 2> CollectionSchemeManager::SUPPORTED_NETWORK_PROTOCOL;
 void
 CollectionSchemeManager::decoderDictionaryExtractor(
@@ -206,6 +237,37 @@ CollectionSchemeManager::decoderDictionaryExtractor(
             decoderDictionaryMap.emplace( networkType, std::make_shared<CANDecoderDictionary>() );
         }
     }
+    // The signals used by the conditions of the highest priority collection schemes are never shed by the data
+    // sources when the signal buffer fills up, so these collection schemes can still trigger under load.
+    // A smaller value is a higher priority.
+    auto highestPriority = std::numeric_limits<uint32_t>::max();
+    std::unordered_set<SignalID> highPrioritySignalIDs;
+    for ( const auto &collectionScheme : mEnabledCollectionSchemeMap )
+    {
+        std::unordered_set<SignalID> conditionSignalIDs;
+        getConditionSignalIDs( collectionScheme.second->getCondition(), conditionSignalIDs );
+        if ( conditionSignalIDs.empty() || ( collectionScheme.second->getPriority() > highestPriority ) )
+        {
+            continue;
+        }
+        if ( collectionScheme.second->getPriority() < highestPriority )
+        {
+            highestPriority = collectionScheme.second->getPriority();
+            highPrioritySignalIDs.clear();
+        }
+        highPrioritySignalIDs.insert( conditionSignalIDs.begin(), conditionSignalIDs.end() );
+    }
+    for ( auto &decoderDictionary : decoderDictionaryMap )
+    {
+        for ( auto signalID : highPrioritySignalIDs )
+        {
+            if ( decoderDictionary.second->signalIDsToCollect.find( signalID ) !=
+                 decoderDictionary.second->signalIDsToCollect.end() )
+            {
+                decoderDictionary.second->highPrioritySignalIDs.insert( signalID );
+            }
+        }
+    }
 }
 
 // TODO: The collection scheme manager shall support generic decoder dictionary other than only can
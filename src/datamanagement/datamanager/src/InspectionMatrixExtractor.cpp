@@ -95,6 +95,7 @@ CollectionSchemeManager::addConditionData( const ICollectionSchemePtr &collectio
     // The rest
     conditionData.metaData.compress = collectionScheme->isCompressionNeeded();
     conditionData.metaData.persist = collectionScheme->isPersistNeeded();
+    conditionData.metaData.columnarEncoding = collectionScheme->isColumnarEncodingNeeded();
     conditionData.metaData.priority = collectionScheme->getPriority();
     conditionData.metaData.decoderID = collectionScheme->getDecoderManifestID();
     conditionData.metaData.collectionSchemeID = collectionScheme->getCollectionSchemeID();
@@ -13,6 +13,7 @@
 
 #include "CollectionSchemeManagerMock.h"
 #include "CollectionSchemeManagerTest.h"
+#include "DecoderManifestIngestion.h"
 #include <utility>
 
 using ::testing::_;
@@ -215,3 +216,50 @@ TEST( CollectionSchemeManagerTest2, StoreAndRetrieve )
     ret = std::system( "rm -rf ./testPersist" );
     ASSERT_FALSE( WIFEXITED( ret ) == 0 );
 }
+
+/** @brief
+ * This test validates that a retrieved decoder manifest is built from the persisted image of the stored one.
+ */
+TEST( CollectionSchemeManagerTest2, StoreAndRetrieveDecoderManifestImage )
+{
+    int ret = std::system( "mkdir ./testPersistImage" );
+    ASSERT_FALSE( WIFEXITED( ret ) == 0 );
+    auto testPersistency = std::make_shared<CacheAndPersist>( "./testPersistImage", 65536 );
+    ASSERT_TRUE( testPersistency->init() );
+
+    DecoderManifestMsg::DecoderManifest protoDM;
+    protoDM.set_arn( "DM1" );
+    auto *protoCANSignal = protoDM.add_can_signals();
+    protoCANSignal->set_signal_id( 1 );
+    protoCANSignal->set_interface_id( "can0" );
+    protoCANSignal->set_message_id( 0x100 );
+    protoCANSignal->set_start_bit( 8 );
+    protoCANSignal->set_factor( 1.0 );
+    protoCANSignal->set_length( 16 );
+    std::string protoSerializedBuffer;
+    ASSERT_TRUE( protoDM.SerializeToString( &protoSerializedBuffer ) );
+    auto storeDM = std::make_shared<DecoderManifestIngestion>();
+    ASSERT_TRUE( storeDM->copyData( reinterpret_cast<const uint8_t *>( protoSerializedBuffer.data() ),
+                                    protoSerializedBuffer.size() ) );
+    ASSERT_TRUE( storeDM->build() );
+
+    CollectionSchemeManagerTest testCollectionSchemeManager;
+    testCollectionSchemeManager.setCollectionSchemePersistency( testPersistency );
+    testCollectionSchemeManager.setDecoderManifest( storeDM );
+    testCollectionSchemeManager.store( DataType::DECODER_MANIFEST );
+    testCollectionSchemeManager.store( DataType::DECODER_MANIFEST_IMAGE );
+    ASSERT_GT( testPersistency->getSize( DataType::DECODER_MANIFEST_IMAGE ), 0 );
+
+    auto retrieveDM = std::make_shared<DecoderManifestIngestion>();
+    testCollectionSchemeManager.setDecoderManifest( retrieveDM );
+    ASSERT_TRUE( testCollectionSchemeManager.retrieve( DataType::DECODER_MANIFEST ) );
+    ASSERT_TRUE( retrieveDM->build() );
+    // The decoder manifest was built from the image, so there is no new image to store
+    ASSERT_TRUE( retrieveDM->compileImage().empty() );
+    ASSERT_EQ( retrieveDM->getID(), "DM1" );
+    ASSERT_EQ( retrieveDM->getCANFrameAndInterfaceID( 1 ), std::make_pair( 0x100U, std::string( "can0" ) ) );
+    ASSERT_EQ( retrieveDM->getCANMessageFormat( 0x100, "can0" ), storeDM->getCANMessageFormat( 0x100, "can0" ) );
+
+    ret = std::system( "rm -rf ./testPersistImage" );
+    ASSERT_FALSE( WIFEXITED( ret ) == 0 );
+}
@@ -225,3 +225,70 @@ TEST( CollectionSchemeManagerTest, MockProducerTest )
     std::this_thread::sleep_for( std::chrono::milliseconds( 200 ) );
     ASSERT_TRUE( test.disconnect() );
 }
+
+/** @brief
+ * This test validates that incoming documents are built off the main thread: while a DecoderManifest takes long to
+ * build, the main thread keeps sending checkins, and the DecoderManifest is activated once it is built.
+ */
+TEST( CollectionSchemeManagerTest, DocumentsBuiltOffMainThread )
+{
+    class SlowDecoderManifest : public IDecoderManifestTest
+    {
+    public:
+        SlowDecoderManifest( std::string id )
+            : IDecoderManifestTest( std::move( id ) )
+        {
+        }
+        bool
+        build() override
+        {
+            mBuilding = true;
+            while ( !mRelease )
+            {
+                std::this_thread::sleep_for( std::chrono::milliseconds( 10 ) );
+            }
+            return true;
+        }
+        std::atomic<bool> mBuilding{ false };
+        std::atomic<bool> mRelease{ false };
+    };
+    class CheckinCounter : public SchemaListener
+    {
+    public:
+        bool
+        sendCheckin( const std::vector<std::string> &documentARNs ) override
+        {
+            mDocumentARNs = documentARNs;
+            mCheckins++;
+            return true;
+        }
+        std::vector<std::string> mDocumentARNs;
+        std::atomic<unsigned> mCheckins{ 0 };
+    };
+
+    CollectionSchemeManagerTest test;
+    CANInterfaceIDTranslator canIDTranslator;
+    test.init( 50, nullptr, canIDTranslator );
+    test.myRegisterListener();
+    auto checkinCounter = std::make_shared<CheckinCounter>();
+    test.setSchemaListenerPtr( checkinCounter );
+    ASSERT_TRUE( test.connect() );
+
+    auto slowDM = std::make_shared<SlowDecoderManifest>( "DM1" );
+    test.mDmTest = slowDM;
+    test.myInvokeDecoderManifest();
+    while ( !slowDM->mBuilding )
+    {
+        std::this_thread::sleep_for( std::chrono::milliseconds( 10 ) );
+    }
+    unsigned checkinsBeforeBuild = checkinCounter->mCheckins;
+    std::this_thread::sleep_for( std::chrono::milliseconds( 300 ) );
+    // The main thread was not blocked by the build and kept checking in
+    ASSERT_GE( checkinCounter->mCheckins, checkinsBeforeBuild + 2 );
+
+    slowDM->mRelease = true;
+    std::this_thread::sleep_for( std::chrono::milliseconds( 200 ) );
+    ASSERT_TRUE( test.disconnect() );
+    // Checkins sent after the build report the new DecoderManifest
+    ASSERT_EQ( checkinCounter->mDocumentARNs, std::vector<std::string>{ "DM1" } );
+}
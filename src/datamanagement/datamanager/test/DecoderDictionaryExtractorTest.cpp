@@ -11,6 +11,7 @@
  * permissions and limitations under the License.
  */
 
+#include "CANDecodePlan.h"
 #include "CollectionSchemeManagerTest.h"
 
 /** @brief
@@ -636,3 +637,93 @@ TEST( CollectionSchemeManagerTest, DecoderDictionaryExtractorFirstRawFrameThenSi
     ASSERT_EQ( decoderMethod->second.find( 0x100 )->second.collectType, CANMessageCollectType::RAW_AND_DECODE );
     ASSERT_EQ( decoderMethod->second.find( 0x100 )->second.format.mSignals[0].mOffset, 17 );
 }
+
+/**
+ * @brief The signals used by the conditions of the collection schemes with the smallest priority value are marked as
+ * high priority. Collection schemes without signals in their condition are not taken into account.
+ */
+TEST( CollectionSchemeManagerTest, DecoderDictionaryExtractorHighPrioritySignals )
+{
+    CollectionSchemeManagerTest test( "DM1" );
+    CANInterfaceIDTranslator canIDTranslator;
+    canIDTranslator.add( "10" );
+    test.init( 0, nullptr, canIDTranslator );
+    TimePointInMsec currTime = ClockHandler::getClock()->timeSinceEpochMs();
+    TimePointInMsec stopTime = currTime + SECOND_TO_MILLISECOND( 5 );
+
+    std::unordered_map<SignalID, std::pair<CANRawFrameID, CANInterfaceID>> signalToFrameAndNodeID;
+    CANMessageFormat canMessageFormat0x100;
+    canMessageFormat0x100.mMessageID = 0x100;
+    canMessageFormat0x100.mSizeInBytes = 8;
+    for ( SignalID signalID = 1; signalID <= 4; signalID++ )
+    {
+        signalToFrameAndNodeID[signalID] = { 0x100, "10" };
+        CANSignalFormat sigFormat;
+        sigFormat.mSignalID = signalID;
+        canMessageFormat0x100.mSignals.emplace_back( sigFormat );
+    }
+    std::unordered_map<CANInterfaceID, std::unordered_map<CANRawFrameID, CANMessageFormat>> formatMap = {
+        { "10", { { 0x100, canMessageFormat0x100 } } } };
+
+    auto signals = []( std::vector<SignalID> signalIDs ) {
+        ICollectionScheme::Signals_t signalInfo;
+        for ( auto signalID : signalIDs )
+        {
+            SignalCollectionInfo signal;
+            signal.signalID = signalID;
+            signalInfo.emplace_back( signal );
+        }
+        return signalInfo;
+    };
+    // Condition: signal1 > signal2
+    ExpressionNode signal1;
+    signal1.nodeType = ExpressionNodeType::SIGNAL;
+    signal1.signalID = 1;
+    ExpressionNode signal2;
+    signal2.nodeType = ExpressionNodeType::SIGNAL;
+    signal2.signalID = 2;
+    ExpressionNode bigger;
+    bigger.nodeType = ExpressionNodeType::OPERATOR_BIGGER;
+    bigger.left = &signal1;
+    bigger.right = &signal2;
+    // Condition: signal3 > 1.0
+    ExpressionNode signal3;
+    signal3.nodeType = ExpressionNodeType::SIGNAL;
+    signal3.signalID = 3;
+    ExpressionNode value;
+    value.nodeType = ExpressionNodeType::FLOAT;
+    value.floatingValue = 1.0;
+    ExpressionNode bigger2;
+    bigger2.nodeType = ExpressionNodeType::OPERATOR_BIGGER;
+    bigger2.left = &signal3;
+    bigger2.right = &value;
+    // Condition: true
+    ExpressionNode alwaysTrue;
+    alwaysTrue.nodeType = ExpressionNodeType::BOOLEAN;
+    alwaysTrue.booleanValue = true;
+
+    std::vector<ICollectionSchemePtr> list1;
+    list1.emplace_back( std::make_shared<ICollectionSchemeTest>(
+        "COLLECTIONSCHEME1", "DM1", currTime, stopTime, signals( { 1, 2, 4 } ), &bigger, 1 ) );
+    list1.emplace_back( std::make_shared<ICollectionSchemeTest>(
+        "COLLECTIONSCHEME2", "DM1", currTime, stopTime, signals( { 3 } ), &bigger2, 5 ) );
+    list1.emplace_back( std::make_shared<ICollectionSchemeTest>(
+        "COLLECTIONSCHEME3", "DM1", currTime, stopTime, signals( { 4 } ), &alwaysTrue, 0 ) );
+
+    std::unordered_map<SignalID, PIDSignalDecoderFormat> signalIDToPIDDecoderFormat = {};
+    IDecoderManifestPtr DM1 =
+        std::make_shared<IDecoderManifestTest>( "DM1", formatMap, signalToFrameAndNodeID, signalIDToPIDDecoderFormat );
+    test.setDecoderManifest( DM1 );
+    test.setCollectionSchemeList( std::make_shared<ICollectionSchemeListTest>( list1 ) );
+    ASSERT_TRUE( test.updateMapsandTimeLine( currTime ) );
+    std::map<VehicleDataSourceProtocol, std::shared_ptr<CANDecoderDictionary>> decoderDictionaryMap;
+    test.decoderDictionaryExtractor( decoderDictionaryMap );
+
+    auto &canDictionary = decoderDictionaryMap[VehicleDataSourceProtocol::RAW_SOCKET];
+    ASSERT_EQ( canDictionary->signalIDsToCollect, std::unordered_set<SignalID>( { 1, 2, 3, 4 } ) );
+    ASSERT_EQ( canDictionary->highPrioritySignalIDs, std::unordered_set<SignalID>( { 1, 2 } ) );
+    ASSERT_TRUE( decoderDictionaryMap[VehicleDataSourceProtocol::OBD]->highPrioritySignalIDs.empty() );
+
+    auto plan = CANChannelDecodePlan::build( *canDictionary, canIDTranslator.getChannelNumericID( "10" ) );
+    ASSERT_EQ( plan->getHighPrioritySignalIDs(), canDictionary->highPrioritySignalIDs );
+}
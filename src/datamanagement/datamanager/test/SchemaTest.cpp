@@ -346,6 +346,106 @@ TEST( SchemaTest, DecoderManifestIngestion )
     ASSERT_EQ( testPIDM.getNetworkProtocol( 567 ), VehicleDataSourceProtocol::OBD );
 }
 
+/**
+ * @brief This test compiles the image of a built DecoderManifestIngestion and checks that a DecoderManifestIngestion
+ * built from the image returns the same decoding rules without parsing the proto, and that outdated or corrupted
+ * images are not used.
+ */
+TEST( SchemaTest, DecoderManifestImage )
+{
+    DecoderManifestMsg::DecoderManifest protoDM;
+    protoDM.set_arn( "arn:aws:iotfleetwise:us-west-2:123456789012:decoder-manifest/dm1" );
+    for ( uint32_t i = 0; i < 20; i++ )
+    {
+        DecoderManifestMsg::CANSignal *protoCANSignal = protoDM.add_can_signals();
+        protoCANSignal->set_signal_id( 1000 - ( i * 7 ) );
+        protoCANSignal->set_interface_id( ( i % 3 ) == 0 ? "can0" : "vcan1" );
+        protoCANSignal->set_message_id( 0x100 + ( i % 5 ) );
+        protoCANSignal->set_is_big_endian( ( i % 2 ) == 0 );
+        protoCANSignal->set_is_signed( ( i % 4 ) == 0 );
+        protoCANSignal->set_start_bit( i * 3 );
+        protoCANSignal->set_offset( -1.5 * i );
+        protoCANSignal->set_factor( 0.25 * ( i + 1 ) );
+        protoCANSignal->set_length( 1 + i );
+    }
+    DecoderManifestMsg::OBDPIDSignal *protoOBDPIDSignal = protoDM.add_obd_pid_signals();
+    protoOBDPIDSignal->set_signal_id( 567 );
+    protoOBDPIDSignal->set_pid_response_length( 4 );
+    protoOBDPIDSignal->set_service_mode( 1 );
+    protoOBDPIDSignal->set_pid( 0x14 );
+    protoOBDPIDSignal->set_scaling( 0.0125 );
+    protoOBDPIDSignal->set_offset( -40.0 );
+    protoOBDPIDSignal->set_start_byte( 2 );
+    protoOBDPIDSignal->set_byte_length( 2 );
+    protoOBDPIDSignal->set_bit_right_shift( 0 );
+    protoOBDPIDSignal->set_bit_mask_length( 8 );
+    std::string protoSerializedBuffer;
+    ASSERT_TRUE( protoDM.SerializeToString( &protoSerializedBuffer ) );
+
+    DecoderManifestIngestion protoBuiltDM;
+    ASSERT_TRUE( protoBuiltDM.copyData( reinterpret_cast<const uint8_t *>( protoSerializedBuffer.data() ),
+                                        protoSerializedBuffer.size() ) );
+    ASSERT_TRUE( protoBuiltDM.compileImage().empty() );
+    ASSERT_TRUE( protoBuiltDM.build() );
+    auto imageData = std::make_shared<const std::vector<uint8_t>>( protoBuiltDM.compileImage() );
+    ASSERT_FALSE( imageData->empty() );
+    auto image = std::make_shared<DecoderManifestImage>();
+    ASSERT_TRUE( image->init( imageData->data(), imageData->size(), imageData ) );
+    ASSERT_EQ( image->getID(), protoDM.arn() );
+
+    DecoderManifestIngestion imageBuiltDM;
+    ASSERT_TRUE( imageBuiltDM.copyData( reinterpret_cast<const uint8_t *>( protoSerializedBuffer.data() ),
+                                        protoSerializedBuffer.size() ) );
+    imageBuiltDM.setImage( image );
+    ASSERT_TRUE( imageBuiltDM.build() );
+    // There is nothing new to compile for a decoder manifest built from an up to date image
+    ASSERT_TRUE( imageBuiltDM.compileImage().empty() );
+    ASSERT_EQ( imageBuiltDM.getID(), protoDM.arn() );
+    for ( int i = 0; i < protoDM.can_signals_size(); i++ )
+    {
+        const auto &protoCANSignal = protoDM.can_signals( i );
+        ASSERT_EQ( imageBuiltDM.getNetworkProtocol( protoCANSignal.signal_id() ),
+                   VehicleDataSourceProtocol::RAW_SOCKET );
+        ASSERT_EQ( imageBuiltDM.getCANFrameAndInterfaceID( protoCANSignal.signal_id() ),
+                   std::make_pair( protoCANSignal.message_id(), protoCANSignal.interface_id() ) );
+        const auto &format =
+            imageBuiltDM.getCANMessageFormat( protoCANSignal.message_id(), protoCANSignal.interface_id() );
+        ASSERT_TRUE( format.isValid() );
+        ASSERT_EQ( format,
+                   protoBuiltDM.getCANMessageFormat( protoCANSignal.message_id(), protoCANSignal.interface_id() ) );
+    }
+    ASSERT_EQ( imageBuiltDM.getNetworkProtocol( 567 ), VehicleDataSourceProtocol::OBD );
+    ASSERT_EQ( imageBuiltDM.getPIDSignalDecoderFormat( 567 ), protoBuiltDM.getPIDSignalDecoderFormat( 567 ) );
+    ASSERT_EQ( imageBuiltDM.getNetworkProtocol( 999999 ), VehicleDataSourceProtocol::INVALID_PROTOCOL );
+    ASSERT_EQ( imageBuiltDM.getCANFrameAndInterfaceID( 567 ),
+               std::make_pair( INVALID_CAN_FRAME_ID, INVALID_CAN_INTERFACE_ID ) );
+    ASSERT_EQ( imageBuiltDM.getPIDSignalDecoderFormat( 1000 ), NOT_FOUND_PID_DECODER_FORMAT );
+    ASSERT_FALSE( imageBuiltDM.getCANMessageFormat( 0x100, "can2" ).isValid() );
+    ASSERT_FALSE( imageBuiltDM.getCANMessageFormat( 0x200, "can0" ).isValid() );
+
+    // An image of another version of the decoder manifest is not used
+    protoDM.set_arn( "arn:aws:iotfleetwise:us-west-2:123456789012:decoder-manifest/dm2" );
+    ASSERT_TRUE( protoDM.SerializeToString( &protoSerializedBuffer ) );
+    DecoderManifestIngestion newDM;
+    ASSERT_TRUE( newDM.copyData( reinterpret_cast<const uint8_t *>( protoSerializedBuffer.data() ),
+                                 protoSerializedBuffer.size() ) );
+    newDM.setImage( image );
+    ASSERT_TRUE( newDM.build() );
+    ASSERT_EQ( newDM.getID(), protoDM.arn() );
+    ASSERT_FALSE( newDM.compileImage().empty() );
+
+    // Truncated, corrupted and images of other versions are rejected
+    DecoderManifestImage invalidImage;
+    ASSERT_FALSE( invalidImage.init( imageData->data(), imageData->size() - 8, nullptr ) );
+    ASSERT_FALSE( invalidImage.init( imageData->data(), 16, nullptr ) );
+    std::vector<uint8_t> corruptedImage = *imageData;
+    corruptedImage[4]++;
+    ASSERT_FALSE( invalidImage.init( corruptedImage.data(), corruptedImage.size(), nullptr ) );
+    corruptedImage = *imageData;
+    corruptedImage[24]++;
+    ASSERT_FALSE( invalidImage.init( corruptedImage.data(), corruptedImage.size(), nullptr ) );
+}
+
 /**
  * @brief This test writes an invalid DecoderManifest object to a protobuf binary array. The decoder manifest doesn't
  * contain CAN Node, CAN Signal, OBD Signal. When CollectionScheme Ingestion start building, it will return failure due
@@ -439,6 +539,48 @@ TEST( SchemaTest, CollectionSchemeIngestionList )
     ASSERT_EQ( testPIPL.getCollectionSchemes().size(), 0 );
 }
 
+/**
+ * @brief This test builds a CollectionScheme List large enough to be built by several threads, and checks that all
+ * valid collectionSchemes are built and kept in the order of the list.
+ */
+TEST( SchemaTest, CollectionSchemeIngestionListBuiltInParallel )
+{
+    CollectionSchemesMsg::CollectionSchemes protoCollectionSchemesMsg;
+    std::vector<std::string> expectedCollectionSchemeIDs;
+    for ( int i = 0; i < 100; i++ )
+    {
+        auto collectionScheme = protoCollectionSchemesMsg.add_collection_schemes();
+        std::string id = "P" + std::to_string( i );
+        collectionScheme->set_campaign_arn( id );
+        collectionScheme->set_start_time_ms_epoch( 1621448160000 );
+        collectionScheme->set_expiry_time_ms_epoch( 2621448160000 );
+        collectionScheme->mutable_time_based_collection_scheme()->set_time_based_collection_scheme_period_ms( 5000 );
+        // Every seventh collectionScheme has no decoder manifest and fails to build
+        if ( ( i % 7 ) != 0 )
+        {
+            collectionScheme->set_decoder_manifest_arn( "DM1" );
+            expectedCollectionSchemeIDs.emplace_back( id );
+        }
+    }
+    std::string protoSerializedBuffer;
+    ASSERT_TRUE( protoCollectionSchemesMsg.SerializeToString( &protoSerializedBuffer ) );
+
+    CollectionSchemeIngestionList testPIPL;
+    ASSERT_TRUE( testPIPL.copyData( reinterpret_cast<const uint8_t *>( protoSerializedBuffer.data() ),
+                                    protoSerializedBuffer.length() ) );
+    ASSERT_TRUE( testPIPL.build() );
+    ASSERT_TRUE( testPIPL.isReady() );
+
+    auto &collectionSchemes = testPIPL.getCollectionSchemes();
+    ASSERT_EQ( collectionSchemes.size(), expectedCollectionSchemeIDs.size() );
+    for ( size_t i = 0; i < collectionSchemes.size(); i++ )
+    {
+        ASSERT_TRUE( collectionSchemes[i]->isReady() );
+        ASSERT_EQ( collectionSchemes[i]->getCollectionSchemeID(), expectedCollectionSchemeIDs[i] );
+        ASSERT_EQ( collectionSchemes[i]->getDecoderManifestID(), "DM1" );
+    }
+}
+
 TEST( SchemaTest, CollectionSchemeIngestionHeartBeat )
 {
     // Create a  collection scheme Proto Message
@@ -457,6 +599,7 @@ TEST( SchemaTest, CollectionSchemeIngestionHeartBeat )
     collectionSchemeTestMessage.set_include_active_dtcs( true );
     collectionSchemeTestMessage.set_persist_all_collected_data( true );
     collectionSchemeTestMessage.set_compress_collected_data( true );
+    collectionSchemeTestMessage.set_signal_encoding( CollectionSchemesMsg::CollectionScheme::COLUMNAR_SIGNAL_ENCODING );
     collectionSchemeTestMessage.set_priority( 9 );
 
     // Add 3 Signals
@@ -518,6 +661,7 @@ TEST( SchemaTest, CollectionSchemeIngestionHeartBeat )
     ASSERT_TRUE( collectionSchemeTest.getCollectRawCanFrames().size() == 0 );
     ASSERT_TRUE( collectionSchemeTest.isPersistNeeded() == false );
     ASSERT_TRUE( collectionSchemeTest.isCompressionNeeded() == false );
+    ASSERT_TRUE( collectionSchemeTest.isColumnarEncodingNeeded() == false );
     ASSERT_TRUE( collectionSchemeTest.getPriority() == std::numeric_limits<uint32_t>::max() );
     ASSERT_TRUE( collectionSchemeTest.getCondition() == nullptr );
     ASSERT_TRUE( collectionSchemeTest.getMinimumPublishIntervalMs() == std::numeric_limits<uint32_t>::max() );
@@ -573,6 +717,7 @@ TEST( SchemaTest, CollectionSchemeIngestionHeartBeat )
 
     ASSERT_TRUE( collectionSchemeTest.isPersistNeeded() == true );
     ASSERT_TRUE( collectionSchemeTest.isCompressionNeeded() == true );
+    ASSERT_TRUE( collectionSchemeTest.isColumnarEncodingNeeded() == true );
     ASSERT_TRUE( collectionSchemeTest.getPriority() == 9 );
     // For time based collectionScheme the condition is always set to true hence: currentNode.booleanValue=true
     ASSERT_TRUE( collectionSchemeTest.getCondition()->booleanValue == true );
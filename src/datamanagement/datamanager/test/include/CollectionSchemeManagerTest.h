@@ -171,6 +171,22 @@ public:
         , root( root )
     {
     }
+    ICollectionSchemeTest( std::string collectionSchemeID,
+                           std::string DMID,
+                           uint64_t start,
+                           uint64_t stop,
+                           Signals_t signalsIn,
+                           ExpressionNode *root,
+                           uint32_t priority )
+        : collectionSchemeID( collectionSchemeID )
+        , decoderManifestID( DMID )
+        , startTime( start )
+        , expiryTime( stop )
+        , signals( signalsIn )
+        , root( root )
+        , priority( priority )
+    {
+    }
     const std::string &
     getCollectionSchemeID() const
     {
@@ -211,6 +227,11 @@ public:
     {
         return root;
     }
+    uint32_t
+    getPriority() const override
+    {
+        return priority;
+    }
     bool
     build() override
     {
@@ -226,6 +247,7 @@ private:
     RawCanFrames_t rawCanFrms;
     ImagesDataType imagesData;
     ExpressionNode *root;
+    uint32_t priority{ 0 };
 };
 
 class ICollectionSchemeListTest : public CollectionSchemeIngestionList
@@ -49,9 +49,14 @@ struct CANFrameInfo
     std::vector<CANDecodedSignal> mSignals;
 };
 /**
- * @brief Cloud does not send information about each CAN message, so we set every CAN message size to the maximum.
+ * @brief Cloud does not send information about each CAN message, so we set every CAN message size to the maximum,
+ * which is the payload size of a CAN FD frame.
  */
-static constexpr uint8_t MAX_CAN_FRAME_BYTE_SIZE = 8;
+static constexpr uint8_t MAX_CAN_FRAME_BYTE_SIZE = 64;
+/**
+ * @brief Maximum payload size of a classic CAN frame
+ */
+static constexpr uint8_t MAX_CLASSIC_CAN_FRAME_BYTE_SIZE = 8;
 
 struct CANDecodedMessage
 {
@@ -14,11 +14,14 @@
 
 #include "CANDataTypes.h"
 #include "EventTypes.h"
+#include "FanInBuffer.h"
 #include "GeohashInfo.h"
 #include "MessageTypes.h"
 #include "OBDDataTypes.h"
 #include "SensorTypes.h"
 #include "SignalTypes.h"
+#include <algorithm>
+#include <array>
 // multi producer queue:
 #include <boost/lockfree/queue.hpp>
 // single producer queue:
@@ -39,7 +42,7 @@ namespace DataInspection
 {
 using namespace Aws::IoTFleetWise::DataManagement;
 
-static constexpr uint32_t MAX_NUMBER_OF_ACTIVE_CONDITION = 256; /**< More active conditions will be ignored */
+static constexpr uint32_t MAX_NUMBER_OF_ACTIVE_CONDITION = 10000; /**< More active conditions will be ignored */
 static constexpr uint32_t ALL_CONDITIONS = 0xFFFFFFFF;
 static constexpr uint32_t MAX_EQUATION_DEPTH =
     10; /**< If the AST of the expression is deeper than this value the equation is not accepted */
@@ -58,6 +61,7 @@ struct PassThroughMetaData
 {
     bool compress{ false };
     bool persist{ false };
+    bool columnarEncoding{ false };
     uint32_t priority{ 0 };
     std::string decoderID;
     std::string collectionSchemeID;
@@ -146,6 +150,18 @@ struct CollectedCanRawFrame
         , size( sizeIn )
     {
     }
+    CollectedCanRawFrame( CANRawFrameID frameIDIn,
+                          CANChannelNumericID channelIdIn,
+                          Timestamp receiveTimeIn,
+                          const uint8_t *dataIn,
+                          uint8_t sizeIn )
+        : frameID( frameIDIn )
+        , channelId( channelIdIn )
+        , receiveTime( receiveTimeIn )
+        , size( std::min( sizeIn, MAX_CAN_FRAME_BYTE_SIZE ) )
+    {
+        std::copy( dataIn, dataIn + size, data.begin() );
+    }
     CANRawFrameID frameID{ INVALID_CAN_FRAME_ID };
     CANChannelNumericID channelId{ INVALID_CAN_SOURCE_NUMERIC_ID };
     Timestamp receiveTime{ 0 };
@@ -180,9 +196,9 @@ struct CollectedSignal
 };
 
 using SignalBuffer =
-    boost::lockfree::queue<CollectedSignal>; /**<  multi NetworkChannel Consumers fill this queue and only one instance
-                                                of the Inspection and Collection Engine consumes it. It is used for Can
-                                                and OBD based signals */
+    FanInBuffer<CollectedSignal>; /**<  multi NetworkChannel Consumers fill this queue, each through its own lane, and
+                                     only one instance of the Inspection and Collection Engine consumes it. It is used
+                                     for Can and OBD based signals */
 using CANBuffer =
     boost::lockfree::queue<CollectedCanRawFrame>; /**<  contains only raw can messages which at least one
                                                      collectionScheme needs to publish in a raw format. multi
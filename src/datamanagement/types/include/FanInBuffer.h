@@ -0,0 +1,252 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <boost/lockfree/spsc_queue.hpp>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace DataInspection
+{
+
+/**
+ * @brief Queue with many producers and a single consumer, built from one single producer single consumer ring buffer
+ * (lane) per producer. The consumer drains the lanes round robin.
+ *
+ * Producers that run on their own thread should get their own lane with createLane() and push to it. Pushing to an
+ * own lane does not need any compare and swap loop and does not share cache lines with other producers. The push
+ * functions of the queue itself use a shared lane guarded by a mutex, so they can be called from any thread.
+ *
+ * The order of the elements is kept per lane, but not across lanes.
+ */
+template <typename T>
+class FanInBuffer
+{
+public:
+    /**
+     * @brief Maximum number of lanes including the shared lane. If more lanes are requested, the shared lane is
+     * handed out.
+     */
+    static constexpr size_t MAX_LANES = 32;
+
+    /**
+     * @brief Lane of a single producer
+     */
+    class Lane
+    {
+    public:
+        Lane( size_t capacity, std::mutex *mutex )
+            : mQueue( capacity )
+            , mCapacity( capacity )
+            , mMutex( mutex )
+        {
+        }
+
+        /**
+         * @brief Pushes an element to the lane. Must only be called from the thread owning the lane.
+         * @return True if the element was pushed, false if the lane is full
+         */
+        bool
+        push( const T &element )
+        {
+            if ( mMutex != nullptr )
+            {
+                std::lock_guard<std::mutex> lock( *mMutex );
+                return mQueue.push( element );
+            }
+            return mQueue.push( element );
+        }
+
+        /**
+         * @brief Pushes as many elements of an array as fit into the lane. Must only be called from the thread owning
+         * the lane.
+         * @return Number of elements pushed
+         */
+        size_t
+        push( const T *elements, size_t count )
+        {
+            if ( mMutex != nullptr )
+            {
+                std::lock_guard<std::mutex> lock( *mMutex );
+                return mQueue.push( elements, count );
+            }
+            return mQueue.push( elements, count );
+        }
+
+        /**
+         * @brief How full the lane is, used by producers for backpressure. Must only be called from the thread owning
+         * the lane.
+         * @return Filled part of the lane in percent, between 0 and 100
+         */
+        size_t
+        fillPercent() const
+        {
+            if ( mCapacity == 0 )
+            {
+                return 100;
+            }
+            size_t writeAvailable = 0;
+            if ( mMutex != nullptr )
+            {
+                std::lock_guard<std::mutex> lock( *mMutex );
+                writeAvailable = mQueue.write_available();
+            }
+            else
+            {
+                writeAvailable = mQueue.write_available();
+            }
+            return ( ( mCapacity - std::min( writeAvailable, mCapacity ) ) * 100 ) / mCapacity;
+        }
+
+    private:
+        friend class FanInBuffer;
+
+        boost::lockfree::spsc_queue<T> mQueue;
+        size_t mCapacity;
+        // Only set for the shared lane
+        std::mutex *mMutex;
+    };
+
+    /**
+     * @param capacity number of elements each lane can hold
+     */
+    explicit FanInBuffer( size_t capacity )
+        : mCapacity( capacity )
+    {
+        mLanes[0].reset( new Lane( capacity, &mSharedLaneMutex ) );
+    }
+
+    ~FanInBuffer() = default;
+    FanInBuffer( const FanInBuffer & ) = delete;
+    FanInBuffer &operator=( const FanInBuffer & ) = delete;
+    FanInBuffer( FanInBuffer && ) = delete;
+    FanInBuffer &operator=( FanInBuffer && ) = delete;
+
+    /**
+     * @brief Creates the lane of a producer. Can be called from any thread. The lane lives as long as the queue.
+     * @return the new lane, or the shared lane if MAX_LANES is reached
+     */
+    Lane *
+    createLane()
+    {
+        std::lock_guard<std::mutex> lock( mCreateLaneMutex );
+        auto laneCount = mLaneCount.load( std::memory_order_relaxed );
+        if ( laneCount >= MAX_LANES )
+        {
+            return mLanes[0].get();
+        }
+        mLanes[laneCount].reset( new Lane( mCapacity, nullptr ) );
+        // The consumer only looks at lanes below the count, so the lane must be complete before the count is stored
+        mLaneCount.store( laneCount + 1, std::memory_order_release );
+        return mLanes[laneCount].get();
+    }
+
+    /**
+     * @brief Pushes an element to the shared lane. Can be called from any thread.
+     * @return True if the element was pushed, false if the shared lane is full
+     */
+    bool
+    push( const T &element )
+    {
+        return mLanes[0]->push( element );
+    }
+
+    /**
+     * @brief Pushes as many elements of an array as fit into the shared lane. Can be called from any thread.
+     * @return Number of elements pushed
+     */
+    size_t
+    push( const T *elements, size_t count )
+    {
+        return mLanes[0]->push( elements, count );
+    }
+
+    /**
+     * @brief Pops one element. Must only be called from the consumer thread.
+     * @return True if an element was popped, false if all lanes are empty
+     */
+    bool
+    pop( T &element )
+    {
+        return pop( &element, 1 ) == 1;
+    }
+
+    /**
+     * @brief Pops up to maxCount elements. The lanes are drained one after the other, starting with a different lane
+     * on every call, so that a busy producer cannot starve the others. Must only be called from the consumer thread.
+     * @return Number of elements popped
+     */
+    size_t
+    pop( T *elements, size_t maxCount )
+    {
+        auto laneCount = mLaneCount.load( std::memory_order_acquire );
+        size_t count = 0;
+        for ( size_t i = 0; ( i < laneCount ) && ( count < maxCount ); i++ )
+        {
+            auto &lane = *mLanes[( mNextLane + i ) % laneCount];
+            count += lane.mQueue.pop( elements + count, maxCount - count );
+        }
+        mNextLane = ( mNextLane + 1 ) % laneCount;
+        return count;
+    }
+
+    /**
+     * @brief Checks if all lanes are empty. Must only be called from the consumer thread.
+     */
+    bool
+    empty() const
+    {
+        return sizeApprox() == 0;
+    }
+
+    /**
+     * @brief Number of elements in all lanes. As the producers keep pushing while the lanes are summed up, the result
+     * is only approximate. Must only be called from the consumer thread.
+     */
+    size_t
+    sizeApprox() const
+    {
+        auto laneCount = mLaneCount.load( std::memory_order_acquire );
+        size_t size = 0;
+        for ( size_t i = 0; i < laneCount; i++ )
+        {
+            size += mLanes[i]->mQueue.read_available();
+        }
+        return size;
+    }
+
+private:
+    size_t mCapacity;
+    std::array<std::unique_ptr<Lane>, MAX_LANES> mLanes;
+    std::atomic<size_t> mLaneCount{ 1 };
+    std::mutex mSharedLaneMutex;
+    std::mutex mCreateLaneMutex;
+    // Only used by the consumer
+    size_t mNextLane{ 0 };
+};
+
+template <typename T>
+constexpr size_t FanInBuffer<T>::MAX_LANES;
+
+} // namespace DataInspection
+} // namespace IoTFleetWise
+} // namespace Aws
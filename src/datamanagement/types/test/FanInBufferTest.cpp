@@ -0,0 +1,151 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include "FanInBuffer.h"
+#include <algorithm>
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+
+using namespace Aws::IoTFleetWise::DataInspection;
+
+/** @brief Elements pushed to the shared lane are popped in order, and a full lane rejects further elements */
+TEST( FanInBufferTest, SharedLane )
+{
+    FanInBuffer<int> buffer( 3 );
+    ASSERT_TRUE( buffer.empty() );
+    int element = 0;
+    ASSERT_FALSE( buffer.pop( element ) );
+
+    ASSERT_TRUE( buffer.push( 1 ) );
+    ASSERT_TRUE( buffer.push( 2 ) );
+    ASSERT_TRUE( buffer.push( 3 ) );
+    ASSERT_FALSE( buffer.push( 4 ) );
+    ASSERT_EQ( buffer.sizeApprox(), 3 );
+
+    for ( int i = 1; i <= 3; i++ )
+    {
+        ASSERT_TRUE( buffer.pop( element ) );
+        ASSERT_EQ( element, i );
+    }
+    ASSERT_TRUE( buffer.empty() );
+}
+
+/** @brief Batches are pushed as far as they fit, and are popped from all lanes */
+TEST( FanInBufferTest, BatchPushAndPop )
+{
+    FanInBuffer<int> buffer( 4 );
+    auto lane1 = buffer.createLane();
+    auto lane2 = buffer.createLane();
+    ASSERT_NE( lane1, lane2 );
+    ASSERT_EQ( lane1->fillPercent(), 0 );
+
+    std::vector<int> elements = { 10, 11, 12, 13, 14, 15 };
+    ASSERT_EQ( lane1->push( elements.data(), elements.size() ), 4 );
+    ASSERT_EQ( lane2->push( elements.data(), 2 ), 2 );
+    ASSERT_EQ( lane1->fillPercent(), 100 );
+    ASSERT_EQ( lane2->fillPercent(), 50 );
+    ASSERT_EQ( buffer.push( elements.data(), 1 ), 1 );
+    ASSERT_EQ( buffer.sizeApprox(), 7 );
+
+    std::vector<int> popped( 10 );
+    ASSERT_EQ( buffer.pop( popped.data(), 3 ), 3 );
+    ASSERT_EQ( buffer.pop( popped.data() + 3, 7 ), 4 );
+    ASSERT_TRUE( buffer.empty() );
+    popped.resize( 7 );
+    std::sort( popped.begin(), popped.end() );
+    ASSERT_EQ( popped, std::vector<int>( { 10, 10, 10, 11, 11, 12, 13 } ) );
+}
+
+/** @brief A producer that fills its lane does not starve the other producers */
+TEST( FanInBufferTest, LanesAreDrainedRoundRobin )
+{
+    FanInBuffer<int> buffer( 100 );
+    auto busyLane = buffer.createLane();
+    auto quietLane = buffer.createLane();
+    for ( int i = 0; i < 100; i++ )
+    {
+        ASSERT_TRUE( busyLane->push( 1 ) );
+    }
+    ASSERT_TRUE( quietLane->push( 2 ) );
+
+    int element = 0;
+    bool quietElementPopped = false;
+    for ( int i = 0; i < 3; i++ )
+    {
+        ASSERT_TRUE( buffer.pop( element ) );
+        quietElementPopped |= ( element == 2 );
+    }
+    ASSERT_TRUE( quietElementPopped );
+}
+
+/** @brief When all lanes are taken, the shared lane is handed out */
+TEST( FanInBufferTest, SharedLaneWhenAllLanesTaken )
+{
+    FanInBuffer<int> buffer( 2 );
+    for ( size_t i = 1; i < FanInBuffer<int>::MAX_LANES; i++ )
+    {
+        ASSERT_TRUE( buffer.createLane()->push( static_cast<int>( i ) ) );
+    }
+    auto lane = buffer.createLane();
+    ASSERT_TRUE( lane->push( 100 ) );
+    ASSERT_TRUE( buffer.push( 101 ) );
+    // The shared lane is full now
+    ASSERT_FALSE( lane->push( 102 ) );
+    ASSERT_EQ( buffer.sizeApprox(), FanInBuffer<int>::MAX_LANES + 1 );
+}
+
+/** @brief Several producer threads push through their own lanes and the shared lane while one consumer drains them.
+ * No element is lost and the order of each producer is kept.
+ */
+TEST( FanInBufferTest, ConcurrentProducers )
+{
+    constexpr int NUM_PRODUCERS = 4;
+    constexpr int ELEMENTS_PER_PRODUCER = 20000;
+    FanInBuffer<std::pair<int, int>> buffer( 1000 );
+    std::vector<std::thread> producers;
+    for ( int producer = 0; producer <= NUM_PRODUCERS; producer++ )
+    {
+        producers.emplace_back( [&buffer, producer]() {
+            // The last producer uses the shared lane
+            auto lane = producer < NUM_PRODUCERS ? buffer.createLane() : nullptr;
+            for ( int i = 0; i < ELEMENTS_PER_PRODUCER; i++ )
+            {
+                auto element = std::make_pair( producer, i );
+                while ( !( lane != nullptr ? lane->push( element ) : buffer.push( element ) ) )
+                {
+                    std::this_thread::yield();
+                }
+            }
+        } );
+    }
+
+    std::vector<int> nextElement( NUM_PRODUCERS + 1, 0 );
+    std::vector<std::pair<int, int>> batch( 64 );
+    int received = 0;
+    while ( received < ( NUM_PRODUCERS + 1 ) * ELEMENTS_PER_PRODUCER )
+    {
+        auto count = buffer.pop( batch.data(), batch.size() );
+        for ( size_t i = 0; i < count; i++ )
+        {
+            ASSERT_EQ( batch[i].second, nextElement[batch[i].first] );
+            nextElement[batch[i].first]++;
+        }
+        received += static_cast<int>( count );
+    }
+    for ( auto &producer : producers )
+    {
+        producer.join();
+    }
+    ASSERT_TRUE( buffer.empty() );
+}
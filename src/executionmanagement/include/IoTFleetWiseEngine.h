@@ -30,12 +30,14 @@
 #include "LoggingModule.h"
 #include "OBDOverCANModule.h"
 #include "RemoteProfiler.h"
+#include "ReplayClock.h"
 #include "Schema.h"
 #include "Signal.h"
 #include "Thread.h"
 #include "Timer.h"
 #include "VehicleDataSourceBinder.h"
 #include "businterfaces/AbstractVehicleDataSource.h"
+#include "businterfaces/CANMultiBusReader.h"
 #include <atomic>
 #include <json/json.h>
 #include <map>
@@ -140,7 +142,11 @@ private:
 
     LoggingModule mLogger;
     std::shared_ptr<const Clock> mClock = ClockHandler::getClock();
+    // Clock driven by the replayed frames, only set if a CAN log file is replayed
+    std::shared_ptr<ReplayClock> mReplayClock;
     std::unique_ptr<VehicleDataSourceBinder> mVehicleDataSourceBinder;
+    // Threads that read all CAN interfaces, empty if each interface is read by an own thread
+    std::vector<std::shared_ptr<CANMultiBusReader>> mCANMultiBusReaders;
     CollectionSchemePtr mCollectionScheme;
 
     std::shared_ptr<OBDOverCANModule> mOBDOverCANModule;
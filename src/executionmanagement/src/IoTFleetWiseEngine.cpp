@@ -20,6 +20,7 @@
 #include "TraceModule.h"
 #include "businterfaces/AbstractVehicleDataSource.h"
 #include "businterfaces/CANDataSource.h"
+#include "businterfaces/CANLogFileDataSource.h"
 #include <boost/lockfree/spsc_queue.hpp>
 
 namespace Aws
@@ -39,6 +40,7 @@ const uint64_t IoTFleetWiseEngine::DEFAULT_RETRY_UPLOAD_PERSISTED_INTERVAL_MS =
 
 static const std::string CAN_INTERFACE_TYPE = "canInterface";
 static const std::string OBD_INTERFACE_TYPE = "obdInterface";
+static const std::string CAN_LOG_FILE_INTERFACE_TYPE = "canLogFileInterface";
 
 namespace
 {
@@ -106,6 +108,18 @@ IoTFleetWiseEngine::connect( const Json::Value &config )
     // Main bootstrap sequence.
     try
     {
+        // When CAN log files are replayed, the replay clock has to be installed before any module caches the
+        // clock, so that all modules see the recorded time of the replayed frames
+        for ( const auto &interfaceName : config["networkInterfaces"] )
+        {
+            if ( ( interfaceName["type"].asString() == CAN_LOG_FILE_INTERFACE_TYPE ) && ( mReplayClock == nullptr ) )
+            {
+                mReplayClock = std::make_shared<ReplayClock>();
+                ClockHandler::setClock( mReplayClock );
+                mClock = mReplayClock;
+            }
+        }
+
         const auto persistencyPath = config["staticConfig"]["persistency"]["persistencyPath"].asString();
         /*************************Payload Manager and Persistency library bootstrap begin*********/
 
@@ -125,8 +139,26 @@ IoTFleetWiseEngine::connect( const Json::Value &config )
         {
             mPersistencyUploadRetryIntervalMs = DEFAULT_RETRY_UPLOAD_PERSISTED_INTERVAL_MS;
         }
+        // Codec the payloads are compressed with if a collection scheme requests compression. Persisted
+        // payloads record the codec they were compressed with, so they stay readable if it is changed.
+        const auto &publishToCloudParameters = config["staticConfig"]["publishToCloudParameters"];
+        std::string compressionDictionaryFilename;
+        if ( publishToCloudParameters.isMember( "compressionDictionaryFilename" ) )
+        {
+            compressionDictionaryFilename =
+                persistencyPath + "/" + publishToCloudParameters["compressionDictionaryFilename"].asString();
+        }
+        auto payloadCodec = std::make_shared<PayloadCodec>();
+        if ( !payloadCodec->init( publishToCloudParameters.get( "compressionCodec", "snappy" ).asString(),
+                                  publishToCloudParameters.get( "compressionLevel", 3 ).asInt(),
+                                  compressionDictionaryFilename ) )
+        {
+            mLogger.error( "IoTFleetWiseEngine::connect", " Failed to init the payload compression codec " );
+            return false;
+        }
         // Payload Manager for offline data management
-        mPayloadManager = std::make_shared<PayloadManager>( mPersistDecoderManifestCollectionSchemesAndData );
+        mPayloadManager =
+            std::make_shared<PayloadManager>( mPersistDecoderManifestCollectionSchemesAndData, payloadCodec );
 
         /*************************Payload Manager and Persistency library bootstrap end************/
 
@@ -136,7 +168,8 @@ IoTFleetWiseEngine::connect( const Json::Value &config )
         // Initialize
         for ( const auto &interfaceName : config["networkInterfaces"] )
         {
-            if ( interfaceName["type"].asString() == CAN_INTERFACE_TYPE )
+            if ( ( interfaceName["type"].asString() == CAN_INTERFACE_TYPE ) ||
+                 ( interfaceName["type"].asString() == CAN_LOG_FILE_INTERFACE_TYPE ) )
             {
                 canIDTranslator.add( interfaceName["interfaceId"].asString() );
             }
@@ -193,7 +226,9 @@ IoTFleetWiseEngine::connect( const Json::Value &config )
             config["staticConfig"]["internalParameters"]["useJsonBasedCollection"].asBool(),
             config["staticConfig"]["publishToCloudParameters"]["maxPublishMessageCount"].asUInt(),
             canIDTranslator,
-            persistencyPath );
+            persistencyPath,
+            config["staticConfig"]["publishToCloudParameters"]["maxPublishPayloadSizeBytes"].asUInt(),
+            payloadCodec );
 
         // Pass on the AWS SDK Bootsrap handle to the IoTModule.
         auto bootstrapPtr = AwsBootstrap::getInstance().getClientBootStrap();
@@ -281,7 +316,10 @@ IoTFleetWiseEngine::connect( const Json::Value &config )
                  activeDTCBufferPtr,
                  mCollectedDataReadyToPublish,
                  config["staticConfig"]["threadIdleTimes"]["inspectionThreadIdleTimeMs"].asUInt(),
-                 config["staticConfig"]["internalParameters"]["dataReductionProbabilityDisabled"].asBool() ) ||
+                 config["staticConfig"]["internalParameters"]["dataReductionProbabilityDisabled"].asBool(),
+                 config["staticConfig"]["internalParameters"]["inspectionBatchSize"].asUInt(),
+                 config["staticConfig"]["internalParameters"]["inspectionBatchMaxLatencyMs"].asUInt(),
+                 config["staticConfig"]["internalParameters"]["inspectionShards"].asUInt() ) ||
              !mCollectionInspectionWorkerThread->start() )
         {
             mLogger.error( "IoTFleetWiseEngine::connect", " Failed to init and start the Inspection Engine " );
@@ -376,6 +414,21 @@ IoTFleetWiseEngine::connect( const Json::Value &config )
             return false;
         }
 
+        // Optionally read all CAN interfaces from a few threads instead of one thread per interface
+        auto canReaderThreads = config["staticConfig"]["internalParameters"]["canReaderThreads"].asUInt();
+        for ( uint32_t i = 0; i < canReaderThreads; i++ )
+        {
+            auto reader = std::make_shared<CANMultiBusReader>( i + 1 );
+            if ( !reader->start() )
+            {
+                mLogger.error( "IoTFleetWiseEngine::connect", " Failed to start the CAN reader threads " );
+                return false;
+            }
+            mCANMultiBusReaders.push_back( reader );
+        }
+        auto canReceiveBatchSize = config["staticConfig"]["internalParameters"]["canReceiveBatchSize"].asUInt();
+        uint32_t canInterfaceIndex = 0;
+
         // Initialize
         for ( const auto &interfaceName : config["networkInterfaces"] )
         {
@@ -390,6 +443,11 @@ IoTFleetWiseEngine::connect( const Json::Value &config )
                 canSourceConfig.transportProperties.emplace(
                     "threadIdleTimeMs",
                     config["staticConfig"]["threadIdleTimes"]["socketCANThreadIdleTimeMs"].asString() );
+                if ( canReceiveBatchSize != 0 )
+                {
+                    canSourceConfig.transportProperties.emplace( "receiveBatchSize",
+                                                                 std::to_string( canReceiveBatchSize ) );
+                }
                 canSourceConfig.maxNumberOfVehicleDataMessages =
                     config["staticConfig"]["bufferSizes"]["socketCANBufferSize"].asUInt();
                 CAN_TIMESTAMP_TYPE canTimestampType = CAN_TIMESTAMP_TYPE::KERNEL_SOFTWARE_TIMESTAMP; // default
@@ -432,6 +490,17 @@ IoTFleetWiseEngine::connect( const Json::Value &config )
                     // sources.
                     canConsumerPtr->setCANBufferPtr( canRawBufferPtr );
                 }
+                if ( !mCANMultiBusReaders.empty() )
+                {
+                    // The interfaces are distributed over the reader threads, which also decode the received
+                    // frames, so that no thread per interface is needed for reading or decoding
+                    canSourcePtr->setMultiBusReader(
+                        mCANMultiBusReaders[canInterfaceIndex % mCANMultiBusReaders.size()] );
+                    canConsumerPtr->setConsumeInReceivingThread();
+                    canSourcePtr->setFramesReceivedCallback(
+                        [canConsumerPtr]() { canConsumerPtr->consumeAvailableFrames(); } );
+                }
+                canInterfaceIndex++;
 
                 // Handshake the binder and the channel
                 if ( !mVehicleDataSourceBinder->addVehicleDataSource( canSourcePtr ) )
@@ -447,6 +516,52 @@ IoTFleetWiseEngine::connect( const Json::Value &config )
                     return false;
                 }
             }
+            else if ( interfaceType == CAN_LOG_FILE_INTERFACE_TYPE )
+            {
+                std::vector<VehicleDataSourceConfig> logFileSourceConfigs( 1 );
+                auto &logFileSourceConfig = logFileSourceConfigs.back();
+                const auto &logFileInterface = interfaceName[CAN_LOG_FILE_INTERFACE_TYPE];
+                for ( const auto &key : { "logFile", "replaySpeed", "logInterfaceName", "keepRecordedTimestamps" } )
+                {
+                    if ( logFileInterface.isMember( key ) )
+                    {
+                        logFileSourceConfig.transportProperties.emplace( key, logFileInterface[key].asString() );
+                    }
+                }
+                logFileSourceConfig.transportProperties.emplace(
+                    "threadIdleTimeMs",
+                    config["staticConfig"]["threadIdleTimes"]["socketCANThreadIdleTimeMs"].asString() );
+                logFileSourceConfig.maxNumberOfVehicleDataMessages =
+                    config["staticConfig"]["bufferSizes"]["socketCANBufferSize"].asUInt();
+
+                auto logFileSourcePtr = std::make_shared<CANLogFileDataSource>( mReplayClock );
+                auto canConsumerPtr = std::make_shared<CANDataConsumer>();
+                if ( !logFileSourcePtr->init( logFileSourceConfigs ) ||
+                     !canConsumerPtr->init(
+                         static_cast<VehicleDataSourceID>(
+                             canIDTranslator.getChannelNumericID( interfaceName["interfaceId"].asString() ) ),
+                         signalBufferPtr,
+                         config["staticConfig"]["threadIdleTimes"]["canDecoderThreadIdleTimeMs"].asUInt() ) )
+                {
+                    mLogger.error( "IoTFleetWiseEngine::connect", " Failed to initialize the CAN log file replay " );
+                    return false;
+                }
+                canConsumerPtr->setCANBufferPtr( canRawBufferPtr );
+
+                // Handshake the binder and the channel
+                if ( !mVehicleDataSourceBinder->addVehicleDataSource( logFileSourcePtr ) )
+                {
+                    mLogger.error( "IoTFleetWiseEngine::connect", " Failed to add a network channel " );
+                    return false;
+                }
+
+                if ( !mVehicleDataSourceBinder->bindConsumerToVehicleDataSource(
+                         canConsumerPtr, logFileSourcePtr->getVehicleDataSourceID() ) )
+                {
+                    mLogger.error( "IoTFleetWiseEngine::connect", " Failed to Bind Consumers to Producers " );
+                    return false;
+                }
+            }
             else if ( interfaceType == OBD_INTERFACE_TYPE )
             {
                 if ( !obdOverCANModuleInit )
@@ -665,6 +780,19 @@ IoTFleetWiseEngine::disconnect()
         mLogger.error( "IoTFleetWiseEngine::disconnect", "Could not disconnect the Binder" );
         return false;
     }
+
+    for ( auto &reader : mCANMultiBusReaders )
+    {
+        if ( !reader->stop() )
+        {
+            mLogger.error( "IoTFleetWiseEngine::disconnect", "Could not stop the CAN reader threads" );
+            return false;
+        }
+    }
+    if ( mReplayClock != nullptr )
+    {
+        ClockHandler::setClock( nullptr );
+    }
     mLogger.info( "IoTFleetWiseEngine::disconnect", "Engine Disconnected" );
     TraceModule::get().sectionEnd( TraceSection::FWE_SHUTDOWN );
     TraceModule::get().print();
@@ -842,53 +970,59 @@ bool
 IoTFleetWiseEngine::checkAndSendRetrievedData()
 {
     std::vector<std::string> payloads;
+    // Start at the first record that has not been acknowledged, so that an interrupted upload is resumed
+    auto cursor = mPayloadManager->getRetrieveCursor();
+    size_t payloadCount = 0;
 
-    // Retrieve the data from persistency library
-    ErrorCode status = mPayloadManager->retrieveData( payloads );
-
-    if ( status == ErrorCode::SUCCESS )
+    while ( true )
     {
-        ConnectivityError res = ConnectivityError::Success;
-        mLogger.trace( "IoTFleetWiseEngine::checkAndSendRetrievedData",
-                       "Number of Payloads to transmit : " + std::to_string( payloads.size() ) );
+        payloads.clear();
+        // Retrieve the next record from persistency library
+        ErrorCode status = mPayloadManager->retrieveNextPayloads( cursor, payloads );
+
+        if ( status == ErrorCode::EMPTY )
+        {
+            break;
+        }
+        else if ( status == ErrorCode::INVALID_DATA )
+        {
+            // The corrupted record was skipped, it would never be sent successfully
+            mLogger.error( "IoTFleetWiseEngine::checkAndSendRetrievedData", "Dropping corrupted persisted payload" );
+        }
+        else if ( status != ErrorCode::SUCCESS )
+        {
+            mLogger.error( "IoTFleetWiseEngine::checkAndSendRetrievedData", "Payload Retrieval Failed" );
+            return false;
+        }
 
         for ( const auto &payload : payloads )
         {
             // transmit the retrieved payload
-            res = mDataCollectionSender->transmit( payload );
+            ConnectivityError res = mDataCollectionSender->transmit( payload );
             if ( res != ConnectivityError::Success )
             {
-                // Error occurred in the transmission
+                // Error occurred in the transmission, the record stays unacknowledged
                 mLogger.error( "IoTFleetWiseEngine::checkAndSendRetrievedData",
-                               "Payload transmission failed, will be retried on the next bootup" );
-                break;
-            }
-            else
-            {
-                mLogger.trace( "IoTFleetWiseEngine::checkAndSendRetrievedData",
-                               "Payload has been successfully sent to the backend" );
+                               "Payload transmission failed, will be retried from the first unsent payload" );
+                return false;
             }
+            payloadCount++;
         }
-        if ( res == ConnectivityError::Success )
-        {
-            // All the stored data has been transmitted, erase the file contents
-            mPersistDecoderManifestCollectionSchemesAndData->erase( DataType::EDGE_TO_CLOUD_PAYLOAD );
-            mLogger.info( "IoTFleetWiseEngine::checkAndSendRetrievedData",
-                          "All " + std::to_string( payloads.size() ) + " Payloads successfully sent to the backend" );
-            return true;
-        }
-        return false;
+        // Delete the record from the storage as soon as it has been sent, segment files are removed once all their
+        // records are acknowledged
+        mPayloadManager->acknowledgeRetrievedData( cursor );
     }
-    else if ( status == ErrorCode::EMPTY )
+
+    if ( payloadCount > 0 )
     {
-        mLogger.trace( "IoTFleetWiseEngine::checkAndSendRetrievedData", "No Payloads to Retrieve" );
-        return true;
+        mLogger.info( "IoTFleetWiseEngine::checkAndSendRetrievedData",
+                      "All " + std::to_string( payloadCount ) + " Payloads successfully sent to the backend" );
     }
     else
     {
-        mLogger.error( "IoTFleetWiseEngine::checkAndSendRetrievedData", "Payload Retrieval Failed" );
-        return false;
+        mLogger.trace( "IoTFleetWiseEngine::checkAndSendRetrievedData", "No Payloads to Retrieve" );
     }
+    return true;
 }
 
 } // namespace ExecutionManagement
@@ -90,11 +90,11 @@ TEST_F( IoTFleetWiseEngineTest, CheckPublishDataQueue )
     }
     {
         std::array<uint8_t, 8> data = { 1, 2, 3, 4, 5, 6, 7, 8 };
-        CollectedCanRawFrame canFrames1( 12 /*frameId*/, 1 /*nodeId*/, 815 /*receiveTime*/, data, sizeof data );
+        CollectedCanRawFrame canFrames1( 12 /*frameId*/, 1 /*nodeId*/, 815 /*receiveTime*/, data.data(), sizeof data );
         collectedDataPtr->canFrames.push_back( canFrames1 );
-        CollectedCanRawFrame canFrames2( 4 /*frameId*/, 2 /*nodeId*/, 1100 /*receiveTime*/, data, sizeof data );
+        CollectedCanRawFrame canFrames2( 4 /*frameId*/, 2 /*nodeId*/, 1100 /*receiveTime*/, data.data(), sizeof data );
         collectedDataPtr->canFrames.push_back( canFrames2 );
-        CollectedCanRawFrame canFrames3( 6 /*frameId*/, 3 /*nodeId*/, 1300 /*receiveTime*/, data, sizeof data );
+        CollectedCanRawFrame canFrames3( 6 /*frameId*/, 3 /*nodeId*/, 1300 /*receiveTime*/, data.data(), sizeof data );
         collectedDataPtr->canFrames.push_back( canFrames3 );
     }
 
@@ -0,0 +1,766 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include "CANDataConsumer.h"
+#include "CANInterfaceIDTranslator.h"
+#include "ClockHandler.h"
+#include "CollectionInspectionWorkerThread.h"
+#include "DataCollectionSender.h"
+#include "IDataReadyToPublishListener.h"
+#include "ISender.h"
+#include "LogLevel.h"
+#include "Signal.h"
+#include "TraceModule.h"
+#include "VehicleDataSourceBinder.h"
+#include "businterfaces/AbstractVehicleDataSource.h"
+#include "businterfaces/CANLogFileDataSource.h"
+#include <algorithm>
+#include <atomic>
+#include <benchmark/benchmark.h>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <dirent.h>
+#include <fstream>
+#include <map>
+#include <pthread.h>
+#include <random>
+#include <sstream>
+#include <thread>
+#include <unistd.h>
+
+using namespace Aws::IoTFleetWise::DataInspection;
+using namespace Aws::IoTFleetWise::DataManagement;
+using namespace Aws::IoTFleetWise::OffboardConnectivity;
+using namespace Aws::IoTFleetWise::Platform::Linux;
+using namespace Aws::IoTFleetWise::VehicleNetwork;
+
+/**
+ * End-to-end throughput benchmark of the CAN data path. Frames are replayed through an in-process data source into
+ * CANDataConsumer, CollectionInspectionWorkerThread and DataCollectionSender, whose sender only counts the payloads.
+ *
+ * The decoder dictionary and, unless a log file is given, the traffic are generated from a DBC file. Environment
+ * variables:
+ * - FWE_BENCHMARK_DBC: DBC file, by default hscan.dbc from tools/cansim
+ * - FWE_BENCHMARK_CANDUMP: log file written by `candump -l` that is replayed instead of the synthetic traffic
+ *
+ * Benchmark arguments: number of campaigns, offered frames per second (0 replays as fast as possible)
+ */
+
+static constexpr uint32_t SOURCE_BUFFER_SIZE = 10000;
+static constexpr uint32_t SIGNAL_BUFFER_SIZE = 10000;
+static constexpr uint32_t CAN_BUFFER_SIZE = 10000;
+static constexpr uint32_t DTC_BUFFER_SIZE = 100;
+static constexpr uint32_t READY_TO_PUBLISH_BUFFER_SIZE = 10000;
+static constexpr uint32_t CONSUMER_IDLE_TIME_MS = 50;
+static constexpr uint32_t INSPECTION_IDLE_TIME_MS = 50;
+static constexpr uint32_t SENDER_IDLE_TIME_MS = 50;
+static constexpr uint32_t INSPECTION_BATCH_SIZE = 256;
+static constexpr uint32_t INSPECTION_BATCH_MAX_LATENCY_MS = 1;
+static constexpr uint32_t MAX_PUBLISH_MESSAGE_COUNT = 1000;
+static constexpr uint32_t PUBLISH_INTERVAL_MS = 100;
+static constexpr uint32_t SAMPLE_BUFFER_SIZE = 100;
+static constexpr uint32_t DEFAULT_CYCLE_TIME_MS = 100;
+static constexpr size_t SYNTHETIC_FRAME_COUNT = 10000;
+static constexpr uint64_t RATE_CHECK_INTERVAL_FRAMES = 64;
+static constexpr uint32_t STARTUP_TIMEOUT_MS = 5000;
+static constexpr uint32_t DRAIN_TIMEOUT_MS = 5000;
+static constexpr uint32_t CAN_ID_MASK = 0x1FFFFFFF;
+
+struct DbcSignal
+{
+    CANSignalFormat format;
+    double minimum{ 0.0 };
+    double maximum{ 0.0 };
+};
+
+struct DbcMessage
+{
+    uint32_t id{ 0 };
+    uint8_t size{ 0 };
+    uint32_t cycleTimeMs{ DEFAULT_CYCLE_TIME_MS };
+    std::vector<DbcSignal> signals;
+};
+
+/**
+ * @brief Reads the messages, signals and cycle times of a DBC file. Multiplexed signals are skipped.
+ */
+static bool
+parseDbc( const std::string &path, std::vector<DbcMessage> &messages )
+{
+    std::ifstream file( path );
+    if ( !file.is_open() )
+    {
+        return false;
+    }
+    std::map<uint32_t, uint32_t> cycleTimes;
+    SignalID nextSignalID = 1;
+    std::string line;
+    while ( std::getline( file, line ) )
+    {
+        std::istringstream stream( line );
+        std::string keyword;
+        stream >> keyword;
+        if ( keyword == "BO_" )
+        {
+            unsigned long id = 0;
+            std::string name;
+            unsigned size = 0;
+            if ( stream >> id >> name >> size )
+            {
+                DbcMessage message;
+                message.id = static_cast<uint32_t>( id ) & CAN_ID_MASK;
+                message.size =
+                    static_cast<uint8_t>( std::min( size, static_cast<unsigned>( MAX_CAN_FRAME_BYTE_SIZE ) ) );
+                messages.push_back( message );
+            }
+        }
+        else if ( ( keyword == "SG_" ) && !messages.empty() )
+        {
+            // SG_ <name> [<multiplexer>] : <start>|<length>@<byte order><sign> (<factor>,<offset>) [<min>|<max>] ...
+            std::string name;
+            std::string separator;
+            stream >> name >> separator;
+            auto colon = line.find( ':' );
+            if ( ( separator != ":" ) || ( colon == std::string::npos ) )
+            {
+                continue;
+            }
+            unsigned startBit = 0;
+            unsigned length = 0;
+            char byteOrder = 0;
+            char sign = 0;
+            DbcSignal signal;
+            if ( ( sscanf( line.c_str() + colon + 1,
+                           " %u|%u@%c%c (%lf,%lf) [%lf|%lf]",
+                           &startBit,
+                           &length,
+                           &byteOrder,
+                           &sign,
+                           &signal.format.mFactor,
+                           &signal.format.mOffset,
+                           &signal.minimum,
+                           &signal.maximum ) != 8 ) ||
+                 ( length == 0 ) || ( length > 64 ) )
+            {
+                continue;
+            }
+            signal.format.mSignalID = nextSignalID++;
+            signal.format.mIsBigEndian = ( byteOrder == '0' );
+            signal.format.mIsSigned = ( sign == '-' );
+            signal.format.mSizeInBits = static_cast<uint16_t>( length );
+            if ( signal.format.mIsBigEndian )
+            {
+                // The DBC start bit of Motorola signals is their most significant bit, the decoder expects the
+                // least significant one
+                for ( unsigned i = 1; i < length; i++ )
+                {
+                    startBit = ( ( startBit % 8 ) == 0 ) ? ( startBit + 15 ) : ( startBit - 1 );
+                }
+            }
+            signal.format.mFirstBitPosition = static_cast<uint16_t>( startBit );
+            messages.back().signals.push_back( signal );
+        }
+        else if ( keyword == "BA_" )
+        {
+            unsigned long id = 0;
+            unsigned cycleTime = 0;
+            if ( sscanf( line.c_str(), "BA_ \"GenMsgCycleTime\" BO_ %lu %u;", &id, &cycleTime ) == 2 )
+            {
+                cycleTimes[static_cast<uint32_t>( id ) & CAN_ID_MASK] = cycleTime;
+            }
+        }
+    }
+    for ( auto &message : messages )
+    {
+        auto cycleTime = cycleTimes.find( message.id );
+        if ( ( cycleTime != cycleTimes.end() ) && ( cycleTime->second > 0 ) )
+        {
+            message.cycleTimeMs = cycleTime->second;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Generates frames with random payload. Every message is sent with its cycle time like on a real bus, so
+ * messages with a short cycle time are replayed more often.
+ */
+static std::vector<CANRawFrameMessage>
+generateFrames( const std::vector<DbcMessage> &messages, size_t count )
+{
+    std::vector<CANRawFrameMessage> frames( count );
+    std::vector<uint64_t> nextSendTimes( messages.size(), 0 );
+    std::mt19937 random( 1 );
+    std::uniform_int_distribution<unsigned> byteDistribution( 0, UINT8_MAX );
+    std::array<uint8_t, MAX_CAN_FRAME_BYTE_SIZE> data{};
+    for ( auto &frame : frames )
+    {
+        auto next = std::min_element( nextSendTimes.begin(), nextSendTimes.end() );
+        const auto &message = messages[static_cast<size_t>( next - nextSendTimes.begin() )];
+        for ( auto &byte : data )
+        {
+            byte = static_cast<uint8_t>( byteDistribution( random ) );
+        }
+        frame.setup( message.id, INVALID_DATA_SOURCE_ID, data.data(), message.size, 0 );
+        *next += message.cycleTimeMs;
+    }
+    return frames;
+}
+
+/**
+ * @brief Reads a log file written by `candump -l`. The lines look like "(1600000000.000000) vcan0 191#0011223344"
+ * or "(1600000000.000000) vcan0 191##1001122" for CAN FD frames. Remote frames are skipped. The frames are replayed
+ * at the offered rate of the benchmark and not with the timing of the log file.
+ */
+static bool
+loadCandumpLog( const std::string &path, std::vector<CANRawFrameMessage> &frames )
+{
+    std::ifstream file( path );
+    if ( !file.is_open() )
+    {
+        return false;
+    }
+    std::string line;
+    CANLogFrame logFrame;
+    while ( std::getline( file, line ) )
+    {
+        if ( !CANLogFileDataSource::parseCandumpLine( line, logFrame ) )
+        {
+            continue;
+        }
+        CANRawFrameMessage frame;
+        frame.setup( logFrame.id, INVALID_DATA_SOURCE_ID, logFrame.data.data(), logFrame.size, 0 );
+        frames.push_back( frame );
+    }
+    return true;
+}
+
+/**
+ * @brief Decoder dictionary decoding all signals of the DBC file on channel 0
+ */
+static std::shared_ptr<const CANDecoderDictionary>
+buildDecoderDictionary( const std::vector<DbcMessage> &messages )
+{
+    auto dictionary = std::make_shared<CANDecoderDictionary>();
+    for ( const auto &message : messages )
+    {
+        CANMessageDecoderMethod decoderMethod;
+        decoderMethod.collectType = CANMessageCollectType::DECODE;
+        decoderMethod.format.mMessageID = message.id;
+        decoderMethod.format.mSizeInBytes = message.size;
+        for ( const auto &signal : message.signals )
+        {
+            decoderMethod.format.mSignals.push_back( signal.format );
+            dictionary->signalIDsToCollect.insert( signal.format.mSignalID );
+        }
+        dictionary->canMessageDecoderMethod[0][message.id] = decoderMethod;
+    }
+    return dictionary;
+}
+
+/**
+ * @brief Campaigns collecting all signals of the DBC file. Half of them are time based and publish every
+ * PUBLISH_INTERVAL_MS, the other half are condition based and trigger when a signal exceeds the middle of its range.
+ */
+class BenchmarkCampaigns
+{
+public:
+    BenchmarkCampaigns( const std::vector<DbcMessage> &messages, uint32_t campaignCount )
+    {
+        std::vector<const DbcSignal *> signals;
+        for ( const auto &message : messages )
+        {
+            for ( const auto &dbcSignal : message.signals )
+            {
+                signals.push_back( &dbcSignal );
+            }
+        }
+        auto matrix = std::make_shared<InspectionMatrix>();
+        matrix->conditions.resize( campaignCount );
+        for ( uint32_t i = 0; i < campaignCount; i++ )
+        {
+            auto &condition = matrix->conditions[i];
+            condition.minimumPublishInterval = PUBLISH_INTERVAL_MS;
+            condition.afterDuration = 0;
+            condition.includeActiveDtcs = false;
+            condition.triggerOnlyOnRisingEdge = false;
+            condition.probabilityToSend = 1.0;
+            condition.includeImageCapture = false;
+            condition.metaData.collectionSchemeID = "campaign" + std::to_string( i );
+            for ( const auto dbcSignal : signals )
+            {
+                InspectionMatrixSignalCollectionInfo signalInfo{};
+                signalInfo.signalID = dbcSignal->format.mSignalID;
+                signalInfo.sampleBufferSize = SAMPLE_BUFFER_SIZE;
+                condition.signals.push_back( signalInfo );
+            }
+            if ( ( ( i % 2 ) == 0 ) || signals.empty() )
+            {
+                condition.condition = boolean( true );
+            }
+            else
+            {
+                const auto &dbcSignal = *signals[( i / 2 ) % signals.size()];
+                condition.condition = binary( ExpressionNodeType::OPERATOR_BIGGER,
+                                              signal( dbcSignal.format.mSignalID ),
+                                              value( ( dbcSignal.minimum + dbcSignal.maximum ) / 2.0 ) );
+            }
+        }
+        mMatrix = matrix;
+    }
+
+    std::shared_ptr<const InspectionMatrix> mMatrix;
+
+private:
+    ExpressionNode *
+    newNode( ExpressionNodeType type )
+    {
+        mNodes.push_back( std::make_shared<ExpressionNode>() );
+        mNodes.back()->nodeType = type;
+        return mNodes.back().get();
+    }
+    ExpressionNode *
+    binary( ExpressionNodeType type, ExpressionNode *left, ExpressionNode *right )
+    {
+        auto node = newNode( type );
+        node->left = left;
+        node->right = right;
+        return node;
+    }
+    ExpressionNode *
+    signal( SignalID id )
+    {
+        auto node = newNode( ExpressionNodeType::SIGNAL );
+        node->signalID = id;
+        return node;
+    }
+    ExpressionNode *
+    value( double floatingValue )
+    {
+        auto node = newNode( ExpressionNodeType::FLOAT );
+        node->floatingValue = floatingValue;
+        return node;
+    }
+    ExpressionNode *
+    boolean( bool booleanValue )
+    {
+        auto node = newNode( ExpressionNodeType::BOOLEAN );
+        node->booleanValue = booleanValue;
+        return node;
+    }
+
+    std::vector<std::shared_ptr<ExpressionNode>> mNodes;
+};
+
+/**
+ * @brief In-process data source. The benchmark thread pushes the replayed frames directly into the buffer that is
+ * read by the CANDataConsumer, like the CANDataSource does with the frames received from the socket.
+ */
+class ReplayDataSource : public AbstractVehicleDataSource
+{
+public:
+    ReplayDataSource()
+    {
+        mType = VehicleDataSourceType::CAN_SOURCE;
+        mNetworkProtocol = VehicleDataSourceProtocol::RAW_SOCKET;
+        mID = generateSourceID();
+    }
+
+    bool
+    init( const std::vector<VehicleDataSourceConfig> &sourceConfigs ) override
+    {
+        if ( sourceConfigs.size() != 1 )
+        {
+            return false;
+        }
+        mConfigs = sourceConfigs;
+        mCircularBuffPtr =
+            std::make_shared<CANRawFrameCircularBuffer>( sourceConfigs[0].maxNumberOfVehicleDataMessages );
+        return true;
+    }
+
+    bool
+    connect() override
+    {
+        mConnected = true;
+        notifyListeners<const VehicleDataSourceID &>( &VehicleDataSourceListener::onVehicleDataSourceConnected, mID );
+        return true;
+    }
+
+    bool
+    disconnect() override
+    {
+        mConnected = false;
+        notifyListeners<const VehicleDataSourceID &>( &VehicleDataSourceListener::onVehicleDataSourceDisconnected,
+                                                      mID );
+        return true;
+    }
+
+    bool
+    isAlive() override
+    {
+        return mConnected;
+    }
+
+    void
+    suspendDataAcquisition() override
+    {
+        mActive = false;
+    }
+
+    void
+    resumeDataAcquisition() override
+    {
+        mActive = true;
+    }
+
+    bool
+    isActive() const
+    {
+        return mActive;
+    }
+
+    /**
+     * @brief Hands a frame over to the consumer. If the buffer is full the frame is discarded like in CANDataSource.
+     */
+    void
+    replay( const CANRawFrameMessage &frame, Timestamp receptionTime )
+    {
+        CANRawFrameMessage message;
+        message.setup( frame.getMessageID(), mID, frame.getData(), frame.getSize(), receptionTime );
+        if ( !mCircularBuffPtr->push( message ) )
+        {
+            mDiscardedFrames++;
+            TraceModule::get().setVariable( TraceVariable::DISCARDED_FRAMES, mDiscardedFrames );
+        }
+    }
+
+    uint64_t
+    getDiscardedFrames() const
+    {
+        return mDiscardedFrames;
+    }
+
+private:
+    std::atomic<bool> mConnected{ false };
+    std::atomic<bool> mActive{ false };
+    uint64_t mDiscardedFrames{ 0 };
+};
+
+/**
+ * @brief Sender that accepts every payload and only counts them
+ */
+class CountingSender : public ISender
+{
+public:
+    bool
+    isAlive() override
+    {
+        return true;
+    }
+
+    size_t
+    getMaxSendSize() const override
+    {
+        return 128U * 1024U;
+    }
+
+    ConnectivityError
+    send( const std::uint8_t *buf,
+          size_t size,
+          struct CollectionSchemeParams collectionSchemeParams = CollectionSchemeParams() ) override
+    {
+        static_cast<void>( buf );
+        static_cast<void>( collectionSchemeParams );
+        mPayloads++;
+        mPayloadBytes += size;
+        return ConnectivityError::Success;
+    }
+
+    std::atomic<uint64_t> mPayloads{ 0 };
+    std::atomic<uint64_t> mPayloadBytes{ 0 };
+};
+
+/**
+ * @brief Hands the collected data over to the DataCollectionSender like the IoTFleetWiseEngine thread does
+ */
+class SenderLoop : public IDataReadyToPublishListener
+{
+public:
+    SenderLoop( std::shared_ptr<CollectedDataReadyToPublish> collectedData, DataCollectionSender &sender )
+        : mCollectedData( std::move( collectedData ) )
+        , mSender( sender )
+    {
+    }
+
+    void
+    start()
+    {
+        mThread = std::thread( [this]() {
+            pthread_setname_np( pthread_self(), "fwBMSender" );
+            while ( !mShouldStop )
+            {
+                mWait.wait( SENDER_IDLE_TIME_MS );
+                mCollectedData->consume_all(
+                    [this]( const TriggeredCollectionSchemeDataPtr data ) { mSender.send( data ); } );
+            }
+        } );
+    }
+
+    void
+    stop()
+    {
+        mShouldStop = true;
+        mWait.notify();
+        mThread.join();
+    }
+
+    void
+    onDataReadyToPublish() override
+    {
+        mWait.notify();
+    }
+
+private:
+    std::shared_ptr<CollectedDataReadyToPublish> mCollectedData;
+    DataCollectionSender &mSender;
+    std::thread mThread;
+    std::atomic<bool> mShouldStop{ false };
+    Signal mWait;
+};
+
+/**
+ * @brief CPU time in clock ticks used by every thread of the process so far. The thread names are used as keys
+ * without a trailing index, so that the results of all benchmark runs have the same names.
+ */
+static std::map<std::string, uint64_t>
+readThreadCpuTicks()
+{
+    std::map<std::string, uint64_t> ticks;
+    auto directory = opendir( "/proc/self/task" );
+    if ( directory == nullptr )
+    {
+        return ticks;
+    }
+    while ( auto entry = readdir( directory ) )
+    {
+        std::ifstream statFile( std::string( "/proc/self/task/" ) + entry->d_name + "/stat" );
+        std::string stat;
+        if ( ( entry->d_name[0] == '.' ) || !std::getline( statFile, stat ) )
+        {
+            continue;
+        }
+        // The name is in parentheses and can contain spaces, utime and stime are the 12th and 13th field after it
+        auto nameStart = stat.find( '(' );
+        auto nameEnd = stat.rfind( ')' );
+        if ( ( nameStart == std::string::npos ) || ( nameEnd == std::string::npos ) || ( nameEnd < nameStart ) )
+        {
+            continue;
+        }
+        auto name = stat.substr( nameStart + 1, nameEnd - nameStart - 1 );
+        name.erase( name.find_last_not_of( "0123456789" ) + 1 );
+        std::istringstream fields( stat.substr( nameEnd + 1 ) );
+        std::string field;
+        for ( int i = 0; i < 11; i++ )
+        {
+            fields >> field;
+        }
+        uint64_t userTicks = 0;
+        uint64_t systemTicks = 0;
+        if ( fields >> userTicks >> systemTicks )
+        {
+            ticks[name] += userTicks + systemTicks;
+        }
+    }
+    closedir( directory );
+    return ticks;
+}
+
+static std::string
+getEnvironment( const char *name, const std::string &defaultValue )
+{
+    auto value = getenv( name );
+    return ( value != nullptr ) ? std::string( value ) : defaultValue;
+}
+
+static void
+BM_replayPipeline( benchmark::State &state )
+{
+    // Every discarded frame is logged as a warning which would distort the measurement
+    gSystemWideLogLevel = LogLevel::Error;
+
+    std::vector<DbcMessage> messages;
+    if ( !parseDbc( getEnvironment( "FWE_BENCHMARK_DBC", "hscan.dbc" ), messages ) || messages.empty() )
+    {
+        state.SkipWithError( "Could not read the DBC file" );
+        return;
+    }
+    std::vector<CANRawFrameMessage> frames;
+    auto candumpPath = getEnvironment( "FWE_BENCHMARK_CANDUMP", "" );
+    if ( candumpPath.empty() )
+    {
+        frames = generateFrames( messages, SYNTHETIC_FRAME_COUNT );
+    }
+    else if ( !loadCandumpLog( candumpPath, frames ) || frames.empty() )
+    {
+        state.SkipWithError( "Could not read the candump log file" );
+        return;
+    }
+    auto campaignCount = static_cast<uint32_t>( state.range( 0 ) );
+    auto offeredRate = static_cast<uint64_t>( state.range( 1 ) );
+    BenchmarkCampaigns campaigns( messages, campaignCount );
+
+    // Inspection and sending, configured like the defaults of the static configuration
+    auto signalBuffer = std::make_shared<SignalBuffer>( SIGNAL_BUFFER_SIZE );
+    auto canBuffer = std::make_shared<CANBuffer>( CAN_BUFFER_SIZE );
+    auto activeDTCBuffer = std::make_shared<ActiveDTCBuffer>( DTC_BUFFER_SIZE );
+    auto collectedData = std::make_shared<CollectedDataReadyToPublish>( READY_TO_PUBLISH_BUFFER_SIZE );
+    auto countingSender = std::make_shared<CountingSender>();
+    CANInterfaceIDTranslator canIDTranslator;
+    DataCollectionSender dataCollectionSender( countingSender, false, MAX_PUBLISH_MESSAGE_COUNT, canIDTranslator, "" );
+    SenderLoop senderLoop( collectedData, dataCollectionSender );
+    CollectionInspectionWorkerThread inspection;
+    if ( !inspection.init( signalBuffer,
+                           canBuffer,
+                           activeDTCBuffer,
+                           collectedData,
+                           INSPECTION_IDLE_TIME_MS,
+                           false,
+                           INSPECTION_BATCH_SIZE,
+                           INSPECTION_BATCH_MAX_LATENCY_MS ) ||
+         !inspection.subscribeListener( &senderLoop ) || !inspection.start() )
+    {
+        state.SkipWithError( "Could not start the inspection" );
+        return;
+    }
+    inspection.onChangeInspectionMatrix( campaigns.mMatrix );
+    senderLoop.start();
+
+    // Source and consumer
+    VehicleDataSourceConfig sourceConfig;
+    sourceConfig.maxNumberOfVehicleDataMessages = SOURCE_BUFFER_SIZE;
+    auto source = std::make_shared<ReplayDataSource>();
+    auto consumer = std::make_shared<CANDataConsumer>();
+    VehicleDataSourceBinder binder;
+    if ( !source->init( { sourceConfig } ) || !consumer->init( 0, signalBuffer, CONSUMER_IDLE_TIME_MS ) )
+    {
+        state.SkipWithError( "Could not initialize the source and the consumer" );
+    }
+    else
+    {
+        consumer->setCANBufferPtr( canBuffer );
+        if ( !binder.connect() || !binder.addVehicleDataSource( source ) ||
+             !binder.bindConsumerToVehicleDataSource( consumer, source->getVehicleDataSourceID() ) )
+        {
+            state.SkipWithError( "Could not bind the consumer to the source" );
+        }
+    }
+    ConstDecoderDictionaryConstPtr dictionary = buildDecoderDictionary( messages );
+    binder.onChangeOfActiveDictionary( dictionary, VehicleDataSourceProtocol::RAW_SOCKET );
+    auto startupStart = std::chrono::steady_clock::now();
+    while ( !state.error_occurred() && !source->isActive() )
+    {
+        if ( std::chrono::steady_clock::now() - startupStart > std::chrono::milliseconds( STARTUP_TIMEOUT_MS ) )
+        {
+            state.SkipWithError( "The source was not activated" );
+        }
+        std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
+    }
+
+    static const std::vector<std::pair<TraceHistogram, std::string>> histograms = {
+        { TraceHistogram::CAN_TO_CONSUMER_LATENCY, "can_to_consumer" },
+        { TraceHistogram::CAN_TO_INSPECTION_LATENCY, "can_to_inspection" },
+        { TraceHistogram::TRIGGER_TO_SENDER_LATENCY, "trigger_to_sender" },
+        { TraceHistogram::CAN_TO_PUBLISH_LATENCY, "can_to_publish" } };
+    std::vector<LatencyHistogram> histogramsBefore;
+    for ( const auto &histogram : histograms )
+    {
+        histogramsBefore.push_back( TraceModule::get().getHistogram( histogram.first ) );
+    }
+    auto cpuTicksBefore = readThreadCpuTicks();
+    auto clock = ClockHandler::getClock();
+    uint64_t replayedFrames = 0;
+    auto replayStart = std::chrono::steady_clock::now();
+    for ( auto _ : state )
+    {
+        if ( state.error_occurred() )
+        {
+            break;
+        }
+        for ( const auto &frame : frames )
+        {
+            if ( ( offeredRate != 0 ) && ( ( replayedFrames % RATE_CHECK_INTERVAL_FRAMES ) == 0 ) )
+            {
+                std::this_thread::sleep_until( replayStart +
+                                               std::chrono::microseconds( replayedFrames * 1000000 / offeredRate ) );
+            }
+            source->replay( frame, clock->timeSinceEpochMs() );
+            replayedFrames++;
+        }
+    }
+    auto replayEnd = std::chrono::steady_clock::now();
+
+    // Wait until the pipeline has processed all frames, so that their latencies are recorded as well
+    while ( ( ( source->getBuffer()->read_available() > 0 ) || !signalBuffer->empty() ) &&
+            ( std::chrono::steady_clock::now() - replayEnd < std::chrono::milliseconds( DRAIN_TIMEOUT_MS ) ) )
+    {
+        std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
+    }
+    std::this_thread::sleep_for( std::chrono::milliseconds( INSPECTION_IDLE_TIME_MS + SENDER_IDLE_TIME_MS ) );
+    auto drainEnd = std::chrono::steady_clock::now();
+    auto cpuTicksAfter = readThreadCpuTicks();
+
+    binder.disconnect();
+    inspection.stop();
+    senderLoop.stop();
+    if ( state.error_occurred() )
+    {
+        return;
+    }
+
+    auto replaySeconds = std::chrono::duration<double>( replayEnd - replayStart ).count();
+    auto totalSeconds = std::chrono::duration<double>( drainEnd - replayStart ).count();
+    auto discardedFrames = source->getDiscardedFrames();
+    state.counters["offered_frames_per_second"] = static_cast<double>( replayedFrames ) / replaySeconds;
+    state.counters["processed_frames_per_second"] =
+        static_cast<double>( replayedFrames - discardedFrames ) / totalSeconds;
+    state.counters["discarded_frames"] = static_cast<double>( discardedFrames );
+    state.counters["payloads"] = static_cast<double>( countingSender->mPayloads );
+    state.counters["payload_bytes"] = static_cast<double>( countingSender->mPayloadBytes );
+    for ( size_t i = 0; i < histograms.size(); i++ )
+    {
+        auto histogram = TraceModule::get().getHistogram( histograms[i].first );
+        histogram.subtract( histogramsBefore[i] );
+        state.counters[histograms[i].second + "_p50_ms"] = static_cast<double>( histogram.getPercentile( 50.0 ) );
+        state.counters[histograms[i].second + "_p99_ms"] = static_cast<double>( histogram.getPercentile( 99.0 ) );
+    }
+    // CPU usage of every thread in percent of one core
+    auto ticksPerSecond = static_cast<double>( sysconf( _SC_CLK_TCK ) );
+    for ( const auto &threadTicks : cpuTicksAfter )
+    {
+        auto ticks = threadTicks.second - std::min( threadTicks.second, cpuTicksBefore[threadTicks.first] );
+        state.counters["cpu_percent_" + threadTicks.first] =
+            100.0 * static_cast<double>( ticks ) / ticksPerSecond / totalSeconds;
+    }
+}
+BENCHMARK( BM_replayPipeline )
+    ->ArgNames( { "campaigns", "offered_rate" } )
+    ->Args( { 1, 0 } )
+    ->Args( { 10, 0 } )
+    ->Args( { 100, 0 } )
+    ->Args( { 10, 20000 } )
+    ->Unit( benchmark::kMillisecond )
+    ->UseRealTime();
+
+BENCHMARK_MAIN();
@@ -14,6 +14,9 @@
 #pragma once
 
 #include "IConnectionTypes.h"
+#include <cstdint>
+#include <memory>
+#include <vector>
 
 namespace Aws
 {
@@ -80,6 +83,30 @@ public:
         const std::uint8_t *buf,
         size_t size,
         struct CollectionSchemeParams collectionSchemeParams = CollectionSchemeParams() ) = 0;
+
+    /**
+     * @brief called to send data to the cloud taking over a shared reference to the buffer
+     *
+     * Same as send() but the implementation may keep the buffer alive until the data was handed over
+     * to the lower layers instead of copying it. The caller must not modify the buffer after this call.
+     * The default implementation forwards to send().
+     *
+     * @param buffer data to send. The same restrictions as for the buf parameter of send() apply.
+     * @param collectionSchemeParams object containing collectionScheme related metadata for data persistency and
+     * transmission
+     *
+     * @return SUCCESS if connection is established.
+     */
+    virtual ConnectivityError
+    sendBuffer( std::shared_ptr<const std::vector<std::uint8_t>> buffer,
+                struct CollectionSchemeParams collectionSchemeParams = CollectionSchemeParams() )
+    {
+        if ( buffer == nullptr )
+        {
+            return ConnectivityError::WrongInputData;
+        }
+        return send( buffer->data(), buffer->size(), collectionSchemeParams );
+    }
 };
 } // namespace OffboardConnectivity
 } // namespace IoTFleetWise
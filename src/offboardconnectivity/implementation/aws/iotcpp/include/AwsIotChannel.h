@@ -20,6 +20,7 @@
 #include "PayloadManager.h"
 #include <atomic>
 #include <aws/crt/Api.h>
+#include <functional>
 #include <memory>
 #include <mutex>
 #include <string>
@@ -122,6 +123,13 @@ public:
                             size_t size,
                             struct CollectionSchemeParams collectionSchemeParams = CollectionSchemeParams() ) override;
 
+    /**
+     * @brief Publishes the buffer without copying it. The buffer is held until the publish completed.
+     */
+    ConnectivityError sendBuffer(
+        std::shared_ptr<const std::vector<std::uint8_t>> buffer,
+        struct CollectionSchemeParams collectionSchemeParams = CollectionSchemeParams() ) override;
+
     bool
     isTopicValid()
     {
@@ -145,6 +153,25 @@ public:
 private:
     bool isAliveNotThreadSafe();
 
+    /**
+     * @brief Checks the payload and the connection state and reserves the SDK memory for the payload
+     *
+     * If the payload can not be published now it is persisted according to the collectionScheme params.
+     * @return Success if the payload can be published
+     */
+    ConnectivityError prepareSendNotThreadSafe( const std::uint8_t *buf,
+                                                size_t size,
+                                                const CollectionSchemeParams &collectionSchemeParams );
+
+    /**
+     * @brief Publishes a payload on the topic. prepareSendNotThreadSafe must have succeeded before.
+     *
+     * @param payload the payload passed to the SDK
+     * @param size the size reserved for the payload in the SDK memory usage
+     * @param releasePayload called once the SDK does not need the payload anymore
+     */
+    void publishNotThreadSafe( const Aws::Crt::ByteBuf &payload, size_t size, std::function<void()> releasePayload );
+
     /** See "Message size" : "The payload for every publish request can be no larger
      * than 128 KB. AWS IoT Core rejects publish and connect requests larger than this size."
      * https://docs.aws.amazon.com/general/latest/gr/iot-core.html#limits_iot
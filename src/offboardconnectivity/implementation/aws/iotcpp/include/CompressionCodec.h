@@ -0,0 +1,220 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#pragma once
+
+// Includes
+#include "LoggingModule.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#ifdef FWE_FEATURE_ZSTD
+struct ZSTD_CCtx_s;
+struct ZSTD_DCtx_s;
+struct ZSTD_CDict_s;
+struct ZSTD_DDict_s;
+#endif // FWE_FEATURE_ZSTD
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace OffboardConnectivityAwsIot
+{
+
+/**
+ * @brief IDs of the compression codecs. The IDs are persisted and sent to the cloud, so they must not change.
+ */
+enum class CompressionCodecID : uint8_t
+{
+    SNAPPY = 0,
+    LZ4 = 1,
+    ZSTD = 2
+};
+
+/**
+ * @brief Interface of a compression codec. The functions can be called from several threads at once.
+ */
+class ICompressionCodec
+{
+public:
+    virtual ~ICompressionCodec() = default;
+
+    virtual CompressionCodecID getID() const = 0;
+
+    /**
+     * @brief Gets the maximum size the compressed data can have
+     * @param size  size of the uncompressed data
+     */
+    virtual size_t getMaxCompressedSize( size_t size ) const = 0;
+
+    /**
+     * @brief Compresses data
+     * @param input  uncompressed data
+     * @param size  size of the uncompressed data
+     * @param output  buffer for the compressed data
+     * @param capacity  size of the output buffer, at least getMaxCompressedSize( size )
+     * @return the size of the compressed data, 0 if an error occurred
+     */
+    virtual size_t compress( const uint8_t *input, size_t size, uint8_t *output, size_t capacity ) const = 0;
+
+    /**
+     * @brief Decompresses data
+     * @param input  compressed data
+     * @param size  size of the compressed data
+     * @param output  set to the uncompressed data
+     * @return True if the data could be decompressed
+     */
+    virtual bool decompress( const uint8_t *input, size_t size, std::string &output ) const = 0;
+};
+
+class SnappyCodec : public ICompressionCodec
+{
+public:
+    CompressionCodecID getID() const override;
+    size_t getMaxCompressedSize( size_t size ) const override;
+    size_t compress( const uint8_t *input, size_t size, uint8_t *output, size_t capacity ) const override;
+    bool decompress( const uint8_t *input, size_t size, std::string &output ) const override;
+};
+
+#ifdef FWE_FEATURE_LZ4
+/**
+ * @brief LZ4 block compression. The block is prefixed with the uncompressed size as 32 bit little endian value,
+ * as the block format does not store it.
+ */
+class LZ4Codec : public ICompressionCodec
+{
+public:
+    CompressionCodecID getID() const override;
+    size_t getMaxCompressedSize( size_t size ) const override;
+    size_t compress( const uint8_t *input, size_t size, uint8_t *output, size_t capacity ) const override;
+    bool decompress( const uint8_t *input, size_t size, std::string &output ) const override;
+};
+#endif // FWE_FEATURE_LZ4
+
+#ifdef FWE_FEATURE_ZSTD
+/**
+ * @brief zstd compression, optionally with a dictionary trained on typical payloads e.g. with `zstd --train`.
+ * Frames compressed with a dictionary carry its ID, so frames compressed without it can still be decompressed.
+ */
+class ZstdCodec : public ICompressionCodec
+{
+public:
+    /**
+     * @param level  compression level
+     * @param dictionary  trained dictionary, empty to compress without dictionary
+     */
+    ZstdCodec( int level, const std::vector<uint8_t> &dictionary );
+    ~ZstdCodec() override;
+
+    ZstdCodec( const ZstdCodec & ) = delete;
+    ZstdCodec &operator=( const ZstdCodec & ) = delete;
+    ZstdCodec( ZstdCodec && ) = delete;
+    ZstdCodec &operator=( ZstdCodec && ) = delete;
+
+    /**
+     * @brief Gets the ID of the dictionary
+     * @return the ID, 0 if no dictionary is used
+     */
+    uint32_t getDictionaryID() const;
+
+    CompressionCodecID getID() const override;
+    size_t getMaxCompressedSize( size_t size ) const override;
+    size_t compress( const uint8_t *input, size_t size, uint8_t *output, size_t capacity ) const override;
+    bool decompress( const uint8_t *input, size_t size, std::string &output ) const override;
+
+private:
+    int mLevel;
+    uint32_t mDictionaryID{ 0 };
+    ZSTD_CDict_s *mCompressionDictionary{ nullptr };
+    ZSTD_DDict_s *mDecompressionDictionary{ nullptr };
+    // The contexts are reused as creating them is expensive, but can only be used by one thread at a time
+    mutable std::mutex mCompressionMutex;
+    ZSTD_CCtx_s *mCompressionContext{ nullptr };
+    mutable std::mutex mDecompressionMutex;
+    ZSTD_DCtx_s *mDecompressionContext{ nullptr };
+};
+#endif // FWE_FEATURE_ZSTD
+
+/**
+ * @brief Compresses the payloads sent to the cloud or persisted with the configured codec, and decompresses
+ * payloads with the codec they were compressed with.
+ *
+ * Payloads compressed with Snappy are the plain Snappy data as before. Payloads compressed with any other codec
+ * start with a header of PAYLOAD_CODEC_HEADER_SIZE bytes: the magic bytes 0xFF 'F' 'W' followed by the codec ID.
+ */
+class PayloadCodec
+{
+public:
+    static constexpr size_t PAYLOAD_CODEC_HEADER_SIZE = 4;
+
+    /**
+     * @brief Sets up Snappy as codec, which is always available
+     */
+    PayloadCodec();
+
+    /**
+     * @brief Selects the codec for compression
+     * @param codecName  "snappy", "lz4" or "zstd". LZ4 and zstd are only available if enabled at build time.
+     * @param level  compression level for zstd
+     * @param dictionaryFile  file with a trained zstd dictionary, empty to compress without dictionary
+     * @return True if the codec is available and the dictionary could be loaded
+     */
+    bool init( const std::string &codecName, int level, const std::string &dictionaryFile );
+
+    CompressionCodecID getCodecID() const;
+
+    /**
+     * @brief Gets the maximum size a compressed payload can have including the header
+     * @param size  size of the uncompressed payload
+     */
+    size_t getMaxCompressedSize( size_t size ) const;
+
+    /**
+     * @brief Compresses a payload with the selected codec
+     * @param input  uncompressed payload
+     * @param size  size of the uncompressed payload
+     * @param output  buffer for the compressed payload
+     * @param capacity  size of the output buffer, at least getMaxCompressedSize( size )
+     * @return the size of the compressed payload, 0 if an error occurred
+     */
+    size_t compress( const uint8_t *input, size_t size, uint8_t *output, size_t capacity ) const;
+
+    /**
+     * @brief Decompresses a payload
+     * @param codecID  codec the payload was compressed with
+     * @param input  compressed payload including the header
+     * @param size  size of the compressed payload
+     * @param output  set to the uncompressed payload
+     * @return True if the codec is available and the payload could be decompressed
+     */
+    bool decompress( CompressionCodecID codecID, const uint8_t *input, size_t size, std::string &output ) const;
+
+private:
+    static constexpr size_t CODEC_COUNT = 3;
+    static constexpr std::array<uint8_t, PAYLOAD_CODEC_HEADER_SIZE - 1> PAYLOAD_CODEC_MAGIC = { 0xFF, 'F', 'W' };
+
+    // Logging does not change the state of the codec, but LoggingModule has no const functions
+    mutable Aws::IoTFleetWise::Platform::Linux::LoggingModule mLogger;
+    std::array<std::shared_ptr<ICompressionCodec>, CODEC_COUNT> mCodecs;
+    std::shared_ptr<ICompressionCodec> mCodec;
+};
+
+} // namespace OffboardConnectivityAwsIot
+} // namespace IoTFleetWise
+} // namespace Aws
@@ -15,12 +15,13 @@
 
 // Includes
 #include "CacheAndPersist.h"
+#include "CompressionCodec.h"
 #include "ISender.h"
 #include "LoggingModule.h"
 #include <iostream>
 #include <memory>
-#include <snappy.h>
 #include <string>
+#include <vector>
 
 namespace Aws
 {
@@ -38,7 +39,10 @@ using namespace Aws::IoTFleetWise::Platform::Linux::PersistencyManagement;
 #pragma pack( push, 1 )
 struct PayloadHeader
 {
-    bool compressionRequired{ false };
+    // The first byte was a bool before the codec ID was added, so records persisted by older versions are read as
+    // compressed with Snappy
+    uint8_t compressionRequired : 1;
+    uint8_t codecID : 7;
     size_t size{ 0 };
 };
 
@@ -50,7 +54,12 @@ struct PayloadHeader
 class PayloadManager
 {
 public:
-    PayloadManager( std::shared_ptr<CacheAndPersist> persistencyPtr );
+    /**
+     * @param persistencyPtr  storage of the payloads
+     * @param payloadCodec  codec the payloads are compressed with. If nullptr, Snappy is used.
+     */
+    PayloadManager( std::shared_ptr<CacheAndPersist> persistencyPtr,
+                    std::shared_ptr<const PayloadCodec> payloadCodec = nullptr );
 
     /**
      * @brief Prepare the payload data to be written to storage. Adds a header with metadata consisting
@@ -66,7 +75,8 @@ public:
     bool storeData( const std::uint8_t *buf, size_t size, const struct CollectionSchemeParams &collectionSchemeParams );
 
     /**
-     * @brief Parses the retrieved data from the storage. Separates metadata from the actual payload.
+     * @brief Parses all the retrieved data from the storage. Separates metadata from the actual payload.
+     *        Corrupted records are skipped.
      *
      * @param data  vector to store parsed payloads
      *
@@ -74,13 +84,43 @@ public:
      */
     ErrorCode retrieveData( std::vector<std::string> &data );
 
+    /**
+     * @brief Gets the position of the first persisted record that has not been acknowledged yet
+     */
+    PayloadCursor getRetrieveCursor();
+
+    /**
+     * @brief Retrieves the payloads of the persisted record at the cursor and advances the cursor to the next record.
+     *        A record normally holds a single payload, but data imported from older versions may hold several.
+     *
+     * @param cursor  position of the record, updated to the position of the next record
+     * @param data    vector to store parsed payloads
+     *
+     * @return SUCCESS if payloads were retrieved, EMPTY if there are no more records,
+     *         INVALID_DATA if the record is corrupted and was skipped, FILESYSTEM_ERROR if other errors
+     */
+    ErrorCode retrieveNextPayloads( PayloadCursor &cursor, std::vector<std::string> &data );
+
+    /**
+     * @brief Acknowledges all records before the cursor, so that they are deleted from the storage and not
+     *        retrieved again
+     *
+     * @param cursor  position of the first record that has not been transmitted
+     *
+     * @return SUCCESS if true, FILESYSTEM_ERROR if the data could not be deleted
+     */
+    ErrorCode acknowledgeRetrievedData( const PayloadCursor &cursor );
+
 private:
     Aws::IoTFleetWise::Platform::Linux::LoggingModule mLogger;
     std::shared_ptr<CacheAndPersist> mPersistencyPtr;
+    std::shared_ptr<const PayloadCodec> mPayloadCodec;
+    // Reused for reading the records from the storage
+    std::vector<uint8_t> mRecord;
 
     /**
      * @brief Prepare the payload data to be written to storage. Adds a header with metadata consisting
-     *        of compression flag and size of the payload.
+     *        of compression flag, codec and size of the payload.
      *
      * @param buf  buffer to store encoded payload
      * @param data proto data to be stored
@@ -94,6 +134,16 @@ private:
                          size_t size,
                          const std::string &data,
                          const struct CollectionSchemeParams &collectionSchemeParams );
+
+    /**
+     * @brief Splits a persisted record into its payloads and uncompresses them if needed
+     *
+     * @param record  record read from the storage
+     * @param data    vector to store parsed payloads
+     *
+     * @return SUCCESS if all payloads could be parsed, INVALID_DATA otherwise
+     */
+    ErrorCode parsePayloads( const std::vector<uint8_t> &record, std::vector<std::string> &data );
 };
 } // namespace OffboardConnectivityAwsIot
 } // namespace IoTFleetWise
@@ -68,6 +68,7 @@ public:
      * @brief Implement the ILogger interface
      *
      * Packs the log string into a json and uploads to the cloud if necessary
+     * Called from the LogWriter thread, so the logging threads never wait for the json to be built.
      * Can be called from multiple threads.
      *
      * @param level the log level used to decide if log entry should be uploaded
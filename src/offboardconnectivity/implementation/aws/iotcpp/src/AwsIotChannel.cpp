@@ -153,6 +153,44 @@ ConnectivityError
 AwsIotChannel::send( const std::uint8_t *buf, size_t size, struct CollectionSchemeParams collectionSchemeParams )
 {
     std::lock_guard<std::mutex> connectivityLock( mConnectivityMutex );
+    auto result = prepareSendNotThreadSafe( buf, size, collectionSchemeParams );
+    if ( result != ConnectivityError::Success )
+    {
+        return result;
+    }
+
+    auto payload = ByteBufNewCopy( DefaultAllocator(), (const uint8_t *)buf, size );
+    publishNotThreadSafe( payload, size, [payload]() mutable { aws_byte_buf_clean_up( &payload ); } );
+    return ConnectivityError::Success;
+}
+
+ConnectivityError
+AwsIotChannel::sendBuffer( std::shared_ptr<const std::vector<std::uint8_t>> buffer,
+                           struct CollectionSchemeParams collectionSchemeParams )
+{
+    if ( buffer == nullptr )
+    {
+        mLogger.warn( "AwsIotChannel::send", "No valid data provided" );
+        return ConnectivityError::WrongInputData;
+    }
+    std::lock_guard<std::mutex> connectivityLock( mConnectivityMutex );
+    auto result = prepareSendNotThreadSafe( buffer->data(), buffer->size(), collectionSchemeParams );
+    if ( result != ConnectivityError::Success )
+    {
+        return result;
+    }
+
+    // The SDK only references the payload, which stays valid as long as the shared buffer is held
+    auto payload = ByteBufFromArray( buffer->data(), buffer->size() );
+    publishNotThreadSafe( payload, buffer->size(), [buffer]() mutable { buffer.reset(); } );
+    return ConnectivityError::Success;
+}
+
+ConnectivityError
+AwsIotChannel::prepareSendNotThreadSafe( const std::uint8_t *buf,
+                                         size_t size,
+                                         const CollectionSchemeParams &collectionSchemeParams )
+{
     if ( !isTopicValid() )
     {
         mLogger.warn( "AwsIotChannel::send", "Invalid topic provided" );
@@ -213,37 +251,39 @@ AwsIotChannel::send( const std::uint8_t *buf, size_t size, struct CollectionSche
         }
         return ConnectivityError::QuotaReached;
     }
+    return ConnectivityError::Success;
+}
 
+void
+AwsIotChannel::publishNotThreadSafe( const ByteBuf &payload, size_t size, std::function<void()> releasePayload )
+{
     auto connection = mConnectivityModule->getConnection();
 
-    auto payload = ByteBufNewCopy( DefaultAllocator(), (const uint8_t *)buf, size );
-
-    auto onPublishComplete =
-        [payload, size, this]( Mqtt::MqttConnection &mqttConnection, uint16_t packetId, int errorCode ) {
-            /* This call means that the data was handed over to some lower level in the stack but not
-                that the data is actually sent on the bus or removed from RAM*/
-            (void)mqttConnection;
-            aws_byte_buf_clean_up( (Aws::Crt::ByteBuf *)&payload ); // NOLINT(cppcoreguidelines-pro-type-cstyle-cast)
-            {
-                std::lock_guard<std::mutex> connectivityLambdaLock( mConnectivityLambdaMutex );
-                if ( mConnectivityModule != nullptr )
-                {
-                    mConnectivityModule->releaseMemoryUsage( size );
-                }
-            }
-            if ( packetId != 0U && errorCode == 0 )
-            {
-                mLogger.trace( "AwsIotChannel::send",
-                               "Operation on packetId  " + std::to_string( packetId ) + " Succeeded" );
-            }
-            else
+    auto onPublishComplete = [releasePayload = std::move( releasePayload ), size, this](
+                                 Mqtt::MqttConnection &mqttConnection, uint16_t packetId, int errorCode ) mutable {
+        /* This call means that the data was handed over to some lower level in the stack but not
+            that the data is actually sent on the bus or removed from RAM*/
+        (void)mqttConnection;
+        releasePayload();
+        {
+            std::lock_guard<std::mutex> connectivityLambdaLock( mConnectivityLambdaMutex );
+            if ( mConnectivityModule != nullptr )
             {
-                mLogger.error( "AwsIotChannel::send",
-                               std::string( "Operation failed with error" ) + aws_error_debug_str( errorCode ) );
+                mConnectivityModule->releaseMemoryUsage( size );
             }
-        };
+        }
+        if ( packetId != 0U && errorCode == 0 )
+        {
+            mLogger.trace( "AwsIotChannel::send",
+                           "Operation on packetId  " + std::to_string( packetId ) + " Succeeded" );
+        }
+        else
+        {
+            mLogger.error( "AwsIotChannel::send",
+                           std::string( "Operation failed with error" ) + aws_error_debug_str( errorCode ) );
+        }
+    };
     connection->Publish( mTopicName.c_str(), Mqtt::QOS::AWS_MQTT_QOS_AT_MOST_ONCE, false, payload, onPublishComplete );
-    return ConnectivityError::Success;
 }
 
 bool
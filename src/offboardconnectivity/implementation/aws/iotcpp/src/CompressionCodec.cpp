@@ -0,0 +1,356 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+// Includes
+#include "CompressionCodec.h"
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <snappy.h>
+#ifdef FWE_FEATURE_LZ4
+#include <lz4.h>
+#endif // FWE_FEATURE_LZ4
+#ifdef FWE_FEATURE_ZSTD
+#include <zstd.h>
+#endif // FWE_FEATURE_ZSTD
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace OffboardConnectivityAwsIot
+{
+
+constexpr size_t PayloadCodec::PAYLOAD_CODEC_HEADER_SIZE;
+constexpr size_t PayloadCodec::CODEC_COUNT;
+constexpr std::array<uint8_t, PayloadCodec::PAYLOAD_CODEC_HEADER_SIZE - 1> PayloadCodec::PAYLOAD_CODEC_MAGIC;
+
+CompressionCodecID
+SnappyCodec::getID() const
+{
+    return CompressionCodecID::SNAPPY;
+}
+
+size_t
+SnappyCodec::getMaxCompressedSize( size_t size ) const
+{
+    return snappy::MaxCompressedLength( size );
+}
+
+size_t
+SnappyCodec::compress( const uint8_t *input, size_t size, uint8_t *output, size_t capacity ) const
+{
+    if ( capacity < getMaxCompressedSize( size ) )
+    {
+        return 0U;
+    }
+    size_t compressedSize = 0U;
+    snappy::RawCompress( reinterpret_cast<const char *>( input ),
+                         size,
+                         reinterpret_cast<char *>( output ),
+                         &compressedSize );
+    return compressedSize;
+}
+
+bool
+SnappyCodec::decompress( const uint8_t *input, size_t size, std::string &output ) const
+{
+    return snappy::Uncompress( reinterpret_cast<const char *>( input ), size, &output );
+}
+
+#ifdef FWE_FEATURE_LZ4
+namespace
+{
+constexpr size_t LZ4_SIZE_PREFIX_BYTES = 4;
+} // namespace
+
+CompressionCodecID
+LZ4Codec::getID() const
+{
+    return CompressionCodecID::LZ4;
+}
+
+size_t
+LZ4Codec::getMaxCompressedSize( size_t size ) const
+{
+    if ( size > static_cast<size_t>( LZ4_MAX_INPUT_SIZE ) )
+    {
+        return 0U;
+    }
+    return LZ4_SIZE_PREFIX_BYTES + static_cast<size_t>( LZ4_compressBound( static_cast<int>( size ) ) );
+}
+
+size_t
+LZ4Codec::compress( const uint8_t *input, size_t size, uint8_t *output, size_t capacity ) const
+{
+    auto maxSize = getMaxCompressedSize( size );
+    if ( ( maxSize == 0U ) || ( capacity < maxSize ) )
+    {
+        return 0U;
+    }
+    for ( size_t i = 0; i < LZ4_SIZE_PREFIX_BYTES; i++ )
+    {
+        output[i] = static_cast<uint8_t>( size >> ( i * 8U ) );
+    }
+    auto compressedSize = LZ4_compress_default( reinterpret_cast<const char *>( input ),
+                                                reinterpret_cast<char *>( output + LZ4_SIZE_PREFIX_BYTES ),
+                                                static_cast<int>( size ),
+                                                static_cast<int>( capacity - LZ4_SIZE_PREFIX_BYTES ) );
+    return ( compressedSize <= 0 ) ? 0U : LZ4_SIZE_PREFIX_BYTES + static_cast<size_t>( compressedSize );
+}
+
+bool
+LZ4Codec::decompress( const uint8_t *input, size_t size, std::string &output ) const
+{
+    if ( ( size < LZ4_SIZE_PREFIX_BYTES ) ||
+         ( size - LZ4_SIZE_PREFIX_BYTES > static_cast<size_t>( std::numeric_limits<int>::max() ) ) )
+    {
+        return false;
+    }
+    size_t uncompressedSize = 0U;
+    for ( size_t i = 0; i < LZ4_SIZE_PREFIX_BYTES; i++ )
+    {
+        uncompressedSize |= static_cast<size_t>( input[i] ) << ( i * 8U );
+    }
+    if ( uncompressedSize > static_cast<size_t>( LZ4_MAX_INPUT_SIZE ) )
+    {
+        return false;
+    }
+    output.resize( uncompressedSize );
+    auto result = LZ4_decompress_safe( reinterpret_cast<const char *>( input + LZ4_SIZE_PREFIX_BYTES ),
+                                       &output[0],
+                                       static_cast<int>( size - LZ4_SIZE_PREFIX_BYTES ),
+                                       static_cast<int>( uncompressedSize ) );
+    return ( result >= 0 ) && ( static_cast<size_t>( result ) == uncompressedSize );
+}
+#endif // FWE_FEATURE_LZ4
+
+#ifdef FWE_FEATURE_ZSTD
+ZstdCodec::ZstdCodec( int level, const std::vector<uint8_t> &dictionary )
+    : mLevel( level )
+    , mCompressionContext( ZSTD_createCCtx() )
+    , mDecompressionContext( ZSTD_createDCtx() )
+{
+    if ( !dictionary.empty() )
+    {
+        mDictionaryID = ZSTD_getDictID_fromDict( dictionary.data(), dictionary.size() );
+        mCompressionDictionary = ZSTD_createCDict( dictionary.data(), dictionary.size(), level );
+        mDecompressionDictionary = ZSTD_createDDict( dictionary.data(), dictionary.size() );
+    }
+}
+
+ZstdCodec::~ZstdCodec()
+{
+    ZSTD_freeCDict( mCompressionDictionary );
+    ZSTD_freeDDict( mDecompressionDictionary );
+    ZSTD_freeCCtx( mCompressionContext );
+    ZSTD_freeDCtx( mDecompressionContext );
+}
+
+uint32_t
+ZstdCodec::getDictionaryID() const
+{
+    return mDictionaryID;
+}
+
+CompressionCodecID
+ZstdCodec::getID() const
+{
+    return CompressionCodecID::ZSTD;
+}
+
+size_t
+ZstdCodec::getMaxCompressedSize( size_t size ) const
+{
+    return ZSTD_compressBound( size );
+}
+
+size_t
+ZstdCodec::compress( const uint8_t *input, size_t size, uint8_t *output, size_t capacity ) const
+{
+    if ( mCompressionContext == nullptr )
+    {
+        return 0U;
+    }
+    std::lock_guard<std::mutex> lock( mCompressionMutex );
+    size_t result = 0U;
+    if ( mCompressionDictionary != nullptr )
+    {
+        result =
+            ZSTD_compress_usingCDict( mCompressionContext, output, capacity, input, size, mCompressionDictionary );
+    }
+    else
+    {
+        result = ZSTD_compressCCtx( mCompressionContext, output, capacity, input, size, mLevel );
+    }
+    return ( ZSTD_isError( result ) != 0U ) ? 0U : result;
+}
+
+bool
+ZstdCodec::decompress( const uint8_t *input, size_t size, std::string &output ) const
+{
+    auto uncompressedSize = ZSTD_getFrameContentSize( input, size );
+    if ( ( mDecompressionContext == nullptr ) || ( uncompressedSize == ZSTD_CONTENTSIZE_UNKNOWN ) ||
+         ( uncompressedSize == ZSTD_CONTENTSIZE_ERROR ) ||
+         ( uncompressedSize > std::numeric_limits<uint32_t>::max() ) )
+    {
+        return false;
+    }
+    // Frames compressed without dictionary can always be decompressed, but the dictionary must match otherwise
+    auto frameDictionaryID = ZSTD_getDictID_fromFrame( input, size );
+    if ( ( frameDictionaryID != 0U ) && ( frameDictionaryID != mDictionaryID ) )
+    {
+        return false;
+    }
+    output.resize( static_cast<size_t>( uncompressedSize ) );
+    std::lock_guard<std::mutex> lock( mDecompressionMutex );
+    size_t result = 0U;
+    if ( frameDictionaryID != 0U )
+    {
+        result = ZSTD_decompress_usingDDict(
+            mDecompressionContext, &output[0], output.size(), input, size, mDecompressionDictionary );
+    }
+    else
+    {
+        result = ZSTD_decompressDCtx( mDecompressionContext, &output[0], output.size(), input, size );
+    }
+    return ( ZSTD_isError( result ) == 0U ) && ( result == output.size() );
+}
+#endif // FWE_FEATURE_ZSTD
+
+PayloadCodec::PayloadCodec()
+{
+    mCodecs[static_cast<size_t>( CompressionCodecID::SNAPPY )] = std::make_shared<SnappyCodec>();
+#ifdef FWE_FEATURE_LZ4
+    mCodecs[static_cast<size_t>( CompressionCodecID::LZ4 )] = std::make_shared<LZ4Codec>();
+#endif // FWE_FEATURE_LZ4
+#ifdef FWE_FEATURE_ZSTD
+    mCodecs[static_cast<size_t>( CompressionCodecID::ZSTD )] =
+        std::make_shared<ZstdCodec>( 3, std::vector<uint8_t>() );
+#endif // FWE_FEATURE_ZSTD
+    mCodec = mCodecs[static_cast<size_t>( CompressionCodecID::SNAPPY )];
+}
+
+bool
+PayloadCodec::init( const std::string &codecName, int level, const std::string &dictionaryFile )
+{
+#ifndef FWE_FEATURE_ZSTD
+    // Only used by zstd
+    (void)level;
+    (void)dictionaryFile;
+#endif // FWE_FEATURE_ZSTD
+    if ( codecName.empty() || ( codecName == "snappy" ) )
+    {
+        mCodec = mCodecs[static_cast<size_t>( CompressionCodecID::SNAPPY )];
+    }
+#ifdef FWE_FEATURE_LZ4
+    else if ( codecName == "lz4" )
+    {
+        mCodec = mCodecs[static_cast<size_t>( CompressionCodecID::LZ4 )];
+    }
+#endif // FWE_FEATURE_LZ4
+#ifdef FWE_FEATURE_ZSTD
+    else if ( codecName == "zstd" )
+    {
+        std::vector<uint8_t> dictionary;
+        if ( !dictionaryFile.empty() )
+        {
+            std::ifstream file( dictionaryFile, std::ios::binary );
+            if ( !file.is_open() )
+            {
+                mLogger.error( "PayloadCodec::init", "Could not open the zstd dictionary " + dictionaryFile );
+                return false;
+            }
+            dictionary.assign( std::istreambuf_iterator<char>( file ), std::istreambuf_iterator<char>() );
+        }
+        auto codec = std::make_shared<ZstdCodec>( level, dictionary );
+        if ( !dictionary.empty() && ( codec->getDictionaryID() == 0U ) )
+        {
+            // Frames compressed with a dictionary without ID could not be told apart from frames without dictionary
+            mLogger.error( "PayloadCodec::init",
+                           "The zstd dictionary " + dictionaryFile + " is not a trained dictionary" );
+            return false;
+        }
+        mCodecs[static_cast<size_t>( CompressionCodecID::ZSTD )] = codec;
+        mCodec = codec;
+    }
+#endif // FWE_FEATURE_ZSTD
+    else
+    {
+        mLogger.error( "PayloadCodec::init", "The compression codec " + codecName + " is not supported" );
+        return false;
+    }
+    mLogger.info( "PayloadCodec::init",
+                  "Compressing payloads with codec " + std::to_string( static_cast<uint32_t>( getCodecID() ) ) );
+    return true;
+}
+
+CompressionCodecID
+PayloadCodec::getCodecID() const
+{
+    return mCodec->getID();
+}
+
+size_t
+PayloadCodec::getMaxCompressedSize( size_t size ) const
+{
+    auto headerSize = ( getCodecID() == CompressionCodecID::SNAPPY ) ? 0U : PAYLOAD_CODEC_HEADER_SIZE;
+    return headerSize + mCodec->getMaxCompressedSize( size );
+}
+
+size_t
+PayloadCodec::compress( const uint8_t *input, size_t size, uint8_t *output, size_t capacity ) const
+{
+    if ( getCodecID() == CompressionCodecID::SNAPPY )
+    {
+        return mCodec->compress( input, size, output, capacity );
+    }
+    if ( capacity < PAYLOAD_CODEC_HEADER_SIZE )
+    {
+        return 0U;
+    }
+    std::copy( PAYLOAD_CODEC_MAGIC.begin(), PAYLOAD_CODEC_MAGIC.end(), output );
+    output[PAYLOAD_CODEC_MAGIC.size()] = static_cast<uint8_t>( getCodecID() );
+    auto compressedSize = mCodec->compress(
+        input, size, output + PAYLOAD_CODEC_HEADER_SIZE, capacity - PAYLOAD_CODEC_HEADER_SIZE );
+    return ( compressedSize == 0U ) ? 0U : PAYLOAD_CODEC_HEADER_SIZE + compressedSize;
+}
+
+bool
+PayloadCodec::decompress( CompressionCodecID codecID, const uint8_t *input, size_t size, std::string &output ) const
+{
+    auto index = static_cast<size_t>( codecID );
+    if ( ( index >= mCodecs.size() ) || ( mCodecs[index] == nullptr ) )
+    {
+        mLogger.error( "PayloadCodec::decompress",
+                       "The compression codec " + std::to_string( index ) + " is not available" );
+        return false;
+    }
+    if ( codecID == CompressionCodecID::SNAPPY )
+    {
+        return mCodecs[index]->decompress( input, size, output );
+    }
+    if ( ( size < PAYLOAD_CODEC_HEADER_SIZE ) ||
+         !std::equal( PAYLOAD_CODEC_MAGIC.begin(), PAYLOAD_CODEC_MAGIC.end(), input ) ||
+         ( input[PAYLOAD_CODEC_MAGIC.size()] != static_cast<uint8_t>( codecID ) ) )
+    {
+        return false;
+    }
+    return mCodecs[index]->decompress(
+        input + PAYLOAD_CODEC_HEADER_SIZE, size - PAYLOAD_CODEC_HEADER_SIZE, output );
+}
+
+} // namespace OffboardConnectivityAwsIot
+} // namespace IoTFleetWise
+} // namespace Aws
@@ -13,6 +13,7 @@
 
 #include "PayloadManager.h"
 #include "TraceModule.h"
+#include <algorithm>
 #include <cstring>
 #include <memory>
 #include <sstream>
@@ -20,9 +21,15 @@
 using namespace Aws::IoTFleetWise::OffboardConnectivityAwsIot;
 using namespace Aws::IoTFleetWise::Platform::Linux;
 
-PayloadManager::PayloadManager( std::shared_ptr<CacheAndPersist> persistencyPtr )
+PayloadManager::PayloadManager( std::shared_ptr<CacheAndPersist> persistencyPtr,
+                                std::shared_ptr<const PayloadCodec> payloadCodec )
     : mPersistencyPtr( std::move( persistencyPtr ) )
+    , mPayloadCodec( std::move( payloadCodec ) )
 {
+    if ( mPayloadCodec == nullptr )
+    {
+        mPayloadCodec = std::make_shared<PayloadCodec>();
+    }
 }
 
 bool
@@ -51,7 +58,8 @@ PayloadManager::preparePayload( uint8_t *const buf,
 
     // Add a payload header before writing to the file
     payloadHdr.size = data.size();
-    payloadHdr.compressionRequired = collectionSchemeParams.compression;
+    payloadHdr.compressionRequired = collectionSchemeParams.compression ? 1U : 0U;
+    payloadHdr.codecID = static_cast<uint8_t>( mPayloadCodec->getCodecID() ) & 0x7FU;
 
     memcpy( &buf[0], &payloadHdr, hdrSize );
     memcpy( reinterpret_cast<char *>( &buf[hdrSize] ), data.data(), payloadHdr.size );
@@ -78,7 +86,13 @@ PayloadManager::storeData( const std::uint8_t *buf,
             mLogger.trace( "PayloadManager::storeData",
                            "CollectionScheme does not activate compression, but will apply compression for local "
                            "persistency anyway" );
-            if ( snappy::Compress( payload.data(), payload.size(), &compressedData ) == 0u )
+            compressedData.resize( mPayloadCodec->getMaxCompressedSize( payload.size() ) );
+            auto compressedSize = mPayloadCodec->compress( reinterpret_cast<const uint8_t *>( payload.data() ),
+                                                           payload.size(),
+                                                           reinterpret_cast<uint8_t *>( &compressedData[0] ),
+                                                           compressedData.size() );
+            compressedData.resize( compressedSize );
+            if ( compressedSize == 0U )
             {
                 TraceModule::get().incrementVariable( TraceVariable::PM_COMPRESS_ERROR );
                 mLogger.error( "PayloadManager::storeData",
@@ -129,75 +143,102 @@ PayloadManager::storeData( const std::uint8_t *buf,
 ErrorCode
 PayloadManager::retrieveData( std::vector<std::string> &data )
 {
-    size_t readSize = mPersistencyPtr->getSize( DataType::EDGE_TO_CLOUD_PAYLOAD );
+    auto cursor = getRetrieveCursor();
+    size_t readSize = 0;
+    ErrorCode status = ErrorCode::SUCCESS;
+    size_t payloadCount = data.size();
 
+    while ( ( status = retrieveNextPayloads( cursor, data ) ) != ErrorCode::EMPTY )
+    {
+        if ( ( status != ErrorCode::SUCCESS ) && ( status != ErrorCode::INVALID_DATA ) )
+        {
+            return status;
+        }
+        for ( ; payloadCount < data.size(); payloadCount++ )
+        {
+            readSize += data[payloadCount].size();
+        }
+    }
     if ( readSize == 0 )
     {
         return ErrorCode::EMPTY;
     }
+    mLogger.info( "PayloadManager::retrieveData",
+                  "Payload of Size : " + std::to_string( readSize ) + " Bytes has been loaded from disk" );
 
-    // Parsed data will be stored here
-    std::unique_ptr<uint8_t[]> readBuffer( new uint8_t[readSize] );
-    ErrorCode status = mPersistencyPtr->read( readBuffer.get(), readSize, DataType::EDGE_TO_CLOUD_PAYLOAD );
+    return ErrorCode::SUCCESS;
+}
 
+PayloadCursor
+PayloadManager::getRetrieveCursor()
+{
+    return mPersistencyPtr->getPayloadCursor();
+}
+
+ErrorCode
+PayloadManager::retrieveNextPayloads( PayloadCursor &cursor, std::vector<std::string> &data )
+{
+    ErrorCode status = mPersistencyPtr->readPayloadRecord( cursor, mRecord );
     if ( status != ErrorCode::SUCCESS )
     {
         return status;
     }
-    else
-    {
-        size_t size = 0U;
-        std::string dataString;
+    return parsePayloads( mRecord, data );
+}
 
-        // Read from the beginning of the buffer
-        size_t pos = 0;
+ErrorCode
+PayloadManager::acknowledgeRetrievedData( const PayloadCursor &cursor )
+{
+    return mPersistencyPtr->acknowledgePayloads( cursor );
+}
 
-        while ( pos < readSize )
-        {
-            size_t j = 0;
-            PayloadHeader payloadHdr{};
-            memcpy( &payloadHdr, &( readBuffer.get()[pos] ), sizeof( PayloadHeader ) );
-            pos += sizeof( PayloadHeader );
+ErrorCode
+PayloadManager::parsePayloads( const std::vector<uint8_t> &record, std::vector<std::string> &data )
+{
+    // Read from the beginning of the record
+    size_t pos = 0;
 
-            // capture the size of the payload
-            size = payloadHdr.size;
+    while ( pos < record.size() )
+    {
+        PayloadHeader payloadHdr{};
+        if ( record.size() - pos < sizeof( PayloadHeader ) )
+        {
+            mLogger.error( "PayloadManager::retrieveData", "Incomplete payload header" );
+            return ErrorCode::INVALID_DATA;
+        }
+        memcpy( &payloadHdr, &record[pos], sizeof( PayloadHeader ) );
+        pos += sizeof( PayloadHeader );
 
-            // Clear the data string before parsing new payload
-            dataString.clear();
-            for ( j = 0; j < size && ( ( pos + j ) < readSize ); ++j )
-            {
-                dataString += ( readBuffer.get()[pos + j] ); // NOLINT(clang-diagnostic-sign-conversion)
-            }
+        // capture the size of the payload
+        size_t size = std::min( payloadHdr.size, record.size() - pos );
+        const char *payloadStart = reinterpret_cast<const char *>( record.data() + pos );
 
+        // Since we always compress for storage,
+        // uncompress if the collectionScheme did not require compression
+        if ( payloadHdr.compressionRequired == 0U )
+        {
+            mLogger.trace( "PayloadManager::retrieveData",
+                           "CollectionScheme does not require compression, uncompress " + std::to_string( size ) +
+                               " bytes before transmitting the "
+                               "persisted data." );
             std::string payloadData;
-            // Since we always compress for storage,
-            // uncompress if the collectionScheme did not require compression
-            if ( !payloadHdr.compressionRequired )
-            {
-                mLogger.trace( "PayloadManager::retrieveData",
-                               "CollectionScheme does not require compression, uncompress " +
-                                   std::to_string( dataString.size() ) +
-                                   " bytes before transmitting the "
-                                   "persisted data." );
-                if ( !snappy::Uncompress( dataString.data(), dataString.size(), &payloadData ) )
-                {
-                    mLogger.error(
-                        "PayloadManager::retrieveData",
-                        "Error occurred while un-compressing the payload from disk. The payload is likely corrupted." );
-                    return ErrorCode::INVALID_DATA;
-                }
-            }
-            else
+            if ( !mPayloadCodec->decompress( static_cast<CompressionCodecID>( payloadHdr.codecID ),
+                                             reinterpret_cast<const uint8_t *>( payloadStart ),
+                                             size,
+                                             payloadData ) )
             {
-                payloadData = dataString;
+                mLogger.error(
+                    "PayloadManager::retrieveData",
+                    "Error occurred while un-compressing the payload from disk. The payload is likely corrupted." );
+                return ErrorCode::INVALID_DATA;
             }
-
-            data.emplace_back( payloadData );
-            pos += j;
+            data.emplace_back( std::move( payloadData ) );
+        }
+        else
+        {
+            data.emplace_back( payloadStart, size );
         }
+        pos += size;
     }
-    mLogger.info( "PayloadManager::retrieveData",
-                  "Payload of Size : " + std::to_string( readSize ) + " Bytes has been loaded from disk" );
-
     return ErrorCode::SUCCESS;
 }
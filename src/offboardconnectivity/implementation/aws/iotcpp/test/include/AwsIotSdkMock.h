@@ -21,6 +21,7 @@ public:
     MOCK_METHOD( ( struct aws_byte_buf ),
                  ByteBufNewCopy,
                  ( struct aws_allocator * alloc, const uint8_t *array, size_t len ) );
+    MOCK_METHOD( ( struct aws_byte_buf ), ByteBufFromArray, ( const uint8_t *array, size_t len ) );
     MOCK_METHOD( ( struct aws_byte_cursor ), ByteCursorFromCString, ( const char *str ) );
     MOCK_METHOD( ( Aws::Crt::String ), UUIDToString, () );
 };
@@ -45,6 +45,12 @@ ByteBufNewCopy( Allocator *alloc, const uint8_t *array, size_t len )
     return getSdkMock()->ByteBufNewCopy( alloc, array, len );
 }
 
+inline ByteBuf
+ByteBufFromArray( const uint8_t *array, size_t len ) noexcept
+{
+    return getSdkMock()->ByteBufFromArray( array, len );
+}
+
 inline ByteCursor
 ByteCursorFromCString( const char *str )
 {
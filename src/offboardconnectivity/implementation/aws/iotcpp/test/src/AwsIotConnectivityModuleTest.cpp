@@ -367,6 +367,44 @@ TEST_F( AwsIotConnectivityModuleTest, sendMultiple )
     c.invalidateConnection();
 }
 
+/** @brief Test that a shared buffer is published without copying and held until the publish completed */
+TEST_F( AwsIotConnectivityModuleTest, sendBufferWithoutCopy )
+{
+    auto con = setupValidConnection();
+    std::shared_ptr<AwsIotConnectivityModule> m = std::make_shared<AwsIotConnectivityModule>();
+    AwsIotChannel c( m.get(), nullptr );
+    ASSERT_TRUE( m->connect( "key", "cert", "endpoint", "clientIdTest", bootstrap ) );
+    c.setTopic( "topic" );
+    auto buffer = std::make_shared<const std::vector<std::uint8_t>>( std::vector<std::uint8_t>{ 0xca, 0xfe } );
+    std::weak_ptr<const std::vector<std::uint8_t>> weakBuffer = buffer;
+
+    EXPECT_CALL( sdkMock, ByteBufNewCopy( _, _, _ ) ).Times( 0 );
+    EXPECT_CALL( sdkMock, aws_byte_buf_clean_up( _ ) ).Times( 0 );
+    EXPECT_CALL( sdkMock, ByteBufFromArray( buffer->data(), buffer->size() ) ).WillOnce( Return( byteBuffer ) );
+    MqttConnection::OnOperationCompleteHandler completeHandler;
+    EXPECT_CALL( *con, Publish( _, _, _, _, _ ) )
+        .WillOnce(
+            Invoke( [&completeHandler]( const char *,
+                                        aws_mqtt_qos,
+                                        bool,
+                                        const struct aws_byte_buf &,
+                                        MqttConnection::OnOperationCompleteHandler &&onOpComplete ) noexcept -> bool {
+                completeHandler = std::move( onOpComplete );
+                return true;
+            } ) );
+
+    ASSERT_EQ( c.sendBuffer( std::move( buffer ) ), ConnectivityError::Success );
+    // The channel keeps the buffer alive while the publish is pending
+    ASSERT_FALSE( weakBuffer.expired() );
+    completeHandler( *con, 1, 0 );
+    ASSERT_TRUE( weakBuffer.expired() );
+
+    ASSERT_EQ( c.sendBuffer( nullptr ), ConnectivityError::WrongInputData );
+
+    con->OnDisconnect( *con );
+    c.invalidateConnection();
+}
+
 /** @brief Test SDK exceeds RAM and Channel stops sending */
 TEST_F( AwsIotConnectivityModuleTest, sdkRAMExceeded )
 {
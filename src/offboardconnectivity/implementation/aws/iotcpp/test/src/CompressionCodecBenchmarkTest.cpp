@@ -0,0 +1,164 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include "CompressionCodec.h"
+#include "vehicle_data.pb.h"
+#include <benchmark/benchmark.h>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <dirent.h>
+#include <fstream>
+#include <iterator>
+
+using namespace Aws::IoTFleetWise::OffboardConnectivityAwsIot;
+
+/**
+ * @brief Gets the uncompressed payloads to compress. If the environment variable FWE_BENCHMARK_PAYLOAD_DIR is set,
+ * every file in that directory is read as one recorded payload. Otherwise payloads like the ones of a campaign
+ * collecting a few dozen periodic signals are generated.
+ */
+static const std::vector<std::string> &
+getPayloads()
+{
+    static std::vector<std::string> payloads;
+    if ( !payloads.empty() )
+    {
+        return payloads;
+    }
+    const char *payloadDir = std::getenv( "FWE_BENCHMARK_PAYLOAD_DIR" );
+    if ( payloadDir != nullptr )
+    {
+        DIR *dir = opendir( payloadDir );
+        if ( dir != nullptr )
+        {
+            for ( auto entry = readdir( dir ); entry != nullptr; entry = readdir( dir ) )
+            {
+                if ( entry->d_type != DT_REG )
+                {
+                    continue;
+                }
+                std::ifstream file( std::string( payloadDir ) + "/" + entry->d_name, std::ios::binary );
+                payloads.emplace_back( std::istreambuf_iterator<char>( file ), std::istreambuf_iterator<char>() );
+            }
+            closedir( dir );
+        }
+        return payloads;
+    }
+    for ( uint32_t event = 0; event < 20; event++ )
+    {
+        Aws::IoTFleetWise::Schemas::VehicleDataMsg::VehicleData vehicleData;
+        vehicleData.set_campaign_arn( "arn:aws:iotfleetwise:us-west-2:123456789012:campaign/benchmark" );
+        vehicleData.set_decoder_arn( "arn:aws:iotfleetwise:us-west-2:123456789012:decoder-manifest/benchmark" );
+        vehicleData.set_collection_event_id( event );
+        vehicleData.set_collection_event_time_ms_epoch( 1600000000000 + ( event * 10000 ) );
+        for ( uint32_t signal = 0; signal < 40; signal++ )
+        {
+            auto period = 10U * ( 1U + ( signal % 10U ) );
+            for ( uint32_t sample = 0; sample < 1000U / period; sample++ )
+            {
+                auto capturedSignal = vehicleData.add_captured_signals();
+                capturedSignal->set_signal_id( 1000U + signal );
+                capturedSignal->set_relative_time_ms( -static_cast<int64_t>( sample * period ) );
+                capturedSignal->set_double_value(
+                    std::round( 500.0 * std::sin( ( event * 100U + sample ) * 0.01 + signal ) ) * 0.25 );
+            }
+        }
+        payloads.push_back( vehicleData.SerializeAsString() );
+    }
+    return payloads;
+}
+
+static void
+BM_compressPayloads( benchmark::State &state )
+{
+    static const std::vector<std::string> CODEC_NAMES = { "snappy", "lz4", "zstd" };
+    auto codecID = static_cast<size_t>( state.range( 0 ) );
+    std::string dictionaryFile;
+    const char *dictionary = std::getenv( "FWE_BENCHMARK_ZSTD_DICTIONARY" );
+    if ( ( codecID == static_cast<size_t>( CompressionCodecID::ZSTD ) ) && ( dictionary != nullptr ) )
+    {
+        dictionaryFile = dictionary;
+    }
+    PayloadCodec codec;
+    if ( !codec.init( CODEC_NAMES[codecID], static_cast<int>( state.range( 1 ) ), dictionaryFile ) )
+    {
+        state.SkipWithError( "Could not init the codec" );
+        return;
+    }
+    const auto &payloads = getPayloads();
+    if ( payloads.empty() )
+    {
+        state.SkipWithError( "No payloads" );
+        return;
+    }
+    std::vector<std::string> compressedPayloads( payloads.size() );
+    size_t uncompressedSize = 0U;
+    for ( const auto &payload : payloads )
+    {
+        uncompressedSize += payload.size();
+    }
+    for ( auto _ : state )
+    {
+        for ( size_t i = 0; i < payloads.size(); i++ )
+        {
+            auto &compressed = compressedPayloads[i];
+            compressed.resize( codec.getMaxCompressedSize( payloads[i].size() ) );
+            auto compressedSize = codec.compress( reinterpret_cast<const uint8_t *>( payloads[i].data() ),
+                                                  payloads[i].size(),
+                                                  reinterpret_cast<uint8_t *>( &compressed[0] ),
+                                                  compressed.size() );
+            compressed.resize( compressedSize );
+            benchmark::DoNotOptimize( compressed.data() );
+        }
+    }
+    size_t compressedSize = 0U;
+    for ( const auto &compressed : compressedPayloads )
+    {
+        compressedSize += compressed.size();
+    }
+    // Also measure the decompression, which the cloud and the retransmission of persisted payloads have to do
+    auto start = std::chrono::steady_clock::now();
+    std::string decompressed;
+    for ( const auto &compressed : compressedPayloads )
+    {
+        codec.decompress( codec.getCodecID(),
+                          reinterpret_cast<const uint8_t *>( compressed.data() ),
+                          compressed.size(),
+                          decompressed );
+        benchmark::DoNotOptimize( decompressed.data() );
+    }
+    auto decompressionTime = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+    state.counters["ratio"] = static_cast<double>( uncompressedSize ) / static_cast<double>( compressedSize );
+    state.counters["decompress_MB/s"] = static_cast<double>( uncompressedSize ) / 1e6 / decompressionTime;
+    state.SetBytesProcessed( static_cast<int64_t>( state.iterations() * uncompressedSize ) );
+}
+
+// Arguments: codec ID, compression level (only used by zstd)
+BENCHMARK( BM_compressPayloads )
+    ->ArgNames( { "codec", "level" } )
+    ->Args( { static_cast<int64_t>( CompressionCodecID::SNAPPY ), 0 } );
+#ifdef FWE_FEATURE_LZ4
+BENCHMARK( BM_compressPayloads )
+    ->ArgNames( { "codec", "level" } )
+    ->Args( { static_cast<int64_t>( CompressionCodecID::LZ4 ), 0 } );
+#endif // FWE_FEATURE_LZ4
+#ifdef FWE_FEATURE_ZSTD
+BENCHMARK( BM_compressPayloads )
+    ->ArgNames( { "codec", "level" } )
+    ->Args( { static_cast<int64_t>( CompressionCodecID::ZSTD ), 1 } )
+    ->Args( { static_cast<int64_t>( CompressionCodecID::ZSTD ), 3 } )
+    ->Args( { static_cast<int64_t>( CompressionCodecID::ZSTD ), 9 } );
+#endif // FWE_FEATURE_ZSTD
+
+BENCHMARK_MAIN();
@@ -0,0 +1,156 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include "CompressionCodec.h"
+#include <cstdio>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <snappy.h>
+
+using namespace Aws::IoTFleetWise::OffboardConnectivityAwsIot;
+
+namespace
+{
+
+std::string
+createTestPayload()
+{
+    std::string payload;
+    for ( int i = 0; i < 200; i++ )
+    {
+        payload += "signal_id:" + std::to_string( 1000 + ( i % 7 ) ) + " value:" + std::to_string( i * 0.5 ) + ';';
+    }
+    // Make sure the codecs handle null characters
+    payload += '\0';
+    payload += "end";
+    return payload;
+}
+
+std::string
+compressPayload( const PayloadCodec &codec, const std::string &payload )
+{
+    std::string compressed;
+    compressed.resize( codec.getMaxCompressedSize( payload.size() ) );
+    auto compressedSize = codec.compress( reinterpret_cast<const uint8_t *>( payload.data() ),
+                                          payload.size(),
+                                          reinterpret_cast<uint8_t *>( &compressed[0] ),
+                                          compressed.size() );
+    compressed.resize( compressedSize );
+    return compressed;
+}
+
+void
+checkRoundTrip( const PayloadCodec &codec )
+{
+    auto payload = createTestPayload();
+    auto compressed = compressPayload( codec, payload );
+    ASSERT_GT( compressed.size(), 0 );
+    std::string decompressed;
+    ASSERT_TRUE( codec.decompress( codec.getCodecID(),
+                                   reinterpret_cast<const uint8_t *>( compressed.data() ),
+                                   compressed.size(),
+                                   decompressed ) );
+    ASSERT_EQ( decompressed, payload );
+}
+
+} // namespace
+
+TEST( CompressionCodecTest, SnappyIsDefaultAndCompatible )
+{
+    PayloadCodec codec;
+    ASSERT_EQ( codec.getCodecID(), CompressionCodecID::SNAPPY );
+    checkRoundTrip( codec );
+
+    // Snappy payloads have no header, so the cloud can decompress them as before
+    auto payload = createTestPayload();
+    auto compressed = compressPayload( codec, payload );
+    std::string decompressed;
+    ASSERT_TRUE( snappy::Uncompress( compressed.data(), compressed.size(), &decompressed ) );
+    ASSERT_EQ( decompressed, payload );
+}
+
+TEST( CompressionCodecTest, InitSelectsCodec )
+{
+    PayloadCodec codec;
+    ASSERT_TRUE( codec.init( "snappy", 3, "" ) );
+    ASSERT_EQ( codec.getCodecID(), CompressionCodecID::SNAPPY );
+    ASSERT_FALSE( codec.init( "gzip", 3, "" ) );
+    ASSERT_EQ( codec.getCodecID(), CompressionCodecID::SNAPPY );
+#ifndef FWE_FEATURE_LZ4
+    ASSERT_FALSE( codec.init( "lz4", 3, "" ) );
+#endif
+#ifndef FWE_FEATURE_ZSTD
+    ASSERT_FALSE( codec.init( "zstd", 3, "" ) );
+#endif
+}
+
+TEST( CompressionCodecTest, UnavailableOrCorruptPayloadIsRejected )
+{
+    PayloadCodec codec;
+    std::string output;
+    const uint8_t garbage[] = { 0xFF, 'F', 'W', 0x01, 0x00, 0x01 };
+    ASSERT_FALSE( codec.decompress( static_cast<CompressionCodecID>( 100 ), garbage, sizeof( garbage ), output ) );
+    // The header must name the codec the record claims
+    ASSERT_FALSE( codec.decompress( CompressionCodecID::ZSTD, garbage, sizeof( garbage ), output ) );
+    ASSERT_FALSE( codec.decompress( CompressionCodecID::SNAPPY, garbage, sizeof( garbage ), output ) );
+}
+
+#ifdef FWE_FEATURE_LZ4
+TEST( CompressionCodecTest, LZ4RoundTrip )
+{
+    PayloadCodec codec;
+    ASSERT_TRUE( codec.init( "lz4", 0, "" ) );
+    ASSERT_EQ( codec.getCodecID(), CompressionCodecID::LZ4 );
+    checkRoundTrip( codec );
+    auto compressed = compressPayload( codec, createTestPayload() );
+    ASSERT_EQ( static_cast<uint8_t>( compressed[0] ), 0xFF );
+    ASSERT_EQ( compressed[3], static_cast<char>( CompressionCodecID::LZ4 ) );
+}
+#endif // FWE_FEATURE_LZ4
+
+#ifdef FWE_FEATURE_ZSTD
+TEST( CompressionCodecTest, ZstdRoundTrip )
+{
+    PayloadCodec codec;
+    ASSERT_TRUE( codec.init( "zstd", 19, "" ) );
+    ASSERT_EQ( codec.getCodecID(), CompressionCodecID::ZSTD );
+    checkRoundTrip( codec );
+}
+
+TEST( CompressionCodecTest, ZstdDictionary )
+{
+    PayloadCodec codec;
+    ASSERT_FALSE( codec.init( "zstd", 3, "does-not-exist.dict" ) );
+
+    // Raw content without the dictionary header has no ID, which is rejected
+    std::string dictionaryFile = "CompressionCodecTest-raw.dict";
+    {
+        std::ofstream file( dictionaryFile, std::ios::binary );
+        file << createTestPayload();
+    }
+    ASSERT_FALSE( codec.init( "zstd", 3, dictionaryFile ) );
+    std::remove( dictionaryFile.c_str() );
+
+    // Persisted payloads compressed with the previous configuration can be decompressed with the default one
+    ASSERT_TRUE( codec.init( "zstd", 3, "" ) );
+    auto payload = createTestPayload();
+    auto compressed = compressPayload( codec, payload );
+    PayloadCodec otherCodec;
+    std::string decompressed;
+    ASSERT_TRUE( otherCodec.decompress( CompressionCodecID::ZSTD,
+                                        reinterpret_cast<const uint8_t *>( compressed.data() ),
+                                        compressed.size(),
+                                        decompressed ) );
+    ASSERT_EQ( decompressed, payload );
+}
+#endif // FWE_FEATURE_ZSTD
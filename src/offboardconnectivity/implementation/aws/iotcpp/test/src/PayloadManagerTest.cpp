@@ -18,6 +18,7 @@
 #include <functional>
 #include <gtest/gtest.h>
 #include <list>
+#include <snappy.h>
 
 using namespace Aws::IoTFleetWise::Platform::Linux::PersistencyManagement;
 using namespace Aws::IoTFleetWise::OffboardConnectivity;
@@ -121,3 +122,93 @@ TEST( PayloadManagerTest, TestCompression )
         persistencyPtr->erase( DataType::EDGE_TO_CLOUD_PAYLOAD );
     }
 }
+
+TEST( PayloadManagerTest, TestRetrieveResumesAfterAcknowledgedData )
+{
+    char buffer[PATH_MAX];
+    if ( getcwd( buffer, sizeof( buffer ) ) != NULL )
+    {
+        // Use a directory of its own, as the test cases run in parallel
+        std::string path = std::string( buffer ) + "/testRetrieveResumes";
+        int ret = std::system( ( "rm -rf " + path + " && mkdir " + path ).c_str() );
+        ASSERT_EQ( ret, 0 );
+        const std::shared_ptr<CacheAndPersist> persistencyPtr = std::make_shared<CacheAndPersist>( path, 131072 );
+        ASSERT_TRUE( persistencyPtr->init() );
+        PayloadManager testSend( persistencyPtr );
+
+        CollectionSchemeParams collectionSchemeParams;
+        collectionSchemeParams.persist = true;
+        collectionSchemeParams.compression = false;
+        std::vector<std::string> testData = { "payload 1", "payload 2", "payload 3" };
+        for ( const auto &data : testData )
+        {
+            ASSERT_TRUE( testSend.storeData(
+                reinterpret_cast<const uint8_t *>( data.data() ), data.size(), collectionSchemeParams ) );
+        }
+
+        // Only the first payload is transmitted successfully
+        auto cursor = testSend.getRetrieveCursor();
+        std::vector<std::string> payloads;
+        ASSERT_EQ( testSend.retrieveNextPayloads( cursor, payloads ), ErrorCode::SUCCESS );
+        ASSERT_EQ( payloads, std::vector<std::string>{ testData[0] } );
+        ASSERT_EQ( testSend.acknowledgeRetrievedData( cursor ), ErrorCode::SUCCESS );
+        payloads.clear();
+        ASSERT_EQ( testSend.retrieveNextPayloads( cursor, payloads ), ErrorCode::SUCCESS );
+
+        // The next retrieval starts at the first payload that was not acknowledged
+        payloads.clear();
+        ASSERT_EQ( testSend.retrieveData( payloads ), ErrorCode::SUCCESS );
+        ASSERT_EQ( payloads, std::vector<std::string>( testData.begin() + 1, testData.end() ) );
+
+        cursor = testSend.getRetrieveCursor();
+        payloads.clear();
+        while ( testSend.retrieveNextPayloads( cursor, payloads ) == ErrorCode::SUCCESS )
+        {
+        }
+        ASSERT_EQ( testSend.acknowledgeRetrievedData( cursor ), ErrorCode::SUCCESS );
+        payloads.clear();
+        ASSERT_EQ( testSend.retrieveData( payloads ), ErrorCode::EMPTY );
+        ret = std::system( ( "rm -rf " + path ).c_str() );
+        static_cast<void>( ret );
+    }
+}
+
+TEST( PayloadManagerTest, TestRecordsOfPreviousVersionAreReadable )
+{
+    char buffer[PATH_MAX];
+    if ( getcwd( buffer, sizeof( buffer ) ) != NULL )
+    {
+        // Use a directory of its own, as the test cases run in parallel
+        std::string path = std::string( buffer ) + "/testPreviousVersion";
+        int ret = std::system( ( "rm -rf " + path + " && mkdir " + path ).c_str() );
+        ASSERT_EQ( ret, 0 );
+        const std::shared_ptr<CacheAndPersist> persistencyPtr = std::make_shared<CacheAndPersist>( path, 131072 );
+        ASSERT_TRUE( persistencyPtr->init() );
+
+        // Header as written before the codec ID was added
+#pragma pack( push, 1 )
+        struct PreviousPayloadHeader
+        {
+            bool compressionRequired;
+            size_t size;
+        };
+#pragma pack( pop )
+        std::string testData = "abcdefjh!24$iklmnop!24$3@qrstuvwxyz";
+        std::string compressedData;
+        ASSERT_TRUE( snappy::Compress( testData.data(), testData.size(), &compressedData ) );
+        PreviousPayloadHeader header{ false, compressedData.size() };
+        std::string record( reinterpret_cast<const char *>( &header ), sizeof( header ) );
+        record += compressedData;
+        ASSERT_EQ( persistencyPtr->write( reinterpret_cast<const uint8_t *>( record.data() ),
+                                          record.size(),
+                                          DataType::EDGE_TO_CLOUD_PAYLOAD ),
+                   ErrorCode::SUCCESS );
+
+        PayloadManager testSend( persistencyPtr );
+        std::vector<std::string> payloads;
+        ASSERT_EQ( testSend.retrieveData( payloads ), ErrorCode::SUCCESS );
+        ASSERT_EQ( payloads, std::vector<std::string>{ testData } );
+        ret = std::system( ( "rm -rf " + path ).c_str() );
+        static_cast<void>( ret );
+    }
+}
@@ -44,6 +44,7 @@ public:
     /**
      * @brief Logs a log message to the standard output. Includes current Thread ID and timestamp.
      *        The log message has this structure : [Thread : ID] [Time] [Level] [function]: [Message]
+     *        The message is only queued here, the LogWriter thread formats and prints it.
      * @param level log level
      * @param function calling function
      * @param logEntry actual message
@@ -51,13 +52,6 @@ public:
     void logMessage( LogLevel level, const std::string &function, const std::string &logEntry ) override;
 
 private:
-    /**
-     * @brief Time stamp as a String. The actual timestamp conversion and format happens
-     *        in the Clock API
-     * @return the current time in a string representation as it's defined in the clock.
-     */
-    static std::string timeAsString();
-
     /**
      * @brief Current Thread ID that's logging the message.
      * @return Thread ID.
@@ -56,6 +56,15 @@ public:
  */
 extern void setLogForwarding( ILogger *logForwarder );
 
+/**
+ * @brief Forwards a log message to the instance set with setLogForwarding, if any
+ *
+ * @param level log level
+ * @param function calling function
+ * @param logEntry actual message
+ */
+extern void forwardLog( LogLevel level, const std::string &function, const std::string &logEntry );
+
 } // namespace Linux
 } // namespace Platform
 } // namespace IoTFleetWise
@@ -0,0 +1,129 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+
+#pragma once
+
+// Includes
+#include <array>
+#include <cstdint>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace Platform
+{
+namespace Linux
+{
+/**
+ * @brief Histogram of latencies with logarithmically growing buckets, similar to HdrHistogram.
+ *
+ * Every power of two range is split into SUB_BUCKET_COUNT linear buckets, so the value reported for a
+ * percentile is at most 1/SUB_BUCKET_COUNT above the real value, independent of its magnitude.
+ * Values up to 2^MAX_VALUE_BITS - 1 are tracked, bigger values are counted into the last bucket.
+ * The unit of the values is up to the user e.g. milliseconds or microseconds.
+ *
+ * This class is not thread safe. For recording from multiple threads use TraceModule::addToHistogram.
+ */
+class LatencyHistogram
+{
+public:
+    static constexpr uint32_t SUB_BUCKET_BITS = 3U;
+    static constexpr uint32_t SUB_BUCKET_COUNT = 1U << SUB_BUCKET_BITS;
+    static constexpr uint32_t MAX_VALUE_BITS = 32U;
+    static constexpr uint32_t BUCKET_COUNT = ( MAX_VALUE_BITS - SUB_BUCKET_BITS + 1U ) * SUB_BUCKET_COUNT;
+
+    /**
+     * @brief Get the index of the bucket which counts the given value
+     * @param value the recorded value
+     * @return index between 0 and BUCKET_COUNT - 1
+     */
+    static uint32_t getBucketIndex( uint64_t value );
+
+    /**
+     * @brief Get the highest value that is counted in the bucket
+     * @param index the bucket index
+     * @return the highest value of the bucket
+     */
+    static uint64_t getBucketUpperBound( uint32_t index );
+
+    /**
+     * @brief Record a single value
+     * @param value the value e.g. a latency
+     */
+    void record( uint64_t value );
+
+    /**
+     * @brief Add a number of values to a bucket. Used together with addStatistics to merge histograms that
+     *        were recorded somewhere else e.g. in another thread.
+     * @param index the bucket index
+     * @param count number of values to add to the bucket
+     */
+    void addToBucket( uint32_t index, uint64_t count );
+
+    /**
+     * @brief Add the sum and the maximum of values that were added with addToBucket
+     * @param sum sum of the values
+     * @param max the biggest of the values
+     */
+    void addStatistics( uint64_t sum, uint64_t max );
+
+    /**
+     * @brief Remove the values of an older snapshot of the same histogram, so that only the values recorded
+     *        since the snapshot remain. The max value is kept.
+     * @param olderSnapshot the snapshot of this histogram taken earlier
+     */
+    void subtract( const LatencyHistogram &olderSnapshot );
+
+    /**
+     * @brief Get the number of recorded values
+     */
+    uint64_t
+    getCount() const
+    {
+        return mCount;
+    }
+
+    /**
+     * @brief Get the average of the recorded values, 0 if nothing was recorded
+     */
+    double getMean() const;
+
+    /**
+     * @brief Get the value at the given percentile
+     * @param percentile between 0 and 100
+     * @return the upper bound of the bucket the percentile falls into but not bigger than the biggest
+     *         value recorded. 0 if nothing was recorded.
+     */
+    uint64_t getPercentile( double percentile ) const;
+
+    /**
+     * @brief Get the biggest recorded value, 0 if nothing was recorded
+     */
+    uint64_t
+    getMax() const
+    {
+        return getPercentile( 100.0 );
+    }
+
+private:
+    std::array<uint64_t, BUCKET_COUNT> mBuckets{};
+    uint64_t mCount{ 0 };
+    uint64_t mSum{ 0 };
+    uint64_t mMax{ 0 };
+};
+} // namespace Linux
+} // namespace Platform
+} // namespace IoTFleetWise
+} // namespace Aws
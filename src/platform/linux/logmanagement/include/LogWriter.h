@@ -0,0 +1,144 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+
+#pragma once
+
+#if defined( IOTFLEETWISE_LINUX )
+// Includes
+#include "LogLevel.h"
+#include "Thread.h"
+#include "TimeTypes.h"
+#include <atomic>
+#include <boost/lockfree/spsc_queue.hpp>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace Platform
+{
+namespace Linux
+{
+/**
+ * @brief Writes the log messages of all threads to the standard output on a background thread, and
+ * forwards them from there to the log forwarder set with setLogForwarding.
+ *
+ * Every logging thread has its own lock-free single producer single consumer queue. Logging a message
+ * only copies it into that queue, the message line is formatted and printed by the writer thread. So
+ * the logging threads neither block on the standard output, nor on the log forwarder, nor on each other.
+ * Messages that do not fit into the queue of a thread are dropped, and the number of dropped messages
+ * is logged once there is space again. If the writer thread can not be started, the messages are written
+ * synchronously by the logging threads instead.
+ */
+class LogWriter
+{
+public:
+    static constexpr size_t LOG_QUEUE_SIZE = 256;
+    // The writer thread checks the queues at least this often
+    static constexpr uint32_t IDLE_TIME_MS = 100;
+
+    /**
+     * @brief Returns the writer, and starts the writer thread on the first call
+     */
+    static LogWriter &get();
+
+    /**
+     * @brief Checks whether the writer can take messages. This is not the case if the writer thread could
+     *        not be started, or once the writer was destroyed during the process exit.
+     */
+    static bool isAvailable();
+
+    /**
+     * @brief Queues a message to be written by the writer thread. Never blocks.
+     * @param level log level
+     * @param function calling function
+     * @param logEntry actual message
+     */
+    void write( LogLevel level, const std::string &function, const std::string &logEntry );
+
+    /**
+     * @brief Writes all queued messages on the calling thread before returning
+     */
+    void flush();
+
+    /**
+     * @brief Formats the log line and writes it to the standard output, then forwards the message.
+     *        Used by the writer thread, and directly by the logging thread when the writer is not available.
+     * @param timestamp time the message was logged at, taken from ClockHandler::getClock()
+     */
+    static void writeLine( LogLevel level,
+                           uint64_t threadId,
+                           Timestamp timestamp,
+                           const std::string &function,
+                           const std::string &logEntry );
+
+    ~LogWriter();
+
+    LogWriter( const LogWriter & ) = delete;
+    LogWriter &operator=( const LogWriter & ) = delete;
+    LogWriter( LogWriter && ) = delete;
+    LogWriter &operator=( LogWriter && ) = delete;
+
+private:
+    struct LogEntry
+    {
+        LogLevel level{ LogLevel::Off };
+        Timestamp timestamp{ 0 };
+        std::string function;
+        std::string logEntry;
+    };
+
+    struct ThreadQueue
+    {
+        explicit ThreadQueue( uint64_t id )
+            : threadId( id )
+        {
+        }
+        uint64_t threadId;
+        boost::lockfree::spsc_queue<LogEntry> entries{ LOG_QUEUE_SIZE };
+        std::atomic<uint64_t> droppedEntries{ 0 };
+        // Set when the thread exited, so that the queue is removed once it is empty
+        std::atomic<bool> threadExited{ false };
+    };
+
+    LogWriter();
+
+    // Returns the queue of the calling thread, creating it on the first call from this thread
+    ThreadQueue &getThreadQueue();
+    static void doWork( void *data );
+    // Writes the messages from all queues. Returns true if any message was written.
+    bool drainQueues();
+    bool hasQueuedEntries();
+
+    std::mutex mQueuesMutex;
+    std::vector<std::shared_ptr<ThreadQueue>> mQueues;
+    // Only one thread at a time may consume from the queues
+    std::mutex mDrainMutex;
+    std::mutex mWakeUpMutex;
+    std::condition_variable mWakeUp;
+    std::atomic<bool> mWriterIdle{ false };
+    std::atomic<bool> mShouldStop{ false };
+    Thread mThread;
+};
+} // namespace Linux
+} // namespace Platform
+} // namespace IoTFleetWise
+} // namespace Aws
+#endif // IOTFLEETWISE_LINUX
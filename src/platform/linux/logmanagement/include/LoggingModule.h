@@ -38,6 +38,18 @@ public:
 
     LoggingModule();
 
+    /**
+     * @brief Checks whether messages of the given level are logged at all. Used to skip building
+     *        log messages that would be discarded anyway.
+     * @param level log level
+     * @return True if the level is at or above the system wide log level
+     */
+    static bool
+    isEnabled( LogLevel level )
+    {
+        return level >= gSystemWideLogLevel;
+    }
+
     /**
      * @brief Logs an Error
      * @param function Calling function
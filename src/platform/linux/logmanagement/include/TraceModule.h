@@ -15,11 +15,15 @@
 
 // Includes
 #include "EnumUtility.h"
+#include "LatencyHistogram.h"
 #include "LoggingModule.h"
 #include <algorithm>
 #include <atomic>
 #include <chrono>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <vector>
 
 namespace Aws
 {
@@ -95,6 +99,16 @@ enum class TraceVariable
     OBD_KEEP_ALIVE_ERROR,
     DISCARDED_FRAMES,
     CAN_POLLING_TIMESTAMP_COUNTER,
+    CE_SAMPLE_MEMORY_BYTES,
+    CE_SAMPLE_MEMORY_SAVED_BYTES,
+    DS_PAYLOAD_SIZE,
+    // Number of payloads per fill level of the maximum payload size, keep in this order
+    DS_PAYLOAD_FILL_25,
+    DS_PAYLOAD_FILL_50,
+    DS_PAYLOAD_FILL_75,
+    DS_PAYLOAD_FILL_100,
+    DS_PAYLOAD_OVERSIZE,
+    OBD_REQUEST_TIMEOUT,
     TRACE_VARIABLE_SIZE
 };
 
@@ -109,6 +123,7 @@ enum class TraceAtomicVariable
     CONNECTION_REJECTED,
     CONNECTION_INTERRUPTED,
     CONNECTION_RESUMED,
+    CAN_FILTERED_FRAMES,
     TRACE_ATOMIC_VARIABLE_SIZE
 };
 
@@ -126,6 +141,23 @@ enum class TraceSection
     MANAGER_EXTRACTION,
     TRACE_SECTION_SIZE
 };
+
+/**
+ * Different histograms defined at compile time used by all other modules
+ * For verbose print to work it needs to be also added to getHistogramName() and getHistogramUnit()
+ * */
+enum class TraceHistogram
+{
+    // Latencies of the data path, measured from the reception timestamp of the CAN frame in milliseconds
+    CAN_TO_CONSUMER_LATENCY = 0,
+    CAN_TO_INSPECTION_LATENCY,
+    CAN_TO_PUBLISH_LATENCY,
+    // Time from the trigger of a condition until the sender picked up the collected data in milliseconds
+    TRIGGER_TO_SENDER_LATENCY,
+    // Execution time of one evaluation of all conditions in microseconds
+    CE_EVALUATE_CONDITIONS_TIME,
+    TRACE_HISTOGRAM_SIZE
+};
 /**
  * @brief An interface that can be implemented by different classes to store or upload metrics
  */
@@ -219,6 +251,27 @@ public:
         addToVariable( variable, 1 );
     }
 
+    /**
+     * @brief Set a variable defined in enum TraceAtomicVariable to trace its value
+     *
+     * Useful for values that are sampled by a single thread, like the fill level of a queue seen by its consumer,
+     * instead of being incremented and decremented by all producers and consumers.
+     *
+     * @param variable the variable define in enum TraceAtomicVariable
+     * @param value the uint64_t value that should be traced
+     *
+     */
+    void
+    setAtomicVariable( TraceAtomicVariable variable, uint64_t value )
+    {
+        if ( variable < TraceAtomicVariable::TRACE_ATOMIC_VARIABLE_SIZE )
+        {
+            mAtomicVariableData[toUType( variable )].mCurrentValue.store( value );
+            mAtomicVariableData[toUType( variable )].mMaxValue =
+                std::max( value, mAtomicVariableData[toUType( variable )].mMaxValue );
+        }
+    }
+
     /**
      * @brief Add to a variable defined in enum TraceAtomicVariable to trace its value
      *
@@ -349,6 +402,45 @@ public:
      */
     void sectionEnd( TraceSection section );
 
+    /**
+     * @brief Record a value in a histogram defined in enum TraceHistogram
+     *
+     * Every thread records into its own copy of the histograms, so this is lock free and does not need
+     * any atomic read-modify-write operation. The copies are merged when the histogram is read.
+     * The memory for the copies of a thread is allocated on its first call.
+     *
+     * @param histogram the histogram defined in enum TraceHistogram
+     * @param value the value e.g. a latency in the unit of the histogram
+     */
+    void addToHistogram( TraceHistogram histogram, uint64_t value );
+
+    /**
+     * @brief Record the time between two timestamps in a histogram defined in enum TraceHistogram
+     *
+     * Nothing is recorded if the end is before the start, which can happen if the timestamps come from
+     * different clocks e.g. hardware timestamps of CAN frames.
+     *
+     * @param histogram the histogram defined in enum TraceHistogram
+     * @param startTime the timestamp when the measured stage started
+     * @param endTime the timestamp when the measured stage ended
+     */
+    void
+    addLatencyToHistogram( TraceHistogram histogram, uint64_t startTime, uint64_t endTime )
+    {
+        if ( endTime >= startTime )
+        {
+            addToHistogram( histogram, endTime - startTime );
+        }
+    }
+
+    /**
+     * @brief Get all values recorded from all threads since startup in a histogram
+     * @param histogram the histogram defined in enum TraceHistogram
+     *
+     * @return the merged histogram
+     */
+    LatencyHistogram getHistogram( TraceHistogram histogram );
+
     /**
      * @brief Starts a new observation window for all variables and sections
      *
@@ -371,6 +463,7 @@ public:
      *
      * Any usage of the metrics that is not printing them to stdout should be implemented over
      * an IMetricsReceiver. The profiler pointer is not stored inside the class
+     * The percentiles of the histograms "since last" cover the values recorded since the previous call.
      * @param profiler The instance that all data should be sent.
      */
     void forwardAllMetricsToMetricsReceiver( IMetricsReceiver *profiler );
@@ -382,6 +475,10 @@ private:
 
     static const char *getSectionName( TraceSection section );
 
+    static const char *getHistogramName( TraceHistogram histogram );
+
+    static const char *getHistogramUnit( TraceHistogram histogram );
+
     void updateAllTimeData();
 
     struct VariableData
@@ -412,12 +509,36 @@ private:
         bool mCurrentlyActive;
     };
 
+    /**
+     * @brief The copy of one histogram that is written by exactly one thread and read by any thread
+     */
+    struct HistogramShard
+    {
+        std::atomic<uint64_t> mBuckets[LatencyHistogram::BUCKET_COUNT];
+        std::atomic<uint64_t> mSum;
+        std::atomic<uint64_t> mMax;
+    };
+
+    struct ThreadHistograms
+    {
+        HistogramShard mHistograms[toUType( TraceHistogram::TRACE_HISTOGRAM_SIZE )];
+    };
+
+    ThreadHistograms &getThreadHistograms();
+
     struct VariableData mVariableData[toUType( TraceVariable::TRACE_VARIABLE_SIZE )];
 
     struct AtomicVariableData mAtomicVariableData[toUType( TraceAtomicVariable::TRACE_ATOMIC_VARIABLE_SIZE )];
 
     struct SectionData mSectionData[toUType( TraceSection::TRACE_SECTION_SIZE )];
 
+    // Threads are never removed, as the values they recorded stay part of the histograms
+    std::mutex mThreadHistogramsMutex;
+    std::vector<std::unique_ptr<ThreadHistograms>> mThreadHistograms;
+
+    // The histograms at the last call of forwardAllMetricsToMetricsReceiver
+    LatencyHistogram mLastForwardedHistograms[toUType( TraceHistogram::TRACE_HISTOGRAM_SIZE )];
+
     LoggingModule mLogger;
 };
 } // namespace Linux
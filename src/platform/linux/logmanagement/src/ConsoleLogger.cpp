@@ -16,11 +16,9 @@
 
 #include "ConsoleLogger.h"
 #include "ClockHandler.h"
-#include <chrono>
-#include <cinttypes>
-#include <iomanip>
+#include "LogWriter.h"
+#include <cstdio>
 #include <mutex>
-#include <sstream>
 #include <sys/syscall.h>
 #include <unistd.h>
 
@@ -67,25 +65,20 @@ ConsoleLogger::logMessage( LogLevel level, const std::string &function, const st
 {
     if ( level >= gSystemWideLogLevel )
     {
-        std::printf( "[Thread : %" PRIu64 "] [%s] [%s] [%s]: [%s] ",
-                     currentThreadId(),
-                     timeAsString().c_str(),
-                     levelToString( level ).c_str(),
-                     function.c_str(),
-                     logEntry.c_str() );
-        std::printf( "\n" );
-        std::fflush( stdout );
-        forwardLog( level, function, logEntry );
+        if ( LogWriter::isAvailable() )
+        {
+            LogWriter::get().write( level, function, logEntry );
+        }
+        else
+        {
+            // During the process exit once the writer thread is gone, or if it could not be started
+            LogWriter::writeLine(
+                level, currentThreadId(), ClockHandler::getClock()->timeSinceEpochMs(), function, logEntry );
+            std::fflush( stdout );
+        }
     }
 }
 
-std::string
-ConsoleLogger::timeAsString()
-{
-    auto clock = ClockHandler::getClock();
-    return clock->timestampToString();
-}
-
 const std::string &
 ILogger::levelToString( LogLevel level )
 {
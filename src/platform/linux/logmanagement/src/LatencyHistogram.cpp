@@ -0,0 +1,137 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+
+// Includes
+#include "LatencyHistogram.h"
+#include <algorithm>
+#include <cmath>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace Platform
+{
+namespace Linux
+{
+
+constexpr uint32_t LatencyHistogram::SUB_BUCKET_BITS;
+constexpr uint32_t LatencyHistogram::SUB_BUCKET_COUNT;
+constexpr uint32_t LatencyHistogram::MAX_VALUE_BITS;
+constexpr uint32_t LatencyHistogram::BUCKET_COUNT;
+
+uint32_t
+LatencyHistogram::getBucketIndex( uint64_t value )
+{
+    if ( value < SUB_BUCKET_COUNT )
+    {
+        return static_cast<uint32_t>( value );
+    }
+    if ( value >= ( static_cast<uint64_t>( 1U ) << MAX_VALUE_BITS ) )
+    {
+        return BUCKET_COUNT - 1U;
+    }
+    // The highest bit selects the power of two range, the next SUB_BUCKET_BITS bits the bucket inside of it
+    auto highestBit = static_cast<uint32_t>( 63 - __builtin_clzll( value ) );
+    auto shift = highestBit - SUB_BUCKET_BITS;
+    return ( ( shift + 1U ) * SUB_BUCKET_COUNT ) +
+           static_cast<uint32_t>( ( value >> shift ) & ( SUB_BUCKET_COUNT - 1U ) );
+}
+
+uint64_t
+LatencyHistogram::getBucketUpperBound( uint32_t index )
+{
+    if ( index < SUB_BUCKET_COUNT )
+    {
+        return index;
+    }
+    auto shift = ( index / SUB_BUCKET_COUNT ) - 1U;
+    uint64_t lowerBound = static_cast<uint64_t>( SUB_BUCKET_COUNT + ( index % SUB_BUCKET_COUNT ) ) << shift;
+    return lowerBound + ( static_cast<uint64_t>( 1U ) << shift ) - 1U;
+}
+
+void
+LatencyHistogram::record( uint64_t value )
+{
+    mBuckets[getBucketIndex( value )]++;
+    mCount++;
+    mSum += value;
+    mMax = std::max( mMax, value );
+}
+
+void
+LatencyHistogram::addToBucket( uint32_t index, uint64_t count )
+{
+    if ( index < BUCKET_COUNT )
+    {
+        mBuckets[index] += count;
+        mCount += count;
+    }
+}
+
+void
+LatencyHistogram::addStatistics( uint64_t sum, uint64_t max )
+{
+    mSum += sum;
+    mMax = std::max( mMax, max );
+}
+
+void
+LatencyHistogram::subtract( const LatencyHistogram &olderSnapshot )
+{
+    for ( uint32_t i = 0; i < BUCKET_COUNT; i++ )
+    {
+        mBuckets[i] -= std::min( mBuckets[i], olderSnapshot.mBuckets[i] );
+    }
+    mCount -= std::min( mCount, olderSnapshot.mCount );
+    mSum -= std::min( mSum, olderSnapshot.mSum );
+}
+
+double
+LatencyHistogram::getMean() const
+{
+    if ( mCount == 0U )
+    {
+        return 0.0;
+    }
+    return static_cast<double>( mSum ) / static_cast<double>( mCount );
+}
+
+uint64_t
+LatencyHistogram::getPercentile( double percentile ) const
+{
+    if ( mCount == 0U )
+    {
+        return 0U;
+    }
+    percentile = std::min( std::max( percentile, 0.0 ), 100.0 );
+    // The rank of the value in the sorted list of all recorded values, at least the first value
+    auto rank = static_cast<uint64_t>( std::ceil( ( percentile / 100.0 ) * static_cast<double>( mCount ) ) );
+    rank = std::max<uint64_t>( rank, 1U );
+    uint64_t countedValues = 0U;
+    for ( uint32_t i = 0; i < BUCKET_COUNT; i++ )
+    {
+        countedValues += mBuckets[i];
+        if ( countedValues >= rank )
+        {
+            return std::min( getBucketUpperBound( i ), mMax );
+        }
+    }
+    return mMax;
+}
+
+} // namespace Linux
+} // namespace Platform
+} // namespace IoTFleetWise
+} // namespace Aws
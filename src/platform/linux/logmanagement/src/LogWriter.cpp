@@ -0,0 +1,236 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+
+#if defined( IOTFLEETWISE_LINUX )
+// Includes
+#include "LogWriter.h"
+#include "ClockHandler.h"
+#include "ILogger.h"
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace Platform
+{
+namespace Linux
+{
+constexpr size_t LogWriter::LOG_QUEUE_SIZE;
+constexpr uint32_t LogWriter::IDLE_TIME_MS;
+
+// Trivially destructible, so that it can still be checked after the writer was destroyed
+static std::atomic<bool> gLogWriterAvailable( false );
+
+LogWriter &
+LogWriter::get()
+{
+    static LogWriter writer;
+    return writer;
+}
+
+bool
+LogWriter::isAvailable()
+{
+    if ( !gLogWriterAvailable.load( std::memory_order_acquire ) )
+    {
+        // Not yet created or already destroyed. Creating it is only attempted once.
+        static bool created = ( get(), true );
+        (void)created;
+    }
+    return gLogWriterAvailable.load( std::memory_order_acquire );
+}
+
+LogWriter::LogWriter()
+{
+    if ( !mThread.create( doWork, this ) )
+    {
+        // Not available, so the messages are written synchronously by the logging threads
+        return;
+    }
+    mThread.setThreadName( "fwPLLogWriter" );
+    gLogWriterAvailable.store( true, std::memory_order_release );
+}
+
+LogWriter::~LogWriter()
+{
+    gLogWriterAvailable.store( false, std::memory_order_release );
+    mShouldStop.store( true );
+    {
+        std::lock_guard<std::mutex> lock( mWakeUpMutex );
+        mWakeUp.notify_one();
+    }
+    if ( mThread.isValid() )
+    {
+        mThread.release();
+    }
+    // The thread skips its work if it is released before it started, so write what is left here
+    drainQueues();
+}
+
+LogWriter::ThreadQueue &
+LogWriter::getThreadQueue()
+{
+    // Marks the queue when its thread exits, the writer thread then removes it once it is drained
+    struct ThreadQueueHandle
+    {
+        ~ThreadQueueHandle()
+        {
+            if ( queue != nullptr )
+            {
+                queue->threadExited.store( true );
+            }
+        }
+        std::shared_ptr<ThreadQueue> queue;
+    };
+    static thread_local ThreadQueueHandle handle;
+    if ( handle.queue == nullptr )
+    {
+        handle.queue = std::make_shared<ThreadQueue>( static_cast<uint64_t>( syscall( SYS_gettid ) ) );
+        std::lock_guard<std::mutex> lock( mQueuesMutex );
+        mQueues.emplace_back( handle.queue );
+    }
+    return *handle.queue;
+}
+
+void
+LogWriter::write( LogLevel level, const std::string &function, const std::string &logEntry )
+{
+    auto &queue = getThreadQueue();
+    LogEntry entry;
+    entry.level = level;
+    entry.timestamp = ClockHandler::getClock()->timeSinceEpochMs();
+    entry.function = function;
+    entry.logEntry = logEntry;
+    if ( !queue.entries.push( entry ) )
+    {
+        queue.droppedEntries.fetch_add( 1, std::memory_order_relaxed );
+        return;
+    }
+    // Only wake up the writer thread if it went to sleep
+    if ( mWriterIdle.load() )
+    {
+        std::lock_guard<std::mutex> lock( mWakeUpMutex );
+        mWakeUp.notify_one();
+    }
+}
+
+void
+LogWriter::flush()
+{
+    drainQueues();
+}
+
+void
+LogWriter::doWork( void *data )
+{
+    auto *writer = static_cast<LogWriter *>( data );
+    while ( true )
+    {
+        if ( writer->drainQueues() )
+        {
+            continue;
+        }
+        if ( writer->mShouldStop.load() )
+        {
+            break;
+        }
+        std::unique_lock<std::mutex> lock( writer->mWakeUpMutex );
+        writer->mWriterIdle.store( true );
+        // Check again after announcing the sleep, so that a message queued in between is not delayed
+        if ( !writer->hasQueuedEntries() && !writer->mShouldStop.load() )
+        {
+            writer->mWakeUp.wait_for( lock, std::chrono::milliseconds( IDLE_TIME_MS ) );
+        }
+        writer->mWriterIdle.store( false );
+    }
+}
+
+bool
+LogWriter::hasQueuedEntries()
+{
+    std::lock_guard<std::mutex> lock( mQueuesMutex );
+    for ( const auto &queue : mQueues )
+    {
+        if ( queue->entries.read_available() > 0 )
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool
+LogWriter::drainQueues()
+{
+    std::lock_guard<std::mutex> drainLock( mDrainMutex );
+    std::vector<std::shared_ptr<ThreadQueue>> queues;
+    {
+        std::lock_guard<std::mutex> lock( mQueuesMutex );
+        queues = mQueues;
+    }
+    bool written = false;
+    for ( const auto &queue : queues )
+    {
+        bool threadExited = queue->threadExited.load();
+        auto writtenEntries = queue->entries.consume_all( [&queue]( const LogEntry &entry ) {
+            writeLine( entry.level, queue->threadId, entry.timestamp, entry.function, entry.logEntry );
+        } );
+        written = written || ( writtenEntries > 0 );
+        auto droppedEntries = queue->droppedEntries.exchange( 0, std::memory_order_relaxed );
+        if ( droppedEntries > 0 )
+        {
+            writeLine( LogLevel::Warning,
+                       queue->threadId,
+                       ClockHandler::getClock()->timeSinceEpochMs(),
+                       "LogWriter::drainQueues",
+                       "Dropped " + std::to_string( droppedEntries ) + " log messages" );
+        }
+        if ( threadExited )
+        {
+            // The thread pushed its last message before it exited, so the queue is empty now
+            std::lock_guard<std::mutex> lock( mQueuesMutex );
+            mQueues.erase( std::remove( mQueues.begin(), mQueues.end(), queue ), mQueues.end() );
+        }
+    }
+    if ( written )
+    {
+        std::fflush( stdout );
+    }
+    return written;
+}
+
+void
+LogWriter::writeLine(
+    LogLevel level, uint64_t threadId, Timestamp timestamp, const std::string &function, const std::string &logEntry )
+{
+    std::printf( "[Thread : %" PRIu64 "] [%s] [%s] [%s]: [%s] \n",
+                 threadId,
+                 ClockHandler::getClock()->timestampToString( timestamp ).c_str(),
+                 ILogger::levelToString( level ).c_str(),
+                 function.c_str(),
+                 logEntry.c_str() );
+    forwardLog( level, function, logEntry );
+}
+
+} // namespace Linux
+} // namespace Platform
+} // namespace IoTFleetWise
+} // namespace Aws
+#endif // IOTFLEETWISE_LINUX
@@ -61,6 +61,66 @@ TraceModule::sectionEnd( TraceSection section )
     }
 }
 
+/*
+ * return the histograms of the calling thread, registering them on the first call from this thread
+ */
+TraceModule::ThreadHistograms &
+TraceModule::getThreadHistograms()
+{
+    // TraceModule is a singleton, so a function static is enough to find the histograms of the calling thread
+    static thread_local ThreadHistograms *threadHistograms = nullptr;
+    if ( threadHistograms == nullptr )
+    {
+        // Value initialization sets all counters to zero
+        auto newThreadHistograms = std::make_unique<ThreadHistograms>();
+        threadHistograms = newThreadHistograms.get();
+        std::lock_guard<std::mutex> lock( mThreadHistogramsMutex );
+        mThreadHistograms.emplace_back( std::move( newThreadHistograms ) );
+    }
+    return *threadHistograms;
+}
+
+void
+TraceModule::addToHistogram( TraceHistogram histogram, uint64_t value )
+{
+    if ( histogram >= TraceHistogram::TRACE_HISTOGRAM_SIZE )
+    {
+        return;
+    }
+    auto &shard = getThreadHistograms().mHistograms[toUType( histogram )];
+    // Only the calling thread writes to its shard, so a relaxed load and store is enough and
+    // readers see every value eventually
+    auto &bucket = shard.mBuckets[LatencyHistogram::getBucketIndex( value )];
+    bucket.store( bucket.load( std::memory_order_relaxed ) + 1U, std::memory_order_relaxed );
+    shard.mSum.store( shard.mSum.load( std::memory_order_relaxed ) + value, std::memory_order_relaxed );
+    if ( value > shard.mMax.load( std::memory_order_relaxed ) )
+    {
+        shard.mMax.store( value, std::memory_order_relaxed );
+    }
+}
+
+LatencyHistogram
+TraceModule::getHistogram( TraceHistogram histogram )
+{
+    LatencyHistogram result;
+    if ( histogram >= TraceHistogram::TRACE_HISTOGRAM_SIZE )
+    {
+        return result;
+    }
+    std::lock_guard<std::mutex> lock( mThreadHistogramsMutex );
+    for ( const auto &threadHistograms : mThreadHistograms )
+    {
+        const auto &shard = threadHistograms->mHistograms[toUType( histogram )];
+        for ( uint32_t i = 0; i < LatencyHistogram::BUCKET_COUNT; i++ )
+        {
+            result.addToBucket( i, shard.mBuckets[i].load( std::memory_order_relaxed ) );
+        }
+        result.addStatistics( shard.mSum.load( std::memory_order_relaxed ),
+                              shard.mMax.load( std::memory_order_relaxed ) );
+    }
+    return result;
+}
+
 /*
  * return the name that should be as short as possible but still meaningful
  */
@@ -183,6 +243,24 @@ TraceModule::getVariableName( TraceVariable variable )
         return "FrmE0";
     case TraceVariable::CAN_POLLING_TIMESTAMP_COUNTER:
         return "CanPollTCnt";
+    case TraceVariable::CE_SAMPLE_MEMORY_BYTES:
+        return "CeSampleMem";
+    case TraceVariable::CE_SAMPLE_MEMORY_SAVED_BYTES:
+        return "CeSampleMemSaved";
+    case TraceVariable::DS_PAYLOAD_SIZE:
+        return "DsPayloadSize";
+    case TraceVariable::DS_PAYLOAD_FILL_25:
+        return "DsPayloadFill25";
+    case TraceVariable::DS_PAYLOAD_FILL_50:
+        return "DsPayloadFill50";
+    case TraceVariable::DS_PAYLOAD_FILL_75:
+        return "DsPayloadFill75";
+    case TraceVariable::DS_PAYLOAD_FILL_100:
+        return "DsPayloadFill100";
+    case TraceVariable::DS_PAYLOAD_OVERSIZE:
+        return "DsPayloadOversize";
+    case TraceVariable::OBD_REQUEST_TIMEOUT:
+        return "ObdE4";
     default:
         return "UNKNOWN";
     }
@@ -211,6 +289,8 @@ TraceModule::getAtomicVariableName( TraceAtomicVariable variable )
         return "ConInt";
     case TraceAtomicVariable::CONNECTION_RESUMED:
         return "ConRes";
+    case TraceAtomicVariable::CAN_FILTERED_FRAMES:
+        return "CanFiltered";
     default:
         return "UNKNOWN";
     }
@@ -238,6 +318,38 @@ TraceModule::getSectionName( TraceSection section )
     }
 }
 
+const char *
+TraceModule::getHistogramName( TraceHistogram histogram )
+{
+    switch ( histogram )
+    {
+    case TraceHistogram::CAN_TO_CONSUMER_LATENCY:
+        return "CanToConsumer";
+    case TraceHistogram::CAN_TO_INSPECTION_LATENCY:
+        return "CanToInspection";
+    case TraceHistogram::CAN_TO_PUBLISH_LATENCY:
+        return "CanToPublish";
+    case TraceHistogram::TRIGGER_TO_SENDER_LATENCY:
+        return "TriggerToSender";
+    case TraceHistogram::CE_EVALUATE_CONDITIONS_TIME:
+        return "CeEvaluate";
+    default:
+        return "UNKNOWN";
+    }
+}
+
+const char *
+TraceModule::getHistogramUnit( TraceHistogram histogram )
+{
+    switch ( histogram )
+    {
+    case TraceHistogram::CE_EVALUATE_CONDITIONS_TIME:
+        return "Microseconds";
+    default:
+        return "Milliseconds";
+    }
+}
+
 void
 TraceModule::updateAllTimeData()
 {
@@ -341,6 +453,34 @@ TraceModule::forwardAllMetricsToMetricsReceiver( IMetricsReceiver *profiler )
                              v.mHitCounter,
                              "Seconds" );
     }
+    for ( auto i = 0; i < toUType( TraceHistogram::TRACE_HISTOGRAM_SIZE ); i++ )
+    {
+        auto histogram = static_cast<TraceHistogram>( i );
+        auto sinceStartup = getHistogram( histogram );
+        auto sinceLast = sinceStartup;
+        sinceLast.subtract( mLastForwardedHistograms[i] );
+        mLastForwardedHistograms[i] = sinceStartup;
+        auto nameSuffix = std::string( getHistogramName( histogram ) ) + "_id" + std::to_string( i );
+        auto unit = getHistogramUnit( histogram );
+        profiler->setMetric( "histogramCountSinceLast_" + nameSuffix,
+                             static_cast<double>( sinceLast.getCount() ),
+                             "Count" );
+        profiler->setMetric( "histogramP50SinceLast_" + nameSuffix,
+                             static_cast<double>( sinceLast.getPercentile( 50.0 ) ),
+                             unit );
+        profiler->setMetric( "histogramP90SinceLast_" + nameSuffix,
+                             static_cast<double>( sinceLast.getPercentile( 90.0 ) ),
+                             unit );
+        profiler->setMetric( "histogramP99SinceLast_" + nameSuffix,
+                             static_cast<double>( sinceLast.getPercentile( 99.0 ) ),
+                             unit );
+        profiler->setMetric( "histogramMaxSinceLast_" + nameSuffix, static_cast<double>( sinceLast.getMax() ), unit );
+        profiler->setMetric( "histogramP99SinceStartup_" + nameSuffix,
+                             static_cast<double>( sinceStartup.getPercentile( 99.0 ) ),
+                             unit );
+        profiler->setMetric(
+            "histogramMaxSinceStartup_" + nameSuffix, static_cast<double>( sinceStartup.getMax() ), unit );
+    }
 }
 
 void
@@ -388,6 +528,20 @@ TraceModule::print()
                 "] max interval since last print: [" + std::to_string( v.mMaxInterval ) + "] overall: [" +
                 std::to_string( v.mMaxIntervalAllTime ) + "]" );
     }
+    for ( auto i = 0; i < toUType( TraceHistogram::TRACE_HISTOGRAM_SIZE ); i++ )
+    {
+        auto histogram = getHistogram( static_cast<TraceHistogram>( i ) );
+        mLogger.trace( "TraceModule::print",
+                       std::string{ " TraceModule-ConsoleLogging-Histogram '" } +
+                           getHistogramName( static_cast<TraceHistogram>( i ) ) + "' [" + std::to_string( i ) +
+                           "] count: [" + std::to_string( histogram.getCount() ) + "] avg: [" +
+                           std::to_string( histogram.getMean() ) + "] p50: [" +
+                           std::to_string( histogram.getPercentile( 50.0 ) ) + "] p90: [" +
+                           std::to_string( histogram.getPercentile( 90.0 ) ) + "] p99: [" +
+                           std::to_string( histogram.getPercentile( 99.0 ) ) + "] max: [" +
+                           std::to_string( histogram.getMax() ) + "] unit: [" +
+                           getHistogramUnit( static_cast<TraceHistogram>( i ) ) + "]" );
+    }
 
     std::fflush( stdout );
 }
@@ -0,0 +1,85 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+
+#include "LatencyHistogram.h"
+#include <gtest/gtest.h>
+
+using namespace Aws::IoTFleetWise::Platform::Linux;
+
+TEST( LatencyHistogramTest, BucketsHaveBoundedRelativeError )
+{
+    for ( uint64_t value = 0; value < LatencyHistogram::SUB_BUCKET_COUNT; value++ )
+    {
+        ASSERT_EQ( LatencyHistogram::getBucketUpperBound( LatencyHistogram::getBucketIndex( value ) ), value );
+    }
+    uint32_t lastIndex = 0;
+    for ( uint64_t value = 1; value < 100000; value++ )
+    {
+        auto index = LatencyHistogram::getBucketIndex( value );
+        ASSERT_GE( index, lastIndex );
+        ASSERT_LT( index, LatencyHistogram::BUCKET_COUNT );
+        lastIndex = index;
+        auto upperBound = LatencyHistogram::getBucketUpperBound( index );
+        ASSERT_GE( upperBound, value );
+        ASSERT_LE( upperBound - value, value / LatencyHistogram::SUB_BUCKET_COUNT );
+    }
+    ASSERT_EQ( LatencyHistogram::getBucketIndex( UINT64_MAX ), LatencyHistogram::BUCKET_COUNT - 1 );
+}
+
+TEST( LatencyHistogramTest, Percentiles )
+{
+    LatencyHistogram histogram;
+    ASSERT_EQ( histogram.getCount(), 0 );
+    ASSERT_EQ( histogram.getPercentile( 99.0 ), 0 );
+    ASSERT_EQ( histogram.getMean(), 0.0 );
+    for ( uint64_t value = 1; value <= 1000; value++ )
+    {
+        histogram.record( value );
+    }
+    ASSERT_EQ( histogram.getCount(), 1000 );
+    ASSERT_DOUBLE_EQ( histogram.getMean(), 500.5 );
+    ASSERT_GE( histogram.getPercentile( 50.0 ), 500 );
+    ASSERT_LE( histogram.getPercentile( 50.0 ), 500 + 500 / LatencyHistogram::SUB_BUCKET_COUNT );
+    ASSERT_GE( histogram.getPercentile( 99.0 ), 990 );
+    ASSERT_LE( histogram.getPercentile( 99.0 ), 1000 );
+    ASSERT_EQ( histogram.getPercentile( 0.0 ), 1 );
+    ASSERT_EQ( histogram.getMax(), 1000 );
+}
+
+TEST( LatencyHistogramTest, SubtractOlderSnapshot )
+{
+    LatencyHistogram histogram;
+    histogram.record( 5 );
+    histogram.record( 7 );
+    auto snapshot = histogram;
+    histogram.record( 100 );
+    histogram.record( 200 );
+    histogram.subtract( snapshot );
+    ASSERT_EQ( histogram.getCount(), 2 );
+    ASSERT_DOUBLE_EQ( histogram.getMean(), 150.0 );
+    ASSERT_GE( histogram.getPercentile( 0.0 ), 100 );
+    ASSERT_EQ( histogram.getMax(), 200 );
+}
+
+TEST( LatencyHistogramTest, MergeFromBuckets )
+{
+    LatencyHistogram histogram;
+    histogram.addToBucket( LatencyHistogram::getBucketIndex( 3 ), 2 );
+    histogram.addToBucket( LatencyHistogram::getBucketIndex( 40 ), 1 );
+    histogram.addToBucket( LatencyHistogram::BUCKET_COUNT, 1 );
+    histogram.addStatistics( 46, 40 );
+    ASSERT_EQ( histogram.getCount(), 3 );
+    ASSERT_EQ( histogram.getPercentile( 50.0 ), 3 );
+    ASSERT_EQ( histogram.getMax(), 40 );
+}
@@ -0,0 +1,155 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+
+#include "ClockHandler.h"
+#include "LogWriter.h"
+#include "LoggingModule.h"
+#include "ReplayClock.h"
+#include <algorithm>
+#include <gtest/gtest.h>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace Aws::IoTFleetWise::Platform::Linux;
+
+class LogCollector : public ILogger
+{
+public:
+    void
+    logMessage( LogLevel level, const std::string &function, const std::string &logEntry ) override
+    {
+        static_cast<void>( level );
+        static_cast<void>( function );
+        // Called from the writer thread
+        std::lock_guard<std::mutex> lock( mMutex );
+        mLogEntries.push_back( logEntry );
+    }
+
+    std::vector<std::string>
+    getLogEntries()
+    {
+        std::lock_guard<std::mutex> lock( mMutex );
+        return mLogEntries;
+    }
+
+private:
+    std::mutex mMutex;
+    std::vector<std::string> mLogEntries;
+};
+
+class LogWriterTest : public ::testing::Test
+{
+protected:
+    void
+    SetUp() override
+    {
+        mPreviousLogLevel = gSystemWideLogLevel;
+        gSystemWideLogLevel = LogLevel::Trace;
+        LogWriter::get().flush();
+        setLogForwarding( &mCollector );
+    }
+
+    void
+    TearDown() override
+    {
+        LogWriter::get().flush();
+        setLogForwarding( nullptr );
+        gSystemWideLogLevel = mPreviousLogLevel;
+    }
+
+    LogCollector mCollector;
+    LogLevel mPreviousLogLevel{ LogLevel::Trace };
+};
+
+TEST_F( LogWriterTest, MessagesOfOneThreadAreWrittenInOrder )
+{
+    LoggingModule logger;
+    for ( int i = 0; i < 100; i++ )
+    {
+        logger.info( "LogWriterTest", "Message " + std::to_string( i ) );
+    }
+    LogWriter::get().flush();
+    auto logEntries = mCollector.getLogEntries();
+    ASSERT_EQ( logEntries.size(), 100 );
+    for ( size_t i = 0; i < logEntries.size(); i++ )
+    {
+        ASSERT_EQ( logEntries[i], "Message " + std::to_string( i ) );
+    }
+}
+
+TEST_F( LogWriterTest, MessagesOfExitedThreadsAreWritten )
+{
+    std::vector<std::thread> threads;
+    for ( int i = 0; i < 4; i++ )
+    {
+        threads.emplace_back( [i]() {
+            LoggingModule logger;
+            logger.warn( "LogWriterTest", "Thread " + std::to_string( i ) );
+        } );
+    }
+    for ( auto &thread : threads )
+    {
+        thread.join();
+    }
+    LogWriter::get().flush();
+    auto logEntries = mCollector.getLogEntries();
+    ASSERT_EQ( logEntries.size(), 4 );
+    for ( int i = 0; i < 4; i++ )
+    {
+        ASSERT_NE( std::find( logEntries.begin(), logEntries.end(), "Thread " + std::to_string( i ) ),
+                   logEntries.end() );
+    }
+}
+
+TEST_F( LogWriterTest, MessagesBelowTheLogLevelAreDiscarded )
+{
+    gSystemWideLogLevel = LogLevel::Warning;
+    ASSERT_FALSE( LoggingModule::isEnabled( LogLevel::Info ) );
+    ASSERT_TRUE( LoggingModule::isEnabled( LogLevel::Error ) );
+    LoggingModule logger;
+    logger.trace( "LogWriterTest", "Trace" );
+    logger.info( "LogWriterTest", "Info" );
+    logger.error( "LogWriterTest", "Error" );
+    LogWriter::get().flush();
+    ASSERT_EQ( mCollector.getLogEntries(), std::vector<std::string>{ "Error" } );
+}
+
+TEST_F( LogWriterTest, WriterThreadWritesWithoutFlush )
+{
+    LoggingModule logger;
+    logger.info( "LogWriterTest", "Message" );
+    for ( int i = 0; i < 100 && mCollector.getLogEntries().empty(); i++ )
+    {
+        std::this_thread::sleep_for( std::chrono::milliseconds( LogWriter::IDLE_TIME_MS / 10 ) );
+    }
+    ASSERT_EQ( mCollector.getLogEntries(), std::vector<std::string>{ "Message" } );
+}
+
+TEST_F( LogWriterTest, MessagesAreStampedWithTheInjectedClockWhenQueued )
+{
+    auto replayClock = std::make_shared<ReplayClock>();
+    replayClock->advance( 1000000 );
+    ClockHandler::setClock( replayClock );
+    LoggingModule logger;
+    logger.info( "LogWriterTest", "Replayed" );
+    // Moving the clock on before the message is written must not change its timestamp
+    replayClock->advance( 100000000 );
+    testing::internal::CaptureStdout();
+    LogWriter::get().flush();
+    auto output = testing::internal::GetCapturedStdout();
+    ClockHandler::setClock( nullptr );
+    auto expectedLine = "[" + replayClock->timestampToString( 1000000 ) + "] [INFO] [LogWriterTest]: [Replayed]";
+    ASSERT_NE( output.find( expectedLine ), std::string::npos );
+}
@@ -16,6 +16,7 @@
 
 #include <gtest/gtest.h>
 #include <thread>
+#include <vector>
 
 using namespace Aws::IoTFleetWise::Platform::Linux;
 
@@ -47,3 +48,36 @@ TEST( TraceModuleTest, TraceModulePrint )
     TraceModule::get().print();
     TraceModule::get().startNewObservationWindow();
 }
+
+TEST( TraceModuleTest, HistogramsRecordedFromMultipleThreads )
+{
+    auto before = TraceModule::get().getHistogram( TraceHistogram::CE_EVALUATE_CONDITIONS_TIME );
+    std::vector<std::thread> threads;
+    for ( uint64_t t = 0; t < 4; t++ )
+    {
+        threads.emplace_back( [t]() {
+            for ( uint64_t i = 1; i <= 1000; i++ )
+            {
+                TraceModule::get().addToHistogram( TraceHistogram::CE_EVALUATE_CONDITIONS_TIME, i + t );
+            }
+        } );
+    }
+    for ( auto &thread : threads )
+    {
+        thread.join();
+    }
+    auto histogram = TraceModule::get().getHistogram( TraceHistogram::CE_EVALUATE_CONDITIONS_TIME );
+    histogram.subtract( before );
+    ASSERT_EQ( histogram.getCount(), 4000 );
+    ASSERT_EQ( histogram.getMax(), 1003 );
+
+    // Timestamps from different clocks must not create huge latencies
+    auto countBefore = TraceModule::get().getHistogram( TraceHistogram::CAN_TO_CONSUMER_LATENCY ).getCount();
+    TraceModule::get().addLatencyToHistogram( TraceHistogram::CAN_TO_CONSUMER_LATENCY, 1000, 999 );
+    TraceModule::get().addLatencyToHistogram( TraceHistogram::CAN_TO_CONSUMER_LATENCY, 1000, 1002 );
+    auto latencies = TraceModule::get().getHistogram( TraceHistogram::CAN_TO_CONSUMER_LATENCY );
+    ASSERT_EQ( latencies.getCount(), countBefore + 1 );
+    ASSERT_GE( latencies.getMax(), 2 );
+
+    TraceModule::get().print();
+}
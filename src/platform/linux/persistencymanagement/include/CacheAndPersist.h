@@ -16,7 +16,12 @@
 // Includes
 #include "ICacheAndPersist.h"
 #include "LoggingModule.h"
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <fstream>
 #include <map>
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -29,8 +34,14 @@ constexpr size_t INVALID_FILE_SIZE = (size_t)-1;
 
 // Define File names for the components using the lib
 #define DECODER_MANIFEST_FILE "/DecoderManifest.bin"
+// Compiled image of the decoder manifest, see DecoderManifestImage
+#define DECODER_MANIFEST_IMAGE_FILE "/DecoderManifest.image"
 #define COLLECTION_SCHEME_LIST_FILE "/CollectionSchemeList.bin"
+// Single file used for the edge to cloud payloads by older versions, imported into the segments on init
 #define COLLECTED_DATA_FILE "/CollectedData.bin"
+// Segment files of the edge to cloud payloads are named CollectedData.<segment ID>.seg
+#define COLLECTED_DATA_SEGMENT_PREFIX "CollectedData."
+#define COLLECTED_DATA_SEGMENT_SUFFIX ".seg"
 
 namespace Aws
 {
@@ -42,6 +53,19 @@ namespace Linux
 {
 namespace PersistencyManagement
 {
+/**
+ * @brief Position of a record in the persisted edge to cloud payloads
+ */
+struct PayloadCursor
+{
+    // ID of the segment file containing the record
+    uint64_t segmentID{ 0 };
+    // Byte offset of the record in the segment file
+    size_t offset{ 0 };
+    // Number of records preceding the record in the segment file
+    size_t recordIndex{ 0 };
+};
+
 /**
  * @brief Class that implements the persistency interface. Handles storage/retrieval for non-volatile memory(NVM).
  *
@@ -49,17 +73,30 @@ namespace PersistencyManagement
  * Underlying storage mechanism writes data to a file.
  * Multiple components using this library e.g. CollectionScheme Manager, Payload Manager are operating on its separate
  * files hence are thread safe.
+ *
+ * Edge to cloud payloads are appended as records to a log of segment files, each record being prefixed with a
+ * header holding its size and CRC32. A new segment is started once the current one would exceed the max segment
+ * size. Records are read one at a time with a PayloadCursor, and segments are deleted as soon as all their records
+ * have been acknowledged, so an interrupted upload resumes at the first unacknowledged record. Incomplete or
+ * corrupted records at the end of a segment, e.g. due to a power loss while writing, are dropped on init.
  */
 class CacheAndPersist : public ICacheAndPersist
 {
 
 public:
+    static constexpr size_t DEFAULT_MAX_PAYLOAD_SEGMENT_SIZE = 65536;
+    static constexpr size_t PAYLOAD_RECORD_HEADER_SIZE = 12;
+
     /**
      * @brief Constructor
      * @param partitionPath    Partition allocated for the NV storage (from config file)
      * @param maxPartitionSize Partition size should not exceed this.
+     * @param maxPayloadSegmentSize A new payload segment file is started when a record would exceed this size.
+     *                              Records bigger than this get a segment of their own.
      */
-    CacheAndPersist( const std::string &partitionPath, size_t maxPartitionSize );
+    CacheAndPersist( const std::string &partitionPath,
+                     size_t maxPartitionSize,
+                     size_t maxPayloadSegmentSize = DEFAULT_MAX_PAYLOAD_SEGMENT_SIZE );
 
     /**
      * @brief Writes to the non volatile memory(NVM).
@@ -78,6 +115,8 @@ public:
     /**
      * @brief Gets the total size of data in the persistence library.
      *        Includes data written to the file as well as any data in flight i.e. in cache.
+     *        For edge to cloud payloads this is the size of all unacknowledged records excluding their headers.
+     *        The sizes are cached, so this does not access the file system.
      * @param dataType   specifies if the data is an edge to cloud payload, collectionScheme list, etc.
      *
      * @return  total size of all the persisted data.
@@ -86,6 +125,8 @@ public:
 
     /**
      * @brief Reads the persisted data in a pre-allocated buffer.
+     *        Edge to cloud payloads are returned as the concatenation of all unacknowledged records without their
+     *        headers. Use readPayloadRecord() to read them one at a time instead.
      *
      * @param readBufPtr   pointer to a buffer location where data should be read
      * @param size         size to be read
@@ -108,6 +149,15 @@ public:
      */
     ErrorCode erase( DataType dataType ) override;
 
+    /**
+     * @brief Maps the persisted data read only into memory. Only the decoder manifest image can be mapped. It is
+     *        replaced with a rename when it is written, so that existing mappings stay valid.
+     * @param dataType   specifies the data to map
+     *
+     * @return the mapping, or nullptr if there is no data or the data type can not be mapped
+     */
+    std::shared_ptr<const MemoryMappedFile> map( DataType dataType ) override;
+
     /**
      * @brief Initializes the library by checking if the files exist and creating if necessary
      *
@@ -115,13 +165,103 @@ public:
      */
     bool init();
 
+    /**
+     * @brief Gets the cursor of the first unacknowledged edge to cloud payload record
+     */
+    PayloadCursor getPayloadCursor();
+
+    /**
+     * @brief Reads the edge to cloud payload record at the cursor and advances the cursor to the next record
+     *
+     * @param cursor   position to read from, updated to the position of the next record
+     * @param record   filled with the record without its header
+     *
+     * @return ErrorCode   SUCCESS if a record was read,
+     *                     EMPTY if there are no more records after the cursor,
+     *                     INVALID_DATA if the record is corrupted. The cursor is moved to the next segment.
+     *                     FILESYSTEM_ERROR in case of any file I/O errors.
+     */
+    ErrorCode readPayloadRecord( PayloadCursor &cursor, std::vector<uint8_t> &record );
+
+    /**
+     * @brief Acknowledges all edge to cloud payload records before the cursor, e.g. after they were uploaded.
+     *        Segment files whose records are all acknowledged are deleted.
+     *
+     * @param cursor   position of the first record that is not acknowledged
+     *
+     * @return ErrorCode   SUCCESS if the acknowledgement is successful,
+     *                     FILESYSTEM_ERROR if a segment file could not be deleted.
+     */
+    ErrorCode acknowledgePayloads( const PayloadCursor &cursor );
+
+    /**
+     * @brief Gets the number of edge to cloud payload segment files
+     */
+    size_t getPayloadSegmentCount();
+
 private:
+    struct PayloadSegment
+    {
+        uint64_t id;
+        // Size of the segment file
+        size_t size;
+        // Size of all records in the segment without their headers
+        size_t dataSize;
+    };
+
+    std::string mPartitionPath;
     std::string mDecoderManifestFile;
+    std::string mDecoderManifestImageFile;
     std::string mCollectionSchemeListFile;
     std::string mCollectedDataFile;
     size_t mMaxPersistencePartitionSize;
+    size_t mMaxPayloadSegmentSize;
     LoggingModule mLogger;
 
+    // Cached file sizes, so that the partition size can be checked without accessing the file system
+    std::atomic<size_t> mDecoderManifestSize{ 0 };
+    std::atomic<size_t> mDecoderManifestImageSize{ 0 };
+    std::atomic<size_t> mCollectionSchemeListSize{ 0 };
+    std::atomic<size_t> mPayloadDiskSize{ 0 };
+
+    // Protects the payload segments and the open segment streams
+    std::mutex mPayloadMutex;
+    std::deque<PayloadSegment> mPayloadSegments;
+    uint64_t mNextPayloadSegmentID{ 1 };
+    // Sum of PayloadSegment::dataSize
+    size_t mPayloadDataSize{ 0 };
+    // Acknowledged part of the first segment
+    size_t mAcknowledgedOffset{ 0 };
+    size_t mAcknowledgedRecordCount{ 0 };
+    size_t mAcknowledgedDataSize{ 0 };
+    // The segment being appended to and the segment being read are kept open
+    std::ofstream mSegmentWriter;
+    uint64_t mSegmentWriterID{ 0 };
+    std::ifstream mSegmentReader;
+    uint64_t mSegmentReaderID{ 0 };
+
+    /**
+     * @brief Gets the size of all persisted files, to check it against the max partition size
+     */
+    size_t getPersistedSize() const;
+
+    ErrorCode appendPayloadRecord( const uint8_t *bufPtr, size_t size );
+    ErrorCode readPayloads( uint8_t *const readBufPtr, size_t size );
+    ErrorCode erasePayloads();
+    bool loadPayloadSegments();
+    bool importLegacyPayloadFile();
+
+    /**
+     * @brief Checks all records of a segment file and truncates it after the last valid record
+     *
+     * @param segment   segment with its ID set, size and data size are filled by this function
+     * @return false if the file could not be read
+     */
+    bool recoverPayloadSegment( PayloadSegment &segment );
+
+    ErrorCode removeFirstPayloadSegment();
+    std::string getPayloadSegmentPath( uint64_t segmentID ) const;
+
     /**
      * @brief checks if the specified file exists, if not creates a new one
      *
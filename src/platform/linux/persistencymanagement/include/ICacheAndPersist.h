@@ -14,7 +14,8 @@
 #pragma once
 
 // Includes
-
+#include "MemoryMappedFile.h"
+#include <memory>
 #include <string>
 
 namespace Aws
@@ -43,6 +44,7 @@ enum class DataType
     EDGE_TO_CLOUD_PAYLOAD = 0,
     COLLECTION_SCHEME_LIST,
     DECODER_MANIFEST,
+    DECODER_MANIFEST_IMAGE,
     DEFAULT_DATA_TYPE
 };
 
@@ -102,6 +104,19 @@ public:
      */
     virtual ErrorCode erase( DataType dataType ) = 0;
 
+    /**
+     * @brief Maps the persisted data read only into memory instead of copying it to a buffer.
+     * @param dataType   specifies the data to map. Edge to cloud payloads can not be mapped.
+     *
+     * @return the mapping, or nullptr if there is no data or the data type can not be mapped
+     */
+    virtual std::shared_ptr<const MemoryMappedFile>
+    map( DataType dataType )
+    {
+        static_cast<void>( dataType );
+        return nullptr;
+    }
+
     /**
      * @brief Returns a text representation of the error for better readable logging
      * @param err the error code to convert to string
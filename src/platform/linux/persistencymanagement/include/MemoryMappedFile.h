@@ -0,0 +1,76 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#pragma once
+
+// Includes
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace Platform
+{
+namespace Linux
+{
+namespace PersistencyManagement
+{
+/**
+ * @brief Read only memory mapping of a file. The file is unmapped when the object is destroyed.
+ *
+ * Files that are mapped must not be modified in place, but replaced e.g. with a rename, otherwise accessing the
+ * mapping after the file was truncated causes a SIGBUS.
+ */
+class MemoryMappedFile
+{
+public:
+    MemoryMappedFile() = default;
+    ~MemoryMappedFile();
+
+    MemoryMappedFile( const MemoryMappedFile & ) = delete;
+    MemoryMappedFile &operator=( const MemoryMappedFile & ) = delete;
+    MemoryMappedFile( MemoryMappedFile && ) = delete;
+    MemoryMappedFile &operator=( MemoryMappedFile && ) = delete;
+
+    /**
+     * @brief Maps the complete file
+     *
+     * @param fileName  path of the file
+     * @return true if the file was mapped, false if it does not exist, is empty or could not be mapped
+     */
+    bool open( const std::string &fileName );
+
+    const uint8_t *
+    getData() const
+    {
+        return mData;
+    }
+
+    size_t
+    getSize() const
+    {
+        return mSize;
+    }
+
+private:
+    const uint8_t *mData{ nullptr };
+    size_t mSize{ 0 };
+};
+} // namespace PersistencyManagement
+} // namespace Linux
+} // namespace Platform
+} // namespace IoTFleetWise
+} // namespace Aws
@@ -13,18 +13,111 @@
 
 // Includes
 #include "CacheAndPersist.h"
+#include <algorithm>
+#include <array>
+#include <cerrno>
 #include <cstdio>
+#include <cstring>
+#include <dirent.h>
 #include <fstream>
 #include <ios>
 #include <iostream>
+#include <limits>
 #include <sys/stat.h>
+#include <unistd.h>
 
 using namespace Aws::IoTFleetWise::Platform::Linux::PersistencyManagement;
 
-CacheAndPersist::CacheAndPersist( const std::string &partitionPath, size_t maxPartitionSize )
+namespace
+{
+constexpr uint32_t PAYLOAD_RECORD_MAGIC = 0x46574552; // "FWER"
+
+struct PayloadRecordHeader
+{
+    uint32_t magic;
+    uint32_t size;
+    // CRC32 of the record data
+    uint32_t crc;
+};
+static_assert( sizeof( PayloadRecordHeader ) == CacheAndPersist::PAYLOAD_RECORD_HEADER_SIZE,
+               "Unexpected padding in PayloadRecordHeader" );
+
+uint32_t
+calculateCrc32( const uint8_t *buf, size_t size )
+{
+    // CRC-32 (IEEE 802.3), reflected polynomial
+    static const std::array<uint32_t, 256> table = []() {
+        std::array<uint32_t, 256> t{};
+        for ( uint32_t i = 0; i < t.size(); i++ )
+        {
+            uint32_t c = i;
+            for ( int k = 0; k < 8; k++ )
+            {
+                c = ( ( c & 1U ) != 0 ) ? ( 0xEDB88320U ^ ( c >> 1 ) ) : ( c >> 1 );
+            }
+            t[i] = c;
+        }
+        return t;
+    }();
+    uint32_t crc = 0xFFFFFFFFU;
+    for ( size_t i = 0; i < size; i++ )
+    {
+        crc = table[( crc ^ buf[i] ) & 0xFFU] ^ ( crc >> 8 );
+    }
+    return crc ^ 0xFFFFFFFFU;
+}
+
+size_t
+getFileSize( const std::string &fileName )
+{
+    struct stat res = {};
+    if ( stat( fileName.c_str(), &res ) == 0 )
+    {
+        return static_cast<size_t>( res.st_size );
+    }
+    return 0;
+}
+
+/**
+ * @brief Reads and validates the record at the current position of the stream
+ *
+ * @param file          stream positioned at the record header
+ * @param maxRecordSize bytes left in the segment from the current position
+ * @param record        filled with the record data
+ * @return true if a complete record with matching CRC was read
+ */
+bool
+readRecord( std::ifstream &file, size_t maxRecordSize, std::vector<uint8_t> &record )
+{
+    PayloadRecordHeader header{};
+    if ( maxRecordSize < sizeof( header ) )
+    {
+        return false;
+    }
+    file.read( reinterpret_cast<char *>( &header ), static_cast<std::streamsize>( sizeof( header ) ) );
+    if ( ( !file.good() ) || ( header.magic != PAYLOAD_RECORD_MAGIC ) ||
+         ( header.size > maxRecordSize - sizeof( header ) ) )
+    {
+        return false;
+    }
+    record.resize( header.size );
+    file.read( reinterpret_cast<char *>( record.data() ), static_cast<std::streamsize>( header.size ) );
+    return ( !file.fail() ) && ( calculateCrc32( record.data(), record.size() ) == header.crc );
+}
+} // namespace
+
+constexpr size_t CacheAndPersist::DEFAULT_MAX_PAYLOAD_SEGMENT_SIZE;
+constexpr size_t CacheAndPersist::PAYLOAD_RECORD_HEADER_SIZE;
+
+CacheAndPersist::CacheAndPersist( const std::string &partitionPath,
+                                  size_t maxPartitionSize,
+                                  size_t maxPayloadSegmentSize )
+    : mPartitionPath( partitionPath )
+    , mMaxPayloadSegmentSize( maxPayloadSegmentSize )
 {
     // Define the file paths
     mDecoderManifestFile = partitionPath + DECODER_MANIFEST_FILE;
+    mDecoderManifestImageFile = partitionPath + DECODER_MANIFEST_IMAGE_FILE;
     mCollectionSchemeListFile = partitionPath + COLLECTION_SCHEME_LIST_FILE;
     mCollectedDataFile = partitionPath + COLLECTED_DATA_FILE;
 
@@ -45,11 +138,20 @@ CacheAndPersist::init()
         mLogger.error( "PersistencyManagement::init", " Failed to create collectionScheme list file " );
         return false;
     }
+    mDecoderManifestSize = getFileSize( mDecoderManifestFile );
+    // The decoder manifest image is optional, so it is not created here
+    mDecoderManifestImageSize = getFileSize( mDecoderManifestImageFile );
+    mCollectionSchemeListSize = getFileSize( mCollectionSchemeListFile );
 
-    if ( createFile( mCollectedDataFile ) != ErrorCode::SUCCESS )
+    if ( !loadPayloadSegments() )
     {
-        mLogger.error( "PersistencyManagement::init", " Failed to create collected data file " );
+        mLogger.error( "PersistencyManagement::init", " Failed to load collected data segments " );
+        return false;
+    }
 
+    if ( !importLegacyPayloadFile() )
+    {
+        mLogger.error( "PersistencyManagement::init", " Failed to import collected data file " );
         return false;
     }
 
@@ -88,55 +190,198 @@ CacheAndPersist::createFile( const std::string &fileName )
     return status;
 }
 
+std::string
+CacheAndPersist::getPayloadSegmentPath( uint64_t segmentID ) const
+{
+    return mPartitionPath + "/" + COLLECTED_DATA_SEGMENT_PREFIX + std::to_string( segmentID ) +
+           COLLECTED_DATA_SEGMENT_SUFFIX;
+}
+
+bool
+CacheAndPersist::loadPayloadSegments()
+{
+    std::lock_guard<std::mutex> lock( mPayloadMutex );
+    mPayloadSegments.clear();
+    mPayloadDataSize = 0;
+    mPayloadDiskSize = 0;
+    mAcknowledgedOffset = 0;
+    mAcknowledgedRecordCount = 0;
+    mAcknowledgedDataSize = 0;
+
+    DIR *dir = opendir( mPartitionPath.c_str() );
+    if ( dir == nullptr )
+    {
+        mLogger.error( "PersistencyManagement::loadPayloadSegments", " Could not open " + mPartitionPath );
+        return false;
+    }
+    const std::string prefix = COLLECTED_DATA_SEGMENT_PREFIX;
+    const std::string suffix = COLLECTED_DATA_SEGMENT_SUFFIX;
+    std::vector<uint64_t> segmentIDs;
+    for ( struct dirent *entry = readdir( dir ); entry != nullptr; entry = readdir( dir ) )
+    {
+        std::string name( entry->d_name );
+        if ( ( name.size() <= prefix.size() + suffix.size() ) || ( name.compare( 0, prefix.size(), prefix ) != 0 ) ||
+             ( name.compare( name.size() - suffix.size(), suffix.size(), suffix ) != 0 ) )
+        {
+            continue;
+        }
+        std::string id = name.substr( prefix.size(), name.size() - prefix.size() - suffix.size() );
+        if ( std::all_of( id.begin(), id.end(), []( char c ) { return ( c >= '0' ) && ( c <= '9' ); } ) )
+        {
+            segmentIDs.push_back( std::stoull( id ) );
+        }
+    }
+    closedir( dir );
+    std::sort( segmentIDs.begin(), segmentIDs.end() );
+
+    for ( auto id : segmentIDs )
+    {
+        mNextPayloadSegmentID = std::max( mNextPayloadSegmentID, id + 1 );
+        PayloadSegment segment{ id, 0, 0 };
+        if ( !recoverPayloadSegment( segment ) )
+        {
+            return false;
+        }
+        if ( segment.size == 0 )
+        {
+            // Nothing valid in the segment
+            static_cast<void>( std::remove( getPayloadSegmentPath( id ).c_str() ) );
+            continue;
+        }
+        mPayloadSegments.push_back( segment );
+        mPayloadDataSize += segment.dataSize;
+        mPayloadDiskSize += segment.size;
+    }
+    if ( !mPayloadSegments.empty() )
+    {
+        mLogger.info( "PersistencyManagement::loadPayloadSegments",
+                      " Found " + std::to_string( mPayloadSegments.size() ) + " segments with " +
+                          std::to_string( mPayloadDataSize ) + " Bytes of collected data" );
+    }
+    return true;
+}
+
+bool
+CacheAndPersist::recoverPayloadSegment( PayloadSegment &segment )
+{
+    const std::string fileName = getPayloadSegmentPath( segment.id );
+    const size_t fileSize = getFileSize( fileName );
+    std::ifstream file( fileName.c_str(), std::ios_base::binary | std::ios_base::in );
+    if ( !file.is_open() )
+    {
+        mLogger.error( "PersistencyManagement::recoverPayloadSegment", " Could not open " + fileName );
+        return false;
+    }
+    std::vector<uint8_t> record;
+    segment.size = 0;
+    segment.dataSize = 0;
+    while ( ( segment.size < fileSize ) && readRecord( file, fileSize - segment.size, record ) )
+    {
+        segment.size += PAYLOAD_RECORD_HEADER_SIZE + record.size();
+        segment.dataSize += record.size();
+    }
+    file.close();
+
+    if ( segment.size < fileSize )
+    {
+        // Typically the last record was not completely written before a power loss
+        mLogger.warn( "PersistencyManagement::recoverPayloadSegment",
+                      " Dropping " + std::to_string( fileSize - segment.size ) +
+                          " Bytes of incomplete or corrupted data from " + fileName );
+        if ( truncate( fileName.c_str(), static_cast<off_t>( segment.size ) ) != 0 )
+        {
+            mLogger.error( "PersistencyManagement::recoverPayloadSegment", " Could not truncate " + fileName );
+            return false;
+        }
+    }
+    return true;
+}
+
+bool
+CacheAndPersist::importLegacyPayloadFile()
+{
+    const size_t legacySize = getFileSize( mCollectedDataFile );
+    if ( legacySize > 0 )
+    {
+        std::vector<uint8_t> data( legacySize );
+        std::ifstream file( mCollectedDataFile.c_str(), std::ios_base::binary | std::ios_base::in );
+        file.read( reinterpret_cast<char *>( data.data() ), static_cast<std::streamsize>( legacySize ) );
+        if ( file.fail() )
+        {
+            mLogger.error( "PersistencyManagement::importLegacyPayloadFile", " Error reading file" );
+            return false;
+        }
+        file.close();
+        // The old file is a concatenation of payloads, it is kept together as a single record
+        ErrorCode status = appendPayloadRecord( data.data(), data.size() );
+        if ( status != ErrorCode::SUCCESS )
+        {
+            mLogger.error( "PersistencyManagement::importLegacyPayloadFile",
+                           std::string( " Could not import collected data: " ) + getErrorString( status ) );
+            return false;
+        }
+        mLogger.info( "PersistencyManagement::importLegacyPayloadFile",
+                      " Imported " + std::to_string( legacySize ) + " Bytes of collected data" );
+    }
+    // Ignore the error if the file does not exist
+    static_cast<void>( std::remove( mCollectedDataFile.c_str() ) );
+    return true;
+}
+
 ErrorCode
 CacheAndPersist::write( const uint8_t *bufPtr, size_t size, DataType dataType )
 {
     ErrorCode status = ErrorCode::SUCCESS;
     std::string fileName;
     std::ofstream file;
+    std::atomic<size_t> *cachedSize = nullptr;
 
     if ( bufPtr == nullptr )
     {
         return ErrorCode::INVALID_DATA;
     }
 
-    if ( getSize( DataType::COLLECTION_SCHEME_LIST ) + getSize( DataType::DECODER_MANIFEST ) +
-             getSize( DataType::EDGE_TO_CLOUD_PAYLOAD ) + size >=
-         mMaxPersistencePartitionSize )
-    {
-        return ErrorCode::MEMORY_FULL;
-    }
-
     switch ( dataType )
     {
     case DataType::COLLECTION_SCHEME_LIST:
         fileName = mCollectionSchemeListFile;
+        cachedSize = &mCollectionSchemeListSize;
         break;
 
     case DataType::DECODER_MANIFEST:
         fileName = mDecoderManifestFile;
+        cachedSize = &mDecoderManifestSize;
         break;
 
-    case DataType::EDGE_TO_CLOUD_PAYLOAD:
-        fileName = mCollectedDataFile;
+    case DataType::DECODER_MANIFEST_IMAGE:
+        fileName = mDecoderManifestImageFile;
+        cachedSize = &mDecoderManifestImageSize;
         break;
 
+    case DataType::EDGE_TO_CLOUD_PAYLOAD:
+        // Payload is appended to the segments
+        return appendPayloadRecord( bufPtr, size );
+
     default:
         status = ErrorCode::INVALID_DATATYPE;
         mLogger.error( "PersistencyManagement::write", " Invalid data type specified " );
         return status;
     }
 
-    if ( dataType == DataType::EDGE_TO_CLOUD_PAYLOAD )
+    if ( getPersistedSize() + size >= mMaxPersistencePartitionSize )
     {
-        // Payload is appended to the existing file
-        file.open( fileName.c_str(), std::ios_base::binary | std::ios_base::app );
+        return ErrorCode::MEMORY_FULL;
     }
-    else
+
+    // The decoder manifest image may be mapped, so it is written to a temporary file which then replaces it
+    const bool replaceFile = dataType == DataType::DECODER_MANIFEST_IMAGE;
+    const std::string targetFileName = fileName;
+    if ( replaceFile )
     {
-        // CollectionScheme list and Decoder Manifest are overwritten
-        file.open( fileName.c_str(), std::ios_base::binary );
+        fileName += ".tmp";
     }
+    // CollectionScheme list and Decoder Manifest are overwritten
+    file.open( fileName.c_str(), std::ios_base::binary );
 
     if ( !file.is_open() )
     {
@@ -152,44 +397,114 @@ CacheAndPersist::write( const uint8_t *bufPtr, size_t size, DataType dataType )
             mLogger.error( "PersistencyManagement::write", " Error writing to the file " );
         }
         file.close();
+        if ( replaceFile )
+        {
+            if ( ( status == ErrorCode::SUCCESS ) && ( std::rename( fileName.c_str(), targetFileName.c_str() ) != 0 ) )
+            {
+                status = ErrorCode::FILESYSTEM_ERROR;
+                mLogger.error( "PersistencyManagement::write", " Could not replace " + targetFileName );
+            }
+            static_cast<void>( std::remove( fileName.c_str() ) );
+            fileName = targetFileName;
+        }
+        *cachedSize = ( status == ErrorCode::SUCCESS ) ? size : getFileSize( fileName );
     }
     return status;
 }
 
 size_t
-CacheAndPersist::getSize( DataType dataType )
+CacheAndPersist::getPersistedSize() const
 {
-    // get size of the file specified
-    std::string fileName;
-    size_t size = 0U;
-    struct stat res = {};
+    return mCollectionSchemeListSize + mDecoderManifestSize + mDecoderManifestImageSize + mPayloadDiskSize;
+}
+
+ErrorCode
+CacheAndPersist::appendPayloadRecord( const uint8_t *bufPtr, size_t size )
+{
+    if ( size > std::numeric_limits<uint32_t>::max() )
+    {
+        return ErrorCode::INVALID_DATA;
+    }
+    const size_t recordSize = PAYLOAD_RECORD_HEADER_SIZE + size;
+    if ( getPersistedSize() + recordSize >= mMaxPersistencePartitionSize )
+    {
+        return ErrorCode::MEMORY_FULL;
+    }
+
+    std::lock_guard<std::mutex> lock( mPayloadMutex );
+    if ( mPayloadSegments.empty() ||
+         ( ( mPayloadSegments.back().size > 0 ) &&
+           ( mPayloadSegments.back().size + recordSize > mMaxPayloadSegmentSize ) ) )
+    {
+        mPayloadSegments.push_back( PayloadSegment{ mNextPayloadSegmentID, 0, 0 } );
+        mNextPayloadSegmentID++;
+    }
+    auto &segment = mPayloadSegments.back();
+    const std::string fileName = getPayloadSegmentPath( segment.id );
+    if ( ( !mSegmentWriter.is_open() ) || ( mSegmentWriterID != segment.id ) )
+    {
+        mSegmentWriter.close();
+        mSegmentWriter.clear();
+        mSegmentWriter.open( fileName.c_str(), std::ios_base::binary | std::ios_base::app );
+        mSegmentWriterID = segment.id;
+        if ( !mSegmentWriter.is_open() )
+        {
+            mLogger.error( "PersistencyManagement::write", " Could not open file " );
+            if ( segment.size == 0 )
+            {
+                mPayloadSegments.pop_back();
+            }
+            return ErrorCode::FILESYSTEM_ERROR;
+        }
+    }
+
+    PayloadRecordHeader header{ PAYLOAD_RECORD_MAGIC, static_cast<uint32_t>( size ), calculateCrc32( bufPtr, size ) };
+    mSegmentWriter.write( reinterpret_cast<const char *>( &header ), static_cast<std::streamsize>( sizeof( header ) ) );
+    mSegmentWriter.write( reinterpret_cast<const char *>( bufPtr ), static_cast<std::streamsize>( size ) );
+    // The stream stays open for the next record, so hand the data over to the OS right away
+    mSegmentWriter.flush();
+    if ( !mSegmentWriter.good() )
+    {
+        mLogger.error( "PersistencyManagement::write", " Error writing to the file " );
+        mSegmentWriter.close();
+        // Drop the partially written record, so that the following records can be appended after the last valid one
+        if ( truncate( fileName.c_str(), static_cast<off_t>( segment.size ) ) != 0 )
+        {
+            mLogger.error( "PersistencyManagement::write", " Could not truncate " + fileName );
+        }
+        return ErrorCode::FILESYSTEM_ERROR;
+    }
+    segment.size += recordSize;
+    segment.dataSize += size;
+    mPayloadDataSize += size;
+    mPayloadDiskSize += recordSize;
+    return ErrorCode::SUCCESS;
+}
 
+size_t
+CacheAndPersist::getSize( DataType dataType )
+{
     switch ( dataType )
     {
     case DataType::COLLECTION_SCHEME_LIST:
-        fileName = mCollectionSchemeListFile;
-        break;
+        return mCollectionSchemeListSize;
 
     case DataType::DECODER_MANIFEST:
-        fileName = mDecoderManifestFile;
-        break;
+        return mDecoderManifestSize;
+
+    case DataType::DECODER_MANIFEST_IMAGE:
+        return mDecoderManifestImageSize;
 
     case DataType::EDGE_TO_CLOUD_PAYLOAD:
-        fileName = mCollectedDataFile;
-        break;
+    {
+        std::lock_guard<std::mutex> lock( mPayloadMutex );
+        return mPayloadDataSize - mAcknowledgedDataSize;
+    }
 
     default:
         mLogger.error( "PersistencyManagement::getSize", " Invalid data type specified " );
         return INVALID_FILE_SIZE;
     }
-
-    // Get the file size
-    if ( stat( fileName.c_str(), &res ) == 0 )
-    {
-        size = static_cast<size_t>( res.st_size );
-    }
-
-    return size;
 }
 
 ErrorCode
@@ -213,10 +528,13 @@ CacheAndPersist::read( uint8_t *const readBufPtr, size_t size, DataType dataType
         fileName = mDecoderManifestFile;
         break;
 
-    case DataType::EDGE_TO_CLOUD_PAYLOAD:
-        fileName = mCollectedDataFile;
+    case DataType::DECODER_MANIFEST_IMAGE:
+        fileName = mDecoderManifestImageFile;
         break;
 
+    case DataType::EDGE_TO_CLOUD_PAYLOAD:
+        return readPayloads( readBufPtr, size );
+
     default:
         status = ErrorCode::INVALID_DATATYPE;
         mLogger.error( "PersistencyManagement::read", " Invalid data type specified " );
@@ -254,25 +572,188 @@ CacheAndPersist::read( uint8_t *const readBufPtr, size_t size, DataType dataType
     return status;
 }
 
+ErrorCode
+CacheAndPersist::readPayloads( uint8_t *const readBufPtr, size_t size )
+{
+    auto cursor = getPayloadCursor();
+    std::vector<uint8_t> record;
+    size_t readSize = 0;
+    while ( readSize < size )
+    {
+        ErrorCode status = readPayloadRecord( cursor, record );
+        if ( status == ErrorCode::EMPTY )
+        {
+            break;
+        }
+        if ( status == ErrorCode::INVALID_DATA )
+        {
+            continue;
+        }
+        if ( status != ErrorCode::SUCCESS )
+        {
+            return status;
+        }
+        size_t copySize = std::min( record.size(), size - readSize );
+        memcpy( &readBufPtr[readSize], record.data(), copySize );
+        readSize += copySize;
+    }
+    return ( readSize == 0 ) ? ErrorCode::EMPTY : ErrorCode::SUCCESS;
+}
+
+PayloadCursor
+CacheAndPersist::getPayloadCursor()
+{
+    std::lock_guard<std::mutex> lock( mPayloadMutex );
+    if ( mPayloadSegments.empty() )
+    {
+        return PayloadCursor{ mNextPayloadSegmentID, 0, 0 };
+    }
+    return PayloadCursor{ mPayloadSegments.front().id, mAcknowledgedOffset, mAcknowledgedRecordCount };
+}
+
+ErrorCode
+CacheAndPersist::readPayloadRecord( PayloadCursor &cursor, std::vector<uint8_t> &record )
+{
+    std::lock_guard<std::mutex> lock( mPayloadMutex );
+    // Find the segment of the cursor, moving to the next segment if the end of a segment was reached
+    auto segment =
+        std::find_if( mPayloadSegments.begin(), mPayloadSegments.end(), [&cursor]( const PayloadSegment &s ) {
+            return s.id >= cursor.segmentID;
+        } );
+    if ( ( segment != mPayloadSegments.end() ) && ( segment->id != cursor.segmentID ) )
+    {
+        cursor = PayloadCursor{ segment->id, 0, 0 };
+    }
+    while ( ( segment != mPayloadSegments.end() ) && ( cursor.offset >= segment->size ) )
+    {
+        segment++;
+        if ( segment != mPayloadSegments.end() )
+        {
+            cursor = PayloadCursor{ segment->id, 0, 0 };
+        }
+    }
+    if ( segment == mPayloadSegments.end() )
+    {
+        return ErrorCode::EMPTY;
+    }
+
+    if ( ( !mSegmentReader.is_open() ) || ( mSegmentReaderID != segment->id ) )
+    {
+        mSegmentReader.close();
+        mSegmentReader.open( getPayloadSegmentPath( segment->id ).c_str(),
+                             std::ios_base::binary | std::ios_base::in );
+        mSegmentReaderID = segment->id;
+        if ( !mSegmentReader.is_open() )
+        {
+            mLogger.error( "PersistencyManagement::readPayloadRecord", " Error opening file" );
+            return ErrorCode::FILESYSTEM_ERROR;
+        }
+    }
+    // Clear a previous end of file, the segment may have grown since
+    mSegmentReader.clear();
+    mSegmentReader.seekg( static_cast<std::streamoff>( cursor.offset ) );
+    if ( !readRecord( mSegmentReader, segment->size - cursor.offset, record ) )
+    {
+        mLogger.error( "PersistencyManagement::readPayloadRecord",
+                       " Corrupted record " + std::to_string( cursor.recordIndex ) + " in segment " +
+                           std::to_string( segment->id ) + ", skipping the rest of the segment" );
+        cursor.offset = segment->size;
+        return ErrorCode::INVALID_DATA;
+    }
+    cursor.offset += PAYLOAD_RECORD_HEADER_SIZE + record.size();
+    cursor.recordIndex++;
+    return ErrorCode::SUCCESS;
+}
+
+ErrorCode
+CacheAndPersist::acknowledgePayloads( const PayloadCursor &cursor )
+{
+    std::lock_guard<std::mutex> lock( mPayloadMutex );
+    ErrorCode status = ErrorCode::SUCCESS;
+    while ( ( !mPayloadSegments.empty() ) && ( ( mPayloadSegments.front().id < cursor.segmentID ) ||
+                                               ( ( mPayloadSegments.front().id == cursor.segmentID ) &&
+                                                 ( cursor.offset >= mPayloadSegments.front().size ) ) ) )
+    {
+        if ( removeFirstPayloadSegment() != ErrorCode::SUCCESS )
+        {
+            status = ErrorCode::FILESYSTEM_ERROR;
+        }
+    }
+    if ( ( !mPayloadSegments.empty() ) && ( mPayloadSegments.front().id == cursor.segmentID ) &&
+         ( cursor.offset > mAcknowledgedOffset ) )
+    {
+        mAcknowledgedOffset = cursor.offset;
+        mAcknowledgedRecordCount = cursor.recordIndex;
+        mAcknowledgedDataSize = cursor.offset - ( cursor.recordIndex * PAYLOAD_RECORD_HEADER_SIZE );
+    }
+    return status;
+}
+
+ErrorCode
+CacheAndPersist::removeFirstPayloadSegment()
+{
+    const auto &segment = mPayloadSegments.front();
+    if ( mSegmentWriterID == segment.id )
+    {
+        mSegmentWriter.close();
+    }
+    if ( mSegmentReaderID == segment.id )
+    {
+        mSegmentReader.close();
+    }
+    mPayloadDataSize -= segment.dataSize;
+    mPayloadDiskSize -= segment.size;
+    mAcknowledgedOffset = 0;
+    mAcknowledgedRecordCount = 0;
+    mAcknowledgedDataSize = 0;
+    const std::string fileName = getPayloadSegmentPath( segment.id );
+    mPayloadSegments.pop_front();
+    if ( std::remove( fileName.c_str() ) != 0 )
+    {
+        mLogger.error( "PersistencyManagement::removeFirstPayloadSegment", " Could not delete " + fileName );
+        return ErrorCode::FILESYSTEM_ERROR;
+    }
+    return ErrorCode::SUCCESS;
+}
+
+size_t
+CacheAndPersist::getPayloadSegmentCount()
+{
+    std::lock_guard<std::mutex> lock( mPayloadMutex );
+    return mPayloadSegments.size();
+}
+
 ErrorCode
 CacheAndPersist::erase( DataType dataType )
 {
     ErrorCode status = ErrorCode::SUCCESS;
     std::string fileName;
+    std::atomic<size_t> *cachedSize = nullptr;
 
     switch ( dataType )
     {
     case DataType::COLLECTION_SCHEME_LIST:
         fileName = mCollectionSchemeListFile;
+        cachedSize = &mCollectionSchemeListSize;
         break;
 
     case DataType::DECODER_MANIFEST:
         fileName = mDecoderManifestFile;
+        cachedSize = &mDecoderManifestSize;
         break;
 
+    case DataType::DECODER_MANIFEST_IMAGE:
+        // The image may be mapped, so it is removed instead of truncated
+        if ( ( std::remove( mDecoderManifestImageFile.c_str() ) != 0 ) && ( errno != ENOENT ) )
+        {
+            mLogger.error( "PersistencyManagement::erase", " Error erasing the file " );
+            return ErrorCode::FILESYSTEM_ERROR;
+        }
+        mDecoderManifestImageSize = 0;
+        return ErrorCode::SUCCESS;
+
     case DataType::EDGE_TO_CLOUD_PAYLOAD:
-        fileName = mCollectedDataFile;
-        break;
+        return erasePayloads();
 
     default:
         status = ErrorCode::INVALID_DATATYPE;
@@ -292,8 +773,49 @@ CacheAndPersist::erase( DataType dataType )
     {
 
         file.close();
+        *cachedSize = 0;
+    }
+
+    return status;
+}
+
+std::shared_ptr<const MemoryMappedFile>
+CacheAndPersist::map( DataType dataType )
+{
+    if ( dataType != DataType::DECODER_MANIFEST_IMAGE )
+    {
+        mLogger.error( "PersistencyManagement::map", " Invalid data type specified " );
+        return nullptr;
+    }
+    if ( mDecoderManifestImageSize == 0 )
+    {
+        return nullptr;
+    }
+    auto mappedFile = std::make_shared<MemoryMappedFile>();
+    if ( !mappedFile->open( mDecoderManifestImageFile ) )
+    {
+        mLogger.error( "PersistencyManagement::map", " Could not map " + mDecoderManifestImageFile );
+        return nullptr;
     }
+    return mappedFile;
+}
 
+ErrorCode
+CacheAndPersist::erasePayloads()
+{
+    std::lock_guard<std::mutex> lock( mPayloadMutex );
+    ErrorCode status = ErrorCode::SUCCESS;
+    while ( !mPayloadSegments.empty() )
+    {
+        if ( removeFirstPayloadSegment() != ErrorCode::SUCCESS )
+        {
+            status = ErrorCode::FILESYSTEM_ERROR;
+        }
+    }
+    if ( status != ErrorCode::SUCCESS )
+    {
+        mLogger.error( "PersistencyManagement::erase", " Error erasing the file " );
+    }
     return status;
 }
 
@@ -0,0 +1,73 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+// Includes
+#include "MemoryMappedFile.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace Platform
+{
+namespace Linux
+{
+namespace PersistencyManagement
+{
+MemoryMappedFile::~MemoryMappedFile()
+{
+    if ( mData != nullptr )
+    {
+        munmap( const_cast<uint8_t *>( mData ), mSize );
+    }
+}
+
+bool
+MemoryMappedFile::open( const std::string &fileName )
+{
+    if ( mData != nullptr )
+    {
+        return false;
+    }
+    int fd = ::open( fileName.c_str(), O_RDONLY | O_CLOEXEC );
+    if ( fd < 0 )
+    {
+        return false;
+    }
+    struct stat res = {};
+    if ( ( fstat( fd, &res ) != 0 ) || ( res.st_size <= 0 ) )
+    {
+        close( fd );
+        return false;
+    }
+    auto size = static_cast<size_t>( res.st_size );
+    // The mapping stays valid after the file descriptor is closed
+    void *data = mmap( nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0 );
+    close( fd );
+    if ( data == MAP_FAILED )
+    {
+        return false;
+    }
+    mData = static_cast<const uint8_t *>( data );
+    mSize = size;
+    return true;
+}
+} // namespace PersistencyManagement
+} // namespace Linux
+} // namespace Platform
+} // namespace IoTFleetWise
+} // namespace Aws
@@ -12,14 +12,54 @@
  */
 
 #include "CacheAndPersist.h"
+#include <cstdlib>
+#include <fstream>
 #include <functional>
 #include <gtest/gtest.h>
 #include <limits.h>
 #include <stdio.h>
+#include <sys/stat.h>
 #include <unistd.h>
 
 using namespace Aws::IoTFleetWise::Platform::Linux::PersistencyManagement;
 
+namespace
+{
+// The test cases run in parallel, so the segment tests use a directory of their own
+std::string
+createTestDirectory( const std::string &name )
+{
+    char buffer[PATH_MAX];
+    if ( getcwd( buffer, sizeof( buffer ) ) == NULL )
+    {
+        return "";
+    }
+    std::string path = std::string( buffer ) + "/" + name;
+    int ret = std::system( ( "rm -rf " + path ).c_str() );
+    static_cast<void>( ret );
+    mkdir( path.c_str(), 0755 );
+    return path;
+}
+
+bool
+fileExists( const std::string &fileName )
+{
+    struct stat res = {};
+    return stat( fileName.c_str(), &res ) == 0;
+}
+
+std::string
+readPayloadRecord( CacheAndPersist &storage, PayloadCursor &cursor )
+{
+    std::vector<uint8_t> record;
+    if ( storage.readPayloadRecord( cursor, record ) != ErrorCode::SUCCESS )
+    {
+        return "";
+    }
+    return std::string( record.begin(), record.end() );
+}
+} // namespace
+
 // Unit Tests for the collectionScheme persistency
 TEST( CacheAndPersistTest, testCollectionSchemePersistency )
 {
@@ -287,4 +327,200 @@ TEST( CacheAndPersistTest, testMultipleEventDataPersistency )
         ASSERT_EQ( storage.erase( DataType::EDGE_TO_CLOUD_PAYLOAD ), ErrorCode::SUCCESS );
         ASSERT_EQ( storage.getSize( DataType::EDGE_TO_CLOUD_PAYLOAD ), 0 );
     }
-}
\ No newline at end of file
+}
+// Test that records are spread over segments which are deleted once acknowledged
+TEST( CacheAndPersistTest, testPayloadSegmentsAreDeletedWhenAcknowledged )
+{
+    std::string path = createTestDirectory( "testPayloadSegments" );
+    ASSERT_FALSE( path.empty() );
+    // Two records with 20 Bytes fit into a segment
+    CacheAndPersist storage( path, 131072, 2 * ( CacheAndPersist::PAYLOAD_RECORD_HEADER_SIZE + 20 ) );
+    ASSERT_TRUE( storage.init() );
+
+    for ( char c = 'a'; c < 'f'; c++ )
+    {
+        std::string data( 20, c );
+        ASSERT_EQ( storage.write( reinterpret_cast<const uint8_t *>( data.c_str() ),
+                                  data.size(),
+                                  DataType::EDGE_TO_CLOUD_PAYLOAD ),
+                   ErrorCode::SUCCESS );
+    }
+    ASSERT_EQ( storage.getPayloadSegmentCount(), 3 );
+    ASSERT_EQ( storage.getSize( DataType::EDGE_TO_CLOUD_PAYLOAD ), 100 );
+
+    auto cursor = storage.getPayloadCursor();
+    ASSERT_EQ( readPayloadRecord( storage, cursor ), std::string( 20, 'a' ) );
+    ASSERT_EQ( readPayloadRecord( storage, cursor ), std::string( 20, 'b' ) );
+    ASSERT_EQ( readPayloadRecord( storage, cursor ), std::string( 20, 'c' ) );
+    ASSERT_EQ( storage.acknowledgePayloads( cursor ), ErrorCode::SUCCESS );
+    ASSERT_EQ( storage.getPayloadSegmentCount(), 2 );
+    ASSERT_EQ( storage.getSize( DataType::EDGE_TO_CLOUD_PAYLOAD ), 40 );
+
+    // Reading again resumes after the acknowledged records
+    cursor = storage.getPayloadCursor();
+    ASSERT_EQ( readPayloadRecord( storage, cursor ), std::string( 20, 'd' ) );
+    ASSERT_EQ( readPayloadRecord( storage, cursor ), std::string( 20, 'e' ) );
+    std::vector<uint8_t> record;
+    ASSERT_EQ( storage.readPayloadRecord( cursor, record ), ErrorCode::EMPTY );
+    ASSERT_EQ( storage.acknowledgePayloads( cursor ), ErrorCode::SUCCESS );
+    ASSERT_EQ( storage.getPayloadSegmentCount(), 0 );
+    ASSERT_EQ( storage.getSize( DataType::EDGE_TO_CLOUD_PAYLOAD ), 0 );
+
+    // New records go to a new segment
+    std::string data = "after acknowledge";
+    ASSERT_EQ( storage.write(
+                   reinterpret_cast<const uint8_t *>( data.c_str() ), data.size(), DataType::EDGE_TO_CLOUD_PAYLOAD ),
+               ErrorCode::SUCCESS );
+    cursor = storage.getPayloadCursor();
+    ASSERT_EQ( readPayloadRecord( storage, cursor ), data );
+    ASSERT_EQ( storage.erase( DataType::EDGE_TO_CLOUD_PAYLOAD ), ErrorCode::SUCCESS );
+    ASSERT_EQ( storage.getPayloadSegmentCount(), 0 );
+    int ret = std::system( ( "rm -rf " + path ).c_str() );
+    static_cast<void>( ret );
+}
+
+// Test that an incompletely written record is dropped when the segments are loaded
+TEST( CacheAndPersistTest, testIncompletePayloadRecordIsDroppedOnInit )
+{
+    std::string path = createTestDirectory( "testIncompletePayloadRecord" );
+    ASSERT_FALSE( path.empty() );
+    std::string data1 = "first record";
+    std::string data2 = "second record";
+    {
+        CacheAndPersist storage( path, 131072 );
+        ASSERT_TRUE( storage.init() );
+        ASSERT_EQ( storage.write( reinterpret_cast<const uint8_t *>( data1.c_str() ),
+                                  data1.size(),
+                                  DataType::EDGE_TO_CLOUD_PAYLOAD ),
+                   ErrorCode::SUCCESS );
+        ASSERT_EQ( storage.write( reinterpret_cast<const uint8_t *>( data2.c_str() ),
+                                  data2.size(),
+                                  DataType::EDGE_TO_CLOUD_PAYLOAD ),
+                   ErrorCode::SUCCESS );
+    }
+    // Cut the last record in half
+    std::string segmentFile = path + "/" + COLLECTED_DATA_SEGMENT_PREFIX + "1" + COLLECTED_DATA_SEGMENT_SUFFIX;
+    ASSERT_TRUE( fileExists( segmentFile ) );
+    ASSERT_EQ( truncate( segmentFile.c_str(),
+                         static_cast<off_t>( 2 * CacheAndPersist::PAYLOAD_RECORD_HEADER_SIZE + data1.size() + 5 ) ),
+               0 );
+
+    CacheAndPersist storage( path, 131072 );
+    ASSERT_TRUE( storage.init() );
+    ASSERT_EQ( storage.getSize( DataType::EDGE_TO_CLOUD_PAYLOAD ), data1.size() );
+    std::string data3 = "third record";
+    ASSERT_EQ( storage.write(
+                   reinterpret_cast<const uint8_t *>( data3.c_str() ), data3.size(), DataType::EDGE_TO_CLOUD_PAYLOAD ),
+               ErrorCode::SUCCESS );
+
+    auto cursor = storage.getPayloadCursor();
+    ASSERT_EQ( readPayloadRecord( storage, cursor ), data1 );
+    ASSERT_EQ( readPayloadRecord( storage, cursor ), data3 );
+    std::vector<uint8_t> record;
+    ASSERT_EQ( storage.readPayloadRecord( cursor, record ), ErrorCode::EMPTY );
+    ASSERT_EQ( storage.erase( DataType::EDGE_TO_CLOUD_PAYLOAD ), ErrorCode::SUCCESS );
+    ASSERT_FALSE( fileExists( segmentFile ) );
+    int ret = std::system( ( "rm -rf " + path ).c_str() );
+    static_cast<void>( ret );
+}
+
+// Test that a corrupted record is skipped
+TEST( CacheAndPersistTest, testCorruptedPayloadRecordIsSkipped )
+{
+    std::string path = createTestDirectory( "testCorruptedPayloadRecord" );
+    ASSERT_FALSE( path.empty() );
+    std::string data = "some record";
+    CacheAndPersist storage( path, 131072, CacheAndPersist::PAYLOAD_RECORD_HEADER_SIZE + data.size() );
+    ASSERT_TRUE( storage.init() );
+    for ( int i = 0; i < 2; i++ )
+    {
+        ASSERT_EQ( storage.write( reinterpret_cast<const uint8_t *>( data.c_str() ),
+                                  data.size(),
+                                  DataType::EDGE_TO_CLOUD_PAYLOAD ),
+                   ErrorCode::SUCCESS );
+    }
+    // Flip a byte in the data of the first record
+    std::string segmentFile = path + "/" + COLLECTED_DATA_SEGMENT_PREFIX + "1" + COLLECTED_DATA_SEGMENT_SUFFIX;
+    {
+        std::fstream file( segmentFile.c_str(), std::ios_base::binary | std::ios_base::in | std::ios_base::out );
+        file.seekp( static_cast<std::streamoff>( CacheAndPersist::PAYLOAD_RECORD_HEADER_SIZE ) );
+        file.put( 'X' );
+    }
+
+    auto cursor = storage.getPayloadCursor();
+    std::vector<uint8_t> record;
+    ASSERT_EQ( storage.readPayloadRecord( cursor, record ), ErrorCode::INVALID_DATA );
+    ASSERT_EQ( readPayloadRecord( storage, cursor ), data );
+    ASSERT_EQ( storage.erase( DataType::EDGE_TO_CLOUD_PAYLOAD ), ErrorCode::SUCCESS );
+    int ret = std::system( ( "rm -rf " + path ).c_str() );
+    static_cast<void>( ret );
+}
+
+// Test that the data file of older versions is imported into the segments
+TEST( CacheAndPersistTest, testLegacyPayloadFileIsImported )
+{
+    std::string path = createTestDirectory( "testLegacyPayloadFile" );
+    ASSERT_FALSE( path.empty() );
+    std::string data = "data persisted by an older version";
+    {
+        std::ofstream legacyFile( ( path + COLLECTED_DATA_FILE ).c_str(), std::ios_base::binary );
+        legacyFile << data;
+    }
+
+    CacheAndPersist storage( path, 131072 );
+    ASSERT_TRUE( storage.init() );
+    ASSERT_FALSE( fileExists( path + COLLECTED_DATA_FILE ) );
+    ASSERT_EQ( storage.getSize( DataType::EDGE_TO_CLOUD_PAYLOAD ), data.size() );
+    auto cursor = storage.getPayloadCursor();
+    ASSERT_EQ( readPayloadRecord( storage, cursor ), data );
+    ASSERT_EQ( storage.erase( DataType::EDGE_TO_CLOUD_PAYLOAD ), ErrorCode::SUCCESS );
+    int ret = std::system( ( "rm -rf " + path ).c_str() );
+    static_cast<void>( ret );
+}
+
+TEST( CacheAndPersistTest, testDecoderManifestImageIsMapped )
+{
+    std::string path = createTestDirectory( "testDecoderManifestImage" );
+    CacheAndPersist storage( path, 131072 );
+    ASSERT_TRUE( storage.init() );
+    ASSERT_EQ( storage.map( DataType::DECODER_MANIFEST_IMAGE ), nullptr );
+    ASSERT_EQ( storage.map( DataType::DECODER_MANIFEST ), nullptr );
+
+    std::string image1 = "first decoder manifest image";
+    ASSERT_EQ( storage.write( reinterpret_cast<const uint8_t *>( image1.data() ),
+                              image1.size(),
+                              DataType::DECODER_MANIFEST_IMAGE ),
+               ErrorCode::SUCCESS );
+    ASSERT_EQ( storage.getSize( DataType::DECODER_MANIFEST_IMAGE ), image1.size() );
+    auto mappedImage1 = storage.map( DataType::DECODER_MANIFEST_IMAGE );
+    ASSERT_NE( mappedImage1, nullptr );
+    ASSERT_EQ( std::string( reinterpret_cast<const char *>( mappedImage1->getData() ), mappedImage1->getSize() ),
+               image1 );
+
+    // A new image replaces the file, so the previous mapping keeps its content
+    std::string image2 = "second image";
+    ASSERT_EQ( storage.write( reinterpret_cast<const uint8_t *>( image2.data() ),
+                              image2.size(),
+                              DataType::DECODER_MANIFEST_IMAGE ),
+               ErrorCode::SUCCESS );
+    auto mappedImage2 = storage.map( DataType::DECODER_MANIFEST_IMAGE );
+    ASSERT_NE( mappedImage2, nullptr );
+    ASSERT_EQ( std::string( reinterpret_cast<const char *>( mappedImage2->getData() ), mappedImage2->getSize() ),
+               image2 );
+    ASSERT_EQ( std::string( reinterpret_cast<const char *>( mappedImage1->getData() ), mappedImage1->getSize() ),
+               image1 );
+    ASSERT_FALSE( fileExists( path + DECODER_MANIFEST_IMAGE_FILE + ".tmp" ) );
+
+    // The size of the image is restored on init
+    CacheAndPersist storage2( path, 131072 );
+    ASSERT_TRUE( storage2.init() );
+    ASSERT_EQ( storage2.getSize( DataType::DECODER_MANIFEST_IMAGE ), image2.size() );
+
+    ASSERT_EQ( storage.erase( DataType::DECODER_MANIFEST_IMAGE ), ErrorCode::SUCCESS );
+    ASSERT_EQ( storage.getSize( DataType::DECODER_MANIFEST_IMAGE ), 0 );
+    ASSERT_EQ( storage.map( DataType::DECODER_MANIFEST_IMAGE ), nullptr );
+    ASSERT_EQ( std::string( reinterpret_cast<const char *>( mappedImage2->getData() ), mappedImage2->getSize() ),
+               image2 );
+    int ret = std::system( ( "rm -rf " + path ).c_str() );
+    static_cast<void>( ret );
+}
@@ -74,6 +74,14 @@ public:
     // NOLINTNEXTLINE(readability-make-member-function-const)
     void setThreadName( const std::string &name );
 
+    /**
+     * @brief Pins the thread to one CPU
+     * @param cpuIndex index of the CPU. Wraps around the number of online CPUs
+     * @return True if it's successful.
+     */
+    // NOLINTNEXTLINE(readability-make-member-function-const)
+    bool setThreadAffinity( uint32_t cpuIndex );
+
     /**
      * @brief Sets Thread name of the callee thread
      */
@@ -15,6 +15,8 @@
 // Includes
 
 #include "Thread.h"
+#include <pthread.h>
+#include <sched.h>
 #include <string>
 #include <sys/prctl.h>
 #include <unistd.h>
@@ -114,6 +116,20 @@ Thread::setThreadName( const std::string &name ) // NOLINT(readability-make-memb
     pthread_setname_np( mThread, name.c_str() );
 }
 
+bool
+Thread::setThreadAffinity( uint32_t cpuIndex ) // NOLINT(readability-make-member-function-const)
+{
+    long numberOfCpus = sysconf( _SC_NPROCESSORS_ONLN );
+    if ( numberOfCpus <= 0 )
+    {
+        return false;
+    }
+    cpu_set_t cpuSet;
+    CPU_ZERO( &cpuSet );
+    CPU_SET( cpuIndex % static_cast<uint32_t>( numberOfCpus ), &cpuSet );
+    return pthread_setaffinity_np( mThread, sizeof( cpuSet ), &cpuSet ) == 0;
+}
+
 void
 Thread::SetCurrentThreadName( const std::string &name )
 {
@@ -44,6 +44,13 @@ public:
      */
     virtual std::string timestampToString() const = 0;
 
+    /**
+     * @brief  Convert a timestamp of this clock to "%Y-%m-%d %I:%M:%S %p" format.
+     * @param  timestamp in milliseconds since epoch, e.g. taken earlier with timeSinceEpochMs()
+     * @return the timestamp in a string format
+     */
+    virtual std::string timestampToString( Timestamp timestamp ) const = 0;
+
     /**
      * @brief virtual destructor
      */
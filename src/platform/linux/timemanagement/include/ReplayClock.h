@@ -0,0 +1,77 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#pragma once
+
+// Includes
+#include "Clock.h"
+#include <mutex>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace Platform
+{
+namespace Linux
+{
+
+/**
+ * @brief Clock driven by replayed data, e.g. CAN frames read from a log file. It can be injected with
+ *        ClockHandler::setClock so that all modules measure time with the timestamps of the replayed data
+ *        instead of the wall time, e.g. to process recorded traffic faster than real time.
+ *
+ *        Before the replay starts the clock follows the wall time. During the replay it only moves forward when
+ *        the replay advances it, and stands still in between. After the replay has finished it continues from
+ *        the last replayed timestamp in real time, so that pending time based collections complete.
+ *        The clock never goes backwards.
+ */
+class ReplayClock : public Clock
+{
+public:
+    Timestamp timeSinceEpochMs() const override;
+
+    std::string timestampToString() const override;
+
+    std::string timestampToString( Timestamp timestamp ) const override;
+
+    /**
+     * @brief Moves the clock forward to the timestamp of the data that is replayed next. Earlier timestamps
+     *        are ignored. Thread safe, several replays can advance the same clock.
+     * @param timestamp time in milliseconds since epoch
+     */
+    void advance( Timestamp timestamp );
+
+    /**
+     * @brief Lets the clock run in real time again, starting from the last replayed timestamp
+     */
+    void finishReplay();
+
+private:
+    static Timestamp wallTimeSinceEpochMs();
+
+    // Current time of the clock, mMutex must be held
+    Timestamp getTime() const;
+
+    mutable std::mutex mMutex;
+    bool mReplaying{ false };
+    // The time of the clock when it stood still last or was switched to real time
+    Timestamp mAnchorTime{ 0 };
+    // The wall time at mAnchorTime, only used when the clock runs in real time
+    Timestamp mAnchorWallTime{ 0 };
+};
+
+} // namespace Linux
+} // namespace Platform
+} // namespace IoTFleetWise
+} // namespace Aws
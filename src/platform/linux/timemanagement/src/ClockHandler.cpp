@@ -14,9 +14,8 @@
 // Includes
 #include "ClockHandler.h"
 #include <chrono>
-#include <iomanip>
+#include <ctime>
 #include <mutex>
-#include <sstream>
 
 namespace Aws
 {
@@ -43,11 +42,21 @@ public:
     std::string
     timestampToString() const override
     {
-        std::stringstream timeAsString;
-        auto timeNow = std::chrono::system_clock::now();
-        auto timeNowFormatted = std::chrono::system_clock::to_time_t( timeNow );
-        timeAsString << std::put_time( std::localtime( &timeNowFormatted ), "%Y-%m-%d %I:%M:%S %p" );
-        return timeAsString.str();
+        return timestampToString( timeSinceEpochMs() );
+    }
+
+    std::string
+    timestampToString( Timestamp timestamp ) const override
+    {
+        auto time = static_cast<std::time_t>( timestamp / 1000 );
+        std::tm localTime = {};
+        char timeAsString[32] = {};
+        // localtime_r, as the log writer thread formats timestamps concurrently to the other threads
+        if ( localtime_r( &time, &localTime ) != nullptr )
+        {
+            std::strftime( timeAsString, sizeof( timeAsString ), "%Y-%m-%d %I:%M:%S %p", &localTime );
+        }
+        return timeAsString;
     }
 };
 
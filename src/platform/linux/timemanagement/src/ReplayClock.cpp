@@ -0,0 +1,108 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+// Includes
+#include "ReplayClock.h"
+#include <algorithm>
+#include <chrono>
+#include <ctime>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace Platform
+{
+namespace Linux
+{
+
+Timestamp
+ReplayClock::wallTimeSinceEpochMs()
+{
+    return static_cast<Timestamp>(
+        std::chrono::duration_cast<std::chrono::milliseconds>( std::chrono::system_clock::now().time_since_epoch() )
+            .count() );
+}
+
+Timestamp
+ReplayClock::timeSinceEpochMs() const
+{
+    std::lock_guard<std::mutex> lock( mMutex );
+    return getTime();
+}
+
+Timestamp
+ReplayClock::getTime() const
+{
+    if ( mReplaying )
+    {
+        return mAnchorTime;
+    }
+    if ( mAnchorWallTime == 0 )
+    {
+        // The replay has not started yet
+        return wallTimeSinceEpochMs();
+    }
+    auto wallTime = wallTimeSinceEpochMs();
+    return mAnchorTime + ( ( wallTime > mAnchorWallTime ) ? ( wallTime - mAnchorWallTime ) : 0 );
+}
+
+std::string
+ReplayClock::timestampToString() const
+{
+    return timestampToString( timeSinceEpochMs() );
+}
+
+std::string
+ReplayClock::timestampToString( Timestamp timestamp ) const
+{
+    auto time = static_cast<std::time_t>( timestamp / 1000 );
+    std::tm localTime = {};
+    char timeAsString[32] = {};
+    if ( localtime_r( &time, &localTime ) != nullptr )
+    {
+        std::strftime( timeAsString, sizeof( timeAsString ), "%Y-%m-%d %I:%M:%S %p", &localTime );
+    }
+    return timeAsString;
+}
+
+void
+ReplayClock::advance( Timestamp timestamp )
+{
+    std::lock_guard<std::mutex> lock( mMutex );
+    if ( !mReplaying )
+    {
+        // The first replayed timestamp can be before the wall time, but a restarted replay continues from the
+        // current time of the clock
+        mAnchorTime = ( mAnchorWallTime == 0 ) ? 0 : getTime();
+        mReplaying = true;
+    }
+    mAnchorTime = std::max( mAnchorTime, timestamp );
+    mAnchorWallTime = wallTimeSinceEpochMs();
+}
+
+void
+ReplayClock::finishReplay()
+{
+    std::lock_guard<std::mutex> lock( mMutex );
+    if ( mReplaying )
+    {
+        mReplaying = false;
+        mAnchorWallTime = wallTimeSinceEpochMs();
+    }
+}
+
+} // namespace Linux
+} // namespace Platform
+} // namespace IoTFleetWise
+} // namespace Aws
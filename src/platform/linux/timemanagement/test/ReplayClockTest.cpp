@@ -0,0 +1,56 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include "ReplayClock.h"
+#include "ClockHandler.h"
+#include <chrono>
+#include <gtest/gtest.h>
+#include <thread>
+
+using namespace Aws::IoTFleetWise::Platform::Linux;
+
+TEST( ReplayClockTest, FollowsWallTimeBeforeReplay )
+{
+    ReplayClock replayClock;
+    auto wallTime = ClockHandler::getClock()->timeSinceEpochMs();
+    ASSERT_GE( replayClock.timeSinceEpochMs(), wallTime );
+    ASSERT_LE( replayClock.timeSinceEpochMs(), wallTime + 1000 );
+}
+
+TEST( ReplayClockTest, StandsStillBetweenReplayedTimestamps )
+{
+    ReplayClock replayClock;
+    replayClock.advance( 1000000 );
+    ASSERT_EQ( replayClock.timeSinceEpochMs(), 1000000 );
+    std::this_thread::sleep_for( std::chrono::milliseconds( 20 ) );
+    ASSERT_EQ( replayClock.timeSinceEpochMs(), 1000000 );
+    replayClock.advance( 1000500 );
+    ASSERT_EQ( replayClock.timeSinceEpochMs(), 1000500 );
+    // Never goes backwards
+    replayClock.advance( 1000100 );
+    ASSERT_EQ( replayClock.timeSinceEpochMs(), 1000500 );
+}
+
+TEST( ReplayClockTest, RunsInRealTimeAfterReplay )
+{
+    ReplayClock replayClock;
+    replayClock.advance( 1000000 );
+    replayClock.finishReplay();
+    std::this_thread::sleep_for( std::chrono::milliseconds( 20 ) );
+    auto time = replayClock.timeSinceEpochMs();
+    ASSERT_GE( time, 1000020 );
+    ASSERT_LT( time, 1010000 );
+    // A new replay continues from the current time
+    replayClock.advance( 1000001 );
+    ASSERT_GE( replayClock.timeSinceEpochMs(), time );
+}
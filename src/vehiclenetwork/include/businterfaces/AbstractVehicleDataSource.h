@@ -16,11 +16,13 @@
 // Includes
 #include "Listener.h"
 #include "VehicleDataSourceListener.h"
+#include "datatypes/CANRawFrameMessage.h"
 #include "datatypes/VehicleDataMessage.h"
 #include "datatypes/VehicleDataSourceConfig.h"
 #include <boost/lockfree/queue.hpp>
 #include <boost/lockfree/spsc_queue.hpp>
 #include <memory>
+#include <vector>
 
 namespace Aws
 {
@@ -29,7 +31,10 @@ namespace IoTFleetWise
 namespace VehicleNetwork
 {
 using namespace Aws::IoTFleetWise::Platform::Linux;
-// Single Producer/Consumer buffer. Used for data processing between the source and the consumer.
+// Single Producer/Consumer buffer. Used for raw frame processing between the source and the consumer.
+using CANRawFrameCircularBuffer = boost::lockfree::spsc_queue<CANRawFrameMessage>;
+using CANRawFrameCircularBufferPtr = std::shared_ptr<CANRawFrameCircularBuffer>;
+// Single Producer/Consumer buffer. Used for synthetic data processing between the source and the consumer.
 using VehicleMessageCircularBuffer = boost::lockfree::spsc_queue<VehicleDataMessage>;
 using VehicleMessageCircularBufferPtr = std::shared_ptr<VehicleMessageCircularBuffer>;
 // Multi Producer/Single Consumer buffer. Used for raw data propagation.
@@ -87,13 +92,27 @@ public:
      */
     virtual void resumeDataAcquisition() = 0;
 
+    /**
+     * @brief Ask the source to only acquire the frames with the given IDs from the Transport, if the
+     * Transport supports filtering. Frames with other IDs can still be acquired, so users must not rely on
+     * the filter. The default implementation does not filter.
+     * @param frameIds IDs of all frames that are needed. If empty, no frame is needed.
+     * @return True if the filter has been applied.
+     */
+    virtual bool
+    setFrameFilter( const std::vector<uint32_t> &frameIds )
+    {
+        static_cast<void>( frameIds );
+        return false;
+    }
+
     /**
      * @brief Handle of the Vehicle Data Source circular buffer. User of the Data Source
      * can use this object to consume data. The buffer can ONLY be consume
      * from one single consumer thread.
      * @return shared object pointer to the circular buffer.
      */
-    inline VehicleMessageCircularBufferPtr
+    inline CANRawFrameCircularBufferPtr
     getBuffer()
     {
         return mCircularBuffPtr;
@@ -148,8 +167,8 @@ protected:
         static std::atomic<VehicleDataSourceID> sourceID( INVALID_DATA_SOURCE_ID );
         return ++sourceID;
     }
-    // A FIFO queue holding the currently acquired vehicle data messages.
-    VehicleMessageCircularBufferPtr mCircularBuffPtr;
+    // A FIFO queue holding the currently acquired raw frames.
+    CANRawFrameCircularBufferPtr mCircularBuffPtr;
     // Current active Data Source Configurations
     std::vector<VehicleDataSourceConfig> mConfigs;
     // Unique Identifier of the source.
@@ -16,13 +16,20 @@
 #if defined( IOTFLEETWISE_LINUX )
 // Includes
 #include "AbstractVehicleDataSource.h"
+#include "CANMultiBusReader.h"
 #include "ClockHandler.h"
 #include "LoggingModule.h"
 #include "Signal.h"
 #include "Thread.h"
 #include "Timer.h"
+#include <functional>
 #include <iostream>
+#include <linux/can.h>
+#include <memory>
+#include <mutex>
 #include <net/if.h>
+#include <sys/socket.h>
+#include <vector>
 
 using namespace Aws::IoTFleetWise::Platform::Linux;
 
@@ -66,13 +73,21 @@ stringToCanTimestampType( std::string const &timestampType, CAN_TIMESTAMP_TYPE &
 }
 /**
  * @brief Linux CAN Bus implementation. Uses Raw Sockets to listen to CAN
- * data on 1 single CAN IF.
+ * data on 1 single CAN IF. The socket is read either by an own thread or by a CANMultiBusReader
+ * that serves the sockets of several data sources.
  */
 class CANDataSource : public AbstractVehicleDataSource
 {
 public:
+    // Default number of frames received with one recvmmsg call
     static constexpr int PARALLEL_RECEIVED_FRAMES_FROM_KERNEL = 10;
+    // Maximum number of frames received with one recvmmsg call, UIO_MAXIOV of the Linux kernel
+    static constexpr uint32_t MAX_RECEIVE_BATCH_SIZE = 1024;
     static constexpr int DEFAULT_THREAD_IDLE_TIME_MS = 1000;
+    // Maximum number of filters on a socket, CAN_RAW_FILTER_MAX of the Linux kernel
+    static constexpr size_t MAX_FRAME_FILTERS = 512;
+    // Interval in which the number of frames dropped by the filter is updated
+    static constexpr uint32_t FILTER_STATISTICS_INTERVAL_MS = 1000;
 
     /**
      * @brief Data Source Constructor.
@@ -100,6 +115,78 @@ public:
 
     void suspendDataAcquisition() override;
 
+    /**
+     * @brief Set the kernel filter of the socket so that only frames with the given IDs are received.
+     * If the socket is not connected yet, the filter is applied on connect.
+     * Frames received on the interface but dropped by the filter are traced as CAN_FILTERED_FRAMES.
+     * @param frameIds IDs of all frames that are needed. Standard and extended frames with the ID are received.
+     * @return True if the filter has been applied
+     */
+    bool setFrameFilter( const std::vector<uint32_t> &frameIds ) override;
+
+    /**
+     * @brief Create the kernel CAN filters for a set of frame IDs. If there are more IDs than maxFilters,
+     * the IDs are grouped by their upper bits and one masked filter is created per group, so that some
+     * frames with other IDs pass the filter as well.
+     * @param frameIds IDs of the frames that should pass the filter
+     * @param maxFilters maximum number of filters
+     * @return the filters, empty if no frame should pass
+     */
+    static std::vector<struct can_filter> createFrameFilters( std::vector<uint32_t> frameIds,
+                                                              size_t maxFilters = MAX_FRAME_FILTERS );
+
+    /**
+     * @brief Read the socket with the given reader instead of an own thread. Must be set before connect.
+     * @param reader started reader that is shared with other data sources
+     */
+    void
+    setMultiBusReader( std::shared_ptr<CANMultiBusReader> reader )
+    {
+        mMultiBusReader = std::move( reader );
+    }
+
+    /**
+     * @brief Set a function that is called by the reading thread after received frames were pushed to the
+     * buffer, e.g. to decode them in the same thread. Must be set before connect.
+     * @param callback called after each batch of received frames
+     */
+    void
+    setFramesReceivedCallback( std::function<void()> callback )
+    {
+        mFramesReceivedCallback = std::move( callback );
+    }
+
+    /**
+     * @brief Receive one batch of frames from the socket without blocking and push them to the buffer.
+     * Called by the thread that reads the socket.
+     * @return number of received frames, 0 or less if no frame was available
+     */
+    int receiveFrames();
+
+    /**
+     * @brief Count the frames received on the interface that were not read from the socket.
+     * Called by the thread that reads the socket.
+     */
+    void updateFilteredFrames();
+
+    /**
+     * @brief Returns the socket, only valid while the data source is connected
+     */
+    int
+    getSocket() const
+    {
+        return mSocket;
+    }
+
+    /**
+     * @brief Returns the maximum number of frames received with one recvmmsg call
+     */
+    uint32_t
+    getReceiveBatchSize() const
+    {
+        return static_cast<uint32_t>( mMessageHeaders.size() );
+    }
+
 private:
     // Start the bus thread
     bool start();
@@ -117,6 +204,12 @@ private:
 
     Timestamp extractTimestamp( struct msghdr *msgHeader );
 
+    // Apply mFrameFilters to the socket, mFrameFilterMutex must be held
+    bool applyFrameFilters();
+
+    // Allocate the buffers of one recvmmsg call
+    void setupReceiveBuffers( uint32_t batchSize );
+
     Thread mThread;
     std::atomic<bool> mShouldStop{ false };
     std::atomic<bool> mShouldSleep{ false };
@@ -129,8 +222,25 @@ private:
     uint32_t mIdleTimeMs{ DEFAULT_THREAD_IDLE_TIME_MS };
     uint64_t receivedMessages{ 0 };
     uint64_t discardedMessages{ 0 };
+    uint64_t mReadFrames{ 0 };
+    uint64_t mLastReadFrames{ 0 };
+    uint64_t mLastInterfaceRxFrames{ 0 };
+    std::atomic<bool> mFrameFilterActive{ false };
+    std::mutex mFrameFilterMutex;
+    std::vector<struct can_filter> mFrameFilters;
     CAN_TIMESTAMP_TYPE mTimestampTypeToUse{ CAN_TIMESTAMP_TYPE::KERNEL_SOFTWARE_TIMESTAMP };
     std::atomic<Timestamp> mResumeTime{ 0 };
+    // True after waking up until the frames queued in the kernel while sleeping were read
+    std::atomic<bool> mWokeUpFromSleep{ false };
+    Timestamp mLastFrameTime{ 0 };
+    // Buffers of one recvmmsg call, only used by the thread that reads the socket.
+    // Classic CAN frames are received into the same structure with a payload of at most 8 bytes.
+    std::vector<struct canfd_frame> mFrames;
+    std::vector<struct iovec> mFrameBuffers;
+    std::vector<struct mmsghdr> mMessageHeaders;
+    std::vector<char> mControlBuffers;
+    std::shared_ptr<CANMultiBusReader> mMultiBusReader;
+    std::function<void()> mFramesReceivedCallback;
 };
 } // namespace VehicleNetwork
 } // namespace IoTFleetWise
@@ -0,0 +1,197 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#pragma once
+
+#if defined( IOTFLEETWISE_LINUX )
+// Includes
+#include "AbstractVehicleDataSource.h"
+#include "ClockHandler.h"
+#include "LoggingModule.h"
+#include "ReplayClock.h"
+#include "Signal.h"
+#include "Thread.h"
+#include "datatypes/CANRawFrameMessage.h"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+using namespace Aws::IoTFleetWise::Platform::Linux;
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace VehicleNetwork
+{
+
+/**
+ * @brief CAN frame read from a log file
+ */
+struct CANLogFrame
+{
+    // Recorded time in milliseconds, since epoch or for ASC files without a date since the start of the recording
+    Timestamp timestamp{ 0 };
+    // Interface name in candump logs, channel number in ASC logs
+    std::string channel;
+    uint32_t id{ 0 };
+    uint8_t size{ 0 };
+    std::array<uint8_t, MAX_RAW_CAN_FRAME_BYTE_SIZE> data{};
+};
+
+/**
+ * @brief Replays CAN frames from a log file written by `candump -l` or in the Vector ASC format, e.g. to run
+ * new campaigns over recorded drives. The frames are pushed to the buffer like the frames received by
+ * CANDataSource, but instead of being discarded when the buffer is full, the replay waits for the consumer.
+ *
+ * The frames keep the time difference between them from the recording. By default the first frame is stamped
+ * with the time the replay starts, with keepRecordedTimestamps the recorded timestamps are used unchanged.
+ * If a ReplayClock is set as the clock of the system, the replay advances it with the frame timestamps, so that
+ * the inspection and collection measure time with the recording instead of the wall time.
+ *
+ * Transport properties:
+ * - logFile: path of the log file
+ * - replaySpeed: 0 to replay as fast as possible (default), otherwise the factor the replay is faster than the
+ *   recording, e.g. 1 for real time
+ * - logInterfaceName: only replay the frames of this candump interface or ASC channel, by default all frames
+ * - keepRecordedTimestamps: "true" to stamp the frames with the recorded timestamps
+ * - threadIdleTimeMs: sleep time of the thread while the data acquisition is suspended
+ */
+class CANLogFileDataSource : public AbstractVehicleDataSource
+{
+public:
+    static constexpr uint32_t DEFAULT_THREAD_IDLE_TIME_MS = 1000;
+    // Wait time for the consumer when the buffer is full
+    static constexpr uint32_t BUFFER_FULL_WAIT_TIME_MS = 1;
+
+    /**
+     * @brief Data Source Constructor.
+     * @param replayClock clock that is advanced with the timestamps of the replayed frames, can be nullptr
+     */
+    CANLogFileDataSource( std::shared_ptr<ReplayClock> replayClock = nullptr );
+
+    ~CANLogFileDataSource() override;
+
+    CANLogFileDataSource( const CANLogFileDataSource & ) = delete;
+    CANLogFileDataSource &operator=( const CANLogFileDataSource & ) = delete;
+    CANLogFileDataSource( CANLogFileDataSource && ) = delete;
+    CANLogFileDataSource &operator=( CANLogFileDataSource && ) = delete;
+
+    bool init( const std::vector<VehicleDataSourceConfig> &sourceConfigs ) override;
+
+    bool connect() override;
+
+    bool disconnect() override;
+
+    bool isAlive() final;
+
+    void resumeDataAcquisition() override;
+
+    void suspendDataAcquisition() override;
+
+    /**
+     * @brief Returns true after all frames of the log file were pushed to the buffer
+     */
+    bool
+    isReplayFinished() const
+    {
+        return mReplayFinished.load();
+    }
+
+    /**
+     * @brief Returns the number of frames pushed to the buffer so far
+     */
+    uint64_t
+    getReplayedFrames() const
+    {
+        return mReplayedFrames.load();
+    }
+
+    /**
+     * @brief Parses a line of a `candump -l` log like "(1600000000.123456) can0 123#0011223344" or
+     * "(1600000000.123456) can0 123##1001122" for CAN FD frames. Remote and error frames are not parsed.
+     * @param line line of the log file
+     * @param frame filled with the frame if the line could be parsed
+     * @return True if the line contains a data frame
+     */
+    static bool parseCandumpLine( const std::string &line, CANLogFrame &frame );
+
+    /**
+     * @brief Parses a frame line of a Vector ASC log like "0.001234 1 123 Rx d 8 00 11 22 33 44 55 66 77" or
+     * "0.001234 CANFD 1 Rx 123 1 0 9 12 00 11 ...". Extended IDs end with x. Other events are not parsed.
+     * @param line line of the log file
+     * @param hexIds True if the IDs are hexadecimal ("base hex"), False if they are decimal
+     * @param frame filled with the frame if the line could be parsed, the timestamp is the time of the line
+     * @return True if the line contains a data frame
+     */
+    static bool parseAscLine( const std::string &line, bool hexIds, CANLogFrame &frame );
+
+    /**
+     * @brief Parses the date header of a Vector ASC log like "date Wed Sep 29 10:31:26.123 am 2021" as local time
+     * @param line line of the log file
+     * @param startTime time in milliseconds since epoch
+     * @return True if the line is a valid date header
+     */
+    static bool parseAscDate( const std::string &line, Timestamp &startTime );
+
+private:
+    // Start the replay thread
+    bool start();
+    // Stop the replay thread
+    bool stop();
+    // atomic state of the replay. If true, we should stop
+    bool shouldStop() const;
+    // Intercepts sleep signals.
+    bool shouldSleep() const;
+    // Main work function. Reads the frames from the log file and pushes them to the circular buffer.
+    static void doWork( void *data );
+    // Read the next frame of the configured channel from the file
+    bool readNextFrame( CANLogFrame &frame );
+    // Wait until the frame is due in the scaled time mode
+    bool waitUntilDue( Timestamp recordedTime );
+
+    Thread mThread;
+    std::atomic<bool> mShouldStop{ false };
+    std::atomic<bool> mShouldSleep{ false };
+    mutable std::mutex mThreadMutex;
+    LoggingModule mLogger;
+    Platform::Linux::Signal mWait;
+    std::shared_ptr<ReplayClock> mReplayClock;
+    std::string mLogFilePath;
+    std::string mLogInterfaceName;
+    std::ifstream mLogFile;
+    double mReplaySpeed{ 0.0 };
+    bool mKeepRecordedTimestamps{ false };
+    uint32_t mIdleTimeMs{ DEFAULT_THREAD_IDLE_TIME_MS };
+    // State of the ASC format, only used by the replay thread
+    bool mAscHexIds{ true };
+    bool mAscRelativeTimestamps{ false };
+    Timestamp mAscStartTime{ 0 };
+    Timestamp mAscLastTime{ 0 };
+    // Time of the first replayed frame in the recording and when it was replayed
+    bool mReplayStarted{ false };
+    Timestamp mFirstRecordedTime{ 0 };
+    Timestamp mReplayStartTime{ 0 };
+    std::chrono::steady_clock::time_point mReplayStartSteadyTime;
+    std::atomic<bool> mReplayFinished{ false };
+    std::atomic<uint64_t> mReplayedFrames{ 0 };
+};
+} // namespace VehicleNetwork
+} // namespace IoTFleetWise
+} // namespace Aws
+#endif // IOTFLEETWISE_LINUX
@@ -0,0 +1,129 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#pragma once
+
+#if defined( IOTFLEETWISE_LINUX )
+// Includes
+#include "LoggingModule.h"
+#include "Thread.h"
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+using namespace Aws::IoTFleetWise::Platform::Linux;
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace VehicleNetwork
+{
+
+class CANDataSource;
+
+/**
+ * @brief Reads the sockets of several CAN data sources in one thread. The thread blocks in epoll until a
+ * socket is readable, instead of each data source polling its socket from an own thread.
+ * A data source uses the reader if it was set with CANDataSource::setMultiBusReader before connect.
+ * Suspended data sources stay registered but their sockets are not watched.
+ */
+class CANMultiBusReader
+{
+public:
+    static constexpr int MAX_EPOLL_EVENTS = 16;
+    // Number of receive batches read from one socket before the other sockets are served
+    static constexpr uint32_t MAX_BATCHES_PER_EVENT = 4;
+    // Timeout of epoll_wait, so that the frame filter statistics are updated without traffic
+    static constexpr int WAIT_TIMEOUT_MS = 1000;
+
+    /**
+     * @brief Constructor
+     * @param index index of the reader, used in the thread name
+     */
+    CANMultiBusReader( uint32_t index = 1 );
+
+    ~CANMultiBusReader();
+
+    CANMultiBusReader( const CANMultiBusReader & ) = delete;
+    CANMultiBusReader &operator=( const CANMultiBusReader & ) = delete;
+    CANMultiBusReader( CANMultiBusReader && ) = delete;
+    CANMultiBusReader &operator=( CANMultiBusReader && ) = delete;
+
+    /**
+     * @brief Create the epoll instance and start the reader thread
+     * @return True if the thread is running
+     */
+    bool start();
+
+    /**
+     * @brief Stop the reader thread. All data sources must be removed before.
+     * @return True if the thread was stopped
+     */
+    bool stop();
+
+    /**
+     * @brief Checks if the reader thread is running
+     * @return True if it's running
+     */
+    bool isAlive() const;
+
+    /**
+     * @brief Register the connected socket of a data source. The socket is not watched until the data source is
+     * enabled with setSourceEnabled.
+     * @param source connected data source, must stay valid until it is removed
+     * @return True if the source was added
+     */
+    bool addSource( CANDataSource *source );
+
+    /**
+     * @brief Remove a data source. When this returns the reader thread does not access the source anymore.
+     * @param source data source added before
+     * @return True if the source was removed
+     */
+    bool removeSource( CANDataSource *source );
+
+    /**
+     * @brief Start or stop watching the socket of a data source
+     * @param source data source added before
+     * @param enabled if true, frames are read from the socket as soon as it is readable
+     * @return True if successful
+     */
+    bool setSourceEnabled( CANDataSource *source, bool enabled );
+
+private:
+    // Main work function. Waits until sockets are readable and reads their frames.
+    static void doWork( void *data );
+
+    // Wake up the thread from epoll_wait
+    void wakeUp();
+
+    // Read the frames of a readable source, mSourcesMutex must be held
+    void readSource( CANDataSource *source );
+
+    uint32_t mIndex;
+    Thread mThread;
+    std::atomic<bool> mShouldStop{ false };
+    mutable std::mutex mThreadMutex;
+    LoggingModule mLogger;
+    int mEpollFd{ -1 };
+    int mWakeUpFd{ -1 };
+    // Protects mSources. Held by the reader thread while it reads sockets, so that removeSource waits for it.
+    std::mutex mSourcesMutex;
+    std::vector<CANDataSource *> mSources;
+};
+
+} // namespace VehicleNetwork
+} // namespace IoTFleetWise
+} // namespace Aws
+#endif // IOTFLEETWISE_LINUX
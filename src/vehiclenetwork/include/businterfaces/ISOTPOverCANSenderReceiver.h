@@ -68,6 +68,18 @@ public:
      */
     bool isAlive() const;
 
+    /**
+     * @brief Returns the file descriptor of the ISO-TP socket, so that the readiness of several
+     *        channels can be waited for at once e.g. with epoll. A PDU can then be read with
+     *        receivePDU without blocking.
+     * @return the socket, only valid while the channel is connected
+     */
+    int
+    getSocket() const
+    {
+        return mSocket;
+    }
+
     /**
      * @brief Receives PDUs over the channel. This API blocks
      *        till all bytes in the PDU are consumed.
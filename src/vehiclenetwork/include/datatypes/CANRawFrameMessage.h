@@ -0,0 +1,140 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#pragma once
+
+// Includes
+#include "TimeTypes.h"
+#include "datatypes/VehicleDataSourceTypes.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <type_traits>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace VehicleNetwork
+{
+
+using namespace Aws::IoTFleetWise::Platform::Linux;
+
+/**
+ * @brief Maximum number of payload bytes a raw CAN frame message can hold inline, the size of a CAN FD payload.
+ */
+static constexpr uint8_t MAX_RAW_CAN_FRAME_BYTE_SIZE = 64;
+
+/**
+ * @brief Raw CAN frame as received from the network interface.
+ *
+ * Unlike VehicleDataMessage, this type has a fixed size and keeps the frame bytes inline. It is
+ * trivially copyable, so handing it over through the single producer/consumer queue between the
+ * data source and the consumer never touches the heap.
+ */
+class CANRawFrameMessage
+{
+public:
+    /**
+     * @brief CAN Frame ID (arbitration ID) without the EFF/RTR/ERR flags
+     * @return ID
+     */
+    inline std::uint32_t
+    getMessageID() const
+    {
+        return mID;
+    }
+
+    /**
+     * @brief ID of the Vehicle Data Source that received the frame
+     * @return Channel ID
+     */
+    inline VehicleDataSourceID
+    getChannelID() const
+    {
+        return mChannelID;
+    }
+
+    /**
+     * @brief Pointer to the frame payload. Only the first getSize() bytes are valid.
+     * @return Pointer to the first byte of the payload
+     */
+    inline const std::uint8_t *
+    getData() const
+    {
+        return mData.data();
+    }
+
+    /**
+     * @brief Number of valid payload bytes
+     * @return Size in bytes
+     */
+    inline std::uint8_t
+    getSize() const
+    {
+        return mSize;
+    }
+
+    /**
+     * @brief Timepoint when the frame was acquired from the vehicle, usually the kernel timestamp
+     * @return Timestamp
+     */
+    inline Timestamp
+    getReceptionTimestamp() const
+    {
+        return mTimestamp;
+    }
+
+    /**
+     * @brief Checks if the message is valid or not. A message is valid if it carries a payload.
+     * @return True if Valid, False if not.
+     */
+    inline bool
+    isValid() const
+    {
+        return mSize > 0;
+    }
+
+    /**
+     * @brief Routine to setup a raw CAN frame message. Payloads longer than
+     * MAX_RAW_CAN_FRAME_BYTE_SIZE are truncated.
+     */
+    inline void
+    setup( std::uint32_t id,
+           VehicleDataSourceID channelID,
+           const std::uint8_t *data,
+           std::uint8_t size,
+           Timestamp timestamp )
+    {
+        mID = id;
+        mChannelID = channelID;
+        mTimestamp = timestamp;
+        mSize = std::min( size, MAX_RAW_CAN_FRAME_BYTE_SIZE );
+        std::copy( data, data + mSize, mData.begin() );
+    }
+
+private:
+    Timestamp mTimestamp{ 0 };
+    std::uint32_t mID{ 0 };
+    VehicleDataSourceID mChannelID{ INVALID_DATA_SOURCE_ID };
+    std::array<std::uint8_t, MAX_RAW_CAN_FRAME_BYTE_SIZE> mData{};
+    std::uint8_t mSize{ 0 };
+};
+
+static_assert( std::is_trivially_copyable<CANRawFrameMessage>::value,
+               "CANRawFrameMessage must stay trivially copyable to be passed through the lock-free queues" );
+
+} // namespace VehicleNetwork
+} // namespace IoTFleetWise
+} // namespace Aws
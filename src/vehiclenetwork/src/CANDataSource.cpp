@@ -17,8 +17,10 @@
 #include "ClockHandler.h"
 #include "EnumUtility.h"
 #include "TraceModule.h"
+#include <algorithm>
 #include <boost/lockfree/spsc_queue.hpp>
 #include <cstring>
+#include <fstream>
 #include <iostream>
 #include <linux/can.h>
 #include <linux/can/raw.h>
@@ -36,7 +38,16 @@ namespace VehicleNetwork
 using namespace Aws::IoTFleetWise::Platform::Utility;
 static const std::string INTERFACE_NAME_KEY = "interfaceName";
 static const std::string THREAD_IDLE_TIME_KEY = "threadIdleTimeMs";
+static const std::string RECEIVE_BATCH_SIZE_KEY = "receiveBatchSize";
+// We expect only one timestamp to return
+static constexpr size_t CONTROL_BUFFER_SIZE = CMSG_SPACE( sizeof( struct scm_timestamping ) );
 static constexpr uint32_t MSB_MASK = 0X7FFFFFFFU;
+// The largest shift groups all 29 bit IDs into one filter
+static constexpr uint32_t MAX_FILTER_MASK_SHIFT = 29U;
+constexpr size_t CANDataSource::MAX_FRAME_FILTERS;
+constexpr uint32_t CANDataSource::FILTER_STATISTICS_INTERVAL_MS;
+constexpr uint32_t CANDataSource::MAX_RECEIVE_BATCH_SIZE;
+
 CANDataSource::CANDataSource( CAN_TIMESTAMP_TYPE timestampTypeToUse )
     : mTimestampTypeToUse{ timestampTypeToUse }
 {
@@ -54,8 +65,13 @@ CANDataSource::CANDataSource()
 
 CANDataSource::~CANDataSource()
 {
+    if ( mMultiBusReader != nullptr )
+    {
+        // The reader must not access this source anymore
+        mMultiBusReader->removeSource( this );
+    }
     // To make sure the thread stops during teardown of tests.
-    if ( isAlive() )
+    else if ( isAlive() )
     {
         stop();
     }
@@ -83,7 +99,7 @@ CANDataSource::init( const std::vector<VehicleDataSourceConfig> &sourceConfigs )
     }
 
     mCircularBuffPtr =
-        std::make_shared<VehicleMessageCircularBuffer>( sourceConfigs[0].maxNumberOfVehicleDataMessages );
+        std::make_shared<CANRawFrameCircularBuffer>( sourceConfigs[0].maxNumberOfVehicleDataMessages );
     settingsIterator = sourceConfigs[0].transportProperties.find( std::string( THREAD_IDLE_TIME_KEY ) );
     if ( settingsIterator == sourceConfigs[0].transportProperties.end() )
     {
@@ -104,10 +120,53 @@ CANDataSource::init( const std::vector<VehicleDataSourceConfig> &sourceConfigs )
         }
     }
 
+    uint32_t batchSize = PARALLEL_RECEIVED_FRAMES_FROM_KERNEL;
+    settingsIterator = sourceConfigs[0].transportProperties.find( RECEIVE_BATCH_SIZE_KEY );
+    if ( settingsIterator != sourceConfigs[0].transportProperties.end() )
+    {
+        try
+        {
+            batchSize = static_cast<uint32_t>( std::stoul( settingsIterator->second ) );
+        }
+        catch ( const std::exception &e )
+        {
+            mLogger.error( "CANDataSource::init",
+                           "Could not cast the receiveBatchSize, invalid input: " + std::string( e.what() ) );
+            return false;
+        }
+        if ( ( batchSize == 0 ) || ( batchSize > MAX_RECEIVE_BATCH_SIZE ) )
+        {
+            mLogger.error( "CANDataSource::init",
+                           "receiveBatchSize must be between 1 and " + std::to_string( MAX_RECEIVE_BATCH_SIZE ) );
+            return false;
+        }
+    }
+    setupReceiveBuffers( batchSize );
+
     mTimer.reset();
     return true;
 }
 
+void
+CANDataSource::setupReceiveBuffers( uint32_t batchSize )
+{
+    mFrames.resize( batchSize );
+    mFrameBuffers.resize( batchSize );
+    mMessageHeaders.resize( batchSize );
+    mControlBuffers.assign( batchSize * CONTROL_BUFFER_SIZE, 0 );
+    for ( uint32_t i = 0; i < batchSize; i++ )
+    {
+        mFrameBuffers[i].iov_base = &mFrames[i];
+        mFrameBuffers[i].iov_len = sizeof( mFrames[i] );
+        mMessageHeaders[i] = {};
+        mMessageHeaders[i].msg_hdr.msg_name = nullptr; // not interested in the source address
+        mMessageHeaders[i].msg_hdr.msg_namelen = 0;
+        mMessageHeaders[i].msg_hdr.msg_iov = &mFrameBuffers[i];
+        mMessageHeaders[i].msg_hdr.msg_iovlen = 1;
+        mMessageHeaders[i].msg_hdr.msg_control = &mControlBuffers[i * CONTROL_BUFFER_SIZE];
+    }
+}
+
 bool
 CANDataSource::start()
 {
@@ -138,6 +197,10 @@ CANDataSource::suspendDataAcquisition()
     mLogger.trace( "CANDataSource::suspendDataAcquisition",
                    "Going to sleep until a the resume signal. CAN Data Source : " + std::to_string( mID ) );
     mShouldSleep.store( true, std::memory_order_relaxed );
+    if ( ( mMultiBusReader != nullptr ) && ( mSocket >= 0 ) )
+    {
+        mMultiBusReader->setSourceEnabled( this, false );
+    }
 }
 
 void
@@ -148,7 +211,20 @@ CANDataSource::resumeDataAcquisition()
                    " Resuming Network data acquisition on Data Source :" + std::to_string( mID ) );
     // Make sure the thread does not sleep anymore
     mResumeTime = mClock->timeSinceEpochMs();
+    if ( mShouldSleep.load() )
+    {
+        // Old messages in the kernel queue need to be ignored
+        mWokeUpFromSleep.store( true );
+    }
     mShouldSleep.store( false );
+    if ( mMultiBusReader != nullptr )
+    {
+        if ( mSocket >= 0 )
+        {
+            mMultiBusReader->setSourceEnabled( this, true );
+        }
+        return;
+    }
     // Wake up the worker thread.
     mWait.notify();
 }
@@ -219,21 +295,90 @@ CANDataSource::extractTimestamp( struct msghdr *msgHeader )
     return timestamp;
 }
 
+int
+CANDataSource::receiveFrames()
+{
+    // The kernel overwrites the length of the control data, so it is set again for every call
+    for ( auto &msg : mMessageHeaders )
+    {
+        msg.msg_hdr.msg_controllen = CONTROL_BUFFER_SIZE;
+    }
+    // In one syscall receive up to the batch size frames in parallel
+    int nmsgs =
+        recvmmsg( mSocket, mMessageHeaders.data(), static_cast<unsigned int>( mMessageHeaders.size() ), 0, nullptr );
+    if ( nmsgs > 0 )
+    {
+        mReadFrames += static_cast<uint64_t>( nmsgs );
+    }
+    const bool wokeUpFromSleep = mWokeUpFromSleep.load( std::memory_order_relaxed );
+    for ( int i = 0; i < nmsgs; i++ )
+    {
+        Timestamp timestamp = extractTimestamp( &mMessageHeaders[static_cast<size_t>( i )].msg_hdr );
+        if ( timestamp < mLastFrameTime )
+        {
+            TraceModule::get().incrementAtomicVariable( TraceAtomicVariable::NOT_TIME_MONOTONIC_FRAMES );
+        }
+        // After waking up the Socket Can old messages in the kernel queue need to be ignored
+        if ( !wokeUpFromSleep || timestamp >= mResumeTime )
+        {
+            mLastFrameTime = timestamp;
+            receivedMessages++;
+            TraceVariable traceFrames =
+                static_cast<TraceVariable>( mID + toUType( TraceVariable::READ_SOCKET_FRAMES_0 ) );
+            TraceModule::get().setVariable( ( traceFrames < TraceVariable::READ_SOCKET_FRAMES_MAX )
+                                                ? traceFrames
+                                                : TraceVariable::READ_SOCKET_FRAMES_MAX,
+                                            receivedMessages );
+            // Compose the correct CAN Frame ID by clearing the MSB. The frame bytes are copied inline into
+            // the message so that no heap allocation happens per received frame.
+            const auto &frame = mFrames[static_cast<size_t>( i )];
+            CANRawFrameMessage message;
+            message.setup( frame.can_id & MSB_MASK, mID, frame.data, frame.len, timestamp );
+            if ( message.isValid() )
+            {
+                if ( !mCircularBuffPtr->push( message ) )
+                {
+                    discardedMessages++;
+                    TraceModule::get().setVariable( TraceVariable::DISCARDED_FRAMES, discardedMessages );
+                    mLogger.warn( "CANDataSource::receiveFrames", " Circular Buffer is full" );
+                }
+            }
+            else
+            {
+                mLogger.warn( "CANDataSource::receiveFrames", "Message is not valid" );
+            }
+        }
+    }
+    if ( nmsgs < static_cast<int>( mMessageHeaders.size() ) )
+    {
+        // All frames queued in the kernel were read
+        mWokeUpFromSleep.store( false, std::memory_order_relaxed );
+    }
+    if ( ( nmsgs > 0 ) && mFramesReceivedCallback )
+    {
+        mFramesReceivedCallback();
+    }
+    return nmsgs;
+}
+
 void
 CANDataSource::doWork( void *data )
 {
 
     CANDataSource *dataSource = static_cast<CANDataSource *>( data );
 
-    Timestamp lastFrameTime = 0;
     uint32_t activations = 0;
-    bool wokeUpFromSleep =
-        false; /**< This variable is true after the thread is woken up for example because a valid decoder manifest was
-                  received until the thread sleeps for the next time when it is false again*/
     Timer logTimer;
+    Timer filterStatisticsTimer;
     do
     {
         activations++;
+        if ( filterStatisticsTimer.getElapsedMs().count() >=
+             static_cast<int64_t>( FILTER_STATISTICS_INTERVAL_MS ) )
+        {
+            dataSource->updateFilteredFrames();
+            filterStatisticsTimer.reset();
+        }
         if ( dataSource->shouldSleep() )
         {
             // We either just started or there was a decoder manifest update that we can't use
@@ -241,95 +386,140 @@ CANDataSource::doWork( void *data )
             dataSource->mLogger.trace( "CANDataSource::doWork",
                                        "No valid decoding dictionary available, Channel going to sleep " );
             dataSource->mWait.wait( Platform::Linux::Signal::WaitWithPredicate );
-            wokeUpFromSleep = true;
         }
 
         dataSource->mTimer.reset();
-        int nmsgs = 0;
-        struct can_frame frame[PARALLEL_RECEIVED_FRAMES_FROM_KERNEL];
-        struct iovec frame_buffer[PARALLEL_RECEIVED_FRAMES_FROM_KERNEL];
-        struct mmsghdr msg[PARALLEL_RECEIVED_FRAMES_FROM_KERNEL];
-        // we expect only one timestamp to return
-        char cmsgReturnBuffer[PARALLEL_RECEIVED_FRAMES_FROM_KERNEL][CMSG_SPACE( sizeof( struct scm_timestamping ) )] = {
-            { 0 } };
-
-        // Setup all buffer to receive data
-        for ( int i = 0; i < PARALLEL_RECEIVED_FRAMES_FROM_KERNEL; i++ )
-        {
-            frame_buffer[i].iov_base = &frame[i];
-            frame_buffer[i].iov_len = sizeof( frame );
-            msg[i].msg_hdr.msg_name = nullptr; // not interested in the source address
-            msg[i].msg_hdr.msg_namelen = 0;
-            msg[i].msg_hdr.msg_iov = &frame_buffer[i];
-            msg[i].msg_hdr.msg_iovlen = 1;
-            msg[i].msg_hdr.msg_control = &cmsgReturnBuffer[i];
-            msg[i].msg_hdr.msg_controllen = sizeof( cmsgReturnBuffer[i] );
-        }
-        // In one syscall receive up to PARALLEL_RECEIVED_FRAMES_FROM_KERNEL frames in parallel
-        nmsgs = recvmmsg( dataSource->mSocket, msg, PARALLEL_RECEIVED_FRAMES_FROM_KERNEL, 0, nullptr );
-        for ( int i = 0; i < nmsgs; i++ )
-        {
-            VehicleDataMessage message;
-            const std::vector<boost::any> syntheticData{};
-            std::vector<std::uint8_t> rawData = {};
-            Timestamp timestamp = dataSource->extractTimestamp( &msg[i].msg_hdr );
-            if ( timestamp < lastFrameTime )
-            {
-                TraceModule::get().incrementAtomicVariable( TraceAtomicVariable::NOT_TIME_MONOTONIC_FRAMES );
-            }
-            // After waking up the Socket Can old messages in the kernel queue need to be ignored
-            if ( !wokeUpFromSleep || timestamp >= dataSource->mResumeTime )
-            {
-                lastFrameTime = timestamp;
-                dataSource->receivedMessages++;
-                TraceVariable traceFrames =
-                    static_cast<TraceVariable>( dataSource->mID + toUType( TraceVariable::READ_SOCKET_FRAMES_0 ) );
-                TraceModule::get().setVariable( ( traceFrames < TraceVariable::READ_SOCKET_FRAMES_MAX )
-                                                    ? traceFrames
-                                                    : TraceVariable::READ_SOCKET_FRAMES_MAX,
-                                                dataSource->receivedMessages );
-                rawData.reserve( frame[i].can_dlc );
-                for ( size_t j = 0; j < frame[i].can_dlc; ++j )
-                {
-                    rawData.emplace_back( frame[i].data[j] );
-                }
-                // Compose the correct CAN Frame ID by clearing the MSB
-                message.setup( frame[i].can_id & MSB_MASK, rawData, syntheticData, timestamp );
-                if ( message.isValid() )
-                {
-                    if ( !dataSource->mCircularBuffPtr->push( message ) )
-                    {
-                        dataSource->discardedMessages++;
-                        TraceModule::get().setVariable( TraceVariable::DISCARDED_FRAMES,
-                                                        dataSource->discardedMessages );
-                        dataSource->mLogger.warn( "CANDataSource::doWork", " Circular Buffer is full" );
-                    }
-                }
-                else
-                {
-                    dataSource->mLogger.warn( "CANDataSource::doWork", "Message is not valid" );
-                }
-            }
-        }
+        int nmsgs = dataSource->receiveFrames();
         if ( nmsgs <= 0 )
         {
             if ( logTimer.getElapsedMs().count() > static_cast<int64_t>( LoggingModule::LOG_AGGREGATION_TIME_MS ) )
             {
                 // Nothing is in the ring buffer to consume. Go to idle mode for some time.
-                dataSource->mLogger.trace(
-                    "CANDataSource::doWork",
-                    "Activations: " + std::to_string( activations ) +
-                        ". Waiting for some data to come. Idling for :" + std::to_string( dataSource->mIdleTimeMs ) +
-                        " ms, processed " + std::to_string( dataSource->receivedMessages ) + " frames" );
+                if ( LoggingModule::isEnabled( LogLevel::Trace ) )
+                {
+                    dataSource->mLogger.trace( "CANDataSource::doWork",
+                                               "Activations: " + std::to_string( activations ) +
+                                                   ". Waiting for some data to come. Idling for :" +
+                                                   std::to_string( dataSource->mIdleTimeMs ) + " ms, processed " +
+                                                   std::to_string( dataSource->receivedMessages ) + " frames" );
+                }
                 activations = 0;
                 logTimer.reset();
             }
             dataSource->mWait.wait( static_cast<uint32_t>( dataSource->mIdleTimeMs ) );
-            wokeUpFromSleep = false;
         }
     } while ( !dataSource->shouldStop() );
 }
 
+std::vector<struct can_filter>
+CANDataSource::createFrameFilters( std::vector<uint32_t> frameIds, size_t maxFilters )
+{
+    for ( auto &frameId : frameIds )
+    {
+        frameId &= CAN_EFF_MASK;
+    }
+    std::sort( frameIds.begin(), frameIds.end() );
+    frameIds.erase( std::unique( frameIds.begin(), frameIds.end() ), frameIds.end() );
+    maxFilters = std::max<size_t>( maxFilters, 1U );
+
+    // Find the smallest number of ignored lower bits, so that the groups of IDs with the same upper bits fit
+    // into the filters. As the IDs are sorted, IDs with the same upper bits are next to each other.
+    uint32_t shift = 0;
+    std::vector<uint32_t> groups = frameIds;
+    while ( ( groups.size() > maxFilters ) && ( shift < MAX_FILTER_MASK_SHIFT ) )
+    {
+        shift++;
+        groups.clear();
+        for ( auto frameId : frameIds )
+        {
+            auto group = frameId >> shift;
+            if ( groups.empty() || ( groups.back() != group ) )
+            {
+                groups.push_back( group );
+            }
+        }
+    }
+
+    std::vector<struct can_filter> filters;
+    filters.reserve( groups.size() );
+    for ( auto group : groups )
+    {
+        struct can_filter filter = {};
+        filter.can_id = group << shift;
+        // The flags are not part of the mask, so standard and extended frames with the ID pass
+        filter.can_mask = CAN_EFF_MASK & ~( ( 1U << shift ) - 1U );
+        filters.push_back( filter );
+    }
+    return filters;
+}
+
+bool
+CANDataSource::setFrameFilter( const std::vector<uint32_t> &frameIds )
+{
+    std::lock_guard<std::mutex> lock( mFrameFilterMutex );
+    mFrameFilters = createFrameFilters( frameIds );
+    mFrameFilterActive.store( true );
+    if ( frameIds.size() > MAX_FRAME_FILTERS )
+    {
+        mLogger.info( "CANDataSource::setFrameFilter",
+                      std::to_string( frameIds.size() ) + " frame IDs on " + mIfName + " are combined into " +
+                          std::to_string( mFrameFilters.size() ) + " masked filters" );
+    }
+    if ( mSocket < 0 )
+    {
+        // Applied on connect
+        return true;
+    }
+    return applyFrameFilters();
+}
+
+bool
+CANDataSource::applyFrameFilters()
+{
+    // An empty filter list makes the socket receive no frames at all
+    if ( setsockopt( mSocket,
+                     SOL_CAN_RAW,
+                     CAN_RAW_FILTER,
+                     mFrameFilters.empty() ? nullptr : mFrameFilters.data(),
+                     static_cast<socklen_t>( mFrameFilters.size() * sizeof( struct can_filter ) ) ) != 0 )
+    {
+        mLogger.error( "CANDataSource::applyFrameFilters",
+                       "Could not set the CAN filter on " + mIfName + ": " + std::string( strerror( errno ) ) );
+        return false;
+    }
+    mLogger.trace( "CANDataSource::applyFrameFilters",
+                   "Set " + std::to_string( mFrameFilters.size() ) + " CAN filters on " + mIfName );
+    return true;
+}
+
+void
+CANDataSource::updateFilteredFrames()
+{
+    if ( !mFrameFilterActive.load( std::memory_order_relaxed ) )
+    {
+        return;
+    }
+    std::ifstream statisticsFile( "/sys/class/net/" + mIfName + "/statistics/rx_packets" );
+    uint64_t interfaceRxFrames = 0;
+    if ( !( statisticsFile >> interfaceRxFrames ) )
+    {
+        return;
+    }
+    // The first reading is only the baseline
+    if ( mLastInterfaceRxFrames != 0 )
+    {
+        auto receivedFrames = interfaceRxFrames - mLastInterfaceRxFrames;
+        auto readFrames = mReadFrames - mLastReadFrames;
+        if ( receivedFrames > readFrames )
+        {
+            TraceModule::get().addToAtomicVariable( TraceAtomicVariable::CAN_FILTERED_FRAMES,
+                                                    receivedFrames - readFrames );
+        }
+    }
+    mLastInterfaceRxFrames = interfaceRxFrames;
+    mLastReadFrames = mReadFrames;
+}
+
 size_t
 CANDataSource::queueSize() const
 {
@@ -378,6 +568,24 @@ CANDataSource::connect()
         }
     }
 
+    // Also receive CAN FD frames. Without kernel support only classic CAN frames are received.
+    const int enableFdFrames = 1;
+    if ( setsockopt( mSocket, SOL_CAN_RAW, CAN_RAW_FD_FRAMES, &enableFdFrames, sizeof( enableFdFrames ) ) != 0 )
+    {
+        mLogger.warn( "CANDataSource::connect", "CAN FD frames are not supported on " + mIfName );
+    }
+
+    // Set the filter before binding so that no unneeded frames are queued on the socket
+    if ( mFrameFilterActive.load() )
+    {
+        std::lock_guard<std::mutex> lock( mFrameFilterMutex );
+        if ( !applyFrameFilters() )
+        {
+            close( mSocket );
+            return false;
+        }
+    }
+
     memset( &interfaceAddress, 0, sizeof( interfaceAddress ) );
     interfaceAddress.can_family = AF_CAN;
     interfaceAddress.can_ifindex = interfaceRequest.ifr_ifindex;
@@ -391,6 +599,12 @@ CANDataSource::connect()
     }
     // Notify on connection success
     notifyListeners<const VehicleDataSourceID &>( &VehicleDataSourceListener::onVehicleDataSourceConnected, mID );
+    if ( mMultiBusReader != nullptr )
+    {
+        // Like the own thread, the reader only reads the socket after the data acquisition is resumed
+        mShouldSleep.store( true );
+        return mMultiBusReader->addSource( this );
+    }
     // Start the main thread.
     return start();
 }
@@ -398,7 +612,16 @@ CANDataSource::connect()
 bool
 CANDataSource::disconnect()
 {
-    if ( !stop() && close( mSocket ) < 0 )
+    if ( mMultiBusReader != nullptr )
+    {
+        mMultiBusReader->removeSource( this );
+        if ( close( mSocket ) < 0 )
+        {
+            return false;
+        }
+        mSocket = -1;
+    }
+    else if ( !stop() && close( mSocket ) < 0 )
     {
         return false;
     }
@@ -414,11 +637,15 @@ CANDataSource::isAlive()
     socklen_t len = sizeof( error );
     // Get the error status of the socket
     int retSockOpt = getsockopt( mSocket, SOL_SOCKET, SO_ERROR, &error, &len );
-    if ( retSockOpt == -1 || !mThread.isValid() || !mThread.isActive() || error != 0 )
+    if ( retSockOpt == -1 || error != 0 )
     {
         return false;
     }
-    return true;
+    if ( mMultiBusReader != nullptr )
+    {
+        return mMultiBusReader->isAlive();
+    }
+    return mThread.isValid() && mThread.isActive();
 }
 
 } // namespace VehicleNetwork
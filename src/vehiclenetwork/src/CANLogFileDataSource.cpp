@@ -0,0 +1,590 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#if defined( IOTFLEETWISE_LINUX )
+// Includes
+#include "businterfaces/CANLogFileDataSource.h"
+#include "EnumUtility.h"
+#include "TraceModule.h"
+#include <algorithm>
+#include <cstdlib>
+#include <ctime>
+#include <linux/can.h>
+#include <sstream>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace VehicleNetwork
+{
+using namespace Aws::IoTFleetWise::Platform::Utility;
+static const std::string LOG_FILE_KEY = "logFile";
+static const std::string REPLAY_SPEED_KEY = "replaySpeed";
+static const std::string LOG_INTERFACE_NAME_KEY = "logInterfaceName";
+static const std::string KEEP_RECORDED_TIMESTAMPS_KEY = "keepRecordedTimestamps";
+static const std::string THREAD_IDLE_TIME_KEY = "threadIdleTimeMs";
+static const std::array<std::string, 12> MONTH_NAMES = {
+    "Jan", "Feb", "Mar", "Apr", "May", "Jun", "Jul", "Aug", "Sep", "Oct", "Nov", "Dec" };
+constexpr uint32_t CANLogFileDataSource::DEFAULT_THREAD_IDLE_TIME_MS;
+constexpr uint32_t CANLogFileDataSource::BUFFER_FULL_WAIT_TIME_MS;
+
+/**
+ * @brief Parses an unsigned number of at most 32 bits
+ */
+static bool
+parseNumber( const std::string &text, int base, uint32_t &value )
+{
+    if ( text.empty() || ( text.size() > 10 ) || ( text[0] == '-' ) || ( text[0] == '+' ) )
+    {
+        return false;
+    }
+    char *end = nullptr;
+    auto parsed = strtoul( text.c_str(), &end, base );
+    if ( ( *end != '\0' ) || ( parsed > UINT32_MAX ) )
+    {
+        return false;
+    }
+    value = static_cast<uint32_t>( parsed );
+    return true;
+}
+
+/**
+ * @brief Parses seconds with an optional fraction like "1600000000.123456" into milliseconds
+ */
+static bool
+parseSeconds( const std::string &text, Timestamp &milliseconds )
+{
+    auto point = text.find( '.' );
+    auto secondsText = text.substr( 0, point );
+    auto fractionText = ( point == std::string::npos ) ? std::string() : text.substr( point + 1 );
+    if ( secondsText.empty() || ( secondsText.size() > 12 ) ||
+         ( secondsText.find_first_not_of( "0123456789" ) != std::string::npos ) ||
+         ( fractionText.find_first_not_of( "0123456789" ) != std::string::npos ) )
+    {
+        return false;
+    }
+    fractionText = ( fractionText + "000" ).substr( 0, 3 );
+    milliseconds = static_cast<Timestamp>( std::stoull( secondsText ) * 1000 + std::stoull( fractionText ) );
+    return true;
+}
+
+static std::vector<std::string>
+splitTokens( const std::string &line )
+{
+    std::istringstream stream( line );
+    std::vector<std::string> tokens;
+    std::string token;
+    while ( stream >> token )
+    {
+        tokens.push_back( token );
+    }
+    return tokens;
+}
+
+CANLogFileDataSource::CANLogFileDataSource( std::shared_ptr<ReplayClock> replayClock )
+    : mReplayClock( std::move( replayClock ) )
+{
+    mType = VehicleDataSourceType::CAN_SOURCE;
+    mNetworkProtocol = VehicleDataSourceProtocol::RAW_SOCKET;
+    mID = generateSourceID();
+}
+
+CANLogFileDataSource::~CANLogFileDataSource()
+{
+    // To make sure the thread stops during teardown of tests.
+    if ( isAlive() )
+    {
+        stop();
+    }
+}
+
+bool
+CANLogFileDataSource::init( const std::vector<VehicleDataSourceConfig> &sourceConfigs )
+{
+    // Only one source config is supported, i.e. one log file is replayed by one thread
+    if ( sourceConfigs.size() > 1 || sourceConfigs.empty() )
+    {
+        mLogger.error( "CANLogFileDataSource::init", " Only one source config is supported " );
+        return false;
+    }
+    const auto &properties = sourceConfigs[0].transportProperties;
+    auto settingsIterator = properties.find( LOG_FILE_KEY );
+    if ( ( settingsIterator == properties.end() ) || settingsIterator->second.empty() )
+    {
+        mLogger.error( "CANLogFileDataSource::init", "Could not find logFile in the config" );
+        return false;
+    }
+    mLogFilePath = settingsIterator->second;
+    mIfName = mLogFilePath;
+    mReplaySpeed = 0.0;
+    mIdleTimeMs = DEFAULT_THREAD_IDLE_TIME_MS;
+    mLogInterfaceName.clear();
+    try
+    {
+        settingsIterator = properties.find( REPLAY_SPEED_KEY );
+        if ( settingsIterator != properties.end() )
+        {
+            mReplaySpeed = std::stod( settingsIterator->second );
+        }
+        settingsIterator = properties.find( THREAD_IDLE_TIME_KEY );
+        if ( settingsIterator != properties.end() )
+        {
+            mIdleTimeMs = static_cast<uint32_t>( std::stoul( settingsIterator->second ) );
+        }
+    }
+    catch ( const std::exception &e )
+    {
+        mLogger.error( "CANLogFileDataSource::init",
+                       "Could not cast the replaySpeed or threadIdleTimeMs, invalid input: " +
+                           std::string( e.what() ) );
+        return false;
+    }
+    if ( mReplaySpeed < 0.0 )
+    {
+        mLogger.error( "CANLogFileDataSource::init", "replaySpeed must not be negative" );
+        return false;
+    }
+    settingsIterator = properties.find( LOG_INTERFACE_NAME_KEY );
+    if ( settingsIterator != properties.end() )
+    {
+        mLogInterfaceName = settingsIterator->second;
+    }
+    settingsIterator = properties.find( KEEP_RECORDED_TIMESTAMPS_KEY );
+    mKeepRecordedTimestamps = ( settingsIterator != properties.end() ) && ( settingsIterator->second == "true" );
+
+    mCircularBuffPtr =
+        std::make_shared<CANRawFrameCircularBuffer>( sourceConfigs[0].maxNumberOfVehicleDataMessages );
+    return true;
+}
+
+bool
+CANLogFileDataSource::start()
+{
+    // Prevent concurrent stop/init
+    std::lock_guard<std::mutex> lock( mThreadMutex );
+    // On multi core systems the shared variable mShouldStop must be updated for
+    // all cores before starting the thread otherwise thread will directly end
+    mShouldStop.store( false );
+    // Make sure the thread goes into sleep immediately to wait for
+    // the manifest to be available
+    mShouldSleep.store( true );
+    if ( !mThread.create( doWork, this ) )
+    {
+        mLogger.trace( "CANLogFileDataSource::start", " CAN Log File Data Source Thread failed to start " );
+    }
+    else
+    {
+        mLogger.trace( "CANLogFileDataSource::start", " CAN Log File Data Source Thread started " );
+        mThread.setThreadName( "fwVNCANLogFile" + std::to_string( mID ) );
+    }
+    return mThread.isActive() && mThread.isValid();
+}
+
+bool
+CANLogFileDataSource::stop()
+{
+    std::lock_guard<std::mutex> lock( mThreadMutex );
+    mShouldStop.store( true, std::memory_order_relaxed );
+    mWait.notify();
+    mThread.release();
+    mShouldStop.store( false, std::memory_order_relaxed );
+    mLogger.trace( "CANLogFileDataSource::stop", " CAN Log File Data Source Thread stopped " );
+    return !mThread.isActive();
+}
+
+bool
+CANLogFileDataSource::shouldStop() const
+{
+    return mShouldStop.load( std::memory_order_relaxed );
+}
+
+bool
+CANLogFileDataSource::shouldSleep() const
+{
+    return mShouldSleep.load( std::memory_order_relaxed );
+}
+
+void
+CANLogFileDataSource::suspendDataAcquisition()
+{
+    // The replay pauses at the current position of the log file
+    mLogger.trace( "CANLogFileDataSource::suspendDataAcquisition",
+                   "Going to sleep until a the resume signal. CAN Log File Data Source : " + std::to_string( mID ) );
+    mShouldSleep.store( true, std::memory_order_relaxed );
+}
+
+void
+CANLogFileDataSource::resumeDataAcquisition()
+{
+    mLogger.trace( "CANLogFileDataSource::resumeDataAcquisition",
+                   " Resuming the replay on Data Source :" + std::to_string( mID ) );
+    mShouldSleep.store( false );
+    // Wake up the worker thread.
+    mWait.notify();
+}
+
+bool
+CANLogFileDataSource::parseCandumpLine( const std::string &line, CANLogFrame &frame )
+{
+    auto tokens = splitTokens( line );
+    if ( ( tokens.size() < 3 ) || ( tokens[0].size() < 3 ) || ( tokens[0].front() != '(' ) ||
+         ( tokens[0].back() != ')' ) ||
+         !parseSeconds( tokens[0].substr( 1, tokens[0].size() - 2 ), frame.timestamp ) )
+    {
+        return false;
+    }
+    const auto &frameText = tokens[2];
+    auto separator = frameText.find( '#' );
+    if ( ( separator == std::string::npos ) || ( separator == 0 ) ||
+         !parseNumber( frameText.substr( 0, separator ), 16, frame.id ) || ( frame.id > CAN_EFF_MASK ) )
+    {
+        // IDs of error frames contain the CAN_ERR_FLAG
+        return false;
+    }
+    auto dataText = frameText.substr( separator + 1 );
+    if ( !dataText.empty() && ( dataText[0] == '#' ) )
+    {
+        // Skip the second separator and the flags of CAN FD frames
+        if ( dataText.size() < 2 )
+        {
+            return false;
+        }
+        dataText = dataText.substr( 2 );
+    }
+    else if ( !dataText.empty() && ( dataText[0] == 'R' ) )
+    {
+        return false;
+    }
+    // The payload bytes can be separated by dots
+    dataText.erase( std::remove( dataText.begin(), dataText.end(), '.' ), dataText.end() );
+    if ( ( ( dataText.size() % 2 ) != 0 ) || ( ( dataText.size() / 2 ) > MAX_RAW_CAN_FRAME_BYTE_SIZE ) )
+    {
+        return false;
+    }
+    frame.size = static_cast<uint8_t>( dataText.size() / 2 );
+    for ( size_t i = 0; i < frame.size; i++ )
+    {
+        uint32_t byte = 0;
+        if ( !parseNumber( dataText.substr( i * 2, 2 ), 16, byte ) )
+        {
+            return false;
+        }
+        frame.data[i] = static_cast<uint8_t>( byte );
+    }
+    frame.channel = tokens[1];
+    return true;
+}
+
+bool
+CANLogFileDataSource::parseAscLine( const std::string &line, bool hexIds, CANLogFrame &frame )
+{
+    auto tokens = splitTokens( line );
+    if ( ( tokens.size() < 6 ) || !parseSeconds( tokens[0], frame.timestamp ) )
+    {
+        return false;
+    }
+    bool isCanFd = ( tokens[1] == "CANFD" );
+    // Classic: <time> <channel> <id> <Rx|Tx> d <dlc> <data>...
+    // CAN FD: <time> CANFD <channel> <Rx|Tx> <id> [<name>] <brs> <esi> <dlc> <data length> <data>...
+    const auto &channel = isCanFd ? tokens[2] : tokens[1];
+    auto idText = isCanFd ? tokens[4] : tokens[2];
+    const auto &direction = tokens[3];
+    uint32_t channelNumber = 0;
+    if ( !parseNumber( channel, 10, channelNumber ) || ( ( direction != "Rx" ) && ( direction != "Tx" ) ) )
+    {
+        return false;
+    }
+    if ( idText.back() == 'x' )
+    {
+        idText.pop_back();
+    }
+    if ( !parseNumber( idText, hexIds ? 16 : 10, frame.id ) || ( frame.id > CAN_EFF_MASK ) )
+    {
+        return false;
+    }
+    size_t dataIndex = 0;
+    uint32_t size = 0;
+    if ( isCanFd )
+    {
+        size_t flagsIndex = 5;
+        if ( ( tokens[flagsIndex] != "0" ) && ( tokens[flagsIndex] != "1" ) )
+        {
+            // Skip the symbolic name
+            flagsIndex++;
+        }
+        dataIndex = flagsIndex + 4;
+        if ( ( tokens.size() < dataIndex ) || !parseNumber( tokens[dataIndex - 1], 10, size ) )
+        {
+            return false;
+        }
+    }
+    else
+    {
+        // Remote frames are marked with r instead of d
+        dataIndex = 6;
+        if ( ( tokens[4] != "d" ) || !parseNumber( tokens[5], 16, size ) )
+        {
+            return false;
+        }
+    }
+    if ( ( size > MAX_RAW_CAN_FRAME_BYTE_SIZE ) || ( tokens.size() < dataIndex + size ) )
+    {
+        return false;
+    }
+    for ( size_t i = 0; i < size; i++ )
+    {
+        uint32_t byte = 0;
+        if ( ( tokens[dataIndex + i].size() > 2 ) || !parseNumber( tokens[dataIndex + i], 16, byte ) )
+        {
+            return false;
+        }
+        frame.data[i] = static_cast<uint8_t>( byte );
+    }
+    frame.size = static_cast<uint8_t>( size );
+    frame.channel = channel;
+    return true;
+}
+
+bool
+CANLogFileDataSource::parseAscDate( const std::string &line, Timestamp &startTime )
+{
+    // date <weekday> <month> <day> <hh:mm:ss[.mmm]> [am|pm] <year>
+    auto tokens = splitTokens( line );
+    if ( ( tokens.size() < 6 ) || ( tokens[0] != "date" ) )
+    {
+        return false;
+    }
+    auto month = std::find( MONTH_NAMES.begin(), MONTH_NAMES.end(), tokens[2].substr( 0, 3 ) );
+    uint32_t day = 0;
+    uint32_t year = 0;
+    if ( ( month == MONTH_NAMES.end() ) || !parseNumber( tokens[3], 10, day ) ||
+         !parseNumber( tokens.back(), 10, year ) || ( year < 1970 ) )
+    {
+        return false;
+    }
+    std::istringstream timeStream( tokens[4] );
+    uint32_t hour = 0;
+    uint32_t minute = 0;
+    double second = 0.0;
+    char separator1 = 0;
+    char separator2 = 0;
+    if ( !( timeStream >> hour >> separator1 >> minute >> separator2 >> second ) || ( separator1 != ':' ) ||
+         ( separator2 != ':' ) )
+    {
+        return false;
+    }
+    if ( ( tokens.size() > 6 ) && ( ( tokens[5] == "am" ) || ( tokens[5] == "pm" ) ) )
+    {
+        hour = ( hour % 12 ) + ( ( tokens[5] == "pm" ) ? 12 : 0 );
+    }
+    std::tm time{};
+    time.tm_year = static_cast<int>( year ) - 1900;
+    time.tm_mon = static_cast<int>( month - MONTH_NAMES.begin() );
+    time.tm_mday = static_cast<int>( day );
+    time.tm_hour = static_cast<int>( hour );
+    time.tm_min = static_cast<int>( minute );
+    time.tm_sec = 0;
+    time.tm_isdst = -1;
+    auto secondsSinceEpoch = std::mktime( &time );
+    if ( secondsSinceEpoch < 0 )
+    {
+        return false;
+    }
+    startTime = static_cast<Timestamp>( secondsSinceEpoch ) * 1000 + static_cast<Timestamp>( second * 1000.0 + 0.5 );
+    return true;
+}
+
+bool
+CANLogFileDataSource::readNextFrame( CANLogFrame &frame )
+{
+    std::string line;
+    while ( std::getline( mLogFile, line ) )
+    {
+        // candump timestamps are since epoch, ASC timestamps since the date in the header
+        if ( !parseCandumpLine( line, frame ) )
+        {
+            Timestamp ascStartTime = 0;
+            if ( parseAscDate( line, ascStartTime ) )
+            {
+                mAscStartTime = ascStartTime;
+                continue;
+            }
+            if ( line.compare( 0, 4, "base" ) == 0 )
+            {
+                // e.g. "base hex  timestamps absolute"
+                mAscHexIds = ( line.find( "dec" ) == std::string::npos );
+                mAscRelativeTimestamps = ( line.find( "relative" ) != std::string::npos );
+                continue;
+            }
+            if ( !parseAscLine( line, mAscHexIds, frame ) )
+            {
+                continue;
+            }
+            if ( mAscRelativeTimestamps )
+            {
+                mAscLastTime += frame.timestamp;
+                frame.timestamp = mAscLastTime;
+            }
+            frame.timestamp += mAscStartTime;
+        }
+        if ( mLogInterfaceName.empty() || ( frame.channel == mLogInterfaceName ) )
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool
+CANLogFileDataSource::waitUntilDue( Timestamp recordedTime )
+{
+    auto recordedOffsetMs = ( recordedTime > mFirstRecordedTime ) ? ( recordedTime - mFirstRecordedTime ) : 0;
+    auto due = mReplayStartSteadyTime + std::chrono::microseconds( static_cast<int64_t>(
+                                            static_cast<double>( recordedOffsetMs ) * 1000.0 / mReplaySpeed ) );
+    auto now = std::chrono::steady_clock::now();
+    if ( now >= due )
+    {
+        return true;
+    }
+    auto remainingMs = std::chrono::duration_cast<std::chrono::milliseconds>( due - now ).count() + 1;
+    mWait.wait( static_cast<uint32_t>( std::min<int64_t>( remainingMs, mIdleTimeMs ) ) );
+    return false;
+}
+
+void
+CANLogFileDataSource::doWork( void *data )
+{
+    auto source = static_cast<CANLogFileDataSource *>( data );
+    CANLogFrame frame;
+    bool framePending = false;
+    while ( !source->shouldStop() )
+    {
+        if ( source->shouldSleep() || source->mReplayFinished )
+        {
+            // The thread is woken up on resume and stop
+            source->mWait.wait( source->mIdleTimeMs );
+            continue;
+        }
+        if ( !framePending )
+        {
+            if ( !source->readNextFrame( frame ) )
+            {
+                source->mReplayFinished.store( true );
+                if ( source->mReplayClock != nullptr )
+                {
+                    source->mReplayClock->finishReplay();
+                }
+                source->mLogger.info( "CANLogFileDataSource::doWork",
+                                      "Replayed " + std::to_string( source->mReplayedFrames.load() ) +
+                                          " frames from " + source->mLogFilePath );
+                continue;
+            }
+            framePending = true;
+            if ( !source->mReplayStarted )
+            {
+                source->mReplayStarted = true;
+                source->mFirstRecordedTime = frame.timestamp;
+                source->mReplayStartTime =
+                    static_cast<Timestamp>( std::chrono::duration_cast<std::chrono::milliseconds>(
+                                                std::chrono::system_clock::now().time_since_epoch() )
+                                                .count() );
+                source->mReplayStartSteadyTime = std::chrono::steady_clock::now();
+            }
+        }
+        if ( ( source->mReplaySpeed > 0.0 ) && !source->waitUntilDue( frame.timestamp ) )
+        {
+            continue;
+        }
+        Timestamp timestamp = frame.timestamp;
+        if ( !source->mKeepRecordedTimestamps )
+        {
+            timestamp = source->mReplayStartTime +
+                        ( ( frame.timestamp > source->mFirstRecordedTime )
+                              ? ( frame.timestamp - source->mFirstRecordedTime )
+                              : 0 );
+        }
+        CANRawFrameMessage message;
+        message.setup( frame.id, source->mID, frame.data.data(), frame.size, timestamp );
+        if ( message.isValid() )
+        {
+            if ( source->mReplayClock != nullptr )
+            {
+                source->mReplayClock->advance( timestamp );
+            }
+            if ( !source->mCircularBuffPtr->push( message ) )
+            {
+                // A log file can be read faster than it is decoded, so wait for the consumer instead of
+                // discarding the frame
+                source->mWait.wait( BUFFER_FULL_WAIT_TIME_MS );
+                continue;
+            }
+            auto replayedFrames = ++source->mReplayedFrames;
+            TraceVariable traceFrames =
+                static_cast<TraceVariable>( source->mID + toUType( TraceVariable::READ_SOCKET_FRAMES_0 ) );
+            TraceModule::get().setVariable( ( traceFrames < TraceVariable::READ_SOCKET_FRAMES_MAX )
+                                                ? traceFrames
+                                                : TraceVariable::READ_SOCKET_FRAMES_MAX,
+                                            replayedFrames );
+        }
+        framePending = false;
+    }
+}
+
+bool
+CANLogFileDataSource::connect()
+{
+    mLogFile.close();
+    mLogFile.clear();
+    mLogFile.open( mLogFilePath );
+    if ( !mLogFile.is_open() )
+    {
+        mLogger.error( "CANLogFileDataSource::connect", "Could not open the log file " + mLogFilePath );
+        return false;
+    }
+    mReplayStarted = false;
+    mReplayFinished.store( false );
+    mReplayedFrames.store( 0 );
+    mAscHexIds = true;
+    mAscRelativeTimestamps = false;
+    mAscStartTime = 0;
+    mAscLastTime = 0;
+    // Notify on connection success
+    notifyListeners<const VehicleDataSourceID &>( &VehicleDataSourceListener::onVehicleDataSourceConnected, mID );
+    // Start the main thread.
+    return start();
+}
+
+bool
+CANLogFileDataSource::disconnect()
+{
+    if ( !stop() )
+    {
+        return false;
+    }
+    mLogFile.close();
+    // Notify on connection closure
+    notifyListeners<const VehicleDataSourceID &>( &VehicleDataSourceListener::onVehicleDataSourceDisconnected, mID );
+    return true;
+}
+
+bool
+CANLogFileDataSource::isAlive()
+{
+    return mThread.isValid() && mThread.isActive();
+}
+
+} // namespace VehicleNetwork
+} // namespace IoTFleetWise
+} // namespace Aws
+#endif // IOTFLEETWISE_LINUX
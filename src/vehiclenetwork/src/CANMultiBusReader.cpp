@@ -0,0 +1,280 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#if defined( IOTFLEETWISE_LINUX )
+// Includes
+#include "businterfaces/CANMultiBusReader.h"
+#include "Timer.h"
+#include "businterfaces/CANDataSource.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace Aws
+{
+namespace IoTFleetWise
+{
+namespace VehicleNetwork
+{
+constexpr int CANMultiBusReader::MAX_EPOLL_EVENTS;
+constexpr uint32_t CANMultiBusReader::MAX_BATCHES_PER_EVENT;
+constexpr int CANMultiBusReader::WAIT_TIMEOUT_MS;
+
+CANMultiBusReader::CANMultiBusReader( uint32_t index )
+    : mIndex( index )
+{
+}
+
+CANMultiBusReader::~CANMultiBusReader()
+{
+    // To make sure the thread stops during teardown of tests.
+    if ( isAlive() )
+    {
+        stop();
+    }
+}
+
+bool
+CANMultiBusReader::start()
+{
+    // Prevent concurrent stop/init
+    std::lock_guard<std::mutex> lock( mThreadMutex );
+    mEpollFd = epoll_create1( EPOLL_CLOEXEC );
+    if ( mEpollFd < 0 )
+    {
+        mLogger.error( "CANMultiBusReader::start", "Failed to create the epoll instance" );
+        return false;
+    }
+    mWakeUpFd = eventfd( 0, EFD_CLOEXEC | EFD_NONBLOCK );
+    if ( mWakeUpFd < 0 )
+    {
+        mLogger.error( "CANMultiBusReader::start", "Failed to create the wake up event" );
+        close( mEpollFd );
+        mEpollFd = -1;
+        return false;
+    }
+    struct epoll_event event = {};
+    event.events = EPOLLIN;
+    // A null pointer identifies the wake up event
+    event.data.ptr = nullptr;
+    if ( epoll_ctl( mEpollFd, EPOLL_CTL_ADD, mWakeUpFd, &event ) != 0 )
+    {
+        mLogger.error( "CANMultiBusReader::start", "Failed to watch the wake up event" );
+        close( mWakeUpFd );
+        close( mEpollFd );
+        mWakeUpFd = -1;
+        mEpollFd = -1;
+        return false;
+    }
+    // On multi core systems the shared variable mShouldStop must be updated for
+    // all cores before starting the thread otherwise thread will directly end
+    mShouldStop.store( false );
+    if ( !mThread.create( doWork, this ) )
+    {
+        mLogger.trace( "CANMultiBusReader::start", " CAN Reader Thread failed to start " );
+    }
+    else
+    {
+        mLogger.trace( "CANMultiBusReader::start", " CAN Reader Thread started " );
+        mThread.setThreadName( "fwVNCANReader" + std::to_string( mIndex ) );
+    }
+    return mThread.isActive() && mThread.isValid();
+}
+
+bool
+CANMultiBusReader::stop()
+{
+    std::lock_guard<std::mutex> lock( mThreadMutex );
+    mShouldStop.store( true, std::memory_order_relaxed );
+    wakeUp();
+    mThread.release();
+    mShouldStop.store( false, std::memory_order_relaxed );
+    if ( mWakeUpFd >= 0 )
+    {
+        close( mWakeUpFd );
+        mWakeUpFd = -1;
+    }
+    if ( mEpollFd >= 0 )
+    {
+        close( mEpollFd );
+        mEpollFd = -1;
+    }
+    mLogger.trace( "CANMultiBusReader::stop", " CAN Reader Thread stopped " );
+    return !mThread.isActive();
+}
+
+bool
+CANMultiBusReader::isAlive() const
+{
+    return mThread.isValid() && mThread.isActive();
+}
+
+void
+CANMultiBusReader::wakeUp()
+{
+    if ( mWakeUpFd >= 0 )
+    {
+        uint64_t value = 1;
+        if ( write( mWakeUpFd, &value, sizeof( value ) ) < 0 )
+        {
+            mLogger.warn( "CANMultiBusReader::wakeUp", "Failed to wake up the reader thread" );
+        }
+    }
+}
+
+bool
+CANMultiBusReader::addSource( CANDataSource *source )
+{
+    if ( ( source == nullptr ) || ( mEpollFd < 0 ) )
+    {
+        mLogger.error( "CANMultiBusReader::addSource", "Reader not started or invalid source" );
+        return false;
+    }
+    std::lock_guard<std::mutex> lock( mSourcesMutex );
+    // Registered without events until the data acquisition is resumed
+    struct epoll_event event = {};
+    event.events = 0;
+    event.data.ptr = source;
+    if ( epoll_ctl( mEpollFd, EPOLL_CTL_ADD, source->getSocket(), &event ) != 0 )
+    {
+        mLogger.error( "CANMultiBusReader::addSource",
+                       "Failed to watch the socket of " + source->getVehicleDataSourceIfName() + ": " +
+                           std::string( strerror( errno ) ) );
+        return false;
+    }
+    mSources.push_back( source );
+    mLogger.trace( "CANMultiBusReader::addSource",
+                   "Reading " + source->getVehicleDataSourceIfName() + " in reader " + std::to_string( mIndex ) );
+    return true;
+}
+
+bool
+CANMultiBusReader::removeSource( CANDataSource *source )
+{
+    // Waits until the reader thread is not reading any socket
+    std::lock_guard<std::mutex> lock( mSourcesMutex );
+    auto it = std::find( mSources.begin(), mSources.end(), source );
+    if ( it == mSources.end() )
+    {
+        return false;
+    }
+    mSources.erase( it );
+    if ( mEpollFd >= 0 )
+    {
+        // Fails if the socket was already closed, which removes it from the epoll instance as well
+        epoll_ctl( mEpollFd, EPOLL_CTL_DEL, source->getSocket(), nullptr );
+    }
+    return true;
+}
+
+bool
+CANMultiBusReader::setSourceEnabled( CANDataSource *source, bool enabled )
+{
+    if ( mEpollFd < 0 )
+    {
+        return false;
+    }
+    // epoll_ctl can be called while the reader thread waits in epoll_wait
+    struct epoll_event event = {};
+    event.events = enabled ? static_cast<uint32_t>( EPOLLIN ) : 0U;
+    event.data.ptr = source;
+    if ( epoll_ctl( mEpollFd, EPOLL_CTL_MOD, source->getSocket(), &event ) != 0 )
+    {
+        mLogger.error( "CANMultiBusReader::setSourceEnabled",
+                       "Failed to change the events of " + source->getVehicleDataSourceIfName() + ": " +
+                           std::string( strerror( errno ) ) );
+        return false;
+    }
+    return true;
+}
+
+void
+CANMultiBusReader::readSource( CANDataSource *source )
+{
+    // Stop after some batches even if more frames are queued, so that one busy bus does not delay the others.
+    // The socket stays readable, so the next epoll_wait returns immediately.
+    for ( uint32_t i = 0; i < MAX_BATCHES_PER_EVENT; i++ )
+    {
+        int nmsgs = source->receiveFrames();
+        if ( nmsgs < static_cast<int>( source->getReceiveBatchSize() ) )
+        {
+            break;
+        }
+    }
+}
+
+void
+CANMultiBusReader::doWork( void *data )
+{
+    CANMultiBusReader *reader = static_cast<CANMultiBusReader *>( data );
+
+    Timer filterStatisticsTimer;
+    struct epoll_event events[MAX_EPOLL_EVENTS];
+    do
+    {
+        int eventCount = epoll_wait( reader->mEpollFd, events, MAX_EPOLL_EVENTS, WAIT_TIMEOUT_MS );
+        if ( eventCount < 0 && errno != EINTR )
+        {
+            reader->mLogger.error( "CANMultiBusReader::doWork", "epoll_wait failed: " + std::to_string( errno ) );
+        }
+        std::lock_guard<std::mutex> lock( reader->mSourcesMutex );
+        for ( int i = 0; i < eventCount; i++ )
+        {
+            auto source = static_cast<CANDataSource *>( events[i].data.ptr );
+            if ( source == nullptr )
+            {
+                uint64_t value = 0;
+                // Only resets the wake up event, mShouldStop is checked below
+                static_cast<void>( read( reader->mWakeUpFd, &value, sizeof( value ) ) );
+                continue;
+            }
+            // The source may have been removed after epoll_wait returned
+            if ( std::find( reader->mSources.begin(), reader->mSources.end(), source ) == reader->mSources.end() )
+            {
+                continue;
+            }
+            if ( ( events[i].events & EPOLLIN ) != 0 )
+            {
+                reader->readSource( source );
+            }
+            else
+            {
+                // Errors are reported even if the socket is not watched. Reading the error clears it.
+                int error = 0;
+                socklen_t len = sizeof( error );
+                static_cast<void>( getsockopt( source->getSocket(), SOL_SOCKET, SO_ERROR, &error, &len ) );
+                reader->mLogger.warn( "CANMultiBusReader::doWork",
+                                      "Error on " + source->getVehicleDataSourceIfName() + ": " +
+                                          std::to_string( error ) );
+            }
+        }
+        if ( filterStatisticsTimer.getElapsedMs().count() >=
+             static_cast<int64_t>( CANDataSource::FILTER_STATISTICS_INTERVAL_MS ) )
+        {
+            for ( auto source : reader->mSources )
+            {
+                source->updateFilteredFrames();
+            }
+            filterStatisticsTimer.reset();
+        }
+    } while ( !reader->mShouldStop.load( std::memory_order_relaxed ) );
+}
+
+} // namespace VehicleNetwork
+} // namespace IoTFleetWise
+} // namespace Aws
+#endif // IOTFLEETWISE_LINUX
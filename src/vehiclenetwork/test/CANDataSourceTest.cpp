@@ -13,6 +13,7 @@
  */
 
 #include "businterfaces/CANDataSource.h"
+#include <atomic>
 #include <functional>
 #include <gtest/gtest.h>
 #include <linux/can.h>
@@ -179,7 +180,7 @@ TEST_F( CANDataSourceTest, testAquireDataFromNetwork )
     sendTestMessage( socketFD );
     // Sleep for sometime on this thread to allow the other thread to finish
     std::this_thread::sleep_for( std::chrono::seconds( 2 ) );
-    VehicleDataMessage msg;
+    CANRawFrameMessage msg;
     ASSERT_TRUE( dataSource.getBuffer()->pop( msg ) );
     ASSERT_TRUE( dataSource.disconnect() );
     ASSERT_TRUE( dataSource.unSubscribeListener( &listener ) );
@@ -215,7 +216,7 @@ TEST_F( CANDataSourceTest, testDoNotAcquireDataFromNetwork )
     sendTestMessage( socketFD );
     // Sleep for sometime on this thread to allow the other thread to finish
     std::this_thread::sleep_for( std::chrono::seconds( 2 ) );
-    VehicleDataMessage msg;
+    CANRawFrameMessage msg;
     // No messages should be in the buffer
     ASSERT_FALSE( dataSource.getBuffer()->pop( msg ) );
     ASSERT_TRUE( dataSource.disconnect() ); // Here the frame will be read from the socket
@@ -254,7 +255,7 @@ TEST_F( CANDataSourceTest, testNetworkDataAquisitionStateChange )
     sendTestMessage( socketFD );
     // Sleep for sometime on this thread to allow the other thread to finish
     std::this_thread::sleep_for( std::chrono::seconds( 2 ) );
-    VehicleDataMessage msg;
+    CANRawFrameMessage msg;
     // No messages should be in the buffer
     ASSERT_FALSE( dataSource.getBuffer()->pop( msg ) );
 
@@ -325,10 +326,154 @@ TEST_F( CANDataSourceTest, testExtractExtendedID )
     sendTestMessageExtendedID( socketFD );
     // Sleep for sometime on this thread to allow the other thread to finish
     std::this_thread::sleep_for( std::chrono::seconds( 2 ) );
-    VehicleDataMessage msg;
+    CANRawFrameMessage msg;
     ASSERT_TRUE( dataSource.getBuffer()->pop( msg ) );
     ASSERT_EQ( msg.getMessageID(), 0x123 );
+    ASSERT_EQ( msg.getChannelID(), dataSource.getVehicleDataSourceID() );
+    ASSERT_EQ( msg.getSize(), 4 );
+    ASSERT_EQ( msg.getData()[2], 2 );
     ASSERT_TRUE( dataSource.disconnect() );
     ASSERT_TRUE( dataSource.unSubscribeListener( &listener ) );
     ASSERT_TRUE( listener.gotDisConnectCallback );
 }
+
+TEST_F( CANDataSourceTest, testFrameFilter )
+{
+    ASSERT_TRUE( socketFD != -1 );
+
+    VehicleDataSourceConfig sourceConfig;
+    sourceConfig.transportProperties.emplace( "interfaceName", "vcan0" );
+    sourceConfig.transportProperties.emplace( "threadIdleTimeMs", "100" );
+    sourceConfig.maxNumberOfVehicleDataMessages = 1000;
+    std::vector<VehicleDataSourceConfig> sourceConfigs = { sourceConfig };
+    CANDataSource dataSource;
+    ASSERT_TRUE( dataSource.init( sourceConfigs ) );
+    // Applied on connect
+    ASSERT_TRUE( dataSource.setFrameFilter( { 0x456 } ) );
+    ASSERT_TRUE( dataSource.connect() );
+    dataSource.resumeDataAcquisition();
+    sendTestMessage( socketFD );
+    std::this_thread::sleep_for( std::chrono::milliseconds( 500 ) );
+    CANRawFrameMessage msg;
+    ASSERT_FALSE( dataSource.getBuffer()->pop( msg ) );
+
+    // Applied to the connected socket
+    ASSERT_TRUE( dataSource.setFrameFilter( { 0x456, 0x123 } ) );
+    sendTestMessage( socketFD );
+    sendTestMessageExtendedID( socketFD );
+    std::this_thread::sleep_for( std::chrono::milliseconds( 500 ) );
+    ASSERT_TRUE( dataSource.getBuffer()->pop( msg ) );
+    ASSERT_EQ( msg.getMessageID(), 0x123 );
+    ASSERT_TRUE( dataSource.getBuffer()->pop( msg ) );
+    ASSERT_EQ( msg.getMessageID(), 0x123 );
+    ASSERT_TRUE( dataSource.disconnect() );
+}
+
+static bool
+passesFilters( const std::vector<struct can_filter> &filters, uint32_t frameId )
+{
+    for ( const auto &filter : filters )
+    {
+        if ( ( frameId & filter.can_mask ) == ( filter.can_id & filter.can_mask ) )
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+TEST( CANDataSourceFilterTest, oneFilterPerFrameId )
+{
+    auto filters = CANDataSource::createFrameFilters( { 0x123, 0x100, 0x123, 0x18FEF100 | CAN_EFF_FLAG } );
+    ASSERT_EQ( filters.size(), 3 );
+    ASSERT_TRUE( passesFilters( filters, 0x100 ) );
+    ASSERT_TRUE( passesFilters( filters, 0x123 ) );
+    ASSERT_TRUE( passesFilters( filters, 0x123 | CAN_EFF_FLAG ) );
+    ASSERT_TRUE( passesFilters( filters, 0x18FEF100 | CAN_EFF_FLAG ) );
+    ASSERT_FALSE( passesFilters( filters, 0x101 ) );
+    ASSERT_FALSE( passesFilters( filters, 0x18FEF101 | CAN_EFF_FLAG ) );
+
+    ASSERT_TRUE( CANDataSource::createFrameFilters( {} ).empty() );
+}
+
+TEST( CANDataSourceFilterTest, tooManyFrameIdsAreGroupedWithMasks )
+{
+    std::vector<uint32_t> frameIds;
+    for ( uint32_t i = 0; i < 1000; i++ )
+    {
+        frameIds.push_back( 0x100 + ( i * 3 ) );
+    }
+    auto filters = CANDataSource::createFrameFilters( frameIds, 16 );
+    ASSERT_LE( filters.size(), 16 );
+    for ( auto frameId : frameIds )
+    {
+        ASSERT_TRUE( passesFilters( filters, frameId ) );
+    }
+    ASSERT_FALSE( passesFilters( filters, 0x1 ) );
+    ASSERT_FALSE( passesFilters( filters, 0x1FFFFFFF ) );
+
+    // A single filter passes everything if nothing else fits
+    filters = CANDataSource::createFrameFilters( { 0x1, 0x1FFFFFFF }, 1 );
+    ASSERT_EQ( filters.size(), 1 );
+    ASSERT_TRUE( passesFilters( filters, 0x12345 ) );
+}
+
+TEST_F( CANDataSourceTest, testMultiBusReader )
+{
+    ASSERT_TRUE( socketFD != -1 );
+
+    VehicleDataSourceConfig sourceConfig;
+    sourceConfig.transportProperties.emplace( "interfaceName", "vcan0" );
+    sourceConfig.transportProperties.emplace( "threadIdleTimeMs", "1000" );
+    sourceConfig.maxNumberOfVehicleDataMessages = 1000;
+    std::vector<VehicleDataSourceConfig> sourceConfigs = { sourceConfig };
+    auto reader = std::make_shared<CANMultiBusReader>();
+    ASSERT_TRUE( reader->start() );
+    CANDataSource dataSource1;
+    CANDataSource dataSource2;
+    std::atomic<int> callbacks{ 0 };
+    for ( auto dataSource : { &dataSource1, &dataSource2 } )
+    {
+        ASSERT_TRUE( dataSource->init( sourceConfigs ) );
+        dataSource->setMultiBusReader( reader );
+        dataSource->setFramesReceivedCallback( [&callbacks]() { callbacks++; } );
+        ASSERT_TRUE( dataSource->connect() );
+        ASSERT_TRUE( dataSource->isAlive() );
+    }
+    // Only the resumed data source reads its socket
+    dataSource1.resumeDataAcquisition();
+    sendTestMessage( socketFD );
+    std::this_thread::sleep_for( std::chrono::milliseconds( 200 ) );
+    CANRawFrameMessage msg;
+    ASSERT_TRUE( dataSource1.getBuffer()->pop( msg ) );
+    ASSERT_EQ( msg.getMessageID(), 0x123 );
+    ASSERT_FALSE( dataSource2.getBuffer()->pop( msg ) );
+    ASSERT_EQ( callbacks, 1 );
+
+    dataSource2.resumeDataAcquisition();
+    dataSource1.suspendDataAcquisition();
+    sendTestMessage( socketFD );
+    std::this_thread::sleep_for( std::chrono::milliseconds( 200 ) );
+    ASSERT_FALSE( dataSource1.getBuffer()->pop( msg ) );
+    ASSERT_TRUE( dataSource2.getBuffer()->pop( msg ) );
+    ASSERT_EQ( callbacks, 2 );
+
+    ASSERT_TRUE( dataSource1.disconnect() );
+    ASSERT_TRUE( dataSource2.disconnect() );
+    ASSERT_TRUE( reader->stop() );
+}
+
+TEST( CANMultiBusReaderTest, startAndStop )
+{
+    CANMultiBusReader reader;
+    CANDataSource dataSource;
+    // Not started
+    ASSERT_FALSE( reader.addSource( &dataSource ) );
+    ASSERT_TRUE( reader.start() );
+    ASSERT_TRUE( reader.isAlive() );
+    // Not connected
+    ASSERT_FALSE( reader.addSource( &dataSource ) );
+    ASSERT_FALSE( reader.removeSource( &dataSource ) );
+    ASSERT_TRUE( reader.stop() );
+    ASSERT_FALSE( reader.isAlive() );
+}
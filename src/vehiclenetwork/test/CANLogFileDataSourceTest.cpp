@@ -0,0 +1,252 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include "businterfaces/CANLogFileDataSource.h"
+#include "ReplayClock.h"
+#include <chrono>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <thread>
+
+using namespace Aws::IoTFleetWise::VehicleNetwork;
+
+static std::string
+writeLogFile( const std::string &name, const std::string &content )
+{
+    auto path = "CANLogFileDataSourceTest-" + name + ".log";
+    std::ofstream file( path );
+    file << content;
+    return path;
+}
+
+static std::vector<VehicleDataSourceConfig>
+createConfigs( const std::map<std::string, std::string> &properties )
+{
+    VehicleDataSourceConfig config;
+    config.transportProperties = properties;
+    config.transportProperties.emplace( "threadIdleTimeMs", "10" );
+    config.maxNumberOfVehicleDataMessages = 1000;
+    return { config };
+}
+
+static bool
+waitUntilFinished( const CANLogFileDataSource &source )
+{
+    for ( int i = 0; ( i < 500 ) && !source.isReplayFinished(); i++ )
+    {
+        std::this_thread::sleep_for( std::chrono::milliseconds( 10 ) );
+    }
+    return source.isReplayFinished();
+}
+
+TEST( CANLogFileDataSourceTest, ParseCandumpLines )
+{
+    CANLogFrame frame;
+    ASSERT_TRUE( CANLogFileDataSource::parseCandumpLine( "(1600000000.123456) can0 123#0011AAFF", frame ) );
+    ASSERT_EQ( frame.timestamp, 1600000000123 );
+    ASSERT_EQ( frame.channel, "can0" );
+    ASSERT_EQ( frame.id, 0x123 );
+    ASSERT_EQ( frame.size, 4 );
+    ASSERT_EQ( frame.data[0], 0x00 );
+    ASSERT_EQ( frame.data[3], 0xFF );
+
+    ASSERT_TRUE( CANLogFileDataSource::parseCandumpLine( "(1600000001.5) vcan1 18FEF100#01.02", frame ) );
+    ASSERT_EQ( frame.timestamp, 1600000001500 );
+    ASSERT_EQ( frame.id, 0x18FEF100 );
+    ASSERT_EQ( frame.size, 2 );
+    ASSERT_EQ( frame.data[1], 0x02 );
+
+    // CAN FD frame with flags
+    std::string fdPayload( 24, 'A' );
+    ASSERT_TRUE( CANLogFileDataSource::parseCandumpLine( "(1600000002.000000) can0 456##1" + fdPayload, frame ) );
+    ASSERT_EQ( frame.id, 0x456 );
+    ASSERT_EQ( frame.size, 12 );
+    ASSERT_EQ( frame.data[11], 0xAA );
+
+    // Remote frame, error frame and broken lines
+    ASSERT_FALSE( CANLogFileDataSource::parseCandumpLine( "(1600000000.000000) can0 123#R", frame ) );
+    ASSERT_FALSE(
+        CANLogFileDataSource::parseCandumpLine( "(1600000000.000000) can0 20000080#0000000000000000", frame ) );
+    ASSERT_FALSE( CANLogFileDataSource::parseCandumpLine( "(1600000000.000000) can0 123#001", frame ) );
+    ASSERT_FALSE( CANLogFileDataSource::parseCandumpLine( "(1600000000.000000) can0 XYZ#00", frame ) );
+    ASSERT_FALSE( CANLogFileDataSource::parseCandumpLine( "1600000000.000000 can0 123#00", frame ) );
+    ASSERT_FALSE( CANLogFileDataSource::parseCandumpLine( "", frame ) );
+}
+
+TEST( CANLogFileDataSourceTest, ParseAscLines )
+{
+    CANLogFrame frame;
+    ASSERT_TRUE(
+        CANLogFileDataSource::parseAscLine( "   1.002346 1  123             Rx   d 3 00 11 22", true, frame ) );
+    ASSERT_EQ( frame.timestamp, 1002 );
+    ASSERT_EQ( frame.channel, "1" );
+    ASSERT_EQ( frame.id, 0x123 );
+    ASSERT_EQ( frame.size, 3 );
+    ASSERT_EQ( frame.data[2], 0x22 );
+
+    ASSERT_TRUE( CANLogFileDataSource::parseAscLine(
+        "   2.000000 2  18FEF100x       Tx   d 8 01 02 03 04 05 06 07 08  Length = 0 BitCount = 0", true, frame ) );
+    ASSERT_EQ( frame.channel, "2" );
+    ASSERT_EQ( frame.id, 0x18FEF100 );
+    ASSERT_EQ( frame.size, 8 );
+    ASSERT_EQ( frame.data[7], 0x08 );
+
+    ASSERT_TRUE( CANLogFileDataSource::parseAscLine( "   0.500000 1  291             Rx   d 1 AB", false, frame ) );
+    ASSERT_EQ( frame.id, 291 );
+
+    // CAN FD with and without symbolic name
+    ASSERT_TRUE( CANLogFileDataSource::parseAscLine(
+        "   3.000000 CANFD   1 Rx        456                                   1 0 9 12 "
+        "00 01 02 03 04 05 06 07 08 09 0a 0b   0 0 1000 0 0 0 0 0",
+        true,
+        frame ) );
+    ASSERT_EQ( frame.id, 0x456 );
+    ASSERT_EQ( frame.size, 12 );
+    ASSERT_EQ( frame.data[11], 0x0B );
+    ASSERT_TRUE( CANLogFileDataSource::parseAscLine(
+        "   3.000000 CANFD   1 Rx        457  EngineData  1 0 2 2 AA BB", true, frame ) );
+    ASSERT_EQ( frame.id, 0x457 );
+    ASSERT_EQ( frame.size, 2 );
+
+    // Remote frames and other events
+    ASSERT_FALSE( CANLogFileDataSource::parseAscLine( "   1.000000 1  123             Rx   r", true, frame ) );
+    ASSERT_FALSE( CANLogFileDataSource::parseAscLine( "   1.000000 1  ErrorFrame", true, frame ) );
+    ASSERT_FALSE(
+        CANLogFileDataSource::parseAscLine( "Begin Triggerblock Wed Sep 29 10:31:26.123 am 2021", true, frame ) );
+    ASSERT_FALSE( CANLogFileDataSource::parseAscLine( "   1.000000 1  123 Rx d 4 00 11", true, frame ) );
+}
+
+TEST( CANLogFileDataSourceTest, ParseAscDate )
+{
+    Timestamp am = 0;
+    Timestamp pm = 0;
+    ASSERT_TRUE( CANLogFileDataSource::parseAscDate( "date Wed Sep 29 10:31:26.123 am 2021", am ) );
+    ASSERT_TRUE( CANLogFileDataSource::parseAscDate( "date Wed Sep 29 10:31:26.123 pm 2021", pm ) );
+    ASSERT_EQ( pm - am, 12 * 3600 * 1000 );
+    ASSERT_EQ( am % 1000, 123 );
+    Timestamp noAmPm = 0;
+    ASSERT_TRUE( CANLogFileDataSource::parseAscDate( "date Wed Sep 29 22:31:26.123 2021", noAmPm ) );
+    ASSERT_EQ( noAmPm, pm );
+    ASSERT_FALSE( CANLogFileDataSource::parseAscDate( "base hex  timestamps absolute", am ) );
+    ASSERT_FALSE( CANLogFileDataSource::parseAscDate( "date Wed Foo 29 10:31:26 2021", am ) );
+}
+
+TEST( CANLogFileDataSourceTest, InitAndConnectFailures )
+{
+    CANLogFileDataSource source;
+    ASSERT_FALSE( source.init( createConfigs( {} ) ) );
+    ASSERT_FALSE( source.init( createConfigs( { { "logFile", "test.log" }, { "replaySpeed", "-1" } } ) ) );
+    ASSERT_FALSE( source.init( createConfigs( { { "logFile", "test.log" }, { "replaySpeed", "fast" } } ) ) );
+    ASSERT_TRUE( source.init( createConfigs( { { "logFile", "CANLogFileDataSourceTest-does-not-exist.log" } } ) ) );
+    ASSERT_FALSE( source.connect() );
+}
+
+TEST( CANLogFileDataSourceTest, ReplayCandumpAsFastAsPossible )
+{
+    auto path = writeLogFile( "candump",
+                              "(1600000000.000000) can0 100#01\n"
+                              "(1600000000.010000) can1 200#02\n"
+                              "(1600000000.250000) can0 101#0102\n"
+                              "this line is ignored\n"
+                              "(1600000000.500000) can0 102#\n" );
+    auto replayClock = std::make_shared<ReplayClock>();
+    CANLogFileDataSource source( replayClock );
+    ASSERT_TRUE( source.init( createConfigs( { { "logFile", path }, { "logInterfaceName", "can0" } } ) ) );
+    ASSERT_TRUE( source.connect() );
+    ASSERT_TRUE( source.isAlive() );
+    // Nothing is replayed until the data acquisition is resumed
+    std::this_thread::sleep_for( std::chrono::milliseconds( 50 ) );
+    ASSERT_EQ( source.getReplayedFrames(), 0 );
+    source.resumeDataAcquisition();
+    ASSERT_TRUE( waitUntilFinished( source ) );
+    // The frame of can1 and the frame without payload are not replayed
+    ASSERT_EQ( source.getReplayedFrames(), 2 );
+
+    CANRawFrameMessage first;
+    CANRawFrameMessage second;
+    ASSERT_TRUE( source.getBuffer()->pop( first ) );
+    ASSERT_TRUE( source.getBuffer()->pop( second ) );
+    ASSERT_FALSE( source.getBuffer()->pop( second ) );
+    ASSERT_EQ( first.getMessageID(), 0x100 );
+    ASSERT_EQ( second.getMessageID(), 0x101 );
+    ASSERT_EQ( second.getSize(), 2 );
+    ASSERT_EQ( first.getChannelID(), source.getVehicleDataSourceID() );
+    // The recorded time difference is kept, but the replay starts now
+    ASSERT_EQ( second.getReceptionTimestamp() - first.getReceptionTimestamp(), 250 );
+    ASSERT_GT( first.getReceptionTimestamp(), 1600000000000 );
+    // The clock continues from the last frame after the replay
+    ASSERT_GE( replayClock->timeSinceEpochMs(), second.getReceptionTimestamp() );
+    ASSERT_TRUE( source.disconnect() );
+}
+
+TEST( CANLogFileDataSourceTest, ReplayAscInScaledTimeWithRecordedTimestamps )
+{
+    auto path = writeLogFile( "asc",
+                              "date Wed Sep 29 10:31:26.000 am 2021\n"
+                              "base hex  timestamps absolute\n"
+                              "internal events logged\n"
+                              "Begin Triggerblock Wed Sep 29 10:31:26.000 am 2021\n"
+                              "   0.000000 Start of measurement\n"
+                              "   0.100000 1  123             Rx   d 2 00 11\n"
+                              "   0.400000 1  124             Rx   d 2 00 11\n"
+                              "End TriggerBlock\n" );
+    Timestamp startTime = 0;
+    ASSERT_TRUE( CANLogFileDataSource::parseAscDate( "date Wed Sep 29 10:31:26.000 am 2021", startTime ) );
+    CANLogFileDataSource source;
+    ASSERT_TRUE( source.init( createConfigs(
+        { { "logFile", path }, { "replaySpeed", "2" }, { "keepRecordedTimestamps", "true" } } ) ) );
+    ASSERT_TRUE( source.connect() );
+    auto replayStart = std::chrono::steady_clock::now();
+    source.resumeDataAcquisition();
+    ASSERT_TRUE( waitUntilFinished( source ) );
+    // 300 ms recorded between the frames are replayed in 150 ms
+    ASSERT_GE( std::chrono::steady_clock::now() - replayStart, std::chrono::milliseconds( 150 ) );
+    ASSERT_EQ( source.getReplayedFrames(), 2 );
+    CANRawFrameMessage frame;
+    ASSERT_TRUE( source.getBuffer()->pop( frame ) );
+    ASSERT_EQ( frame.getReceptionTimestamp(), startTime + 100 );
+    ASSERT_TRUE( source.getBuffer()->pop( frame ) );
+    ASSERT_EQ( frame.getReceptionTimestamp(), startTime + 400 );
+    ASSERT_TRUE( source.disconnect() );
+}
+
+TEST( CANLogFileDataSourceTest, ReplayWaitsForTheConsumerWhenTheBufferIsFull )
+{
+    std::string content;
+    for ( int i = 0; i < 30; i++ )
+    {
+        content += "(1600000000.0000" + std::to_string( 10 + i ) + ") can0 100#01\n";
+    }
+    auto path = writeLogFile( "full", content );
+    CANLogFileDataSource source;
+    auto configs = createConfigs( { { "logFile", path } } );
+    configs[0].maxNumberOfVehicleDataMessages = 10;
+    ASSERT_TRUE( source.init( configs ) );
+    ASSERT_TRUE( source.connect() );
+    source.resumeDataAcquisition();
+    std::this_thread::sleep_for( std::chrono::milliseconds( 50 ) );
+    ASSERT_FALSE( source.isReplayFinished() );
+    uint32_t poppedFrames = 0;
+    CANRawFrameMessage frame;
+    for ( int i = 0; ( i < 500 ) && ( poppedFrames < 30 ); i++ )
+    {
+        while ( source.getBuffer()->pop( frame ) )
+        {
+            poppedFrames++;
+        }
+        std::this_thread::sleep_for( std::chrono::milliseconds( 2 ) );
+    }
+    ASSERT_EQ( poppedFrames, 30 );
+    ASSERT_TRUE( waitUntilFinished( source ) );
+    ASSERT_TRUE( source.disconnect() );
+}
@@ -0,0 +1,64 @@
+/**
+ * Copyright 2020 Amazon.com, Inc. and its affiliates. All Rights Reserved.
+ * SPDX-License-Identifier: LicenseRef-.amazon.com.-AmznSL-1.0
+ * Licensed under the Amazon Software License (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ * http://aws.amazon.com/asl/
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+#include "datatypes/CANRawFrameMessage.h"
+#include <boost/lockfree/spsc_queue.hpp>
+#include <gtest/gtest.h>
+
+using namespace Aws::IoTFleetWise::VehicleNetwork;
+using namespace Aws::IoTFleetWise::Platform::Linux;
+
+TEST( CANRawFrameMessageTest, SetupTest )
+{
+    CANRawFrameMessage message;
+    ASSERT_FALSE( message.isValid() );
+
+    const std::array<std::uint8_t, 8> rawData = { 0U, 1U, 2U, 3U, 4U, 5U, 6U, 7U };
+    Timestamp timestamp = static_cast<Timestamp>( 12345678 );
+    message.setup( 0x123U, 3U, rawData.data(), static_cast<uint8_t>( rawData.size() ), timestamp );
+    ASSERT_TRUE( message.isValid() );
+    ASSERT_EQ( message.getMessageID(), 0x123U );
+    ASSERT_EQ( message.getChannelID(), 3U );
+    ASSERT_EQ( message.getSize(), rawData.size() );
+    for ( size_t i = 0; i < rawData.size(); i++ )
+    {
+        ASSERT_EQ( rawData[i], message.getData()[i] );
+    }
+    ASSERT_EQ( message.getReceptionTimestamp(), timestamp );
+}
+
+TEST( CANRawFrameMessageTest, PayloadIsTruncatedToInlineStorage )
+{
+    CANRawFrameMessage message;
+    std::array<std::uint8_t, MAX_RAW_CAN_FRAME_BYTE_SIZE + 4> rawData{};
+    rawData.fill( 0xAA );
+    message.setup( 0x1U, 1U, rawData.data(), static_cast<uint8_t>( rawData.size() ), 1 );
+    ASSERT_EQ( message.getSize(), MAX_RAW_CAN_FRAME_BYTE_SIZE );
+}
+
+TEST( CANRawFrameMessageTest, PassThroughSPSCQueue )
+{
+    boost::lockfree::spsc_queue<CANRawFrameMessage> queue( 2 );
+    const std::array<std::uint8_t, 3> rawData = { 0xCAU, 0xFEU, 0x01U };
+    CANRawFrameMessage in;
+    in.setup( 0x7FFU, 2U, rawData.data(), static_cast<uint8_t>( rawData.size() ), 100 );
+    ASSERT_TRUE( queue.push( in ) );
+
+    CANRawFrameMessage out;
+    ASSERT_TRUE( queue.pop( out ) );
+    ASSERT_EQ( out.getMessageID(), 0x7FFU );
+    ASSERT_EQ( out.getChannelID(), 2U );
+    ASSERT_EQ( out.getSize(), 3U );
+    ASSERT_EQ( out.getData()[1], 0xFEU );
+    ASSERT_EQ( out.getReceptionTimestamp(), 100U );
+}
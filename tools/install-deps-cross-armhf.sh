@@ -58,7 +58,9 @@ apt install -y \
     curl \
     zlib1g-dev:armhf \
     libcurl4-openssl-dev:armhf \
-    libsnappy-dev:armhf
+    libsnappy-dev:armhf \
+    liblz4-dev:armhf \
+    libzstd-dev:armhf
 
 mkdir -p deps-cross-armhf && cd deps-cross-armhf
 
@@ -47,6 +47,8 @@ apt install -y \
     zlib1g-dev \
     libcurl4-openssl-dev \
     libsnappy-dev \
+    liblz4-dev \
+    libzstd-dev \
     doxygen \
     graphviz \
     clang-format-10 \